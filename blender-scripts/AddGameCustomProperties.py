@@ -38,6 +38,16 @@ for obj in objects:
             description="Mass of the object in kilograms"
         )
     
+    if "CollisionLod" not in obj:
+        obj["CollisionLod"] = 0
+        rna_prop = obj.id_properties_ui("CollisionLod")
+        rna_prop.update(
+            default=0,
+            min=0,
+            max=4,
+            description="Level of detail of the collision mesh used for collision detection (0 = full detail)"
+        )
+    
     if "LockRotationX" not in obj:
         obj["LockRotationX"] = False
         rna_prop = obj.id_properties_ui("LockRotationX")
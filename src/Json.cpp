@@ -4,6 +4,7 @@
 
 #include "json.h"
 #include <string.h>
+#include <charconv>
 
  /*! \brief Checks for an empty string
   *
@@ -180,28 +181,21 @@ sjson::parsing::parse_results sjson::parsing::parse(const char* input)
     switch (result.type)
     {
     case sjson::jtype::jstring:
+    {
         // Validate the input
         if (*index != '"') throw sjson::parsing_error("Expected '\"' as first character");
 
         // Remove the opening quote
         index++;
 
-        // Copy the string
-        while (!EMPTY_STRING(index))
-        {
-            if (*index != '"' || (result.value.size() > 0 && result.value[result.value.size() - 1] == '\\'))
-            {
-                result.value.push_back(*index);
-                index++;
-            }
-            else
-            {
-                break;
-            }
-        }
+        // Find the closing quote and copy the string in one go
+        const char* start = index;
+        while (!EMPTY_STRING(index) && (*index != '"' || (index > start && index[-1] == '\\'))) index++;
+        result.value.assign(start, index);
         if (EMPTY_STRING(index) || *index != '"') result.type = sjson::jtype::not_valid;
         else index++;
         break;
+    }
     case sjson::jtype::jnumber:
     {
         const char error[] = "Input did not contain a valid number";
@@ -443,59 +437,9 @@ void sjson::jobject::proxy::set_array(const std::vector<std::string>& values, co
 
 sjson::jobject sjson::jobject::parse(const char* input)
 {
-    const char error[] = "Input is not a valid object";
     const char* index = sjson::parsing::tlws(input);
-    sjson::jobject result;
-    switch (*index)
-    {
-    case '{':
-        // Result is already an object
-        break;
-    case '[':
-        result = sjson::jobject(true);
-        break;
-    default:
-        throw sjson::parsing_error(error);
-        break;
-    }
-    index++;
-    SKIP_WHITE_SPACE(index);
-    if (EMPTY_STRING(index)) throw sjson::parsing_error(error);
-
-    while (!EMPTY_STRING(index) && !END_CHARACTER_ENCOUNTERED(result, index))
-    {
-        // Get key
-        kvp entry;
-
-        if (!result.is_array()) {
-            sjson::parsing::parse_results key = sjson::parsing::parse(index);
-            if (key.type != sjson::jtype::jstring || key.value == "") throw sjson::parsing_error(error);
-            entry.first = key.value;
-            index = key.remainder;
-
-            // Get value
-            SKIP_WHITE_SPACE(index);
-            if (*index != ':') throw sjson::parsing_error(error);
-            index++;
-        }
-
-        SKIP_WHITE_SPACE(index);
-        sjson::parsing::parse_results value = sjson::parsing::parse(index);
-        if (value.type == sjson::jtype::not_valid) throw sjson::parsing_error(error);
-        if (value.type == sjson::jtype::jstring) entry.second = "\"" + value.value + "\"";
-        else entry.second = value.value;
-        index = value.remainder;
-
-        // Clean up
-        SKIP_WHITE_SPACE(index);
-        if (*index != ',' && !END_CHARACTER_ENCOUNTERED(result, index)) throw sjson::parsing_error(error);
-        if (*index == ',') index++;
-        result += entry;
-
-    }
-    if (EMPTY_STRING(index) || !END_CHARACTER_ENCOUNTERED(result, index)) throw sjson::parsing_error(error);
-    index++;
-    return result;
+    if (*index != '{' && *index != '[') throw sjson::parsing_error("Input is not a valid object");
+    return sjson::document::parse(index).root().as_object();
 }
 
 void sjson::jobject::set(const std::string& key, const std::string& value)
@@ -608,4 +552,676 @@ std::string sjson::jobject::pretty(unsigned int indent_level) const
         result += "}";
     }
     return result;
-}
\ No newline at end of file
+}
+
+/*! \brief Moves a pointer to the first character that is not white space, without reading past end */
+static const char* skip_white_space(const char* index, const char* end)
+{
+    while (index != end && std::isspace((unsigned char)*index)) index++;
+    return index;
+}
+
+/*! \brief Reads the four hexadecimal digits of a \\u escape sequence */
+static uint32_t read_code_unit(const char*& index, const char* end)
+{
+    uint32_t code_unit = 0;
+    if (end - index < 4 || std::from_chars(index, index + 4, code_unit, 16).ptr != index + 4) throw sjson::parsing_error("Invalid unicode escape sequence");
+    index += 4;
+    return code_unit;
+}
+
+/*! \brief Checks the grammar of the JSON number index points to, which std::from_chars is more lenient with
+ *
+ * @return A pointer to the first character after the number
+ * \exception json::parsing_error Thrown if the input does not start with a valid number
+ */
+static const char* scan_number(const char* index, const char* end, bool& is_integer)
+{
+    const char error[] = "Input did not contain a valid number";
+    is_integer = true;
+    if (index != end && *index == '-') index++;
+    if (index == end || !std::isdigit((unsigned char)*index)) throw sjson::parsing_error(error);
+    while (index != end && std::isdigit((unsigned char)*index)) index++;
+    if (index != end && *index == '.')
+    {
+        is_integer = false;
+        if (++index == end || !std::isdigit((unsigned char)*index)) throw sjson::parsing_error(error);
+        while (index != end && std::isdigit((unsigned char)*index)) index++;
+    }
+    if (index != end && (*index == 'e' || *index == 'E'))
+    {
+        is_integer = false;
+        if (++index != end && (*index == '+' || *index == '-')) index++;
+        if (index == end || !std::isdigit((unsigned char)*index)) throw sjson::parsing_error(error);
+        while (index != end && std::isdigit((unsigned char)*index)) index++;
+    }
+    return index;
+}
+
+/*! \brief Decodes the escape sequence following a backslash, moving index past it
+ *
+ * @return The position after the decoded characters. At most 4 characters are written, never more than were read
+ */
+static char* decode_escape(const char*& index, const char* end, char* write)
+{
+    switch (*index++)
+    {
+    case '"': *write++ = '"'; break;
+    case '\\': *write++ = '\\'; break;
+    case '/': *write++ = '/'; break;
+    case 'b': *write++ = '\b'; break;
+    case 'f': *write++ = '\f'; break;
+    case 'n': *write++ = '\n'; break;
+    case 'r': *write++ = '\r'; break;
+    case 't': *write++ = '\t'; break;
+    case 'u':
+    {
+        uint32_t code_point = read_code_unit(index, end);
+        if (code_point >= 0xD800 && code_point <= 0xDBFF && end - index >= 6 && index[0] == '\\' && index[1] == 'u')
+        {
+            index += 2;
+            uint32_t low_surrogate = read_code_unit(index, end);
+            if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF) throw sjson::parsing_error("Invalid unicode surrogate pair");
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+        }
+
+        // Encode as UTF-8
+        if (code_point < 0x80) *write++ = (char)code_point;
+        else if (code_point < 0x800)
+        {
+            *write++ = (char)(0xC0 | (code_point >> 6));
+            *write++ = (char)(0x80 | (code_point & 0x3F));
+        }
+        else if (code_point < 0x10000)
+        {
+            *write++ = (char)(0xE0 | (code_point >> 12));
+            *write++ = (char)(0x80 | ((code_point >> 6) & 0x3F));
+            *write++ = (char)(0x80 | (code_point & 0x3F));
+        }
+        else
+        {
+            *write++ = (char)(0xF0 | (code_point >> 18));
+            *write++ = (char)(0x80 | ((code_point >> 12) & 0x3F));
+            *write++ = (char)(0x80 | ((code_point >> 6) & 0x3F));
+            *write++ = (char)(0x80 | (code_point & 0x3F));
+        }
+        break;
+    }
+    default:
+        throw sjson::parsing_error("Invalid escape sequence");
+    }
+    return write;
+}
+
+std::string_view sjson::document::read_string(const char*& index, const char* end)
+{
+    const char error[] = "Input did not contain a valid string";
+
+    // Strings without escape sequences are used in place
+    const char* start = ++index;
+    while (index != end && *index != '"' && *index != '\\') index++;
+    if (index == end) throw sjson::parsing_error(error);
+    if (*index == '"') return std::string_view(start, (size_t)(index++ - start));
+
+    // The others are decoded, which never makes them longer
+    char* output = this->strings.get() + this->strings_size;
+    char* write = output;
+    memcpy(write, start, (size_t)(index - start));
+    write += index - start;
+    while (index != end && *index != '"')
+    {
+        if (*index != '\\')
+        {
+            *write++ = *index++;
+            continue;
+        }
+        if (++index == end) throw sjson::parsing_error(error);
+        write = decode_escape(index, end, write);
+    }
+    if (index == end) throw sjson::parsing_error(error);
+    index++;
+    this->strings_size += (size_t)(write - output);
+    return std::string_view(output, (size_t)(write - output));
+}
+
+sjson::document sjson::document::parse(std::string_view input)
+{
+    document result;
+    result.input.reset(new char[input.size() + 1]);
+    memcpy(result.input.get(), input.data(), input.size());
+    result.input[input.size()] = '\0';
+    result.strings.reset(new char[input.size() + 1]);
+
+    const char* begin = result.input.get();
+    const char* end = begin + input.size();
+    const char* index = skip_white_space(begin, end);
+
+    // Indices of the objects and arrays whose closing bracket has not been reached yet
+    std::vector<uint32_t> open;
+    while (true)
+    {
+        // Members of objects start with their key
+        std::string_view key;
+        if (!open.empty() && result.nodes[open.back()].type == sjson::jtype::jobject)
+        {
+            if (index == end || *index != '"') throw sjson::parsing_error("Expected a key");
+            key = result.read_string(index, end);
+            index = skip_white_space(index, end);
+            if (index == end || *index != ':') throw sjson::parsing_error("Expected ':' after a key");
+            index = skip_white_space(index + 1, end);
+        }
+        if (index == end) throw sjson::parsing_error("Unexpected end of input");
+
+        if (!open.empty()) result.nodes[open.back()].count++;
+        const uint32_t node_index = (uint32_t)result.nodes.size();
+        node value{ sjson::jtype::not_valid, node_index + 1, 0, 0, key, std::string_view(), std::string_view(), 0.0, 0 };
+        const char* value_start = index;
+        switch (*index)
+        {
+        case '{':
+        case '[':
+        {
+            value.type = *index == '{' ? sjson::jtype::jobject : sjson::jtype::jarray;
+            value.source = std::string_view(value_start, 0);
+            const char closing = *index == '{' ? '}' : ']';
+            result.nodes.push_back(value);
+            index = skip_white_space(index + 1, end);
+            if (index == end || *index != closing)
+            {
+                open.push_back(node_index);
+                continue;
+            }
+
+            // Empty objects and arrays are closed right away
+            index++;
+            result.nodes[node_index].source = result.nodes[node_index].text = std::string_view(value_start, (size_t)(index - value_start));
+            break;
+        }
+        case '"':
+            value.type = sjson::jtype::jstring;
+            value.text = result.read_string(index, end);
+            value.source = std::string_view(value_start, (size_t)(index - value_start));
+            result.nodes.push_back(value);
+            break;
+        case 't':
+        case 'f':
+        case 'n':
+        {
+            const char* literal = *index == 't' ? "true" : *index == 'f' ? "false" : "null";
+            const size_t length = strlen(literal);
+            if ((size_t)(end - index) < length || strncmp(index, literal, length) != 0) throw sjson::parsing_error("Input did not contain valid json");
+            index += length;
+            value.type = *value_start == 'n' ? sjson::jtype::jnull : sjson::jtype::jbool;
+            value.source = value.text = std::string_view(value_start, length);
+            result.nodes.push_back(value);
+            break;
+        }
+        default:
+        {
+            bool is_integer;
+            index = scan_number(index, end, is_integer);
+            value.type = sjson::jtype::jnumber;
+            value.source = value.text = std::string_view(value_start, (size_t)(index - value_start));
+            if (std::from_chars(value_start, index, value.number).ec != std::errc()) throw sjson::parsing_error("Input did not contain a valid number");
+            if (!is_integer || std::from_chars(value_start, index, value.integer).ec != std::errc()) value.integer = (int64_t)value.number;
+            result.nodes.push_back(value);
+            break;
+        }
+        }
+
+        // Close every object and array that ends after the value, until a comma asks for another value
+        while (true)
+        {
+            index = skip_white_space(index, end);
+            if (open.empty())
+            {
+                if (index != end) throw sjson::parsing_error("Unexpected characters after the root value");
+                result.index_children();
+                return result;
+            }
+
+            node& container = result.nodes[open.back()];
+            if (index == end) throw sjson::parsing_error("Unexpected end of input");
+            if (*index == ',')
+            {
+                index = skip_white_space(index + 1, end);
+                break;
+            }
+            if (*index != (container.type == sjson::jtype::jobject ? '}' : ']')) throw sjson::parsing_error("Expected ',' or a closing bracket");
+
+            index++;
+            container.source = container.text = std::string_view(container.source.data(), (size_t)(index - container.source.data()));
+            container.next = (uint32_t)result.nodes.size();
+            open.pop_back();
+        }
+    }
+}
+
+void sjson::document::index_children()
+{
+    // Every node but the root is the child of exactly one container, so this is linear in the number of nodes
+    this->children.reserve(this->nodes.size());
+    for (size_t i = 0; i < this->nodes.size(); i++)
+    {
+        node& container = this->nodes[i];
+        if (container.type != sjson::jtype::jobject && container.type != sjson::jtype::jarray) continue;
+        container.first_child = (uint32_t)this->children.size();
+        for (uint32_t child = (uint32_t)i + 1; child < container.next; child = this->nodes[child].next) this->children.push_back(child);
+    }
+}
+
+bool sjson::document::value::has_key(std::string_view key) const
+{
+    if (this->type() != sjson::jtype::jobject) return false;
+    for (const value member : *this) if (member.key() == key) return true;
+    return false;
+}
+
+sjson::document::value sjson::document::value::operator[](std::string_view key) const
+{
+    if (this->type() == sjson::jtype::jobject)
+    {
+        for (const value member : *this) if (member.key() == key) return member;
+    }
+    throw sjson::invalid_key(std::string(key));
+}
+
+sjson::document::value sjson::document::value::operator[](size_t index) const
+{
+    if (index >= this->size()) throw std::out_of_range("Index is out of range");
+    return value(this->source_document, this->source_document->children[this->get_node().first_child + index]);
+}
+
+double sjson::document::value::as_double() const
+{
+    if (this->type() != sjson::jtype::jnumber) throw std::invalid_argument("Value is not a number");
+    return this->get_node().number;
+}
+
+int64_t sjson::document::value::as_int64() const
+{
+    if (this->type() != sjson::jtype::jnumber) throw std::invalid_argument("Value is not a number");
+    return this->get_node().integer;
+}
+
+sjson::jobject sjson::document::value::as_object() const
+{
+    if (this->type() != sjson::jtype::jobject && this->type() != sjson::jtype::jarray) throw sjson::parsing_error("Input is not a valid object");
+    sjson::jobject result(this->type() == sjson::jtype::jarray);
+    result.data.reserve(this->size());
+    for (const value member : *this) result.data.push_back(sjson::kvp(std::string(member.key()), std::string(member.source())));
+    return result;
+}
+
+void sjson::reader::feed(const char* data, size_t size)
+{
+    const char* index = data;
+    const char* end = data + size;
+    while (index != end)
+    {
+        // Finish the token being read, which may have started in a previous chunk
+        switch (this->current)
+        {
+        case token::key:
+        case token::string:
+        {
+            const char* start = index;
+            while (index != end && (this->escaped || *index != '"'))
+            {
+                if (this->escaped) this->escaped = false;
+                else if (*index == '\\') this->escaped = this->has_escapes = true;
+                index++;
+            }
+            this->pending.append(start, index);
+            if (index == end) return;
+            index++;
+            this->end_token();
+            continue;
+        }
+        case token::number:
+        case token::literal:
+        {
+            const char* start = index;
+            if (this->current == token::number) while (index != end && (std::isdigit((unsigned char)*index) || *index == '-' || *index == '+' || *index == '.' || *index == 'e' || *index == 'E')) index++;
+            else while (index != end && std::isalpha((unsigned char)*index)) index++;
+            this->pending.append(start, index);
+            if (index == end) return;
+            this->end_token();
+            continue;
+        }
+        default:
+            break;
+        }
+
+        const char character = *index;
+        if (std::isspace((unsigned char)character))
+        {
+            index++;
+            continue;
+        }
+
+        switch (this->state)
+        {
+        case expect::value_or_end:
+        case expect::value:
+            if (this->state == expect::value_or_end && character == ']')
+            {
+                index++;
+                this->close();
+            }
+            else if (character == '{' || character == '[')
+            {
+                index++;
+                this->open.push_back(character);
+                if (character == '{') this->events.start_object();
+                else this->events.start_array();
+                this->state = character == '{' ? expect::key_or_end : expect::value_or_end;
+            }
+            else if (character == '"')
+            {
+                index++;
+                this->pending.clear();
+                this->escaped = this->has_escapes = false;
+                this->current = token::string;
+            }
+            else if (character == '-' || std::isdigit((unsigned char)character) || character == 't' || character == 'f' || character == 'n')
+            {
+                // The token loop above consumes the first character too
+                this->pending.clear();
+                this->current = character == '-' || std::isdigit((unsigned char)character) ? token::number : token::literal;
+            }
+            else throw sjson::parsing_error("Input did not contain valid json");
+            break;
+        case expect::key_or_end:
+        case expect::key:
+            if (this->state == expect::key_or_end && character == '}')
+            {
+                index++;
+                this->close();
+                break;
+            }
+            if (character != '"') throw sjson::parsing_error("Expected a key");
+            index++;
+            this->pending.clear();
+            this->escaped = this->has_escapes = false;
+            this->current = token::key;
+            break;
+        case expect::colon:
+            if (character != ':') throw sjson::parsing_error("Expected ':' after a key");
+            index++;
+            this->state = expect::value;
+            break;
+        case expect::comma_or_end:
+            if (character == ',') this->state = this->open.back() == '{' ? expect::key : expect::value;
+            else if (character == (this->open.back() == '{' ? '}' : ']')) this->close();
+            else throw sjson::parsing_error("Expected ',' or a closing bracket");
+            index++;
+            break;
+        case expect::nothing:
+            throw sjson::parsing_error("Unexpected characters after the root value");
+        }
+    }
+}
+
+void sjson::reader::finish()
+{
+    // Numbers and literals have no terminator of their own, so a root value may still be pending
+    if (this->current == token::number || this->current == token::literal) this->end_token();
+    const bool complete = this->current == token::none && this->state == expect::nothing;
+
+    // Get ready for another document
+    this->current = token::none;
+    this->state = expect::value;
+    this->open.clear();
+    if (!complete) throw sjson::parsing_error("Unexpected end of input");
+}
+
+void sjson::reader::parse(const source& input, sjson::handler& events, size_t chunk_size)
+{
+    std::vector<char> chunk(chunk_size);
+    sjson::reader reader(events);
+    while (size_t size = input(chunk.data(), chunk.size())) reader.feed(chunk.data(), size);
+    reader.finish();
+}
+
+void sjson::reader::parse(std::FILE* file, sjson::handler& events, size_t chunk_size)
+{
+    parse([file](char* buffer, size_t size) { return std::fread(buffer, 1, size, file); }, events, chunk_size);
+}
+
+void sjson::reader::end_token()
+{
+    const token finished = this->current;
+    this->current = token::none;
+    switch (finished)
+    {
+    case token::key:
+    case token::string:
+    {
+        std::string_view text = this->pending;
+        if (this->has_escapes)
+        {
+            this->decoded.resize(this->pending.size());
+            const char* index = this->pending.data();
+            const char* end = index + this->pending.size();
+            char* write = this->decoded.data();
+            while (index != end)
+            {
+                if (*index != '\\') *write++ = *index++;
+                else write = decode_escape(++index, end, write);
+            }
+            text = std::string_view(this->decoded.data(), (size_t)(write - this->decoded.data()));
+        }
+        if (finished == token::key)
+        {
+            this->events.key(text);
+            this->state = expect::colon;
+        }
+        else
+        {
+            this->events.string(text);
+            this->end_value();
+        }
+        break;
+    }
+    case token::number:
+    {
+        bool is_integer;
+        const char* begin = this->pending.data();
+        const char* end = begin + this->pending.size();
+        double number = 0.0;
+        if (scan_number(begin, end, is_integer) != end || std::from_chars(begin, end, number).ec != std::errc()) throw sjson::parsing_error("Input did not contain a valid number");
+        this->events.number(number, this->pending);
+        this->end_value();
+        break;
+    }
+    case token::literal:
+        if (this->pending == "true") this->events.boolean(true);
+        else if (this->pending == "false") this->events.boolean(false);
+        else if (this->pending == "null") this->events.null();
+        else throw sjson::parsing_error("Input did not contain valid json");
+        this->end_value();
+        break;
+    default:
+        break;
+    }
+}
+
+void sjson::reader::close()
+{
+    const char bracket = this->open.back();
+    this->open.pop_back();
+    if (bracket == '{') this->events.end_object();
+    else this->events.end_array();
+    this->end_value();
+}
+
+void sjson::reader::end_value()
+{
+    this->state = this->open.empty() ? expect::nothing : expect::comma_or_end;
+}
+
+sjson::writer::sink sjson::writer::file_sink(std::FILE* file)
+{
+    return [file](const char* data, size_t size) { std::fwrite(data, 1, size, file); };
+}
+
+void sjson::writer::separate()
+{
+    if (this->after_key)
+    {
+        this->after_key = false;
+        return;
+    }
+    if (this->counts.empty()) return;
+    if (this->counts.back()++ > 0) this->buffer += ',';
+    if (this->pretty)
+    {
+        this->buffer += '\n';
+        this->buffer.append(this->counts.size(), '\t');
+    }
+}
+
+void sjson::writer::close(char bracket)
+{
+    const size_t count = this->counts.back();
+    this->counts.pop_back();
+    if (this->pretty && count > 0)
+    {
+        this->buffer += '\n';
+        this->buffer.append(this->counts.size(), '\t');
+    }
+    this->buffer += bracket;
+    this->flush_if_full();
+}
+
+void sjson::writer::append_quoted(std::string_view value)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    this->buffer += '"';
+
+    // Characters that need no escaping are appended in runs
+    size_t run_start = 0;
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        const unsigned char character = (unsigned char)value[i];
+        if (character >= 0x20 && character != '"' && character != '\\') continue;
+        this->buffer.append(value.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (character)
+        {
+        case '"': this->buffer += "\\\""; break;
+        case '\\': this->buffer += "\\\\"; break;
+        case '\b': this->buffer += "\\b"; break;
+        case '\f': this->buffer += "\\f"; break;
+        case '\n': this->buffer += "\\n"; break;
+        case '\r': this->buffer += "\\r"; break;
+        case '\t': this->buffer += "\\t"; break;
+        default:
+            this->buffer += "\\u00";
+            this->buffer += hex_digits[character >> 4];
+            this->buffer += hex_digits[character & 0xF];
+            break;
+        }
+    }
+    this->buffer.append(value.data() + run_start, value.size() - run_start);
+    this->buffer += '"';
+}
+
+sjson::writer& sjson::writer::start_object()
+{
+    this->separate();
+    this->buffer += '{';
+    this->counts.push_back(0);
+    return *this;
+}
+
+sjson::writer& sjson::writer::end_object()
+{
+    this->close('}');
+    return *this;
+}
+
+sjson::writer& sjson::writer::start_array()
+{
+    this->separate();
+    this->buffer += '[';
+    this->counts.push_back(0);
+    return *this;
+}
+
+sjson::writer& sjson::writer::end_array()
+{
+    this->close(']');
+    return *this;
+}
+
+sjson::writer& sjson::writer::key(std::string_view key)
+{
+    this->separate();
+    this->append_quoted(key);
+    this->buffer += this->pretty ? ": " : ":";
+    this->after_key = true;
+    return *this;
+}
+
+sjson::writer& sjson::writer::string(std::string_view value)
+{
+    this->separate();
+    this->append_quoted(value);
+    this->flush_if_full();
+    return *this;
+}
+
+sjson::writer& sjson::writer::number(double value)
+{
+    // JSON has no representation for infinities and NaNs
+    if (value != value || value - value != 0.0) return this->null();
+
+    this->separate();
+    char text[32];
+    this->buffer.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+    this->flush_if_full();
+    return *this;
+}
+
+sjson::writer& sjson::writer::number(int64_t value)
+{
+    this->separate();
+    char text[24];
+    this->buffer.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+    this->flush_if_full();
+    return *this;
+}
+
+sjson::writer& sjson::writer::number(uint64_t value)
+{
+    this->separate();
+    char text[24];
+    this->buffer.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+    this->flush_if_full();
+    return *this;
+}
+
+sjson::writer& sjson::writer::boolean(bool value)
+{
+    this->separate();
+    this->buffer += value ? "true" : "false";
+    this->flush_if_full();
+    return *this;
+}
+
+sjson::writer& sjson::writer::null()
+{
+    this->separate();
+    this->buffer += "null";
+    this->flush_if_full();
+    return *this;
+}
+
+void sjson::writer::flush()
+{
+    if (!this->output || this->buffer.empty()) return;
+    this->output(this->buffer.data(), this->buffer.size());
+    this->buffer.clear();
+}
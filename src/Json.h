@@ -17,6 +17,10 @@
 #include <utility>
 #include <stdexcept>
 #include <cctype>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <functional>
 
  /*! \brief Base namespace for simpleson */
 namespace sjson
@@ -206,6 +210,8 @@ namespace sjson
 	 */
 	class jobject
 	{
+		friend class document;
+
 	private:
 		/*! \brief The container used to store the object's data */
 		std::vector<kvp> data;
@@ -297,7 +303,8 @@ namespace sjson
 
 		/*! \brief Parses a serialized JSON string
 		 *
-		 * @param input Serialized JSON string
+		 * \details The input is tokenized by json::document, then the serialized text of each member or element is copied into the returned object
+		 * @param input Serialized JSON string. Only white space may follow the object or array
 		 * @return JSON object or array
 		 * \exception json::parsing_error Thrown when the input string is not valid JSON
 		 */
@@ -851,6 +858,422 @@ namespace sjson
 		 */
 		std::string pretty(unsigned int indent_level = 0) const;
 	};
+
+	/*! \class document
+	 * \brief A parsed JSON document, tokenized in a single pass into a flat array of nodes
+	 *
+	 * \details Nodes are stored in document order, each container followed by its members or elements. Every node knows the index of the node that follows
+	 * its whole subtree, so moving to the next sibling is O(1), and every object and array lists the indices of its members or elements, so indexing them
+	 * is O(1) too. Keys and strings are views into buffers owned by the document: strings without escape sequences
+	 * point into the copy of the input, and the others are decoded once into a second buffer. Numbers are decoded with std::from_chars while tokenizing.
+	 * \note The document owns the memory all views point into, so values must not outlive it. Documents can be moved but not copied.
+	 */
+	class document
+	{
+	private:
+		/*! \brief A value of the document */
+		struct node
+		{
+			/*! \brief The type of the value */
+			jtype::jtype type;
+
+			/*! \brief The index of the first node after the value and all of its descendants */
+			uint32_t next;
+
+			/*! \brief The number of members or elements of an object or array */
+			uint32_t count;
+
+			/*! \brief The position of the first member or element of an object or array in children */
+			uint32_t first_child;
+
+			/*! \brief The key of the value if it is an object member, empty otherwise */
+			std::string_view key;
+
+			/*! \brief The decoded text of a string, or the serialized text of any other value */
+			std::string_view text;
+
+			/*! \brief The serialized text of the value, as it appears in the input */
+			std::string_view source;
+
+			/*! \brief The value of a number */
+			double number;
+
+			/*! \brief The value of a number, truncated if it is not an integer */
+			int64_t integer;
+		};
+
+		/*! \brief Copy of the input, keys and strings without escape sequences point into it */
+		std::unique_ptr<char[]> input;
+
+		/*! \brief Decoded keys and strings that contained escape sequences. Sized for the worst case so that it never reallocates */
+		std::unique_ptr<char[]> strings;
+
+		/*! \brief The number of characters used in strings */
+		size_t strings_size = 0;
+
+		/*! \brief The values of the document, in document order */
+		std::vector<node> nodes;
+
+		/*! \brief The node indices of the members or elements of every object and array, each container's in one contiguous run */
+		std::vector<uint32_t> children;
+
+		/*! \brief Fills children and the first_child of every object and array, once all nodes are known */
+		void index_children();
+
+		/*! \brief Reads the string starting at the quote index points to, and moves index past its closing quote
+		 *
+		 * @return A view of the decoded string
+		 * \exception json::parsing_error Thrown if the string is not terminated or contains an invalid escape sequence
+		 */
+		std::string_view read_string(const char*& index, const char* end);
+
+	public:
+		/*! \brief A lightweight reference to a value of a document */
+		class value
+		{
+		private:
+			/*! \brief The document the value belongs to */
+			const document* source_document;
+
+			/*! \brief The index of the node of the value */
+			uint32_t index;
+
+			/*! \brief Returns the node of the value */
+			inline const node& get_node() const { return this->source_document->nodes[this->index]; }
+
+		public:
+			/*! \brief Iterator over the members of an object or the elements of an array */
+			class iterator
+			{
+			private:
+				const document* source_document;
+				uint32_t index;
+
+			public:
+				inline iterator(const document* source_document, uint32_t index) : source_document(source_document), index(index) { }
+				inline value operator*() const { return value(this->source_document, this->index); }
+				inline iterator& operator++() { this->index = this->source_document->nodes[this->index].next; return *this; }
+				inline bool operator==(const iterator& other) const { return this->index == other.index; }
+				inline bool operator!=(const iterator& other) const { return this->index != other.index; }
+			};
+
+			/*! \brief Constructor
+			 *
+			 * @param source_document The document the value belongs to
+			 * @param index The index of the node of the value
+			 */
+			inline value(const document* source_document, uint32_t index) : source_document(source_document), index(index) { }
+
+			/*! \brief Returns the type of the value */
+			inline jtype::jtype type() const { return this->get_node().type; }
+
+			/*! \brief Returns the number of members or elements of an object or array, or 0 for any other value */
+			inline size_t size() const { return this->get_node().count; }
+
+			/*! \brief Returns the key of an object member, or an empty string for any other value */
+			inline std::string_view key() const { return this->get_node().key; }
+
+			/*! \brief Returns the serialized value, as it appears in the input */
+			inline std::string_view source() const { return this->get_node().source; }
+
+			/*! \brief Returns an iterator to the first member or element */
+			inline iterator begin() const { return iterator(this->source_document, this->index + 1); }
+
+			/*! \brief Returns an iterator past the last member or element */
+			inline iterator end() const { return iterator(this->source_document, this->get_node().next); }
+
+			/*! \brief Determines if an object contains a key
+			 *
+			 * \note If the value is not a JSON object, then this function will always return false
+			 */
+			bool has_key(std::string_view key) const;
+
+			/*! \brief Returns the member of an object associated with a key
+			 *
+			 * \exception json::invalid_key Exception thrown if the key does not exist or the value is not a JSON object
+			 */
+			value operator[](std::string_view key) const;
+
+			/*! \brief Returns the member of an object associated with a key */
+			inline value operator[](const char* key) const { return this->operator[](std::string_view(key)); }
+
+			/*! \brief Returns the element of an array or the member of an object at an index
+			 *
+			 * \exception std::out_of_range Exception thrown if the index is not smaller than size()
+			 */
+			value operator[](size_t index) const;
+
+			/*! \brief Returns the decoded text of a string, or the serialized text of any other value */
+			inline std::string_view as_string_view() const { return this->get_node().text; }
+
+			/*! \brief Returns the decoded text of a string, or the serialized text of any other value */
+			inline std::string as_string() const { return std::string(this->as_string_view()); }
+
+			/*! \brief Returns the value of a number
+			 *
+			 * \exception std::invalid_argument Exception thrown if the value is not a number
+			 */
+			double as_double() const;
+
+			/*! \brief Returns the value of a number as a float */
+			inline float as_float() const { return (float)this->as_double(); }
+
+			/*! \brief Returns the value of a number, truncated if it is not an integer
+			 *
+			 * \exception std::invalid_argument Exception thrown if the value is not a number
+			 */
+			int64_t as_int64() const;
+
+			/*! \brief Returns the value of a number as an integer */
+			inline int as_int() const { return (int)this->as_int64(); }
+
+			/*! \brief Returns the value of a number as an unsigned integer */
+			inline unsigned int as_uint() const { return (unsigned int)this->as_int64(); }
+
+			/*! \brief Returns true if the value is a boolean and set to true */
+			inline bool is_true() const { return this->type() == jtype::jbool && this->get_node().text == "true"; }
+
+			/*! \brief Returns true if the value is a null value */
+			inline bool is_null() const { return this->type() == jtype::jnull; }
+
+			/*! \brief Copies an object or array into a json::jobject
+			 *
+			 * \details The members or elements are stored serialized, as json::jobject expects
+			 * \exception json::parsing_error Thrown if the value is not a JSON object or array
+			 */
+			jobject as_object() const;
+		};
+
+		/*! \brief Default constructor, creates an empty document */
+		document() = default;
+
+		document(const document&) = delete;
+		document& operator=(const document&) = delete;
+		document(document&&) = default;
+		document& operator=(document&&) = default;
+
+		/*! \brief Parses a serialized JSON value
+		 *
+		 * @param input Serialized JSON value. Only white space may follow the value
+		 * @return The parsed document
+		 * \exception json::parsing_error Thrown when the input is not valid JSON
+		 */
+		static document parse(std::string_view input);
+
+		/*! \brief Returns the root value of the document
+		 *
+		 * \exception std::out_of_range Exception thrown if the document is empty
+		 */
+		inline value root() const
+		{
+			if (this->nodes.empty()) throw std::out_of_range("Document is empty");
+			return value(this, 0);
+		}
+	};
+
+	/*! \class handler
+	 * \brief Receives the events of a json::reader, in document order
+	 *
+	 * \details Views passed to the handler are only valid for the duration of the call. Every event does nothing by default.
+	 */
+	class handler
+	{
+	public:
+		/*! \brief Destructor */
+		inline virtual ~handler() { }
+
+		/*! \brief Called when an object starts */
+		virtual void start_object() { }
+
+		/*! \brief Called when an object ends */
+		virtual void end_object() { }
+
+		/*! \brief Called when an array starts */
+		virtual void start_array() { }
+
+		/*! \brief Called when an array ends */
+		virtual void end_array() { }
+
+		/*! \brief Called with the decoded key of an object member, before its value */
+		virtual void key(std::string_view key) { }
+
+		/*! \brief Called with the decoded text of a string value */
+		virtual void string(std::string_view value) { }
+
+		/*! \brief Called with the value of a number and its serialized text */
+		virtual void number(double value, std::string_view text) { }
+
+		/*! \brief Called with the value of a boolean */
+		virtual void boolean(bool value) { }
+
+		/*! \brief Called for a null value */
+		virtual void null() { }
+	};
+
+	/*! \class reader
+	 * \brief Event based JSON reader that parses its input one chunk at a time
+	 *
+	 * \details Chunks may end anywhere, even in the middle of a token. Only the token being read is buffered, so the memory used is bounded by the
+	 * longest string or number of the document and the nesting depth, not by the size of the document.
+	 */
+	class reader
+	{
+	public:
+		/*! \brief Fills buffer with at most size characters and returns how many were written, 0 once the input is exhausted */
+		typedef std::function<size_t(char* buffer, size_t size)> source;
+
+		/*! \brief Constructor
+		 *
+		 * @param events The handler receiving the events
+		 */
+		inline reader(sjson::handler& events) : events(events) { }
+
+		/*! \brief Parses the next chunk of the input
+		 *
+		 * \exception json::parsing_error Thrown when the input is not valid JSON
+		 */
+		void feed(const char* data, size_t size);
+
+		/*! \brief Signals the end of the input
+		 *
+		 * \exception json::parsing_error Thrown if the input ended before the root value was complete
+		 */
+		void finish();
+
+		/*! \brief Reads a whole input through a reusable buffer of chunk_size characters
+		 *
+		 * \exception json::parsing_error Thrown when the input is not valid JSON
+		 */
+		static void parse(const source& input, sjson::handler& events, size_t chunk_size = 64 * 1024);
+
+		/*! \brief Reads a file from its current position to its end
+		 *
+		 * \exception json::parsing_error Thrown when the input is not valid JSON
+		 */
+		static void parse(std::FILE* file, sjson::handler& events, size_t chunk_size = 64 * 1024);
+
+	private:
+		/*! \brief What the reader expects next, outside of tokens */
+		enum class expect { value, value_or_end, key, key_or_end, colon, comma_or_end, nothing };
+
+		/*! \brief The token being read, which may span several chunks */
+		enum class token { none, key, string, number, literal };
+
+		sjson::handler& events;
+		expect state = expect::value;
+		token current = token::none;
+
+		/*! \brief Whether the last character of a string token was an unescaped backslash */
+		bool escaped = false;
+
+		/*! \brief Whether the string token contains escape sequences */
+		bool has_escapes = false;
+
+		/*! \brief The characters of the token read so far */
+		std::string pending;
+
+		/*! \brief Buffer strings with escape sequences are decoded into */
+		std::string decoded;
+
+		/*! \brief The open objects ('{') and arrays ('[') */
+		std::vector<char> open;
+
+		/*! \brief Emits the token in pending and moves on to the next state */
+		void end_token();
+
+		/*! \brief Closes the innermost object or array */
+		void close();
+
+		/*! \brief Moves on to the next state after a complete value */
+		void end_value();
+	};
+
+	/*! \class writer
+	 * \brief Event based JSON writer that appends to a reusable buffer or streams to a sink
+	 *
+	 * \details Commas, colons and indentation are inserted as needed. The caller is responsible for matching starts and ends and for writing a key before
+	 * each member of an object.
+	 */
+	class writer
+	{
+	public:
+		/*! \brief Receives serialized text when the writer flushes */
+		typedef std::function<void(const char* data, size_t size)> sink;
+
+		/*! \brief Constructs a writer that appends to output, which can be cleared and reused between documents
+		 *
+		 * @param output The buffer to append to
+		 * @param pretty When true, members and elements are written on their own lines, indented with tabs
+		 */
+		inline writer(std::string& output, bool pretty = false) : buffer(output), pretty(pretty) { }
+
+		/*! \brief Constructs a writer that streams to a sink whenever flush_size characters are buffered, and when flushed or destroyed
+		 *
+		 * @param output The sink receiving the serialized text
+		 * @param pretty When true, members and elements are written on their own lines, indented with tabs
+		 * @param flush_size How many characters to buffer before passing them on
+		 */
+		inline writer(sink output, bool pretty = false, size_t flush_size = 64 * 1024)
+			: buffer(owned_buffer), output(std::move(output)), pretty(pretty), flush_size(flush_size)
+		{
+			this->owned_buffer.reserve(flush_size);
+		}
+
+		/*! \brief Destructor, flushes the buffered text to the sink */
+		inline ~writer() { this->flush(); }
+
+		writer(const writer&) = delete;
+		writer& operator=(const writer&) = delete;
+
+		/*! \brief Returns a sink that writes to a file */
+		static sink file_sink(std::FILE* file);
+
+		writer& start_object();
+		writer& end_object();
+		writer& start_array();
+		writer& end_array();
+		writer& key(std::string_view key);
+		writer& string(std::string_view value);
+		writer& number(double value);
+		writer& number(int64_t value);
+		writer& number(uint64_t value);
+		inline writer& number(int value) { return this->number((int64_t)value); }
+		inline writer& number(unsigned int value) { return this->number((uint64_t)value); }
+		writer& boolean(bool value);
+		writer& null();
+
+		/*! \brief Passes the buffered text on to the sink, if the writer has one */
+		void flush();
+
+	private:
+		/*! \brief Buffer used when the writer streams to a sink */
+		std::string owned_buffer;
+
+		/*! \brief The buffer the text is appended to */
+		std::string& buffer;
+
+		sink output;
+		bool pretty;
+		size_t flush_size = 0;
+
+		/*! \brief The number of members or elements written to each open object or array */
+		std::vector<size_t> counts;
+
+		/*! \brief Whether a key was just written, in which case its value follows without a separator */
+		bool after_key = false;
+
+		/*! \brief Writes the separator and indentation that go before a value or key */
+		void separate();
+
+		/*! \brief Writes the indentation that goes before a closing bracket and closes the innermost object or array */
+		void close(char bracket);
+
+		/*! \brief Appends a quoted and escaped string */
+		void append_quoted(std::string_view value);
+
+		/*! \brief Flushes if enough text is buffered */
+		inline void flush_if_full() { if (this->output && this->buffer.size() >= this->flush_size) this->flush(); }
+	};
 }
 
 #endif // !JSON_H
\ No newline at end of file
@@ -20,6 +20,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <array>
 #include <string>
 #include <algorithm>
 #include <chrono>
@@ -27,17 +28,40 @@
 #include <optional>
 #include <filesystem>
 #include <map>
+#include <deque>
+#include <tuple>
+#include <sstream>
+#include <memory>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <bitset>
+#include <charconv>
+#include <random>
+#include <cfloat>
+#include <immintrin.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
 #include <tinygltf/tiny_gltf.h>
 #include <vulkan/vulkan.h>
 #include <Json.h>
 #include <nuklear/nuklear.h>
 #include <nuklear/nuklear_glfw_vulkan.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <sys/inotify.h>
+#endif
+
 using namespace std::chrono_literals;
 
 namespace Engine {
@@ -61,27 +85,433 @@ namespace Engine {
 		}
 	};
 
+	/**
+	 * @brief How important a log message is.
+	 */
+	enum class LogLevel : uint8_t {
+		Debug,
+		Info,
+		Warning,
+		Error
+	};
+
+	/**
+	 * @brief Asynchronous logger. Every thread writes its messages to a ring buffer of its own, without locking and without formatting them: a message
+	 * is stored as a pointer to its format string, which must be a string literal, followed by its arguments. A background thread takes the messages out
+	 * of the rings, formats them and writes them to the console and to the log file, so logging never waits for I/O. When a thread's ring is full its
+	 * messages are counted and dropped rather than waiting for room.
+	 * Format strings have a {} for each argument, e.g. Logger::Warning("failed loading {} in {} ms", path, milliseconds).
+	 */
 	class Logger : public Singleton<Logger> {
 	public:
-		static void Log(const char* message) {
-			std::cout << message << std::endl;
+
+		/**
+		 * @brief Messages below this level are compiled out.
+		 */
+#ifdef NDEBUG
+		static constexpr LogLevel _compiledLevel = LogLevel::Info;
+#else
+		static constexpr LogLevel _compiledLevel = LogLevel::Debug;
+#endif
+
+		Logger() {
+			_startTime = std::chrono::steady_clock::now();
+			_drainThread = std::thread(&Logger::Drain, this);
+		}
+
+		~Logger() {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_isStopping = true;
+			}
+			_condition.notify_all();
+			_drainThread.join();
+			if (_pFile != nullptr) fclose(_pFile);
+		}
+
+		template<size_t N, typename... Args>
+		static void Debug(const char(&format)[N], const Args&... arguments) {
+			Log<LogLevel::Debug>(format, arguments...);
+		}
+
+		template<size_t N, typename... Args>
+		static void Info(const char(&format)[N], const Args&... arguments) {
+			Log<LogLevel::Info>(format, arguments...);
+		}
+
+		template<size_t N, typename... Args>
+		static void Warning(const char(&format)[N], const Args&... arguments) {
+			Log<LogLevel::Warning>(format, arguments...);
+		}
+
+		template<size_t N, typename... Args>
+		static void Error(const char(&format)[N], const Args&... arguments) {
+			Log<LogLevel::Error>(format, arguments...);
+		}
+
+		/**
+		 * @brief Logs a message if level is at least both the compiled level and the level set with SetLevel. Numbers, booleans, enums, strings and paths
+		 * can be passed as arguments; strings and paths are copied, so they do not need to outlive the call.
+		 */
+		template<LogLevel level, size_t N, typename... Args>
+		static void Log(const char(&format)[N], const Args&... arguments) {
+			if constexpr (level >= _compiledLevel) {
+				auto& logger = Instance();
+				if (level < logger._level.load(std::memory_order_relaxed)) return;
+				logger.Write(level, format, ToArgument(arguments)...);
+			}
+		}
+
+		/**
+		 * @brief Sets the lowest level of the messages that are logged. Safe to call from any thread.
+		 */
+		void SetLevel(LogLevel level) {
+			_level.store(level, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Writes the messages logged from now on to the file at absolutePath as well, either as text or in the binary format described at WriteBinary.
+		 * Returns false if the file cannot be created.
+		 */
+		bool OpenFile(const std::filesystem::path& absolutePath, bool isBinary) {
+			std::error_code error;
+			std::filesystem::create_directories(absolutePath.parent_path(), error);
+			auto pFile = fopen(absolutePath.string().c_str(), isBinary ? "wb" : "w");
+			if (pFile == nullptr) return false;
+			if (isBinary) {
+				uint32_t version = 1;
+				fwrite("CLOG", 1, 4, pFile);
+				fwrite(&version, sizeof(version), 1, pFile);
+			}
+
+			std::lock_guard<std::mutex> lock(_fileMutex);
+			if (_pFile != nullptr) fclose(_pFile);
+			_pFile = pFile;
+			_isFileBinary = isBinary;
+			_formatIds.clear();
+			return true;
+		}
+
+		/**
+		 * @brief Blocks until every message logged before the call has been written out.
+		 */
+		void Flush() {
+			std::unique_lock<std::mutex> lock(_mutex);
+			auto flushRequest = ++_flushRequest;
+			_condition.notify_all();
+			_condition.wait(lock, [this, flushRequest]() { return _flushed >= flushRequest; });
+		}
+
+	private:
+
+		enum class ArgumentType : uint8_t {
+			Int,
+			UInt,
+			Float,
+			Bool,
+			String
+		};
+
+		/**
+		 * @brief Stored in the ring before the arguments of each message.
+		 */
+		struct RecordHeader {
+			const char* _format;
+			uint64_t _timeNanoseconds;
+			uint32_t _argumentsSizeBytes;
+			LogLevel _level;
+		};
+
+		/**
+		 * @brief Ring buffer written by one thread and read by the drain thread. The positions only ever grow, the bytes they refer to are at position % _sizeBytes.
+		 */
+		struct Ring {
+			static constexpr size_t _sizeBytes = 64 * 1024;
+			unsigned char _data[_sizeBytes];
+			std::atomic<uint64_t> _writePosition = 0;
+			std::atomic<uint64_t> _readPosition = 0;
+			std::atomic<uint64_t> _droppedCount = 0;
+			std::atomic<bool> _isAbandoned = false;
+			uint32_t _threadIndex = 0;
+
+			void Write(uint64_t position, const void* pData, size_t sizeBytes) {
+				auto offset = position % _sizeBytes;
+				auto firstSizeBytes = std::min(sizeBytes, _sizeBytes - offset);
+				memcpy(_data + offset, pData, firstSizeBytes);
+				memcpy(_data, (const unsigned char*)pData + firstSizeBytes, sizeBytes - firstSizeBytes);
+			}
+
+			void Read(uint64_t position, void* pData, size_t sizeBytes) const {
+				auto offset = position % _sizeBytes;
+				auto firstSizeBytes = std::min(sizeBytes, _sizeBytes - offset);
+				memcpy(pData, _data + offset, firstSizeBytes);
+				memcpy((unsigned char*)pData + firstSizeBytes, _data, sizeBytes - firstSizeBytes);
+			}
+		};
+
+		/**
+		 * @brief Owns the calling thread's reference to its ring, and tells the drain thread it can let go of the ring once the thread exits.
+		 */
+		struct ThreadRing {
+			std::shared_ptr<Ring> _pRing;
+
+			~ThreadRing() {
+				if (_pRing) _pRing->_isAbandoned.store(true, std::memory_order_release);
+			}
+		};
+
+		/**
+		 * @brief A message taken out of a ring, waiting to be written in time order with the messages of the other threads.
+		 */
+		struct DrainedRecord {
+			RecordHeader _header;
+			uint32_t _threadIndex;
+			size_t _argumentsOffset;
+		};
+
+		std::atomic<LogLevel> _level = LogLevel::Debug;
+		std::chrono::steady_clock::time_point _startTime;
+		std::thread _drainThread;
+
+		/**
+		 * @brief Guards the list of rings and the flush and stop requests. Never taken when logging, except for the first message of each thread.
+		 */
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		std::vector<std::shared_ptr<Ring>> _rings;
+		uint32_t _nextThreadIndex = 0;
+		uint64_t _flushRequest = 0;
+		uint64_t _flushed = 0;
+		bool _isStopping = false;
+
+		/**
+		 * @brief Guards the log file, and is held while writing messages out.
+		 */
+		std::mutex _fileMutex;
+		FILE* _pFile = nullptr;
+		bool _isFileBinary = false;
+
+		/**
+		 * @brief Ids the format strings have in the binary log file. Only used by the drain thread.
+		 */
+		std::map<const char*, uint32_t> _formatIds;
+
+		template<typename T>
+		static auto ToArgument(const T& argument) {
+			if constexpr (std::is_same_v<T, bool>) return argument;
+			else if constexpr (std::is_enum_v<T>) return (int64_t)argument;
+			else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) return (int64_t)argument;
+			else if constexpr (std::is_integral_v<T>) return (uint64_t)argument;
+			else if constexpr (std::is_floating_point_v<T>) return (double)argument;
+			else if constexpr (std::is_same_v<T, std::filesystem::path>) return argument.string();
+			else return std::string_view(argument);
+		}
+
+		static size_t GetEncodedSize(bool) { return 1 + sizeof(uint8_t); }
+		static size_t GetEncodedSize(int64_t) { return 1 + sizeof(int64_t); }
+		static size_t GetEncodedSize(uint64_t) { return 1 + sizeof(uint64_t); }
+		static size_t GetEncodedSize(double) { return 1 + sizeof(double); }
+		static size_t GetEncodedSize(std::string_view value) { return 1 + sizeof(uint32_t) + value.size(); }
+
+		static void Encode(Ring& ring, uint64_t& position, ArgumentType type, const void* pValue, size_t sizeBytes) {
+			ring.Write(position, &type, 1);
+			ring.Write(position + 1, pValue, sizeBytes);
+			position += 1 + sizeBytes;
+		}
+
+		static void Encode(Ring& ring, uint64_t& position, bool value) { uint8_t byte = value; Encode(ring, position, ArgumentType::Bool, &byte, sizeof(byte)); }
+		static void Encode(Ring& ring, uint64_t& position, int64_t value) { Encode(ring, position, ArgumentType::Int, &value, sizeof(value)); }
+		static void Encode(Ring& ring, uint64_t& position, uint64_t value) { Encode(ring, position, ArgumentType::UInt, &value, sizeof(value)); }
+		static void Encode(Ring& ring, uint64_t& position, double value) { Encode(ring, position, ArgumentType::Float, &value, sizeof(value)); }
+
+		static void Encode(Ring& ring, uint64_t& position, std::string_view value) {
+			auto sizeBytes = (uint32_t)value.size();
+			Encode(ring, position, ArgumentType::String, &sizeBytes, sizeof(sizeBytes));
+			ring.Write(position, value.data(), value.size());
+			position += value.size();
+		}
+
+		Ring& GetThreadRing() {
+			thread_local ThreadRing threadRing;
+			if (!threadRing._pRing) {
+				threadRing._pRing = std::make_shared<Ring>();
+				std::lock_guard<std::mutex> lock(_mutex);
+				threadRing._pRing->_threadIndex = _nextThreadIndex++;
+				_rings.push_back(threadRing._pRing);
+			}
+			return *threadRing._pRing;
+		}
+
+		template<typename... Args>
+		void Write(LogLevel level, const char* format, const Args&... arguments) {
+			auto& ring = GetThreadRing();
+			RecordHeader header{ format, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _startTime).count(), (uint32_t)(0 + ... + GetEncodedSize(arguments)), level };
+			auto writePosition = ring._writePosition.load(std::memory_order_relaxed);
+			auto freeBytes = Ring::_sizeBytes - (writePosition - ring._readPosition.load(std::memory_order_acquire));
+			if (sizeof(header) + header._argumentsSizeBytes > freeBytes) {
+				ring._droppedCount.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			auto position = writePosition;
+			ring.Write(position, &header, sizeof(header));
+			position += sizeof(header);
+			(Encode(ring, position, arguments), ...);
+			ring._writePosition.store(position, std::memory_order_release);
 		}
 
-		static void Log(std::string message) {
-			std::cout << message << std::endl;
+		static const char* GetName(LogLevel level) {
+			switch (level) {
+			case LogLevel::Debug: return "debug";
+			case LogLevel::Info: return "info";
+			case LogLevel::Warning: return "warning";
+			default: return "error";
+			}
 		}
 
-		static void Log(const wchar_t* message) {
-			std::wcout << message << std::endl;
+		/**
+		 * @brief Formats the message of a record, replacing each {} in the format string with the next argument.
+		 */
+		static void Format(const char* format, const unsigned char* pArguments, const unsigned char* pArgumentsEnd, std::string& outText) {
+			char number[32];
+			for (auto pCharacter = format; *pCharacter != 0; ++pCharacter) {
+				if (pCharacter[0] != '{' || pCharacter[1] != '}' || pArguments >= pArgumentsEnd) {
+					outText += *pCharacter;
+					continue;
+				}
+				++pCharacter;
+
+				auto type = (ArgumentType)*pArguments++;
+				switch (type) {
+				case ArgumentType::Int: { int64_t value; memcpy(&value, pArguments, sizeof(value)); pArguments += sizeof(value); snprintf(number, sizeof(number), "%lld", (long long)value); outText += number; break; }
+				case ArgumentType::UInt: { uint64_t value; memcpy(&value, pArguments, sizeof(value)); pArguments += sizeof(value); snprintf(number, sizeof(number), "%llu", (unsigned long long)value); outText += number; break; }
+				case ArgumentType::Float: { double value; memcpy(&value, pArguments, sizeof(value)); pArguments += sizeof(value); snprintf(number, sizeof(number), "%g", value); outText += number; break; }
+				case ArgumentType::Bool: outText += *pArguments++ ? "true" : "false"; break;
+				case ArgumentType::String: {
+					uint32_t sizeBytes;
+					memcpy(&sizeBytes, pArguments, sizeof(sizeBytes));
+					pArguments += sizeof(sizeBytes);
+					outText.append((const char*)pArguments, sizeBytes);
+					pArguments += sizeBytes;
+					break;
+				}
+				}
+			}
 		}
 
-		static void Log(const std::wstring message) {
-			std::wcout << message << std::endl;
+		/**
+		 * @brief Writes a record to the binary log file. The file starts with "CLOG" and a uint32 version, followed by records that each start with a byte
+		 * telling what they are:
+		 * 0: a format string, the first time it is used: uint32 id, uint8 level, uint32 size, then the characters.
+		 * 1: a message: uint32 format id, uint64 nanoseconds since the logger started, uint32 thread index, uint32 size of the arguments, then the arguments,
+		 * each a byte for its ArgumentType followed by its value; strings are a uint32 size followed by the characters.
+		 * 2: dropped messages: uint32 thread index, uint64 how many messages were dropped.
+		 */
+		void WriteBinary(const DrainedRecord& record, const unsigned char* pArguments) {
+			uint8_t recordType = 0;
+			auto formatId = _formatIds.find(record._header._format);
+			if (formatId == _formatIds.end()) {
+				formatId = _formatIds.emplace(record._header._format, (uint32_t)_formatIds.size()).first;
+				auto sizeBytes = (uint32_t)strlen(record._header._format);
+				fwrite(&recordType, 1, 1, _pFile);
+				fwrite(&formatId->second, sizeof(uint32_t), 1, _pFile);
+				fwrite(&record._header._level, 1, 1, _pFile);
+				fwrite(&sizeBytes, sizeof(sizeBytes), 1, _pFile);
+				fwrite(record._header._format, 1, sizeBytes, _pFile);
+			}
+
+			recordType = 1;
+			fwrite(&recordType, 1, 1, _pFile);
+			fwrite(&formatId->second, sizeof(uint32_t), 1, _pFile);
+			fwrite(&record._header._timeNanoseconds, sizeof(uint64_t), 1, _pFile);
+			fwrite(&record._threadIndex, sizeof(uint32_t), 1, _pFile);
+			fwrite(&record._header._argumentsSizeBytes, sizeof(uint32_t), 1, _pFile);
+			fwrite(pArguments, 1, record._header._argumentsSizeBytes, _pFile);
+		}
+
+		/**
+		 * @brief Body of the drain thread. Wakes up every few milliseconds, or when a flush is requested, and writes out whatever the rings hold.
+		 */
+		void Drain() {
+			std::vector<DrainedRecord> records;
+			std::vector<unsigned char> arguments;
+			std::string text;
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (true) {
+				_condition.wait_for(lock, 10ms, [this]() { return _isStopping || _flushRequest > _flushed; });
+				auto flushRequest = _flushRequest;
+				auto isStopping = _isStopping;
+				auto rings = _rings;
+				lock.unlock();
+
+				// Take every message out of the rings first, then write them out ordered by time.
+				records.clear();
+				arguments.clear();
+				std::vector<std::pair<uint32_t, uint64_t>> droppedCounts;
+				for (auto& pRing : rings) {
+					auto readPosition = pRing->_readPosition.load(std::memory_order_relaxed);
+					auto writePosition = pRing->_writePosition.load(std::memory_order_acquire);
+					while (readPosition < writePosition) {
+						DrainedRecord record{ {}, pRing->_threadIndex, arguments.size() };
+						pRing->Read(readPosition, &record._header, sizeof(record._header));
+						arguments.resize(arguments.size() + record._header._argumentsSizeBytes);
+						pRing->Read(readPosition + sizeof(record._header), arguments.data() + record._argumentsOffset, record._header._argumentsSizeBytes);
+						readPosition += sizeof(record._header) + record._header._argumentsSizeBytes;
+						records.push_back(record);
+					}
+					pRing->_readPosition.store(readPosition, std::memory_order_release);
+
+					auto droppedCount = pRing->_droppedCount.exchange(0, std::memory_order_relaxed);
+					if (droppedCount > 0) droppedCounts.emplace_back(pRing->_threadIndex, droppedCount);
+				}
+				std::stable_sort(records.begin(), records.end(), [](const DrainedRecord& a, const DrainedRecord& b) { return a._header._timeNanoseconds < b._header._timeNanoseconds; });
+
+				std::unique_lock<std::mutex> fileLock(_fileMutex);
+				for (auto& record : records) {
+					auto pArguments = arguments.data() + record._argumentsOffset;
+					text.clear();
+					char prefix[64];
+					snprintf(prefix, sizeof(prefix), "[%10.3f] [%s] [%u] ", record._header._timeNanoseconds * 1e-9, GetName(record._header._level), record._threadIndex);
+					text += prefix;
+					Format(record._header._format, pArguments, pArguments + record._header._argumentsSizeBytes, text);
+					text += '\n';
+					fputs(text.c_str(), record._header._level >= LogLevel::Warning ? stderr : stdout);
+					if (_pFile == nullptr) continue;
+					if (_isFileBinary) WriteBinary(record, pArguments);
+					else fputs(text.c_str(), _pFile);
+				}
+				for (auto& [threadIndex, droppedCount] : droppedCounts) {
+					auto message = "[warning] [" + std::to_string(threadIndex) + "] " + std::to_string(droppedCount) + " messages dropped, the thread's log ring was full\n";
+					fputs(message.c_str(), stderr);
+					if (_pFile == nullptr) continue;
+					if (!_isFileBinary) fputs(message.c_str(), _pFile);
+					else {
+						uint8_t recordType = 2;
+						fwrite(&recordType, 1, 1, _pFile);
+						fwrite(&threadIndex, sizeof(threadIndex), 1, _pFile);
+						fwrite(&droppedCount, sizeof(droppedCount), 1, _pFile);
+					}
+				}
+				fflush(stdout);
+				if (_pFile != nullptr) fflush(_pFile);
+				fileLock.unlock();
+
+				// Rings of threads that have exited are let go once they are empty.
+				lock.lock();
+				std::erase_if(_rings, [](const std::shared_ptr<Ring>& pRing) {
+					return pRing->_isAbandoned.load(std::memory_order_acquire) && pRing->_readPosition.load(std::memory_order_relaxed) == pRing->_writePosition.load(std::memory_order_acquire);
+				});
+
+				_flushed = flushRequest;
+				_condition.notify_all();
+				if (isStopping) return;
+			}
 		}
 	};
 
 	void Exit(int errorCode, const char* message) {
-		Logger::Log(message);
+		Logger::Error("{}", message);
+		Logger::Instance().Flush();
 		throw std::exception(message);
 		std::exit(errorCode);
 	}
@@ -244,23 +674,52 @@ namespace Engine {
 		}
 
 		/**
-		 * @brief Reads an ASCII or UNICODE text file.
-		 * @param absolutePath
-		 * @return The text the file contains as a std::string.
-		 */
-		static std::string GetFileText(std::filesystem::path absolutePath) {
-			std::fstream textFile{ absolutePath, std::ios::in };
-			std::string fileText{};
-
-			if (textFile.is_open()) {
-				char nextChar = textFile.get();
-
-				while (nextChar >= 0) {
-					fileText += nextChar;
-					nextChar = textFile.get();
+		 * @brief 64 bit xxHash (XXH64) of a block of memory. Fast enough to hash whole asset files at disk speed.
+		 */
+		static uint64_t Hash64(const void* pData, size_t sizeBytes, uint64_t seed = 0) {
+			const uint64_t prime1 = 11400714785074694791ull;
+			const uint64_t prime2 = 14029467366897019727ull;
+			const uint64_t prime3 = 1609587929392839161ull;
+			const uint64_t prime4 = 9650029242287828579ull;
+			const uint64_t prime5 = 2870177450012600261ull;
+			auto rotateLeft = [](uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); };
+			auto mixRound = [&](uint64_t accumulator, uint64_t input) { return rotateLeft(accumulator + input * prime2, 31) * prime1; };
+			auto read64 = [](const unsigned char* p) { uint64_t value; memcpy(&value, p, sizeof(value)); return value; };
+			auto read32 = [](const unsigned char* p) { uint32_t value; memcpy(&value, p, sizeof(value)); return value; };
+
+			auto p = (const unsigned char*)pData;
+			auto pEnd = p + sizeBytes;
+			uint64_t hash;
+
+			if (sizeBytes >= 32) {
+				uint64_t v1 = seed + prime1 + prime2;
+				uint64_t v2 = seed + prime2;
+				uint64_t v3 = seed;
+				uint64_t v4 = seed - prime1;
+				for (; p + 32 <= pEnd; p += 32) {
+					v1 = mixRound(v1, read64(p));
+					v2 = mixRound(v2, read64(p + 8));
+					v3 = mixRound(v3, read64(p + 16));
+					v4 = mixRound(v4, read64(p + 24));
 				}
+				hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+				for (auto v : { v1, v2, v3, v4 }) hash = (hash ^ mixRound(0, v)) * prime1 + prime4;
+			}
+			else {
+				hash = seed + prime5;
 			}
-			return fileText;
+			hash += (uint64_t)sizeBytes;
+
+			for (; p + 8 <= pEnd; p += 8) hash = rotateLeft(hash ^ mixRound(0, read64(p)), 27) * prime1 + prime4;
+			if (p + 4 <= pEnd) { hash = rotateLeft(hash ^ (read32(p) * prime1), 23) * prime2 + prime3; p += 4; }
+			for (; p < pEnd; ++p) hash = rotateLeft(hash ^ (*p * prime5), 11) * prime1;
+
+			hash ^= hash >> 33;
+			hash *= prime2;
+			hash ^= hash >> 29;
+			hash *= prime3;
+			hash ^= hash >> 32;
+			return hash;
 		}
 
 		static void SaveImageAsPng(std::filesystem::path absolutePath, void* data, uint32_t width, uint32_t height) {
@@ -295,2713 +754,4823 @@ namespace Engine {
 		}
 	};
 
-	class GlobalSettings : public Singleton<GlobalSettings> {
+	/**
+	 * @brief Read-only view of a whole file mapped into the address space of the process. Pages are loaded by the OS on first access,
+	 * so opening a file costs no reads, and the data can be handed to Vulkan upload functions without copying it into intermediate buffers first.
+	 * The file stays mapped until Close is called or the object is destroyed.
+	 */
+	class MappedFile {
 	public:
 
 		/**
-		 * @brief Flag for enabling or disabling validation layers when the Vulkan instance is created.
+		 * @brief First byte of the file, or nullptr if no file is mapped.
 		 */
-		bool _enableValidationLayers;
+		const unsigned char* _pData = nullptr;
 
 		/**
-		 * @brief Instance validation layers to report problems with Vulkan usage.
+		 * @brief Size of the file in bytes.
 		 */
-		std::vector<const char*> _pValidationLayers;
+		size_t _sizeBytes = 0;
+
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { Close(); }
 
 		/**
-		 * @brief Window width in pixels.
+		 * @brief Maps the file at the given path. Returns false if the file does not exist, is empty or cannot be mapped.
 		 */
-		uint32_t _windowWidth;
+		bool Open(const std::filesystem::path& absolutePath) {
+			Close();
+#ifdef _WIN32
+			_file = CreateFileW(absolutePath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (_file == INVALID_HANDLE_VALUE) return false;
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) { Close(); return false; }
+
+			_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (_mapping == nullptr) { Close(); return false; }
+
+			_pData = (const unsigned char*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+			if (_pData == nullptr) { Close(); return false; }
+			_sizeBytes = (size_t)size.QuadPart;
+#else
+			_file = open(absolutePath.string().c_str(), O_RDONLY);
+			if (_file < 0) return false;
+
+			struct stat fileStatus;
+			if (fstat(_file, &fileStatus) != 0 || fileStatus.st_size == 0) { Close(); return false; }
+
+			auto pMapped = mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, _file, 0);
+			if (pMapped == MAP_FAILED) { Close(); return false; }
+			_pData = (const unsigned char*)pMapped;
+			_sizeBytes = (size_t)fileStatus.st_size;
+#endif
+			return true;
+		}
 
 		/**
-		 * @brief Window height in pixels.
-		 */
-		uint32_t _windowHeight;
+		 * @brief Hints the OS that the given range of the file will be read soon, so that it starts loading its pages in the background instead of
+		 * one page fault at a time. The whole file is prefetched by default.
+		 */
+		void WillNeed(size_t offset = 0, size_t sizeBytes = SIZE_MAX) const {
+			if (_pData == nullptr || offset >= _sizeBytes) return;
+			sizeBytes = std::min(sizeBytes, _sizeBytes - offset);
+#ifdef _WIN32
+			WIN32_MEMORY_RANGE_ENTRY range{ (void*)(_pData + offset), sizeBytes };
+			PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+			// madvise needs a page aligned address.
+			auto pageSize = (size_t)sysconf(_SC_PAGESIZE);
+			auto alignedOffset = offset / pageSize * pageSize;
+			madvise((void*)(_pData + alignedOffset), sizeBytes + offset - alignedOffset, MADV_WILLNEED);
+#endif
+		}
+
+		void Close() {
+#ifdef _WIN32
+			if (_pData != nullptr) UnmapViewOfFile(_pData);
+			if (_mapping != nullptr) CloseHandle(_mapping);
+			if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+			_mapping = nullptr;
+			_file = INVALID_HANDLE_VALUE;
+#else
+			if (_pData != nullptr) munmap((void*)_pData, _sizeBytes);
+			if (_file >= 0) close(_file);
+			_file = -1;
+#endif
+			_pData = nullptr;
+			_sizeBytes = 0;
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE _file = INVALID_HANDLE_VALUE;
+		HANDLE _mapping = nullptr;
+#else
+		int _file = -1;
+#endif
+	};
+
+	/**
+	 * @brief Whole file reads, for files that are needed in memory all at once, such as settings and SPIR-V. The size of the file is queried first and the file
+	 * is read straight into a buffer of that size, in as few reads as the OS allows. Large files that are only partially read should use MappedFile instead.
+	 */
+	class FileIO {
+	public:
 
 		/**
-		 * @brief Mouse sensitivity multiplier.
-		 */
-		float _mouseSensitivity;
+		 * @brief Reads the whole file into outData, which is resized to the size of the file. T is a contiguous container of bytes, such as std::string
+		 * or std::vector<char>. Returns false and leaves outData empty if the file cannot be opened or read.
+		 */
+		template<typename T>
+		static bool ReadAll(const std::filesystem::path& absolutePath, T& outData) {
+			static_assert(sizeof(typename T::value_type) == 1, "ReadAll reads into containers of bytes");
+			outData.clear();
+			auto isRead = false;
+#ifdef _WIN32
+			auto file = CreateFileW(absolutePath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return false;
+
+			LARGE_INTEGER size;
+			isRead = GetFileSizeEx(file, &size) != 0;
+			if (isRead) {
+				outData.resize((size_t)size.QuadPart);
+				for (size_t offset = 0; isRead && offset < outData.size();) {
+					DWORD readBytes = 0;
+					auto chunkBytes = (DWORD)std::min<size_t>(outData.size() - offset, 1ull << 30);
+					isRead = ReadFile(file, (char*)outData.data() + offset, chunkBytes, &readBytes, nullptr) && readBytes > 0;
+					offset += readBytes;
+				}
+			}
+			CloseHandle(file);
+#else
+			auto file = open(absolutePath.string().c_str(), O_RDONLY);
+			if (file < 0) return false;
+
+			struct stat fileStatus;
+			isRead = fstat(file, &fileStatus) == 0;
+			if (isRead) {
+#ifdef POSIX_FADV_SEQUENTIAL
+				posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+				outData.resize((size_t)fileStatus.st_size);
+				for (size_t offset = 0; isRead && offset < outData.size();) {
+					auto readBytes = read(file, (char*)outData.data() + offset, outData.size() - offset);
+					if (readBytes < 0 && errno == EINTR) continue;
+					isRead = readBytes > 0;
+					if (isRead) offset += (size_t)readBytes;
+				}
+			}
+			close(file);
+#endif
+			if (!isRead) outData.clear();
+			return isRead;
+		}
+	};
+
+	class Vertex;
+
+	/**
+	 * @brief Describes how vertices are stored in vertex buffers. The CPU always keeps full precision vertices (see Vertex) for physics and collision detection,
+	 * while vertex buffers store them in the formats chosen here, which are converted back to floats by the vertex input stage and the vertex shader.
+	 * Attributes are tightly packed in the order position, normal, UV, at shader locations 0, 1 and 2.
+	 */
+	class VertexLayout {
+	public:
+
+		enum class PositionFormat {
+			/**
+			 * @brief 3 32 bit floats.
+			 */
+			Float32,
+
+			/**
+			 * @brief 4 16 bit floats, the 4th is padding.
+			 */
+			Half,
+
+			/**
+			 * @brief 4 16 bit signed normalized integers relative to the bounding box of the vertices, the 4th is padding. See GetPositionDequantization.
+			 */
+			Snorm16
+		};
+
+		enum class NormalFormat {
+			/**
+			 * @brief 3 32 bit floats.
+			 */
+			Float32,
+
+			/**
+			 * @brief Unit vector mapped onto an octahedron unfolded to a square, stored as 2 16 bit signed normalized integers. The vertex shader folds it back.
+			 */
+			Octahedral16
+		};
+
+		enum class UvFormat {
+			/**
+			 * @brief 2 32 bit floats.
+			 */
+			Float32,
+
+			/**
+			 * @brief 2 16 bit floats.
+			 */
+			Half
+		};
+
+		PositionFormat _positionFormat = PositionFormat::Snorm16;
+		NormalFormat _normalFormat = NormalFormat::Octahedral16;
+		UvFormat _uvFormat = UvFormat::Half;
+
+		uint32_t GetPositionSizeBytes() const {
+			return _positionFormat == PositionFormat::Float32 ? sizeof(float) * 3 : sizeof(uint16_t) * 4;
+		}
+
+		uint32_t GetNormalSizeBytes() const {
+			return _normalFormat == NormalFormat::Float32 ? sizeof(float) * 3 : sizeof(uint16_t) * 2;
+		}
+
+		uint32_t GetUvSizeBytes() const {
+			return _uvFormat == UvFormat::Float32 ? sizeof(float) * 2 : sizeof(uint16_t) * 2;
+		}
 
 		/**
-		 * @brief Gamma correction to make images look more or less bright.
+		 * @brief Size of one vertex in a vertex buffer, in bytes.
 		 */
-		float _gammaCorrection;
+		uint32_t GetStride() const {
+			return GetPositionSizeBytes() + GetNormalSizeBytes() + GetUvSizeBytes();
+		}
+
+		VkVertexInputBindingDescription GetBindingDescription(uint32_t binding) const {
+			return VkVertexInputBindingDescription{ binding, GetStride(), VK_VERTEX_INPUT_RATE_VERTEX };
+		}
 
 		/**
-		 * @brief Trims the ends of a string by removing the first and last characters from it.
-		 * @param quotedString
-		 * @return A new string with the 2 ends trimmed by one character.
+		 * @brief Returns the descriptions of the position, normal and UV attributes, at locations 0, 1 and 2 of the given binding.
 		 */
-		std::string TrimEnds(std::string quotedString) {
-			auto length = quotedString.length();
-			quotedString = quotedString.substr(1, length - 2);
-			return quotedString;
+		std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(uint32_t binding) const {
+			std::vector<VkVertexInputAttributeDescription> descriptions(3);
+			descriptions[0] = { 0, binding, VK_FORMAT_R32G32B32_SFLOAT, 0 };
+			if (_positionFormat == PositionFormat::Half) descriptions[0].format = VK_FORMAT_R16G16B16A16_SFLOAT;
+			if (_positionFormat == PositionFormat::Snorm16) descriptions[0].format = VK_FORMAT_R16G16B16A16_SNORM;
+
+			descriptions[1] = { 1, binding, VK_FORMAT_R32G32B32_SFLOAT, GetPositionSizeBytes() };
+			if (_normalFormat == NormalFormat::Octahedral16) descriptions[1].format = VK_FORMAT_R16G16_SNORM;
+
+			descriptions[2] = { 2, binding, VK_FORMAT_R32G32_SFLOAT, GetPositionSizeBytes() + GetNormalSizeBytes() };
+			if (_uvFormat == UvFormat::Half) descriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+			return descriptions;
 		}
 
 		/**
-		 * @brief Loads global settings from the json file.
-		 * @param absolutePathToJson
+		 * @brief Computes how the vertex shader gets object space positions back from the positions in the vertex buffer: position = offset + stored * scale.
+		 * For Snorm16 the offset is the center of the bounding box of the vertices and the scale is its extents, for the other formats they are 0 and 1.
 		 */
-		void Load(const std::filesystem::path& absolutePathToJson) {
-			// Read the json file and parse it.
-			auto text = Helpers::GetFileText(absolutePathToJson);
+		void GetPositionDequantization(const Vertex* pVertices, size_t vertexCount, glm::vec4& outOffset, glm::vec4& outScale) const;
+
+		/**
+		 * @brief Writes vertexCount vertices to pOut in this layout, which must have room for vertexCount * GetStride() bytes. offset and scale are the ones
+		 * returned by GetPositionDequantization.
+		 */
+		void Encode(const Vertex* pVertices, size_t vertexCount, const glm::vec4& offset, const glm::vec4& scale, unsigned char* pOut) const;
+	};
+
+	/**
+	 * @brief Tells when a file has been written to. The folder of the file is watched rather than the file itself, because many editors save by replacing
+	 * the file with a new one. HasChanged does not block, so it can be polled every frame.
+	 */
+	class FileWatcher {
+	public:
 
-			sjson::parsing::parse_results json = sjson::parsing::parse(text.data());
-			sjson::jobject rootObj = sjson::jobject::parse(json.value);
+		FileWatcher() = default;
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
 
-			// Get the values from the parsed result.
-			auto evlJson = rootObj.get("EnableValidationLayers");
-			_enableValidationLayers = Helpers::Convert<std::string, bool>(TrimEnds(evlJson));
+		~FileWatcher() {
+			Close();
+		}
 
-			auto validationLayers = sjson::jobject::parse(rootObj.get("ValidationLayers"));
-			_pValidationLayers.resize(validationLayers.size());
+		/**
+		 * @brief Starts watching the file at absolutePath. Returns false if its folder cannot be watched.
+		 */
+		bool Watch(const std::filesystem::path& absolutePath) {
+			Close();
+			_path = absolutePath;
+			std::error_code error;
+			_lastWriteTime = std::filesystem::last_write_time(_path, error);
+#ifdef _WIN32
+			_handle = FindFirstChangeNotificationW(_path.parent_path().wstring().c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+			return _handle != INVALID_HANDLE_VALUE;
+#else
+			_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (_descriptor < 0) return false;
+			if (inotify_add_watch(_descriptor, _path.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) >= 0) return true;
+			Close();
+			return false;
+#endif
+		}
 
-			for (int i = 0; i < validationLayers.size(); ++i) {
-				auto str = validationLayers.array(i).as_string();
-				auto length = strlen(str.data()) + 1;
-				char* ch = new char[length];
-				ch[length] = 0;
-				memcpy(ch, str.data(), length);
-				_pValidationLayers[i] = ch;
+		/**
+		 * @brief Whether the file has been written to since the last call, or since Watch for the first call.
+		 */
+		bool HasChanged() {
+			auto isFolderChanged = false;
+#ifdef _WIN32
+			if (_handle == INVALID_HANDLE_VALUE) return false;
+			while (WaitForSingleObject(_handle, 0) == WAIT_OBJECT_0) {
+				isFolderChanged = true;
+				if (!FindNextChangeNotification(_handle)) break;
 			}
+#else
+			if (_descriptor < 0) return false;
+			alignas(inotify_event) char events[4096];
+			while (read(_descriptor, events, sizeof(events)) > 0) isFolderChanged = true;
+#endif
+			if (!isFolderChanged) return false;
+
+			// The change may have been to another file in the folder.
+			std::error_code error;
+			auto writeTime = std::filesystem::last_write_time(_path, error);
+			if (error || writeTime == _lastWriteTime) return false;
+			_lastWriteTime = writeTime;
+			return true;
+		}
 
-			auto windowSize = sjson::jobject::parse(rootObj.get("WindowSize"));
-			auto width = windowSize.get("Width");
-			auto height = windowSize.get("Height");
-			_windowWidth = Helpers::Convert<std::string, int>(width);
-			_windowHeight = Helpers::Convert<std::string, int>(height);
-
-			auto input = sjson::jobject::parse(rootObj.get("Input"));
-			auto sens = input.get("MouseSensitivity");
-			_mouseSensitivity = Helpers::Convert<std::string, float>(sens);
+	private:
 
-			auto graphics = sjson::jobject::parse(rootObj.get("Graphics"));
-			auto gc = graphics.get("GammaCorrection");
-			_gammaCorrection = Helpers::Convert<std::string, float>(gc);
+		std::filesystem::path _path;
+		std::filesystem::file_time_type _lastWriteTime;
+#ifdef _WIN32
+		HANDLE _handle = INVALID_HANDLE_VALUE;
+#else
+		int _descriptor = -1;
+#endif
+
+		void Close() {
+#ifdef _WIN32
+			if (_handle != INVALID_HANDLE_VALUE) FindCloseChangeNotification(_handle);
+			_handle = INVALID_HANDLE_VALUE;
+#else
+			if (_descriptor >= 0) close(_descriptor);
+			_descriptor = -1;
+#endif
 		}
 	};
 
 	/**
-	 * @brief Contains all paths to files needed in the project.
+	 * @brief Settings read from GlobalSettings.json. Every setting is declared once in GetSchema, with the path of its value in the file, the value it
+	 * takes when the file leaves it out and whether it is live, that is whether it may change while the engine runs. The file is watched, and when it
+	 * is saved Update applies the live settings that changed all at once, so a frame never sees only part of a save.
 	 */
-	class Paths {
+	class GlobalSettings : public Singleton<GlobalSettings> {
 	public:
 
 		/**
-		 * @brief Every executable is passed a "working directory" parameter when starting it. This function returns the
-		 * current working directory supplied to the executable that is running the code in this function, if provided,
-		 * otherwise returns the folder, on disk, where the executable resides.
+		 * @brief Settings used by the physics thread. As they are live, the physics thread gets them through GetPhysics.
 		 */
-		static inline auto CurrentWorkingDirectory = []() -> std::filesystem::path { return std::filesystem::current_path(); };
+		struct Physics {
 
-		// I.N. Always use backward slashes for Windows, otherwise file reading may fail because of inconsistent path separators.
-		// i.e. don't use C:\path/to\file, always use C:\path\to\file.
+			/**
+			 * @brief How much rigid bodies are slowed down by the air, divided by the square of their mass.
+			 */
+			float _airFrictionCoefficient;
+
+			/**
+			 * @brief Most physics steps taken per second, or 0 to step as often as possible.
+			 */
+			uint32_t _maxStepsPerSecond;
+		};
 
 		/**
-		 * @brief Function returning the path to the global settings json file.
+		 * @brief Flag for enabling or disabling validation layers when the Vulkan instance is created.
 		 */
-		static inline auto Settings = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"src\\GlobalSettings.json"; };
+		bool _enableValidationLayers;
 
 		/**
-		 * @brief Function returning the path to the folder containing shaders.
+		 * @brief Names of the instance validation layers to report problems with Vulkan usage.
 		 */
-		static inline auto ShadersPath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"src\\shaders"; };
+		std::vector<std::string> _validationLayers;
 
 		/**
-		 * @brief Function returning the path to the compiled vertex shader file.
+		 * @brief Pointers to the names in _validationLayers, the way Vulkan takes them.
 		 */
-		static inline auto VertexShaderPath = []() -> std::filesystem::path { return ShadersPath() /= L"Graphics\\VertexShader.spv"; };
+		std::vector<const char*> _pValidationLayers;
 
 		/**
-		 * @brief Function returning the path to the compiled fragment shader file.
+		 * @brief Window width in pixels.
 		 */
-		static inline auto FragmentShaderPath = []() -> std::filesystem::path { return ShadersPath() /= L"Graphics\\FragmentShader.spv"; };
+		uint32_t _windowWidth;
 
 		/**
-		 * @brief Function returning the path to the textures folder.
+		 * @brief Window height in pixels.
 		 */
-		static inline auto TexturesPath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"textures"; };
+		uint32_t _windowHeight;
 
 		/**
-		 * @brief Function returning the path to the models folder.
+		 * @brief Mouse sensitivity multiplier.
 		 */
-		static inline auto ModelsPath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"models"; };
-	};
-
-	class Key {
-	public:
-		bool _isHeldDown;
-		bool _wasPressed;
-		int _code;
-		Key() = default;
-		Key(int code) : _code(code), _isHeldDown(false), _wasPressed(false) {}
-	};
-
-	class KeyCombo {
-	public:
-		std::vector<Key> _keys;
-		bool IsActive() { return false; }
-	};
-
-	class KeyboardMouse : public Singleton<KeyboardMouse>, public IUpdatable {
-		double _lastMouseX;
-		double _lastMouseY;
-		GLFWwindow* _pWindow;
+		float _mouseSensitivity;
 
-	public:
+		/**
+		 * @brief Gamma correction to make images look more or less bright.
+		 */
+		float _gammaCorrection;
 
 		/**
-		 * @brief .
+		 * @brief Whether the scene is culled and drawn on the GPU via indirect draws (see GpuDrivenScene), when the device supports it.
 		 */
-		std::map<int, Key> _keys;
+		bool _gpuDrivenRendering;
 
 		/**
-		 * @brief True if the cursor is visible.
+		 * @brief Whether materials are looked up in a single table of all the scene's textures (see MaterialTable) instead of binding a descriptor set per mesh.
 		 */
-		bool _cursorEnabled = false;
+		bool _bindlessMaterials;
 
 		/**
-		 * @brief Cumulative value of all horizontal mouse movements since a callback function was registered with glfwSetCursorPosCallback.
+		 * @brief Formats mesh vertices are stored in on the GPU.
 		 */
-		double _mouseX;
+		VertexLayout _vertexLayout;
 
 		/**
-		 * @brief Cumulative value of all vertical mouse movements since a callback function was registered with glfwSetCursorPosCallback.
+		 * @brief How many pixels on screen a level of detail may differ from the full detail mesh by, for it to be drawn instead.
 		 */
-		double _mouseY;
+		float _lodErrorPixels;
 
 		/**
-		 * @brief The difference between the current frame's mouseX and the mouseX registered on the last Update() call.
+		 * @brief Distance from the camera, in meters, past which objects are culled.
 		 */
-		double _deltaMouseX;
+		float _farClippingDistance;
 
 		/**
-		 * @brief The difference between the current frame's mouseY and the mouseY registered on the last Update() call.
+		 * @brief How frames are handed to the window: FIFO waits for vertical blank, MAILBOX replaces the queued frame with a newer one, IMMEDIATE
+		 * shows frames as soon as they are done and may tear. Falls back to FIFO if the surface does not support it.
 		 */
-		double _deltaMouseY;
+		VkPresentModeKHR _presentMode;
 
-		//double _scrollX; // Only used for scroll-pads. For vertical scroll wheels, only the Y value is actually used.
-		double _scrollY;
+		/**
+		 * @brief Most frames drawn per second, or 0 to draw as often as possible.
+		 */
+		uint32_t _maxFramesPerSecond;
 
-		static void KeyCallback(GLFWwindow* pWindow, int key, int scancode, int action, int mods) {
-			Instance()._keys.try_emplace(key, Key(key));
+		/**
+		 * @brief Size the asset cache is trimmed to, in megabytes.
+		 */
+		uint32_t _assetCacheSizeMegabytes;
 
-			if (action == GLFW_PRESS) {
-				Instance()._keys[key]._wasPressed = true;
-				Instance()._keys[key]._isHeldDown = true;
-			}
-			else if (action == GLFW_REPEAT) {
-				Instance()._keys[key]._isHeldDown = true;
-			}
-			else {
-				Instance()._keys[key]._isHeldDown = false;
-			}
-		}
+		/**
+		 * @brief Number of threads preparing meshes and textures for upload while a scene streams in.
+		 */
+		uint32_t _streamingWorkerCount;
 
-		static void CursorPositionCallback(GLFWwindow* pWindow, double xPos, double yPos) {
-			if (Instance()._cursorEnabled) return;
-			Instance()._mouseX = xPos;
-			Instance()._mouseY = yPos;
-		}
+		/**
+		 * @brief How many megabytes of streamed meshes and textures are uploaded to the GPU per frame at most.
+		 */
+		uint32_t _streamingUploadMegabytesPerFrame;
 
-		static void ScrollWheelCallback(GLFWwindow* pWindow, double xPos, double yPos) {
-			if (!Instance()._cursorEnabled) {
-				//Instance()._scrollX = xPos;
-				Instance()._scrollY += yPos;
-			}
-		}
+		/**
+		 * @brief Changed by Update while the physics thread runs, which reads it through GetPhysics instead.
+		 */
+		Physics _physics;
 
 		/**
-		 * @brief Constructor.
+		 * @brief Lowest level of the messages that are logged.
 		 */
-		KeyboardMouse() = default;
+		LogLevel _logLevel;
 
-		void Initialize(GLFWwindow* pWindow) {
-			if (nullptr == pWindow) return;
-			_pWindow = pWindow;
+		/**
+		 * @brief Whether the profiler measures zones.
+		 */
+		bool _profilingEnabled;
 
-			// Keyboard init
-			glfwSetKeyCallback(pWindow, KeyCallback);
+		/**
+		 * @brief File messages are logged to, relative to the working directory. Empty to only log to the console.
+		 */
+		std::string _logFile;
 
-			// Mouse init
-			_cursorEnabled = true;
-			glfwSetInputMode(_pWindow, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-			if (glfwRawMouseMotionSupported()) glfwSetInputMode(pWindow, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
-			glfwSetCursorPosCallback(pWindow, CursorPositionCallback);
-			glfwSetScrollCallback(pWindow, ScrollWheelCallback);
+		/**
+		 * @brief Whether the log file is written in the binary format of Logger::WriteBinary rather than as text.
+		 */
+		bool _logBinary;
 
+		/**
+		 * @brief Loads global settings from the json file and starts watching it for changes.
+		 * @param absolutePathToJson
+		 */
+		void Load(const std::filesystem::path& absolutePathToJson) {
+			_path = absolutePathToJson;
+			Read(_path);
+			if (!_watcher.Watch(_path)) Logger::Warning("cannot watch {} for changes, settings will not be reloaded", _path);
 		}
 
-		bool IsKeyHeldDown(int glfwKeyCode) {
-			if (!_keys[glfwKeyCode]._isHeldDown) {
-				_keys[glfwKeyCode]._wasPressed = false;
+		/**
+		 * @brief Called once per frame on the main thread. If the file was saved since the last call, reads it again and applies the live settings
+		 * that changed. Settings that are not live keep their value until the engine restarts. Returns whether any setting changed.
+		 */
+		bool Update() {
+			if (!_watcher.HasChanged()) return false;
+			GlobalSettings reloaded;
+			if (!reloaded.Read(_path)) return false;
+
+			auto isChanged = false;
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (auto& setting : GetSchema()) {
+				if (setting._isEqual(*this, reloaded)) continue;
+				if (!setting._isLive) {
+					Logger::Warning("{} changed, the new value is used after a restart", setting._path);
+					continue;
+				}
+				setting._copy(*this, reloaded);
+				Logger::Info("{} changed", setting._path);
+				isChanged = true;
 			}
-			return _keys[glfwKeyCode]._isHeldDown;
+			return isChanged;
 		}
 
-		bool WasKeyPressed(int glfwKeyCode) {
-			bool wasPressed = _keys[glfwKeyCode]._wasPressed;
-			_keys[glfwKeyCode]._wasPressed = false;
-			return wasPressed;
+		/**
+		 * @brief Returns the current physics settings. Safe to call from any thread.
+		 */
+		Physics GetPhysics() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _physics;
 		}
 
-		void ToggleCursor() {
-			_cursorEnabled = !_cursorEnabled;
-			glfwSetInputMode(_pWindow, GLFW_CURSOR, _cursorEnabled ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+		/**
+		 * @brief Name of a present mode in the settings file, as read by ReadValue.
+		 */
+		static const char* GetName(VkPresentModeKHR presentMode) {
+			switch (presentMode) {
+			case VK_PRESENT_MODE_FIFO_KHR: return "Fifo";
+			case VK_PRESENT_MODE_MAILBOX_KHR: return "Mailbox";
+			case VK_PRESENT_MODE_IMMEDIATE_KHR: return "Immediate";
+			default: return "unknown";
+			}
 		}
 
-		void Update() {
-			if (WasKeyPressed(GLFW_KEY_ESCAPE)) {
-				ToggleCursor();
-				if (!_cursorEnabled) glfwSetCursorPos(_pWindow, _lastMouseX, _lastMouseY);
-			};
-
-			_deltaMouseX = (_mouseX - _lastMouseX);
-			_deltaMouseY = (_mouseY - _lastMouseY);
+	private:
 
-			_lastMouseX = _mouseX;
-			_lastMouseY = _mouseY;
-		}
-	};
+		/**
+		 * @brief Declaration of a setting. The functions work on the member of the given GlobalSettings instances that holds the setting.
+		 */
+		struct Setting {
 
-	/**
-	 * @brief Vulkan's representation of a GPU.
-	 */
-	class PhysicalDevice {
+			/**
+			 * @brief Names of the json objects containing the value, and of the value, separated by dots.
+			 */
+			std::string _path;
+			bool _isLive;
+			std::function<void(GlobalSettings& settings)> _reset;
+			std::function<bool(GlobalSettings& settings, const sjson::document::value& value)> _read;
+			std::function<bool(const GlobalSettings& a, const GlobalSettings& b)> _isEqual;
+			std::function<void(GlobalSettings& to, const GlobalSettings& from)> _copy;
+		};
 
-	public:
+		std::filesystem::path _path;
+		FileWatcher _watcher;
+
+		/**
+		 * @brief Guards the live settings read by threads other than the main thread.
+		 */
+		std::mutex _mutex;
+
+		/**
+		 * @brief Declares a setting of type T. member is a lambda returning a reference to the setting's member of the GlobalSettings instance it is given.
+		 */
+		template<typename T, typename Member>
+		static Setting Declare(std::string path, T defaultValue, bool isLive, Member member) {
+			Setting setting;
+			setting._path = std::move(path);
+			setting._isLive = isLive;
+			setting._reset = [=](GlobalSettings& settings) { member(settings) = defaultValue; };
+			setting._read = [=](GlobalSettings& settings, const sjson::document::value& value) { return ReadValue(value, member(settings)); };
+			setting._isEqual = [=](const GlobalSettings& a, const GlobalSettings& b) { return member(a) == member(b); };
+			setting._copy = [=](GlobalSettings& to, const GlobalSettings& from) { member(to) = member(from); };
+			return setting;
+		}
+
+		/**
+		 * @brief All the settings, with their default values.
+		 */
+		static const std::vector<Setting>& GetSchema() {
+			static const std::vector<Setting> schema = {
+				Declare("EnableValidationLayers", false, false, [](auto& settings) -> auto& { return settings._enableValidationLayers; }),
+				Declare("ValidationLayers", std::vector<std::string>{ "VK_LAYER_KHRONOS_validation" }, false, [](auto& settings) -> auto& { return settings._validationLayers; }),
+				Declare("WindowSize.Width", 1280u, false, [](auto& settings) -> auto& { return settings._windowWidth; }),
+				Declare("WindowSize.Height", 720u, false, [](auto& settings) -> auto& { return settings._windowHeight; }),
+				Declare("Input.MouseSensitivity", 0.1f, true, [](auto& settings) -> auto& { return settings._mouseSensitivity; }),
+				Declare("Graphics.GammaCorrection", 0.7f, true, [](auto& settings) -> auto& { return settings._gammaCorrection; }),
+				Declare("Graphics.GpuDrivenRendering", true, false, [](auto& settings) -> auto& { return settings._gpuDrivenRendering; }),
+				Declare("Graphics.BindlessMaterials", true, false, [](auto& settings) -> auto& { return settings._bindlessMaterials; }),
+				Declare("Graphics.VertexLayout.Position", VertexLayout::PositionFormat::Snorm16, false, [](auto& settings) -> auto& { return settings._vertexLayout._positionFormat; }),
+				Declare("Graphics.VertexLayout.Normal", VertexLayout::NormalFormat::Octahedral16, false, [](auto& settings) -> auto& { return settings._vertexLayout._normalFormat; }),
+				Declare("Graphics.VertexLayout.UV", VertexLayout::UvFormat::Half, false, [](auto& settings) -> auto& { return settings._vertexLayout._uvFormat; }),
+				Declare("Graphics.LodErrorPixels", 1.0f, true, [](auto& settings) -> auto& { return settings._lodErrorPixels; }),
+				Declare("Graphics.FarClippingDistance", 200.0f, true, [](auto& settings) -> auto& { return settings._farClippingDistance; }),
+				Declare("Graphics.PresentMode", VK_PRESENT_MODE_MAILBOX_KHR, true, [](auto& settings) -> auto& { return settings._presentMode; }),
+				Declare("Graphics.MaxFramesPerSecond", 0u, true, [](auto& settings) -> auto& { return settings._maxFramesPerSecond; }),
+				Declare("Assets.CacheSizeMegabytes", 2048u, false, [](auto& settings) -> auto& { return settings._assetCacheSizeMegabytes; }),
+				Declare("Assets.StreamingWorkerCount", 2u, true, [](auto& settings) -> auto& { return settings._streamingWorkerCount; }),
+				Declare("Assets.StreamingUploadMegabytesPerFrame", 16u, true, [](auto& settings) -> auto& { return settings._streamingUploadMegabytesPerFrame; }),
+				Declare("Physics.AirFrictionCoefficient", 0.09f, true, [](auto& settings) -> auto& { return settings._physics._airFrictionCoefficient; }),
+				Declare("Physics.MaxStepsPerSecond", 0u, true, [](auto& settings) -> auto& { return settings._physics._maxStepsPerSecond; }),
+				Declare("Logging.Level", LogLevel::Info, true, [](auto& settings) -> auto& { return settings._logLevel; }),
+				Declare("Logging.File", std::string(), false, [](auto& settings) -> auto& { return settings._logFile; }),
+				Declare("Logging.Binary", false, false, [](auto& settings) -> auto& { return settings._logBinary; }),
+				Declare("Profiling.Enabled", true, true, [](auto& settings) -> auto& { return settings._profilingEnabled; }),
+			};
+			return schema;
+		}
 
 		/**
-		 * @brief Allocates memory according to the requirements, and returns a handle to be used strictly via the Vulkan
-		 * API to access the allocated memory.
-		 * @param memoryType This can be any of the following values:
-		 * 1) VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT: this means GPU memory, so VRAM. If this is not set, then regular RAM is assumed.
-		 * 2) VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT: this means that the CPU will be able to read and write from the allocated memory IF YOU CALL vkMapMemory() FIRST.
-		 * 3) VK_MEMORY_PROPERTY_HOST_CACHED_BIT: this means that the memory will be cached so that when the CPU writes to this buffer, if the data is small enough to fit in its
-		 * cache (which is much faster to access) it will do that instead. Only problem is that this way, if your GPU needs to access that data, it won't be able to unless it's
-		 * also marked as HOST_COHERENT.
-		 * 4) VK_MEMORY_PROPERTY_HOST_COHERENT_BIT: this means that anything that the CPU writes to the buffer will be able to be read by the GPU as well, effectively
-		 * granting the GPU access to the CPU's cache (if the buffer is also marked as HOST_CACHED). COHERENT stands for consistency across memories, so it basically means
-		 * that the CPU, GPU or any other device will see the same memory if trying to access the buffer. If you don't have this flag set, and you try to access the
-		 * buffer from the GPU while the buffer is marked HOST_CACHED, you may not be able to get the data or even worse, you may end up reading the wrong chunk of memory.
-		 * Further read: https://asawicki.info/news_1740_vulkan_memory_types_on_pc_and_how_to_use_them
+		 * @brief Resets every setting to its default value, then reads the values in the file in a single walk over it. Returns false if the file
+		 * cannot be read or is not valid json.
 		 */
-		static VkDeviceMemory AllocateMemory(VkPhysicalDevice& physicalDevice, VkDevice& logicalDevice, const VkMemoryRequirements& memoryRequirements, const VkMemoryPropertyFlagBits& memoryType) {
-			VkMemoryAllocateInfo allocInfo{};
-			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocInfo.allocationSize = memoryRequirements.size;
-			allocInfo.memoryTypeIndex = GetMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, memoryType);
+		bool Read(const std::filesystem::path& absolutePathToJson) {
+			for (auto& setting : GetSchema()) setting._reset(*this);
 
-			VkDeviceMemory handleToAllocatedMemory;
+			std::string text;
+			if (!FileIO::ReadAll(absolutePathToJson, text)) {
+				Logger::Error("failed reading settings from {}", absolutePathToJson);
+				return false;
+			}
 
-			if (vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &handleToAllocatedMemory) != VK_SUCCESS) {
-				std::cout << "failed allocating memory of size " << allocInfo.allocationSize << std::endl;
-				std::exit(-1);
+			try {
+				auto json = sjson::document::parse(text);
+				std::string path;
+				ReadObject(json.root(), path);
+			}
+			catch (const sjson::parsing_error& error) {
+				Logger::Error("failed parsing settings from {}: {}", absolutePathToJson, error.what());
+				return false;
 			}
 
-			return handleToAllocatedMemory;
+			_pValidationLayers.clear();
+			for (auto& layer : _validationLayers) _pValidationLayers.push_back(layer.c_str());
+			return true;
 		}
 
-		static bool SupportsSwapchains(VkPhysicalDevice& physicalDevice) {
-			uint32_t extensionCount = 0;
-			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
-
-			if (extensionCount == 0) {
-				std::cerr << "physical device doesn't support any extensions" << std::endl;
-				exit(1);
-			}
+		/**
+		 * @brief Reads the values inside object, which is at path in the file.
+		 */
+		void ReadObject(const sjson::document::value& object, std::string& path) {
+			static const auto settingsByPath = []() {
+				std::map<std::string, const Setting*, std::less<>> settingsByPath;
+				for (auto& setting : GetSchema()) settingsByPath.emplace(setting._path, &setting);
+				return settingsByPath;
+			}();
 
-			std::vector<VkExtensionProperties> deviceExtensions(extensionCount);
-			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, deviceExtensions.data());
+			for (auto member : object) {
+				auto parentPathLength = path.size();
+				if (parentPathLength > 0) path += '.';
+				path += member.key();
 
-			for (const auto& extension : deviceExtensions) {
-				if (strcmp(extension.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) {
-					std::cout << "physical device supports swap chains" << std::endl;
-					return true;
+				auto setting = settingsByPath.find(path);
+				if (setting != settingsByPath.end()) {
+					if (!setting->second->_read(*this, member)) Logger::Warning("invalid value for {}, using the default", path);
 				}
+				else if (member.type() == sjson::jtype::jobject) ReadObject(member, path);
+				else Logger::Warning("unknown setting {}", path);
+
+				path.resize(parentPathLength);
 			}
+		}
 
-			return false;
+		/**
+		 * @brief Booleans can be written either as json booleans or as strings such as "true".
+		 */
+		static bool ReadValue(const sjson::document::value& value, bool& outValue) {
+			if (value.type() == sjson::jtype::jbool) outValue = value.is_true();
+			else if (value.type() == sjson::jtype::jstring) outValue = Helpers::Convert<std::string, bool>(value.as_string());
+			else return false;
+			return true;
 		}
 
-		static bool SupportsSurface(VkPhysicalDevice& physicalDevice, uint32_t& queueFamilyIndex, VkSurfaceKHR& surface) {
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, queueFamilyIndex, surface, &presentSupport);
-			return presentSupport == 0 ? false : true;
+		static bool ReadValue(const sjson::document::value& value, float& outValue) {
+			if (value.type() != sjson::jtype::jnumber) return false;
+			outValue = value.as_float();
+			return true;
 		}
 
-		static VkPhysicalDeviceMemoryProperties GetMemoryProperties(VkPhysicalDevice& physicalDevice) {
-			VkPhysicalDeviceMemoryProperties props;
-			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &props);
-			return props;
+		static bool ReadValue(const sjson::document::value& value, uint32_t& outValue) {
+			if (value.type() != sjson::jtype::jnumber || value.as_int64() < 0 || value.as_int64() > UINT32_MAX) return false;
+			outValue = value.as_uint();
+			return true;
 		}
 
-		static uint32_t GetMemoryTypeIndex(VkPhysicalDevice& physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties) {
-			auto props = GetMemoryProperties(physicalDevice);
+		static bool ReadValue(const sjson::document::value& value, std::string& outValue) {
+			if (value.type() != sjson::jtype::jstring) return false;
+			outValue = value.as_string();
+			return true;
+		}
 
-			for (uint32_t i = 0; i < 32; i++) {
-				if ((typeBits & 1) == 1) {
-					if ((props.memoryTypes[i].propertyFlags & properties) == properties) {
-						return i;
-					}
-				}
-				typeBits >>= 1;
+		static bool ReadValue(const sjson::document::value& value, LogLevel& outValue) {
+			auto name = value.as_string_view();
+			if (name == "Debug") outValue = LogLevel::Debug;
+			else if (name == "Info") outValue = LogLevel::Info;
+			else if (name == "Warning") outValue = LogLevel::Warning;
+			else if (name == "Error") outValue = LogLevel::Error;
+			else return false;
+			return true;
+		}
+
+		static bool ReadValue(const sjson::document::value& value, std::vector<std::string>& outValue) {
+			if (value.type() != sjson::jtype::jarray) return false;
+			std::vector<std::string> strings;
+			for (auto element : value) {
+				if (element.type() != sjson::jtype::jstring) return false;
+				strings.push_back(element.as_string());
 			}
+			outValue = std::move(strings);
+			return true;
+		}
 
-			return -1;
+		static bool ReadValue(const sjson::document::value& value, VkPresentModeKHR& outValue) {
+			auto name = value.as_string_view();
+			if (name == "Fifo") outValue = VK_PRESENT_MODE_FIFO_KHR;
+			else if (name == "Mailbox") outValue = VK_PRESENT_MODE_MAILBOX_KHR;
+			else if (name == "Immediate") outValue = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			else return false;
+			return true;
 		}
 
-		static std::vector<VkQueueFamilyProperties> GetAllQueueFamilyProperties(VkPhysicalDevice& physicalDevice) {
-			uint32_t queueFamilyCount = 0;
-			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		static bool ReadValue(const sjson::document::value& value, VertexLayout::PositionFormat& outValue) {
+			auto name = value.as_string_view();
+			if (name == "Float32") outValue = VertexLayout::PositionFormat::Float32;
+			else if (name == "Half") outValue = VertexLayout::PositionFormat::Half;
+			else if (name == "Snorm16") outValue = VertexLayout::PositionFormat::Snorm16;
+			else return false;
+			return true;
+		}
 
-			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+		static bool ReadValue(const sjson::document::value& value, VertexLayout::NormalFormat& outValue) {
+			auto name = value.as_string_view();
+			if (name == "Float32") outValue = VertexLayout::NormalFormat::Float32;
+			else if (name == "Octahedral16") outValue = VertexLayout::NormalFormat::Octahedral16;
+			else return false;
+			return true;
+		}
 
-			return queueFamilies;
+		static bool ReadValue(const sjson::document::value& value, VertexLayout::UvFormat& outValue) {
+			auto name = value.as_string_view();
+			if (name == "Float32") outValue = VertexLayout::UvFormat::Float32;
+			else if (name == "Half") outValue = VertexLayout::UvFormat::Half;
+			else return false;
+			return true;
 		}
+	};
 
-		static void GetQueueFamilyIndices(VkPhysicalDevice& physicalDevice, const VkQueueFlagBits& queueFlags, bool needsPresentationSupport, const VkSurfaceKHR& surface) {
-			// Check queue families
-			auto queueFamilyProperties = GetAllQueueFamilyProperties(physicalDevice);
+	/**
+	 * @brief Contains all paths to files needed in the project.
+	 */
+	class Paths {
+	public:
 
-			std::vector<uint32_t> queueFamilyIndices;
+		/**
+		 * @brief Every executable is passed a "working directory" parameter when starting it. This function returns the
+		 * current working directory supplied to the executable that is running the code in this function, if provided,
+		 * otherwise returns the folder, on disk, where the executable resides.
+		 */
+		static inline auto CurrentWorkingDirectory = []() -> std::filesystem::path { return std::filesystem::current_path(); };
 
-			for (uint32_t i = 0; i < queueFamilyProperties.size(); i++) {
-				VkBool32 presentationSupported = false;
-				vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentationSupported);
+		// I.N. Always use backward slashes for Windows, otherwise file reading may fail because of inconsistent path separators.
+		// i.e. don't use C:\path/to\file, always use C:\path\to\file.
 
-				if (queueFamilyProperties[i].queueCount > 0 && queueFamilyProperties[i].queueFlags & queueFlags) {
-					if (needsPresentationSupport) {
-						if (presentationSupported) {
-							queueFamilyIndices.push_back(i);
-						}
-					}
-					else {
-						queueFamilyIndices.push_back(i);
-					}
-				}
-			}
-		}
+		/**
+		 * @brief Function returning the path to the global settings json file.
+		 */
+		static inline auto Settings = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"src\\GlobalSettings.json"; };
 
-		static VkSurfaceCapabilitiesKHR GetSurfaceCapabilities(VkPhysicalDevice& physicalDevice, VkSurfaceKHR& windowSurface) {
-			VkSurfaceCapabilitiesKHR surfaceCapabilities;
-			if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, windowSurface, &surfaceCapabilities) != VK_SUCCESS) {
-				std::cerr << "failed to acquire presentation surface capabilities" << std::endl;
-			}
-			return surfaceCapabilities;
-		}
+		/**
+		 * @brief Function returning the path to the folder containing shaders.
+		 */
+		static inline auto ShadersPath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"src\\shaders"; };
 
-		static std::vector<VkSurfaceFormatKHR> GetSupportedFormatsForSurface(VkPhysicalDevice& physicalDevice, VkSurfaceKHR& windowSurface) {
-			uint32_t formatCount;
-			if (vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, windowSurface, &formatCount, nullptr) != VK_SUCCESS || formatCount == 0) {
-				std::cerr << "failed to get number of supported surface formats" << std::endl;
-			}
+		/**
+		 * @brief Function returning the path to the compiled vertex shader file.
+		 */
+		static inline auto VertexShaderPath = []() -> std::filesystem::path { return ShadersPath() /= L"Graphics\\VertexShader.spv"; };
 
-			std::vector<VkSurfaceFormatKHR> surfaceFormats(formatCount);
-			if (vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, windowSurface, &formatCount, surfaceFormats.data()) != VK_SUCCESS) {
-				std::cerr << "failed to get supported surface formats" << std::endl;
-			}
+		/**
+		 * @brief Function returning the path to the compiled fragment shader file.
+		 */
+		static inline auto FragmentShaderPath = []() -> std::filesystem::path { return ShadersPath() /= L"Graphics\\FragmentShader.spv"; };
 
-			return surfaceFormats;
-		}
+		/**
+		 * @brief Function returning the path to the compiled fragment shader file that reads materials from the material table.
+		 */
+		static inline auto BindlessFragmentShaderPath = []() -> std::filesystem::path { return ShadersPath() /= L"Graphics\\BindlessFragmentShader.spv"; };
 
-		static std::vector<VkPresentModeKHR> GetSupportedPresentModesForSurface(VkPhysicalDevice& physicalDevice, VkSurfaceKHR& windowSurface) {
-			uint32_t presentModeCount;
-			if (vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, windowSurface, &presentModeCount, nullptr) != VK_SUCCESS || presentModeCount == 0) {
-				std::cerr << "failed to get number of supported presentation modes" << std::endl;
-				exit(1);
-			}
+		/**
+		 * @brief Function returning the path to the textures folder.
+		 */
+		static inline auto TexturesPath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"textures"; };
 
-			std::vector<VkPresentModeKHR> presentModes(presentModeCount);
-			if (vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, windowSurface, &presentModeCount, presentModes.data()) != VK_SUCCESS) {
-				std::cerr << "failed to get supported presentation modes" << std::endl;
-				exit(1);
-			}
+		/**
+		 * @brief Function returning the path to the models folder.
+		 */
+		static inline auto ModelsPath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"models"; };
 
-			return presentModes;
-		}
+		/**
+		 * @brief Function returning the path to the file the pipeline cache data is saved to between runs.
+		 */
+		static inline auto PipelineCachePath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"cache\\PipelineCache.bin"; };
+
+		/**
+		 * @brief Function returning the path to the folder cooked assets are cached in.
+		 */
+		static inline auto AssetCachePath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"cache\\assets"; };
+
+		/**
+		 * @brief Function returning the path to the file profiler traces are saved to.
+		 */
+		static inline auto TracePath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"profiles\\Trace.json"; };
+
+		/**
+		 * @brief Function returning the path to the folder benchmark results are saved to.
+		 */
+		static inline auto BenchmarksPath = []() -> std::filesystem::path { return CurrentWorkingDirectory() /= L"benchmarks"; };
 	};
 
-	class VkHelper {
+	/**
+	 * @brief Keeps count of the Vulkan buffers, images, descriptor pools and device memory allocations that are alive, and of the bytes of device memory they
+	 * hold, per category and per memory heap. Every call creating or destroying one of those goes through the functions of this class, which take the same
+	 * arguments as the Vulkan ones and tag what they create with the category of the innermost Scope of the calling thread. When the device supports
+	 * VK_EXT_memory_budget, the heaps also tell how much of them the whole process uses and how much the driver allows it to use. The counts are shown in
+	 * the profiler overlay and saved with benchmark results, and whatever is still alive at shutdown is logged, so that leaks and memory growing over a
+	 * long session show up.
+	 */
+	class ResourceTracker : public Singleton<ResourceTracker> {
 	public:
-		static VkCommandPool CreateCommandPool(VkDevice& logicalDevice, uint32_t& queueFamilyIndex) {
-			VkCommandPoolCreateInfo poolCreateInfo = {};
-			poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-			poolCreateInfo.queueFamilyIndex = queueFamilyIndex;
-			poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-			VkCommandPool outPool;
-			vkCreateCommandPool(logicalDevice, &poolCreateInfo, nullptr, &outPool);
-			return outPool;
-		}
-
-		static int FindQueueFamilyIndex(VkPhysicalDevice& physicalDevice, VkQueueFlagBits queueFlags) {
-			auto queueFamilyProperties = PhysicalDevice::GetAllQueueFamilyProperties(physicalDevice);
 
-			for (uint32_t queueFamilyIndex = 0; queueFamilyIndex < queueFamilyProperties.size(); queueFamilyIndex++) {
-				if (queueFamilyProperties[queueFamilyIndex].queueCount > 0 && queueFamilyProperties[queueFamilyIndex].queueFlags & queueFlags) {
-					return queueFamilyIndex;
-				}
-			}
+		enum class Category {
+			Mesh,
+			Texture,
+			Uniform,
+			Staging,
+			Collision,
+			RenderTarget,
+			Other,
+			Count
+		};
 
-			return -1;
-		}
+		enum class ObjectType {
+			Buffer,
+			Image,
+			DescriptorPool,
+			Allocation,
+			Count
+		};
 
-		static void StartRecording(VkCommandBuffer& commandBuffer) {
-			VkCommandBufferBeginInfo beginInfo{};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-			vkResetCommandBuffer(commandBuffer, 0);
-			vkBeginCommandBuffer(commandBuffer, &beginInfo);
-		}
+		static constexpr const char* _categoryNames[] = { "mesh", "texture", "uniform", "staging", "collision", "renderTarget", "other" };
+		static constexpr const char* _objectTypeNames[] = { "buffers", "images", "descriptorPools", "allocations" };
 
-		static void StopRecording(VkCommandBuffer& commandBuffer) { vkEndCommandBuffer(commandBuffer); }
+		/**
+		 * @brief Tags what the calling thread creates until the end of its scope with a category. Scopes nest, and the innermost one wins, so that for
+		 * example the staging buffers used to upload a mesh count as staging rather than as mesh.
+		 */
+		class Scope {
+		public:
 
-		static void ExecuteCommands(VkCommandBuffer& commandBuffer, VkQueue& queue) {
-			VkSubmitInfo submitInfo{};
-			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			submitInfo.commandBufferCount = 1;
-			submitInfo.pCommandBuffers = &commandBuffer;
-			vkQueueSubmit(queue, 1, &submitInfo, nullptr);
-			vkQueueWaitIdle(queue);
-		}
+			Scope(Category category) {
+				_previousCategory = _currentCategory;
+				_currentCategory = category;
+			}
 
-		static VkCommandBuffer CreateCommandBuffer(VkDevice& logicalDevice, VkCommandPool& commandPool) {
-			VkCommandBufferAllocateInfo cmdBufInfo = {};
-			cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-			cmdBufInfo.commandPool = commandPool;
-			cmdBufInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-			cmdBufInfo.commandBufferCount = 1;
-			VkCommandBuffer commandBuffer;
-			vkAllocateCommandBuffers(logicalDevice, &cmdBufInfo, &commandBuffer);
-			return commandBuffer;
-		}
+			~Scope() {
+				_currentCategory = _previousCategory;
+			}
 
-		static void* DownloadImage(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue, VkImage image, uint32_t width, uint32_t height, VkDeviceMemory& outStagingMemory, VkBuffer& outStagingBuffer) {
-			CreateBuffer(logicalDevice, physicalDevice, 4 * width * height, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT /*| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT*/,
-				&outStagingBuffer, &outStagingMemory);
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
 
-			TransitionImageLayout(logicalDevice, commandPool, queue, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-			CopyImageToBuffer(logicalDevice, commandPool, queue, image, outStagingBuffer, width, height);
+		private:
 
-			void* data;
-			vkMapMemory(logicalDevice, outStagingMemory, 0, 4 * width * height, 0, &data);
-			return data;
-		}
+			Category _previousCategory;
+		};
 
-		static void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer* buffer, VkDeviceMemory* bufferMemory) {
-			VkBufferCreateInfo bufferInfo{};
-			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = size;
-			bufferInfo.usage = usage;
-			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			CheckResult(vkCreateBuffer(device, &bufferInfo, nullptr, buffer));
-			*bufferMemory = AllocateGpuMemoryForBuffer(device, physicalDevice, *buffer, properties);
-			vkBindBufferMemory(device, *buffer, *bufferMemory, 0);
-		}
+		struct CategoryStatistics {
+			uint64_t _objectCounts[(size_t)ObjectType::Count] = {};
+			uint64_t _bytes = 0;
 
-		static void TransitionImageLayout(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout) {
-			VkCommandBuffer commandBuffer = CreateCommandBuffer(device, commandPool);
-			StartRecording(commandBuffer);
+			/**
+			 * @brief Most bytes the category held at once since the start.
+			 */
+			uint64_t _peakBytes = 0;
+		};
 
-			VkImageMemoryBarrier barrier{};
-			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			barrier.oldLayout = oldLayout;
-			barrier.newLayout = newLayout;
-			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			barrier.image = image;
-			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			barrier.subresourceRange.baseMipLevel = 0;
-			barrier.subresourceRange.levelCount = 1;
-			barrier.subresourceRange.baseArrayLayer = 0;
-			barrier.subresourceRange.layerCount = 1;
+		struct HeapStatistics {
+			VkDeviceSize _sizeBytes = 0;
+			bool _isDeviceLocal = false;
 
-			VkPipelineStageFlags sourceStage;
-			VkPipelineStageFlags destinationStage;
+			/**
+			 * @brief Bytes of the heap held by the allocations of the engine.
+			 */
+			uint64_t _bytes = 0;
 
-			if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) { barrier.srcAccessMask = 0; sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT; }
-			if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
-			if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT; sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
-			if (oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; }
-			if (oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT; sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; }
+			/**
+			 * @brief Bytes of the heap the whole process uses, and the bytes it can use before allocations start failing or slowing down, as reported
+			 * by VK_EXT_memory_budget. Both are zero when the extension is not enabled.
+			 */
+			VkDeviceSize _usageBytes = 0;
+			VkDeviceSize _budgetBytes = 0;
+		};
 
-			if (newLayout == VK_IMAGE_LAYOUT_UNDEFINED) { barrier.dstAccessMask = 0; destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
-			if (newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT; destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
-			if (newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
-			if (newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT; destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; }
-			if (newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) { barrier.dstAccessMask = 0; destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
-			if (newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
+		/**
+		 * @brief Returns true if memory budgets can be queried on physicalDevice, so VK_EXT_memory_budget should be enabled when creating the logical device.
+		 * The instance must have been created with VK_KHR_get_physical_device_properties2.
+		 */
+		static bool IsMemoryBudgetSupported(VkPhysicalDevice physicalDevice) {
+			uint32_t extensionCount = 0;
+			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+			std::vector<VkExtensionProperties> extensions(extensionCount);
+			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+			for (auto& extension : extensions) if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) return true;
+			return false;
+		}
 
-			vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-			vkEndCommandBuffer(commandBuffer);
-			ExecuteCommands(commandBuffer, queue);
-			vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+		/**
+		 * @brief Reads the memory heaps of physicalDevice. Called once the physical device is chosen, before any memory is allocated.
+		 */
+		void Initialize(VkInstance instance, VkPhysicalDevice physicalDevice, bool isMemoryBudgetEnabled) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_physicalDevice = physicalDevice;
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+			_heapBytes.assign(_memoryProperties.memoryHeapCount, 0);
+			_pGetMemoryProperties2 = isMemoryBudgetEnabled ? (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR") : nullptr;
 		}
 
-		static void CopyImageToBuffer(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkImage image, VkBuffer buffer, uint32_t width, uint32_t height) {
-			VkCommandBufferAllocateInfo allocInfo{};
-			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-			allocInfo.commandPool = commandPool;
-			allocInfo.commandBufferCount = 1;
+		static VkResult AllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator, VkDeviceMemory* pMemory) {
+			auto result = vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+			if (result != VK_SUCCESS) return result;
 
-			VkCommandBuffer commandBuffer = CreateCommandBuffer(device, commandPool);
-			StartRecording(commandBuffer);
+			auto& tracker = Instance();
+			std::lock_guard<std::mutex> lock(tracker._mutex);
+			Allocation allocation{ pAllocateInfo->allocationSize, _currentCategory, UINT32_MAX };
+			if (pAllocateInfo->memoryTypeIndex < tracker._memoryProperties.memoryTypeCount) allocation._heapIndex = tracker._memoryProperties.memoryTypes[pAllocateInfo->memoryTypeIndex].heapIndex;
+			tracker._allocations[{ device, *pMemory }] = allocation;
 
-			VkBufferImageCopy region{};
-			region.bufferOffset = 0;
-			region.bufferRowLength = 0;  // Tightly packed
-			region.bufferImageHeight = 0; // Tightly packed
-			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			region.imageSubresource.mipLevel = 0;
-			region.imageSubresource.baseArrayLayer = 0;
-			region.imageSubresource.layerCount = 1;
-			region.imageOffset = { 0, 0, 0 };
-			region.imageExtent = { width, height, 1 };
+			auto& category = tracker._categories[(size_t)allocation._category];
+			category._objectCounts[(size_t)ObjectType::Allocation]++;
+			category._bytes += allocation._sizeBytes;
+			category._peakBytes = std::max(category._peakBytes, category._bytes);
+			if (allocation._heapIndex < tracker._heapBytes.size()) tracker._heapBytes[allocation._heapIndex] += allocation._sizeBytes;
+			return result;
+		}
 
-			vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
-			vkEndCommandBuffer(commandBuffer);
-			ExecuteCommands(commandBuffer, queue);
-			vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+		/**
+		 * @brief The allocation is forgotten before it is freed: once freed, another thread may be handed the same handle and record it.
+		 */
+		static void FreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator) {
+			auto& tracker = Instance();
+			{
+				std::lock_guard<std::mutex> lock(tracker._mutex);
+				auto found = tracker._allocations.find({ device, memory });
+				if (found != tracker._allocations.end()) {
+					auto& allocation = found->second;
+					auto& category = tracker._categories[(size_t)allocation._category];
+					category._objectCounts[(size_t)ObjectType::Allocation]--;
+					category._bytes -= allocation._sizeBytes;
+					if (allocation._heapIndex < tracker._heapBytes.size()) tracker._heapBytes[allocation._heapIndex] -= allocation._sizeBytes;
+					tracker._allocations.erase(found);
+				}
+			}
+			vkFreeMemory(device, memory, pAllocator);
 		}
 
-		static VkDeviceMemory AllocateGpuMemory(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkMemoryRequirements memRequirements, VkMemoryPropertyFlags requiredMemoryProperties) {
-			VkMemoryAllocateInfo allocInfo = {};
-			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocInfo.allocationSize = memRequirements.size;
-			allocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, memRequirements.memoryTypeBits, requiredMemoryProperties);
-			VkDeviceMemory allocatedMemory;
-			CheckResult(vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &allocatedMemory));
-			return allocatedMemory;
+		static VkResult CreateBuffer(VkDevice device, const VkBufferCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkBuffer* pBuffer) {
+			auto result = vkCreateBuffer(device, pCreateInfo, pAllocator, pBuffer);
+			if (result == VK_SUCCESS) Instance().Add(device, ObjectType::Buffer, (uint64_t)*pBuffer);
+			return result;
 		}
 
-		static VkDeviceMemory AllocateGpuMemoryForImage(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkImage imageToAllocate, VkMemoryPropertyFlags requiredMemoryProperties) {
-			VkMemoryRequirements memRequirements;
-			vkGetImageMemoryRequirements(logicalDevice, imageToAllocate, &memRequirements);
-			return AllocateGpuMemory(logicalDevice, physicalDevice, memRequirements, requiredMemoryProperties);
+		static void DestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator) {
+			Instance().Remove(device, ObjectType::Buffer, (uint64_t)buffer);
+			vkDestroyBuffer(device, buffer, pAllocator);
 		}
 
-		static VkDeviceMemory AllocateGpuMemoryForBuffer(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkBuffer buffer, VkMemoryPropertyFlags requiredMemoryProperties) {
-			VkMemoryRequirements memRequirements;
-			vkGetBufferMemoryRequirements(logicalDevice, buffer, &memRequirements);
-			return AllocateGpuMemory(logicalDevice, physicalDevice, memRequirements, requiredMemoryProperties);
+		static VkResult CreateImage(VkDevice device, const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImage* pImage) {
+			auto result = vkCreateImage(device, pCreateInfo, pAllocator, pImage);
+			if (result == VK_SUCCESS) Instance().Add(device, ObjectType::Image, (uint64_t)*pImage);
+			return result;
 		}
 
-		static VkDescriptorSet AllocateDescriptorSet(VkDevice logicalDevice, VkDescriptorPool descriptorPool, VkDescriptorSetLayout setLayout) {
-			VkDescriptorSetAllocateInfo allocInfo = {};
-			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			allocInfo.descriptorPool = descriptorPool;
-			allocInfo.descriptorSetCount = (uint32_t)1;
-			allocInfo.pSetLayouts = &setLayout;
-			VkDescriptorSet descriptorSet;
-			CheckResult(vkAllocateDescriptorSets(logicalDevice, &allocInfo, &descriptorSet));
-			return descriptorSet;
+		static void DestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator) {
+			Instance().Remove(device, ObjectType::Image, (uint64_t)image);
+			vkDestroyImage(device, image, pAllocator);
 		}
 
-		static void CopyImage(VkDevice logicalDevice, VkCommandPool commandPool, VkQueue queue,
-			VkImage srcImage, VkImage dstImage, VkExtent2D extent,
-			uint32_t mipLevel = 0, uint32_t baseArrayLayer = 0, uint32_t layerCount = 1) {
-			VkCommandBuffer commandBuffer = CreateCommandBuffer(logicalDevice, commandPool);
-			StartRecording(commandBuffer);
+		static VkResult CreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorPool* pDescriptorPool) {
+			auto result = vkCreateDescriptorPool(device, pCreateInfo, pAllocator, pDescriptorPool);
+			if (result == VK_SUCCESS) Instance().Add(device, ObjectType::DescriptorPool, (uint64_t)*pDescriptorPool);
+			return result;
+		}
 
-			VkImageSubresourceLayers subresource = {};
-			subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; // Assuming color images
-			subresource.mipLevel = mipLevel;
-			subresource.baseArrayLayer = baseArrayLayer;
-			subresource.layerCount = layerCount;
+		static void DestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator) {
+			Instance().Remove(device, ObjectType::DescriptorPool, (uint64_t)descriptorPool);
+			vkDestroyDescriptorPool(device, descriptorPool, pAllocator);
+		}
 
-			VkImageCopy copyRegion = {};
-			copyRegion.srcSubresource = subresource;
-			copyRegion.dstSubresource = subresource;
-			copyRegion.srcOffset = { 0, 0, 0 }; // Copy from the start of the source image
-			copyRegion.dstOffset = { 0, 0, 0 }; // Copy to the start of the destination image
-			copyRegion.extent = { extent.width, extent.height, 1 };       // The size of the image to copy
-
-			// Record the copy command
-			vkCmdCopyImage(commandBuffer,
-				srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-				dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				1, &copyRegion);
-
-			// End the command buffer
-			CheckResult(vkEndCommandBuffer(commandBuffer));
-
-			ExecuteCommands(commandBuffer, queue);
-			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+		std::vector<CategoryStatistics> GetCategories() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			return std::vector<CategoryStatistics>(std::begin(_categories), std::end(_categories));
 		}
 
-		static void DestroyImage(VkDevice logicalDevice, VkImage image, VkImageView imageView = nullptr, VkSampler sampler = nullptr) {
-			vkDestroyImage(logicalDevice, image, nullptr);
-			if (imageView != nullptr) vkDestroyImageView(logicalDevice, imageView, nullptr);
-			if (imageView != nullptr) vkDestroySampler(logicalDevice, sampler, nullptr);
-		}
+		std::vector<HeapStatistics> GetHeaps() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+			budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+			if (_pGetMemoryProperties2 != nullptr) {
+				VkPhysicalDeviceMemoryProperties2 properties{};
+				properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+				properties.pNext = &budget;
+				_pGetMemoryProperties2(_physicalDevice, &properties);
+			}
 
-		static void UploadData(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool commandPool, VkQueue queue, VkBuffer buffer, void* pData, size_t sizeBytes) {
-			// Create a temporary buffer.
-			VkBuffer stagingBuffer;
-			VkDeviceMemory stagingBufferGpuMemory;
-			CreateBuffer(logicalDevice, physicalDevice, sizeBytes, 
-				VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-				&stagingBuffer,
-				&stagingBufferGpuMemory);
+			std::vector<HeapStatistics> heaps(_memoryProperties.memoryHeapCount);
+			for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; ++i) {
+				heaps[i]._sizeBytes = _memoryProperties.memoryHeaps[i].size;
+				heaps[i]._isDeviceLocal = (_memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+				heaps[i]._bytes = _heapBytes[i];
+				heaps[i]._usageBytes = budget.heapUsage[i];
+				heaps[i]._budgetBytes = budget.heapBudget[i];
+			}
+			return heaps;
+		}
 
-			// Map memory to the correct GPU and CPU ranges for the buffer.
-			void* cpuMemory;
-			vkMapMemory(logicalDevice, stagingBufferGpuMemory, 0, sizeBytes, 0, &cpuMemory);
-			memcpy(cpuMemory, pData, sizeBytes);
+		/**
+		 * @brief Adds rows with the memory held by each category and the use of each heap to the window being built. Called by the main thread while
+		 * building the UI.
+		 */
+		void DrawOverlay(nk_context* pUiCtx) {
+			char text[128];
+			nk_layout_row_dynamic(pUiCtx, 18, 1);
+			nk_label(pUiCtx, "GPU memory", NK_TEXT_LEFT);
 
-			VkBufferCopy copyRegion = {0,0,sizeBytes };
-			auto copyCommandBuffer = CreateCommandBuffer(logicalDevice, commandPool);
-			StartRecording(copyCommandBuffer);
-			vkCmdCopyBuffer(copyCommandBuffer, stagingBuffer, buffer, 1, &copyRegion);
-			StopRecording(copyCommandBuffer);
-			
-			ExecuteCommands(copyCommandBuffer, queue);
+			auto categories = GetCategories();
+			for (size_t i = 0; i < categories.size(); ++i) {
+				auto& counts = categories[i]._objectCounts;
+				if (categories[i]._bytes == 0 && counts[(size_t)ObjectType::Buffer] == 0 && counts[(size_t)ObjectType::Image] == 0 && counts[(size_t)ObjectType::DescriptorPool] == 0) continue;
+				nk_layout_row_dynamic(pUiCtx, 16, 2);
+				snprintf(text, sizeof(text), "  %s: %llu buf, %llu img, %llu pools", _categoryNames[i], (unsigned long long)counts[(size_t)ObjectType::Buffer], (unsigned long long)counts[(size_t)ObjectType::Image], (unsigned long long)counts[(size_t)ObjectType::DescriptorPool]);
+				nk_label(pUiCtx, text, NK_TEXT_LEFT);
+				snprintf(text, sizeof(text), "%.1f MB (peak %.1f)", categories[i]._bytes / (1024.0 * 1024.0), categories[i]._peakBytes / (1024.0 * 1024.0));
+				nk_label(pUiCtx, text, NK_TEXT_RIGHT);
+			}
 
-			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &copyCommandBuffer);
-			DestroyBuffer(logicalDevice, stagingBuffer, stagingBufferGpuMemory, true);
+			// Without budgets, the heaps show how much of them the engine allocated out of their size.
+			auto heaps = GetHeaps();
+			for (size_t i = 0; i < heaps.size(); ++i) {
+				nk_layout_row_dynamic(pUiCtx, 16, 2);
+				snprintf(text, sizeof(text), "  heap %zu%s", i, heaps[i]._isDeviceLocal ? " (device local)" : "");
+				nk_label(pUiCtx, text, NK_TEXT_LEFT);
+				if (heaps[i]._budgetBytes > 0) snprintf(text, sizeof(text), "%.1f / %.1f MB", heaps[i]._usageBytes / (1024.0 * 1024.0), heaps[i]._budgetBytes / (1024.0 * 1024.0));
+				else snprintf(text, sizeof(text), "%.1f / %.1f MB", heaps[i]._bytes / (1024.0 * 1024.0), heaps[i]._sizeBytes / (1024.0 * 1024.0));
+				nk_label(pUiCtx, text, NK_TEXT_RIGHT);
+			}
 		}
 
-		static VkShaderModule CreateShaderModule(VkDevice logicalDevice, const char* absolutePath) {
-			std::ifstream file(absolutePath, std::ios::ate | std::ios::binary);
-			if (!file.is_open()) { std::cout << "Failed opening file " << absolutePath << std::endl; exit(0); }
+		/**
+		 * @brief Writes the statistics of every category and heap as a JSON object.
+		 */
+		void Write(sjson::writer& json) {
+			json.start_object().key("categories").start_object();
+			auto categories = GetCategories();
+			for (size_t i = 0; i < categories.size(); ++i) {
+				json.key(_categoryNames[i]).start_object();
+				for (size_t j = 0; j < std::size(_objectTypeNames); ++j) json.key(_objectTypeNames[j]).number(categories[i]._objectCounts[j]);
+				json.key("bytes").number(categories[i]._bytes).key("peakBytes").number(categories[i]._peakBytes).end_object();
+			}
+			json.end_object().key("heaps").start_array();
+			for (auto& heap : GetHeaps()) {
+				json.start_object().key("sizeBytes").number((uint64_t)heap._sizeBytes).key("deviceLocal").boolean(heap._isDeviceLocal).key("bytes").number(heap._bytes);
+				if (heap._budgetBytes > 0) json.key("usageBytes").number((uint64_t)heap._usageBytes).key("budgetBytes").number((uint64_t)heap._budgetBytes);
+				json.end_object();
+			}
+			json.end_array().end_object();
+		}
 
-			std::vector<char> fileBytes(file.tellg());
-			file.seekg(0, std::ios::beg);
-			file.read(fileBytes.data(), fileBytes.size());
-			file.close();
+		/**
+		 * @brief Logs what is still alive in each category. Called at shutdown, once everything the engine owns should have been destroyed.
+		 */
+		void LogLiveResources() {
+			auto categories = GetCategories();
+			for (size_t i = 0; i < categories.size(); ++i) {
+				auto& counts = categories[i]._objectCounts;
+				if (counts[(size_t)ObjectType::Buffer] == 0 && counts[(size_t)ObjectType::Image] == 0 && counts[(size_t)ObjectType::DescriptorPool] == 0 && counts[(size_t)ObjectType::Allocation] == 0) continue;
+				Logger::Warning("{} resources still alive: {} buffers, {} images, {} descriptor pools, {} allocations holding {} bytes", _categoryNames[i], counts[(size_t)ObjectType::Buffer],
+					counts[(size_t)ObjectType::Image], counts[(size_t)ObjectType::DescriptorPool], counts[(size_t)ObjectType::Allocation], categories[i]._bytes);
+			}
+		}
 
-			VkShaderModuleCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-			createInfo.codeSize = fileBytes.size();
-			createInfo.pCode = (uint32_t*)fileBytes.data();
-			VkShaderModule shaderModule = nullptr;
-			CheckResult(vkCreateShaderModule(logicalDevice, &createInfo, nullptr, &shaderModule));
+	private:
 
-			return shaderModule;
-		}
+		struct Allocation {
+			VkDeviceSize _sizeBytes;
+			Category _category;
+			uint32_t _heapIndex;
+		};
 
-		static void DestroyBuffer(VkDevice& logicalDevice, VkBuffer& buffer, VkDeviceMemory& gpuMemory, const bool& isMemoryMapped) {
-			vkDestroyBuffer(logicalDevice, buffer, nullptr);
-			if (isMemoryMapped)
-				vkUnmapMemory(logicalDevice, gpuMemory);
-			if (gpuMemory)
-				vkFreeMemory(logicalDevice, gpuMemory, nullptr);
-		}
+		/**
+		 * @brief Category of what the calling thread creates, set by Scope.
+		 */
+		static inline thread_local Category _currentCategory = Category::Other;
 
-		// A function that transfers data from the GPU to the CPU using staging buffer, because GPU memory is not host-coherent (meaning it is
-		// not synced with the contents of CPU memory).
-		static void DownloadData(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkFence queueFence, VkQueue queue, int sizeOutputBytes, VkBuffer& srcBuffer, void* outDstData) {
-			// Create a temporary CPU-side vulkan buffer to store the data we want to download
-			VkBuffer stagingBuffer;
-			VkDeviceMemory stagingBufferGpuMemory;
-			CreateBuffer(logicalDevice,
-				physicalDevice,
-				sizeOutputBytes,
-				VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				&stagingBuffer,
-				&stagingBufferGpuMemory);
+		std::mutex _mutex;
+		CategoryStatistics _categories[(size_t)Category::Count];
 
-			// Record commands to copy data to download from the input buffer to this temporary staging buffer
-			VkBufferCopy copyRegion = { 0, 0, sizeOutputBytes };
-			auto commandBuffer = CreateCommandBuffer(logicalDevice, commandPool);
-			StartRecording(commandBuffer);
-			vkCmdCopyBuffer(commandBuffer, srcBuffer, stagingBuffer, 1, &copyRegion);
-			StopRecording(commandBuffer);
+		/**
+		 * @brief Category of every live object, keyed by its device, type and handle. Handles of different types may be equal, and so may handles of
+		 * different devices, such as the logical device of the renderer and the compute device of the physics thread.
+		 */
+		std::map<std::tuple<VkDevice, ObjectType, uint64_t>, Category> _objects;
+		std::map<std::pair<VkDevice, VkDeviceMemory>, Allocation> _allocations;
+		std::vector<uint64_t> _heapBytes;
+		VkPhysicalDeviceMemoryProperties _memoryProperties{};
+		VkPhysicalDevice _physicalDevice = VK_NULL_HANDLE;
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR _pGetMemoryProperties2 = nullptr;
 
-			// Execute the command above. We will then have the downloaded data in the staging buffer
-			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, 0, 0, NULL, NULL, 1, &commandBuffer, 0, NULL };
-			CheckResult(vkQueueSubmit(queue, 1, &submitInfo, queueFence));
-			CheckResult(vkWaitForFences(logicalDevice, 1, &queueFence, VK_TRUE, 100000000000));
-			CheckResult(vkResetFences(logicalDevice, 1, &queueFence));
+		void Add(VkDevice device, ObjectType type, uint64_t handle) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_objects[{ device, type, handle }] = _currentCategory;
+			_categories[(size_t)_currentCategory]._objectCounts[(size_t)type]++;
+		}
 
-			// Copy the data to actual CPU memory
-			void* stagingData;
-			CheckResult(vkMapMemory(logicalDevice, stagingBufferGpuMemory, 0, sizeOutputBytes, 0, &stagingData));
-			memcpy(outDstData, stagingData, sizeOutputBytes);
-			DestroyBuffer(logicalDevice, stagingBuffer, stagingBufferGpuMemory, true);
-			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+		/**
+		 * @brief Objects that were not created through the tracker, such as swapchain images, are ignored. Called before the object is destroyed, for the
+		 * same reason as in FreeMemory.
+		 */
+		void Remove(VkDevice device, ObjectType type, uint64_t handle) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto found = _objects.find({ device, type, handle });
+			if (found == _objects.end()) return;
+			_categories[(size_t)found->second]._objectCounts[(size_t)type]--;
+			_objects.erase(found);
 		}
 	};
 
-	struct Buffer {
-		VkBufferCreateInfo _createInfo{};
-		VkBufferViewCreateInfo _viewCreateInfo{};
+	/**
+	 * @brief Frame profiler. CPU time is measured with ScopedZone, which records when it is created and destroyed. Every thread writes its zones to a ring
+	 * of its own without locking, and the main thread collects them once per frame in EndFrame. GPU time is measured with timestamp queries written around
+	 * the passes of the draw command buffers, see BeginGpuZone. The per frame averages are shown in an overlay toggled with F3, and the zones of the last
+	 * seconds can be saved as a Chrome trace with F4, to be opened in chrome://tracing or ui.perfetto.dev.
+	 */
+	class Profiler : public Singleton<Profiler> {
+		struct Ring;
 
-		VkBuffer _buffer{};
-		VkBufferView _view{};
+	public:
 
 		/**
-		 * @brief Vulkan-only handle that Vulkan uses to handle the buffer on GPU memory.
+		 * @brief A measured span of time. Names must be string literals: zones are told apart by the address of their name.
 		 */
-		VkDeviceMemory _gpuMemory = nullptr;
+		struct Zone {
+			const char* _name;
+			uint64_t _startNanoseconds;
+			uint64_t _endNanoseconds;
+			uint32_t _threadIndex;
+			uint32_t _depth;
+		};
 
 		/**
-		 * @brief Pointer to CPU-accessible memory that Vulkan uses to read/write memory from/to the buffer. This is separate from _pData because Vulkan might need to
-		 * also tell the GPU where this data is stored, and by making this being able to be set only via Vulkan calls, it ensures that it catches all changes to the data
-		 * and maintains it coherent across CPU and GPU.
+		 * @brief Measures the CPU time from its creation to the end of its scope.
 		 */
-		void* _cpuMemory = nullptr;
+		class ScopedZone {
+		public:
+
+			ScopedZone(const char* name) {
+				auto& profiler = Instance();
+				if (!profiler._isEnabled.load(std::memory_order_relaxed)) return;
+				_pRing = &profiler.GetThreadRing();
+				_name = name;
+				_depth = _pRing->_depth++;
+				_startNanoseconds = profiler.GetTime();
+			}
+
+			~ScopedZone() {
+				if (_pRing == nullptr) return;
+				_pRing->_depth--;
+				_pRing->Push(Zone{ _name, _startNanoseconds, Instance().GetTime(), _pRing->_threadIndex, _depth });
+			}
+
+			ScopedZone(const ScopedZone&) = delete;
+			ScopedZone& operator=(const ScopedZone&) = delete;
+
+		private:
+
+			Ring* _pRing = nullptr;
+			const char* _name = nullptr;
+			uint64_t _startNanoseconds = 0;
+			uint32_t _depth = 0;
+		};
 
 		/**
-		 * @brief Pointer to CPU-only visible data.
+		 * @brief Whether the overlay is drawn.
 		 */
-		void* _pData = nullptr;
-
-		size_t _sizeBytes = 0;
+		bool _isOverlayVisible = false;
 
-		Buffer() = default;
+		Profiler() {
+			_startTime = std::chrono::steady_clock::now();
+		}
 
-		Buffer(void* pData, size_t sizeBytes) {
-			_pData = pData;
-			_sizeBytes = sizeBytes;
+		/**
+		 * @brief Nanoseconds since the profiler was created.
+		 */
+		uint64_t GetTime() const {
+			return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _startTime).count();
 		}
 
-		static void CopyToDeviceMemory(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool commandPool, VkQueue queue, VkBuffer buffer, void* pData, size_t sizeBytes) {
-			// Create a temporary buffer.
-			Buffer stagingBuffer{};
-			stagingBuffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			stagingBuffer._createInfo.size = sizeBytes;
-			stagingBuffer._createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			vkCreateBuffer(logicalDevice, &stagingBuffer._createInfo, nullptr, &stagingBuffer._buffer);
+		/**
+		 * @brief Turns measuring on or off. Safe to call from any thread.
+		 */
+		void SetEnabled(bool isEnabled) {
+			_isEnabled.store(isEnabled, std::memory_order_relaxed);
+		}
 
-			// Allocate memory for the buffer.
-			VkMemoryRequirements requirements{};
-			vkGetBufferMemoryRequirements(logicalDevice, stagingBuffer._buffer, &requirements);
-			stagingBuffer._gpuMemory = PhysicalDevice::AllocateMemory(physicalDevice, logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		/**
+		 * @brief Names the calling thread in the overlay and in traces.
+		 */
+		void SetThreadName(const std::string& name) {
+			auto threadIndex = GetThreadRing()._threadIndex;
+			std::lock_guard<std::mutex> lock(_mutex);
+			_threadNames[threadIndex] = name;
+		}
 
-			// Map memory to the correct GPU and CPU ranges for the buffer.
-			vkBindBufferMemory(logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, 0);
-			vkMapMemory(logicalDevice, stagingBuffer._gpuMemory, 0, sizeBytes, 0, &stagingBuffer._cpuMemory);
-			memcpy(stagingBuffer._cpuMemory, pData, sizeBytes);
+		/**
+		 * @brief Creates a timestamp query pool for each of the frameCount command buffers GPU zones are recorded in. GPU zones are not recorded
+		 * if the queue cannot write timestamps.
+		 */
+		void CreateGpuQueries(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t frameCount) {
+			uint32_t queueFamilyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+			auto validBits = queueFamilyIndex < queueFamilyCount ? queueFamilies[queueFamilyIndex].timestampValidBits : 0;
+			if (validBits == 0) {
+				Logger::Info("the queue cannot write timestamps, GPU zones will not be profiled");
+				return;
+			}
+			_timestampMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
 
-			auto copyCommandBuffer = VkHelper::CreateCommandBuffer(logicalDevice, commandPool);
-			VkHelper::StartRecording(copyCommandBuffer);
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+			_timestampPeriod = properties.limits.timestampPeriod;
 
-			VkBufferCopy copyRegion = {};
-			copyRegion.size = sizeBytes;
-			vkCmdCopyBuffer(copyCommandBuffer, stagingBuffer._buffer, buffer, 1, &copyRegion);
+			if (_gpuThreadIndex == UINT32_MAX) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				_gpuThreadIndex = _nextThreadIndex++;
+				_threadNames[_gpuThreadIndex] = "GPU";
+			}
 
-			VkHelper::StopRecording(copyCommandBuffer);
-			VkHelper::ExecuteCommands(copyCommandBuffer, queue);
+			_gpuFrames.resize(frameCount);
+			for (auto& frame : _gpuFrames) {
+				VkQueryPoolCreateInfo createInfo{};
+				createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+				createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+				createInfo.queryCount = _maxGpuZones * 2;
+				CheckResult(vkCreateQueryPool(logicalDevice, &createInfo, nullptr, &frame._queryPool));
+			}
+		}
 
-			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &copyCommandBuffer);
-			vkDestroyBuffer(logicalDevice, stagingBuffer._buffer, nullptr);
+		void DestroyGpuQueries(VkDevice logicalDevice) {
+			for (auto& frame : _gpuFrames) vkDestroyQueryPool(logicalDevice, frame._queryPool, nullptr);
+			_gpuFrames.clear();
 		}
-	};
 
-	void CopyImageToDeviceMemory(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool& commandPool, VkQueue& queue, VkImage& image, int width, int height, int depth, void* pData, size_t sizeBytes) {
-		// Create a temporary buffer.
-		Buffer stagingBuffer{};
-		stagingBuffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		stagingBuffer._createInfo.size = sizeBytes;
-		stagingBuffer._createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		vkCreateBuffer(logicalDevice, &stagingBuffer._createInfo, nullptr, &stagingBuffer._buffer);
+		/**
+		 * @brief Called when recording of the command buffer of frameIndex begins, at which point the GPU is done with the commands recorded in it before.
+		 * Reads back the GPU zones recorded the last time and resets the queries.
+		 */
+		void BeginGpuFrame(VkDevice logicalDevice, VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+			if (frameIndex >= _gpuFrames.size()) return;
+			auto& frame = _gpuFrames[frameIndex];
+			if (frame._isSubmitted && frame._zoneNames.size() > 0) {
+				std::vector<uint64_t> timestamps(frame._zoneNames.size() * 2);
+				auto result = vkGetQueryPoolResults(logicalDevice, frame._queryPool, 0, (uint32_t)timestamps.size(), timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+				if (result == VK_SUCCESS) {
+					// GPU and CPU clocks are not synchronized: the first timestamp of the frame is placed at the time the command buffer was submitted.
+					auto firstTimestamp = timestamps[0] & _timestampMask;
+					for (size_t i = 0; i < frame._zoneNames.size(); ++i) {
+						auto start = (double)((timestamps[i * 2] & _timestampMask) - firstTimestamp) * _timestampPeriod;
+						auto end = (double)((timestamps[i * 2 + 1] & _timestampMask) - firstTimestamp) * _timestampPeriod;
+						_gpuZones.push_back(Zone{ frame._zoneNames[i], frame._submitNanoseconds + (uint64_t)start, frame._submitNanoseconds + (uint64_t)end, _gpuThreadIndex, frame._zoneDepths[i] });
+					}
+				}
+			}
 
-		// Allocate memory for the buffer.
-		VkMemoryRequirements requirements{};
-		vkGetBufferMemoryRequirements(logicalDevice, stagingBuffer._buffer, &requirements);
-		stagingBuffer._gpuMemory = PhysicalDevice::AllocateMemory(physicalDevice, logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			frame._zoneNames.clear();
+			frame._zoneDepths.clear();
+			frame._depth = 0;
+			frame._isSubmitted = false;
+			if (_isEnabled.load(std::memory_order_relaxed)) vkCmdResetQueryPool(commandBuffer, frame._queryPool, 0, _maxGpuZones * 2);
+			else frame._depth = UINT32_MAX;
+		}
 
-		// Map memory to the correct GPU and CPU ranges for the buffer.
-		vkBindBufferMemory(logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, 0);
-		vkMapMemory(logicalDevice, stagingBuffer._gpuMemory, 0, sizeBytes, 0, &stagingBuffer._cpuMemory);
-		memcpy(stagingBuffer._cpuMemory, pData, sizeBytes);
+		/**
+		 * @brief Writes the timestamp starting a GPU zone to the command buffer of frameIndex. Returns the zone to pass to EndGpuZone.
+		 */
+		uint32_t BeginGpuZone(VkCommandBuffer commandBuffer, uint32_t frameIndex, const char* name) {
+			if (frameIndex >= _gpuFrames.size()) return UINT32_MAX;
+			auto& frame = _gpuFrames[frameIndex];
+			if (frame._depth == UINT32_MAX || frame._zoneNames.size() >= _maxGpuZones) return UINT32_MAX;
+			auto zone = (uint32_t)frame._zoneNames.size();
+			frame._zoneNames.push_back(name);
+			frame._zoneDepths.push_back(frame._depth++);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame._queryPool, zone * 2);
+			return zone;
+		}
 
-		auto commandBuffer = VkHelper::CreateCommandBuffer(logicalDevice, commandPool);
-		VkHelper::StartRecording(commandBuffer);
+		void EndGpuZone(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t zone) {
+			if (zone == UINT32_MAX) return;
+			auto& frame = _gpuFrames[frameIndex];
+			frame._depth--;
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame._queryPool, zone * 2 + 1);
+		}
 
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.srcAccessMask = VK_ACCESS_NONE;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		barrier.image = image;
-		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
-		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		/**
+		 * @brief Called when the command buffer of frameIndex is submitted.
+		 */
+		void OnGpuSubmit(uint32_t frameIndex) {
+			if (frameIndex >= _gpuFrames.size()) return;
+			_gpuFrames[frameIndex]._isSubmitted = true;
+			_gpuFrames[frameIndex]._submitNanoseconds = GetTime();
+		}
 
-		VkBufferImageCopy copyInfo{};
-		copyInfo.bufferImageHeight = height;
-		copyInfo.bufferRowLength = width;
-		copyInfo.imageExtent = { (uint32_t)width, (uint32_t)height, (uint32_t)depth };
-		copyInfo.imageOffset = { 0,0,0 };
-		copyInfo.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
-		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer._buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyInfo);
+		/**
+		 * @brief Collects the zones recorded since the last call and updates the averages shown in the overlay, along with the time between calls and how
+		 * much it varies. Called by the main thread once per frame.
+		 */
+		void EndFrame() {
+			std::vector<std::shared_ptr<Ring>> rings;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				rings = _rings;
+			}
 
-		VkHelper::StopRecording(commandBuffer);
-		VkHelper::ExecuteCommands(commandBuffer, queue);
+			_frameZones.clear();
+			for (auto& statistic : _statistics) statistic._frameMilliseconds = 0.0;
+			auto collect = [this](const Zone& zone) {
+				auto key = std::make_pair(zone._threadIndex, zone._name);
+				auto found = _statisticIndices.find(key);
+				if (found == _statisticIndices.end()) {
+					found = _statisticIndices.emplace(key, _statistics.size()).first;
+					_statistics.push_back(Statistic{ zone._name, zone._threadIndex, zone._depth, 0.0, 0.0 });
+				}
+				_statistics[found->second]._frameMilliseconds += (zone._endNanoseconds - zone._startNanoseconds) * 1e-6;
+				_history.push_back(zone);
+				_frameZones.push_back(zone);
+			};
 
-		vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
-		vkDestroyBuffer(logicalDevice, stagingBuffer._buffer, nullptr);
-	}
+			for (auto& pRing : rings) {
+				auto readCount = pRing->_readCount.load(std::memory_order_relaxed);
+				auto writeCount = pRing->_writeCount.load(std::memory_order_acquire);
+				for (; readCount < writeCount; ++readCount) collect(pRing->_zones[readCount % Ring::_capacity]);
+				pRing->_readCount.store(readCount, std::memory_order_release);
+			}
+			for (auto& zone : _gpuZones) collect(zone);
+			_gpuZones.clear();
 
-	inline std::string Format(float value) {
-		return (value >= 0.0f) ? " " + std::to_string(value) : std::to_string(value);
-	}
+			for (auto& statistic : _statistics) statistic._averageMilliseconds += (statistic._frameMilliseconds - statistic._averageMilliseconds) * 0.05;
 
-	inline std::ostream& operator << (std::ostream& stream, const glm::mat4& matrix) {
-		stream << Format(matrix[0][0]) << ", " << Format(matrix[0][1]) << ", " << Format(matrix[0][2]) << ", " << Format(matrix[0][3]) << "\n";
-		stream << Format(matrix[1][0]) << ", " << Format(matrix[1][1]) << ", " << Format(matrix[1][2]) << ", " << Format(matrix[1][3]) << "\n";
-		stream << Format(matrix[2][0]) << ", " << Format(matrix[2][1]) << ", " << Format(matrix[2][2]) << ", " << Format(matrix[2][3]) << "\n";
-		stream << Format(matrix[3][0]) << ", " << Format(matrix[3][1]) << ", " << Format(matrix[3][2]) << ", " << Format(matrix[3][3]);
-		return stream;
-	}
+			auto now = GetTime();
+			if (_lastFrameEndNanoseconds > 0) {
+				auto frameMilliseconds = (now - _lastFrameEndNanoseconds) * 1e-6;
+				auto difference = frameMilliseconds - _averageFrameMilliseconds;
+				_averageFrameMilliseconds += difference * 0.05;
+				_frameMillisecondsVariance = (1.0 - 0.05) * (_frameMillisecondsVariance + 0.05 * difference * difference);
+			}
+			_lastFrameEndNanoseconds = now;
 
-	inline std::ostream& operator<< (std::ostream& stream, const glm::vec3& vector) {
-		return stream << "(" << vector.x << ", " << vector.y << ", " << vector.z << ")";
-	}
+			// Only the last seconds are kept for traces.
+			while (_history.size() > 0 && (_history.front()._endNanoseconds + _historyNanoseconds < now || _history.size() > _maxHistoryZones)) _history.pop_front();
 
-	inline std::ostream& operator<< (std::ostream& stream, const glm::vec3&& vector) {
-		return stream << "(" << vector.x << ", " << vector.y << ", " << vector.z << ")";
-	}
-
-	/**
-	 * @brief Prints a message to a stream given a function that does the printing and a message.
-	 * Default function prints to standard output (console).
-	 * @param message The message to print.
-	 * @param logFunction Logging function. Defaults to a function printing to the console window.
-	 */
-	inline void Print(const std::string& message, void(*logFunction) (const std::string&) = [](const std::string& message) { std::cout << message << std::endl; }) {
-		logFunction(message);
-	}
-
-	/**
-	 * @brief Represents a column-major 4x4 matrix transform in a left handed X right, Y up, Z forward coordinate system.
-	 */
-	class Transform {
-
-	public:
-
-		glm::mat4x4 _matrix;
-		glm::vec3 _scale;
-
-		/**
-		 * @brief Returns the transform to take another transform from right-handed gltf space (X left, Y up, Z forward)
-		 * to left-handed engine space (X right, Y up, Z forward).
-		 */
-		static Transform GltfToEngine() {
-			return Transform(glm::mat4x4{
-				glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f), // Column 1
-				glm::vec4(0.0f,  1.0f, 0.0f, 0.0f), // Column 2
-				glm::vec4(0.0f,  0.0f, 1.0f, 0.0f), // Column 3
-				glm::vec4(0.0f,  0.0f, 0.0f, 1.0f)	// Column 4
-				});
-		}
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::erase_if(_rings, [](const std::shared_ptr<Ring>& pRing) {
+				return pRing->_isAbandoned.load(std::memory_order_acquire) && pRing->_readCount.load(std::memory_order_relaxed) == pRing->_writeCount.load(std::memory_order_acquire);
+			});
+		}
 
 		/**
-		 * @brief Constructs a transform using the identity matrix for both _scale and _matrix.
+		 * @brief Zones collected by the last EndFrame call. GPU zones are collected a frame or more after they are recorded.
 		 */
-		Transform() = default;
-
-		Transform(glm::mat4x4 matrix) : _matrix(matrix) {}
-
-		glm::vec3 Right() {
-			glm::vec4 right = _matrix * glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-			return glm::vec3(right.x, right.y, right.z);
-		}
-
-		glm::vec3 Up() {
-			glm::vec4 up = _matrix * glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
-			return glm::vec3(up.x, up.y, up.z);
+		const std::vector<Zone>& GetFrameZones() const {
+			return _frameZones;
 		}
 
-		glm::vec3 Forward() {
-			glm::vec4 forward = _matrix * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
-			return glm::vec3(forward.x, forward.y, forward.z);
+		bool IsGpuZone(const Zone& zone) const {
+			return zone._threadIndex == _gpuThreadIndex;
 		}
 
-		void Translate(const glm::vec3& offsetLocalSpace) {
-			_matrix[3][0] += offsetLocalSpace.x;
-			_matrix[3][1] += offsetLocalSpace.y;
-			_matrix[3][2] += offsetLocalSpace.z;
-		}
+		/**
+		 * @brief Draws the average frame time and its deviation, then the average time per frame spent in each zone, grouped by thread. Called by the
+		 * main thread while building the UI.
+		 */
+		void DrawOverlay(nk_context* pUiCtx, float windowWidth) {
+			if (!_isOverlayVisible) return;
+			if (nk_begin(pUiCtx, "Profiler", nk_rect(windowWidth - 370.0f, 10.0f, 360.0f, 420.0f), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE | NK_WINDOW_MINIMIZABLE)) {
+				std::vector<const Statistic*> statistics;
+				for (auto& statistic : _statistics) statistics.push_back(&statistic);
+				std::stable_sort(statistics.begin(), statistics.end(), [](const Statistic* a, const Statistic* b) { return a->_threadIndex < b->_threadIndex; });
 
-		void RotateAroundPosition(const glm::vec3& positionWorldSpace, const glm::vec3& axisWorldSpace, const float& angleRadians) {
-			if (angleRadians == 0) return;
-			auto rotation = MakeQuaternionRotation(axisWorldSpace, angleRadians);
-			auto currentPosition = Position();
-			SetPosition(positionWorldSpace + (rotation * (currentPosition - positionWorldSpace)));
-			Rotate(rotation);
-		}
+				char text[128];
+				nk_layout_row_dynamic(pUiCtx, 18, 2);
+				nk_label(pUiCtx, "Frame", NK_TEXT_LEFT);
+				snprintf(text, sizeof(text), "%.2f ms, deviation %.2f ms", _averageFrameMilliseconds, std::sqrt(_frameMillisecondsVariance));
+				nk_label(pUiCtx, text, NK_TEXT_RIGHT);
 
-		glm::quat MakeQuaternionRotation(const glm::vec3& axis, const float& angleRadians) {
-			auto cosine = cos(angleRadians / 2.0f);
-			auto sine = sin(angleRadians / 2.0f);
-			return glm::quat(cosine, axis.x * sine, axis.y * sine, axis.z * sine);
+				auto threadIndex = UINT32_MAX;
+				for (auto pStatistic : statistics) {
+					if (pStatistic->_threadIndex != threadIndex) {
+						threadIndex = pStatistic->_threadIndex;
+						nk_layout_row_dynamic(pUiCtx, 18, 1);
+						nk_label(pUiCtx, GetThreadName(threadIndex).c_str(), NK_TEXT_LEFT);
+					}
+					nk_layout_row_dynamic(pUiCtx, 16, 2);
+					snprintf(text, sizeof(text), "%*s%s", (int)(pStatistic->_depth + 1) * 2, "", pStatistic->_name);
+					nk_label(pUiCtx, text, NK_TEXT_LEFT);
+					snprintf(text, sizeof(text), "%.2f ms", pStatistic->_averageMilliseconds);
+					nk_label(pUiCtx, text, NK_TEXT_RIGHT);
+				}
+				ResourceTracker::Instance().DrawOverlay(pUiCtx);
+			}
+			nk_end(pUiCtx);
 		}
 
-		void Rotate(const glm::quat& rotation) {
-			// Rotate each individual axis of the transformation by the quaternion.
-			auto newX = rotation * glm::vec3(_matrix[0][0], _matrix[0][1], _matrix[0][2]);
-			auto newY = rotation * glm::vec3(_matrix[1][0], _matrix[1][1], _matrix[1][2]);
-			auto newZ = rotation * glm::vec3(_matrix[2][0], _matrix[2][1], _matrix[2][2]);
-
-			// Set the new axes starting with X.
-			_matrix[0][0] = newX.x;
-			_matrix[0][1] = newX.y;
-			_matrix[0][2] = newX.z;
-
-			// Then Y.
-			_matrix[1][0] = newY.x;
-			_matrix[1][1] = newY.y;
-			_matrix[1][2] = newY.z;
+		/**
+		 * @brief Saves the zones of the last seconds to absolutePath in the Chrome trace event format. Called by the main thread.
+		 */
+		bool SaveTrace(const std::filesystem::path& absolutePath) {
+			std::error_code error;
+			std::filesystem::create_directories(absolutePath.parent_path(), error);
+			auto pFile = fopen(absolutePath.string().c_str(), "wb");
+			if (pFile == nullptr) {
+				Logger::Warning("failed saving profiler trace to {}", absolutePath);
+				return false;
+			}
 
-			// And finally Z.
-			_matrix[2][0] = newZ.x;
-			_matrix[2][1] = newZ.y;
-			_matrix[2][2] = newZ.z;
-		}
+			{
+				sjson::writer json(sjson::writer::file_sink(pFile));
+				json.start_object().key("traceEvents").start_array();
 
-		void RotateR(const glm::vec3& axis, const float& angleRadians) {
-			if (angleRadians == 0.0f) { return; }
-			Rotate(MakeQuaternionRotation(axis, angleRadians));
-		}
+				std::map<uint32_t, std::string> threadNames;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					threadNames = _threadNames;
+				}
+				for (auto& [threadIndex, name] : threadNames) {
+					json.start_object().key("name").string("thread_name").key("ph").string("M").key("pid").number(1).key("tid").number(threadIndex);
+					json.key("args").start_object().key("name").string(name).end_object().end_object();
+				}
 
-		void Rotate(const glm::vec3& axis, const float& angleDegrees) {
-			if (angleDegrees == 0.0f) { return; }
-			RotateR(axis, glm::radians(angleDegrees));
+				// Timestamps are in microseconds.
+				for (auto& zone : _history) {
+					json.start_object().key("name").string(zone._name).key("ph").string("X").key("pid").number(1).key("tid").number(zone._threadIndex);
+					json.key("ts").number(zone._startNanoseconds * 1e-3).key("dur").number((zone._endNanoseconds - zone._startNanoseconds) * 1e-3).end_object();
+				}
+				json.end_array().key("displayTimeUnit").string("ms").end_object();
+			}
+			fclose(pFile);
+			Logger::Info("saved profiler trace of {} zones to {}", _history.size(), absolutePath);
+			return true;
 		}
 
-		void SetPosition(const glm::vec3& position) {
-			_matrix[3][0] = position.x;
-			_matrix[3][1] = position.y;
-			_matrix[3][2] = position.z;
-		}
+	private:
 
-		void SetScale(const glm::vec3& scale) {
-			_scale = scale;
-			_matrix[0][0] *= scale.x;
-			_matrix[1][1] *= scale.y;
-			_matrix[2][2] *= scale.z;
-		}
+		/**
+		 * @brief Ring of the zones of one thread, written by the thread and read by EndFrame. When the main thread does not keep up, such as while
+		 * the engine is initializing, the newest zones are dropped.
+		 */
+		struct Ring {
+			static constexpr size_t _capacity = 4096;
+			Zone _zones[_capacity];
+			std::atomic<uint64_t> _writeCount = 0;
+			std::atomic<uint64_t> _readCount = 0;
+			std::atomic<bool> _isAbandoned = false;
+			uint32_t _threadIndex = 0;
 
-		glm::vec3 Position() {
-			return glm::vec3(_matrix[3][0], _matrix[3][1], _matrix[3][2]);
-		}
-	};
+			/**
+			 * @brief Depth of the zone the thread is in, only used by the thread.
+			 */
+			uint32_t _depth = 0;
 
-	class Image {
-	public:
-		VkImageCreateInfo _createInfo{};
-		VkImageViewCreateInfo _viewCreateInfo{};
-		VkSamplerCreateInfo _samplerCreateInfo{};
+			void Push(const Zone& zone) {
+				auto writeCount = _writeCount.load(std::memory_order_relaxed);
+				if (writeCount - _readCount.load(std::memory_order_acquire) >= _capacity) return;
+				_zones[writeCount % _capacity] = zone;
+				_writeCount.store(writeCount + 1, std::memory_order_release);
+			}
+		};
 
-		VkImage _image{};
-		VkImageView _view{};
-		VkSampler _sampler{};
+		/**
+		 * @brief Owns the calling thread's reference to its ring, and marks the ring as abandoned when the thread exits.
+		 */
+		struct ThreadRing {
+			std::shared_ptr<Ring> _pRing;
 
-		VkImageLayout _currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		VkDeviceMemory _gpuMemory = nullptr;
-		void* _pData = nullptr;
-		size_t _sizeBytes = 0;
+			~ThreadRing() {
+				if (_pRing) _pRing->_isAbandoned.store(true, std::memory_order_release);
+			}
+		};
 
-		Image() = default;
+		/**
+		 * @brief Timestamp queries of one of the command buffers GPU zones are recorded in.
+		 */
+		struct GpuFrame {
+			VkQueryPool _queryPool = VK_NULL_HANDLE;
+			std::vector<const char*> _zoneNames;
+			std::vector<uint32_t> _zoneDepths;
 
-		Image(void* pData, size_t sizeBytes) {
-			_pData = pData;
-			_sizeBytes = sizeBytes;
-		}
+			/**
+			 * @brief Depth of the next zone, or UINT32_MAX if zones are not recorded this time.
+			 */
+			uint32_t _depth = 0;
+			bool _isSubmitted = false;
+			uint64_t _submitNanoseconds = 0;
+		};
 
-		static Image SolidColor(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
-			Image image;
+		/**
+		 * @brief Time spent in the zones with the same name on the same thread.
+		 */
+		struct Statistic {
+			const char* _name;
+			uint32_t _threadIndex;
+			uint32_t _depth;
+			double _frameMilliseconds;
+			double _averageMilliseconds;
+		};
 
-			image._sizeBytes = 4;
-			image._pData = malloc(image._sizeBytes);
-			unsigned char imageData[4] = { r, g, b, a };
-			memcpy(image._pData, imageData, image._sizeBytes);
+		static constexpr uint32_t _maxGpuZones = 32;
+		static constexpr uint64_t _historyNanoseconds = 10000000000ull;
+		static constexpr size_t _maxHistoryZones = 1 << 20;
 
-			auto& imageCreateInfo = image._createInfo;
-			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-			imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-			imageCreateInfo.extent = { 1, 1, 1 };
-			imageCreateInfo.mipLevels = 1;
-			imageCreateInfo.arrayLayers = 1;
-			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-			imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-			vkCreateImage(logicalDevice, &imageCreateInfo, nullptr, &image._image);
+		std::atomic<bool> _isEnabled = true;
+		std::chrono::steady_clock::time_point _startTime;
 
-			VkMemoryRequirements reqs;
-			vkGetImageMemoryRequirements(logicalDevice, image._image, &reqs);
+		/**
+		 * @brief Guards the list of rings and the thread names.
+		 */
+		std::mutex _mutex;
+		std::vector<std::shared_ptr<Ring>> _rings;
+		std::map<uint32_t, std::string> _threadNames;
+		uint32_t _nextThreadIndex = 0;
 
-			VkMemoryAllocateInfo allocInfo{};
-			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocInfo.allocationSize = reqs.size;
-			allocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		std::vector<GpuFrame> _gpuFrames;
+		std::vector<Zone> _gpuZones;
+		uint32_t _gpuThreadIndex = UINT32_MAX;
+		uint64_t _timestampMask = 0;
+		float _timestampPeriod = 1.0f;
 
-			VkDeviceMemory mem;
-			vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &mem);
-			vkBindImageMemory(logicalDevice, image._image, mem, 0);
+		/**
+		 * @brief Only used by the main thread.
+		 */
+		std::deque<Zone> _history;
+		std::vector<Zone> _frameZones;
+		std::vector<Statistic> _statistics;
+		std::map<std::pair<uint32_t, const char*>, size_t> _statisticIndices;
 
-			auto& imageViewCreateInfo = image._viewCreateInfo;
-			imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-			imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-			imageViewCreateInfo.image = image._image;
-			imageViewCreateInfo.format = imageCreateInfo.format;
-			imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-			imageViewCreateInfo.subresourceRange.levelCount = 1;
-			imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-			imageViewCreateInfo.subresourceRange.layerCount = 1;
-			imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			vkCreateImageView(logicalDevice, &imageViewCreateInfo, nullptr, &image._view);
+		/**
+		 * @brief Time between EndFrame calls, averaged the same way as the zones, and its variance, to tell smooth frames from uneven ones of the same average.
+		 */
+		uint64_t _lastFrameEndNanoseconds = 0;
+		double _averageFrameMilliseconds = 0.0;
+		double _frameMillisecondsVariance = 0.0;
 
-			auto& samplerCreateInfo = image._samplerCreateInfo;
-			samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-			samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
-			samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
-			samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerCreateInfo.anisotropyEnable = VK_FALSE;
-			samplerCreateInfo.maxAnisotropy = 1.0f;
-			samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
-			samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
-			samplerCreateInfo.compareEnable = VK_FALSE;
-			samplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-			samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-			samplerCreateInfo.mipLodBias = 0.0f;
-			samplerCreateInfo.minLod = 0.0f;
-			samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
-			vkCreateSampler(logicalDevice, &samplerCreateInfo, nullptr, &image._sampler);
+		Ring& GetThreadRing() {
+			thread_local ThreadRing threadRing;
+			if (!threadRing._pRing) {
+				threadRing._pRing = std::make_shared<Ring>();
+				std::lock_guard<std::mutex> lock(_mutex);
+				threadRing._pRing->_threadIndex = _nextThreadIndex++;
+				_rings.push_back(threadRing._pRing);
+			}
+			return *threadRing._pRing;
+		}
 
-			return image;
+		std::string GetThreadName(uint32_t threadIndex) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto name = _threadNames.find(threadIndex);
+			return name != _threadNames.end() ? name->second : "Thread " + std::to_string(threadIndex);
 		}
 	};
 
 	/**
-	 * @brief Describes the structure of a single descriptor set to provide context on how the shader should treat the descriptor set.
-	 * To make an analogy: if descriptor sets were cars, the blueprint used to fabricate them would be the descriptor set layout, and the
-	 * people inside the car would be the descriptors (the data the sets contain).
-	 * A descriptor set is a group of descriptors. Each descriptor in the set is an entry in the shader's input variables, and can be either
-	 * a buffer or an image.
+	 * @brief Cache of derived data produced from source assets, such as cooked scenes. Entries are named after a hash of the content of the source
+	 * and the version of the importer that produced them, so an entry is reused as long as neither changes, no matter where the source file lives,
+	 * and editing a source or changing an importer simply produces a new entry. The least recently used entries are deleted once the cache grows past its size limit.
 	 */
-	class DescriptorSetLayout {
+	class AssetCache : public Singleton<AssetCache> {
 	public:
 
 		/**
-		 * @brief To make it more recognizable when debugging.
+		 * @brief Folder the cached files are stored in.
 		 */
-		std::string _name = "";
+		std::filesystem::path _directory;
 
 		/**
-		 * @brief ID used to make the pipeline layout and the order the descriptor sets are bound to the pipeline (via vkBindDescriptorSets) match.
-		 * In shaders, this corresponds to the "set" decorator when defining an input variable, like in this line of GLSL:
-		 * layout(set = 3, binding = 0) uniform sampler2D albedoMap;
+		 * @brief Size the cache is trimmed to by Evict.
 		 */
-		int _id;
+		uint64_t _maxSizeBytes = 2048ull * 1024 * 1024;
+
+		void Initialize(const std::filesystem::path& directory, uint64_t maxSizeBytes) {
+			_directory = directory;
+			_maxSizeBytes = maxSizeBytes;
+			std::error_code error;
+			std::filesystem::create_directories(_directory, error);
+			LoadIndex();
+		}
 
 		/**
-		 * @brief Layout handle.
+		 * @brief Returns the path of the cache entry for the given source and importer version. The entry may not exist yet, in which case
+		 * the caller cooks the source into the returned path and then calls Evict. Returns nothing if the source cannot be read, as it has no
+		 * content to name an entry after.
 		 */
-		VkDescriptorSetLayout _layout;
+		std::optional<std::filesystem::path> GetCookedPath(const std::filesystem::path& sourcePath, uint32_t importerVersion, const std::string& extension) {
+			auto contentHash = GetContentHash(sourcePath);
+			if (!contentHash) return std::nullopt;
+
+			char name[32];
+			snprintf(name, sizeof(name), "%016llx-%u", (unsigned long long)*contentHash, importerVersion);
+			auto cookedPath = _directory / (std::string(name) + extension);
+
+			// Mark the entry as recently used.
+			std::error_code error;
+			if (std::filesystem::exists(cookedPath, error)) std::filesystem::last_write_time(cookedPath, std::filesystem::file_time_type::clock::now(), error);
+			return cookedPath;
+		}
 
 		/**
-		 * @brief Used for ordering pipeline layouts in map structures.
+		 * @brief Deletes the least recently used entries until the cache fits in _maxSizeBytes. The entry at keepPath is never deleted.
 		 */
-		bool operator<(const DescriptorSetLayout& other) const {
-			return _id < other._id;
+		void Evict(const std::filesystem::path& keepPath) {
+			struct Entry {
+				std::filesystem::path _path;
+				std::filesystem::file_time_type _lastUsed;
+				uint64_t _sizeBytes;
+			};
+			std::vector<Entry> entries;
+			uint64_t totalSizeBytes = 0;
+			std::error_code error;
+			for (auto& file : std::filesystem::directory_iterator(_directory, error)) {
+				if (!file.is_regular_file() || file.path() == IndexPath()) continue;
+				entries.push_back(Entry{ file.path(), file.last_write_time(), file.file_size() });
+				totalSizeBytes += entries.back()._sizeBytes;
+			}
+			if (totalSizeBytes <= _maxSizeBytes) return;
+
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a._lastUsed < b._lastUsed; });
+			for (auto& entry : entries) {
+				if (totalSizeBytes <= _maxSizeBytes) break;
+				if (entry._path == keepPath) continue;
+				if (std::filesystem::remove(entry._path, error)) totalSizeBytes -= entry._sizeBytes;
+			}
 		}
 
+	private:
+
 		/**
-		 * @brief Used for ordering pipeline layouts in map structures.
+		 * @brief What a source file looked like when its content was last hashed.
 		 */
-		bool operator==(const DescriptorSetLayout& other) const {
-			return _id == other._id;
-		}
-	};
+		struct SourceStamp {
+			uint64_t _sizeBytes;
+			int64_t _lastWriteTime;
+			uint64_t _contentHash;
+		};
 
-	/**
-	 * @brief Represents a description of how data from CPU-side memory is bound to input variables in the shaders.
-	 */
-	class ShaderResources {
-	public:
+		/**
+		 * @brief Stamps by absolute source path. They are saved in the cache folder so that unchanged sources are not read and hashed again on the next launch.
+		 */
+		std::map<std::string, SourceStamp> _sourceStamps;
 
-		std::map<DescriptorSetLayout, std::vector<VkDescriptorSet>> _data;
+		std::filesystem::path IndexPath() {
+			return _directory / "SourceIndex.txt";
+		}
 
 		/**
-		 * @brief Merges this shader resources instance with another.
+		 * @brief Returns the hash of the content of the source, or nothing if it cannot be read.
 		 */
-		void MergeResources(ShaderResources& other) {
-			for (const auto& pair : other._data) {
-				auto it = _data.find(pair.first);
-				if (it != _data.end()) {
-					// Here, you can decide how to merge the values.
-					// For simplicity, I'm replacing the value in map1 with the value from map2.
-					it->second = pair.second;
-				}
-				else {
-					_data.insert(pair);
-				}
-			}
+		std::optional<uint64_t> GetContentHash(const std::filesystem::path& sourcePath) {
+			std::error_code error;
+			auto sizeBytes = (uint64_t)std::filesystem::file_size(sourcePath, error);
+			if (error) return std::nullopt;
+			auto lastWriteTime = (int64_t)std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+			if (error) return std::nullopt;
+			auto key = std::filesystem::absolute(sourcePath, error).string();
+
+			auto found = _sourceStamps.find(key);
+			if (found != _sourceStamps.end() && found->second._sizeBytes == sizeBytes && found->second._lastWriteTime == lastWriteTime) return found->second._contentHash;
+
+			MappedFile source;
+			if (!source.Open(sourcePath)) return std::nullopt;
+			source.WillNeed();
+			auto contentHash = Helpers::Hash64(source._pData, source._sizeBytes);
+			_sourceStamps[key] = SourceStamp{ sizeBytes, lastWriteTime, contentHash };
+			SaveIndex();
+			return contentHash;
 		}
 
 		/**
-		 * @brief Operator overload to index into _data.
+		 * @brief Reads the index, one source per line: content hash, size, last write time and path.
 		 */
-		std::vector<VkDescriptorSet>& operator[](const int& index) {
-			auto it = std::find_if(_data.begin(), _data.end(), [index](const auto& pair) { return pair.first._id == index; });
-
-			if (it == _data.end()) {
-				Exit(1, "index not found");
+		void LoadIndex() {
+			_sourceStamps.clear();
+			std::string text;
+			FileIO::ReadAll(IndexPath(), text);
+			std::istringstream file(text);
+			std::string line;
+			while (std::getline(file, line)) {
+				std::istringstream fields(line);
+				SourceStamp stamp;
+				std::string path;
+				fields >> std::hex >> stamp._contentHash >> std::dec >> stamp._sizeBytes >> stamp._lastWriteTime;
+				std::getline(fields >> std::ws, path);
+				if (!fields.fail() && path.size() > 0) _sourceStamps[path] = stamp;
 			}
+		}
 
-			return it->second;
+		void SaveIndex() {
+			std::ofstream file(IndexPath(), std::ios::trunc);
+			for (auto& [path, stamp] : _sourceStamps)
+				file << std::hex << stamp._contentHash << std::dec << " " << stamp._sizeBytes << " " << stamp._lastWriteTime << " " << path << "\n";
 		}
 	};
 
-	/**
-	 * @brief Encapsulates info for a swapchain.
-	 * The swapchain is an image manager; it manages everything that involves presenting images to the screen,
-	 * or more precisely passing the contents of the framebuffers on the GPU down to the window.
-	 */
-	struct Swapchain {
-		/**
-		 * @brief Identifier for Vulkan.
-		 */
-		VkSwapchainKHR _handle;
+	class Key {
+	public:
+		bool _isHeldDown;
+		bool _wasPressed;
+		int _code;
+		Key() = default;
+		Key(int code) : _code(code), _isHeldDown(false), _wasPressed(false) {}
+	};
 
-		/**
-		 * @brief These are the buffers that contain the final rendered images shown on screen.
-		 * A framebuffer is stored on a different portion of memory with respect to the depth and
-		 * color attachments used by a render pass. The depth and color images CONTRIBUTE to generating
-		 * an image for a framebuffer.
-		 */
-		std::vector<VkFramebuffer> _frameBuffers;
+	class KeyCombo {
+	public:
+		std::vector<Key> _keys;
+		bool IsActive() { return false; }
+	};
 
-		/**
-		 * @brief Dimensions in pixels of the framebuffers.
-		 */
-		VkExtent2D _framebufferSize;
+	class KeyboardMouse : public Singleton<KeyboardMouse>, public IUpdatable {
+		double _lastMouseX;
+		double _lastMouseY;
+		GLFWwindow* _pWindow;
 
-		/**
-		 * @brief Image format that the window surface expects when it has to send images from a framebuffer to a monitor.
-		 */
-		VkSurfaceFormatKHR _surfaceFormat;
+	public:
 
 		/**
-		 * @brief Old swapchain handle used when the swapchain is recreated.
+		 * @brief .
 		 */
-		VkSwapchainKHR _oldSwapchainHandle;
+		std::map<int, Key> _keys;
 
 		/**
-		 * @brief The amount of images used by this swapchain to show render results in turn.
+		 * @brief True if the cursor is visible.
 		 */
-		uint32_t _imageCount;
+		bool _cursorEnabled = false;
 
 		/**
-		 * @brief Swapchain images used for presentation (showing the render results to the window).
+		 * @brief Cumulative value of all horizontal mouse movements since a callback function was registered with glfwSetCursorPosCallback.
 		 */
-		std::vector<Image> _images;
-	};
+		double _mouseX;
 
-	/**
-	 * @brief Encapsulates info for a render pass.
-	 * A render pass represents a specific set of commands that generate images, called attachments.
-	 * Attachments are rendered images that contribute to rendering the final image that will go in the framebuffer.
-	 * It is the renderpass's job to also do compositing, which is defining the logic according to which the attachments are merged to create the final image.
-	 * See Swapchain to understand what framebuffers are.
-	 */
-	struct RenderPass {
 		/**
-		 * @brief Identifier for Vulkan.
+		 * @brief Cumulative value of all vertical mouse movements since a callback function was registered with glfwSetCursorPosCallback.
 		 */
-		VkRenderPass _handle;
+		double _mouseY;
 
 		/**
-		 * @brief Attachments used by the GPU to write color information to.
+		 * @brief The difference between the current frame's mouseX and the mouseX registered on the last Update() call.
 		 */
-		std::vector<Image> _colorImages;
+		double _deltaMouseX;
 
 		/**
-		 * @brief Attachment that stores per-pixel depth information for the hardwired depth testing stage.
-		 * This makes sure that the pixels of each triangle are rendered or not, depending on which pixel
-		 * is closer to the camera, which is the information stored in this image.
+		 * @brief The difference between the current frame's mouseY and the mouseY registered on the last Update() call.
 		 */
-		Image _depthImage;
+		double _deltaMouseY;
 
-	};
+		//double _scrollX; // Only used for scroll-pads. For vertical scroll wheels, only the Y value is actually used.
+		double _scrollY;
 
-	/**
-	 * @brief The graphics pipeline represents, at the logical level, the entire process
-	 * of inputting vertices, indices and textures into the GPU and getting a 2D image that represents the scene
-	 * passed in out of it. In early GPUs, this process was hardwired into the graphics chip, but as technology improved and needs
-	 * for better and more complex graphics increased, GPU producers have taken steps to make this a much more programmable
-	 * and CPU-like process, so much so that technologies like CUDA (Compute Uniform Device Architecture) have come out.
-	 *
-	 * Nowadays the typical GPU consists of an array of clusters of microprocessors, where each micro
-	 * processor is highly multithreaded, and its ALU and instruction set (thus its circuitry) optimized for operating on
-	 * floating point numbers, vectors and matrices (as that is what is used to represent coordinates in space and space transformations).
-	 *
-	 * CUDA is the result of NVidia and Microsoft working together to improve the programmers' experience for programming
-	 * shaders; the result is a product that maps C/C++ instructions to the GPU's ALUs instruction set, to take full advantage
-	 * of the GPU's high amount of cores and threads. By doing this, things like crypto mining and machine learning have gotten
-	 * a huge boost, as the data that requires manipulation is very loosely coupled (has very few dependecies on the data in
-	 * the same set) and, as a result, can be processed by many independent threads simultaneously. This is called a compute pipeline.
-	 * Khronos, the developers of the Vulkan API, have also done something similar called OpenCL, the compute side of OpenGL.
-	 *
-	 * The typical graphics (or render) pipeline consists of programmable, configurable and hardwired stages, where:
-	 * a) The programmable stages are custom stages that will be run on the GPU's multi-purpose array of microprocessors using a program (a.k.a shader).
-	 * b) The configurable stages are hardwired stages that can perform their task a different way based on user configuration via calls to the Vulkan API.
-	 * c) The hardwired stages are immutable stages that cannot be changed unless manipulating the hardware.
-	 * The graph of a typical graphics pipeline is shown under docs/GraphicsPipeline.jpg.
-	 *
-	 * More on the programmable stages:
-	 * The programmable stages are the flexible stages that the programmer can fully customize by writing little programs called shaders.
-	 * These shader programs will run:
-	 * 1) once per vertex in the case of the vertex shader; this shader program's goal is to take vertex attrbutes in, and output
-	 * a vertex color and 2D position (more precisely, a 3D position inside of the Vulkan's coordinate range, which is -1 to 1 for X and Y and 0 to 1 for Z).
-	 * 2) once per pixel in the case of the fragment shader; this stage's goal is to take the rasterizer's output (which is a hardwired
-	 * stage on the GPU chip as of 2022, whose goal is to color pixels based on vertex colors) and textures, and output a colored pixel based on
-	 * the color of the textures and other variables such as direct and indirect lighting.
-	 * There are other shader stages, but the 2 above are the strictly needed shaders in order to be able to render something.
+		static void KeyCallback(GLFWwindow* pWindow, int key, int scancode, int action, int mods) {
+			Instance()._keys.try_emplace(key, Key(key));
 
-	 * This type of execution flow has a name and is called SIMD (Single Instruction Multiple Data), as the same program (single instruction)
-	 * is run independently on different cores/threads for multiple vertices or pixels (multiple data).
-	 *
-	 * Examples of the configurable stages are anti-aliasing and tessellation.
-	 * Examples of hardwired stages are backface-culling, depth testing and alpha blending.
-	 *
-	 * For a good overall hardware and software explanation of a typical NVidia GPU, see
-	 * https://developer.nvidia.com/gpugems/gpugems2/part-iv-general-purpose-computation-gpus-primer/chapter-30-geforce-6-series-gpu
-	 */
-	struct Pipeline {
+			if (action == GLFW_PRESS) {
+				Instance()._keys[key]._wasPressed = true;
+				Instance()._keys[key]._isHeldDown = true;
+			}
+			else if (action == GLFW_REPEAT) {
+				Instance()._keys[key]._isHeldDown = true;
+			}
+			else {
+				Instance()._keys[key]._isHeldDown = false;
+			}
+		}
 
-		/**
-		 * @brief Identifier for Vulkan.
-		 */
-		VkPipeline _handle;
+		static void CursorPositionCallback(GLFWwindow* pWindow, double xPos, double yPos) {
+			if (Instance()._cursorEnabled) return;
+			Instance()._mouseX = xPos;
+			Instance()._mouseY = yPos;
+		}
 
-		/**
-		* @brief Access to descriptor sets from a pipeline is accomplished through a pipeline layout. Zero or more descriptor set layouts and zero or more
-		* push constant ranges are combined to form a pipeline layout object describing the complete set of resources that can be accessed by a pipeline.
-		* The pipeline layout represents a sequence of descriptor sets with each having a specific layout. This sequence of layouts is used to determine
-		* the interface between shader stages and shader resources. Each pipeline is created using a pipeline layout.
-		*/
-		VkPipelineLayout _layout;
+		static void ScrollWheelCallback(GLFWwindow* pWindow, double xPos, double yPos) {
+			if (!Instance()._cursorEnabled) {
+				//Instance()._scrollX = xPos;
+				Instance()._scrollY += yPos;
+			}
+		}
 
 		/**
-		 * @brief See ShaderResources definition.
+		 * @brief Constructor.
 		 */
-		ShaderResources _shaderResources;
-	};
+		KeyboardMouse() = default;
 
-	/**
-	 * @brief Represents all the needed, or neeeded in order to obtain, information to run any call in the Vulkan API.
-	 */
-	struct VkContext {
-		VkInstance _instance;
-		VkDevice _logicalDevice;
-		VkPhysicalDevice _physicalDevice;
-		VkCommandPool _commandPool;
-		VkSurfaceKHR _windowSurface;
-		VkQueue _queue;
-		uint32_t _queueFamilyIndex;
-		VkFence _queueFence;
-		/**
-		 * @brief Function pointer called by Vulkan each time it wants to report an error.
-		 * Error reporting is set by enabling validation layers.
-		 */
-		VkDebugReportCallbackEXT _callback;
+		void Initialize(GLFWwindow* pWindow) {
+			if (nullptr == pWindow) return;
+			_pWindow = pWindow;
+
+			// Keyboard init
+			glfwSetKeyCallback(pWindow, KeyCallback);
+
+			// Mouse init
+			_cursorEnabled = true;
+			glfwSetInputMode(_pWindow, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+			if (glfwRawMouseMotionSupported()) glfwSetInputMode(pWindow, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+			glfwSetCursorPosCallback(pWindow, CursorPositionCallback);
+			glfwSetScrollCallback(pWindow, ScrollWheelCallback);
+
+		}
+
+		bool IsKeyHeldDown(int glfwKeyCode) {
+			if (!_keys[glfwKeyCode]._isHeldDown) {
+				_keys[glfwKeyCode]._wasPressed = false;
+			}
+			return _keys[glfwKeyCode]._isHeldDown;
+		}
+
+		bool WasKeyPressed(int glfwKeyCode) {
+			bool wasPressed = _keys[glfwKeyCode]._wasPressed;
+			_keys[glfwKeyCode]._wasPressed = false;
+			return wasPressed;
+		}
+
+		void ToggleCursor() {
+			_cursorEnabled = !_cursorEnabled;
+			glfwSetInputMode(_pWindow, GLFW_CURSOR, _cursorEnabled ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+		}
+
+		void Update() {
+			if (WasKeyPressed(GLFW_KEY_ESCAPE)) {
+				ToggleCursor();
+				if (!_cursorEnabled) glfwSetCursorPos(_pWindow, _lastMouseX, _lastMouseY);
+			};
+
+			_deltaMouseX = (_mouseX - _lastMouseX);
+			_deltaMouseY = (_mouseY - _lastMouseY);
+
+			_lastMouseX = _mouseX;
+			_lastMouseY = _mouseY;
+		}
 	};
 
 	/**
-	 * @brief All the information the engine needs to render the images sent to the window.
+	 * @brief Vulkan's representation of a GPU.
 	 */
-	struct VkRenderContext {
+	class PhysicalDevice {
+
+	public:
+
 		/**
-		 * @brief The images to which Nuklear renders its UI.
-		 */
-		std::vector<Image> _overlayImages;
-		nk_context* _uiCtx;
-		std::vector<VkCommandBuffer> _drawCommandBuffers;
-		Swapchain _swapchain{};
-		Pipeline _envMapPipeline{};
-		Pipeline _scenePipeline{};
-		Pipeline _uiPipeline{};
-		RenderPass _renderPass{};
-		GLFWwindow* _pWindow;
-		/**
-		 * @brief Semaphore that will be used by Vulkan to signal when an image has finished
-		 * rendering and is available to be rendered to in one of the framebuffers.
+		 * @brief Allocates memory according to the requirements, and returns a handle to be used strictly via the Vulkan
+		 * API to access the allocated memory.
+		 * @param memoryType This can be any of the following values:
+		 * 1) VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT: this means GPU memory, so VRAM. If this is not set, then regular RAM is assumed.
+		 * 2) VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT: this means that the CPU will be able to read and write from the allocated memory IF YOU CALL vkMapMemory() FIRST.
+		 * 3) VK_MEMORY_PROPERTY_HOST_CACHED_BIT: this means that the memory will be cached so that when the CPU writes to this buffer, if the data is small enough to fit in its
+		 * cache (which is much faster to access) it will do that instead. Only problem is that this way, if your GPU needs to access that data, it won't be able to unless it's
+		 * also marked as HOST_COHERENT.
+		 * 4) VK_MEMORY_PROPERTY_HOST_COHERENT_BIT: this means that anything that the CPU writes to the buffer will be able to be read by the GPU as well, effectively
+		 * granting the GPU access to the CPU's cache (if the buffer is also marked as HOST_CACHED). COHERENT stands for consistency across memories, so it basically means
+		 * that the CPU, GPU or any other device will see the same memory if trying to access the buffer. If you don't have this flag set, and you try to access the
+		 * buffer from the GPU while the buffer is marked HOST_CACHED, you may not be able to get the data or even worse, you may end up reading the wrong chunk of memory.
+		 * Further read: https://asawicki.info/news_1740_vulkan_memory_types_on_pc_and_how_to_use_them
 		 */
-		VkSemaphore _imageAvailableSemaphore;
-		VkSemaphore	_renderingFinishedSemaphore;
-	};
+		static VkDeviceMemory AllocateMemory(VkPhysicalDevice& physicalDevice, VkDevice& logicalDevice, const VkMemoryRequirements& memoryRequirements, const VkMemoryPropertyFlagBits& memoryType) {
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = memoryRequirements.size;
+			allocInfo.memoryTypeIndex = GetMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, memoryType);
 
-	/**
-	 * @brief Used by implementing classes to mark themselves as a class that is meant to do work on each iteration of the main loop.
-	 */
-	class IVulkanUpdatable {
-	public:
+			VkDeviceMemory handleToAllocatedMemory;
 
-		/**
-		 * @brief Function called on implementing classes in each iteration of the main loop. The main loop is defined in VulkanApplication.cpp.
-		 */
-		virtual void Update(VkContext& context) = 0;
-	};
+			if (ResourceTracker::AllocateMemory(logicalDevice, &allocInfo, nullptr, &handleToAllocatedMemory) != VK_SUCCESS) {
+				Logger::Error("failed allocating memory of size {}", allocInfo.allocationSize);
+				std::exit(-1);
+			}
 
-	/**
-	 * @brief Represents a scene-level PBR material.
-	 */
-	class Material {
+			return handleToAllocatedMemory;
+		}
 
-	public:
+		static bool SupportsSwapchains(VkPhysicalDevice& physicalDevice) {
+			uint32_t extensionCount = 0;
+			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
 
-		/**
-		 * @brief Identifier for debug purposes.
-		 */
-		std::string _name;
+			if (extensionCount == 0) {
+				Logger::Error("physical device doesn't support any extensions");
+				exit(1);
+			}
 
-		/**
-		 * @brief Base color texture data.
-		 */
-		Image _albedo;
+			std::vector<VkExtensionProperties> deviceExtensions(extensionCount);
+			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, deviceExtensions.data());
 
-		/**
-		 * @brief Roughness texture data.
-		 */
-		Image _roughness;
+			for (const auto& extension : deviceExtensions) {
+				if (strcmp(extension.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) {
+					Logger::Info("physical device supports swap chains");
+					return true;
+				}
+			}
 
-		/**
-		 * @brief Metalness texture data.
-		 */
-		Image _metalness;
+			return false;
+		}
 
-		/**
-		 * @brief Default constructor.
-		 */
-		Material() = default;
+		static bool SupportsSurface(VkPhysicalDevice& physicalDevice, uint32_t& queueFamilyIndex, VkSurfaceKHR& surface) {
+			VkBool32 presentSupport = false;
+			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, queueFamilyIndex, surface, &presentSupport);
+			return presentSupport == 0 ? false : true;
+		}
 
-		Material(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice) {
-			_name = "DefaultMaterial";
+		static VkPhysicalDeviceMemoryProperties GetMemoryProperties(VkPhysicalDevice& physicalDevice) {
+			VkPhysicalDeviceMemoryProperties props;
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &props);
+			return props;
+		}
+
+		static uint32_t GetMemoryTypeIndex(VkPhysicalDevice& physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties) {
+			auto props = GetMemoryProperties(physicalDevice);
+
+			for (uint32_t i = 0; i < 32; i++) {
+				if ((typeBits & 1) == 1) {
+					if ((props.memoryTypes[i].propertyFlags & properties) == properties) {
+						return i;
+					}
+				}
+				typeBits >>= 1;
+			}
 
-			_albedo = Image::SolidColor(logicalDevice, physicalDevice, 255, 0, 255, 255);
-			_roughness = Image::SolidColor(logicalDevice, physicalDevice, 125, 125, 125, 255);
-			_metalness = Image::SolidColor(logicalDevice, physicalDevice, 125, 125, 125, 255);
+			return -1;
 		}
-	};
 
-	/**
-	  * @brief Represents vertex attributes, such as positions, normals and UV coordinates.
-	  */
-	class Vertex {
-	public:
+		static std::vector<VkQueueFamilyProperties> GetAllQueueFamilyProperties(VkPhysicalDevice& physicalDevice) {
+			uint32_t queueFamilyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
 
-		/**
-		 * @brief Used to identify vertex attribute types.
-		 */
-		enum class AttributeType {
-			Position, Normal, UV
-		};
+			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
 
-		/**
-		 * @brief Attribute describing the object-space position of the vertex in the engine's coordinate system (X right, Y up, Z forward).
-		 */
-		glm::vec3 _position;
+			return queueFamilies;
+		}
 
-		/**
-		 * @brief Attribute describing the object-space normal vector of the vertex in the engine's coordinate system (X right, Y up, Z forward).
-		 */
-		glm::vec3 _normal;
+		static void GetQueueFamilyIndices(VkPhysicalDevice& physicalDevice, const VkQueueFlagBits& queueFlags, bool needsPresentationSupport, const VkSurfaceKHR& surface) {
+			// Check queue families
+			auto queueFamilyProperties = GetAllQueueFamilyProperties(physicalDevice);
 
-		/**
-		 * @brief Attribute describing the UV coordinates of the vertex in the UV coordinate system, where the origin (U = 0, V = 0) is the bottom left of the 2D space.
-		 */
-		glm::vec2 _uvCoord;
+			std::vector<uint32_t> queueFamilyIndices;
 
-		static size_t OffsetOf(const AttributeType& attributeType) {
-			switch (attributeType) {
-			case AttributeType::Position:
-				return 0;
-			case AttributeType::Normal:
-				return sizeof(_position);
-			case AttributeType::UV:
-				return sizeof(_position) + sizeof(_normal);
-			default: return 0;
+			for (uint32_t i = 0; i < queueFamilyProperties.size(); i++) {
+				VkBool32 presentationSupported = false;
+				vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentationSupported);
+
+				if (queueFamilyProperties[i].queueCount > 0 && queueFamilyProperties[i].queueFlags & queueFlags) {
+					if (needsPresentationSupport) {
+						if (presentationSupported) {
+							queueFamilyIndices.push_back(i);
+						}
+					}
+					else {
+						queueFamilyIndices.push_back(i);
+					}
+				}
 			}
 		}
-	};
 
-	/**
-	 * @brief Used by deriving classes to be able to bind shader resources (descriptor sets and push constants) to GPU-visible memory, to then be used by a pipeline.
-	 * Information can be sent from application (run by the CPU) accessible memory to shader (run by the GPU) accessible memory, in order for it to be used in
-	 * certain ways in the shader programs. This data structure encapsulates all Vulkan calls needed to enable that. There are 2 ways that data can be sent to
-	 * the shaders: using push constants, or using descriptors.
-	 * The most common and flexible way is using descriptors, but push constant are fastest.
-	 */
-	class IPipelineable {
+		static VkSurfaceCapabilitiesKHR GetSurfaceCapabilities(VkPhysicalDevice& physicalDevice, VkSurfaceKHR& windowSurface) {
+			VkSurfaceCapabilitiesKHR surfaceCapabilities;
+			if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, windowSurface, &surfaceCapabilities) != VK_SUCCESS) {
+				Logger::Error("failed to acquire presentation surface capabilities");
+			}
+			return surfaceCapabilities;
+		}
 
-	public:
+		static std::vector<VkSurfaceFormatKHR> GetSupportedFormatsForSurface(VkPhysicalDevice& physicalDevice, VkSurfaceKHR& windowSurface) {
+			uint32_t formatCount;
+			if (vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, windowSurface, &formatCount, nullptr) != VK_SUCCESS || formatCount == 0) {
+				Logger::Error("failed to get number of supported surface formats");
+			}
 
-		/**
-		 * @brief Buffers to be used in descriptors for shader resources.
-		 */
-		std::vector<Buffer> _buffers;
+			std::vector<VkSurfaceFormatKHR> surfaceFormats(formatCount);
+			if (vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, windowSurface, &formatCount, surfaceFormats.data()) != VK_SUCCESS) {
+				Logger::Error("failed to get supported surface formats");
+			}
 
-		/**
-		 * @brief Images to be used in descriptors for shader resources.
-		 */
-		std::vector<Image> _images;
+			return surfaceFormats;
+		}
 
-		/**
-		 * @brief See ShaderResources.
-		 */
-		ShaderResources _shaderResources;
+		static std::vector<VkPresentModeKHR> GetSupportedPresentModesForSurface(VkPhysicalDevice& physicalDevice, VkSurfaceKHR& windowSurface) {
+			uint32_t presentModeCount;
+			if (vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, windowSurface, &presentModeCount, nullptr) != VK_SUCCESS || presentModeCount == 0) {
+				Logger::Error("failed to get number of supported presentation modes");
+				exit(1);
+			}
 
-		/**
-		 * @brief Function that is meant for deriving classes to create shader resources and send them to GPU-visible memory (could be either RAM or VRAM).
-		 * Shader resources can either be push constants or descriptors. See ShaderResources.cpp.
-		 * @param physicalDevice Intended to be used to gather GPU information when allocating buffers or images.
-		 * @param logicalDevice Intended to be used for binding created buffers, images, descriptors, descriptor sets etc. to the GPU.
-		 */
-		virtual ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) = 0;
+			std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+			if (vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, windowSurface, &presentModeCount, presentModes.data()) != VK_SUCCESS) {
+				Logger::Error("failed to get supported presentation modes");
+				exit(1);
+			}
 
-		/**
-		 * @brief Function that is meant for deriving classes to update the shader resources that have been created with CreateDescriptorSets.
-		 */
-		virtual void UpdateShaderResources() = 0;
+			return presentModes;
+		}
 	};
 
-	/**
-	 * @brief Used by deriving classes to mark themselves as a class that is meant to bind drawing resources (vertex buffers, index buffer)
-	 * to a graphics pipeline and send draw commands to the Vulkan API.
-	 */
-	class IDrawable {
-
+	class VkHelper {
 	public:
+		static VkCommandPool CreateCommandPool(VkDevice& logicalDevice, uint32_t& queueFamilyIndex) {
+			VkCommandPoolCreateInfo poolCreateInfo = {};
+			poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+			poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			VkCommandPool outPool;
+			vkCreateCommandPool(logicalDevice, &poolCreateInfo, nullptr, &outPool);
+			return outPool;
+		}
 
-		/**
-		 * @brief Wrapper that contains a GPU-only buffer that contains vertices for drawing operations, and the vertex information.
-		 */
-		struct {
-			/**
-			 * @brief List of vertices that make up the drawable object.
-			 */
-			std::vector<Vertex> _vertexData;
-
-			/**
-			 * @brief Buffer that stores vertex attributes. A vertex attribute is a piece of data
-			 * that decorates the vertex with more information, so that the vertex shader can
-			 * do more work based on it. For example a vertex attribute could be a position or a normal vector.
-			 * Based on the normal vector, the vertex shader can perform lighting calculations by computing
-			 * the angle between the source of the light and the normal.
-			 * At the hardware level, the contents of the vertex buffer are fed into the array of shader cores,
-			 * and each vertex, along with its attributes, are processed in parallel by multiple instances of the
-			 * vertex shader on each thread of the cores.
-			 * This buffer is intended to contain _vertexData to be bound to the graphics pipeline just before
-			 * drawing the mesh in a render pass.
-			 */
-			Buffer _vertexBuffer;
-
-		} _vertices;
+		static int FindQueueFamilyIndex(VkPhysicalDevice& physicalDevice, VkQueueFlagBits queueFlags) {
+			auto queueFamilyProperties = PhysicalDevice::GetAllQueueFamilyProperties(physicalDevice);
 
-		/**
-		 * @brief Wrapper that contains a GPU-only buffer that contains face indices for drawing operations, and the face indices' information.
-		 */
-		struct {
-			/**
-			 * @brief List of indices, where each index corresponds to a vertex defined in the _vertices array above.
-			 * A face (triangle) is defined by three consecutive indices in this array.
-			 */
-			std::vector<unsigned int> _indexData;
+			for (uint32_t queueFamilyIndex = 0; queueFamilyIndex < queueFamilyProperties.size(); queueFamilyIndex++) {
+				if (queueFamilyProperties[queueFamilyIndex].queueCount > 0 && queueFamilyProperties[queueFamilyIndex].queueFlags & queueFlags) {
+					return queueFamilyIndex;
+				}
+			}
 
-			/**
-			 * @brief This buffer is used by Vulkan when drawing using the vkCmdDrawIndexed command; it gives Vulkan
-			 * information about the order in which to draw vertices, and is intended to contain _indexData to be bound
-			 * to the graphics pipeline just before drawing the mesh in a render pass.
-			 */
-			Buffer _indexBuffer;
+			return -1;
+		}
 
-		} _faceIndices;
+		static void StartRecording(VkCommandBuffer& commandBuffer) {
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkResetCommandBuffer(commandBuffer, 0);
+			vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		}
 
-		void CreateVertexBuffer(VkContext& ctx, const std::vector<Vertex>& vertices) {
-			_vertices._vertexData = vertices;
+		static void StopRecording(VkCommandBuffer& commandBuffer) { vkEndCommandBuffer(commandBuffer); }
 
-			// Create a temporary buffer.
-			auto& buffer = _vertices._vertexBuffer;
-			auto bufferSizeBytes = GetVectorSizeInBytes(vertices);
-			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			buffer._createInfo.size = bufferSizeBytes;
-			buffer._createInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-			vkCreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+		static void ExecuteCommands(VkCommandBuffer& commandBuffer, VkQueue& queue) {
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffer;
+			vkQueueSubmit(queue, 1, &submitInfo, nullptr);
+			vkQueueWaitIdle(queue);
+		}
 
-			// Allocate memory for the buffer.
-			VkMemoryRequirements requirements{};
-			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
-			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, (VkMemoryPropertyFlagBits)(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+		static VkCommandBuffer CreateCommandBuffer(VkDevice& logicalDevice, VkCommandPool& commandPool) {
+			VkCommandBufferAllocateInfo cmdBufInfo = {};
+			cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			cmdBufInfo.commandPool = commandPool;
+			cmdBufInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			cmdBufInfo.commandBufferCount = 1;
+			VkCommandBuffer commandBuffer;
+			vkAllocateCommandBuffers(logicalDevice, &cmdBufInfo, &commandBuffer);
+			return commandBuffer;
+		}
 
-			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, GetVectorSizeInBytes(vertices), 0, &buffer._cpuMemory);
+		static void* DownloadImage(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue, VkImage image, uint32_t width, uint32_t height, VkDeviceMemory& outStagingMemory, VkBuffer& outStagingBuffer) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			CreateBuffer(logicalDevice, physicalDevice, 4 * width * height, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT /*| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT*/,
+				&outStagingBuffer, &outStagingMemory);
 
-			// Map memory to the correct GPU and CPU ranges for the buffer.
-			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+			TransitionImageLayout(logicalDevice, commandPool, queue, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+			CopyImageToBuffer(logicalDevice, commandPool, queue, image, outStagingBuffer, width, height);
 
-			// Send the buffer to GPU.
-			buffer._pData = (void*)vertices.data();
-			buffer._sizeBytes = bufferSizeBytes;
-			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, buffer._buffer, buffer._pData, buffer._sizeBytes);
+			void* data;
+			vkMapMemory(logicalDevice, outStagingMemory, 0, 4 * width * height, 0, &data);
+			return data;
 		}
 
-		void CreateIndexBuffer(VkContext& ctx, const std::vector<unsigned int>& indices) {
-			_faceIndices._indexData = indices;
+		static void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer* buffer, VkDeviceMemory* bufferMemory) {
+			VkBufferCreateInfo bufferInfo{};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = size;
+			bufferInfo.usage = usage;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			CheckResult(ResourceTracker::CreateBuffer(device, &bufferInfo, nullptr, buffer));
+			*bufferMemory = AllocateGpuMemoryForBuffer(device, physicalDevice, *buffer, properties);
+			vkBindBufferMemory(device, *buffer, *bufferMemory, 0);
+		}
 
-			// Create a temporary buffer.
-			auto& buffer = _faceIndices._indexBuffer;
-			auto bufferSizeBytes = GetVectorSizeInBytes(indices);
-			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			buffer._createInfo.size = bufferSizeBytes;
-			buffer._createInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-			vkCreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+		static void TransitionImageLayout(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout) {
+			VkCommandBuffer commandBuffer = CreateCommandBuffer(device, commandPool);
+			StartRecording(commandBuffer);
 
-			// Allocate memory for the buffer.
-			VkMemoryRequirements requirements{};
-			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
-			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = 1;
 
-			// Map memory to the correct GPU and CPU ranges for the buffer.
-			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+			VkPipelineStageFlags sourceStage;
+			VkPipelineStageFlags destinationStage;
 
-			// TODO: send the buffer to GPU.
-			buffer._pData = (void*)indices.data();
-			buffer._sizeBytes = bufferSizeBytes;
-			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, buffer._buffer, buffer._pData, buffer._sizeBytes);
-		}
+			if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) { barrier.srcAccessMask = 0; sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT; }
+			if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
+			if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT; sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
+			if (oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; }
+			if (oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) { barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT; sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; }
 
-		/**
-		 * @brief Deriving classes should implement this method to bind their vertex and index buffers to a graphics pipeline and draw them via Vulkan draw calls.
-		 */
-		virtual void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) = 0;
-	};
+			if (newLayout == VK_IMAGE_LAYOUT_UNDEFINED) { barrier.dstAccessMask = 0; destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
+			if (newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT; destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
+			if (newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT; }
+			if (newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT; destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; }
+			if (newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) { barrier.dstAccessMask = 0; destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
+			if (newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) { barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
 
-	/**
-	 * @brief Represents an infinitesimally small light source.
-	 */
-	class PointLight : public IVulkanUpdatable, public IPipelineable {
-	public:
+			vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			vkEndCommandBuffer(commandBuffer);
+			ExecuteCommands(commandBuffer, queue);
+			vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+		}
 
-		/**
-		 * @brief Name of the light.
-		 */
-		std::string _name;
+		static void CopyImageToBuffer(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkImage image, VkBuffer buffer, uint32_t width, uint32_t height) {
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandPool = commandPool;
+			allocInfo.commandBufferCount = 1;
 
-		/**
-		 * @brief .
-		 */
-		Transform _transform;
+			VkCommandBuffer commandBuffer = CreateCommandBuffer(device, commandPool);
+			StartRecording(commandBuffer);
 
-		/**
-		 * @brief Data to be sent to the shaders.
-		 */
-		struct {
-			glm::vec3 position;
-			glm::vec4 colorIntensity;
-		} _lightData;
+			VkBufferImageCopy region{};
+			region.bufferOffset = 0;
+			region.bufferRowLength = 0;  // Tightly packed
+			region.bufferImageHeight = 0; // Tightly packed
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = 0;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { width, height, 1 };
 
-		/**
-		 * @brief X, Y, Z represent red, blue and green for light color, while the W component represents
-		 * light intensity.
-		 */
-		glm::vec4 _colorIntensity;
+			vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+			vkEndCommandBuffer(commandBuffer);
+			ExecuteCommands(commandBuffer, queue);
+			vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+		}
 
 		/**
-		 * @brief Default constructor.
+		 * @brief Records the copy of a tightly packed buffer into the first mip level of a 2D image, with the layout transitions around it. The image ends up
+		 * ready to be sampled by fragment shaders.
 		 */
-		PointLight() = default;
-
-		PointLight(std::string name) {
-			_name = name;
-			_transform.SetPosition(glm::vec3(3.0f, 10.0f, -10.0f));
-		}
-
-		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
-			auto descriptorSetID = 2;
+		static void RecordImageUpload(VkCommandBuffer& commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-			// Create a temporary buffer.
-			Buffer buffer{};
-			auto bufferSizeBytes = sizeof(_lightData);
-			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			buffer._createInfo.size = bufferSizeBytes;
-			buffer._createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-			vkCreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+			VkBufferImageCopy region{};
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			region.imageExtent = { width, height, 1 };
+			vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
-			// Allocate memory for the buffer.
-			VkMemoryRequirements requirements{};
-			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
-			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
 
-			// Map memory to the correct GPU and CPU ranges for the buffer.
-			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
-			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
-			memcpy(buffer._cpuMemory, &_lightData, bufferSizeBytes);
+		static VkDeviceMemory AllocateGpuMemory(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkMemoryRequirements memRequirements, VkMemoryPropertyFlags requiredMemoryProperties) {
+			VkMemoryAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = memRequirements.size;
+			allocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, memRequirements.memoryTypeBits, requiredMemoryProperties);
+			VkDeviceMemory allocatedMemory;
+			CheckResult(ResourceTracker::AllocateMemory(logicalDevice, &allocInfo, nullptr, &allocatedMemory));
+			return allocatedMemory;
+		}
 
-			_buffers.push_back(buffer);
+		static VkDeviceMemory AllocateGpuMemoryForImage(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkImage imageToAllocate, VkMemoryPropertyFlags requiredMemoryProperties) {
+			VkMemoryRequirements memRequirements;
+			vkGetImageMemoryRequirements(logicalDevice, imageToAllocate, &memRequirements);
+			return AllocateGpuMemory(logicalDevice, physicalDevice, memRequirements, requiredMemoryProperties);
+		}
 
-			VkDescriptorPool descriptorPool{};
-			VkDescriptorPoolSize poolSizes[1] = { VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 } };
-			VkDescriptorPoolCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-			createInfo.maxSets = (uint32_t)1;
-			createInfo.poolSizeCount = (uint32_t)1;
-			createInfo.pPoolSizes = poolSizes;
-			vkCreateDescriptorPool(ctx._logicalDevice, &createInfo, nullptr, &descriptorPool);
+		static VkDeviceMemory AllocateGpuMemoryForBuffer(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkBuffer buffer, VkMemoryPropertyFlags requiredMemoryProperties) {
+			VkMemoryRequirements memRequirements;
+			vkGetBufferMemoryRequirements(logicalDevice, buffer, &memRequirements);
+			return AllocateGpuMemory(logicalDevice, physicalDevice, memRequirements, requiredMemoryProperties);
+		}
 
-			// Create the descriptor set.
+		static VkDescriptorSet AllocateDescriptorSet(VkDevice logicalDevice, VkDescriptorPool descriptorPool, VkDescriptorSetLayout setLayout) {
 			VkDescriptorSetAllocateInfo allocInfo = {};
 			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 			allocInfo.descriptorPool = descriptorPool;
 			allocInfo.descriptorSetCount = (uint32_t)1;
-			allocInfo.pSetLayouts = &layouts[descriptorSetID]._layout;
+			allocInfo.pSetLayouts = &setLayout;
 			VkDescriptorSet descriptorSet;
-			vkAllocateDescriptorSets(ctx._logicalDevice, &allocInfo, &descriptorSet);
+			CheckResult(vkAllocateDescriptorSets(logicalDevice, &allocInfo, &descriptorSet));
+			return descriptorSet;
+		}
 
-			// Update the descriptor set's data.
-			VkDescriptorBufferInfo bufferInfo{ buffer._buffer, 0, buffer._createInfo.size };
-			VkWriteDescriptorSet writeInfo = {};
-			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			writeInfo.dstSet = descriptorSet;
-			writeInfo.descriptorCount = 1;
-			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			writeInfo.pBufferInfo = &bufferInfo;
-			writeInfo.dstBinding = 0;
-			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+		static void CopyImage(VkDevice logicalDevice, VkCommandPool commandPool, VkQueue queue,
+			VkImage srcImage, VkImage dstImage, VkExtent2D extent,
+			uint32_t mipLevel = 0, uint32_t baseArrayLayer = 0, uint32_t layerCount = 1) {
+			VkCommandBuffer commandBuffer = CreateCommandBuffer(logicalDevice, commandPool);
+			StartRecording(commandBuffer);
 
-			auto descriptorSets = std::vector<VkDescriptorSet>{ descriptorSet };
-			_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
-			return _shaderResources;
-		}
+			VkImageSubresourceLayers subresource = {};
+			subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; // Assuming color images
+			subresource.mipLevel = mipLevel;
+			subresource.baseArrayLayer = baseArrayLayer;
+			subresource.layerCount = layerCount;
 
-		void UpdateShaderResources() {
-			_lightData.position = _transform.Position();
-			_lightData.colorIntensity = glm::vec4(1.0f, 1.0f, 1.0f, 15000.0f);
-			memcpy(_buffers[0]._cpuMemory, &_lightData, sizeof(_lightData));
-		}
+			VkImageCopy copyRegion = {};
+			copyRegion.srcSubresource = subresource;
+			copyRegion.dstSubresource = subresource;
+			copyRegion.srcOffset = { 0, 0, 0 }; // Copy from the start of the source image
+			copyRegion.dstOffset = { 0, 0, 0 }; // Copy to the start of the destination image
+			copyRegion.extent = { extent.width, extent.height, 1 };       // The size of the image to copy
 
-		void Update(VkContext& vkContext) {
-			auto& input = KeyboardMouse::Instance();
+			// Record the copy command
+			vkCmdCopyImage(commandBuffer,
+				srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &copyRegion);
 
-			if (input.IsKeyHeldDown(GLFW_KEY_UP)) {
-				_transform.Translate(_transform.Forward() * 1.5f);
-			}
+			// End the command buffer
+			CheckResult(vkEndCommandBuffer(commandBuffer));
 
-			if (input.IsKeyHeldDown(GLFW_KEY_DOWN)) {
-				_transform.Translate(_transform.Forward() * -1.5f);
-			}
+			ExecuteCommands(commandBuffer, queue);
+			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+		}
 
-			if (input.IsKeyHeldDown(GLFW_KEY_LEFT)) {
-				_transform.Translate(_transform.Right() * -1.5f);
-			}
+		static void DestroyImage(VkDevice logicalDevice, VkImage image, VkImageView imageView = nullptr, VkSampler sampler = nullptr) {
+			ResourceTracker::DestroyImage(logicalDevice, image, nullptr);
+			if (imageView != nullptr) vkDestroyImageView(logicalDevice, imageView, nullptr);
+			if (imageView != nullptr) vkDestroySampler(logicalDevice, sampler, nullptr);
+		}
 
-			if (input.IsKeyHeldDown(GLFW_KEY_RIGHT)) {
-				_transform.Translate(_transform.Right() * 1.5f);
-			}
+		static void UploadData(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool commandPool, VkQueue queue, VkBuffer buffer, void* pData, size_t sizeBytes) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			// Create a temporary buffer.
+			VkBuffer stagingBuffer;
+			VkDeviceMemory stagingBufferGpuMemory;
+			CreateBuffer(logicalDevice, physicalDevice, sizeBytes, 
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+				&stagingBuffer,
+				&stagingBufferGpuMemory);
 
-			auto pos = _transform.Position();
-			UpdateShaderResources();
+			// Map memory to the correct GPU and CPU ranges for the buffer.
+			void* cpuMemory;
+			vkMapMemory(logicalDevice, stagingBufferGpuMemory, 0, sizeBytes, 0, &cpuMemory);
+			memcpy(cpuMemory, pData, sizeBytes);
+
+			VkBufferCopy copyRegion = {0,0,sizeBytes };
+			auto copyCommandBuffer = CreateCommandBuffer(logicalDevice, commandPool);
+			StartRecording(copyCommandBuffer);
+			vkCmdCopyBuffer(copyCommandBuffer, stagingBuffer, buffer, 1, &copyRegion);
+			StopRecording(copyCommandBuffer);
+			
+			ExecuteCommands(copyCommandBuffer, queue);
+
+			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &copyCommandBuffer);
+			DestroyBuffer(logicalDevice, stagingBuffer, stagingBufferGpuMemory, true);
 		}
-	};
 
+		static void DestroyBuffer(VkDevice& logicalDevice, VkBuffer& buffer, VkDeviceMemory& gpuMemory, const bool& isMemoryMapped) {
+			ResourceTracker::DestroyBuffer(logicalDevice, buffer, nullptr);
+			if (isMemoryMapped)
+				vkUnmapMemory(logicalDevice, gpuMemory);
+			if (gpuMemory)
+				ResourceTracker::FreeMemory(logicalDevice, gpuMemory, nullptr);
+		}
 
-	// All the data that this boxblur application needs to do its thing.
-	class BoxBlur {
+		// A function that transfers data from the GPU to the CPU using staging buffer, because GPU memory is not host-coherent (meaning it is
+		// not synced with the contents of CPU memory).
+		static void DownloadData(VkDevice logicalDevice, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkFence queueFence, VkQueue queue, int sizeOutputBytes, VkBuffer& srcBuffer, void* outDstData) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			// Create a temporary CPU-side vulkan buffer to store the data we want to download
+			VkBuffer stagingBuffer;
+			VkDeviceMemory stagingBufferGpuMemory;
+			CreateBuffer(logicalDevice,
+				physicalDevice,
+				sizeOutputBytes,
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&stagingBuffer,
+				&stagingBufferGpuMemory);
 
-	private:
-		// Input image size.
-		unsigned int _imageWidthPixels;
-		unsigned int _imageHeightPixels;
-		unsigned int _radiusPixels = 60;
-		unsigned char* _loadedImage;
-		VkPhysicalDevice _physicalDevice; // A handle for the graphics card used in the application.
+			// Record commands to copy data to download from the input buffer to this temporary staging buffer
+			VkBufferCopy copyRegion = { 0, 0, sizeOutputBytes };
+			auto commandBuffer = CreateCommandBuffer(logicalDevice, commandPool);
+			StartRecording(commandBuffer);
+			vkCmdCopyBuffer(commandBuffer, srcBuffer, stagingBuffer, 1, &copyRegion);
+			StopRecording(commandBuffer);
 
-		uint32_t _workGroupCount[3]; // Size of the 3D lattice of workgroups.
-		uint32_t _workGroupSize[3];  // Size of the 3D lattice of threads in each workgroup.
-		uint32_t _coalescedMemory;
+			// Execute the command above. We will then have the downloaded data in the staging buffer
+			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, 0, 0, NULL, NULL, 1, &commandBuffer, 0, NULL };
+			CheckResult(vkQueueSubmit(queue, 1, &submitInfo, queueFence));
+			CheckResult(vkWaitForFences(logicalDevice, 1, &queueFence, VK_TRUE, 100000000000));
+			CheckResult(vkResetFences(logicalDevice, 1, &queueFence));
 
-		// Bridging information, that allows shaders to freely access resources like buffers and images.
-		VkDescriptorPool _descriptorPool;
-		VkDescriptorSetLayout _descriptorSetLayout;
-		VkDescriptorSet _descriptorSet;
+			// Copy the data to actual CPU memory
+			void* stagingData;
+			CheckResult(vkMapMemory(logicalDevice, stagingBufferGpuMemory, 0, sizeOutputBytes, 0, &stagingData));
+			memcpy(outDstData, stagingData, sizeOutputBytes);
+			DestroyBuffer(logicalDevice, stagingBuffer, stagingBufferGpuMemory, true);
+			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+		}
+	};
 
-		// Pipeline handles.
-		VkPipelineLayout _pipelineLayout;
-		VkPipeline _pipeline;
+	struct Buffer {
+		VkBufferCreateInfo _createInfo{};
+		VkBufferViewCreateInfo _viewCreateInfo{};
 
-		// Input and output buffers.
-		uint32_t _inputBufferCount;
-		VkBuffer _inputBuffer;
-		VkDeviceMemory _inputBufferDeviceMemory;
-		uint32_t _outputBufferCount;
-		VkBuffer _outputBuffer;
-		VkDeviceMemory _outputBufferDeviceMemory;
+		VkBuffer _buffer{};
+		VkBufferView _view{};
 
-		// Vulkan dependencies
-		VkInstance _instance;                                                // A connection between the application and the Vulkan library .
-		VkDevice _device;                                                    // A logical device, interacting with the physical device.
-		VkPhysicalDeviceProperties _physicalDeviceProperties;                // Basic device properties.
-		VkPhysicalDeviceMemoryProperties _physicalDeviceMemoryProperties;    // Basic memory properties of the device.
-		VkDebugUtilsMessengerEXT _debugMessenger;                            // Extension for debugging.
-		uint32_t _queueFamilyIndex;                                          // If multiple queues are available, specify the used one.
-		VkQueue _queue;                                                      // A place, where all operations are submitted.
-		VkCommandPool _commandPool;                                          // An opaque object that command buffer memory is allocated from.
-		VkFence _fence;                                                      // A fence used to synchronize dispatches.
+		/**
+		 * @brief Vulkan-only handle that Vulkan uses to handle the buffer on GPU memory.
+		 */
+		VkDeviceMemory _gpuMemory = nullptr;
 
-		static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
-			std::cout << "validation layer: " << pCallbackData->pMessage << std::endl;
-			return VK_FALSE;
-		}
+		/**
+		 * @brief Pointer to CPU-accessible memory that Vulkan uses to read/write memory from/to the buffer. This is separate from _pData because Vulkan might need to
+		 * also tell the GPU where this data is stored, and by making this being able to be set only via Vulkan calls, it ensures that it catches all changes to the data
+		 * and maintains it coherent across CPU and GPU.
+		 */
+		void* _cpuMemory = nullptr;
 
-		VkResult SetupDebugUtilsMessenger() {
-			VkDebugUtilsMessengerCreateInfoEXT
-				debugUtilsMessengerCreateInfo = { VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
-					0,
-					(VkDebugUtilsMessengerCreateFlagsEXT)0,
-					(VkDebugUtilsMessageSeverityFlagsEXT)VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
-					(VkDebugUtilsMessageTypeFlagsEXT)VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
-					(PFN_vkDebugUtilsMessengerCallbackEXT)debugCallback,
-					(void*)NULL };
+		/**
+		 * @brief Pointer to CPU-only visible data.
+		 */
+		void* _pData = nullptr;
 
-			PFN_vkCreateDebugUtilsMessengerEXT func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(_instance, "vkCreateDebugUtilsMessengerEXT");
+		size_t _sizeBytes = 0;
 
-			if (func != NULL) {
-				if (func(_instance, &debugUtilsMessengerCreateInfo, NULL, &_debugMessenger) != VK_SUCCESS) {
-					return VK_ERROR_INITIALIZATION_FAILED;
-				}
-			}
-			else {
-				return VK_ERROR_EXTENSION_NOT_PRESENT;
-			}
+		Buffer() = default;
 
-			return VK_SUCCESS;
+		Buffer(void* pData, size_t sizeBytes) {
+			_pData = pData;
+			_sizeBytes = sizeBytes;
 		}
 
-		void DestroyDebugUtilsMessengerEXT(VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator) {
-			//pointer to the function, as it is not part of the core. Function destroys debugging messenger
-			PFN_vkDestroyDebugUtilsMessengerEXT func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(_instance, "vkDestroyDebugUtilsMessengerEXT");
-			if (func != NULL) {
-				func(_instance, debugMessenger, pAllocator);
-			}
-		}
+		static void CopyToDeviceMemory(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool commandPool, VkQueue queue, VkBuffer buffer, void* pData, size_t sizeBytes) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			// Create a temporary buffer.
+			Buffer stagingBuffer{};
+			stagingBuffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			stagingBuffer._createInfo.size = sizeBytes;
+			stagingBuffer._createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			ResourceTracker::CreateBuffer(logicalDevice, &stagingBuffer._createInfo, nullptr, &stagingBuffer._buffer);
 
-		VkResult CreateComputePipeline(VkBuffer* shaderBuffersArray, VkDeviceSize* arrayOfSizesOfEachBuffer, const char* shaderFilename) {
-			// Create an application interface to Vulkan. This function binds the shader to the compute pipeline, so it can be used as a part of the command buffer later.
-			VkResult res = VK_SUCCESS;
-			uint32_t descriptorCount = 2;
+			// Allocate memory for the buffer.
+			VkMemoryRequirements requirements{};
+			vkGetBufferMemoryRequirements(logicalDevice, stagingBuffer._buffer, &requirements);
+			stagingBuffer._gpuMemory = PhysicalDevice::AllocateMemory(physicalDevice, logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 
-			// We have two storage buffer objects in one set in one pool.
-			VkDescriptorPoolSize descriptorPoolSize = { (VkDescriptorType)VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-														   (uint32_t)descriptorCount };
+			// Map memory to the correct GPU and CPU ranges for the buffer.
+			vkBindBufferMemory(logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, 0);
+			vkMapMemory(logicalDevice, stagingBuffer._gpuMemory, 0, sizeBytes, 0, &stagingBuffer._cpuMemory);
+			memcpy(stagingBuffer._cpuMemory, pData, sizeBytes);
 
-			const VkDescriptorType descriptorTypes[2] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-															  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+			auto copyCommandBuffer = VkHelper::CreateCommandBuffer(logicalDevice, commandPool);
+			VkHelper::StartRecording(copyCommandBuffer);
 
-			VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-											   0,
-											   (VkDescriptorPoolCreateFlags)0,
-											   (uint32_t)1,
-											   (uint32_t)1,
-											   (const VkDescriptorPoolSize*)&descriptorPoolSize };
+			VkBufferCopy copyRegion = {};
+			copyRegion.size = sizeBytes;
+			vkCmdCopyBuffer(copyCommandBuffer, stagingBuffer._buffer, buffer, 1, &copyRegion);
 
-			res = vkCreateDescriptorPool(_device, &descriptorPoolCreateInfo, NULL, &_descriptorPool);
-			if (res != VK_SUCCESS) return res;
+			VkHelper::StopRecording(copyCommandBuffer);
+			VkHelper::ExecuteCommands(copyCommandBuffer, queue);
 
-			// Specify each object from the set as a storage buffer.
-			VkDescriptorSetLayoutBinding* descriptorSetLayoutBindings =
-				(VkDescriptorSetLayoutBinding*)malloc(descriptorCount * sizeof(VkDescriptorSetLayoutBinding));
-			for (uint32_t i = 0; i < descriptorCount; ++i) {
-				descriptorSetLayoutBindings[i].binding = (uint32_t)i;
-				descriptorSetLayoutBindings[i].descriptorType = (VkDescriptorType)descriptorTypes[i];
-				descriptorSetLayoutBindings[i].descriptorCount = (uint32_t)1;
-				descriptorSetLayoutBindings[i].stageFlags = (VkShaderStageFlags)VK_SHADER_STAGE_COMPUTE_BIT;
-				descriptorSetLayoutBindings[i].pImmutableSamplers = (const VkSampler*)NULL;
-			}
+			vkFreeCommandBuffers(logicalDevice, commandPool, 1, &copyCommandBuffer);
+			VkHelper::DestroyBuffer(logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, true);
+		}
+	};
 
-			VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-													0,
-													(VkDescriptorSetLayoutCreateFlags)0,
-													(uint32_t)descriptorCount,
-													(const VkDescriptorSetLayoutBinding*)descriptorSetLayoutBindings };
-			//create layout
-			res = vkCreateDescriptorSetLayout(_device, &descriptorSetLayoutCreateInfo, NULL, &_descriptorSetLayout);
-			if (res != VK_SUCCESS) return res;
-			free(descriptorSetLayoutBindings);
+	void CopyImageToDeviceMemory(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool& commandPool, VkQueue& queue, VkImage& image, int width, int height, int depth, void* pData, size_t sizeBytes) {
+		ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+		// Create a temporary buffer.
+		Buffer stagingBuffer{};
+		stagingBuffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		stagingBuffer._createInfo.size = sizeBytes;
+		stagingBuffer._createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		ResourceTracker::CreateBuffer(logicalDevice, &stagingBuffer._createInfo, nullptr, &stagingBuffer._buffer);
 
-			//provide the layout with actual buffers and their sizes
-			VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-												0,
-												(VkDescriptorPool)_descriptorPool,
-												(uint32_t)1,
-												(const VkDescriptorSetLayout*)&_descriptorSetLayout };
-			res = vkAllocateDescriptorSets(_device, &descriptorSetAllocateInfo, &_descriptorSet);
-			if (res != VK_SUCCESS) return res;
+		// Allocate memory for the buffer.
+		VkMemoryRequirements requirements{};
+		vkGetBufferMemoryRequirements(logicalDevice, stagingBuffer._buffer, &requirements);
+		stagingBuffer._gpuMemory = PhysicalDevice::AllocateMemory(physicalDevice, logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 
-			for (uint32_t i = 0; i < descriptorCount; ++i) {
+		// Map memory to the correct GPU and CPU ranges for the buffer.
+		vkBindBufferMemory(logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, 0);
+		vkMapMemory(logicalDevice, stagingBuffer._gpuMemory, 0, sizeBytes, 0, &stagingBuffer._cpuMemory);
+		memcpy(stagingBuffer._cpuMemory, pData, sizeBytes);
 
-				VkDescriptorBufferInfo descriptorBufferInfo = { shaderBuffersArray[i],
-												 0,
-												 arrayOfSizesOfEachBuffer[i] };
+		auto commandBuffer = VkHelper::CreateCommandBuffer(logicalDevice, commandPool);
+		VkHelper::StartRecording(commandBuffer);
 
-				VkWriteDescriptorSet writeDescriptorSet = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-												 0,
-												 (VkDescriptorSet)_descriptorSet,
-												 (uint32_t)i,
-												 (uint32_t)0,
-												 (uint32_t)1,
-												 (VkDescriptorType)descriptorTypes[i],
-												 0,
-												 (const VkDescriptorBufferInfo*)&descriptorBufferInfo,
-												 (const VkBufferView*)NULL };
-				vkUpdateDescriptorSets((VkDevice)_device,
-					(uint32_t)1,
-					(const VkWriteDescriptorSet*)&writeDescriptorSet,
-					(uint32_t)0,
-					(const VkCopyDescriptorSet*)NULL);
-			}
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_NONE;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.image = image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-			VkPushConstantRange range;
-			range.offset = 0;
-			range.size = sizeof(unsigned int) * 3;
-			range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		VkBufferImageCopy copyInfo{};
+		copyInfo.bufferImageHeight = height;
+		copyInfo.bufferRowLength = width;
+		copyInfo.imageExtent = { (uint32_t)width, (uint32_t)height, (uint32_t)depth };
+		copyInfo.imageOffset = { 0,0,0 };
+		copyInfo.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer._buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyInfo);
 
-			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-											   0,
-											   (VkPipelineLayoutCreateFlags)0,
-											   (uint32_t)1,
-											   (const VkDescriptorSetLayout*)&_descriptorSetLayout,
-											   (uint32_t)1,
-											   (const VkPushConstantRange*)&range };
+		VkHelper::StopRecording(commandBuffer);
+		VkHelper::ExecuteCommands(commandBuffer, queue);
 
-			//create pipeline layout
-			res = vkCreatePipelineLayout(_device, &pipelineLayoutCreateInfo, NULL, &_pipelineLayout);
-			if (res != VK_SUCCESS) return res;
+		vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+		VkHelper::DestroyBuffer(logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, true);
+	}
 
-			// Define the specialization constant values
-			VkSpecializationMapEntry* specMapEntry = (VkSpecializationMapEntry*)malloc(sizeof(VkSpecializationMapEntry) * 3);
-			VkSpecializationMapEntry specConstant0 = { 0, 0, sizeof(uint32_t) };
-			VkSpecializationMapEntry specConstant1 = { 1, sizeof(uint32_t), sizeof(uint32_t) };
-			VkSpecializationMapEntry specConstant2 = { 2, sizeof(uint32_t) * 2, sizeof(uint32_t) };
-			specMapEntry[0] = specConstant0;
-			specMapEntry[1] = specConstant1;
-			specMapEntry[2] = specConstant2;
-			VkSpecializationInfo specializationInfo = { 3, specMapEntry, sizeof(uint32_t) * 3, _workGroupSize };
+	inline std::string Format(float value) {
+		return (value >= 0.0f) ? " " + std::to_string(value) : std::to_string(value);
+	}
 
-			std::ifstream file(shaderFilename, std::ios::ate | std::ios::binary);
-			VkShaderModule shaderModule = nullptr;
-			if (file.is_open()) {
-				std::vector<char> fileBytes(file.tellg());
-				file.seekg(0, std::ios::beg);
-				file.read(fileBytes.data(), fileBytes.size());
-				file.close();
+	inline std::ostream& operator << (std::ostream& stream, const glm::mat4& matrix) {
+		stream << Format(matrix[0][0]) << ", " << Format(matrix[0][1]) << ", " << Format(matrix[0][2]) << ", " << Format(matrix[0][3]) << "\n";
+		stream << Format(matrix[1][0]) << ", " << Format(matrix[1][1]) << ", " << Format(matrix[1][2]) << ", " << Format(matrix[1][3]) << "\n";
+		stream << Format(matrix[2][0]) << ", " << Format(matrix[2][1]) << ", " << Format(matrix[2][2]) << ", " << Format(matrix[2][3]) << "\n";
+		stream << Format(matrix[3][0]) << ", " << Format(matrix[3][1]) << ", " << Format(matrix[3][2]) << ", " << Format(matrix[3][3]);
+		return stream;
+	}
 
-				VkShaderModuleCreateInfo createInfo = {};
-				createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-				createInfo.codeSize = fileBytes.size();
-				createInfo.pCode = (uint32_t*)fileBytes.data();
+	inline std::ostream& operator<< (std::ostream& stream, const glm::vec3& vector) {
+		return stream << "(" << vector.x << ", " << vector.y << ", " << vector.z << ")";
+	}
 
-				if (vkCreateShaderModule(_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-					std::cout << "failed to create shader module for " << shaderFilename << std::endl;
-				}
-			}
-			else {
-				std::cout << "failed to open file " << shaderFilename << std::endl;
-			}
+	inline std::ostream& operator<< (std::ostream& stream, const glm::vec3&& vector) {
+		return stream << "(" << vector.x << ", " << vector.y << ", " << vector.z << ")";
+	}
 
-			VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-													0,
-													(VkPipelineShaderStageCreateFlags)0,
-													(VkShaderStageFlagBits)VK_SHADER_STAGE_COMPUTE_BIT,
-													(VkShaderModule)shaderModule,
-													(const char*)"main",
-													(VkSpecializationInfo*)&specializationInfo };
+	/**
+	 * @brief Prints a message to a stream given a function that does the printing and a message.
+	 * Default function logs the message at the Info level.
+	 * @param message The message to print.
+	 * @param logFunction Logging function. Defaults to a function handing the message to Logger::Info.
+	 */
+	inline void Print(const std::string& message, void(*logFunction) (const std::string&) = [](const std::string& message) { Logger::Info("{}", message); }) {
+		logFunction(message);
+	}
 
-			VkComputePipelineCreateInfo computePipelineCreateInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-												0,
-												(VkPipelineCreateFlags)0,
-												pipelineShaderStageCreateInfo,
-												(VkPipelineLayout)_pipelineLayout,
-												(VkPipeline)NULL,
-												(int32_t)0 };
+	/**
+	 * @brief Represents a column-major 4x4 matrix transform in a left handed X right, Y up, Z forward coordinate system.
+	 */
+	class Transform {
 
-			//create pipeline
-			res = vkCreateComputePipelines(_device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, NULL, &_pipeline);
-			if (res != VK_SUCCESS) return res;
+	public:
 
-			vkDestroyShaderModule(_device, pipelineShaderStageCreateInfo.module, NULL);
-			return res;
+		glm::mat4x4 _matrix;
+		glm::vec3 _scale;
+
+		/**
+		 * @brief Returns the transform to take another transform from right-handed gltf space (X left, Y up, Z forward)
+		 * to left-handed engine space (X right, Y up, Z forward).
+		 */
+		static Transform GltfToEngine() {
+			return Transform(glm::mat4x4{
+				glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f), // Column 1
+				glm::vec4(0.0f,  1.0f, 0.0f, 0.0f), // Column 2
+				glm::vec4(0.0f,  0.0f, 1.0f, 0.0f), // Column 3
+				glm::vec4(0.0f,  0.0f, 0.0f, 1.0f)	// Column 4
+				});
 		}
 
-		VkResult Dispatch() {
-			VkResult res = VK_SUCCESS;
-			VkCommandBuffer commandBuffer = { 0 };
+		/**
+		 * @brief Constructs a transform using the identity matrix for both _scale and _matrix.
+		 */
+		Transform() = default;
 
-			// Create a command buffer to be executed on the GPU.
-			VkCommandBufferAllocateInfo commandBufferAllocateInfo;
-			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-			commandBufferAllocateInfo.pNext = 0;
-			commandBufferAllocateInfo.commandPool = _commandPool;
-			commandBufferAllocateInfo.level = (VkCommandBufferLevel)VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-			commandBufferAllocateInfo.commandBufferCount = (uint32_t)1;
-			res = vkAllocateCommandBuffers(_device, &commandBufferAllocateInfo, &commandBuffer);
+		Transform(glm::mat4x4 matrix) : _matrix(matrix) {}
 
-			// Begin command buffer recording.
-			VkCommandBufferBeginInfo commandBufferBeginInfo;
-			commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			commandBufferBeginInfo.pNext = 0;
-			commandBufferBeginInfo.flags = (VkCommandBufferUsageFlags)VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-			commandBufferBeginInfo.pInheritanceInfo = (const VkCommandBufferInheritanceInfo*)NULL;
-			res = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+		glm::vec3 Right() {
+			glm::vec4 right = _matrix * glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+			return glm::vec3(right.x, right.y, right.z);
+		}
 
-			if (res != VK_SUCCESS) return res;
+		glm::vec3 Up() {
+			glm::vec4 up = _matrix * glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+			return glm::vec3(up.x, up.y, up.z);
+		}
 
-			unsigned int pushConstants[3] = { _imageWidthPixels, _imageHeightPixels, _radiusPixels };
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
-			vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(unsigned int) * 3, pushConstants);
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 1, &_descriptorSet, 0, NULL);
-			vkCmdDispatch(commandBuffer, _workGroupCount[0], _workGroupCount[1], _workGroupCount[2]);
+		glm::vec3 Forward() {
+			glm::vec4 forward = _matrix * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+			return glm::vec3(forward.x, forward.y, forward.z);
+		}
 
-			// End command buffer recording.
-			res = vkEndCommandBuffer(commandBuffer);
-			if (res != VK_SUCCESS) return res;
+		void Translate(const glm::vec3& offsetLocalSpace) {
+			_matrix[3][0] += offsetLocalSpace.x;
+			_matrix[3][1] += offsetLocalSpace.y;
+			_matrix[3][2] += offsetLocalSpace.z;
+		}
 
-			// Submit the command buffer.
-			VkSubmitInfo submitInfo;
-			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			submitInfo.pNext = 0;
-			submitInfo.waitSemaphoreCount = (uint32_t)0;
-			submitInfo.pWaitSemaphores = (const VkSemaphore*)NULL;
-			submitInfo.pWaitDstStageMask = (const VkPipelineStageFlags*)NULL;
-			submitInfo.commandBufferCount = (uint32_t)1;
-			submitInfo.pCommandBuffers = (const VkCommandBuffer*)&commandBuffer;
-			submitInfo.signalSemaphoreCount = (uint32_t)0;
-			submitInfo.pSignalSemaphores = (const VkSemaphore*)NULL;
-			clock_t t;
-			t = clock();
-			res = vkQueueSubmit(_queue, 1, &submitInfo, _fence);
-			if (res != VK_SUCCESS) return res;
+		void RotateAroundPosition(const glm::vec3& positionWorldSpace, const glm::vec3& axisWorldSpace, const float& angleRadians) {
+			if (angleRadians == 0) return;
+			auto rotation = MakeQuaternionRotation(axisWorldSpace, angleRadians);
+			auto currentPosition = Position();
+			SetPosition(positionWorldSpace + (rotation * (currentPosition - positionWorldSpace)));
+			Rotate(rotation);
+		}
 
-			// Wait for the fence that was configured to signal when execution has finished.
-			res = vkWaitForFences(_device, 1, &_fence, VK_TRUE, 30000000000);
-			if (res != VK_SUCCESS) return res;
+		glm::quat MakeQuaternionRotation(const glm::vec3& axis, const float& angleRadians) {
+			auto cosine = cos(angleRadians / 2.0f);
+			auto sine = sin(angleRadians / 2.0f);
+			return glm::quat(cosine, axis.x * sine, axis.y * sine, axis.z * sine);
+		}
 
-			// Calculate the time in milliseconds it took to execute and print the result to the console.
-			t = clock() - t;
-			double time = ((double)t) / CLOCKS_PER_SEC * 1000;
+		void Rotate(const glm::quat& rotation) {
+			// Rotate each individual axis of the transformation by the quaternion.
+			auto newX = rotation * glm::vec3(_matrix[0][0], _matrix[0][1], _matrix[0][2]);
+			auto newY = rotation * glm::vec3(_matrix[1][0], _matrix[1][1], _matrix[1][2]);
+			auto newZ = rotation * glm::vec3(_matrix[2][0], _matrix[2][1], _matrix[2][2]);
 
-			// Destroy the command buffer and reset the fence's status. A fence can be signalled or unsignalled. Once a fence is signalled, control is given back to the
-			// the code that called vkWaitForFences().
-			res = vkResetFences(_device, 1, &_fence);
-			if (res != VK_SUCCESS) return res;
+			// Set the new axes starting with X.
+			_matrix[0][0] = newX.x;
+			_matrix[0][1] = newX.y;
+			_matrix[0][2] = newX.z;
 
-			vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
-			return res;
-		}
+			// Then Y.
+			_matrix[1][0] = newY.x;
+			_matrix[1][1] = newY.y;
+			_matrix[1][2] = newY.z;
 
-		VkResult FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t memoryTypeBits, VkMemoryPropertyFlags memoryPropertyFlags, uint32_t* memoryTypeIndex) {
-			//find memory with specified properties
-			VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties = { 0 };
+			// And finally Z.
+			_matrix[2][0] = newZ.x;
+			_matrix[2][1] = newZ.y;
+			_matrix[2][2] = newZ.z;
+		}
 
-			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
+		void RotateR(const glm::vec3& axis, const float& angleRadians) {
+			if (angleRadians == 0.0f) { return; }
+			Rotate(MakeQuaternionRotation(axis, angleRadians));
+		}
 
-			for (uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryTypeCount; ++i) {
-				if ((memoryTypeBits & (1 << i)) && ((physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)) {
-					memoryTypeIndex[0] = i;
-					return VK_SUCCESS;
-				}
-			}
-			return VK_ERROR_INITIALIZATION_FAILED;
+		void Rotate(const glm::vec3& axis, const float& angleDegrees) {
+			if (angleDegrees == 0.0f) { return; }
+			RotateR(axis, glm::radians(angleDegrees));
 		}
 
-		VkResult AllocateGPUOnlyBuffer(VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize bufferSizeBytes, VkBuffer* outBuffer, VkDeviceMemory* outDeviceMemory) {
-			//allocate the buffer used by the GPU with specified properties
-			VkResult res = VK_SUCCESS;
-			uint32_t queueFamilyIndices;
-			VkBufferCreateInfo bufferCreateInfo;
-			bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferCreateInfo.pNext = 0;
-			bufferCreateInfo.flags = (VkBufferCreateFlags)0;
-			bufferCreateInfo.size = (VkDeviceSize)bufferSizeBytes;
-			bufferCreateInfo.usage = (VkBufferUsageFlags)bufferUsageFlags;
-			bufferCreateInfo.sharingMode = (VkSharingMode)VK_SHARING_MODE_EXCLUSIVE;
-			bufferCreateInfo.queueFamilyIndexCount = (uint32_t)1;
-			bufferCreateInfo.pQueueFamilyIndices = (const uint32_t*)&queueFamilyIndices;
+		void SetPosition(const glm::vec3& position) {
+			_matrix[3][0] = position.x;
+			_matrix[3][1] = position.y;
+			_matrix[3][2] = position.z;
+		}
 
-			res = vkCreateBuffer(_device, &bufferCreateInfo, NULL, outBuffer);
-			if (res != VK_SUCCESS) return res;
+		void SetScale(const glm::vec3& scale) {
+			_scale = scale;
+			_matrix[0][0] *= scale.x;
+			_matrix[1][1] *= scale.y;
+			_matrix[2][2] *= scale.z;
+		}
 
-			VkMemoryRequirements memoryRequirements = { 0 };
-			vkGetBufferMemoryRequirements(_device, *outBuffer, &memoryRequirements);
+		glm::vec3 Position() {
+			return glm::vec3(_matrix[3][0], _matrix[3][1], _matrix[3][2]);
+		}
+	};
 
-			//find memory with specified properties
-			uint32_t memoryTypeIndex = 0xFFFFFFFF;
-			vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &_physicalDeviceMemoryProperties);
+	class Image {
+	public:
+		VkImageCreateInfo _createInfo{};
+		VkImageViewCreateInfo _viewCreateInfo{};
+		VkSamplerCreateInfo _samplerCreateInfo{};
 
-			for (uint32_t i = 0; i < _physicalDeviceMemoryProperties.memoryTypeCount; ++i) {
-				if ((memoryRequirements.memoryTypeBits & (1 << i)) && ((_physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)) {
-					memoryTypeIndex = i;
-					break;
-				}
-			}
-			if (0xFFFFFFFF == memoryTypeIndex) return VK_ERROR_INITIALIZATION_FAILED;
+		VkImage _image{};
+		VkImageView _view{};
+		VkSampler _sampler{};
 
-			VkMemoryAllocateInfo memoryAllocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-										 0,
-										 (VkDeviceSize)memoryRequirements.size,
-										 (uint32_t)memoryTypeIndex };
+		VkImageLayout _currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkDeviceMemory _gpuMemory = nullptr;
+		void* _pData = nullptr;
+		size_t _sizeBytes = 0;
 
-			res = vkAllocateMemory(_device, &memoryAllocateInfo, NULL, outDeviceMemory);
-			if (res != VK_SUCCESS) return res;
+		Image() = default;
 
-			res = vkBindBufferMemory(_device, *outBuffer, *outDeviceMemory, 0);
-			return res;
+		Image(void* pData, size_t sizeBytes) {
+			_pData = pData;
+			_sizeBytes = sizeBytes;
 		}
 
-		VkResult UploadDataToGPU(void* data, VkBuffer* outBuffer, VkDeviceSize bufferSizeBytes) {
-			VkResult res = VK_SUCCESS;
+		/**
+		 * @brief Creates a 1x1 image of the given color. Colors are sRGB encoded by default; maps holding linear data, such as normal maps, use a UNORM format.
+		 */
+		static Image SolidColor(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, unsigned char r, unsigned char g, unsigned char b, unsigned char a, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Texture);
+			Image image;
 
-			//a function that transfers data from the CPU to the GPU using staging buffer,
-				//because the GPU memory is not host-coherent
-			VkDeviceSize stagingBufferSize = bufferSizeBytes;
-			VkBuffer stagingBuffer = { 0 };
-			VkDeviceMemory stagingBufferMemory = { 0 };
-			res = AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				stagingBufferSize,
-				&stagingBuffer,
-				&stagingBufferMemory);
-			if (res != VK_SUCCESS) return res;
+			image._sizeBytes = 4;
+			image._pData = malloc(image._sizeBytes);
+			unsigned char imageData[4] = { r, g, b, a };
+			memcpy(image._pData, imageData, image._sizeBytes);
 
-			void* stagingData;
-			res = vkMapMemory(_device, stagingBufferMemory, 0, stagingBufferSize, 0, &stagingData);
-			if (res != VK_SUCCESS) return res;
-			memcpy(stagingData, data, stagingBufferSize);
-			vkUnmapMemory(_device, stagingBufferMemory);
+			auto& imageCreateInfo = image._createInfo;
+			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.format = format;
+			imageCreateInfo.extent = { 1, 1, 1 };
+			imageCreateInfo.mipLevels = 1;
+			imageCreateInfo.arrayLayers = 1;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			ResourceTracker::CreateImage(logicalDevice, &imageCreateInfo, nullptr, &image._image);
 
-			VkCommandBufferAllocateInfo commandBufferAllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-												0,
-												(VkCommandPool)_commandPool,
-												(VkCommandBufferLevel)VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-												(uint32_t)1 };
-			VkCommandBuffer commandBuffer = { 0 };
-			res = vkAllocateCommandBuffers(_device, &commandBufferAllocateInfo, &commandBuffer);
-			if (res != VK_SUCCESS) return res;
+			VkMemoryRequirements reqs;
+			vkGetImageMemoryRequirements(logicalDevice, image._image, &reqs);
 
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = reqs.size;
+			allocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
+			ResourceTracker::AllocateMemory(logicalDevice, &allocInfo, nullptr, &image._gpuMemory);
+			vkBindImageMemory(logicalDevice, image._image, image._gpuMemory, 0);
 
-			VkCommandBufferBeginInfo commandBufferBeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-											 0,
-											 (VkCommandBufferUsageFlags)VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-											 (const VkCommandBufferInheritanceInfo*)NULL };
-			res = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
-			if (res != VK_SUCCESS) return res;
-			VkBufferCopy copyRegion = { 0, 0, stagingBufferSize };
-			vkCmdCopyBuffer(commandBuffer, stagingBuffer, *outBuffer, 1, &copyRegion);
-			res = vkEndCommandBuffer(commandBuffer);
-			if (res != VK_SUCCESS) return res;
+			auto& imageViewCreateInfo = image._viewCreateInfo;
+			imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			imageViewCreateInfo.image = image._image;
+			imageViewCreateInfo.format = imageCreateInfo.format;
+			imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+			imageViewCreateInfo.subresourceRange.levelCount = 1;
+			imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+			imageViewCreateInfo.subresourceRange.layerCount = 1;
+			imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			vkCreateImageView(logicalDevice, &imageViewCreateInfo, nullptr, &image._view);
 
-			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO,
-								 0,
-								 (uint32_t)0,
-								 (const VkSemaphore*)NULL,
-								 (const VkPipelineStageFlags*)NULL,
-								 (uint32_t)1,
-								 (const VkCommandBuffer*)&commandBuffer,
-								 (uint32_t)0,
-								 (const VkSemaphore*)NULL };
+			auto& samplerCreateInfo = image._samplerCreateInfo;
+			samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+			samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+			samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+			samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerCreateInfo.anisotropyEnable = VK_FALSE;
+			samplerCreateInfo.maxAnisotropy = 1.0f;
+			samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+			samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+			samplerCreateInfo.compareEnable = VK_FALSE;
+			samplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+			samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+			samplerCreateInfo.mipLodBias = 0.0f;
+			samplerCreateInfo.minLod = 0.0f;
+			samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+			vkCreateSampler(logicalDevice, &samplerCreateInfo, nullptr, &image._sampler);
 
-			res = vkQueueSubmit(_queue, 1, &submitInfo, _fence);
-			if (res != VK_SUCCESS) return res;
+			return image;
+		}
+	};
 
+	/**
+	 * @brief Describes the structure of a single descriptor set to provide context on how the shader should treat the descriptor set.
+	 * To make an analogy: if descriptor sets were cars, the blueprint used to fabricate them would be the descriptor set layout, and the
+	 * people inside the car would be the descriptors (the data the sets contain).
+	 * A descriptor set is a group of descriptors. Each descriptor in the set is an entry in the shader's input variables, and can be either
+	 * a buffer or an image.
+	 */
+	class DescriptorSetLayout {
+	public:
 
-			res = vkWaitForFences(_device, 1, &_fence, VK_TRUE, 100000000000);
-			if (res != VK_SUCCESS) return res;
+		/**
+		 * @brief To make it more recognizable when debugging.
+		 */
+		std::string _name = "";
 
-			res = vkResetFences(_device, 1, &_fence);
-			if (res != VK_SUCCESS) return res;
+		/**
+		 * @brief ID used to make the pipeline layout and the order the descriptor sets are bound to the pipeline (via vkBindDescriptorSets) match.
+		 * In shaders, this corresponds to the "set" decorator when defining an input variable, like in this line of GLSL:
+		 * layout(set = 3, binding = 0) uniform sampler2D albedoMap;
+		 */
+		int _id;
 
-			vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
-			vkDestroyBuffer(_device, stagingBuffer, NULL);
-			vkFreeMemory(_device, stagingBufferMemory, NULL);
-			return res;
+		/**
+		 * @brief Layout handle.
+		 */
+		VkDescriptorSetLayout _layout;
+
+		/**
+		 * @brief Used for ordering pipeline layouts in map structures.
+		 */
+		bool operator<(const DescriptorSetLayout& other) const {
+			return _id < other._id;
 		}
 
-		VkResult DownloadDataFromGPU(void* data, VkBuffer* outBuffer, VkDeviceSize bufferSize) {
-			VkResult res = VK_SUCCESS;
-			VkCommandBuffer commandBuffer = { 0 };
+		/**
+		 * @brief Used for ordering pipeline layouts in map structures.
+		 */
+		bool operator==(const DescriptorSetLayout& other) const {
+			return _id == other._id;
+		}
+	};
 
-			// A function that transfers data from the GPU to the CPU using staging buffer, because GPU memory is not host-coherent (meaning it is
-			// not synced with the contents of CPU memory).
-			VkDeviceSize stagingBufferSize = bufferSize;
-			VkBuffer stagingBuffer = { 0 };
-			VkDeviceMemory stagingBufferMemory = { 0 };
-			res = AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				stagingBufferSize,
-				&stagingBuffer,
-				&stagingBufferMemory);
-			if (res != VK_SUCCESS) return res;
-
-			VkCommandBufferAllocateInfo commandBufferAllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-												0,
-												(VkCommandPool)_commandPool,
-												(VkCommandBufferLevel)VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-												(uint32_t)1 };
-			res = vkAllocateCommandBuffers(_device, &commandBufferAllocateInfo, &commandBuffer);
-			if (res != VK_SUCCESS) return res;
+	/**
+	 * @brief Represents a description of how data from CPU-side memory is bound to input variables in the shaders.
+	 */
+	class ShaderResources {
+	public:
 
-			VkCommandBufferBeginInfo commandBufferBeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-											 0,
-											 (VkCommandBufferUsageFlags)VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-											 (const VkCommandBufferInheritanceInfo*)NULL };
-			res = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
-			if (res != VK_SUCCESS) return res;
+		std::map<DescriptorSetLayout, std::vector<VkDescriptorSet>> _data;
 
-			VkBufferCopy copyRegion = { (VkDeviceSize)0,
-								 (VkDeviceSize)0,
-								 (VkDeviceSize)stagingBufferSize };
+		/**
+		 * @brief Merges this shader resources instance with another.
+		 */
+		void MergeResources(ShaderResources& other) {
+			for (const auto& pair : other._data) {
+				auto it = _data.find(pair.first);
+				if (it != _data.end()) {
+					// Here, you can decide how to merge the values.
+					// For simplicity, I'm replacing the value in map1 with the value from map2.
+					it->second = pair.second;
+				}
+				else {
+					_data.insert(pair);
+				}
+			}
+		}
 
-			vkCmdCopyBuffer(commandBuffer, outBuffer[0], stagingBuffer, 1, &copyRegion);
-			vkEndCommandBuffer(commandBuffer);
+		/**
+		 * @brief Operator overload to index into _data.
+		 */
+		std::vector<VkDescriptorSet>& operator[](const int& index) {
+			// Layouts are ordered and compared by ID only, so a key with just the ID is enough to find the entry.
+			auto it = _data.find(DescriptorSetLayout{ "", index, VK_NULL_HANDLE });
 
-			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO,
-								 0,
-								 (uint32_t)0,
-								 (const VkSemaphore*)NULL,
-								 (const VkPipelineStageFlags*)NULL,
-								 (uint32_t)1,
-								 (const VkCommandBuffer*)&commandBuffer,
-								 (uint32_t)0,
-								 (const VkSemaphore*)NULL };
+			if (it == _data.end()) {
+				Exit(1, "index not found");
+			}
 
-			res = vkQueueSubmit(_queue, 1, &submitInfo, _fence);
-			if (res != VK_SUCCESS) return res;
+			return it->second;
+		}
+	};
 
-			res = vkWaitForFences(_device, 1, &_fence, VK_TRUE, 100000000000);
-			if (res != VK_SUCCESS) return res;
+	/**
+	 * @brief Encapsulates info for a swapchain.
+	 * The swapchain is an image manager; it manages everything that involves presenting images to the screen,
+	 * or more precisely passing the contents of the framebuffers on the GPU down to the window.
+	 */
+	struct Swapchain {
+		/**
+		 * @brief Identifier for Vulkan.
+		 */
+		VkSwapchainKHR _handle;
 
-			res = vkResetFences(_device, 1, &_fence);
-			if (res != VK_SUCCESS) return res;
+		/**
+		 * @brief These are the buffers that contain the final rendered images shown on screen.
+		 * A framebuffer is stored on a different portion of memory with respect to the depth and
+		 * color attachments used by a render pass. The depth and color images CONTRIBUTE to generating
+		 * an image for a framebuffer.
+		 */
+		std::vector<VkFramebuffer> _frameBuffers;
 
-			vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+		/**
+		 * @brief Dimensions in pixels of the framebuffers.
+		 */
+		VkExtent2D _framebufferSize;
 
-			void* stagingData;
-			res = vkMapMemory(_device, stagingBufferMemory, 0, stagingBufferSize, 0, &stagingData);
-			if (res != VK_SUCCESS) return res;
+		/**
+		 * @brief Image format that the window surface expects when it has to send images from a framebuffer to a monitor.
+		 */
+		VkSurfaceFormatKHR _surfaceFormat;
 
-			memcpy(data, stagingData, stagingBufferSize);
-			vkUnmapMemory(_device, stagingBufferMemory);
+		/**
+		 * @brief Old swapchain handle used when the swapchain is recreated.
+		 */
+		VkSwapchainKHR _oldSwapchainHandle;
 
-			vkDestroyBuffer(_device, stagingBuffer, NULL);
-			vkFreeMemory(_device, stagingBufferMemory, NULL);
-			return res;
-		}
+		/**
+		 * @brief The amount of images used by this swapchain to show render results in turn.
+		 */
+		uint32_t _imageCount;
 
-		VkResult GetComputeQueueFamilyIndex() {
-			//find a queue family for a selected GPU, select the first available for use
-			uint32_t queueFamilyCount;
-			vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, NULL);
+		/**
+		 * @brief Present mode the settings asked for when the swapchain was created. The swapchain is recreated when the setting changes.
+		 */
+		VkPresentModeKHR _requestedPresentMode;
 
-			VkQueueFamilyProperties* queueFamilies = (VkQueueFamilyProperties*)malloc(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
+		/**
+		 * @brief Swapchain images used for presentation (showing the render results to the window).
+		 */
+		std::vector<Image> _images;
+	};
 
-			vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, queueFamilies);
-			uint32_t i = 0;
-			for (; i < queueFamilyCount; i++) {
-				VkQueueFamilyProperties props = queueFamilies[i];
+	/**
+	 * @brief Encapsulates info for a render pass.
+	 * A render pass represents a specific set of commands that generate images, called attachments.
+	 * Attachments are rendered images that contribute to rendering the final image that will go in the framebuffer.
+	 * It is the renderpass's job to also do compositing, which is defining the logic according to which the attachments are merged to create the final image.
+	 * See Swapchain to understand what framebuffers are.
+	 */
+	struct RenderPass {
+		/**
+		 * @brief Identifier for Vulkan.
+		 */
+		VkRenderPass _handle;
 
-				if (props.queueCount > 0 && (props.queueFlags & VK_QUEUE_COMPUTE_BIT)) {
-					break;
-				}
-			}
-			free(queueFamilies);
-			if (i == queueFamilyCount) {
-				return VK_ERROR_INITIALIZATION_FAILED;
-			}
-			_queueFamilyIndex = i;
-			return VK_SUCCESS;
-		}
+		/**
+		 * @brief Attachments used by the GPU to write color information to.
+		 */
+		std::vector<Image> _colorImages;
 
-		VkResult CreateLogicalDevice() {
-			//create logical device representation
-			VkResult res = VK_SUCCESS;
-			res = GetComputeQueueFamilyIndex();
-			if (res != VK_SUCCESS) return res;
-			vkGetDeviceQueue(_device, _queueFamilyIndex, 0, &_queue);
-			return res;
+		/**
+		 * @brief Attachment that stores per-pixel depth information for the hardwired depth testing stage.
+		 * This makes sure that the pixels of each triangle are rendered or not, depending on which pixel
+		 * is closer to the camera, which is the information stored in this image.
+		 */
+		Image _depthImage;
 
-			float queuePriorities = 1.0;
-			VkDeviceQueueCreateInfo deviceQueueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-					0,
-					(VkDeviceQueueCreateFlags)0,
-					(uint32_t)_queueFamilyIndex,
-					(uint32_t)1,
-					(const float*)&queuePriorities };
+	};
 
-			VkPhysicalDeviceFeatures physicalDeviceFeatures = { 0 };
-			physicalDeviceFeatures.shaderFloat64 = VK_TRUE;//this enables double precision support in shaders 
+	/**
+	 * @brief The graphics pipeline represents, at the logical level, the entire process
+	 * of inputting vertices, indices and textures into the GPU and getting a 2D image that represents the scene
+	 * passed in out of it. In early GPUs, this process was hardwired into the graphics chip, but as technology improved and needs
+	 * for better and more complex graphics increased, GPU producers have taken steps to make this a much more programmable
+	 * and CPU-like process, so much so that technologies like CUDA (Compute Uniform Device Architecture) have come out.
+	 *
+	 * Nowadays the typical GPU consists of an array of clusters of microprocessors, where each micro
+	 * processor is highly multithreaded, and its ALU and instruction set (thus its circuitry) optimized for operating on
+	 * floating point numbers, vectors and matrices (as that is what is used to represent coordinates in space and space transformations).
+	 *
+	 * CUDA is the result of NVidia and Microsoft working together to improve the programmers' experience for programming
+	 * shaders; the result is a product that maps C/C++ instructions to the GPU's ALUs instruction set, to take full advantage
+	 * of the GPU's high amount of cores and threads. By doing this, things like crypto mining and machine learning have gotten
+	 * a huge boost, as the data that requires manipulation is very loosely coupled (has very few dependecies on the data in
+	 * the same set) and, as a result, can be processed by many independent threads simultaneously. This is called a compute pipeline.
+	 * Khronos, the developers of the Vulkan API, have also done something similar called OpenCL, the compute side of OpenGL.
+	 *
+	 * The typical graphics (or render) pipeline consists of programmable, configurable and hardwired stages, where:
+	 * a) The programmable stages are custom stages that will be run on the GPU's multi-purpose array of microprocessors using a program (a.k.a shader).
+	 * b) The configurable stages are hardwired stages that can perform their task a different way based on user configuration via calls to the Vulkan API.
+	 * c) The hardwired stages are immutable stages that cannot be changed unless manipulating the hardware.
+	 * The graph of a typical graphics pipeline is shown under docs/GraphicsPipeline.jpg.
+	 *
+	 * More on the programmable stages:
+	 * The programmable stages are the flexible stages that the programmer can fully customize by writing little programs called shaders.
+	 * These shader programs will run:
+	 * 1) once per vertex in the case of the vertex shader; this shader program's goal is to take vertex attrbutes in, and output
+	 * a vertex color and 2D position (more precisely, a 3D position inside of the Vulkan's coordinate range, which is -1 to 1 for X and Y and 0 to 1 for Z).
+	 * 2) once per pixel in the case of the fragment shader; this stage's goal is to take the rasterizer's output (which is a hardwired
+	 * stage on the GPU chip as of 2022, whose goal is to color pixels based on vertex colors) and textures, and output a colored pixel based on
+	 * the color of the textures and other variables such as direct and indirect lighting.
+	 * There are other shader stages, but the 2 above are the strictly needed shaders in order to be able to render something.
 
-			VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-					0,
-					(VkDeviceCreateFlags)0,
-					(uint32_t)1,
-					(const VkDeviceQueueCreateInfo*)&deviceQueueCreateInfo,
-					(uint32_t)0,
-					(const char* const*)NULL,
-					(uint32_t)0,
-					(const char* const*)NULL,
-					(const VkPhysicalDeviceFeatures*)&physicalDeviceFeatures };
+	 * This type of execution flow has a name and is called SIMD (Single Instruction Multiple Data), as the same program (single instruction)
+	 * is run independently on different cores/threads for multiple vertices or pixels (multiple data).
+	 *
+	 * Examples of the configurable stages are anti-aliasing and tessellation.
+	 * Examples of hardwired stages are backface-culling, depth testing and alpha blending.
+	 *
+	 * For a good overall hardware and software explanation of a typical NVidia GPU, see
+	 * https://developer.nvidia.com/gpugems/gpugems2/part-iv-general-purpose-computation-gpus-primer/chapter-30-geforce-6-series-gpu
+	 */
+	struct Pipeline {
 
-			res = vkCreateDevice(_physicalDevice, &deviceCreateInfo, NULL, &_device);
-			if (res != VK_SUCCESS) return res;
+		/**
+		 * @brief Identifier for Vulkan.
+		 */
+		VkPipeline _handle;
 
-		}
+		/**
+		* @brief Access to descriptor sets from a pipeline is accomplished through a pipeline layout. Zero or more descriptor set layouts and zero or more
+		* push constant ranges are combined to form a pipeline layout object describing the complete set of resources that can be accessed by a pipeline.
+		* The pipeline layout represents a sequence of descriptor sets with each having a specific layout. This sequence of layouts is used to determine
+		* the interface between shader stages and shader resources. Each pipeline is created using a pipeline layout.
+		*/
+		VkPipelineLayout _layout;
 
-		void InitializeVulkan() {
-			VkResult res = VK_SUCCESS;
+		/**
+		 * @brief See ShaderResources definition.
+		 */
+		ShaderResources _shaderResources;
+	};
 
-			// Create the instance - a connection between the application and the Vulkan library.
-			/*res = CreateInstance(vkGPU);
-			std::cout << "Instance creation failed, error code: " << res;*/
+	/**
+	 * @brief Hands out descriptor sets from a list of shared descriptor pools, creating a new pool whenever the current one runs out.
+	 * Sets allocated from it live until Reset or Destroy is called, so an allocator can either hold sets that live as long as the scene,
+	 * or be reset every frame to hold sets that are rewritten every frame.
+	 */
+	class DescriptorAllocator {
+	public:
 
-			// Set up the debugging messenger.
-			/*res = SetupDebugUtilsMessenger(vkGPU);
-			std::cout << "Debug utils messenger creation failed, error code: " << res;*/
-
-			// Check if there are GPUs that support Vulkan and select one.
-			/*res = FindGPU(vkGPU);
-			std::cout << "Physical device not found, error code: " << res;*/
-
-			// Create logical device representation.
-			if (CreateLogicalDevice() != VK_SUCCESS) {
-				std::cout << "Logical device creation failed." << std::endl;
-			}
+		/**
+		 * @brief Maximum number of sets each pool can hold.
+		 */
+		uint32_t _setsPerPool = 128;
 
-			// Create a fence for synchronization.
-			VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, 0 };
-			if (vkCreateFence(_device, &fenceCreateInfo, NULL, &_fence)) {
-				std::cout << "Fence creation failed." << std::endl;
-			}
+		/**
+		 * @brief Pools that sets have been allocated from, the last one being the one currently in use.
+		 */
+		std::vector<VkDescriptorPool> _usedPools;
 
-			// Create a structure from which command buffer memory is allocated from.
-			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, NULL, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, _queueFamilyIndex };
-			if (vkCreateCommandPool(_device, &commandPoolCreateInfo, NULL, &_commandPool)) {
-				std::cout << "Command Pool Creation failed." << std::endl;
-			}
-		}
+		/**
+		 * @brief Pools that were reset and can be reused without creating new ones.
+		 */
+		std::vector<VkDescriptorPool> _freePools;
 
-		void CalculateWorkGroupCountAndSize() {
-			// Prepare variables.
-			uint32_t maxWorkGroupInvocations = _physicalDeviceProperties.limits.maxComputeWorkGroupInvocations;
-			uint32_t* maxWorkGroupSize = _physicalDeviceProperties.limits.maxComputeWorkGroupSize;
-			uint32_t* maxWorkGroupCount = _physicalDeviceProperties.limits.maxComputeWorkGroupCount;
-			uint32_t workGroupSize[3] = { 1, 1, 1 };
-			uint32_t workGroupCount[3] = { 1, 1, 1 };
+		VkDescriptorSet Allocate(VkDevice& logicalDevice, VkDescriptorSetLayout setLayout) {
+			if (_usedPools.size() == 0 || _setsLeftInCurrentPool == 0) UsePool(logicalDevice);
 
-			// Use the work group size first, as that directly controls the amount of threads 1 to 1.
-			uint32_t totalWorkGroupSize = workGroupSize[0] * workGroupSize[1] * workGroupSize[2];
-			for (int i = 0; i < 3; ++i) {
-				for (; workGroupSize[i] < maxWorkGroupSize[i]; ++workGroupSize[i]) {
-					totalWorkGroupSize = workGroupSize[0] * workGroupSize[1] * workGroupSize[2];
-					if (totalWorkGroupSize >= _inputBufferCount || totalWorkGroupSize == maxWorkGroupInvocations) { break; }
-				}
-			}
+			VkDescriptorSetAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = _usedPools.back();
+			allocInfo.descriptorSetCount = (uint32_t)1;
+			allocInfo.pSetLayouts = &setLayout;
+			VkDescriptorSet descriptorSet;
+			auto result = vkAllocateDescriptorSets(logicalDevice, &allocInfo, &descriptorSet);
 
-			// If one workgroup still doesn't do it, use multiple workgroups with the size of each one calculated earlier.
-			if (totalWorkGroupSize < _inputBufferCount) {
-				for (int i = 0; i < 3; ++i) {
-					for (; workGroupCount[i] < maxWorkGroupCount[i]; ++workGroupCount[i]) {
-						if (((workGroupCount[0] * workGroupCount[1] * workGroupCount[2]) * totalWorkGroupSize) >= _inputBufferCount) { break; }
-					}
-				}
+			// The pool ran out of descriptors of one of the types in the layout before running out of sets, so try again with a new pool.
+			if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+				UsePool(logicalDevice);
+				allocInfo.descriptorPool = _usedPools.back();
+				result = vkAllocateDescriptorSets(logicalDevice, &allocInfo, &descriptorSet);
 			}
+			CheckResult(result);
 
-			// Return the calculated size and count in the output params.
-			_workGroupCount[0] = workGroupCount[0];
-			_workGroupCount[1] = workGroupCount[1];
-			_workGroupCount[2] = workGroupCount[2];
-			_workGroupSize[0] = workGroupSize[0];
-			_workGroupSize[1] = workGroupSize[1];
-			_workGroupSize[2] = workGroupSize[2];
+			--_setsLeftInCurrentPool;
+			return descriptorSet;
 		}
 
-	public:
-		unsigned char* Run(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, unsigned char* loadedImage, unsigned int imageWidthPixels, unsigned int imageHeightPixels, unsigned int radiusPixels = 15) {
-			_physicalDevice = physicalDevice;
-			_device = logicalDevice;
-			_imageWidthPixels = imageWidthPixels;
-			_imageHeightPixels = imageHeightPixels;
-			_radiusPixels = radiusPixels;
-
-			InitializeVulkan();
-
-			// Get device properties and memory properties, if needed.
-			vkGetPhysicalDeviceProperties(physicalDevice, &_physicalDeviceProperties);
-			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_physicalDeviceMemoryProperties);
-
-			// Load the image.
-			int wantedComponents = 4;
-
-			// In the stbi_load() function, comp stands for components. In a PNG image, for example, there are 4 components 
-			// for each pixel, red, green, blue and alpha.
-			// The image's pixels are read and stored left to right, top to bottom, relative to the image.
-			// Each pixel's component is an unsigned char.
-			int width = imageWidthPixels;
-			int height = imageHeightPixels;
-
-			//unsigned char* loadedImage = stbi_load("C:\\Users\\paolo.parker\\source\\repos\\celeritas-engine\\textures\\LeftFace.png", &width, &height, &componentsDetected, wantedComponents);
-
-			// The most optimal memory has the VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT flag and is usually not accessible by the CPU on dedicated graphics cards. 
-			// The memory type that allows us to access it from the CPU may not be the most optimal memory type for the graphics card itself to read from.
-			// Generate some random data in the array to use as input for the compute shader.
-			uint32_t inputAndOutputBufferSizeInBytes = (uint32_t)(imageWidthPixels * imageHeightPixels) * 4;
-
-			// Prepare the input and output buffers.
-			_inputBufferCount = (uint32_t)(imageWidthPixels * imageHeightPixels);
-			_inputBuffer;
-			_inputBufferDeviceMemory;
-			_outputBufferCount = _inputBufferCount;
-			_outputBuffer;
-			_outputBufferDeviceMemory;
-
-			// Calculate how many workgroups and the size of each workgroup we are going to use.
-			// We want one GPU thread to operate on a single value from the input buffer, so the required thread size is the input buffer size.
-			CalculateWorkGroupCountAndSize();
-
-			//use default values if coalescedMemory = 0
-			if (_coalescedMemory == 0) {
-				switch (_physicalDeviceProperties.vendorID) {
-				case 0x10DE://NVIDIA - change to 128 before Pascal
-					_coalescedMemory = 32;
-					break;
-				case 0x8086://INTEL
-					_coalescedMemory = 64;
-					break;
-				case 0x13B5://AMD
-					_coalescedMemory = 64;
-					break;
-				default:
-					_coalescedMemory = 64;
-					break;
-				}
-			}
-
-			// Create the input buffer.
-			VkResult res = VK_SUCCESS;
-			if (AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, //device local memory
-				inputAndOutputBufferSizeInBytes,
-				&_inputBuffer,
-				&_inputBufferDeviceMemory) != VK_SUCCESS) {
-				std::cout << "Input buffer allocation failed." << std::endl;
-			}
-
-			// Create the output buffer.
-			if (AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, //device local memory
-				inputAndOutputBufferSizeInBytes,
-				&_outputBuffer,
-				&_outputBufferDeviceMemory) != VK_SUCCESS) {
-				std::cout << "Output buffer allocation failed." << std::endl;
-			}
-
-			// Transfer data to GPU staging buffer and thereafter sync the staging buffer with GPU local memory.
-			if (UploadDataToGPU(loadedImage, &_inputBuffer, inputAndOutputBufferSizeInBytes) != VK_SUCCESS) {
-				std::cout << "Failed uploading image to GPU." << std::endl;
-			}
-
-			VkBuffer buffers[2] = { _inputBuffer, _outputBuffer };
-			VkDeviceSize buffersSize[2] = { inputAndOutputBufferSizeInBytes, inputAndOutputBufferSizeInBytes };
-
-			// Create 
-			//const char* shaderPath = "C:\\code\\vulkan-compute\\shaders\\Shader.spv";
-			auto shaderPath = Paths::ShadersPath() /= L"compute\\BoxBlur.spv";
-			if (CreateComputePipeline(buffers, buffersSize, shaderPath.string().c_str()) != VK_SUCCESS) {
-				std::cout << "Application creation failed." << std::endl;
-			}
-
-			if (Dispatch() != VK_SUCCESS) {
-				std::cout << "Application run failed." << std::endl;
+		/**
+		 * @brief Frees all the sets allocated so far at once. The pools are kept for later allocations.
+		 */
+		void Reset(VkDevice& logicalDevice) {
+			for (auto& pool : _usedPools) {
+				vkResetDescriptorPool(logicalDevice, pool, 0);
+				_freePools.push_back(pool);
 			}
+			_usedPools.clear();
+			_setsLeftInCurrentPool = 0;
+		}
 
-			unsigned char* shaderOutputBufferData = (unsigned char*)malloc(inputAndOutputBufferSizeInBytes);
+		void Destroy(VkDevice& logicalDevice) {
+			Reset(logicalDevice);
+			for (auto& pool : _freePools) ResourceTracker::DestroyDescriptorPool(logicalDevice, pool, nullptr);
+			_freePools.clear();
+		}
 
-			res = vkGetFenceStatus(_device, _fence);
+	private:
 
-			//Transfer data from GPU using staging buffer, if needed
-			if (DownloadDataFromGPU(shaderOutputBufferData,
-				&_outputBuffer,
-				inputAndOutputBufferSizeInBytes) != VK_SUCCESS) {
-				std::cout << "Failed downloading image from GPU." << std::endl;
-			}
+		uint32_t _setsLeftInCurrentPool = 0;
 
-			// Print data for debugging.
-			/*printf("Output buffer result: [");
-			uint32_t startAndEndSize = 50;
-			uint32_t i = 0;
-			for (; i < outputBufferCount - 1 && i < startAndEndSize; ++i) {
-				printf("%d, ", shaderOutputBufferData[i]);
+		void UsePool(VkDevice& logicalDevice) {
+			if (_freePools.size() > 0) {
+				_usedPools.push_back(_freePools.back());
+				_freePools.pop_back();
 			}
-			if (i >= startAndEndSize) {
-				printf("..., ");
-				i = outputBufferCount - startAndEndSize + 1;
-				for (; i < outputBufferCount - 1; ++i)
-					printf("%d, ", shaderOutputBufferData[i]);
+			else {
+				// Sizes are per set: the scene uses mostly uniform buffers and texture samplers, with a few storage buffers.
+				VkDescriptorPoolSize poolSizes[3] = {
+					VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 * _setsPerPool },
+					VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * _setsPerPool },
+					VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 * _setsPerPool }
+				};
+				VkDescriptorPoolCreateInfo createInfo = {};
+				createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+				createInfo.maxSets = _setsPerPool;
+				createInfo.poolSizeCount = (uint32_t)3;
+				createInfo.pPoolSizes = poolSizes;
+				VkDescriptorPool pool;
+				CheckResult(ResourceTracker::CreateDescriptorPool(logicalDevice, &createInfo, nullptr, &pool));
+				_usedPools.push_back(pool);
 			}
-			printf("%d]\n", shaderOutputBufferData[outputBufferCount - 1]);*/
-
-			// Free resources.
-			vkDestroyBuffer(_device, _inputBuffer, nullptr);
-			vkFreeMemory(_device, _inputBufferDeviceMemory, nullptr);
-			vkDestroyBuffer(_device, _outputBuffer, nullptr);
-			vkFreeMemory(_device, _outputBufferDeviceMemory, nullptr);
-
-			return shaderOutputBufferData;
-		}
-
-		void Destroy() {
-			vkDestroyFence(_device, _fence, nullptr);
-			vkDestroyDescriptorPool(_device, _descriptorPool, NULL);
-			vkDestroyDescriptorSetLayout(_device, _descriptorSetLayout, NULL);
-			vkDestroyPipelineLayout(_device, _pipelineLayout, NULL);
-			vkDestroyPipeline(_device, _pipeline, NULL);
+			_setsLeftInCurrentPool = _setsPerPool;
 		}
 	};
 
 	/**
-	 * @brief Used specifically for the CubicalEnvironmentMap class in order to index into its faces.
-	 */
-	enum class CubeMapFace {
-		NONE,
-		FRONT,
-		RIGHT,
-		BACK,
-		LEFT,
-		UPPER,
-		LOWER
-	};
-
-	/**
-	 * @brief Represents a cubical environment map, used as an image-based light source
-	 * in the shaders.
+	 * @brief Keeps the VkPipelineCache and the shader modules of a logical device, so that pipelines are built from what the driver
+	 * compiled in previous runs instead of from scratch. The cache data is loaded from disk at startup and written back on shutdown.
+	 * Each logical device has its own cache, used only by the thread that owns the device, so no locking is done.
 	 */
-	class CubicalEnvironmentMap : public IPipelineable, public IDrawable {
-
+	class PipelineCache {
 	public:
 
 		/**
-		 * @brief Physical device.
+		 * @brief A shader module along with a hash of the SPIR-V it was created from.
 		 */
-		VkPhysicalDevice _physicalDevice{};
+		struct ShaderModule {
+			uint64_t _contentHash;
+			VkShaderModule _handle;
+		};
 
 		/**
-		 * @brief Logical device.
+		 * @brief Handle to pass to every vkCreate*Pipelines call on the device.
 		 */
-		VkDevice _logicalDevice = nullptr;
+		VkPipelineCache _handle = VK_NULL_HANDLE;
 
 		/**
-		 * @brief Front face data, including all mipmaps.
+		 * @brief Shader modules by the path of the .spv file they were loaded from.
 		 */
-		std::vector<std::vector<unsigned char>> _front;
+		std::map<std::string, ShaderModule> _shaderModulesByPath;
 
 		/**
-		 * @brief Right face data, including all mipmaps.
+		 * @brief Shader modules by the hash of their SPIR-V, so that the same code found at different paths is only turned into a module once.
 		 */
-		std::vector<std::vector<unsigned char>> _right;
+		std::map<uint64_t, VkShaderModule> _shaderModulesByHash;
 
 		/**
-		 * @brief Back face data, including all mipmaps.
+		 * @brief Creates the pipeline cache, seeding it with the data at the given path if the data was written by the same driver
+		 * for the same physical device. The driver rejects foreign data itself, but not all drivers do it gracefully, so the header is checked here first.
 		 */
-		std::vector<std::vector<unsigned char>> _back;
+		void Create(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, const std::filesystem::path& absolutePath) {
+			std::vector<char> initialData;
+			if (FileIO::ReadAll(absolutePath, initialData)) {
+				if (!IsCompatible(physicalDevice, initialData)) {
+					Logger::Info("pipeline cache at {} was written by a different device or driver, starting with an empty cache", absolutePath);
+					initialData.clear();
+				}
+			}
 
-		/**
-		 * @brief Left face data, including all mipmaps.
-		 */
-		std::vector<std::vector<unsigned char>> _left;
+			VkPipelineCacheCreateInfo createInfo = {};
+			createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			createInfo.initialDataSize = initialData.size();
+			createInfo.pInitialData = initialData.data();
+			CheckResult(vkCreatePipelineCache(logicalDevice, &createInfo, nullptr, &_handle));
+		}
 
 		/**
-		 * @brief Upper face data, including all mipmaps.
+		 * @brief Writes the data of the pipeline cache to the given path, so that the next run can start from it.
 		 */
-		std::vector<std::vector<unsigned char>> _upper;
+		void Save(VkDevice& logicalDevice, const std::filesystem::path& absolutePath) {
+			if (_handle == VK_NULL_HANDLE) return;
 
-		/**
-		 * @brief Lower face data, including all mipmaps.
-		 */
-		std::vector<std::vector<unsigned char>> _lower;
+			size_t dataSize = 0;
+			CheckResult(vkGetPipelineCacheData(logicalDevice, _handle, &dataSize, nullptr));
+			std::vector<char> data(dataSize);
+			CheckResult(vkGetPipelineCacheData(logicalDevice, _handle, &dataSize, data.data()));
 
-		/**
-		 * @brief Data loaded from the HDRi image file.
-		 */
-		std::vector<std::vector<unsigned char>> _hdriImageData;
+			std::filesystem::create_directories(absolutePath.parent_path());
+			std::ofstream file(absolutePath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) { Logger::Warning("failed writing pipeline cache to {}", absolutePath); return; }
+			file.write(data.data(), dataSize);
+		}
 
 		/**
-		 * @brief Width and height of the loaded HDRi image.
+		 * @brief Returns the shader module for the .spv file at the given path, only reading the file the first time the path is asked for.
+		 * The module is owned by the cache and must not be destroyed by the caller.
 		 */
-		VkExtent2D _hdriSizePixels{};
+		VkShaderModule GetShaderModule(VkDevice& logicalDevice, const std::filesystem::path& absolutePath) {
+			auto key = absolutePath.string();
+			auto foundByPath = _shaderModulesByPath.find(key);
+			if (foundByPath != _shaderModulesByPath.end()) return foundByPath->second._handle;
+
+			std::vector<char> fileBytes;
+			if (!FileIO::ReadAll(absolutePath, fileBytes)) Exit(1, ("failed opening shader file " + key).c_str());
+
+			ShaderModule shaderModule{ Helpers::Hash64(fileBytes.data(), fileBytes.size()), VK_NULL_HANDLE };
+			auto foundByHash = _shaderModulesByHash.find(shaderModule._contentHash);
+			if (foundByHash != _shaderModulesByHash.end()) {
+				shaderModule._handle = foundByHash->second;
+			}
+			else {
+				VkShaderModuleCreateInfo createInfo = {};
+				createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+				createInfo.codeSize = fileBytes.size();
+				createInfo.pCode = (uint32_t*)fileBytes.data();
+				CheckResult(vkCreateShaderModule(logicalDevice, &createInfo, nullptr, &shaderModule._handle));
+				_shaderModulesByHash[shaderModule._contentHash] = shaderModule._handle;
+			}
+			_shaderModulesByPath[key] = shaderModule;
+			return shaderModule._handle;
+		}
+
+		void Destroy(VkDevice& logicalDevice) {
+			for (auto& [hash, shaderModule] : _shaderModulesByHash) vkDestroyShaderModule(logicalDevice, shaderModule, nullptr);
+			_shaderModulesByHash.clear();
+			_shaderModulesByPath.clear();
+			if (_handle != VK_NULL_HANDLE) vkDestroyPipelineCache(logicalDevice, _handle, nullptr);
+			_handle = VK_NULL_HANDLE;
+		}
+
+	private:
 
 		/**
-		 * @brief Width and height of each face's image.
+		 * @brief Checks the header every pipeline cache blob starts with (VK_PIPELINE_CACHE_HEADER_VERSION_ONE) against the properties of the physical device.
 		 */
-		int _faceSizePixels = 0;
+		static bool IsCompatible(VkPhysicalDevice& physicalDevice, const std::vector<char>& data) {
+			struct Header {
+				uint32_t _headerSize;
+				uint32_t _headerVersion;
+				uint32_t _vendorId;
+				uint32_t _deviceId;
+				uint8_t _pipelineCacheUuid[VK_UUID_SIZE];
+			};
+			if (data.size() < sizeof(Header)) return false;
 
-		/**
-		 * @brief Vulkan handle to the cube map image used in the shaders. This image is meant to contain all the cube map's images as a serialized array of pixels.
-		 * In order to know where, in the array of pixels, each image starts/ends and what format it's in, a sampler and image view are used.
+			Header header;
+			memcpy(&header, data.data(), sizeof(Header));
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+			return header._headerSize >= sizeof(Header) &&
+				header._headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+				header._vendorId == properties.vendorID &&
+				header._deviceId == properties.deviceID &&
+				memcmp(header._pipelineCacheUuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+	};
+
+	/**
+	 * @brief Represents all the needed, or neeeded in order to obtain, information to run any call in the Vulkan API.
+	 */
+	struct VkContext {
+		VkInstance _instance;
+		VkDevice _logicalDevice;
+		VkPhysicalDevice _physicalDevice;
+		VkCommandPool _commandPool;
+		VkSurfaceKHR _windowSurface;
+		VkQueue _queue;
+		uint32_t _queueFamilyIndex;
+		VkFence _queueFence;
+
+		/**
+		 * @brief Allocator for descriptor sets that live as long as the device.
 		 */
-		Image _cubeMapImage{ nullptr, 0 };
+		DescriptorAllocator _descriptorAllocator;
 
 		/**
-		 * @brief Number of mipmaps. This is dynamically caluclated.
+		 * @brief Pipeline cache and shader modules of the logical device.
 		 */
-		int _mipmapCount = 0;
+		PipelineCache _pipelineCache;
+		/**
+		 * @brief Function pointer called by Vulkan each time it wants to report an error.
+		 * Error reporting is set by enabling validation layers.
+		 */
+		VkDebugReportCallbackEXT _callback;
+	};
 
-		// Returns the 0-based pixel coordinates given the component index of an image data array. Assumes that the
-		// input component index starts from 0, and that the origin of the image is at the top left corner, with X
-		// increasing to the right, and Y increasing downward.
-		glm::vec2 ComponentIndexToCartesian(int componentIndex, int imageWidthPixels) {
-			int x = (int(componentIndex * 0.25f) % imageWidthPixels);
-			int y = (int(componentIndex * 0.25f) / imageWidthPixels);
-			return glm::vec2(x, y);
+	/**
+	 * @brief All the information the engine needs to render the images sent to the window.
+	 */
+	struct VkRenderContext {
+		/**
+		 * @brief The images to which Nuklear renders its UI.
+		 */
+		std::vector<Image> _overlayImages;
+		nk_context* _uiCtx;
+		std::vector<VkCommandBuffer> _drawCommandBuffers;
+		Swapchain _swapchain{};
+		Pipeline _envMapPipeline{};
+		Pipeline _scenePipeline{};
+
+		/**
+		 * @brief Same as _scenePipeline, but reads per object data from a storage buffer indexed by the instance index. Only created when GPU-driven rendering is enabled.
+		 */
+		Pipeline _gpuDrivenScenePipeline{};
+
+		/**
+		 * @brief Number of textures in the material table the scene pipelines are created for, or 0 if materials are bound per mesh.
+		 */
+		uint32_t _bindlessTextureCount = 0;
+		Pipeline _uiPipeline{};
+		RenderPass _renderPass{};
+		GLFWwindow* _pWindow;
+		/**
+		 * @brief Semaphore that will be used by Vulkan to signal when an image has finished
+		 * rendering and is available to be rendered to in one of the framebuffers.
+		 */
+		VkSemaphore _imageAvailableSemaphore;
+		VkSemaphore	_renderingFinishedSemaphore;
+	};
+
+	/**
+	 * @brief Used by implementing classes to mark themselves as a class that is meant to do work on each iteration of the main loop.
+	 */
+	class IVulkanUpdatable {
+	public:
+
+		/**
+		 * @brief Function called on implementing classes in each iteration of the main loop. The main loop is defined in VulkanApplication.cpp.
+		 */
+		virtual void Update(VkContext& context) = 0;
+	};
+
+	/**
+	 * @brief Unique textures of a scene, keyed by the hash of their content. Materials using the same texture share one GPU image, which is sent to the GPU
+	 * once when it is added. Textures are not reference counted: the scene is never unloaded, so they live as long as it does, and their images are
+	 * listed by ResourceTracker at shutdown.
+	 */
+	class TextureRegistry {
+	public:
+
+		struct Entry {
+			uint64_t _key;
+			Image _image;
+		};
+
+		std::vector<Entry> _entries;
+
+		/**
+		 * @brief Returns the index of the texture with key. If there is none yet, create is called to make its image, which is then uploaded and
+		 * left ready to be sampled.
+		 */
+		uint32_t FindOrAdd(VkContext& ctx, uint64_t key, const std::function<Image()>& create) {
+			auto found = _indicesByKey.find(key);
+			if (found != _indicesByKey.end()) return found->second;
+
+			Entry entry{ key, create() };
+			Upload(ctx, entry._image);
+			_entries.push_back(entry);
+			return _indicesByKey[key] = (uint32_t)(_entries.size() - 1);
 		}
 
-		// Returns the 0-based component index into an image data array given the pixel coordinates of the image.
-		// Assumes that X and Y both start from 0, at the top left corner of the image, and the maximum X can be is equal to imageWidthPixels-1.
-		int CartesianToComponentIndex(int x, int y, int imageWidthPixels) {
-			return (x + (y * imageWidthPixels)) * 4;
+		/**
+		 * @brief Replaces the image of the texture at index, e.g. when a streamed texture replaces its placeholder. Returns the image that was replaced,
+		 * which the caller is now responsible for destroying.
+		 */
+		Image Replace(uint32_t index, const Image& image) {
+			auto replaced = _entries[index]._image;
+			_entries[index]._image = image;
+			return replaced;
 		}
 
-		// Blurs an image by averaging the value of each pixel with the value of "samples" pixels at distance of "radiusPixels" pixels in a 
-		// circular pattern around it. Returns the blurred image data.
-		std::vector<unsigned char> BoxBlurImage(const std::vector<unsigned char>& inImageData, int widthPixels, int heightPixels, int radiusPixels) {
-			// Make sure that the input values are valid.
-			if (radiusPixels < 1) {
-				radiusPixels = 1;
-			}
-			if (inImageData.data() == nullptr || inImageData.size() <= 0) {
-				return std::vector<unsigned char>();
-			}
+		/**
+		 * @brief Copies the CPU data of image to its GPU image and transitions it to be sampled by fragment shaders.
+		 */
+		static void Upload(VkContext& ctx, Image& image) {
+			auto& extent = image._createInfo.extent;
+			CopyImageToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, image._image, extent.width, extent.height, extent.depth, image._pData, image._sizeBytes);
+			VkHelper::TransitionImageLayout(ctx._logicalDevice, ctx._commandPool, ctx._queue, image._image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			image._currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
 
-			// Prepare some variables used throughout the function.
-			std::vector<unsigned char> outImageData;
-			int boxSideLength = (radiusPixels * 2) + 1;
-			outImageData.resize(inImageData.size());
+	private:
 
-			for (int componentIndex = 0; componentIndex < inImageData.size(); componentIndex += 4) {
-				auto currentPixelCoordinates = ComponentIndexToCartesian(componentIndex, widthPixels);
+		std::map<uint64_t, uint32_t> _indicesByKey;
+	};
 
-				// Start sampling from the top left relative to the current pixel. Coordinates increase going left to right for X
-				// and top to bottom for Y.
-				int sampleCoordinateY = int(currentPixelCoordinates.y - radiusPixels);
-				glm::vec4 averageColor(-1.0f);
-				for (int i = 0; i < boxSideLength; ++i) {
-					int sampleCoordinateX = int(currentPixelCoordinates.x - radiusPixels);
-					for (int j = 0; j < boxSideLength; ++j) {
+	/**
+	 * @brief Represents a scene-level PBR material.
+	 */
+	class Material {
 
-						// Only sample if the coordinates fall within the range of the image.
-						if (auto sampleIndex = CartesianToComponentIndex(sampleCoordinateX, sampleCoordinateY, widthPixels); sampleIndex >= 0 && sampleIndex < inImageData.size()) {
-							glm::vec4 sampledColor = glm::vec4(inImageData[sampleIndex], inImageData[sampleIndex + 1], inImageData[sampleIndex + 2], inImageData[sampleIndex + 3]);
+	public:
 
-							// Only calculate the average if averageColor is initialized, otherwise just use the average color as is, to account for
-							// the first time this line of code is reached.
-							averageColor = averageColor.x < 0 ? sampledColor : (averageColor + sampledColor);
-						}
-						++sampleCoordinateX;
-					}
-					++sampleCoordinateY;
-				}
+		/**
+		 * @brief Identifier for debug purposes.
+		 */
+		std::string _name;
 
-				// Calculate the average.
-				averageColor /= (boxSideLength * boxSideLength);
+		/**
+		 * @brief Maps a material can have. Occlusion, roughness and metalness are packed in the R, G and B channels of a single map,
+		 * so that the fragment shader fetches all three at once.
+		 */
+		enum MapType : uint32_t {
+			Albedo,
+			OcclusionRoughnessMetalness,
+			Normal,
+			Emissive,
+			MapTypeCount
+		};
 
-				// Assign the calculated average color.
-				outImageData[componentIndex] = int(averageColor.r);
-				outImageData[componentIndex + 1] = int(averageColor.g);
-				outImageData[componentIndex + 2] = int(averageColor.b);
-				outImageData[componentIndex + 3] = int(averageColor.a);
-			}
+		/**
+		 * @brief Texture data of each map, indexed by MapType. Maps without an image fall back to the ones of the default material.
+		 */
+		Image _maps[MapTypeCount];
 
-			return outImageData;
-		}
+		/**
+		 * @brief Index of each map in the texture registry of the scene, or -1 if the map is not registered.
+		 */
+		int32_t _textureIndices[MapTypeCount] = { -1, -1, -1, -1 };
 
-		std::vector<unsigned char> GenerateFaceImage(CubeMapFace face, int mipIndex, int width, int height) {
-			// The world space unit vector that points in the positive X direction of the image (must be left to right), as if the image was placed in the 3D world on a square plane.
-			glm::vec3 imageXWorldSpace;
+		/**
+		 * @brief Bits the vertex shaders forward to the fragment shaders. Must match the MATERIAL_ constants in FragmentShader.frag and BindlessFragmentShader.frag.
+		 */
+		enum Flags : uint32_t {
+			HasNormalMap = 1
+		};
 
-			// The world space unit vector that points in the positive Y direction of the image (must be bottom to top), as if the image was placed in the 3D world on a square plane.
-			glm::vec3 imageYWorldSpace;
+		/**
+		 * @brief Material descriptor set (set 3) of the scene pipeline, shared by every mesh using the material. Created by the first of them.
+		 */
+		VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
 
-			// The origin of the image (must be the bottom left corner) in world space, as if the image was placed in the 3D world on a square plane.
-			glm::vec3 imageOriginWorldSpace;
+		/**
+		 * @brief Default constructor.
+		 */
+		Material() = default;
 
-			auto sizePixels = _faceSizePixels;
-			for (int i = 0; i < mipIndex; ++i) {
-				sizePixels /= 2;
-			}
+		Material(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice) {
+			_name = "DefaultMaterial";
 
-			std::vector<unsigned char> outImage;
-			outImage.resize(sizePixels * sizePixels * 4);
+			_maps[Albedo] = Image::SolidColor(logicalDevice, physicalDevice, 255, 0, 255, 255, GetFormat(Albedo));
+			_maps[OcclusionRoughnessMetalness] = Image::SolidColor(logicalDevice, physicalDevice, 255, 125, 125, 255, GetFormat(OcclusionRoughnessMetalness));
+			_maps[Normal] = Image::SolidColor(logicalDevice, physicalDevice, 128, 128, 255, 255, GetFormat(Normal));
+			_maps[Emissive] = Image::SolidColor(logicalDevice, physicalDevice, 0, 0, 0, 255, GetFormat(Emissive));
+		}
 
-			switch (face) {
-			case CubeMapFace::FRONT:
-				imageXWorldSpace = glm::vec3(1.0f, 0.0f, 0.0f);
-				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
-				imageOriginWorldSpace = glm::vec3(-0.5f, 0.5f, 0.5f);
-				break;
-			case CubeMapFace::RIGHT:
-				imageXWorldSpace = glm::vec3(0.0f, 0.0f, -1.0f);
-				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
-				imageOriginWorldSpace = glm::vec3(0.5f, 0.5f, 0.5f);
-				break;
-			case CubeMapFace::BACK:
-				imageXWorldSpace = glm::vec3(-1.0f, 0.0f, 0.0f);
-				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
-				imageOriginWorldSpace = glm::vec3(0.5f, 0.5f, -0.5f);
-				break;
-			case CubeMapFace::LEFT:
-				imageXWorldSpace = glm::vec3(0.0f, 0.0f, 1.0f);
-				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
-				imageOriginWorldSpace = glm::vec3(-0.5f, 0.5f, -0.5f);
-				break;
-			case CubeMapFace::UPPER:
-				imageXWorldSpace = glm::vec3(1.0f, 0.0f, 0.0f);
-				imageYWorldSpace = glm::vec3(0.0f, 0.0f, -1.0f);
-				imageOriginWorldSpace = glm::vec3(-0.5f, 0.5f, -0.5f);
-				break;
-			case CubeMapFace::LOWER:
-				imageXWorldSpace = glm::vec3(1.0f, 0.0f, 0.0f);
-				imageYWorldSpace = glm::vec3(0.0f, 0.0f, 1.0f);
-				imageOriginWorldSpace = glm::vec3(-0.5f, -0.5f, 0.5f);
-				break;
-			}
+		/**
+		 * @brief Albedo and emissive maps hold colors and are sRGB encoded, the other maps hold linear data.
+		 */
+		static VkFormat GetFormat(MapType type) {
+			return type == Albedo || type == Emissive ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		}
 
-			for (auto y = 0; y < sizePixels; ++y) {
-				for (auto x = 0; x < sizePixels; ++x) {
+		/**
+		 * @brief Flags of the material. Materials without a normal map sample the flat placeholder of the default material, so the fragment shaders
+		 * skip perturbing their normals.
+		 */
+		uint32_t GetFlags() const {
+			return _textureIndices[Normal] >= 0 ? HasNormalMap : 0;
+		}
 
-					// First we calculate the cartesian coordinate of the pixel of the cube map's face we are considering, in world space.
-					glm::vec3 cartesianCoordinatesOnFace;
-					cartesianCoordinatesOnFace = imageOriginWorldSpace + (imageXWorldSpace * ((1.0f / sizePixels) * x));
-					cartesianCoordinatesOnFace += -imageYWorldSpace * ((1.0f / sizePixels) * y);
+		/**
+		 * @brief Returns the maps to sample, in MapType order. Maps the material does not have are taken from defaultMaterial.
+		 */
+		std::vector<Image> GetMaps(const Material& defaultMaterial) const {
+			std::vector<Image> maps(MapTypeCount);
+			for (uint32_t i = 0; i < MapTypeCount; ++i) maps[i] = _maps[i]._image != VK_NULL_HANDLE ? _maps[i] : defaultMaterial._maps[i];
+			return maps;
+		}
 
-					// Then we get the cartesian coordinates on the sphere from the cartesian coordinates on the face. You can
-					// imagine a cube that contains a sphere of exactly the same radius. Only the sphere's poles and sides will
-					// touch each cube's face exactly at the center. We take advantage of the fact that the radius of the sphere
-					// is constant (always equal to 1 for simplicity in our case) so all we need to do is normalize the coordinates
-					// on the face and we get the cartesian coordinates on the sphere. This kind of simulates shooting a ray from
-					// the current pixel on the cube towards the center of the sphere, intersecting it with the sphere, and taking 
-					// the coordinates of the intersection point.
-					auto cartesianCoordinatesOnSphere = glm::normalize(cartesianCoordinatesOnFace);
+		/**
+		 * @brief Creates _descriptorSet with the maps given by GetMaps, one per binding. The maps must already be on the GPU, ready to be sampled.
+		 */
+		void CreateDescriptorSet(VkContext& ctx, VkDescriptorSetLayout layout, const Material& defaultMaterial) {
+			auto maps = GetMaps(defaultMaterial);
+			_descriptorSet = ctx._descriptorAllocator.Allocate(ctx._logicalDevice, layout);
 
-					float localXAngleDegrees = 0.0f;
-					float localYAngleDegrees = 0.0f;
-					float azimuthDegrees = 0.0f;
-					float zenithDegrees = 0.0f;
+			VkDescriptorImageInfo imageInfo[MapTypeCount];
+			for (uint32_t i = 0; i < MapTypeCount; ++i) imageInfo[i] = { maps[i]._sampler, maps[i]._view, maps[i]._currentLayout };
+			VkWriteDescriptorSet writeInfo = {};
+			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfo.dstSet = _descriptorSet;
+			writeInfo.descriptorCount = MapTypeCount;
+			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writeInfo.pImageInfo = imageInfo;
+			writeInfo.dstBinding = 0;
+			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+		}
 
-					// Then we calculate the spherical coordinates by using some trig.
-					// Depending on the coordinate, the angles could either be negative or positive, according to the left hand rule.
-					// This engine uses a left-handed coordinate system.
-					switch (face) {
-					case CubeMapFace::FRONT:
+		/**
+		 * @brief Points the binding of the given map in _descriptorSet to image, if the descriptor set has been created.
+		 */
+		void UpdateDescriptorSet(VkContext& ctx, MapType type, const Image& image) {
+			if (_descriptorSet == VK_NULL_HANDLE) return;
+
+			VkDescriptorImageInfo imageInfo{ image._sampler, image._view, image._currentLayout };
+			VkWriteDescriptorSet writeInfo = {};
+			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfo.dstSet = _descriptorSet;
+			writeInfo.dstBinding = type;
+			writeInfo.dstArrayElement = 0;
+			writeInfo.descriptorCount = 1;
+			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writeInfo.pImageInfo = &imageInfo;
+			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+		}
+	};
+
+	/**
+	  * @brief Represents vertex attributes, such as positions, normals and UV coordinates.
+	  */
+	class Vertex {
+	public:
+
+		/**
+		 * @brief Attribute describing the object-space position of the vertex in the engine's coordinate system (X right, Y up, Z forward).
+		 */
+		glm::vec3 _position;
+
+		/**
+		 * @brief Attribute describing the object-space normal vector of the vertex in the engine's coordinate system (X right, Y up, Z forward).
+		 */
+		glm::vec3 _normal;
+
+		/**
+		 * @brief Attribute describing the UV coordinates of the vertex in the UV coordinate system, where the origin (U = 0, V = 0) is the bottom left of the 2D space.
+		 */
+		glm::vec2 _uvCoord;
+	};
+
+	void VertexLayout::GetPositionDequantization(const Vertex* pVertices, size_t vertexCount, glm::vec4& outOffset, glm::vec4& outScale) const {
+		outOffset = glm::vec4(0.0f);
+		outScale = glm::vec4(1.0f);
+		if (_positionFormat != PositionFormat::Snorm16 || vertexCount == 0) return;
+
+		auto min = pVertices[0]._position;
+		auto max = min;
+		for (size_t i = 1; i < vertexCount; ++i) {
+			min = glm::min(min, pVertices[i]._position);
+			max = glm::max(max, pVertices[i]._position);
+		}
+		outOffset = glm::vec4((min + max) * 0.5f, 0.0f);
+		outScale = glm::vec4((max - min) * 0.5f, 0.0f);
+	}
+
+	void VertexLayout::Encode(const Vertex* pVertices, size_t vertexCount, const glm::vec4& offset, const glm::vec4& scale, unsigned char* pOut) const {
+		auto stride = GetStride();
+		auto normalOffset = GetPositionSizeBytes();
+		auto uvOffset = normalOffset + GetNormalSizeBytes();
+
+		// Axes along which the bounding box is flat are stored as 0, which decodes to the offset.
+		auto inverseScale = glm::vec3(scale.x > 0.0f ? 1.0f / scale.x : 0.0f, scale.y > 0.0f ? 1.0f / scale.y : 0.0f, scale.z > 0.0f ? 1.0f / scale.z : 0.0f);
+
+		for (size_t i = 0; i < vertexCount; ++i) {
+			auto& vertex = pVertices[i];
+			auto pVertex = pOut + i * stride;
+
+			if (_positionFormat == PositionFormat::Float32) {
+				memcpy(pVertex, &vertex._position, sizeof(float) * 3);
+			}
+			else {
+				uint16_t position[4] = {};
+				auto relative = (vertex._position - glm::vec3(offset)) * inverseScale;
+				for (int k = 0; k < 3; ++k) {
+					position[k] = _positionFormat == PositionFormat::Half ? glm::packHalf1x16(vertex._position[k]) : glm::packSnorm1x16(relative[k]);
+				}
+				memcpy(pVertex, position, sizeof(position));
+			}
+
+			if (_normalFormat == NormalFormat::Float32) {
+				memcpy(pVertex + normalOffset, &vertex._normal, sizeof(float) * 3);
+			}
+			else {
+				// Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the upper half's diagonals.
+				auto normal = vertex._normal;
+				auto l1Norm = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+				auto octahedral = l1Norm > 0.0f ? glm::vec2(normal.x, normal.y) / l1Norm : glm::vec2(0.0f);
+				if (normal.z < 0.0f) {
+					auto folded = glm::vec2(1.0f - fabsf(octahedral.y), 1.0f - fabsf(octahedral.x));
+					octahedral.x = octahedral.x >= 0.0f ? folded.x : -folded.x;
+					octahedral.y = octahedral.y >= 0.0f ? folded.y : -folded.y;
+				}
+				uint16_t encodedNormal[2] = { glm::packSnorm1x16(octahedral.x), glm::packSnorm1x16(octahedral.y) };
+				memcpy(pVertex + normalOffset, encodedNormal, sizeof(encodedNormal));
+			}
+
+			if (_uvFormat == UvFormat::Float32) {
+				memcpy(pVertex + uvOffset, &vertex._uvCoord, sizeof(float) * 2);
+			}
+			else {
+				uint16_t uv[2] = { glm::packHalf1x16(vertex._uvCoord.x), glm::packHalf1x16(vertex._uvCoord.y) };
+				memcpy(pVertex + uvOffset, uv, sizeof(uv));
+			}
+		}
+	}
+
+	/**
+	 * @brief Used by deriving classes to be able to bind shader resources (descriptor sets and push constants) to GPU-visible memory, to then be used by a pipeline.
+	 * Information can be sent from application (run by the CPU) accessible memory to shader (run by the GPU) accessible memory, in order for it to be used in
+	 * certain ways in the shader programs. This data structure encapsulates all Vulkan calls needed to enable that. There are 2 ways that data can be sent to
+	 * the shaders: using push constants, or using descriptors.
+	 * The most common and flexible way is using descriptors, but push constant are fastest.
+	 */
+	class IPipelineable {
+
+	public:
+
+		/**
+		 * @brief Buffers to be used in descriptors for shader resources.
+		 */
+		std::vector<Buffer> _buffers;
+
+		/**
+		 * @brief Images to be used in descriptors for shader resources.
+		 */
+		std::vector<Image> _images;
+
+		/**
+		 * @brief See ShaderResources.
+		 */
+		ShaderResources _shaderResources;
+
+		/**
+		 * @brief Function that is meant for deriving classes to create shader resources and send them to GPU-visible memory (could be either RAM or VRAM).
+		 * Shader resources can either be push constants or descriptors. See ShaderResources.cpp.
+		 * @param physicalDevice Intended to be used to gather GPU information when allocating buffers or images.
+		 * @param logicalDevice Intended to be used for binding created buffers, images, descriptors, descriptor sets etc. to the GPU.
+		 */
+		virtual ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) = 0;
+
+		/**
+		 * @brief Function that is meant for deriving classes to update the shader resources that have been created with CreateDescriptorSets.
+		 */
+		virtual void UpdateShaderResources() = 0;
+	};
+
+	/**
+	 * @brief Used by deriving classes to mark themselves as a class that is meant to bind drawing resources (vertex buffers, index buffer)
+	 * to a graphics pipeline and send draw commands to the Vulkan API.
+	 */
+	class IDrawable {
+
+	public:
+
+		/**
+		 * @brief Wrapper that contains a GPU-only buffer that contains vertices for drawing operations, and the vertex information.
+		 */
+		struct {
+			/**
+			 * @brief List of vertices that make up the drawable object.
+			 */
+			std::vector<Vertex> _vertexData;
+
+			/**
+			 * @brief Maps positions read from _vertexBuffer back to object space: position = _positionOffset + stored position * _positionScale.
+			 * See VertexLayout::GetPositionDequantization.
+			 */
+			glm::vec4 _positionOffset = glm::vec4(0.0f);
+			glm::vec4 _positionScale = glm::vec4(1.0f);
+
+			/**
+			 * @brief Buffer that stores vertex attributes. A vertex attribute is a piece of data
+			 * that decorates the vertex with more information, so that the vertex shader can
+			 * do more work based on it. For example a vertex attribute could be a position or a normal vector.
+			 * Based on the normal vector, the vertex shader can perform lighting calculations by computing
+			 * the angle between the source of the light and the normal.
+			 * At the hardware level, the contents of the vertex buffer are fed into the array of shader cores,
+			 * and each vertex, along with its attributes, are processed in parallel by multiple instances of the
+			 * vertex shader on each thread of the cores.
+			 * This buffer is intended to contain _vertexData to be bound to the graphics pipeline just before
+			 * drawing the mesh in a render pass.
+			 */
+			Buffer _vertexBuffer;
+
+		} _vertices;
+
+		/**
+		 * @brief Wrapper that contains a GPU-only buffer that contains face indices for drawing operations, and the face indices' information.
+		 */
+		struct {
+			/**
+			 * @brief List of indices, where each index corresponds to a vertex defined in the _vertices array above.
+			 * A face (triangle) is defined by three consecutive indices in this array.
+			 */
+			std::vector<unsigned int> _indexData;
+
+			/**
+			 * @brief Type of the indices in _indexBuffer. 16 bit when every index fits, since it halves the memory read when assembling faces.
+			 */
+			VkIndexType _indexType = VK_INDEX_TYPE_UINT32;
+
+			/**
+			 * @brief This buffer is used by Vulkan when drawing using the vkCmdDrawIndexed command; it gives Vulkan
+			 * information about the order in which to draw vertices, and is intended to contain _indexData to be bound
+			 * to the graphics pipeline just before drawing the mesh in a render pass.
+			 */
+			Buffer _indexBuffer;
+
+		} _faceIndices;
+
+		void CreateVertexBuffer(VkContext& ctx, const std::vector<Vertex>& vertices) {
+			CreateVertexBuffer(ctx, vertices.data(), vertices.size());
+		}
+
+		/**
+		 * @brief Creates the vertex buffer from vertexCount vertices starting at pVertices, stored in the vertex layout of the global settings.
+		 * pVertices can point into a mapped file.
+		 */
+		void CreateVertexBuffer(VkContext& ctx, const Vertex* pVertices, size_t vertexCount) {
+			SetVertices(pVertices, vertexCount);
+			std::vector<unsigned char> encodedVertices(GetEncodedVerticesSize());
+			EncodeVertices(encodedVertices.data());
+			CreateEncodedVertexBuffer(ctx, encodedVertices);
+		}
+
+		/**
+		 * @brief Creates the vertex buffer from vertices already stored in the vertex layout of the global settings.
+		 */
+		void CreateEncodedVertexBuffer(VkContext& ctx, const std::vector<unsigned char>& encodedVertices) {
+			AllocateVertexBuffer(ctx, encodedVertices.size());
+			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, _vertices._vertexBuffer._buffer, (void*)encodedVertices.data(), encodedVertices.size());
+		}
+
+		/**
+		 * @brief Keeps a CPU copy of vertexCount vertices starting at pVertices and computes how their positions are quantized, without touching the GPU.
+		 * Used with EncodeVertices and AllocateVertexBuffer when the upload happens elsewhere, e.g. in the AssetStreamer.
+		 */
+		void SetVertices(const Vertex* pVertices, size_t vertexCount) {
+			_vertices._vertexData.assign(pVertices, pVertices + vertexCount);
+			GlobalSettings::Instance()._vertexLayout.GetPositionDequantization(pVertices, vertexCount, _vertices._positionOffset, _vertices._positionScale);
+		}
+
+		/**
+		 * @brief Size in bytes of the vertices set with SetVertices, once stored in the vertex layout of the global settings.
+		 */
+		size_t GetEncodedVerticesSize() {
+			return _vertices._vertexData.size() * GlobalSettings::Instance()._vertexLayout.GetStride();
+		}
+
+		/**
+		 * @brief Writes GetEncodedVerticesSize bytes of vertices, stored in the vertex layout of the global settings, to pOut. Does not touch the
+		 * GPU, so it can run on any thread.
+		 */
+		void EncodeVertices(unsigned char* pOut) {
+			auto& layout = GlobalSettings::Instance()._vertexLayout;
+			layout.Encode(_vertices._vertexData.data(), _vertices._vertexData.size(), _vertices._positionOffset, _vertices._positionScale, pOut);
+		}
+
+		/**
+		 * @brief Creates a device local vertex buffer of sizeBytes bytes, to be filled by a transfer.
+		 */
+		void AllocateVertexBuffer(VkContext& ctx, size_t sizeBytes) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Mesh);
+			auto& buffer = _vertices._vertexBuffer;
+			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			buffer._createInfo.size = sizeBytes;
+			buffer._createInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			ResourceTracker::CreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+
+			// Allocate memory for the buffer. Vertices never change after being uploaded, so the buffer does not need to be host visible.
+			VkMemoryRequirements requirements{};
+			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
+			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+
+			buffer._pData = (void*)_vertices._vertexData.data();
+			buffer._sizeBytes = sizeBytes;
+		}
+
+		void CreateIndexBuffer(VkContext& ctx, const std::vector<unsigned int>& indices) {
+			CreateIndexBuffer(ctx, indices.data(), indices.size());
+		}
+
+		/**
+		 * @brief Creates the index buffer from indexCount indices starting at pIndices. Indices are stored as 16 bit integers when they all fit.
+		 */
+		void CreateIndexBuffer(VkContext& ctx, const unsigned int* pIndices, size_t indexCount) {
+			SetFaceIndices(pIndices, indexCount);
+			std::vector<unsigned char> encodedIndices(GetEncodedIndicesSize());
+			EncodeIndices(encodedIndices.data());
+			AllocateIndexBuffer(ctx, encodedIndices.size());
+			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, _faceIndices._indexBuffer._buffer, (void*)encodedIndices.data(), encodedIndices.size());
+		}
+
+		/**
+		 * @brief Keeps a CPU copy of indexCount indices starting at pIndices and picks the index type, without touching the GPU.
+		 */
+		void SetFaceIndices(const unsigned int* pIndices, size_t indexCount) {
+			_faceIndices._indexData.assign(pIndices, pIndices + indexCount);
+			auto maxIndex = indexCount > 0 ? *std::max_element(pIndices, pIndices + indexCount) : 0u;
+			_faceIndices._indexType = maxIndex <= UINT16_MAX ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		}
+
+		/**
+		 * @brief Size in bytes of the indices set with SetFaceIndices, once stored as _indexType.
+		 */
+		size_t GetEncodedIndicesSize() {
+			return _faceIndices._indexData.size() * (_faceIndices._indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(unsigned int));
+		}
+
+		/**
+		 * @brief Writes indexCount indices starting at firstIndex, all of them by default, stored as _indexType to pOut. Can run on any thread.
+		 */
+		void EncodeIndices(unsigned char* pOut, size_t firstIndex = 0, size_t indexCount = SIZE_MAX) {
+			auto pIndices = _faceIndices._indexData.data() + firstIndex;
+			indexCount = std::min(indexCount, _faceIndices._indexData.size() - firstIndex);
+			if (_faceIndices._indexType == VK_INDEX_TYPE_UINT32) {
+				memcpy(pOut, pIndices, indexCount * sizeof(unsigned int));
+				return;
+			}
+			auto pShortIndices = (uint16_t*)pOut;
+			for (size_t i = 0; i < indexCount; ++i) pShortIndices[i] = (uint16_t)pIndices[i];
+		}
+
+		/**
+		 * @brief Creates a device local index buffer of sizeBytes bytes, to be filled by a transfer.
+		 */
+		void AllocateIndexBuffer(VkContext& ctx, size_t sizeBytes) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Mesh);
+			auto& buffer = _faceIndices._indexBuffer;
+			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			buffer._createInfo.size = sizeBytes;
+			buffer._createInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			ResourceTracker::CreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+
+			VkMemoryRequirements requirements{};
+			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
+			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+
+			buffer._pData = (void*)_faceIndices._indexData.data();
+			buffer._sizeBytes = sizeBytes;
+		}
+
+		/**
+		 * @brief Deriving classes should implement this method to bind their vertex and index buffers to a graphics pipeline and draw them via Vulkan draw calls.
+		 */
+		virtual void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) = 0;
+	};
+
+	/**
+	 * @brief Represents an infinitesimally small light source.
+	 */
+	class PointLight : public IVulkanUpdatable, public IPipelineable {
+	public:
+
+		/**
+		 * @brief Name of the light.
+		 */
+		std::string _name;
+
+		/**
+		 * @brief .
+		 */
+		Transform _transform;
+
+		/**
+		 * @brief Data to be sent to the shaders.
+		 */
+		struct {
+			glm::vec3 position;
+			glm::vec4 colorIntensity;
+		} _lightData;
+
+		/**
+		 * @brief X, Y, Z represent red, blue and green for light color, while the W component represents
+		 * light intensity.
+		 */
+		glm::vec4 _colorIntensity;
+
+		/**
+		 * @brief Default constructor.
+		 */
+		PointLight() = default;
+
+		PointLight(std::string name) {
+			_name = name;
+			_transform.SetPosition(glm::vec3(3.0f, 10.0f, -10.0f));
+		}
+
+		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Uniform);
+			auto descriptorSetID = 2;
+
+			// Create a temporary buffer.
+			Buffer buffer{};
+			auto bufferSizeBytes = sizeof(_lightData);
+			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			buffer._createInfo.size = bufferSizeBytes;
+			buffer._createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+			ResourceTracker::CreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+
+			// Allocate memory for the buffer.
+			VkMemoryRequirements requirements{};
+			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
+			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+			// Map memory to the correct GPU and CPU ranges for the buffer.
+			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
+			memcpy(buffer._cpuMemory, &_lightData, bufferSizeBytes);
+
+			_buffers.push_back(buffer);
+
+			VkDescriptorSet descriptorSet = ctx._descriptorAllocator.Allocate(ctx._logicalDevice, layouts[descriptorSetID]._layout);
+
+			// Update the descriptor set's data.
+			VkDescriptorBufferInfo bufferInfo{ buffer._buffer, 0, buffer._createInfo.size };
+			VkWriteDescriptorSet writeInfo = {};
+			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfo.dstSet = descriptorSet;
+			writeInfo.descriptorCount = 1;
+			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			writeInfo.pBufferInfo = &bufferInfo;
+			writeInfo.dstBinding = 0;
+			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+
+			auto descriptorSets = std::vector<VkDescriptorSet>{ descriptorSet };
+			_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
+			return _shaderResources;
+		}
+
+		void UpdateShaderResources() {
+			_lightData.position = _transform.Position();
+			_lightData.colorIntensity = glm::vec4(1.0f, 1.0f, 1.0f, 15000.0f);
+			memcpy(_buffers[0]._cpuMemory, &_lightData, sizeof(_lightData));
+		}
+
+		void Update(VkContext& vkContext) {
+			auto& input = KeyboardMouse::Instance();
+
+			if (input.IsKeyHeldDown(GLFW_KEY_UP)) {
+				_transform.Translate(_transform.Forward() * 1.5f);
+			}
+
+			if (input.IsKeyHeldDown(GLFW_KEY_DOWN)) {
+				_transform.Translate(_transform.Forward() * -1.5f);
+			}
+
+			if (input.IsKeyHeldDown(GLFW_KEY_LEFT)) {
+				_transform.Translate(_transform.Right() * -1.5f);
+			}
+
+			if (input.IsKeyHeldDown(GLFW_KEY_RIGHT)) {
+				_transform.Translate(_transform.Right() * 1.5f);
+			}
+
+			auto pos = _transform.Position();
+			UpdateShaderResources();
+		}
+	};
+
+
+	// All the data that this boxblur application needs to do its thing.
+	class BoxBlur {
+
+	private:
+		// Input image size.
+		unsigned int _imageWidthPixels;
+		unsigned int _imageHeightPixels;
+		unsigned int _radiusPixels = 60;
+		unsigned char* _loadedImage;
+		VkPhysicalDevice _physicalDevice; // A handle for the graphics card used in the application.
+
+		uint32_t _workGroupCount[3]; // Size of the 3D lattice of workgroups.
+		uint32_t _workGroupSize[3];  // Size of the 3D lattice of threads in each workgroup.
+		uint32_t _coalescedMemory;
+
+		// Bridging information, that allows shaders to freely access resources like buffers and images.
+		VkDescriptorPool _descriptorPool;
+		VkDescriptorSetLayout _descriptorSetLayout;
+		VkDescriptorSet _descriptorSet;
+
+		// Pipeline handles.
+		VkPipelineLayout _pipelineLayout;
+		VkPipeline _pipeline;
+
+		// Input and output buffers.
+		uint32_t _inputBufferCount;
+		VkBuffer _inputBuffer;
+		VkDeviceMemory _inputBufferDeviceMemory;
+		uint32_t _outputBufferCount;
+		VkBuffer _outputBuffer;
+		VkDeviceMemory _outputBufferDeviceMemory;
+
+		// Vulkan dependencies
+		VkInstance _instance;                                                // A connection between the application and the Vulkan library .
+		VkDevice _device;                                                    // A logical device, interacting with the physical device.
+		VkPhysicalDeviceProperties _physicalDeviceProperties;                // Basic device properties.
+		VkPhysicalDeviceMemoryProperties _physicalDeviceMemoryProperties;    // Basic memory properties of the device.
+		VkDebugUtilsMessengerEXT _debugMessenger;                            // Extension for debugging.
+		uint32_t _queueFamilyIndex;                                          // If multiple queues are available, specify the used one.
+		VkQueue _queue;                                                      // A place, where all operations are submitted.
+		VkCommandPool _commandPool;                                          // An opaque object that command buffer memory is allocated from.
+		VkFence _fence;                                                      // A fence used to synchronize dispatches.
+
+		static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
+			Logger::Warning("validation layer: {}", pCallbackData->pMessage);
+			return VK_FALSE;
+		}
+
+		VkResult SetupDebugUtilsMessenger() {
+			VkDebugUtilsMessengerCreateInfoEXT
+				debugUtilsMessengerCreateInfo = { VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
+					0,
+					(VkDebugUtilsMessengerCreateFlagsEXT)0,
+					(VkDebugUtilsMessageSeverityFlagsEXT)VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
+					(VkDebugUtilsMessageTypeFlagsEXT)VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
+					(PFN_vkDebugUtilsMessengerCallbackEXT)debugCallback,
+					(void*)NULL };
+
+			PFN_vkCreateDebugUtilsMessengerEXT func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(_instance, "vkCreateDebugUtilsMessengerEXT");
+
+			if (func != NULL) {
+				if (func(_instance, &debugUtilsMessengerCreateInfo, NULL, &_debugMessenger) != VK_SUCCESS) {
+					return VK_ERROR_INITIALIZATION_FAILED;
+				}
+			}
+			else {
+				return VK_ERROR_EXTENSION_NOT_PRESENT;
+			}
+
+			return VK_SUCCESS;
+		}
+
+		void DestroyDebugUtilsMessengerEXT(VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator) {
+			//pointer to the function, as it is not part of the core. Function destroys debugging messenger
+			PFN_vkDestroyDebugUtilsMessengerEXT func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(_instance, "vkDestroyDebugUtilsMessengerEXT");
+			if (func != NULL) {
+				func(_instance, debugMessenger, pAllocator);
+			}
+		}
+
+		VkResult CreateComputePipeline(VkBuffer* shaderBuffersArray, VkDeviceSize* arrayOfSizesOfEachBuffer, const char* shaderFilename) {
+			// Create an application interface to Vulkan. This function binds the shader to the compute pipeline, so it can be used as a part of the command buffer later.
+			VkResult res = VK_SUCCESS;
+			uint32_t descriptorCount = 2;
+
+			// We have two storage buffer objects in one set in one pool.
+			VkDescriptorPoolSize descriptorPoolSize = { (VkDescriptorType)VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+														   (uint32_t)descriptorCount };
+
+			const VkDescriptorType descriptorTypes[2] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+															  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+
+			VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+											   0,
+											   (VkDescriptorPoolCreateFlags)0,
+											   (uint32_t)1,
+											   (uint32_t)1,
+											   (const VkDescriptorPoolSize*)&descriptorPoolSize };
+
+			res = ResourceTracker::CreateDescriptorPool(_device, &descriptorPoolCreateInfo, NULL, &_descriptorPool);
+			if (res != VK_SUCCESS) return res;
+
+			// Specify each object from the set as a storage buffer.
+			VkDescriptorSetLayoutBinding* descriptorSetLayoutBindings =
+				(VkDescriptorSetLayoutBinding*)malloc(descriptorCount * sizeof(VkDescriptorSetLayoutBinding));
+			for (uint32_t i = 0; i < descriptorCount; ++i) {
+				descriptorSetLayoutBindings[i].binding = (uint32_t)i;
+				descriptorSetLayoutBindings[i].descriptorType = (VkDescriptorType)descriptorTypes[i];
+				descriptorSetLayoutBindings[i].descriptorCount = (uint32_t)1;
+				descriptorSetLayoutBindings[i].stageFlags = (VkShaderStageFlags)VK_SHADER_STAGE_COMPUTE_BIT;
+				descriptorSetLayoutBindings[i].pImmutableSamplers = (const VkSampler*)NULL;
+			}
+
+			VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+													0,
+													(VkDescriptorSetLayoutCreateFlags)0,
+													(uint32_t)descriptorCount,
+													(const VkDescriptorSetLayoutBinding*)descriptorSetLayoutBindings };
+			//create layout
+			res = vkCreateDescriptorSetLayout(_device, &descriptorSetLayoutCreateInfo, NULL, &_descriptorSetLayout);
+			if (res != VK_SUCCESS) return res;
+			free(descriptorSetLayoutBindings);
+
+			//provide the layout with actual buffers and their sizes
+			VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+												0,
+												(VkDescriptorPool)_descriptorPool,
+												(uint32_t)1,
+												(const VkDescriptorSetLayout*)&_descriptorSetLayout };
+			res = vkAllocateDescriptorSets(_device, &descriptorSetAllocateInfo, &_descriptorSet);
+			if (res != VK_SUCCESS) return res;
+
+			for (uint32_t i = 0; i < descriptorCount; ++i) {
+
+				VkDescriptorBufferInfo descriptorBufferInfo = { shaderBuffersArray[i],
+												 0,
+												 arrayOfSizesOfEachBuffer[i] };
+
+				VkWriteDescriptorSet writeDescriptorSet = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+												 0,
+												 (VkDescriptorSet)_descriptorSet,
+												 (uint32_t)i,
+												 (uint32_t)0,
+												 (uint32_t)1,
+												 (VkDescriptorType)descriptorTypes[i],
+												 0,
+												 (const VkDescriptorBufferInfo*)&descriptorBufferInfo,
+												 (const VkBufferView*)NULL };
+				vkUpdateDescriptorSets((VkDevice)_device,
+					(uint32_t)1,
+					(const VkWriteDescriptorSet*)&writeDescriptorSet,
+					(uint32_t)0,
+					(const VkCopyDescriptorSet*)NULL);
+			}
+
+			VkPushConstantRange range;
+			range.offset = 0;
+			range.size = sizeof(unsigned int) * 3;
+			range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+											   0,
+											   (VkPipelineLayoutCreateFlags)0,
+											   (uint32_t)1,
+											   (const VkDescriptorSetLayout*)&_descriptorSetLayout,
+											   (uint32_t)1,
+											   (const VkPushConstantRange*)&range };
+
+			//create pipeline layout
+			res = vkCreatePipelineLayout(_device, &pipelineLayoutCreateInfo, NULL, &_pipelineLayout);
+			if (res != VK_SUCCESS) return res;
+
+			// Define the specialization constant values
+			VkSpecializationMapEntry* specMapEntry = (VkSpecializationMapEntry*)malloc(sizeof(VkSpecializationMapEntry) * 3);
+			VkSpecializationMapEntry specConstant0 = { 0, 0, sizeof(uint32_t) };
+			VkSpecializationMapEntry specConstant1 = { 1, sizeof(uint32_t), sizeof(uint32_t) };
+			VkSpecializationMapEntry specConstant2 = { 2, sizeof(uint32_t) * 2, sizeof(uint32_t) };
+			specMapEntry[0] = specConstant0;
+			specMapEntry[1] = specConstant1;
+			specMapEntry[2] = specConstant2;
+			VkSpecializationInfo specializationInfo = { 3, specMapEntry, sizeof(uint32_t) * 3, _workGroupSize };
+
+			std::vector<char> fileBytes;
+			VkShaderModule shaderModule = nullptr;
+			if (FileIO::ReadAll(shaderFilename, fileBytes)) {
+				VkShaderModuleCreateInfo createInfo = {};
+				createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+				createInfo.codeSize = fileBytes.size();
+				createInfo.pCode = (uint32_t*)fileBytes.data();
+
+				if (vkCreateShaderModule(_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+					Logger::Error("failed to create shader module for {}", shaderFilename);
+				}
+			}
+			else {
+				Logger::Error("failed to open file {}", shaderFilename);
+			}
+
+			VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+													0,
+													(VkPipelineShaderStageCreateFlags)0,
+													(VkShaderStageFlagBits)VK_SHADER_STAGE_COMPUTE_BIT,
+													(VkShaderModule)shaderModule,
+													(const char*)"main",
+													(VkSpecializationInfo*)&specializationInfo };
+
+			VkComputePipelineCreateInfo computePipelineCreateInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+												0,
+												(VkPipelineCreateFlags)0,
+												pipelineShaderStageCreateInfo,
+												(VkPipelineLayout)_pipelineLayout,
+												(VkPipeline)NULL,
+												(int32_t)0 };
+
+			//create pipeline
+			res = vkCreateComputePipelines(_device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, NULL, &_pipeline);
+			if (res != VK_SUCCESS) return res;
+
+			vkDestroyShaderModule(_device, pipelineShaderStageCreateInfo.module, NULL);
+			return res;
+		}
+
+		VkResult Dispatch() {
+			VkResult res = VK_SUCCESS;
+			VkCommandBuffer commandBuffer = { 0 };
+
+			// Create a command buffer to be executed on the GPU.
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo;
+			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferAllocateInfo.pNext = 0;
+			commandBufferAllocateInfo.commandPool = _commandPool;
+			commandBufferAllocateInfo.level = (VkCommandBufferLevel)VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			commandBufferAllocateInfo.commandBufferCount = (uint32_t)1;
+			res = vkAllocateCommandBuffers(_device, &commandBufferAllocateInfo, &commandBuffer);
+
+			// Begin command buffer recording.
+			VkCommandBufferBeginInfo commandBufferBeginInfo;
+			commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			commandBufferBeginInfo.pNext = 0;
+			commandBufferBeginInfo.flags = (VkCommandBufferUsageFlags)VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			commandBufferBeginInfo.pInheritanceInfo = (const VkCommandBufferInheritanceInfo*)NULL;
+			res = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+
+			if (res != VK_SUCCESS) return res;
+
+			unsigned int pushConstants[3] = { _imageWidthPixels, _imageHeightPixels, _radiusPixels };
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+			vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(unsigned int) * 3, pushConstants);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 1, &_descriptorSet, 0, NULL);
+			vkCmdDispatch(commandBuffer, _workGroupCount[0], _workGroupCount[1], _workGroupCount[2]);
+
+			// End command buffer recording.
+			res = vkEndCommandBuffer(commandBuffer);
+			if (res != VK_SUCCESS) return res;
+
+			// Submit the command buffer.
+			VkSubmitInfo submitInfo;
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext = 0;
+			submitInfo.waitSemaphoreCount = (uint32_t)0;
+			submitInfo.pWaitSemaphores = (const VkSemaphore*)NULL;
+			submitInfo.pWaitDstStageMask = (const VkPipelineStageFlags*)NULL;
+			submitInfo.commandBufferCount = (uint32_t)1;
+			submitInfo.pCommandBuffers = (const VkCommandBuffer*)&commandBuffer;
+			submitInfo.signalSemaphoreCount = (uint32_t)0;
+			submitInfo.pSignalSemaphores = (const VkSemaphore*)NULL;
+			Profiler::ScopedZone zone("Box blur");
+			res = vkQueueSubmit(_queue, 1, &submitInfo, _fence);
+			if (res != VK_SUCCESS) return res;
+
+			// Wait for the fence that was configured to signal when execution has finished.
+			res = vkWaitForFences(_device, 1, &_fence, VK_TRUE, 30000000000);
+			if (res != VK_SUCCESS) return res;
+
+			// Destroy the command buffer and reset the fence's status. A fence can be signalled or unsignalled. Once a fence is signalled, control is given back to the
+			// the code that called vkWaitForFences().
+			res = vkResetFences(_device, 1, &_fence);
+			if (res != VK_SUCCESS) return res;
+
+			vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+			return res;
+		}
+
+		VkResult FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t memoryTypeBits, VkMemoryPropertyFlags memoryPropertyFlags, uint32_t* memoryTypeIndex) {
+			//find memory with specified properties
+			VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties = { 0 };
+
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
+
+			for (uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryTypeCount; ++i) {
+				if ((memoryTypeBits & (1 << i)) && ((physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)) {
+					memoryTypeIndex[0] = i;
+					return VK_SUCCESS;
+				}
+			}
+			return VK_ERROR_INITIALIZATION_FAILED;
+		}
+
+		VkResult AllocateGPUOnlyBuffer(VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize bufferSizeBytes, VkBuffer* outBuffer, VkDeviceMemory* outDeviceMemory) {
+			//allocate the buffer used by the GPU with specified properties
+			VkResult res = VK_SUCCESS;
+			uint32_t queueFamilyIndices;
+			VkBufferCreateInfo bufferCreateInfo;
+			bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferCreateInfo.pNext = 0;
+			bufferCreateInfo.flags = (VkBufferCreateFlags)0;
+			bufferCreateInfo.size = (VkDeviceSize)bufferSizeBytes;
+			bufferCreateInfo.usage = (VkBufferUsageFlags)bufferUsageFlags;
+			bufferCreateInfo.sharingMode = (VkSharingMode)VK_SHARING_MODE_EXCLUSIVE;
+			bufferCreateInfo.queueFamilyIndexCount = (uint32_t)1;
+			bufferCreateInfo.pQueueFamilyIndices = (const uint32_t*)&queueFamilyIndices;
+
+			res = ResourceTracker::CreateBuffer(_device, &bufferCreateInfo, NULL, outBuffer);
+			if (res != VK_SUCCESS) return res;
+
+			VkMemoryRequirements memoryRequirements = { 0 };
+			vkGetBufferMemoryRequirements(_device, *outBuffer, &memoryRequirements);
+
+			//find memory with specified properties
+			uint32_t memoryTypeIndex = 0xFFFFFFFF;
+			vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &_physicalDeviceMemoryProperties);
+
+			for (uint32_t i = 0; i < _physicalDeviceMemoryProperties.memoryTypeCount; ++i) {
+				if ((memoryRequirements.memoryTypeBits & (1 << i)) && ((_physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)) {
+					memoryTypeIndex = i;
+					break;
+				}
+			}
+			if (0xFFFFFFFF == memoryTypeIndex) return VK_ERROR_INITIALIZATION_FAILED;
+
+			VkMemoryAllocateInfo memoryAllocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+										 0,
+										 (VkDeviceSize)memoryRequirements.size,
+										 (uint32_t)memoryTypeIndex };
+
+			res = ResourceTracker::AllocateMemory(_device, &memoryAllocateInfo, NULL, outDeviceMemory);
+			if (res != VK_SUCCESS) return res;
+
+			res = vkBindBufferMemory(_device, *outBuffer, *outDeviceMemory, 0);
+			return res;
+		}
+
+		VkResult UploadDataToGPU(void* data, VkBuffer* outBuffer, VkDeviceSize bufferSizeBytes) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			VkResult res = VK_SUCCESS;
+
+			//a function that transfers data from the CPU to the GPU using staging buffer,
+				//because the GPU memory is not host-coherent
+			VkDeviceSize stagingBufferSize = bufferSizeBytes;
+			VkBuffer stagingBuffer = { 0 };
+			VkDeviceMemory stagingBufferMemory = { 0 };
+			res = AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				stagingBufferSize,
+				&stagingBuffer,
+				&stagingBufferMemory);
+			if (res != VK_SUCCESS) return res;
+
+			void* stagingData;
+			res = vkMapMemory(_device, stagingBufferMemory, 0, stagingBufferSize, 0, &stagingData);
+			if (res != VK_SUCCESS) return res;
+			memcpy(stagingData, data, stagingBufferSize);
+			vkUnmapMemory(_device, stagingBufferMemory);
+
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+												0,
+												(VkCommandPool)_commandPool,
+												(VkCommandBufferLevel)VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+												(uint32_t)1 };
+			VkCommandBuffer commandBuffer = { 0 };
+			res = vkAllocateCommandBuffers(_device, &commandBufferAllocateInfo, &commandBuffer);
+			if (res != VK_SUCCESS) return res;
+
+
+
+			VkCommandBufferBeginInfo commandBufferBeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+											 0,
+											 (VkCommandBufferUsageFlags)VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+											 (const VkCommandBufferInheritanceInfo*)NULL };
+			res = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+			if (res != VK_SUCCESS) return res;
+			VkBufferCopy copyRegion = { 0, 0, stagingBufferSize };
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer, *outBuffer, 1, &copyRegion);
+			res = vkEndCommandBuffer(commandBuffer);
+			if (res != VK_SUCCESS) return res;
+
+			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO,
+								 0,
+								 (uint32_t)0,
+								 (const VkSemaphore*)NULL,
+								 (const VkPipelineStageFlags*)NULL,
+								 (uint32_t)1,
+								 (const VkCommandBuffer*)&commandBuffer,
+								 (uint32_t)0,
+								 (const VkSemaphore*)NULL };
+
+			res = vkQueueSubmit(_queue, 1, &submitInfo, _fence);
+			if (res != VK_SUCCESS) return res;
+
+
+			res = vkWaitForFences(_device, 1, &_fence, VK_TRUE, 100000000000);
+			if (res != VK_SUCCESS) return res;
+
+			res = vkResetFences(_device, 1, &_fence);
+			if (res != VK_SUCCESS) return res;
+
+			vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+			ResourceTracker::DestroyBuffer(_device, stagingBuffer, NULL);
+			ResourceTracker::FreeMemory(_device, stagingBufferMemory, NULL);
+			return res;
+		}
+
+		VkResult DownloadDataFromGPU(void* data, VkBuffer* outBuffer, VkDeviceSize bufferSize) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			VkResult res = VK_SUCCESS;
+			VkCommandBuffer commandBuffer = { 0 };
+
+			// A function that transfers data from the GPU to the CPU using staging buffer, because GPU memory is not host-coherent (meaning it is
+			// not synced with the contents of CPU memory).
+			VkDeviceSize stagingBufferSize = bufferSize;
+			VkBuffer stagingBuffer = { 0 };
+			VkDeviceMemory stagingBufferMemory = { 0 };
+			res = AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				stagingBufferSize,
+				&stagingBuffer,
+				&stagingBufferMemory);
+			if (res != VK_SUCCESS) return res;
+
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+												0,
+												(VkCommandPool)_commandPool,
+												(VkCommandBufferLevel)VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+												(uint32_t)1 };
+			res = vkAllocateCommandBuffers(_device, &commandBufferAllocateInfo, &commandBuffer);
+			if (res != VK_SUCCESS) return res;
+
+			VkCommandBufferBeginInfo commandBufferBeginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+											 0,
+											 (VkCommandBufferUsageFlags)VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+											 (const VkCommandBufferInheritanceInfo*)NULL };
+			res = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+			if (res != VK_SUCCESS) return res;
+
+			VkBufferCopy copyRegion = { (VkDeviceSize)0,
+								 (VkDeviceSize)0,
+								 (VkDeviceSize)stagingBufferSize };
+
+			vkCmdCopyBuffer(commandBuffer, outBuffer[0], stagingBuffer, 1, &copyRegion);
+			vkEndCommandBuffer(commandBuffer);
+
+			VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO,
+								 0,
+								 (uint32_t)0,
+								 (const VkSemaphore*)NULL,
+								 (const VkPipelineStageFlags*)NULL,
+								 (uint32_t)1,
+								 (const VkCommandBuffer*)&commandBuffer,
+								 (uint32_t)0,
+								 (const VkSemaphore*)NULL };
+
+			res = vkQueueSubmit(_queue, 1, &submitInfo, _fence);
+			if (res != VK_SUCCESS) return res;
+
+			res = vkWaitForFences(_device, 1, &_fence, VK_TRUE, 100000000000);
+			if (res != VK_SUCCESS) return res;
+
+			res = vkResetFences(_device, 1, &_fence);
+			if (res != VK_SUCCESS) return res;
+
+			vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+
+			void* stagingData;
+			res = vkMapMemory(_device, stagingBufferMemory, 0, stagingBufferSize, 0, &stagingData);
+			if (res != VK_SUCCESS) return res;
+
+			memcpy(data, stagingData, stagingBufferSize);
+			vkUnmapMemory(_device, stagingBufferMemory);
+
+			ResourceTracker::DestroyBuffer(_device, stagingBuffer, NULL);
+			ResourceTracker::FreeMemory(_device, stagingBufferMemory, NULL);
+			return res;
+		}
+
+		VkResult GetComputeQueueFamilyIndex() {
+			//find a queue family for a selected GPU, select the first available for use
+			uint32_t queueFamilyCount;
+			vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, NULL);
+
+			VkQueueFamilyProperties* queueFamilies = (VkQueueFamilyProperties*)malloc(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
+
+			vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, queueFamilies);
+			uint32_t i = 0;
+			for (; i < queueFamilyCount; i++) {
+				VkQueueFamilyProperties props = queueFamilies[i];
+
+				if (props.queueCount > 0 && (props.queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+					break;
+				}
+			}
+			free(queueFamilies);
+			if (i == queueFamilyCount) {
+				return VK_ERROR_INITIALIZATION_FAILED;
+			}
+			_queueFamilyIndex = i;
+			return VK_SUCCESS;
+		}
+
+		VkResult CreateLogicalDevice() {
+			//create logical device representation
+			VkResult res = VK_SUCCESS;
+			res = GetComputeQueueFamilyIndex();
+			if (res != VK_SUCCESS) return res;
+			vkGetDeviceQueue(_device, _queueFamilyIndex, 0, &_queue);
+			return res;
+
+			float queuePriorities = 1.0;
+			VkDeviceQueueCreateInfo deviceQueueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+					0,
+					(VkDeviceQueueCreateFlags)0,
+					(uint32_t)_queueFamilyIndex,
+					(uint32_t)1,
+					(const float*)&queuePriorities };
+
+			VkPhysicalDeviceFeatures physicalDeviceFeatures = { 0 };
+			physicalDeviceFeatures.shaderFloat64 = VK_TRUE;//this enables double precision support in shaders 
+
+			VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+					0,
+					(VkDeviceCreateFlags)0,
+					(uint32_t)1,
+					(const VkDeviceQueueCreateInfo*)&deviceQueueCreateInfo,
+					(uint32_t)0,
+					(const char* const*)NULL,
+					(uint32_t)0,
+					(const char* const*)NULL,
+					(const VkPhysicalDeviceFeatures*)&physicalDeviceFeatures };
+
+			res = vkCreateDevice(_physicalDevice, &deviceCreateInfo, NULL, &_device);
+			if (res != VK_SUCCESS) return res;
+
+		}
+
+		void InitializeVulkan() {
+			VkResult res = VK_SUCCESS;
+
+			// Create the instance - a connection between the application and the Vulkan library.
+			/*res = CreateInstance(vkGPU);
+			std::cout << "Instance creation failed, error code: " << res;*/
+
+			// Set up the debugging messenger.
+			/*res = SetupDebugUtilsMessenger(vkGPU);
+			std::cout << "Debug utils messenger creation failed, error code: " << res;*/
+
+			// Check if there are GPUs that support Vulkan and select one.
+			/*res = FindGPU(vkGPU);
+			std::cout << "Physical device not found, error code: " << res;*/
+
+			// Create logical device representation.
+			if (CreateLogicalDevice() != VK_SUCCESS) {
+				Logger::Error("logical device creation failed");
+			}
+
+			// Create a fence for synchronization.
+			VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, 0 };
+			if (vkCreateFence(_device, &fenceCreateInfo, NULL, &_fence)) {
+				Logger::Error("fence creation failed");
+			}
+
+			// Create a structure from which command buffer memory is allocated from.
+			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, NULL, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, _queueFamilyIndex };
+			if (vkCreateCommandPool(_device, &commandPoolCreateInfo, NULL, &_commandPool)) {
+				Logger::Error("command pool creation failed");
+			}
+		}
+
+		void CalculateWorkGroupCountAndSize() {
+			// Prepare variables.
+			uint32_t maxWorkGroupInvocations = _physicalDeviceProperties.limits.maxComputeWorkGroupInvocations;
+			uint32_t* maxWorkGroupSize = _physicalDeviceProperties.limits.maxComputeWorkGroupSize;
+			uint32_t* maxWorkGroupCount = _physicalDeviceProperties.limits.maxComputeWorkGroupCount;
+			uint32_t workGroupSize[3] = { 1, 1, 1 };
+			uint32_t workGroupCount[3] = { 1, 1, 1 };
+
+			// Use the work group size first, as that directly controls the amount of threads 1 to 1.
+			uint32_t totalWorkGroupSize = workGroupSize[0] * workGroupSize[1] * workGroupSize[2];
+			for (int i = 0; i < 3; ++i) {
+				for (; workGroupSize[i] < maxWorkGroupSize[i]; ++workGroupSize[i]) {
+					totalWorkGroupSize = workGroupSize[0] * workGroupSize[1] * workGroupSize[2];
+					if (totalWorkGroupSize >= _inputBufferCount || totalWorkGroupSize == maxWorkGroupInvocations) { break; }
+				}
+			}
+
+			// If one workgroup still doesn't do it, use multiple workgroups with the size of each one calculated earlier.
+			if (totalWorkGroupSize < _inputBufferCount) {
+				for (int i = 0; i < 3; ++i) {
+					for (; workGroupCount[i] < maxWorkGroupCount[i]; ++workGroupCount[i]) {
+						if (((workGroupCount[0] * workGroupCount[1] * workGroupCount[2]) * totalWorkGroupSize) >= _inputBufferCount) { break; }
+					}
+				}
+			}
+
+			// Return the calculated size and count in the output params.
+			_workGroupCount[0] = workGroupCount[0];
+			_workGroupCount[1] = workGroupCount[1];
+			_workGroupCount[2] = workGroupCount[2];
+			_workGroupSize[0] = workGroupSize[0];
+			_workGroupSize[1] = workGroupSize[1];
+			_workGroupSize[2] = workGroupSize[2];
+		}
+
+	public:
+		unsigned char* Run(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, unsigned char* loadedImage, unsigned int imageWidthPixels, unsigned int imageHeightPixels, unsigned int radiusPixels = 15) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Texture);
+			_physicalDevice = physicalDevice;
+			_device = logicalDevice;
+			_imageWidthPixels = imageWidthPixels;
+			_imageHeightPixels = imageHeightPixels;
+			_radiusPixels = radiusPixels;
+
+			InitializeVulkan();
+
+			// Get device properties and memory properties, if needed.
+			vkGetPhysicalDeviceProperties(physicalDevice, &_physicalDeviceProperties);
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_physicalDeviceMemoryProperties);
+
+			// Load the image.
+			int wantedComponents = 4;
+
+			// In the stbi_load() function, comp stands for components. In a PNG image, for example, there are 4 components 
+			// for each pixel, red, green, blue and alpha.
+			// The image's pixels are read and stored left to right, top to bottom, relative to the image.
+			// Each pixel's component is an unsigned char.
+			int width = imageWidthPixels;
+			int height = imageHeightPixels;
+
+			//unsigned char* loadedImage = stbi_load("C:\\Users\\paolo.parker\\source\\repos\\celeritas-engine\\textures\\LeftFace.png", &width, &height, &componentsDetected, wantedComponents);
+
+			// The most optimal memory has the VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT flag and is usually not accessible by the CPU on dedicated graphics cards. 
+			// The memory type that allows us to access it from the CPU may not be the most optimal memory type for the graphics card itself to read from.
+			// Generate some random data in the array to use as input for the compute shader.
+			uint32_t inputAndOutputBufferSizeInBytes = (uint32_t)(imageWidthPixels * imageHeightPixels) * 4;
+
+			// Prepare the input and output buffers.
+			_inputBufferCount = (uint32_t)(imageWidthPixels * imageHeightPixels);
+			_inputBuffer;
+			_inputBufferDeviceMemory;
+			_outputBufferCount = _inputBufferCount;
+			_outputBuffer;
+			_outputBufferDeviceMemory;
+
+			// Calculate how many workgroups and the size of each workgroup we are going to use.
+			// We want one GPU thread to operate on a single value from the input buffer, so the required thread size is the input buffer size.
+			CalculateWorkGroupCountAndSize();
+
+			//use default values if coalescedMemory = 0
+			if (_coalescedMemory == 0) {
+				switch (_physicalDeviceProperties.vendorID) {
+				case 0x10DE://NVIDIA - change to 128 before Pascal
+					_coalescedMemory = 32;
+					break;
+				case 0x8086://INTEL
+					_coalescedMemory = 64;
+					break;
+				case 0x13B5://AMD
+					_coalescedMemory = 64;
+					break;
+				default:
+					_coalescedMemory = 64;
+					break;
+				}
+			}
+
+			// Create the input buffer.
+			VkResult res = VK_SUCCESS;
+			if (AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, //device local memory
+				inputAndOutputBufferSizeInBytes,
+				&_inputBuffer,
+				&_inputBufferDeviceMemory) != VK_SUCCESS) {
+				Logger::Error("input buffer allocation failed");
+			}
+
+			// Create the output buffer.
+			if (AllocateGPUOnlyBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, //device local memory
+				inputAndOutputBufferSizeInBytes,
+				&_outputBuffer,
+				&_outputBufferDeviceMemory) != VK_SUCCESS) {
+				Logger::Error("output buffer allocation failed");
+			}
+
+			// Transfer data to GPU staging buffer and thereafter sync the staging buffer with GPU local memory.
+			if (UploadDataToGPU(loadedImage, &_inputBuffer, inputAndOutputBufferSizeInBytes) != VK_SUCCESS) {
+				Logger::Error("failed uploading image to GPU");
+			}
+
+			VkBuffer buffers[2] = { _inputBuffer, _outputBuffer };
+			VkDeviceSize buffersSize[2] = { inputAndOutputBufferSizeInBytes, inputAndOutputBufferSizeInBytes };
+
+			// Create 
+			//const char* shaderPath = "C:\\code\\vulkan-compute\\shaders\\Shader.spv";
+			auto shaderPath = Paths::ShadersPath() /= L"compute\\BoxBlur.spv";
+			if (CreateComputePipeline(buffers, buffersSize, shaderPath.string().c_str()) != VK_SUCCESS) {
+				Logger::Error("application creation failed");
+			}
+
+			if (Dispatch() != VK_SUCCESS) {
+				Logger::Error("application run failed");
+			}
+
+			unsigned char* shaderOutputBufferData = (unsigned char*)malloc(inputAndOutputBufferSizeInBytes);
+
+			res = vkGetFenceStatus(_device, _fence);
+
+			//Transfer data from GPU using staging buffer, if needed
+			if (DownloadDataFromGPU(shaderOutputBufferData,
+				&_outputBuffer,
+				inputAndOutputBufferSizeInBytes) != VK_SUCCESS) {
+				Logger::Error("failed downloading image from GPU");
+			}
+
+			// Print data for debugging.
+			/*printf("Output buffer result: [");
+			uint32_t startAndEndSize = 50;
+			uint32_t i = 0;
+			for (; i < outputBufferCount - 1 && i < startAndEndSize; ++i) {
+				printf("%d, ", shaderOutputBufferData[i]);
+			}
+			if (i >= startAndEndSize) {
+				printf("..., ");
+				i = outputBufferCount - startAndEndSize + 1;
+				for (; i < outputBufferCount - 1; ++i)
+					printf("%d, ", shaderOutputBufferData[i]);
+			}
+			printf("%d]\n", shaderOutputBufferData[outputBufferCount - 1]);*/
+
+			// Free resources.
+			ResourceTracker::DestroyBuffer(_device, _inputBuffer, nullptr);
+			ResourceTracker::FreeMemory(_device, _inputBufferDeviceMemory, nullptr);
+			ResourceTracker::DestroyBuffer(_device, _outputBuffer, nullptr);
+			ResourceTracker::FreeMemory(_device, _outputBufferDeviceMemory, nullptr);
+
+			return shaderOutputBufferData;
+		}
+
+		void Destroy() {
+			vkDestroyFence(_device, _fence, nullptr);
+			ResourceTracker::DestroyDescriptorPool(_device, _descriptorPool, NULL);
+			vkDestroyDescriptorSetLayout(_device, _descriptorSetLayout, NULL);
+			vkDestroyPipelineLayout(_device, _pipelineLayout, NULL);
+			vkDestroyPipeline(_device, _pipeline, NULL);
+		}
+	};
+
+	/**
+	 * @brief Used specifically for the CubicalEnvironmentMap class in order to index into its faces.
+	 */
+	enum class CubeMapFace {
+		NONE,
+		FRONT,
+		RIGHT,
+		BACK,
+		LEFT,
+		UPPER,
+		LOWER
+	};
+
+	/**
+	 * @brief Represents a cubical environment map, used as an image-based light source
+	 * in the shaders.
+	 */
+	class CubicalEnvironmentMap : public IPipelineable, public IDrawable {
+
+	public:
+
+		/**
+		 * @brief Physical device.
+		 */
+		VkPhysicalDevice _physicalDevice{};
+
+		/**
+		 * @brief Logical device.
+		 */
+		VkDevice _logicalDevice = nullptr;
+
+		/**
+		 * @brief Front face data, including all mipmaps.
+		 */
+		std::vector<std::vector<unsigned char>> _front;
+
+		/**
+		 * @brief Right face data, including all mipmaps.
+		 */
+		std::vector<std::vector<unsigned char>> _right;
+
+		/**
+		 * @brief Back face data, including all mipmaps.
+		 */
+		std::vector<std::vector<unsigned char>> _back;
+
+		/**
+		 * @brief Left face data, including all mipmaps.
+		 */
+		std::vector<std::vector<unsigned char>> _left;
+
+		/**
+		 * @brief Upper face data, including all mipmaps.
+		 */
+		std::vector<std::vector<unsigned char>> _upper;
+
+		/**
+		 * @brief Lower face data, including all mipmaps.
+		 */
+		std::vector<std::vector<unsigned char>> _lower;
+
+		/**
+		 * @brief Data loaded from the HDRi image file.
+		 */
+		std::vector<std::vector<unsigned char>> _hdriImageData;
+
+		/**
+		 * @brief Width and height of the loaded HDRi image.
+		 */
+		VkExtent2D _hdriSizePixels{};
+
+		/**
+		 * @brief Width and height of each face's image.
+		 */
+		int _faceSizePixels = 0;
+
+		/**
+		 * @brief Vulkan handle to the cube map image used in the shaders. This image is meant to contain all the cube map's images as a serialized array of pixels.
+		 * In order to know where, in the array of pixels, each image starts/ends and what format it's in, a sampler and image view are used.
+		 */
+		Image _cubeMapImage{ nullptr, 0 };
+
+		/**
+		 * @brief Number of mipmaps. This is dynamically caluclated.
+		 */
+		int _mipmapCount = 0;
+
+		// Returns the 0-based pixel coordinates given the component index of an image data array. Assumes that the
+		// input component index starts from 0, and that the origin of the image is at the top left corner, with X
+		// increasing to the right, and Y increasing downward.
+		glm::vec2 ComponentIndexToCartesian(int componentIndex, int imageWidthPixels) {
+			int x = (int(componentIndex * 0.25f) % imageWidthPixels);
+			int y = (int(componentIndex * 0.25f) / imageWidthPixels);
+			return glm::vec2(x, y);
+		}
+
+		// Returns the 0-based component index into an image data array given the pixel coordinates of the image.
+		// Assumes that X and Y both start from 0, at the top left corner of the image, and the maximum X can be is equal to imageWidthPixels-1.
+		int CartesianToComponentIndex(int x, int y, int imageWidthPixels) {
+			return (x + (y * imageWidthPixels)) * 4;
+		}
+
+		// Blurs an image by averaging the value of each pixel with the value of "samples" pixels at distance of "radiusPixels" pixels in a 
+		// circular pattern around it. Returns the blurred image data.
+		std::vector<unsigned char> BoxBlurImage(const std::vector<unsigned char>& inImageData, int widthPixels, int heightPixels, int radiusPixels) {
+			// Make sure that the input values are valid.
+			if (radiusPixels < 1) {
+				radiusPixels = 1;
+			}
+			if (inImageData.data() == nullptr || inImageData.size() <= 0) {
+				return std::vector<unsigned char>();
+			}
+
+			// Prepare some variables used throughout the function.
+			std::vector<unsigned char> outImageData;
+			int boxSideLength = (radiusPixels * 2) + 1;
+			outImageData.resize(inImageData.size());
+
+			for (int componentIndex = 0; componentIndex < inImageData.size(); componentIndex += 4) {
+				auto currentPixelCoordinates = ComponentIndexToCartesian(componentIndex, widthPixels);
+
+				// Start sampling from the top left relative to the current pixel. Coordinates increase going left to right for X
+				// and top to bottom for Y.
+				int sampleCoordinateY = int(currentPixelCoordinates.y - radiusPixels);
+				glm::vec4 averageColor(-1.0f);
+				for (int i = 0; i < boxSideLength; ++i) {
+					int sampleCoordinateX = int(currentPixelCoordinates.x - radiusPixels);
+					for (int j = 0; j < boxSideLength; ++j) {
+
+						// Only sample if the coordinates fall within the range of the image.
+						if (auto sampleIndex = CartesianToComponentIndex(sampleCoordinateX, sampleCoordinateY, widthPixels); sampleIndex >= 0 && sampleIndex < inImageData.size()) {
+							glm::vec4 sampledColor = glm::vec4(inImageData[sampleIndex], inImageData[sampleIndex + 1], inImageData[sampleIndex + 2], inImageData[sampleIndex + 3]);
+
+							// Only calculate the average if averageColor is initialized, otherwise just use the average color as is, to account for
+							// the first time this line of code is reached.
+							averageColor = averageColor.x < 0 ? sampledColor : (averageColor + sampledColor);
+						}
+						++sampleCoordinateX;
+					}
+					++sampleCoordinateY;
+				}
+
+				// Calculate the average.
+				averageColor /= (boxSideLength * boxSideLength);
+
+				// Assign the calculated average color.
+				outImageData[componentIndex] = int(averageColor.r);
+				outImageData[componentIndex + 1] = int(averageColor.g);
+				outImageData[componentIndex + 2] = int(averageColor.b);
+				outImageData[componentIndex + 3] = int(averageColor.a);
+			}
+
+			return outImageData;
+		}
+
+		std::vector<unsigned char> GenerateFaceImage(CubeMapFace face, int mipIndex, int width, int height) {
+			// The world space unit vector that points in the positive X direction of the image (must be left to right), as if the image was placed in the 3D world on a square plane.
+			glm::vec3 imageXWorldSpace;
+
+			// The world space unit vector that points in the positive Y direction of the image (must be bottom to top), as if the image was placed in the 3D world on a square plane.
+			glm::vec3 imageYWorldSpace;
+
+			// The origin of the image (must be the bottom left corner) in world space, as if the image was placed in the 3D world on a square plane.
+			glm::vec3 imageOriginWorldSpace;
+
+			auto sizePixels = _faceSizePixels;
+			for (int i = 0; i < mipIndex; ++i) {
+				sizePixels /= 2;
+			}
+
+			std::vector<unsigned char> outImage;
+			outImage.resize(sizePixels * sizePixels * 4);
+
+			switch (face) {
+			case CubeMapFace::FRONT:
+				imageXWorldSpace = glm::vec3(1.0f, 0.0f, 0.0f);
+				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
+				imageOriginWorldSpace = glm::vec3(-0.5f, 0.5f, 0.5f);
+				break;
+			case CubeMapFace::RIGHT:
+				imageXWorldSpace = glm::vec3(0.0f, 0.0f, -1.0f);
+				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
+				imageOriginWorldSpace = glm::vec3(0.5f, 0.5f, 0.5f);
+				break;
+			case CubeMapFace::BACK:
+				imageXWorldSpace = glm::vec3(-1.0f, 0.0f, 0.0f);
+				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
+				imageOriginWorldSpace = glm::vec3(0.5f, 0.5f, -0.5f);
+				break;
+			case CubeMapFace::LEFT:
+				imageXWorldSpace = glm::vec3(0.0f, 0.0f, 1.0f);
+				imageYWorldSpace = glm::vec3(0.0f, 1.0f, 0.0f);
+				imageOriginWorldSpace = glm::vec3(-0.5f, 0.5f, -0.5f);
+				break;
+			case CubeMapFace::UPPER:
+				imageXWorldSpace = glm::vec3(1.0f, 0.0f, 0.0f);
+				imageYWorldSpace = glm::vec3(0.0f, 0.0f, -1.0f);
+				imageOriginWorldSpace = glm::vec3(-0.5f, 0.5f, -0.5f);
+				break;
+			case CubeMapFace::LOWER:
+				imageXWorldSpace = glm::vec3(1.0f, 0.0f, 0.0f);
+				imageYWorldSpace = glm::vec3(0.0f, 0.0f, 1.0f);
+				imageOriginWorldSpace = glm::vec3(-0.5f, -0.5f, 0.5f);
+				break;
+			}
+
+			for (auto y = 0; y < sizePixels; ++y) {
+				for (auto x = 0; x < sizePixels; ++x) {
+
+					// First we calculate the cartesian coordinate of the pixel of the cube map's face we are considering, in world space.
+					glm::vec3 cartesianCoordinatesOnFace;
+					cartesianCoordinatesOnFace = imageOriginWorldSpace + (imageXWorldSpace * ((1.0f / sizePixels) * x));
+					cartesianCoordinatesOnFace += -imageYWorldSpace * ((1.0f / sizePixels) * y);
+
+					// Then we get the cartesian coordinates on the sphere from the cartesian coordinates on the face. You can
+					// imagine a cube that contains a sphere of exactly the same radius. Only the sphere's poles and sides will
+					// touch each cube's face exactly at the center. We take advantage of the fact that the radius of the sphere
+					// is constant (always equal to 1 for simplicity in our case) so all we need to do is normalize the coordinates
+					// on the face and we get the cartesian coordinates on the sphere. This kind of simulates shooting a ray from
+					// the current pixel on the cube towards the center of the sphere, intersecting it with the sphere, and taking 
+					// the coordinates of the intersection point.
+					auto cartesianCoordinatesOnSphere = glm::normalize(cartesianCoordinatesOnFace);
+
+					float localXAngleDegrees = 0.0f;
+					float localYAngleDegrees = 0.0f;
+					float azimuthDegrees = 0.0f;
+					float zenithDegrees = 0.0f;
+
+					// Then we calculate the spherical coordinates by using some trig.
+					// Depending on the coordinate, the angles could either be negative or positive, according to the left hand rule.
+					// This engine uses a left-handed coordinate system.
+					switch (face) {
+					case CubeMapFace::FRONT:
 						localXAngleDegrees = glm::degrees(atanf(cartesianCoordinatesOnFace.x * 2.0f));
 						localYAngleDegrees = (90.0f - glm::degrees(acosf(cartesianCoordinatesOnSphere.y))) * -1.0f;
 						azimuthDegrees = cartesianCoordinatesOnFace.x < 0.0f ? abs(localXAngleDegrees) * -1.0f : abs(localXAngleDegrees);
@@ -3065,2489 +5634,5182 @@ namespace Engine {
 						break;
 					}
 
-					// UV coordinates into the spherical HDRi image.
-					auto uCoordinate = fmodf(0.5f + (azimuthDegrees / 360.0f), 1.0f);
-					auto vCoordinate = 0.5f + (zenithDegrees / -180.0f);
+					// UV coordinates into the spherical HDRi image.
+					auto uCoordinate = fmodf(0.5f + (azimuthDegrees / 360.0f), 1.0f);
+					auto vCoordinate = 0.5f + (zenithDegrees / -180.0f);
+
+					// This calculates at which pixel from the left (for U) and from the top (for V)
+					// we need to fetch from the spherical HDRi.
+					auto coordinateU = uCoordinate * width;
+					auto coordinateV = (1.0f - vCoordinate) * height;
+
+					int pixelNumberU = (int)ceil(coordinateU);
+					if (pixelNumberU >= width || pixelNumberU < 0) {
+						pixelNumberU = (int)floor(coordinateU);
+						if (pixelNumberU >= width || pixelNumberU < 0) {
+							continue;
+						}
+					}
+
+					int pixelNumberV = (int)ceil(coordinateV);
+					if (pixelNumberV >= height || pixelNumberU < 0) {
+						pixelNumberV = (int)floor(coordinateV);
+						if (pixelNumberV >= height || pixelNumberV < 0) {
+							continue;
+						}
+					}
+
+					// This calculates the index into the spherical HDRi image accounting for 2 things:
+					// 1) the pixel numbers calculated above
+					// 2) the fact that each pixel is actually stored in 4 separate cells that represent
+					//    each channel of each individual pixel. The channels used are always 4 (RGBA).
+					int componentIndex = CartesianToComponentIndex(pixelNumberU, pixelNumberV, width);
+
+					// Fetch the channels from the spherical HDRi based on the calculations made above.
+					auto red = _hdriImageData[mipIndex][componentIndex];
+					auto green = _hdriImageData[mipIndex][componentIndex + 1];
+					auto blue = _hdriImageData[mipIndex][componentIndex + 2];
+					auto alpha = _hdriImageData[mipIndex][componentIndex + 3];
+
+					// Assign the color fetched from the HDRi to the cube map face's image we want to generate.
+					int faceComponentIndex = (x + (sizePixels * y)) * 4;
+					outImage[faceComponentIndex] = red;
+					outImage[faceComponentIndex + 1] = green;
+					outImage[faceComponentIndex + 2] = blue;
+					outImage[faceComponentIndex + 3] = alpha;
+				}
+			}
+
+			return outImage;
+		}
+
+		void WriteImagesToFiles(std::filesystem::path absoluteFolderPath) {
+			if (!std::filesystem::exists(absoluteFolderPath)) {
+				if (std::filesystem::is_directory(absoluteFolderPath)) {
+					std::filesystem::create_directories(absoluteFolderPath);
+				}
+				else {
+					Logger::Error("provided path is not valid");
+					return;
+				}
+			}
+
+			auto mipmapIndex = 1;
+			auto resolution = _faceSizePixels;
+			auto faces = { &_front, &_right, &_back, &_left, &_upper, &_lower };
+			for (auto resolution = _faceSizePixels, radius = 2; resolution > 1; resolution /= 2, radius *= 2) {
+
+				int j = 0;
+				for (auto face : faces) {
+					auto halfResolution = resolution / 2;
+
+					auto path = absoluteFolderPath / (std::string("face_") + std::to_string(j) + "_" + std::to_string(mipmapIndex) + ".png");
+					auto ptr = (*face)[mipmapIndex].data();
+					stbi_write_png(path.string().c_str(), halfResolution, halfResolution, 4, ptr, halfResolution * 4);
+					++j;
+				}
+
+				mipmapIndex++;
+			}
+		}
+
+		CubicalEnvironmentMap() = default;
+
+		CubicalEnvironmentMap(VkPhysicalDevice& physicalDevice, VkDevice& logicalDevice) {
+			_physicalDevice = physicalDevice;
+			_logicalDevice = logicalDevice;
+			_faceSizePixels = 512;
+		}
+
+		std::vector<unsigned char> ResizeImage(std::vector<unsigned char> image, int oldWidthPixels, int oldHeightPixels, int newWidthPixels, int newHeightPixels) {
+			std::vector<unsigned char> outImage(newWidthPixels * newHeightPixels * 4);
+			int ratioX = oldWidthPixels / newWidthPixels;
+			int ratioY = oldHeightPixels / newHeightPixels;
+			int oldImageX = 0;
+			int oldImageY = 0;
+			int newImageX = 0;
+			int newImageY = 0;
+
+			for (; newImageY < newHeightPixels; ++newImageY) {
+				newImageX = 0;
+				for (; newImageX < newWidthPixels; ++newImageX) {
+					auto oldImageComponentIndex = CartesianToComponentIndex(newImageX * ratioX, newImageY * ratioY, oldWidthPixels);
+					auto newImageComponentIndex = CartesianToComponentIndex(newImageX, newImageY, newWidthPixels);
+					outImage[newImageComponentIndex] = image[oldImageComponentIndex];
+					outImage[newImageComponentIndex + 1] = image[oldImageComponentIndex + 1];
+					outImage[newImageComponentIndex + 2] = image[oldImageComponentIndex + 2];
+					outImage[newImageComponentIndex + 3] = image[oldImageComponentIndex + 3];
+				}
+			}
+
+			return outImage;
+		}
+
+		std::vector<unsigned char> PadImage(std::vector<unsigned char> image, int widthPixels, int heightPixels, int padAmountPixels) {
+			if (padAmountPixels > std::min(widthPixels, heightPixels)) {
+				Logger::Error("padding cannot exceed smallest image dimension");
+				return std::vector<unsigned char>();
+			}
+
+			int newWidthPixels = 0, newHeightPixels = 0;
+			newWidthPixels = widthPixels + (padAmountPixels * 2);
+			newHeightPixels = heightPixels + (padAmountPixels * 2);
+			std::vector<unsigned char> outImage(newWidthPixels * newHeightPixels * 4);
+
+			// Fill the output image with the original image data.
+			for (int y = 0; y < heightPixels; ++y) {
+				for (int x = 0; x < widthPixels; ++x) {
+					auto oldImageComponentIndex = CartesianToComponentIndex(x, y, widthPixels);
+					auto outImageComponentIndex = CartesianToComponentIndex(x + padAmountPixels, y + padAmountPixels, newWidthPixels);
+					outImage[outImageComponentIndex] = image[oldImageComponentIndex];
+					outImage[outImageComponentIndex + 1] = image[oldImageComponentIndex + 1];
+					outImage[outImageComponentIndex + 2] = image[oldImageComponentIndex + 2];
+					outImage[outImageComponentIndex + 3] = image[oldImageComponentIndex + 3];
+				}
+			}
+
+			// Pad the upper and lower portions of the image by mirroring "padAmountPixels" from the upper and lower borders.
+			for (int yUpper = 0, yLower = heightPixels - 1, rowSampled = 0; rowSampled < padAmountPixels; ++yUpper, --yLower, ++rowSampled) {
+				int yNewUpper = padAmountPixels - rowSampled - 1;
+				int yNewLower = heightPixels + padAmountPixels + rowSampled;
+
+				for (int x = 0; x < widthPixels; ++x) {
+
+					// Mirror the upper pixel.
+					auto indexOfColorToCopy = CartesianToComponentIndex(x, yUpper, widthPixels);
+					auto indexOfOutImage = CartesianToComponentIndex(x + padAmountPixels, yNewUpper, newWidthPixels);
+					outImage[indexOfOutImage] = image[indexOfColorToCopy];
+					outImage[indexOfOutImage + 1] = image[indexOfColorToCopy + 1];
+					outImage[indexOfOutImage + 2] = image[indexOfColorToCopy + 2];
+					outImage[indexOfOutImage + 3] = image[indexOfColorToCopy + 3];
+
+					// Mirror the lower pixel.
+					indexOfColorToCopy = CartesianToComponentIndex(x, yLower, widthPixels);
+					indexOfOutImage = CartesianToComponentIndex(x + padAmountPixels, yNewLower, newWidthPixels);
+					outImage[indexOfOutImage] = image[indexOfColorToCopy];
+					outImage[indexOfOutImage + 1] = image[indexOfColorToCopy + 1];
+					outImage[indexOfOutImage + 2] = image[indexOfColorToCopy + 2];
+					outImage[indexOfOutImage + 3] = image[indexOfColorToCopy + 3];
+				}
+			}
+
+			// Pad the left and right portions of the image by mirroring "padAmountPixels" from the left and right borders.
+			for (int y = 0; y < newHeightPixels; ++y) {
+				for (int xLeft = padAmountPixels, xRight = widthPixels + padAmountPixels - 1, columnSampled = 0; columnSampled < padAmountPixels; ++xLeft, --xRight, ++columnSampled) {
+					int xNewLeft = padAmountPixels - columnSampled - 1;
+					int xNewRight = widthPixels + padAmountPixels + columnSampled;
+
+					// Mirror the left pixel.
+					auto sourceIndex = CartesianToComponentIndex(xLeft, y, newWidthPixels);
+					auto destinationIndex = CartesianToComponentIndex(xNewLeft, y, newWidthPixels);
+					outImage[destinationIndex] = outImage[sourceIndex];
+					outImage[destinationIndex + 1] = outImage[sourceIndex + 1];
+					outImage[destinationIndex + 2] = outImage[sourceIndex + 2];
+					outImage[destinationIndex + 3] = outImage[sourceIndex + 3];
+
+					// Mirror the right pixel.
+					sourceIndex = CartesianToComponentIndex(xRight, y, newWidthPixels);
+					destinationIndex = CartesianToComponentIndex(xNewRight, y, newWidthPixels);
+					outImage[destinationIndex] = outImage[sourceIndex];
+					outImage[destinationIndex + 1] = outImage[sourceIndex + 1];
+					outImage[destinationIndex + 2] = outImage[sourceIndex + 2];
+					outImage[destinationIndex + 3] = outImage[sourceIndex + 3];
+				}
+			}
+
+			return outImage;
+		}
+
+		std::vector<unsigned char> GetImageArea(std::vector<unsigned char> image, int widthPixels, int heightPixels, int xStart, int xFinish, int yStart, int yFinish) {
+			if (xStart < 0 || yStart < 0 || xFinish > widthPixels || yFinish > heightPixels || xStart >= xFinish || yStart >= yFinish) {
+				Logger::Error("invalid image range");
+				return std::vector<unsigned char>();
+			}
+
+			auto newWidthPixels = xFinish - xStart;
+			auto newHeightPixels = yFinish - yStart;
+			std::vector<unsigned char> outImage(newWidthPixels * newHeightPixels * 4);
+
+			// Fill the output image with the original image data.
+			for (int y = yStart, newY = 0; newY < newHeightPixels; ++y, ++newY) {
+				for (int x = xStart, newX = 0; newX < newWidthPixels; ++x, ++newX) {
+					auto oldImageComponentIndex = CartesianToComponentIndex(x, y, widthPixels);
+					auto outImageComponentIndex = CartesianToComponentIndex(newX, newY, newWidthPixels);
+					outImage[outImageComponentIndex] = image[oldImageComponentIndex];
+					outImage[outImageComponentIndex + 1] = image[oldImageComponentIndex + 1];
+					outImage[outImageComponentIndex + 2] = image[oldImageComponentIndex + 2];
+					outImage[outImageComponentIndex + 3] = image[oldImageComponentIndex + 3];
+				}
+			}
+
+			return outImage;
+		}
+
+		void LoadFromSphericalHDRI(std::filesystem::path imageFilePath) {
+			int wantedComponents = 4;
+			int componentsDetected;
+			int width;
+			int height;
+
+			// First, we load the spherical HDRi image.
+			// In the stbi_load() function, comp stands for components. In a PNG image, for example, there are 4 components 
+			// for each pixel: red, green, blue and alpha.
+			// The image's pixels are read and stored left to right, top to bottom, relative to the image.
+			// Each pixel's component is an unsigned char.
+			auto mipCount = 1;
+			for (auto resolution = _faceSizePixels; resolution > 1; resolution /= 2, ++mipCount) {}
+
+			_hdriImageData.resize(mipCount);
+
+			// The file is mapped and decoded straight from memory, and the whole of it is going to be read, so the OS is asked to load it all upfront.
+			MappedFile imageFile;
+			stbi_uc* lodZero = nullptr;
+			if (imageFile.Open(imageFilePath)) {
+				imageFile.WillNeed();
+				lodZero = stbi_load_from_memory(imageFile._pData, (int)imageFile._sizeBytes, &width, &height, &componentsDetected, wantedComponents);
+			}
+
+			if (!lodZero) {
+				std::string message = "failed loading environment map" + imageFilePath.string();
+				Exit(1, message.c_str());
+			}
+
+			auto sizeBytes = width * height * 4;
+			_hdriImageData[0].resize(sizeBytes);
+			memcpy(_hdriImageData[0].data(), lodZero, sizeBytes);
+			stbi_image_free(lodZero);
+			_hdriSizePixels.width = width;
+			_hdriSizePixels.height = height;
+
+			_front.push_back(GenerateFaceImage(CubeMapFace::FRONT, 0, width, height));
+			_right.push_back(GenerateFaceImage(CubeMapFace::RIGHT, 0, width, height));
+			_back.push_back(GenerateFaceImage(CubeMapFace::BACK, 0, width, height));
+			_left.push_back(GenerateFaceImage(CubeMapFace::LEFT, 0, width, height));
+			_upper.push_back(GenerateFaceImage(CubeMapFace::UPPER, 0, width, height));
+			_lower.push_back(GenerateFaceImage(CubeMapFace::LOWER, 0, width, height));
+
+			BoxBlur blurrer;
+			for (int width = _hdriSizePixels.width, height = _hdriSizePixels.height, radius = 2, i = 1; i < mipCount; width /= 2, height /= 2, radius *= 2, ++i) {
+				auto halfWidth = width / 2;
+				auto halfHeight = height / 2;
+				auto tmp = ResizeImage(_hdriImageData[i - 1], width, height, halfWidth, halfHeight);
+
+				int paddingAmountPixels = (int)((halfWidth / 100.0f) * 5.0f);
+				auto paddedWidth = halfWidth + (paddingAmountPixels * 2);
+				auto paddedHeight = halfHeight + (paddingAmountPixels * 2);
+				tmp = PadImage(tmp, halfWidth, halfHeight, paddingAmountPixels);
+
+				auto blurredImageData = blurrer.Run(_physicalDevice, _logicalDevice, tmp.data(), paddedWidth, paddedHeight, radius);
+
+				memcpy(tmp.data(), blurredImageData, paddedWidth * paddedHeight * 4);
+				_hdriImageData[i] = GetImageArea(tmp, paddedWidth, paddedHeight, paddingAmountPixels, halfWidth + paddingAmountPixels, paddingAmountPixels, halfHeight + paddingAmountPixels);
+
+				_front.push_back(GenerateFaceImage(CubeMapFace::FRONT, i, halfWidth, halfHeight));
+				_right.push_back(GenerateFaceImage(CubeMapFace::RIGHT, i, halfWidth, halfHeight));
+				_back.push_back(GenerateFaceImage(CubeMapFace::BACK, i, halfWidth, halfHeight));
+				_left.push_back(GenerateFaceImage(CubeMapFace::LEFT, i, halfWidth, halfHeight));
+				_upper.push_back(GenerateFaceImage(CubeMapFace::UPPER, i, halfWidth, halfHeight));
+				_lower.push_back(GenerateFaceImage(CubeMapFace::LOWER, i, halfWidth, halfHeight));
+			}
+
+			blurrer.Destroy();
+
+			//WriteImagesToFiles(Paths::TexturesPath()/"env_map");
+
+			//Logger::Log("Environment map " + imageFilePath.string() + " loaded.");
+		}
+
+		void CreateImage(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool& commandPool, VkQueue& queue) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Texture);
+			// Create the cubemap image.
+			auto& imageCreateInfo = _cubeMapImage._createInfo;
+			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageCreateInfo.arrayLayers = 6;
+			imageCreateInfo.extent = { (uint32_t)_faceSizePixels, (uint32_t)_faceSizePixels, 1 };
+			imageCreateInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+			imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageCreateInfo.mipLevels = 10;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			ResourceTracker::CreateImage(logicalDevice, &imageCreateInfo, nullptr, &_cubeMapImage._image);
+
+			// Allocate memory on the GPU for the image.
+			VkMemoryRequirements reqs;
+			vkGetImageMemoryRequirements(logicalDevice, _cubeMapImage._image, &reqs);
+			VkMemoryAllocateInfo imageAllocInfo{};
+			imageAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			imageAllocInfo.allocationSize = reqs.size;
+			imageAllocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			VkDeviceMemory mem;
+			ResourceTracker::AllocateMemory(logicalDevice, &imageAllocInfo, nullptr, &mem);
+			vkBindImageMemory(logicalDevice, _cubeMapImage._image, mem, 0);
+
+			auto& imageViewCreateInfo = _cubeMapImage._viewCreateInfo;
+			imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			imageViewCreateInfo.components = { {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY} };
+			imageViewCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+			imageViewCreateInfo.image = _cubeMapImage._image;
+			imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+			imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+			imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+			imageViewCreateInfo.subresourceRange.layerCount = 6;
+			imageViewCreateInfo.subresourceRange.levelCount = 10;
+			vkCreateImageView(_logicalDevice, &imageViewCreateInfo, nullptr, &_cubeMapImage._view);
+
+			auto& samplerCreateInfo = _cubeMapImage._samplerCreateInfo;
+			samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+			samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerCreateInfo.anisotropyEnable = false;
+			samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+			samplerCreateInfo.flags = 0;
+			samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+			samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+			samplerCreateInfo.maxLod = 10;
+			samplerCreateInfo.minLod = 0;
+			samplerCreateInfo.mipLodBias = 0.0f;
+			samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			vkCreateSampler(_logicalDevice, &samplerCreateInfo, nullptr, &_cubeMapImage._sampler);
+
+			auto commandBuffer = VkHelper::CreateCommandBuffer(logicalDevice, commandPool);
+			CopyFacesToImage(logicalDevice, physicalDevice, commandPool, commandBuffer, queue);
+		}
+
+		void CopyFacesToImage(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool& commandPool, VkCommandBuffer& commandBuffer, VkQueue& queue) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			auto faces = { _right, _left, _upper, _lower, _front, _back };
+			uint32_t resolution = _faceSizePixels;
+			uint32_t faceIndex = 0;
+
+			VkHelper::StartRecording(commandBuffer);
+
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_NONE;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.oldLayout = _cubeMapImage._currentLayout;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.image = _cubeMapImage._image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+			_cubeMapImage._currentLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			std::vector<Buffer> temporaryBuffers;
+
+			for (auto& face : faces) {
+				resolution = _faceSizePixels;
+
+				for (int mipmapIndex = 0; mipmapIndex < face.size(); ++mipmapIndex, resolution /= 2) {
+					// Create a temporary buffer.
+					Buffer stagingBuffer{};
+					stagingBuffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+					stagingBuffer._createInfo.size = face[mipmapIndex].size();
+					stagingBuffer._createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+					ResourceTracker::CreateBuffer(_logicalDevice, &stagingBuffer._createInfo, nullptr, &stagingBuffer._buffer);
+
+					// Allocate memory for the buffer.
+					VkMemoryRequirements requirements{};
+					vkGetBufferMemoryRequirements(_logicalDevice, stagingBuffer._buffer, &requirements);
+					stagingBuffer._gpuMemory = PhysicalDevice::AllocateMemory(physicalDevice, logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+					// Map memory to the correct GPU and CPU ranges for the buffer.
+					vkBindBufferMemory(_logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, 0);
+					vkMapMemory(_logicalDevice, stagingBuffer._gpuMemory, 0, face[mipmapIndex].size(), 0, &stagingBuffer._cpuMemory);
+					memcpy(stagingBuffer._cpuMemory, face[mipmapIndex].data(), face[mipmapIndex].size());
+
+					// Copy the buffer to the specific face by defining the subresource range.
+					VkBufferImageCopy copyInfo{};
+					copyInfo.bufferImageHeight = resolution;
+					copyInfo.bufferRowLength = resolution;
+					copyInfo.imageExtent = { resolution, resolution, 1 };
+					copyInfo.imageOffset = { 0,0,0 };
+					copyInfo.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					copyInfo.imageSubresource.layerCount = 1;
+					copyInfo.imageSubresource.baseArrayLayer = faceIndex;
+					copyInfo.imageSubresource.mipLevel = mipmapIndex;
+					vkCmdCopyBufferToImage(commandBuffer, stagingBuffer._buffer, _cubeMapImage._image, _cubeMapImage._currentLayout, 1, &copyInfo);
+
+					temporaryBuffers.push_back(stagingBuffer);
+				}
+
+				++faceIndex;
+			}
+
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barrier.oldLayout = _cubeMapImage._currentLayout;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.image = _cubeMapImage._image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+			_cubeMapImage._currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			VkHelper::StopRecording(commandBuffer);
+			VkHelper::ExecuteCommands(commandBuffer, queue);
+
+			// Destroy all the buffers used to move data to the cube map image.
+			for (auto& buffer : temporaryBuffers) {
+				vkUnmapMemory(_logicalDevice, buffer._gpuMemory);
+				ResourceTracker::FreeMemory(_logicalDevice, buffer._gpuMemory, nullptr);
+				ResourceTracker::DestroyBuffer(_logicalDevice, buffer._buffer, nullptr);
+			}
+		}
+
+		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
+			auto descriptorSetID = 4;
+
+			// Map the cubemap image to the fragment shader.
+			VkDescriptorPool descriptorPool{};
+			VkDescriptorPoolSize poolSizes[1] = { VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 } };
+			VkDescriptorPoolCreateInfo createInfo = {};
+			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			createInfo.maxSets = (uint32_t)1;
+			createInfo.poolSizeCount = (uint32_t)1;
+			createInfo.pPoolSizes = poolSizes;
+			ResourceTracker::CreateDescriptorPool(ctx._logicalDevice, &createInfo, nullptr, &descriptorPool);
+
+			// Create the descriptor set.
+			VkDescriptorSet set{};
+			VkDescriptorSetAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = descriptorPool;
+			allocInfo.descriptorSetCount = (uint32_t)1;
+			allocInfo.pSetLayouts = &layouts[descriptorSetID]._layout;
+			vkAllocateDescriptorSets(ctx._logicalDevice, &allocInfo, &set);
+
+			// Update the descriptor set's data with the environment map's image.
+			VkDescriptorImageInfo imageInfo{ _cubeMapImage._sampler, _cubeMapImage._view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkWriteDescriptorSet writeInfo = {};
+			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfo.dstSet = set;
+			writeInfo.descriptorCount = 1;
+			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writeInfo.pImageInfo = &imageInfo;
+			writeInfo.dstBinding = 0;
+			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+
+			auto descriptorSets = std::vector<VkDescriptorSet>{ set };
+			_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
+			return _shaderResources;
+		}
+
+		void UpdateShaderResources() {
+		}
+
+		void CreateVertexBuffer(VkContext& ctx) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Mesh);
+			//  _right, _left, _upper, _lower, _front, _back 
+			const unsigned int coordinateCount = 72;
+			float skyBoxVertices[coordinateCount] = {
+				// Back face (-Z)
+				-1.0f, -1.0f, -1.0f, // Vertex 0
+				1.0f, -1.0f, -1.0f, // Vertex 1
+				1.0f,  1.0f, -1.0f, // Vertex 2
+				-1.0f,  1.0f, -1.0f, // Vertex 3
+
+				// Front face (+Z)
+				-1.0f, -1.0f,  1.0f, // Vertex 4
+				1.0f, -1.0f,  1.0f, // Vertex 5
+				1.0f,  1.0f,  1.0f, // Vertex 6
+				-1.0f,  1.0f,  1.0f, // Vertex 7
+
+				// Left face (-X)
+				-1.0f, -1.0f,  1.0f, // Vertex 4
+				-1.0f, -1.0f, -1.0f, // Vertex 0
+				-1.0f,  1.0f, -1.0f, // Vertex 3
+				-1.0f,  1.0f,  1.0f, // Vertex 7
+
+				// Right face (+X)
+				1.0f, -1.0f, -1.0f, // Vertex 1
+				1.0f, -1.0f,  1.0f, // Vertex 5
+				1.0f,  1.0f,  1.0f, // Vertex 6
+				1.0f,  1.0f, -1.0f, // Vertex 2
+
+				// Bottom face (-Y)
+				-1.0f, -1.0f, -1.0f, // Vertex 0
+				-1.0f, -1.0f,  1.0f, // Vertex 4
+				1.0f, -1.0f,  1.0f, // Vertex 5
+				1.0f, -1.0f, -1.0f, // Vertex 1
+
+				// Top face (+Y)
+				-1.0f,  1.0f,  1.0f, // Vertex 7
+				-1.0f,  1.0f, -1.0f, // Vertex 3
+				1.0f,  1.0f, -1.0f, // Vertex 2
+				1.0f,  1.0f,  1.0f  // Vertex 6
+			};
+
+			// Create a temporary buffer.
+			auto& buffer = _vertices._vertexBuffer;
+			auto bufferSizeBytes = coordinateCount * sizeof(float);
+			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			buffer._createInfo.size = bufferSizeBytes;
+			buffer._createInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			ResourceTracker::CreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+
+			// Allocate memory for the buffer.
+			VkMemoryRequirements requirements{};
+			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
+			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, (VkMemoryPropertyFlagBits)(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+
+			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
+
+			// Map memory to the correct GPU and CPU ranges for the buffer.
+			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+
+			// Send the buffer to GPU.
+			buffer._pData = skyBoxVertices;
+			buffer._sizeBytes = bufferSizeBytes;
+			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, buffer._buffer, buffer._pData, buffer._sizeBytes);
+		}
+
+		void CreateIndexBuffer(VkContext& ctx) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Mesh);
+			//  _right, _left, _upper, _lower, _front, _back 
+			const unsigned int indexCount = 36;
+			uint32_t skyBoxFaceIndices[indexCount] = {
+
+				// Right face (+X)
+				1, 5, 6, // First triangle
+				6, 2, 1, // Second triangle
+
+				// Left face (-X)
+				4, 0, 3, // First triangle
+				3, 7, 4, // Second triangle
+
+				// Top face (+Y)
+				7, 3, 2, // First triangle
+				2, 6, 7,  // Second triangle
+
+				// Bottom face (-Y)
+				0, 4, 5, // First triangle
+				5, 1, 0, // Second triangle
+
+				// Front face (+Z)
+				6, 5, 4, // First triangle
+				6, 4, 7, // Second triangle
+
+				// Back face (-Z)
+				0, 1, 2, // First triangle
+				2, 3, 0 // Second triangle
+			};
+
+			// Create a temporary buffer.
+			auto& buffer = _faceIndices._indexBuffer;
+			auto bufferSizeBytes = indexCount * sizeof(uint32_t);
+			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			buffer._createInfo.size = bufferSizeBytes;
+			buffer._createInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			ResourceTracker::CreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+
+			// Allocate memory for the buffer.
+			VkMemoryRequirements requirements{};
+			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
+			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, (VkMemoryPropertyFlagBits)(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+
+			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
+
+			// Map memory to the correct GPU and CPU ranges for the buffer.
+			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+
+			// Send the buffer to GPU.
+			buffer._pData = skyBoxFaceIndices;
+			buffer._sizeBytes = bufferSizeBytes;
+			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, buffer._buffer, buffer._pData, buffer._sizeBytes);
+		}
+
+		void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) {
+			VkDescriptorSet sets[2] = { _shaderResources[0][0], _shaderResources[4][0] };
+			vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, sets, 0, nullptr);
+			vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &sets[1], 0, nullptr);
+
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(drawCommandBuffer, 0, 1, &_vertices._vertexBuffer._buffer, &offset);
+			vkCmdBindIndexBuffer(drawCommandBuffer, _faceIndices._indexBuffer._buffer, 0, VkIndexType::VK_INDEX_TYPE_UINT32);
+			vkCmdDrawIndexed(drawCommandBuffer, 36, 1, 0, 0, 0);
+		}
+	};
+
+	// Forward declarations for the compiler.
+	class GameObject;
+	class Scene;
+	class RigidBody;
+	class Mesh;
+	class Camera;
+
+	struct CollisionContext {
+		RigidBody* _collidee; // Collision receiver.
+		std::vector<glm::vec4> _collisionPositions; // List of points where a collision was detected in world space. W component discarded, only there for efficiency reasons, only there for efficiency reasons with CPU-GPU interop.
+		std::vector<glm::vec4> _collisionNormals; // List of normals for each collision position. W component discarded, only there for efficiency reasons with CPU-GPU interop.
+		std::vector<RigidBody*> _collisionObjects; // List of objects for which the collision was detected.
+		glm::vec4 _averagePosition;
+		glm::vec4 _averageNormal;
+
+		void CalculateAverages() {
+			auto count = _collisionPositions.size();
+
+			for (int j = 0; j < count; ++j) {
+				_averageNormal += _collisionNormals[j];
+				_averagePosition += _collisionPositions[j];
+			}
+
+			_averagePosition /= count; _averageNormal /= count;
+		}
+	};
+
+	struct EngineContext;
+
+	/**
+		 * @brief Used by implementing classes to mark themselves as a class that is meant to do work on the main loop of the physics thread.
+		 */
+	class IPhysicsUpdatable {
+	public:
+
+		/**
+		 * @brief Function called on implementing classes in each iteration of the main loop.
+		 */
+		virtual void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) = 0;
+	};
+
+	class Time : public Singleton<Time>, public IUpdatable, public IPhysicsUpdatable {
+	public:
+
+		/**
+		 * @brief The time this instance was created; assigned to in the constructor.
+		 */
+		std::chrono::high_resolution_clock::time_point _timeStart;
+
+		/**
+		 * @brief Time last frame started.
+		 */
+		std::chrono::high_resolution_clock::time_point _lastUpdateTime;
+
+		/**
+		 * @brief Time last physics update happened.
+		 */
+		std::chrono::high_resolution_clock::time_point _lastPhysicsUpdateTime;
+
+		/**
+		 * @brief The amount of time since last frame started in milliseconds.
+		 */
+		double _deltaTime;
+
+		/**
+		 * @brief The amount of time since the last physics simulation update in milliseconds.
+		 */
+		double _physicsDeltaTime;
+
+		/**
+		 * @brief Fixed physics update time in milliseconds.
+		 * The engine will wait for (_fixedPhysicsDeltaTime - _physicsDeltaTime) milliseconds if _physicsDeltaTime is lower than this number.
+		 */
+		double _fixedPhysicsDeltaTime = 16;
+
+		/**
+		 * @brief When set, frames and physics updates advance by _fixedPhysicsDeltaTime instead of by the time that actually passed, so that runs such as
+		 * benchmarks simulate the same steps every time.
+		 */
+		bool _isFixedStep = false;
+
+		/**
+		 * @brief Constructor.
+		 */
+		Time() {
+			_timeStart = std::chrono::high_resolution_clock::now();
+			_deltaTime = 0.0;
+			_physicsDeltaTime = 0.0;
+			_lastUpdateTime = _timeStart;
+			_lastPhysicsUpdateTime = _timeStart;
+		}
+
+		/**
+		 * @brief See IUpdatable.
+		 */
+		void Update() {
+			auto now = std::chrono::high_resolution_clock::now();
+			_deltaTime = _isFixedStep ? _fixedPhysicsDeltaTime : (now - _lastUpdateTime).count() * 0.000001;
+			_lastUpdateTime = now;
+		}
+
+		/**
+		 * @brief See IPhysicsUpdatable.
+		 */
+		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
+			auto now = std::chrono::high_resolution_clock::now();
+			_physicsDeltaTime = _isFixedStep ? _fixedPhysicsDeltaTime : (now - _lastPhysicsUpdateTime).count() * 0.000001;
+			_lastPhysicsUpdateTime = now;
+		}
+	};
+
+	/**
+	 * @brief Caps the frame rate of the main loop, which saves CPU and GPU time when frames are done early and keeps frame times even. Sleeps can end
+	 * later than asked, so Wait sleeps a millisecond at a time only while more time is left than a sleep has been seen to take, and spins for the
+	 * rest. On Windows sleeps use a high resolution waitable timer, as plain sleeps last at least a scheduler tick.
+	 */
+	class FramePacer {
+	public:
+
+		FramePacer() {
+#ifdef _WIN32
+			_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+		}
+
+		~FramePacer() {
+#ifdef _WIN32
+			if (_timer != nullptr) CloseHandle(_timer);
+#endif
+		}
+
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		/**
+		 * @brief Waits until a frame is due, 1 / maxFramesPerSecond seconds after the previous one was. Returns at once if maxFramesPerSecond is 0.
+		 * A frame that ran late is not made up for by shortening the next ones.
+		 */
+		void Wait(uint32_t maxFramesPerSecond) {
+			auto now = std::chrono::steady_clock::now();
+			if (maxFramesPerSecond == 0) {
+				_lastFrameTime = now;
+				return;
+			}
+
+			Profiler::ScopedZone zone("Frame pacing");
+			auto dueTime = std::max(_lastFrameTime + std::chrono::nanoseconds(1000000000 / maxFramesPerSecond), now);
+			while (dueTime - std::chrono::steady_clock::now() > std::chrono::duration<double, std::milli>(_sleepMilliseconds + std::sqrt(_sleepMillisecondsVariance))) {
+				auto sleepStart = std::chrono::steady_clock::now();
+				SleepOneMillisecond();
+				auto sleepMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sleepStart).count();
+				auto difference = sleepMilliseconds - _sleepMilliseconds;
+				_sleepMilliseconds += difference * 0.05;
+				_sleepMillisecondsVariance = (1.0 - 0.05) * (_sleepMillisecondsVariance + 0.05 * difference * difference);
+			}
+			while (std::chrono::steady_clock::now() < dueTime) _mm_pause();
+			_lastFrameTime = dueTime;
+		}
+
+	private:
+
+		std::chrono::steady_clock::time_point _lastFrameTime;
+
+		/**
+		 * @brief How long a one millisecond sleep has been seen to take, and its variance. Starts out pessimistic, so the first frames spin more.
+		 */
+		double _sleepMilliseconds = 2.0;
+		double _sleepMillisecondsVariance = 0.0;
+
+#ifdef _WIN32
+		HANDLE _timer = nullptr;
+#endif
+
+		void SleepOneMillisecond() {
+#ifdef _WIN32
+			if (_timer != nullptr) {
+				// Negative due times are relative, in 100 nanosecond units.
+				LARGE_INTEGER dueTime;
+				dueTime.QuadPart = -10000;
+				if (SetWaitableTimer(_timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+					WaitForSingleObject(_timer, INFINITE);
+					return;
+				}
+			}
+#endif
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	};
+
+	/*struct ForceCtx {
+		glm::vec3 _force;
+		glm::vec3 _pointOfApplication;
+		float _deltaTimeSeconds;
+		bool _isTorque = false;
+		bool _ignoreMass = false;
+		bool _isApplicationPointWorldSpace = true;
+		bool _isForceWorldSpace = true;
+
+		ForceCtx(glm::vec3 force = glm::vec3(0.0f), glm::vec3 pointOfApplication = glm::vec3(0.0f), float deltaTimeSeconds = 0.0f, bool isTorque = false, bool ignoreMass = false, bool isApplicationPointWorldSpace = true, bool isForceWorldSpace = true) :
+			_force(force),
+			_pointOfApplication(pointOfApplication),
+			_deltaTimeSeconds(deltaTimeSeconds),
+			_isTorque(isTorque),
+			_ignoreMass(ignoreMass),
+			_isApplicationPointWorldSpace(isApplicationPointWorldSpace),
+			_isForceWorldSpace(isForceWorldSpace)
+		{
+		}
+	};*/
+
+	glm::vec3 gGravity = glm::vec3(0.0f, -10.0f, 0.0f);
+
+	/**
+	 * @brief Base class for a body that performs physics simulation.
+	 */
+	class RigidBody : public IPhysicsUpdatable {
+	public:
+
+		/**
+		 * @brief Whether the body is initialized and valid for simulation.
+		 */
+		bool _isInitialized = false;
+
+		/**
+		 * @brief True if collision detection and resolution is enabled for the body.
+		 */
+		bool _isCollidable = false;
+
+		/**
+		 * @brief The velocity vector of this physics body in units per second in world space.
+		 */
+		glm::vec3 _velocity = glm::vec3(0.0f, 0.0f, 0.0f);
+
+		/**
+		 * @brief The angular velocity in radians per second. The direction of the vector represents the axis of rotation in world space, whereas the
+		 * length of the vector is the actual value in radians per second.
+		 */
+		glm::vec3 _angularVelocity = glm::vec3(0.0f, 0.0f, 0.0f);
+
+		glm::vec3 _lastAngularVelocity = glm::vec3(0.0f, 0.0f, 0.0f);
+
+		/**
+		 * @brief Mass in kg.
+		 */
+		float _mass;
+
+		/**
+		 * @brief Friction coefficient. Adjust depending on in-engine behaviour.
+		 */
+		float _friction;
+
+		/**
+		 * @brief Level of detail of the mesh used for collision detection. Coarser levels are cheaper collision proxies.
+		 */
+		uint32_t _collisionLod = 0;
+
+		/**
+		 * @brief Bounciness coefficient. Adjust depending on in-engine behaviour.
+		 */
+		float _bounciness;
+
+		/**
+		 * @brief If this is set to true, _overriddenCenterOfMass will be used as center of mass.
+		 */
+		bool _isCenterOfMassOverridden;
+
+		/**
+		 * @brief Overridden center of mass in local space.
+		 */
+		glm::vec3 _overriddenCenterOfMassLocalSpace;
+
+		/**
+		 * @brief Lock rotation along the X axis.
+		 */
+		bool _lockRotationX;
+
+		/**
+		 * @brief Lock rotation along the Y axis.
+		 */
+		bool _lockRotationY;
+
+		/**
+		 * @brief Lock rotation along the Z axis.
+		 */
+		bool _lockRotationZ;
+
+		/**
+		 * @brief Lock translation along the X axis.
+		 */
+		bool _lockTranslationX;
+
+		/**
+		 * @brief Lock translation along the Y axis.
+		 */
+		bool _lockTranslationY;
+
+		/**
+		 * @brief Lock translation along the Z axis.
+		 */
+		bool _lockTranslationZ;
+
+		bool _isAffectedByGravity;
+
+		/**
+		 * @brief The cutoff time after which a collision becomes continuous or stops being continuous.
+		 */
+		int _continuousCollisionThresholdMilliseconds = 100;
+
+		/**
+		 * @brief The maximum time allowed between an angular velocity oscillation and another. If an oscillation happens quicker than this time, it is considered twitching.
+		 */
+		int _twitchingDetectionThresholdMilliseconds = 150;
+
+		std::chrono::high_resolution_clock::time_point _lastTimeCollided;
+
+		/**
+		 * @brief Last time an angular velocity oscillation was detected.
+		 */
+		std::chrono::high_resolution_clock::time_point _lastTimeTwitched;
+
+		/**
+		 * @brief Number of times twitching was detected, increased when an angular velocity oscillation is detected and happens within the twitching time threshold from the last oscillation.
+		 */
+		int _twitchCount;
+
+		/**
+		 * @brief Twitch count threshold. If the twitch count is above this number, the angular velocity and the velocity are both set to zero, as it is assumed that the
+		 * object is at a resting position, and keeps chaning angular velocity really quickly due to collision detection and response inaccuracies.
+		 */
+		int _twitchCountThreshold = 3;
+
+		float _maxAngularSpeed = 5.0f;
+
+		/**
+		 * @brief True if the body has been colliding for longer than the continuous collision threshold, and false if it has not been colliding for longer than said threshold.
+		 */
+		bool _isColliding = false;
+
+		/**
+		 * @brief Physics update implementation for this specific rigidbody.
+		 */
+		void(*_updateImplementation)(GameObject&);
+
+		/**
+		 * @brief GameObject tied to this RigidBody.
+		 */
+		GameObject* _pGameObject;
+
+		/**
+		 * @brief Map where the key is the index of a vertex in _pMesh, and the value is a list of vertex indices directly connected to the vertex represented by the key.
+		 */
+		 //std::map<unsigned int, std::vector<unsigned int>> _neighbors;
+
+		 /**
+		  * @brief Constructor.
+		  */
+		RigidBody() = default;
+
+		/*inline std::ostream& operator<< (std::ostream& stream, const glm::vec3& vector)
+		{
+			return stream << "(" << vector.x << ", " << vector.y << ", " << vector.z << ")";
+		}*/
+
+		static glm::vec3 CalculateTransmittedForce(const glm::vec3& transmitterPosition, const glm::vec3& force, const glm::vec3& receiverPosition);
+
+		/**
+		 * @brief Returns the center of mass in local space.
+		 * @return
+		 */
+		glm::vec3 GetCenterOfMass(bool worldSpace = false);
+
+		glm::vec3 GetVelocityAtPosition(const glm::vec3& position);
+
+		void AddForceAtPosition(const glm::vec3& force, const glm::vec3& pointOfApplication, const float& deltaTimeSeconds, bool isApplicationPointWorldSpace = true, bool isForceWorldSpace = true, const bool& ignoreMass = false);
+
+		void AddForce(const glm::vec3& force, const float& deltaTimeSeconds, const bool& ignoreMass = false);
+
+		void AddTorque(const glm::vec3& torqueWorldSpaceAxis, const float& deltaTimeSeconds, const bool& ignoreMass = false);
+
+		CollisionContext DetectCollision(RigidBody& other);
+
+		std::vector< GameObject*> GetGameObjects(GameObject* pRoot, std::vector<GameObject*> excludedObjects = {});
+
+		std::vector<CollisionContext> DetectCollisions(VkContext& ctx, VkContext& collisionCtx, std::vector<RigidBody*> bodiesToExclude = {});
+
+		/**
+		 * @brief Basic init that guarantees the body's simulation.
+		 */
+		void Initialize(GameObject* pGameObject, const float& mass = 1.0f, const bool& overrideCenterOfMass = false, const glm::vec3& overriddenCenterOfMass = glm::vec3{});
+
+		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx);
+
+		bool IsRotationLocked();
+
+		bool IsTranslationLocked();
+
+		void LockRotation();
+
+		void LockTranslation();
+
+		void UnlockRotation();
+
+		void UnlockTranslation();
+	};
+
+	/**
+	 * @brief Represents a three-dimensional axis-aligned bounding box.
+	 */
+	class BoundingBox {
+	public:
+
+		/**
+		 * @brief Low bound, or more accurately, the position whose components are all the lowest number calculated from a collection of positions.
+		 */
+		glm::vec3 _min = glm::vec3(FLT_MAX);
+
+		/**
+		 * @brief High bound, or more accurately, the position whose components are all the highest number calculated from a collection of positions.
+		 */
+		glm::vec3 _max = glm::vec3(-FLT_MAX);
+
+		glm::vec3 GetCenter() const {
+			return glm::vec3((_min.x + _max.x) * 0.5f, (_min.y + _max.y) * 0.5f, (_min.z + _max.z) * 0.5f);
+		}
+
+		/**
+		 * @brief Returns the half size of the box along each axis.
+		 */
+		glm::vec3 GetExtents() const {
+			return (_max - _min) * 0.5f;
+		}
+
+		/**
+		 * @brief A box is empty when it does not contain any position, which is the case for a default constructed box.
+		 */
+		bool IsEmpty() const {
+			return _min.x > _max.x || _min.y > _max.y || _min.z > _max.z;
+		}
+
+		/**
+		 * @brief Returns the smallest box that contains both a and b.
+		 */
+		static BoundingBox Merge(const BoundingBox& a, const BoundingBox& b) {
+			BoundingBox outBox;
+			outBox._min = glm::min(a._min, b._min);
+			outBox._max = glm::max(a._max, b._max);
+			return outBox;
+		}
+
+		/**
+		 * @brief Returns the axis-aligned box that contains this box after being transformed by the given matrix.
+		 * Uses Arvo's method, so the 8 corners of the box don't need to be transformed one by one.
+		 */
+		BoundingBox Transformed(const glm::mat4& matrix) const {
+			if (IsEmpty()) return *this;
+
+			BoundingBox outBox;
+			auto translation = glm::vec3(matrix[3]);
+			outBox._min = translation;
+			outBox._max = translation;
+
+			for (int column = 0; column < 3; ++column) {
+				for (int row = 0; row < 3; ++row) {
+					float a = matrix[column][row] * _min[column];
+					float b = matrix[column][row] * _max[column];
+					outBox._min[row] += std::min(a, b);
+					outBox._max[row] += std::max(a, b);
+				}
+			}
+
+			return outBox;
+		}
+
+		static BoundingBox Create(const Mesh& mesh);
+	};
+
+	/**
+	 * @brief Represents a bounding sphere, mostly used for quick rejection tests before testing tighter bounds.
+	 */
+	class BoundingSphere {
+	public:
+
+		glm::vec3 _center = glm::vec3(0.0f);
+
+		/**
+		 * @brief Radius of the sphere. A negative radius means the sphere is empty.
+		 */
+		float _radius = -1.0f;
+
+		static BoundingSphere Create(const BoundingBox& box) {
+			BoundingSphere outSphere;
+			if (box.IsEmpty()) return outSphere;
+			outSphere._center = box.GetCenter();
+			outSphere._radius = glm::length(box.GetExtents());
+			return outSphere;
+		}
+	};
+
+	class Mesh : public IVulkanUpdatable, public IDrawable, public IPipelineable {
+
+	public:
+
+		Mesh() = default;
+		~Mesh();
+		int _materialIndex = 0;
+
+		/**
+		 * @brief Whether the vertices and indices of the mesh are on the GPU and it can be drawn. False while a streamed scene is still uploading it.
+		 */
+		bool _isResident = true;
+
+		/**
+		 * @brief Game object the mesh was first loaded for. Meshes are shared by all game objects that reference the same glTF mesh, so this is not necessarily the only user.
+		 */
+		GameObject* _pGameObject = nullptr;
+
+		/**
+		 * @brief Bounds of the vertices of this mesh, in the space the vertices are defined in.
+		 */
+		BoundingBox _bounds;
+
+		/**
+		 * @brief A level of detail: a range of the index buffer that draws a simplified version of the mesh.
+		 */
+		struct Lod {
+			uint32_t _firstIndex;
+			uint32_t _indexCount;
+
+			/**
+			 * @brief How far, at most, the simplified surface is from the full detail surface, in the space the vertices are defined in.
+			 */
+			float _error;
+
+			/**
+			 * @brief Range of _meshlets that the faces of the level are split into.
+			 */
+			uint32_t _firstMeshlet;
+			uint32_t _meshletCount;
+		};
+
+		/**
+		 * @brief A cluster of neighbouring faces, small enough to be culled on its own: a range of the index buffer with the bounds of its faces.
+		 */
+		struct Meshlet {
+			/**
+			 * @brief Bounding sphere of the faces, in the space the vertices are defined in.
+			 */
+			glm::vec3 _center;
+			float _radius;
+
+			/**
+			 * @brief Normal cone of the faces: the faces all look away from any viewer for which dot(_center - viewer, _coneAxis) is at least
+			 * _coneCutoff * length(_center - viewer) + _radius. A cutoff of 1 means the faces cannot be culled that way.
+			 */
+			glm::vec3 _coneAxis;
+			float _coneCutoff;
+
+			uint32_t _firstIndex;
+			uint32_t _indexCount;
+		};
+
+		/**
+		 * @brief Levels of detail, from full detail to coarsest. All of them use the same vertices. When empty, the whole index buffer is the only level.
+		 */
+		std::vector<Lod> _lods;
+
+		/**
+		 * @brief Meshlets of all the levels of detail, each level owning the range given by its Lod.
+		 */
+		std::vector<Meshlet> _meshlets;
+
+		/**
+		 * @brief Returns the level of detail at lodIndex, or the coarsest one if there are fewer levels.
+		 */
+		Lod GetLod(size_t lodIndex) const {
+			if (_lods.size() == 0) return Lod{ 0, (uint32_t)_faceIndices._indexData.size(), 0.0f, 0, 0 };
+			return _lods[std::min(lodIndex, _lods.size() - 1)];
+		}
+
+		/**
+		 * @brief Returns the coarsest level of detail whose error, projected on screen by camera for a mesh drawn with objectToWorld, stays within
+		 * the error allowed by the global settings. The mesh is assumed to be as close to the camera as its bounds allow.
+		 */
+		size_t SelectLod(const glm::mat4& objectToWorld, Camera& camera) const;
+
+		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts);
+		void UpdateShaderResources();
+		void Update(VkContext& vkContext);
+		void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer);
+
+		/**
+		 * @brief Binds the descriptor set containing the textures of the material of this mesh.
+		 */
+		void BindMaterial(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer);
+
+		/**
+		 * @brief Draws instanceCount copies of the level of detail lodIndex of the mesh, reading per instance data starting at firstInstance from the buffer
+		 * bound to vertex input binding 1. The material must have been bound beforehand, either with BindMaterial or through the material table.
+		 */
+		void DrawInstanced(VkCommandBuffer& drawCommandBuffer, uint32_t instanceCount, uint32_t firstInstance, size_t lodIndex = 0);
+	};
+
+	/**
+	 * @brief Represents a physical object in a celeritas-engine scene.
+	 */
+	class GameObject : public IVulkanUpdatable, public IPipelineable, public IDrawable {
+	public:
+
+		/**
+		 * @brief Name of the game object.
+		 */
+		std::string _name;
+
+		/**
+		 * @brief Pointer to the scene so you can use _materialIndex and _gameObjectIndex from this class.
+		 */
+		Scene* _pScene = nullptr;
+
+		/**
+		 * @brief Parent game object pointer.
+		 */
+		GameObject* _pParent = nullptr;
+
+		/**
+		 * @brief Child game object pointers.
+		 */
+		std::vector<GameObject*> _children;
+
+		/**
+		 * @brief Mesh of this game object.
+		 */
+		Mesh* _pMesh = nullptr;
+
+		/**
+		 * @brief Body for physics simulation.
+		 */
+		RigidBody* _pBody;
+
+		/**
+		 * @brief Transform relative to the parent gameobject.
+		 */
+		Transform _localTransform;
+
+		/**
+		 * @brief World space transform, computed on the CPU in Update. Read by UpdateBounds and copied to the GPU by MeshInstancer and GpuDrivenScene.
+		 */
+		struct {
+			glm::mat4x4 transform;
+		} _gameObjectData;
+
+		/**
+		 * @brief World space bounds of the mesh of this game object. Empty if the game object has no mesh.
+		 */
+		BoundingBox _worldBounds;
+
+		/**
+		 * @brief Sphere enclosing _worldBounds.
+		 */
+		BoundingSphere _worldSphere;
+
+		/**
+		 * @brief World space bounds of the meshes of this game object and all of its descendants.
+		 */
+		BoundingBox _subtreeBounds;
+
+		/**
+		 * @brief Sphere enclosing _subtreeBounds.
+		 */
+		BoundingSphere _subtreeSphere;
+
+		GameObject() = default;
+		GameObject(const std::string& name, Scene* pScene);
+		~GameObject();
+		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts);
+		Transform GetWorldSpaceTransform();
+		void UpdateShaderResources();
+		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx);
+		void Update(VkContext& vkContext);
+
+		/**
+		 * @brief Recalculates the world space bounds of this game object and its whole subtree. Relies on _gameObjectData.transform, so it should be called after Update.
+		 */
+		void UpdateBounds();
+	};
+
+	struct GpuCollisionDetector {
+		static int GetComputeQueueFamilyIndex(const VkPhysicalDevice& physicalDevice) {
+			//find a queue family for a selected GPU, select the first available for use
+			uint32_t queueFamilyCount;
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, NULL);
+
+			VkQueueFamilyProperties* queueFamilies = (VkQueueFamilyProperties*)malloc(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
+
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies);
+			uint32_t i = 0;
+			for (; i < queueFamilyCount; i++) {
+				VkQueueFamilyProperties props = queueFamilies[i];
+				if (props.queueCount > 0 && (props.queueFlags & VK_QUEUE_COMPUTE_BIT)) break;
+			}
+			free(queueFamilies);
+			if (i == queueFamilyCount) return -1;
+			return i;
+		}
+
+		static void CreateNewComputeDevice(VkDevice& device, VkPhysicalDevice& physicalDevice, VkDevice& outComputeDevice, VkQueue& outComputeQueue, uint32_t& outComputeQueueFamilyIndex) {
+			int computeFamilyIndex = GetComputeQueueFamilyIndex(physicalDevice);
+			if (computeFamilyIndex < 0) return;
+
+			float queuePriorities = 1.0;
+			VkDeviceQueueCreateInfo deviceQueueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO, 0, (VkDeviceQueueCreateFlags)0, (uint32_t)computeFamilyIndex,(uint32_t)1, (const float*)&queuePriorities };
+
+			VkPhysicalDeviceFeatures physicalDeviceFeatures = { 0 };
+			//physicalDeviceFeatures.shaderFloat64 = VK_TRUE;//this enables double precision support in shaders 
+
+			VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+					0,
+					(VkDeviceCreateFlags)0,
+					(uint32_t)1,
+					(const VkDeviceQueueCreateInfo*)&deviceQueueCreateInfo,
+					(uint32_t)0,
+					(const char* const*)NULL,
+					(uint32_t)0,
+					(const char* const*)NULL,
+					(const VkPhysicalDeviceFeatures*)&physicalDeviceFeatures };
+
+			CheckResult(vkCreateDevice(physicalDevice, &deviceCreateInfo, NULL, &outComputeDevice));
+			outComputeQueueFamilyIndex = computeFamilyIndex;
+
+			vkGetDeviceQueue(outComputeDevice, computeFamilyIndex, 0, &outComputeQueue);
+			if (!outComputeQueue) { Logger::Error("failed to get compute queue"); return; }
+		}
+
+		static VkContext InitializeVulkan(VkDevice& device, VkPhysicalDevice physicalDevice) {
+			// Create logical device representation.
+			VkContext ctx;
+			ctx._physicalDevice = physicalDevice;
+			CreateNewComputeDevice(device, physicalDevice, ctx._logicalDevice, ctx._queue, ctx._queueFamilyIndex);
+			if (!ctx._logicalDevice) { Logger::Error("failed to create compute device"); return {}; }
+
+			// Create a fence for synchronization.
+			VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, 0 };
+			if (vkCreateFence(ctx._logicalDevice, &fenceCreateInfo, NULL, &ctx._queueFence)) { Logger::Error("fence creation failed"); }
+
+			// Create a structure from which command buffer memory is allocated from.
+			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, NULL, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, ctx._queueFamilyIndex };
+			if (vkCreateCommandPool(ctx._logicalDevice, &commandPoolCreateInfo, NULL, &ctx._commandPool)) { Logger::Error("command pool creation failed"); }
+
+			// Same physical device as the rendering device, so the data saved by the rendering device is valid here too. Only the rendering device writes it back.
+			ctx._pipelineCache.Create(ctx._logicalDevice, ctx._physicalDevice, Paths::PipelineCachePath());
+			return ctx;
+		}
+
+		static std::vector<uint32_t> CalculateWorkGroupCount(VkPhysicalDeviceProperties& gpuProperties, uint32_t minimumThreadCount, const std::vector<uint32_t>& workGroupSize) {
+			// Prepare variables.
+			uint32_t maxWorkGroupInvocations = gpuProperties.limits.maxComputeWorkGroupInvocations;
+			uint32_t* maxWorkGroupSize = gpuProperties.limits.maxComputeWorkGroupSize;
+			uint32_t* maxWorkGroupCount = gpuProperties.limits.maxComputeWorkGroupCount;
+			std::vector<uint32_t> outWorkGroupCount = { 1, 1, 1 };
+
+			// Use the work group size first, as that directly controls the amount of threads 1 to 1.
+			uint32_t totalWorkGroupSize = workGroupSize[0] * workGroupSize[1] * workGroupSize[2];
+			if (totalWorkGroupSize >= minimumThreadCount) return outWorkGroupCount;
+
+			// If one workgroup still doesn't do it, use multiple workgroups with the size of each one calculated earlier.
+			if (totalWorkGroupSize < minimumThreadCount) {
+				for (int i = 0; i < 3; ++i) {
+					for (; outWorkGroupCount[i] < maxWorkGroupCount[i]; ++outWorkGroupCount[i]) {
+						if (((outWorkGroupCount[0] * outWorkGroupCount[1] * outWorkGroupCount[2]) * totalWorkGroupSize) >= minimumThreadCount) { return outWorkGroupCount; }
+					}
+				}
+			}
+
+			return { 0,0,0 };
+		}
+
+		static VkResult AllocateGPUOnlyBuffer(VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize bufferSizeBytes, VkContext& ctx, VkBuffer* outBuffer, VkDeviceMemory* outDeviceMemory) {
+			//allocate the buffer used by the GPU with specified properties
+			VkResult res = VK_SUCCESS;
+			uint32_t queueFamilyIndices;
+			VkBufferCreateInfo bufferCreateInfo;
+			bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferCreateInfo.pNext = 0;
+			bufferCreateInfo.flags = (VkBufferCreateFlags)0;
+			bufferCreateInfo.size = (VkDeviceSize)bufferSizeBytes;
+			bufferCreateInfo.usage = (VkBufferUsageFlags)bufferUsageFlags;
+			bufferCreateInfo.sharingMode = (VkSharingMode)VK_SHARING_MODE_EXCLUSIVE;
+			bufferCreateInfo.queueFamilyIndexCount = (uint32_t)1;
+			bufferCreateInfo.pQueueFamilyIndices = (const uint32_t*)&queueFamilyIndices;
+
+			res = ResourceTracker::CreateBuffer(ctx._logicalDevice, &bufferCreateInfo, NULL, outBuffer);
+			if (res != VK_SUCCESS) return res;
+
+			VkMemoryRequirements memoryRequirements = { 0 };
+			vkGetBufferMemoryRequirements(ctx._logicalDevice, *outBuffer, &memoryRequirements);
+
+			//find memory with specified properties
+			uint32_t memoryTypeIndex = 0xFFFFFFFF;
+			VkPhysicalDeviceMemoryProperties gpuMemoryProps;
+			vkGetPhysicalDeviceMemoryProperties(ctx._physicalDevice, &gpuMemoryProps);
+
+			for (uint32_t i = 0; i < gpuMemoryProps.memoryTypeCount; ++i) {
+				if ((memoryRequirements.memoryTypeBits & (1 << i)) && ((gpuMemoryProps.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)) {
+					memoryTypeIndex = i;
+					break;
+				}
+			}
+			if (0xFFFFFFFF == memoryTypeIndex) return VK_ERROR_INITIALIZATION_FAILED;
+
+			VkMemoryAllocateInfo memoryAllocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+										 0,
+										 (VkDeviceSize)memoryRequirements.size,
+										 (uint32_t)memoryTypeIndex };
+
+			res = ResourceTracker::AllocateMemory(ctx._logicalDevice, &memoryAllocateInfo, NULL, outDeviceMemory);
+			if (res != VK_SUCCESS) return res;
+
+			res = vkBindBufferMemory(ctx._logicalDevice, *outBuffer, *outDeviceMemory, 0);
+			return res;
+		}
+
+		static VkResult CreateComputePipeline(VkBuffer* shaderBuffersArray, VkDeviceSize* arrayOfSizesOfEachBuffer, const char* shaderFilePath, VkContext& ctx, VkPipeline& outPipeline, VkPipelineLayout& outLayout, VkDescriptorSet& outDescriptorSet, VkDescriptorPool& outDescriptorPool) {
+			VkResult res = VK_SUCCESS;
+
+			// We now have 5 buffers: vertexA, indexA, vertexB, indexB, result
+			uint32_t descriptorCount = 5;
+
+			VkDescriptorPoolSize descriptorPoolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descriptorCount };
+
+			const VkDescriptorType descriptorTypes[5] = {
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // vertex A
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // index A
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // vertex B
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // index B
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER  // output
+			};
+
+			VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, 1, 1, &descriptorPoolSize };
+			CheckResult(ResourceTracker::CreateDescriptorPool(ctx._logicalDevice, &descriptorPoolCreateInfo, nullptr, &outDescriptorPool));
+
+			VkDescriptorSetLayoutBinding* descriptorSetLayoutBindings = (VkDescriptorSetLayoutBinding*)malloc(descriptorCount * sizeof(VkDescriptorSetLayoutBinding));
+			for (uint32_t i = 0; i < descriptorCount; ++i) {
+				descriptorSetLayoutBindings[i].binding = i;
+				descriptorSetLayoutBindings[i].descriptorType = descriptorTypes[i];
+				descriptorSetLayoutBindings[i].descriptorCount = 1;
+				descriptorSetLayoutBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+				descriptorSetLayoutBindings[i].pImmutableSamplers = nullptr;
+			}
+
+			VkDescriptorSetLayout descriptorSetLayout;
+			VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+				VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, descriptorCount, descriptorSetLayoutBindings
+			};
+			CheckResult(vkCreateDescriptorSetLayout(ctx._logicalDevice, &descriptorSetLayoutCreateInfo, nullptr, &descriptorSetLayout));
+			free(descriptorSetLayoutBindings);
+
+			VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, outDescriptorPool, 1, &descriptorSetLayout };
+
+			CheckResult(vkAllocateDescriptorSets(ctx._logicalDevice, &descriptorSetAllocateInfo, &outDescriptorSet));
+
+			for (uint32_t i = 0; i < descriptorCount; ++i) {
+				VkDescriptorBufferInfo descriptorBufferInfo = { shaderBuffersArray[i], 0, arrayOfSizesOfEachBuffer[i] };
+				VkWriteDescriptorSet writeDescriptorSet = {
+					VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, outDescriptorSet, i, 0, 1,
+					descriptorTypes[i], nullptr, &descriptorBufferInfo, nullptr
+				};
+				vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeDescriptorSet, 0, nullptr);
+			}
+
+			VkPushConstantRange range = {};
+			range.offset = 0;
+			range.size = 144;
+			range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+				VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO, nullptr, 0, 1, &descriptorSetLayout, 1, &range
+			};
+			CheckResult(vkCreatePipelineLayout(ctx._logicalDevice, &pipelineLayoutCreateInfo, nullptr, &outLayout));
+
+			VkShaderModule shaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, shaderFilePath);
+
+			VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo = {
+				VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT,
+				shaderModule, "main", nullptr
+			};
+
+			VkComputePipelineCreateInfo computePipelineCreateInfo = {
+				VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+				pipelineShaderStageCreateInfo, outLayout, VK_NULL_HANDLE, 0
+			};
+
+			res = vkCreateComputePipelines(ctx._logicalDevice, ctx._pipelineCache._handle, 1, &computePipelineCreateInfo, nullptr, &outPipeline);
+			vkDestroyDescriptorSetLayout(ctx._logicalDevice, descriptorSetLayout, nullptr);
+			return res;
+		}
+
+		static void Dispatch(VkContext& ctx, VkPipeline pipeline, VkPipelineLayout pipelineLayout,
+			VkDescriptorSet descriptorSet, std::vector<uint32_t>& workGroupCount,
+			const glm::mat4x4& objectToWorldA, const glm::mat4x4& objectToWorldB, uint32_t& objectAnormal) {
+
+			// Define push constants structure matching the shader
+			struct PushConstants {
+				glm::mat4x4 localToWorldA;
+				glm::mat4x4 localToWorldB;
+				uint32_t objectAnormal;
+			} pushConstants;
+			pushConstants.localToWorldA = objectToWorldA;
+			pushConstants.localToWorldB = objectToWorldB;
+			pushConstants.objectAnormal = objectAnormal;
+
+			// Record compute shader pipeline commands
+			auto commandBuffer = VkHelper::CreateCommandBuffer(ctx._logicalDevice, ctx._commandPool);
+			VkHelper::StartRecording(commandBuffer);
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+			vkCmdDispatch(commandBuffer, workGroupCount[0], workGroupCount[1], workGroupCount[2]);
+			VkHelper::StopRecording(commandBuffer);
+
+			// Submit the command buffer
+			VkSubmitInfo submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffer;
+			Profiler::ScopedZone zone("GPU collision detection");
+			CheckResult(vkQueueSubmit(ctx._queue, 1, &submitInfo, ctx._queueFence));
+			CheckResult(vkWaitForFences(ctx._logicalDevice, 1, &ctx._queueFence, VK_TRUE, 30000000000));
+
+			// Reset fence and free command buffer
+			CheckResult(vkResetFences(ctx._logicalDevice, 1, &ctx._queueFence));
+			vkFreeCommandBuffers(ctx._logicalDevice, ctx._commandPool, 1, &commandBuffer);
+		}
+
+		static CollisionContext Run(VkContext& collisionCtx, RigidBody& bodyA, RigidBody& bodyB, bool& outCollided) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Collision);
+			// Get device properties and memory properties, if needed.
+			VkPhysicalDeviceProperties gpuProperties;
+			VkPhysicalDeviceMemoryProperties gpuMemoryProperties;
+			vkGetPhysicalDeviceProperties(collisionCtx._physicalDevice, &gpuProperties);
+			vkGetPhysicalDeviceMemoryProperties(collisionCtx._physicalDevice, &gpuMemoryProperties);
+
+			RigidBody* a = &bodyA;
+			RigidBody* b = &bodyB;
+			uint32_t objectAnormal = 0;
+
+			if (a->_pGameObject->_pMesh->_vertices._vertexData.size() < b->_pGameObject->_pMesh->_vertices._vertexData.size()) {
+				auto tmp = b;
+				b = a;
+				a = tmp;
+				objectAnormal = 1;
+			}
+
+			auto& aVertices = a->_pGameObject->_pMesh->_vertices._vertexData;
+			auto& bVertices = b->_pGameObject->_pMesh->_vertices._vertexData;
+
+			// Each body collides with the level of detail of its mesh chosen as its collision proxy.
+			auto aLod = a->_pGameObject->_pMesh->GetLod(a->_collisionLod);
+			auto bLod = b->_pGameObject->_pMesh->GetLod(b->_collisionLod);
+			auto pIndicesA = a->_pGameObject->_pMesh->_faceIndices._indexData.data() + aLod._firstIndex;
+			auto pIndicesB = b->_pGameObject->_pMesh->_faceIndices._indexData.data() + bLod._firstIndex;
+
+			size_t sizeA_bytes = aVertices.size() * sizeof(glm::vec4);
+			size_t sizeB_bytes = bVertices.size() * sizeof(glm::vec4);
+			size_t sizeIndexA_bytes = aLod._indexCount * sizeof(uint32_t);
+			size_t sizeIndexB_bytes = bLod._indexCount * sizeof(uint32_t);
+
+			auto faceCount = aLod._indexCount / 3;
+			auto outputCount = faceCount * 2;
+			size_t sizeOutputBytes = sizeof(glm::vec4) * outputCount;
+			glm::vec4* dataInputBufferA = (glm::vec4*)malloc(sizeA_bytes);
+			glm::vec4* dataInputBufferB = (glm::vec4*)malloc(sizeB_bytes);
+			if (!dataInputBufferA || !dataInputBufferB) { Logger::Error("failed allocating buffers for input meshes"); return {}; }
+
+			for (int i = 0; i < aVertices.size(); ++i) {
+				dataInputBufferA[i].x = aVertices[i]._position.x;
+				dataInputBufferA[i].y = aVertices[i]._position.y;
+				dataInputBufferA[i].z = aVertices[i]._position.z;
+				dataInputBufferA[i].w = 1.0f;
+			}
+			for (int i = 0; i < bVertices.size(); ++i) {
+				dataInputBufferB[i].x = bVertices[i]._position.x;
+				dataInputBufferB[i].y = bVertices[i]._position.y;
+				dataInputBufferB[i].z = bVertices[i]._position.z;
+				dataInputBufferB[i].w = 1.0f;
+			}
+
+			std::vector <uint32_t> workGroupCount = CalculateWorkGroupCount(gpuProperties, (uint32_t)faceCount, { 8, 8, 8 });
+
+			// Create all the buffers.
+			VkResult res = VK_SUCCESS;
+			Buffer vertexBufferA, indexBufferA, vertexBufferB, indexBufferB, outputBuffer;
+
+			VkHelper::CreateBuffer(collisionCtx._logicalDevice,
+				collisionCtx._physicalDevice,
+				sizeA_bytes,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&vertexBufferA._buffer,
+				&vertexBufferA._gpuMemory);
+
+			VkHelper::CreateBuffer(collisionCtx._logicalDevice, collisionCtx._physicalDevice, sizeIndexA_bytes,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&indexBufferA._buffer, &indexBufferA._gpuMemory);
+
+			VkHelper::CreateBuffer(collisionCtx._logicalDevice,
+				collisionCtx._physicalDevice,
+				sizeB_bytes,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&vertexBufferB._buffer,
+				&vertexBufferB._gpuMemory);
+
+			VkHelper::CreateBuffer(collisionCtx._logicalDevice, collisionCtx._physicalDevice, sizeIndexB_bytes,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&indexBufferB._buffer, &indexBufferB._gpuMemory);
+
+			VkHelper::CreateBuffer(collisionCtx._logicalDevice,
+				collisionCtx._physicalDevice,
+				sizeOutputBytes,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&outputBuffer._buffer,
+				&outputBuffer._gpuMemory);
+
+			VkBuffer buffers[5] = {
+				vertexBufferA._buffer,
+				indexBufferA._buffer,
+				vertexBufferB._buffer,
+				indexBufferB._buffer,
+				outputBuffer._buffer
+			};
+			VkDeviceSize bufferSizes[5] = {
+				sizeA_bytes,
+				sizeIndexA_bytes,
+				sizeB_bytes,
+				sizeIndexB_bytes,
+				sizeOutputBytes
+			};
+
+			// Create 
+			//const char* shaderPath = "C:\\code\\vulkan-compute\\shaders\\Shader.spv";
+			auto shaderPath = Paths::ShadersPath() /= L"compute\\CollisionDetection.spv";
+			VkPipeline pipeline; VkPipelineLayout layout; VkDescriptorSet descriptorSet; VkDescriptorPool descriptorPool;
+			if (CreateComputePipeline(buffers, bufferSizes, shaderPath.string().c_str(), collisionCtx, pipeline, layout, descriptorSet, descriptorPool) != VK_SUCCESS) {
+				Logger::Error("application creation failed");
+			}
+
+			auto aTransform = a->_pGameObject->GetWorldSpaceTransform()._matrix;
+			auto bTransform = b->_pGameObject->GetWorldSpaceTransform()._matrix;
+
+			// Transfer data to GPU staging buffer and thereafter sync the staging buffer with GPU local memory.
+			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, vertexBufferA._buffer, dataInputBufferA, sizeA_bytes);
+			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, indexBufferA._buffer, pIndicesA, sizeIndexA_bytes);
+			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, vertexBufferB._buffer, dataInputBufferB, sizeB_bytes);
+			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, indexBufferB._buffer, pIndicesB, sizeIndexB_bytes);
+
+			Dispatch(collisionCtx, pipeline, layout, descriptorSet, workGroupCount, aTransform, bTransform, objectAnormal);
+
+			auto shaderOutputBufferData = (glm::vec4*)malloc(sizeOutputBytes);
+			VkHelper::DownloadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queueFence, collisionCtx._queue,
+				sizeOutputBytes,
+				outputBuffer._buffer,
+				shaderOutputBufferData);
+			
+			// Convert GPU results into collision context info
+			CollisionContext outCollisionCtx;
+			for (int i = 0; i < faceCount; ++i) {
+				if (shaderOutputBufferData[i].x == 3.402823466e+38f &&
+					shaderOutputBufferData[i].y == 3.402823466e+38f &&
+					shaderOutputBufferData[i].z == 3.402823466e+38f &&
+					shaderOutputBufferData[i].w == 3.402823466e+38f &&
+					shaderOutputBufferData[i + faceCount].x == 3.402823466e+38f &&
+					shaderOutputBufferData[i + faceCount].y == 3.402823466e+38f &&
+					shaderOutputBufferData[i + faceCount].z == 3.402823466e+38f &&
+					shaderOutputBufferData[i + faceCount].w == 3.402823466e+38f)
+					continue;
+				outCollided = true;
+				outCollisionCtx._collidee = &bodyB;
+				outCollisionCtx._collisionPositions.push_back(shaderOutputBufferData[i]);
+				outCollisionCtx._collisionNormals.push_back(shaderOutputBufferData[i + faceCount]);
+				outCollisionCtx._collisionObjects.push_back(shaderOutputBufferData[i].w == 0.0f ? a : b);
+			}
+
+			// Clean up
+			vkDestroyPipeline(collisionCtx._logicalDevice, pipeline, nullptr);
+			vkDestroyPipelineLayout(collisionCtx._logicalDevice, layout, nullptr);
+			ResourceTracker::DestroyDescriptorPool(collisionCtx._logicalDevice, descriptorPool, nullptr);
+
+			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, vertexBufferA._buffer, vertexBufferA._gpuMemory, false);
+			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, indexBufferA._buffer, indexBufferA._gpuMemory, false);
+			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, vertexBufferB._buffer, vertexBufferB._gpuMemory, false);
+			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, indexBufferB._buffer, indexBufferB._gpuMemory, false);
+			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, outputBuffer._buffer, outputBuffer._gpuMemory, false);
+
+			free(shaderOutputBufferData);
+			free(dataInputBufferA);
+			free(dataInputBufferB);
+
+			return outCollisionCtx;
+		}
+	};
 
-					// This calculates at which pixel from the left (for U) and from the top (for V)
-					// we need to fetch from the spherical HDRi.
-					auto coordinateU = uCoordinate * width;
-					auto coordinateV = (1.0f - vCoordinate) * height;
+	/**
+	 * @brief Represents a celeritas-engine scene.
+	 */
+	class Scene : public IVulkanUpdatable, public IPipelineable {
 
-					int pixelNumberU = (int)ceil(coordinateU);
-					if (pixelNumberU >= width || pixelNumberU < 0) {
-						pixelNumberU = (int)floor(coordinateU);
-						if (pixelNumberU >= width || pixelNumberU < 0) {
-							continue;
-						}
-					}
+	public:
+		/**
+		 * @brief Collection of point lights.
+		 */
+		std::vector<PointLight> _pointLights;
 
-					int pixelNumberV = (int)ceil(coordinateV);
-					if (pixelNumberV >= height || pixelNumberU < 0) {
-						pixelNumberV = (int)floor(coordinateV);
-						if (pixelNumberV >= height || pixelNumberV < 0) {
-							continue;
-						}
-					}
+		/**
+		 * @brief Game object hierarchy.
+		 */
+		GameObject* _pRootGameObject;
 
-					// This calculates the index into the spherical HDRi image accounting for 2 things:
-					// 1) the pixel numbers calculated above
-					// 2) the fact that each pixel is actually stored in 4 separate cells that represent
-					//    each channel of each individual pixel. The channels used are always 4 (RGBA).
-					int componentIndex = CartesianToComponentIndex(pixelNumberU, pixelNumberV, width);
+		/**
+		 * @brief Collection of materials.
+		 */
+		std::vector<Material> _materials;
 
-					// Fetch the channels from the spherical HDRi based on the calculations made above.
-					auto red = _hdriImageData[mipIndex][componentIndex];
-					auto green = _hdriImageData[mipIndex][componentIndex + 1];
-					auto blue = _hdriImageData[mipIndex][componentIndex + 2];
-					auto alpha = _hdriImageData[mipIndex][componentIndex + 3];
+		/**
+		 * @brief Unique textures used by _materials.
+		 */
+		TextureRegistry _textures;
 
-					// Assign the color fetched from the HDRi to the cube map face's image we want to generate.
-					int faceComponentIndex = (x + (sizePixels * y)) * 4;
-					outImage[faceComponentIndex] = red;
-					outImage[faceComponentIndex + 1] = green;
-					outImage[faceComponentIndex + 2] = blue;
-					outImage[faceComponentIndex + 3] = alpha;
-				}
-			}
+		/**
+		 * @brief Meshes of the scene, one per primitive of the glTF file they were loaded from, indexed like the primitive records of the cooked file.
+		 * Game objects that reference the same glTF mesh share the same Meshes.
+		 */
+		std::vector<Mesh*> _meshes;
 
-			return outImage;
-		}
+		/**
+		 * @brief Cooked scene file the scene was loaded from. It is kept mapped because the texture data of the materials points into it.
+		 */
+		std::shared_ptr<MappedFile> _pCookedFile;
 
-		void WriteImagesToFiles(std::filesystem::path absoluteFolderPath) {
-			if (!std::filesystem::exists(absoluteFolderPath)) {
-				if (std::filesystem::is_directory(absoluteFolderPath)) {
-					std::filesystem::create_directories(absoluteFolderPath);
-				}
-				else {
-					Logger::Log("provided path is not valid");
-					return;
-				}
-			}
+		/**
+		 * @brief Environment map used for image-based lighting.
+		 */
+		CubicalEnvironmentMap _environmentMap;
 
-			auto mipmapIndex = 1;
-			auto resolution = _faceSizePixels;
-			auto faces = { &_front, &_right, &_back, &_left, &_upper, &_lower };
-			for (auto resolution = _faceSizePixels, radius = 2; resolution > 1; resolution /= 2, radius *= 2) {
+		/**
+		 * @brief Default constructor.
+		 */
+		Scene() = default;
 
-				int j = 0;
-				for (auto face : faces) {
-					auto halfResolution = resolution / 2;
+		Scene(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice) {
+			_materials.push_back(Material(logicalDevice, physicalDevice));
+			_pRootGameObject = new GameObject("Root", this);
+		}
 
-					auto path = absoluteFolderPath / (std::string("face_") + std::to_string(j) + "_" + std::to_string(mipmapIndex) + ".png");
-					auto ptr = (*face)[mipmapIndex].data();
-					stbi_write_png(path.string().c_str(), halfResolution, halfResolution, 4, ptr, halfResolution * 4);
-					++j;
-				}
+		/**
+		 * @brief Points every game object of the hierarchy to this scene. Needed after copying a scene, since the game objects are shared by the copies.
+		 */
+		void AdoptGameObjects() {
+			std::function<void(GameObject*)> adopt = [&](GameObject* pGameObject) {
+				pGameObject->_pScene = this;
+				for (auto& child : pGameObject->_children) adopt(child);
+			};
+			adopt(_pRootGameObject);
+		}
 
-				mipmapIndex++;
+		Material DefaultMaterial() {
+			if (_materials.size() <= 0) {
+				Logger::Error("a scene object should always have at least a default material");
+				std::exit(1);
 			}
+			return _materials[0];
 		}
 
-		CubicalEnvironmentMap() = default;
+		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
+			for (auto& gameObject : _pRootGameObject->_children)
+				gameObject->PhysicsUpdate(ctx, collisionCtx, eCtx);
+		}
 
-		CubicalEnvironmentMap(VkPhysicalDevice& physicalDevice, VkDevice& logicalDevice) {
-			_physicalDevice = physicalDevice;
-			_logicalDevice = logicalDevice;
-			_faceSizePixels = 512;
+		void Update(VkContext& vkContext) {
+			for (auto& light : _pointLights)
+				light.Update(vkContext);
+
+			for (auto& gameObject : _pRootGameObject->_children)
+				gameObject->Update(vkContext);
 		}
 
-		std::vector<unsigned char> ResizeImage(std::vector<unsigned char> image, int oldWidthPixels, int oldHeightPixels, int newWidthPixels, int newHeightPixels) {
-			std::vector<unsigned char> outImage(newWidthPixels * newHeightPixels * 4);
-			int ratioX = oldWidthPixels / newWidthPixels;
-			int ratioY = oldHeightPixels / newHeightPixels;
-			int oldImageX = 0;
-			int oldImageY = 0;
-			int newImageX = 0;
-			int newImageY = 0;
+		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
+			// The default material is created without a queue to upload it with, so it is sent to the GPU here, before any mesh uses it.
+			auto& defaultMaterial = _materials[0];
+			for (auto& map : defaultMaterial._maps) TextureRegistry::Upload(ctx, map);
 
-			for (; newImageY < newHeightPixels; ++newImageY) {
-				newImageX = 0;
-				for (; newImageX < newWidthPixels; ++newImageX) {
-					auto oldImageComponentIndex = CartesianToComponentIndex(newImageX * ratioX, newImageY * ratioY, oldWidthPixels);
-					auto newImageComponentIndex = CartesianToComponentIndex(newImageX, newImageY, newWidthPixels);
-					outImage[newImageComponentIndex] = image[oldImageComponentIndex];
-					outImage[newImageComponentIndex + 1] = image[oldImageComponentIndex + 1];
-					outImage[newImageComponentIndex + 2] = image[oldImageComponentIndex + 2];
-					outImage[newImageComponentIndex + 3] = image[oldImageComponentIndex + 3];
-				}
+			for (auto& gameObject : _pRootGameObject->_children) {
+				auto gameObjectResources = gameObject->CreateDescriptorSets(ctx, layouts);
+				_shaderResources.MergeResources(gameObjectResources);
 			}
 
-			return outImage;
+			for (auto& light : _pointLights) {
+				auto lightResources = light.CreateDescriptorSets(ctx, layouts);
+				_shaderResources.MergeResources(lightResources);
+				light.UpdateShaderResources();
+			}
+
+			auto environmentMapResources = _environmentMap.CreateDescriptorSets(ctx, layouts);
+			_shaderResources.MergeResources(environmentMapResources);
+			return _shaderResources;
 		}
 
-		std::vector<unsigned char> PadImage(std::vector<unsigned char> image, int widthPixels, int heightPixels, int padAmountPixels) {
-			if (padAmountPixels > std::min(widthPixels, heightPixels)) {
-				Logger::Log("padding cannot exceed smallest image dimension");
-				return std::vector<unsigned char>();
-			}
+		void UpdateShaderResources() {
+			// TODO
+		}
+	};
 
-			int newWidthPixels = 0, newHeightPixels = 0;
-			newWidthPixels = widthPixels + (padAmountPixels * 2);
-			newHeightPixels = heightPixels + (padAmountPixels * 2);
-			std::vector<unsigned char> outImage(newWidthPixels * newHeightPixels * 4);
+	// GameObject
+	GameObject::GameObject(const std::string& name, Scene* pScene) {
+		_name = name;
+		_pScene = pScene;
+	}
 
-			// Fill the output image with the original image data.
-			for (int y = 0; y < heightPixels; ++y) {
-				for (int x = 0; x < widthPixels; ++x) {
-					auto oldImageComponentIndex = CartesianToComponentIndex(x, y, widthPixels);
-					auto outImageComponentIndex = CartesianToComponentIndex(x + padAmountPixels, y + padAmountPixels, newWidthPixels);
-					outImage[outImageComponentIndex] = image[oldImageComponentIndex];
-					outImage[outImageComponentIndex + 1] = image[oldImageComponentIndex + 1];
-					outImage[outImageComponentIndex + 2] = image[oldImageComponentIndex + 2];
-					outImage[outImageComponentIndex + 3] = image[oldImageComponentIndex + 3];
-				}
-			}
+	GameObject::~GameObject()
+	{
+		if (_pBody)
+			delete _pBody;
+	}
 
-			// Pad the upper and lower portions of the image by mirroring "padAmountPixels" from the upper and lower borders.
-			for (int yUpper = 0, yLower = heightPixels - 1, rowSampled = 0; rowSampled < padAmountPixels; ++yUpper, --yLower, ++rowSampled) {
-				int yNewUpper = padAmountPixels - rowSampled - 1;
-				int yNewLower = heightPixels + padAmountPixels + rowSampled;
+	ShaderResources GameObject::CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
+		// Game objects have no descriptor sets of their own: their transform reaches the vertex shader through the instance buffer of MeshInstancer,
+		// or the object buffer of GpuDrivenScene. Only the material of the mesh is bound with a descriptor set.
+		if (_pMesh) {
+			auto meshResources = _pMesh->CreateDescriptorSets(ctx, layouts);
+			_shaderResources.MergeResources(meshResources);
+		}
 
-				for (int x = 0; x < widthPixels; ++x) {
+		for (auto& child : _children) {
+			auto childResources = child->CreateDescriptorSets(ctx, layouts);
+		}
 
-					// Mirror the upper pixel.
-					auto indexOfColorToCopy = CartesianToComponentIndex(x, yUpper, widthPixels);
-					auto indexOfOutImage = CartesianToComponentIndex(x + padAmountPixels, yNewUpper, newWidthPixels);
-					outImage[indexOfOutImage] = image[indexOfColorToCopy];
-					outImage[indexOfOutImage + 1] = image[indexOfColorToCopy + 1];
-					outImage[indexOfOutImage + 2] = image[indexOfColorToCopy + 2];
-					outImage[indexOfOutImage + 3] = image[indexOfColorToCopy + 3];
+		return _shaderResources;
+	}
 
-					// Mirror the lower pixel.
-					indexOfColorToCopy = CartesianToComponentIndex(x, yLower, widthPixels);
-					indexOfOutImage = CartesianToComponentIndex(x + padAmountPixels, yNewLower, newWidthPixels);
-					outImage[indexOfOutImage] = image[indexOfColorToCopy];
-					outImage[indexOfOutImage + 1] = image[indexOfColorToCopy + 1];
-					outImage[indexOfOutImage + 2] = image[indexOfColorToCopy + 2];
-					outImage[indexOfOutImage + 3] = image[indexOfColorToCopy + 3];
-				}
-			}
+	Transform GameObject::GetWorldSpaceTransform() {
+		// Each ancestor's transform is applied to what is below it, up to and including the root.
+		Transform outTransform = _localTransform;
+		for (GameObject* current = _pParent; current != nullptr; current = current->_pParent) outTransform._matrix = current->_localTransform._matrix * outTransform._matrix;
+		return outTransform;
+	}
 
-			// Pad the left and right portions of the image by mirroring "padAmountPixels" from the left and right borders.
-			for (int y = 0; y < newHeightPixels; ++y) {
-				for (int xLeft = padAmountPixels, xRight = widthPixels + padAmountPixels - 1, columnSampled = 0; columnSampled < padAmountPixels; ++xLeft, --xRight, ++columnSampled) {
-					int xNewLeft = padAmountPixels - columnSampled - 1;
-					int xNewRight = widthPixels + padAmountPixels + columnSampled;
+	void GameObject::UpdateShaderResources() {
+		_gameObjectData.transform = GetWorldSpaceTransform()._matrix;
+	}
 
-					// Mirror the left pixel.
-					auto sourceIndex = CartesianToComponentIndex(xLeft, y, newWidthPixels);
-					auto destinationIndex = CartesianToComponentIndex(xNewLeft, y, newWidthPixels);
-					outImage[destinationIndex] = outImage[sourceIndex];
-					outImage[destinationIndex + 1] = outImage[sourceIndex + 1];
-					outImage[destinationIndex + 2] = outImage[sourceIndex + 2];
-					outImage[destinationIndex + 3] = outImage[sourceIndex + 3];
+	void GameObject::PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
+		if (!_pBody) return;
+		if (!_pBody->_isCollidable || (_pBody->IsTranslationLocked() && _pBody->IsRotationLocked())) return;
+		_pBody->PhysicsUpdate(ctx, collisionCtx, eCtx);
+	}
+
+	void GameObject::Update(VkContext& vkContext) {
+		if (_pMesh != nullptr) {
+			_pMesh->Update(vkContext);
+		}
+
+		UpdateShaderResources();
+
+		for (auto& child : _children) {
+			child->Update(vkContext);
+		}
+	}
 
-					// Mirror the right pixel.
-					sourceIndex = CartesianToComponentIndex(xRight, y, newWidthPixels);
-					destinationIndex = CartesianToComponentIndex(xNewRight, y, newWidthPixels);
-					outImage[destinationIndex] = outImage[sourceIndex];
-					outImage[destinationIndex + 1] = outImage[sourceIndex + 1];
-					outImage[destinationIndex + 2] = outImage[sourceIndex + 2];
-					outImage[destinationIndex + 3] = outImage[sourceIndex + 3];
-				}
-			}
+	void GameObject::UpdateBounds() {
+		_worldBounds = BoundingBox();
+		if (_pMesh != nullptr) _worldBounds = _pMesh->_bounds.Transformed(_gameObjectData.transform);
+		_subtreeBounds = _worldBounds;
 
-			return outImage;
+		for (auto& child : _children) {
+			child->UpdateBounds();
+			_subtreeBounds = BoundingBox::Merge(_subtreeBounds, child->_subtreeBounds);
 		}
 
-		std::vector<unsigned char> GetImageArea(std::vector<unsigned char> image, int widthPixels, int heightPixels, int xStart, int xFinish, int yStart, int yFinish) {
-			if (xStart < 0 || yStart < 0 || xFinish > widthPixels || yFinish > heightPixels || xStart >= xFinish || yStart >= yFinish) {
-				Logger::Log("invalid image range");
-				return std::vector<unsigned char>();
-			}
+		_worldSphere = BoundingSphere::Create(_worldBounds);
+		_subtreeSphere = BoundingSphere::Create(_subtreeBounds);
+	}
 
-			auto newWidthPixels = xFinish - xStart;
-			auto newHeightPixels = yFinish - yStart;
-			std::vector<unsigned char> outImage(newWidthPixels * newHeightPixels * 4);
+	Mesh::~Mesh()
+	{
+		// TODO
+	}
 
-			// Fill the output image with the original image data.
-			for (int y = yStart, newY = 0; newY < newHeightPixels; ++y, ++newY) {
-				for (int x = xStart, newX = 0; newX < newWidthPixels; ++x, ++newX) {
-					auto oldImageComponentIndex = CartesianToComponentIndex(x, y, widthPixels);
-					auto outImageComponentIndex = CartesianToComponentIndex(newX, newY, newWidthPixels);
-					outImage[outImageComponentIndex] = image[oldImageComponentIndex];
-					outImage[outImageComponentIndex + 1] = image[oldImageComponentIndex + 1];
-					outImage[outImageComponentIndex + 2] = image[oldImageComponentIndex + 2];
-					outImage[outImageComponentIndex + 3] = image[oldImageComponentIndex + 3];
-				}
-			}
+	// Mesh
+	ShaderResources Mesh::CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
+		auto descriptorSetID = 3;
 
-			return outImage;
-		}
+		// Meshes can be shared by several game objects, the material only needs to be bound once.
+		if (_shaderResources._data.size() > 0) return _shaderResources;
 
-		void LoadFromSphericalHDRI(std::filesystem::path imageFilePath) {
-			int wantedComponents = 4;
-			int componentsDetected;
-			int width;
-			int height;
+		// Meshes with the same material share its descriptor set. The textures were sent to the GPU when they were added to the scene.
+		auto pScene = _pGameObject->_pScene;
+		auto& material = pScene->_materials[_materialIndex];
+		if (material._descriptorSet == VK_NULL_HANDLE) material.CreateDescriptorSet(ctx, layouts[descriptorSetID]._layout, pScene->_materials[0]);
+		_images = material.GetMaps(pScene->_materials[0]);
 
-			// First, we load the spherical HDRi image.
-			// In the stbi_load() function, comp stands for components. In a PNG image, for example, there are 4 components 
-			// for each pixel: red, green, blue and alpha.
-			// The image's pixels are read and stored left to right, top to bottom, relative to the image.
-			// Each pixel's component is an unsigned char.
-			auto mipCount = 1;
-			for (auto resolution = _faceSizePixels; resolution > 1; resolution /= 2, ++mipCount) {}
+		auto descriptorSets = std::vector<VkDescriptorSet>{ material._descriptorSet };
+		_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
+		return _shaderResources;
+	}
 
-			_hdriImageData.resize(mipCount);
-			auto lodZero = stbi_load(imageFilePath.string().c_str(), &width, &height, &componentsDetected, wantedComponents);
+	void Mesh::UpdateShaderResources() {
+		// TODO
+	}
 
-			if (!lodZero) {
-				std::string message = "failed loading environment map" + imageFilePath.string();
-				Exit(1, message.c_str());
-			}
+	void Mesh::Update(VkContext& vkContext) {
+		// Vertices are uploaded once in the vertex layout of the global settings when the vertex buffer is created, and never change afterwards.
+	}
 
-			auto sizeBytes = width * height * 4;
-			_hdriImageData[0].resize(sizeBytes);
-			memcpy(_hdriImageData[0].data(), lodZero, sizeBytes);
-			_hdriSizePixels.width = width;
-			_hdriSizePixels.height = height;
+	void Mesh::Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) {
+		VkDescriptorSet sets[] = { _shaderResources[3][0] };
+		vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3, 1, sets, 0, nullptr);
 
-			_front.push_back(GenerateFaceImage(CubeMapFace::FRONT, 0, width, height));
-			_right.push_back(GenerateFaceImage(CubeMapFace::RIGHT, 0, width, height));
-			_back.push_back(GenerateFaceImage(CubeMapFace::BACK, 0, width, height));
-			_left.push_back(GenerateFaceImage(CubeMapFace::LEFT, 0, width, height));
-			_upper.push_back(GenerateFaceImage(CubeMapFace::UPPER, 0, width, height));
-			_lower.push_back(GenerateFaceImage(CubeMapFace::LOWER, 0, width, height));
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(drawCommandBuffer, 0, 1, &_vertices._vertexBuffer._buffer, &offset);
+		vkCmdBindIndexBuffer(drawCommandBuffer, _faceIndices._indexBuffer._buffer, 0, _faceIndices._indexType);
+		vkCmdDrawIndexed(drawCommandBuffer, GetLod(0)._indexCount, 1, 0, 0, 0);
+	}
 
-			BoxBlur blurrer;
-			for (int width = _hdriSizePixels.width, height = _hdriSizePixels.height, radius = 2, i = 1; i < mipCount; width /= 2, height /= 2, radius *= 2, ++i) {
-				auto halfWidth = width / 2;
-				auto halfHeight = height / 2;
-				auto tmp = ResizeImage(_hdriImageData[i - 1], width, height, halfWidth, halfHeight);
+	void Mesh::BindMaterial(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) {
+		VkDescriptorSet sets[] = { _shaderResources[3][0] };
+		vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3, 1, sets, 0, nullptr);
+	}
 
-				int paddingAmountPixels = (int)((halfWidth / 100.0f) * 5.0f);
-				auto paddedWidth = halfWidth + (paddingAmountPixels * 2);
-				auto paddedHeight = halfHeight + (paddingAmountPixels * 2);
-				tmp = PadImage(tmp, halfWidth, halfHeight, paddingAmountPixels);
+	void Mesh::DrawInstanced(VkCommandBuffer& drawCommandBuffer, uint32_t instanceCount, uint32_t firstInstance, size_t lodIndex) {
+		auto lod = GetLod(lodIndex);
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(drawCommandBuffer, 0, 1, &_vertices._vertexBuffer._buffer, &offset);
+		vkCmdBindIndexBuffer(drawCommandBuffer, _faceIndices._indexBuffer._buffer, 0, _faceIndices._indexType);
+		vkCmdDrawIndexed(drawCommandBuffer, lod._indexCount, instanceCount, lod._firstIndex, 0, firstInstance);
+	}
 
-				auto blurredImageData = blurrer.Run(_physicalDevice, _logicalDevice, tmp.data(), paddedWidth, paddedHeight, radius);
+	// BoundingBox
+	BoundingBox BoundingBox::Create(const Mesh& mesh) {
+		auto& vertices = mesh._vertices._vertexData;
+		BoundingBox boundingBox;
 
-				memcpy(tmp.data(), blurredImageData, paddedWidth * paddedHeight * 4);
-				_hdriImageData[i] = GetImageArea(tmp, paddedWidth, paddedHeight, paddingAmountPixels, halfWidth + paddingAmountPixels, paddingAmountPixels, halfHeight + paddingAmountPixels);
+		if (vertices.size() <= 0) {
+			return boundingBox;
+		}
 
-				_front.push_back(GenerateFaceImage(CubeMapFace::FRONT, i, halfWidth, halfHeight));
-				_right.push_back(GenerateFaceImage(CubeMapFace::RIGHT, i, halfWidth, halfHeight));
-				_back.push_back(GenerateFaceImage(CubeMapFace::BACK, i, halfWidth, halfHeight));
-				_left.push_back(GenerateFaceImage(CubeMapFace::LEFT, i, halfWidth, halfHeight));
-				_upper.push_back(GenerateFaceImage(CubeMapFace::UPPER, i, halfWidth, halfHeight));
-				_lower.push_back(GenerateFaceImage(CubeMapFace::LOWER, i, halfWidth, halfHeight));
-			}
+		float minimumX = vertices[0]._position.x;
+		float minimumY = vertices[0]._position.y;
+		float minimumZ = vertices[0]._position.z;
 
-			blurrer.Destroy();
+		float maximumX = minimumX;
+		float maximumY = minimumY;
+		float maximumZ = minimumZ;
 
-			//WriteImagesToFiles(Paths::TexturesPath()/"env_map");
+		for (int i = 0; i < vertices.size(); ++i) {
+			minimumX = std::min(minimumX, vertices[i]._position.x);
+			minimumY = std::min(minimumY, vertices[i]._position.y);
+			minimumZ = std::min(minimumZ, vertices[i]._position.z);
 
-			//Logger::Log("Environment map " + imageFilePath.string() + " loaded.");
+			maximumX = std::max(maximumX, vertices[i]._position.x);
+			maximumY = std::max(maximumY, vertices[i]._position.y);
+			maximumZ = std::max(maximumZ, vertices[i]._position.z);
 		}
 
-		void CreateImage(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool& commandPool, VkQueue& queue) {
-			// Create the cubemap image.
-			auto& imageCreateInfo = _cubeMapImage._createInfo;
-			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-			imageCreateInfo.arrayLayers = 6;
-			imageCreateInfo.extent = { (uint32_t)_faceSizePixels, (uint32_t)_faceSizePixels, 1 };
-			imageCreateInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
-			imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageCreateInfo.mipLevels = 10;
-			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-			imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-			vkCreateImage(logicalDevice, &imageCreateInfo, nullptr, &_cubeMapImage._image);
+		boundingBox._min = glm::vec3(minimumX, minimumY, minimumZ);
+		boundingBox._max = glm::vec3(maximumX, maximumY, maximumZ);
 
-			// Allocate memory on the GPU for the image.
-			VkMemoryRequirements reqs;
-			vkGetImageMemoryRequirements(logicalDevice, _cubeMapImage._image, &reqs);
-			VkMemoryAllocateInfo imageAllocInfo{};
-			imageAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			imageAllocInfo.allocationSize = reqs.size;
-			imageAllocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-			VkDeviceMemory mem;
-			vkAllocateMemory(logicalDevice, &imageAllocInfo, nullptr, &mem);
-			vkBindImageMemory(logicalDevice, _cubeMapImage._image, mem, 0);
+		return boundingBox;
+	}
 
-			auto& imageViewCreateInfo = _cubeMapImage._viewCreateInfo;
-			imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-			imageViewCreateInfo.components = { {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY} };
-			imageViewCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-			imageViewCreateInfo.image = _cubeMapImage._image;
-			imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
-			imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-			imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-			imageViewCreateInfo.subresourceRange.layerCount = 6;
-			imageViewCreateInfo.subresourceRange.levelCount = 10;
-			vkCreateImageView(_logicalDevice, &imageViewCreateInfo, nullptr, &_cubeMapImage._view);
+	// Rigidbody
+	glm::vec3 RigidBody::CalculateTransmittedForce(const glm::vec3& transmitterPosition, const glm::vec3& force, const glm::vec3& receiverPosition) {
+		if (Helpers::IsVectorZero(receiverPosition - transmitterPosition, 0.001f)) return force;
+		auto effectiveForce = glm::normalize(receiverPosition - transmitterPosition);
+		auto scaleFactor = glm::dot(effectiveForce, force);
+		return effectiveForce * scaleFactor;
+	}
 
-			auto& samplerCreateInfo = _cubeMapImage._samplerCreateInfo;
-			samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-			samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerCreateInfo.anisotropyEnable = false;
-			samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
-			samplerCreateInfo.flags = 0;
-			samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
-			samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
-			samplerCreateInfo.maxLod = 10;
-			samplerCreateInfo.minLod = 0;
-			samplerCreateInfo.mipLodBias = 0.0f;
-			samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-			vkCreateSampler(_logicalDevice, &samplerCreateInfo, nullptr, &_cubeMapImage._sampler);
+	glm::vec3 RigidBody::GetCenterOfMass(bool worldSpace) {
+		auto worldSpaceTransform = _pGameObject->GetWorldSpaceTransform()._matrix;
+		if (_isCenterOfMassOverridden) return worldSpace ? glm::vec3(worldSpaceTransform * glm::vec4(_overriddenCenterOfMassLocalSpace, 1.0f)) : _overriddenCenterOfMassLocalSpace;
 
-			auto commandBuffer = VkHelper::CreateCommandBuffer(logicalDevice, commandPool);
-			CopyFacesToImage(logicalDevice, physicalDevice, commandPool, commandBuffer, queue);
+		auto& vertices = _pGameObject->_pMesh->_vertices._vertexData;
+		int vertexCount = (int)vertices.size();
+		float totalX = 0.0f;
+		float totalY = 0.0f;
+		float totalZ = 0.0f;
+
+		for (int i = 0; i < vertexCount; ++i) {
+			totalX += vertices[i]._position.x;
+			totalY += vertices[i]._position.y;
+			totalZ += vertices[i]._position.z;
 		}
 
-		void CopyFacesToImage(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, VkCommandPool& commandPool, VkCommandBuffer& commandBuffer, VkQueue& queue) {
-			auto faces = { _right, _left, _upper, _lower, _front, _back };
-			uint32_t resolution = _faceSizePixels;
-			uint32_t faceIndex = 0;
+		auto averagePos = glm::vec3(totalX / vertexCount, totalY / vertexCount, totalZ / vertexCount);
+		return worldSpace ? glm::vec3(worldSpaceTransform * glm::vec4(averagePos, 1.0f)) : averagePos;
+	}
 
-			VkHelper::StartRecording(commandBuffer);
+	glm::vec3 RigidBody::GetVelocityAtPosition(const glm::vec3& positionWorldSpace) {
+		glm::vec3 linearVelocityContributionFromAngularVelocityAtPosition;
+		if (!Helpers::IsVectorZero(_angularVelocity)) {
+			auto rotationAxis = glm::normalize(_angularVelocity);
+			auto worldSpaceCom = GetCenterOfMass(true);
+			auto posToCom = worldSpaceCom - positionWorldSpace;
+			glm::vec3 directionOfAngularVelocityContributionAtPosition = -glm::normalize(glm::cross(rotationAxis, posToCom));
+			linearVelocityContributionFromAngularVelocityAtPosition = directionOfAngularVelocityContributionAtPosition * (glm::length(posToCom) * glm::length(_angularVelocity));
+		}
+		return linearVelocityContributionFromAngularVelocityAtPosition + _velocity;
+	}
 
-			VkImageMemoryBarrier barrier{};
-			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			barrier.srcAccessMask = VK_ACCESS_NONE;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.oldLayout = _cubeMapImage._currentLayout;
-			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier.image = _cubeMapImage._image;
-			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
-			_cubeMapImage._currentLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	void RigidBody::AddForceAtPosition(const glm::vec3& force, const glm::vec3& pointOfApplication, const float& deltaTimeSeconds, bool isApplicationPointWorldSpace, bool isForceWorldSpace, const bool& ignoreMass) {
+		auto worldSpaceTransform = _pGameObject->GetWorldSpaceTransform()._matrix;
+		auto worldSpaceForce = isForceWorldSpace ? force : glm::vec3(worldSpaceTransform * glm::vec4(force, 1.0f));
 
-			std::vector<Buffer> temporaryBuffers;
+		// First calculate the translation component of the force to apply.
+		auto worldSpaceCom = GetCenterOfMass(true);
+		auto worldSpacePointOfApplication = isApplicationPointWorldSpace ? pointOfApplication : glm::vec3(worldSpaceTransform * glm::vec4(pointOfApplication, 1.0f));
 
-			for (auto& face : faces) {
-				resolution = _faceSizePixels;
+		glm::vec3 translationForce = CalculateTransmittedForce(worldSpacePointOfApplication, worldSpaceForce, worldSpaceCom);
+		//if (ignoreMass) glm::vec3 translationAcceleration = translationForce / _mass;
+		glm::vec3 translationDelta = translationForce * deltaTimeSeconds;
+		translationDelta.x = _lockTranslationX ? 0.0f : translationDelta.x;
+		translationDelta.y = _lockTranslationY ? 0.0f : translationDelta.y;
+		translationDelta.z = _lockTranslationZ ? 0.0f : translationDelta.z;
+		_velocity += translationDelta;
 
-				for (int mipmapIndex = 0; mipmapIndex < face.size(); ++mipmapIndex, resolution /= 2) {
-					// Create a temporary buffer.
-					Buffer stagingBuffer{};
-					stagingBuffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-					stagingBuffer._createInfo.size = face[mipmapIndex].size();
-					stagingBuffer._createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-					vkCreateBuffer(_logicalDevice, &stagingBuffer._createInfo, nullptr, &stagingBuffer._buffer);
+		// Now calculate the rotation component.
+		auto positionToCom = worldSpaceCom - worldSpacePointOfApplication;
+		if (Helpers::IsVectorZero(positionToCom, 0.001f)) return;
+
+		auto rotationAxis = -glm::normalize(glm::cross(positionToCom, worldSpaceForce));
+		if (glm::isnan(rotationAxis.x) || glm::isnan(rotationAxis.y) || glm::isnan(rotationAxis.x)) return;
+
+		auto comPerpendicularDirection = glm::normalize(glm::cross(positionToCom, rotationAxis));
+		auto rotationalForce = comPerpendicularDirection * glm::dot(comPerpendicularDirection, worldSpaceForce);
+		auto rotationalInertia = powf(glm::length(positionToCom), 2.0f) * _mass;
+		// TODO: better approximation for rotational inertia.
+
+		auto angularAcceleration = glm::cross(rotationalForce, positionToCom) / rotationalInertia;
+		AddTorque(angularAcceleration, deltaTimeSeconds, true);
+	}
+
+	void RigidBody::AddForce(const glm::vec3& force, const float& deltaTimeSeconds, const bool& ignoreMass) {
+		auto translationDelta = ignoreMass ? (force * deltaTimeSeconds) : ((force / _mass) * deltaTimeSeconds);
+		translationDelta.x = _lockTranslationX ? 0.0f : translationDelta.x;
+		translationDelta.y = _lockTranslationY ? 0.0f : translationDelta.y;
+		translationDelta.z = _lockTranslationZ ? 0.0f : translationDelta.z;
+		_velocity += translationDelta;
+	}
 
-					// Allocate memory for the buffer.
-					VkMemoryRequirements requirements{};
-					vkGetBufferMemoryRequirements(_logicalDevice, stagingBuffer._buffer, &requirements);
-					stagingBuffer._gpuMemory = PhysicalDevice::AllocateMemory(physicalDevice, logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	void RigidBody::AddTorque(const glm::vec3& torqueWorldSpaceAxis, const float& deltaTimeSeconds, const bool& ignoreMass) {
+		auto rotationDelta = ignoreMass ? (torqueWorldSpaceAxis * deltaTimeSeconds) : ((torqueWorldSpaceAxis / _mass) * deltaTimeSeconds);
+		rotationDelta.x = _lockRotationX ? 0.0f : rotationDelta.x;
+		rotationDelta.y = _lockRotationY ? 0.0f : rotationDelta.y;
+		rotationDelta.z = _lockRotationZ ? 0.0f : rotationDelta.z;
+		_angularVelocity += rotationDelta;
+	}
 
-					// Map memory to the correct GPU and CPU ranges for the buffer.
-					vkBindBufferMemory(_logicalDevice, stagingBuffer._buffer, stagingBuffer._gpuMemory, 0);
-					vkMapMemory(_logicalDevice, stagingBuffer._gpuMemory, 0, face[mipmapIndex].size(), 0, &stagingBuffer._cpuMemory);
-					memcpy(stagingBuffer._cpuMemory, face[mipmapIndex].data(), face[mipmapIndex].size());
+	CollisionContext RigidBody::DetectCollision(RigidBody& other) {
+		CollisionContext outCtx;
+		outCtx._collidee = &other;
+		auto worldSpaceOther = other._pGameObject->GetWorldSpaceTransform();
+		auto worldSpaceCurrent = _pGameObject->GetWorldSpaceTransform();
+		auto& otherMesh = other._pGameObject->_pMesh;
+		auto& mesh = _pGameObject->_pMesh;
 
-					// Copy the buffer to the specific face by defining the subresource range.
-					VkBufferImageCopy copyInfo{};
-					copyInfo.bufferImageHeight = resolution;
-					copyInfo.bufferRowLength = resolution;
-					copyInfo.imageExtent = { resolution, resolution, 1 };
-					copyInfo.imageOffset = { 0,0,0 };
-					copyInfo.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-					copyInfo.imageSubresource.layerCount = 1;
-					copyInfo.imageSubresource.baseArrayLayer = faceIndex;
-					copyInfo.imageSubresource.mipLevel = mipmapIndex;
-					vkCmdCopyBufferToImage(commandBuffer, stagingBuffer._buffer, _cubeMapImage._image, _cubeMapImage._currentLayout, 1, &copyInfo);
+		auto otherLod = otherMesh->GetLod(other._collisionLod);
+		auto lastIndex = (int)(otherLod._firstIndex + otherLod._indexCount);
+		for (int i = (int)otherLod._firstIndex; i < lastIndex; i += 3) {
+			for (int j = (int)otherLod._firstIndex; j < lastIndex; j += 3) {
 
-					temporaryBuffers.push_back(stagingBuffer);
-				}
+				auto v1Other = glm::vec3(worldSpaceOther._matrix * glm::vec4(otherMesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[i]]._position, 1.0f));
+				auto v2Other = glm::vec3(worldSpaceOther._matrix * glm::vec4(otherMesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[i + 1]]._position, 1.0f));
+				auto v3Other = glm::vec3(worldSpaceOther._matrix * glm::vec4(otherMesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[i + 2]]._position, 1.0f));
 
-				++faceIndex;
-			}
+				auto v1 = glm::vec3(worldSpaceCurrent._matrix * glm::vec4(mesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[j]]._position, 1.0f));
+				auto v2 = glm::vec3(worldSpaceCurrent._matrix * glm::vec4(mesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[j + 1]]._position, 1.0f));
+				auto v3 = glm::vec3(worldSpaceCurrent._matrix * glm::vec4(mesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[j + 2]]._position, 1.0f));
 
-			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			barrier.oldLayout = _cubeMapImage._currentLayout;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.image = _cubeMapImage._image;
-			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
-			_cubeMapImage._currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+				glm::vec3 intersectionPoint1, intersectionPoint2, intersectionPoint3;
+				auto edge1 = v2Other - v1Other;
+				auto edge2 = v3Other - v1Other;
+				auto edge3 = v2Other - v3Other;
+				glm::vec3 normal = -glm::normalize(glm::cross(edge1, edge2));
 
-			VkHelper::StopRecording(commandBuffer);
-			VkHelper::ExecuteCommands(commandBuffer, queue);
+				// Check collision by testing this body's edges as segments against the other body's face.
+				if (IsSegmentIntersectingTriangle(v1, v2 - v1, v1Other, v2Other, v3Other, intersectionPoint1)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint1, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
+				if (IsSegmentIntersectingTriangle(v1, v3 - v1, v1Other, v2Other, v3Other, intersectionPoint2)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint2, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
+				if (IsSegmentIntersectingTriangle(v3, v2 - v3, v1Other, v2Other, v3Other, intersectionPoint3)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint3, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
+				//if (!IsVectorZero(intersectionPoint1) || !IsVectorZero(intersectionPoint2) || !IsVectorZero(intersectionPoint3)) return outCtx;
 
-			// Destroy all the buffers used to move data to the cube map image.
-			for (auto& buffer : temporaryBuffers) {
-				vkUnmapMemory(_logicalDevice, buffer._gpuMemory);
-				vkFreeMemory(_logicalDevice, buffer._gpuMemory, nullptr);
-				vkDestroyBuffer(_logicalDevice, buffer._buffer, nullptr);
+				// Check collision by testing the other body's edges as segments against the current body's face.
+				if (IsSegmentIntersectingTriangle(v1Other, edge1, v1, v2, v3, intersectionPoint1)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint1, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
+				if (IsSegmentIntersectingTriangle(v1Other, edge2, v1, v2, v3, intersectionPoint2)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint2, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
+				if (IsSegmentIntersectingTriangle(v3Other, edge3, v1, v2, v3, intersectionPoint3)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint3, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
 			}
 		}
 
-		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
-			auto descriptorSetID = 4;
-
-			// Map the cubemap image to the fragment shader.
-			VkDescriptorPool descriptorPool{};
-			VkDescriptorPoolSize poolSizes[1] = { VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 } };
-			VkDescriptorPoolCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-			createInfo.maxSets = (uint32_t)1;
-			createInfo.poolSizeCount = (uint32_t)1;
-			createInfo.pPoolSizes = poolSizes;
-			vkCreateDescriptorPool(ctx._logicalDevice, &createInfo, nullptr, &descriptorPool);
-
-			// Create the descriptor set.
-			VkDescriptorSet set{};
-			VkDescriptorSetAllocateInfo allocInfo = {};
-			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			allocInfo.descriptorPool = descriptorPool;
-			allocInfo.descriptorSetCount = (uint32_t)1;
-			allocInfo.pSetLayouts = &layouts[descriptorSetID]._layout;
-			vkAllocateDescriptorSets(ctx._logicalDevice, &allocInfo, &set);
+		return outCtx;
+	}
 
-			// Update the descriptor set's data with the environment map's image.
-			VkDescriptorImageInfo imageInfo{ _cubeMapImage._sampler, _cubeMapImage._view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			VkWriteDescriptorSet writeInfo = {};
-			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			writeInfo.dstSet = set;
-			writeInfo.descriptorCount = 1;
-			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			writeInfo.pImageInfo = &imageInfo;
-			writeInfo.dstBinding = 0;
-			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+	std::vector<GameObject*> RigidBody::GetGameObjects(GameObject* pRoot, std::vector<GameObject*> excludedObjects) {
+		std::vector<GameObject*> outGameObjects;
+		if (!pRoot->_pMesh) goto searchChildren;
+		if (pRoot->_pMesh->_vertices._vertexData.size() < 1) goto searchChildren;
+		for (int i = 0; i < excludedObjects.size(); ++i) if (excludedObjects[i] == pRoot) goto searchChildren;
+		outGameObjects.push_back(pRoot);
 
-			auto descriptorSets = std::vector<VkDescriptorSet>{ set };
-			_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
-			return _shaderResources;
+	searchChildren:
+		for (int i = 0; i < pRoot->_children.size(); ++i) {
+			auto objects = GetGameObjects(pRoot->_children[i], excludedObjects);
+			outGameObjects.insert(outGameObjects.end(), objects.begin(), objects.end());
 		}
+		return outGameObjects;
+	}
 
-		void UpdateShaderResources() {
-		}
+	std::vector<CollisionContext> RigidBody::DetectCollisions(VkContext& ctx, VkContext& collisionCtx, std::vector<RigidBody*> bodiesToExclude) {
+		Profiler::ScopedZone zone("Detect collisions");
+		std::vector<GameObject*> gameObjectsToExclude;
+		gameObjectsToExclude.push_back(_pGameObject);
+		for (int i = 1; i < gameObjectsToExclude.size(); ++i) gameObjectsToExclude[i] = bodiesToExclude[i - 1]->_pGameObject;
+		auto otherGameObjects = GetGameObjects(_pGameObject->_pScene->_pRootGameObject, gameObjectsToExclude);
 
-		void CreateVertexBuffer(VkContext& ctx) {
-			//  _right, _left, _upper, _lower, _front, _back 
-			const unsigned int coordinateCount = 72;
-			float skyBoxVertices[coordinateCount] = {
-				// Back face (-Z)
-				-1.0f, -1.0f, -1.0f, // Vertex 0
-				1.0f, -1.0f, -1.0f, // Vertex 1
-				1.0f,  1.0f, -1.0f, // Vertex 2
-				-1.0f,  1.0f, -1.0f, // Vertex 3
+		std::vector<CollisionContext> outCollisions;
+		for (int i = 0; i < otherGameObjects.size(); ++i) {
+			if (otherGameObjects[i]->_pMesh->_vertices._vertexData.size() < 1) continue;
+			if (!otherGameObjects[i]->_pBody) continue;
+			//auto collision = DetectCollision(otherGameObjects[i]->_body);
+			//bool hasCollided = collision._collisionPositions.size() > 0;
+			bool hasCollided = false;
 
-				// Front face (+Z)
-				-1.0f, -1.0f,  1.0f, // Vertex 4
-				1.0f, -1.0f,  1.0f, // Vertex 5
-				1.0f,  1.0f,  1.0f, // Vertex 6
-				-1.0f,  1.0f,  1.0f, // Vertex 7
+			auto collision = GpuCollisionDetector::Run(collisionCtx, *this, *otherGameObjects[i]->_pBody, hasCollided);
 
-				// Left face (-X)
-				-1.0f, -1.0f,  1.0f, // Vertex 4
-				-1.0f, -1.0f, -1.0f, // Vertex 0
-				-1.0f,  1.0f, -1.0f, // Vertex 3
-				-1.0f,  1.0f,  1.0f, // Vertex 7
+			if (!hasCollided) continue;
+			outCollisions.push_back(collision);
+			//if (collision._collisionPositions.size() > 0) outCollisions.push_back(collision);
+		}
+		return outCollisions;
+	}
 
-				// Right face (+X)
-				1.0f, -1.0f, -1.0f, // Vertex 1
-				1.0f, -1.0f,  1.0f, // Vertex 5
-				1.0f,  1.0f,  1.0f, // Vertex 6
-				1.0f,  1.0f, -1.0f, // Vertex 2
+	void RigidBody::Initialize(GameObject* pGameObject, const float& mass, const bool& overrideCenterOfMass, const glm::vec3& overriddenCenterOfMass) {
+		if (!pGameObject) return;
+		if (!pGameObject->_pMesh) return;
+		if (pGameObject->_pMesh->_vertices._vertexData.size() < 1) return;
+		if (mass <= 0.001f) return;
 
-				// Bottom face (-Y)
-				-1.0f, -1.0f, -1.0f, // Vertex 0
-				-1.0f, -1.0f,  1.0f, // Vertex 4
-				1.0f, -1.0f,  1.0f, // Vertex 5
-				1.0f, -1.0f, -1.0f, // Vertex 1
+		_pGameObject = pGameObject;
+		_mass = mass;
+		_isCenterOfMassOverridden = overrideCenterOfMass;
+		_overriddenCenterOfMassLocalSpace = overriddenCenterOfMass;
+		_isInitialized = true;
+	}
 
-				// Top face (+Y)
-				-1.0f,  1.0f,  1.0f, // Vertex 7
-				-1.0f,  1.0f, -1.0f, // Vertex 3
-				1.0f,  1.0f, -1.0f, // Vertex 2
-				1.0f,  1.0f,  1.0f  // Vertex 6
-			};
+	/**
+	 * @brief Represents a general-purpose camera.
+	 */
+	class Camera : public GameObject {
+	public:
 
-			// Create a temporary buffer.
-			auto& buffer = _vertices._vertexBuffer;
-			auto bufferSizeBytes = coordinateCount * sizeof(float);
-			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			buffer._createInfo.size = bufferSizeBytes;
-			buffer._createInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-			vkCreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+		/**
+		 * @brief Horizontal FOV in degrees.
+		 */
+		float _horizontalFov;
 
-			// Allocate memory for the buffer.
-			VkMemoryRequirements requirements{};
-			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
-			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, (VkMemoryPropertyFlagBits)(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+		/**
+		 * @brief Lower bound that maps to normalizedDeviceCoordinates.z = 0 in the vertex shader, in meters.
+		 * Anything closer than this will not be rendered by the graphics pipeline.
+		 */
+		float _nearClippingDistance;
 
-			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
+		/**
+		 * @brief Upper bound that maps to normalizedDeviceCoordinates.z = 1 in the vertex shader, in meters.
+		 * Anything farther than this will not be rendered by the graphics pipeline.
+		 */
+		float _farClippingDistance;
 
-			// Map memory to the correct GPU and CPU ranges for the buffer.
-			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+		/**
+		 * @brief This is a transform passed to the vertex shader that translates vertices from world space into camera space.
+		 */
+		Transform _view;
 
-			// Send the buffer to GPU.
-			buffer._pData = skyBoxVertices;
-			buffer._sizeBytes = bufferSizeBytes;
-			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, buffer._buffer, buffer._pData, buffer._sizeBytes);
-		}
+		/**
+		 * @brief Up direction of the camera.
+		 */
+		glm::vec3 _up;
 
-		void CreateIndexBuffer(VkContext& ctx) {
-			//  _right, _left, _upper, _lower, _front, _back 
-			const unsigned int indexCount = 36;
-			uint32_t skyBoxFaceIndices[indexCount] = {
+		// Temp
+		float _lastYaw = 0.0f;
+		float _lastPitch = 0.0f;
+		float _lastRoll = 0.0f;
 
-				// Right face (+X)
-				1, 5, 6, // First triangle
-				6, 2, 1, // Second triangle
+		float _yaw = 0.0f;
+		float _pitch = 0.0f;
+		float _roll = 0.0f;
 
-				// Left face (-X)
-				4, 0, 3, // First triangle
-				3, 7, 4, // Second triangle
+		float _lastScrollY = 0.0f;
 
-				// Top face (+Y)
-				7, 3, 2, // First triangle
-				2, 6, 7,  // Second triangle
+		/**
+		 * @brief Camera related data directed to the vertex shader. Knowing this, the vertex shader is able to calculate the correct
+		 * Vulkan view volume coordinates.
+		 */
+		struct {
+			float tanHalfHorizontalFov;
+			float aspectRatio;
+			float nearClipDistance;
+			float farClipDistance;
+			glm::mat4 worldToCamera;
+			glm::vec3 transform;
+		} _cameraData;
 
-				// Bottom face (-Y)
-				0, 4, 5, // First triangle
-				5, 1, 0, // Second triangle
+		Camera() {
+			_horizontalFov = 55.0f;
+			_nearClippingDistance = 0.1f;
+			_farClippingDistance = 200.0f;
+			_up = glm::vec3(0.0f, 1.0f, 0.0f);
+		}
 
-				// Front face (+Z)
-				6, 5, 4, // First triangle
-				6, 4, 7, // Second triangle
+		Camera(float horizontalFov, float nearClippingDistance, float farClippingDistance) {
+			_horizontalFov = horizontalFov;
+			_nearClippingDistance = nearClippingDistance;
+			_farClippingDistance = farClippingDistance;
+			_up = glm::vec3(0.0f, 1.0f, 0.0f);
+		}
 
-				// Back face (-Z)
-				0, 1, 2, // First triangle
-				2, 3, 0 // Second triangle
-			};
+		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Uniform);
+			auto descriptorSetID = 0;
 
 			// Create a temporary buffer.
-			auto& buffer = _faceIndices._indexBuffer;
-			auto bufferSizeBytes = indexCount * sizeof(uint32_t);
+			Buffer buffer{};
+			auto bufferSizeBytes = sizeof(_cameraData);
 			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 			buffer._createInfo.size = bufferSizeBytes;
-			buffer._createInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-			vkCreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+			buffer._createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+			ResourceTracker::CreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
 
 			// Allocate memory for the buffer.
 			VkMemoryRequirements requirements{};
 			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
-			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, (VkMemoryPropertyFlagBits)(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
-
-			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
+			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 
 			// Map memory to the correct GPU and CPU ranges for the buffer.
 			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
+			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
+			memcpy(buffer._cpuMemory, &_cameraData, bufferSizeBytes);
 
-			// Send the buffer to GPU.
-			buffer._pData = skyBoxFaceIndices;
-			buffer._sizeBytes = bufferSizeBytes;
-			Buffer::CopyToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, buffer._buffer, buffer._pData, buffer._sizeBytes);
+			_buffers.push_back(buffer);
+
+			VkDescriptorSet descriptorSet = ctx._descriptorAllocator.Allocate(ctx._logicalDevice, layouts[descriptorSetID]._layout);
+
+			// Update the descriptor set's data with the environment map's image.
+			VkDescriptorBufferInfo bufferInfo{ buffer._buffer, 0, buffer._createInfo.size };
+			VkWriteDescriptorSet writeInfo = {};
+			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfo.dstSet = descriptorSet;
+			writeInfo.descriptorCount = 1;
+			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			writeInfo.pBufferInfo = &bufferInfo;
+			writeInfo.dstBinding = 0;
+			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+
+			auto descriptorSets = std::vector<VkDescriptorSet>{ descriptorSet };
+			_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
+			return _shaderResources;
 		}
 
-		void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) {
-			VkDescriptorSet sets[2] = { _shaderResources[0][0], _shaderResources[4][0] };
-			vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, sets, 0, nullptr);
-			vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &sets[1], 0, nullptr);
+		void UpdateShaderResources() {
+			auto& globalSettings = GlobalSettings::Instance();
 
-			VkDeviceSize offset = 0;
-			vkCmdBindVertexBuffers(drawCommandBuffer, 0, 1, &_vertices._vertexBuffer._buffer, &offset);
-			vkCmdBindIndexBuffer(drawCommandBuffer, _faceIndices._indexBuffer._buffer, 0, VkIndexType::VK_INDEX_TYPE_UINT32);
-			vkCmdDrawIndexed(drawCommandBuffer, 36, 1, 0, 0, 0);
+			_cameraData.worldToCamera = _view._matrix;
+			_cameraData.tanHalfHorizontalFov = tan(glm::radians(_horizontalFov / 2.0f));
+			_cameraData.aspectRatio = Helpers::Convert<uint32_t, float>(globalSettings._windowWidth) / Helpers::Convert<uint32_t, float>(globalSettings._windowHeight);
+			_cameraData.nearClipDistance = _nearClippingDistance;
+			_cameraData.farClipDistance = _farClippingDistance;
+			_cameraData.transform = _localTransform.Position();
+
+			memcpy(_buffers[0]._cpuMemory, &_cameraData, sizeof(_cameraData));
 		}
-	};
 
-	// Forward declarations for the compiler.
-	class GameObject;
-	class Scene;
-	class RigidBody;
-	class Mesh;
+		void Update(VkContext& vkContext, KeyboardMouse& input) {
+			auto& time = Time::Instance();
+			auto mouseSens = GlobalSettings::Instance()._mouseSensitivity;
+			_yaw += (float)input._deltaMouseX * mouseSens;
 
-	struct CollisionContext {
-		RigidBody* _collidee; // Collision receiver.
-		std::vector<glm::vec4> _collisionPositions; // List of points where a collision was detected in world space. W component discarded, only there for efficiency reasons, only there for efficiency reasons with CPU-GPU interop.
-		std::vector<glm::vec4> _collisionNormals; // List of normals for each collision position. W component discarded, only there for efficiency reasons with CPU-GPU interop.
-		std::vector<RigidBody*> _collisionObjects; // List of objects for which the collision was detected.
-		glm::vec4 _averagePosition;
-		glm::vec4 _averageNormal;
+			if ((_pitch + (input._deltaMouseY * mouseSens)) > -90 && (_pitch + (input._deltaMouseY * mouseSens)) < 90) {
+				_pitch += (float)input._deltaMouseY * mouseSens;
+			}
 
-		void CalculateAverages() {
-			auto count = _collisionPositions.size();
+			if (input.IsKeyHeldDown(GLFW_KEY_Q)) {
+				_roll += 0.1f * (float)Time::Instance()._deltaTime;
+			}
 
-			for (int j = 0; j < count; ++j) {
-				_averageNormal += _collisionNormals[j];
-				_averagePosition += _collisionPositions[j];
+			if (input.IsKeyHeldDown(GLFW_KEY_E)) {
+				_roll -= 0.1f * (float)Time::Instance()._deltaTime;
 			}
 
-			_averagePosition /= count; _averageNormal /= count;
-		}
-	};
+			if (input.IsKeyHeldDown(GLFW_KEY_W)) {
+				_localTransform.Translate(_localTransform.Forward() * 0.05f * (float)time._deltaTime);
+			}
 
-	struct EngineContext;
+			if (input.IsKeyHeldDown(GLFW_KEY_A)) {
+				_localTransform.Translate(-_localTransform.Right() * 0.05f * (float)time._deltaTime);
+			}
 
-	/**
-		 * @brief Used by implementing classes to mark themselves as a class that is meant to do work on the main loop of the physics thread.
-		 */
-	class IPhysicsUpdatable {
-	public:
+			if (input.IsKeyHeldDown(GLFW_KEY_S)) {
+				_localTransform.Translate(-_localTransform.Forward() * 0.05f * (float)time._deltaTime);
+			}
 
-		/**
-		 * @brief Function called on implementing classes in each iteration of the main loop.
-		 */
-		virtual void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) = 0;
-	};
+			if (input.IsKeyHeldDown(GLFW_KEY_D)) {
+				_localTransform.Translate(_localTransform.Right() * 0.05f * (float)time._deltaTime);
+			}
 
-	class Time : public Singleton<Time>, public IUpdatable, public IPhysicsUpdatable {
-	public:
+			if (input.IsKeyHeldDown(GLFW_KEY_SPACE)) {
+				_localTransform.Translate(_localTransform.Up() * 0.05f * (float)time._deltaTime);
+			}
 
-		/**
-		 * @brief The time this instance was created; assigned to in the constructor.
-		 */
-		std::chrono::high_resolution_clock::time_point _timeStart;
+			if (input.IsKeyHeldDown(GLFW_KEY_LEFT_CONTROL)) {
+				_localTransform.Translate(-_localTransform.Up() * 0.05f * (float)time._deltaTime);
+			}
 
-		/**
-		 * @brief Time last frame started.
-		 */
-		std::chrono::high_resolution_clock::time_point _lastUpdateTime;
+			float _deltaYaw = (_yaw - _lastYaw);
+			float _deltaPitch = (_pitch - _lastPitch);
+			float _deltaRoll = (_roll - _lastRoll);
 
-		/**
-		 * @brief Time last physics update happened.
-		 */
-		std::chrono::high_resolution_clock::time_point _lastPhysicsUpdateTime;
+			_lastYaw = _yaw;
+			_lastPitch = _pitch;
+			_lastRoll = _roll;
 
-		/**
-		 * @brief The amount of time since last frame started in milliseconds.
-		 */
-		double _deltaTime;
+			// First apply roll rotation.
+			_localTransform.Rotate(_localTransform.Forward(), _deltaRoll);
 
-		/**
-		 * @brief The amount of time since the last physics simulation update in milliseconds.
-		 */
-		double _physicsDeltaTime;
+			// Transform the up vector according to delta roll but not delta pitch, so the
+			// up vector is not affected by looking up and down, but it is by rolling the camera
+			// left and right.
+			auto axis = _localTransform.Forward(); // This gets the pitch-independent forward vector.
+			auto angleRadians = glm::radians(_deltaRoll);
+			auto cosine = cos(angleRadians / 2.0f);
+			auto sine = sin(angleRadians / 2.0f);
+			_up = glm::quat(cosine, axis.x * sine, axis.y * sine, axis.z * sine) * _up;
 
-		/**
-		 * @brief Fixed physics update time in milliseconds.
-		 * The engine will wait for (_fixedPhysicsDeltaTime - _physicsDeltaTime) milliseconds if _physicsDeltaTime is lower than this number.
-		 */
-		double _fixedPhysicsDeltaTime = 16;
+			// Then apply yaw rotation.
+			_localTransform.Rotate(_up, _deltaYaw);
 
-		/**
-		 * @brief Constructor.
-		 */
-		Time() {
-			_timeStart = std::chrono::high_resolution_clock::now();
-			_deltaTime = 0.0;
-			_physicsDeltaTime = 0.0;
-			_lastUpdateTime = _timeStart;
-			_lastPhysicsUpdateTime = _timeStart;
-		}
+			// Then pitch.
+			_localTransform.Rotate(_localTransform.Right(), _deltaPitch);
 
-		/**
-		 * @brief See IUpdatable.
-		 */
-		void Update() {
-			auto now = std::chrono::high_resolution_clock::now();
-			_deltaTime = (now - _lastUpdateTime).count() * 0.000001;
-			_lastUpdateTime = now;
-		}
+			// Vulkan's coordinate system is: X points to the right, Y points down, Z points into the screen.
+			// Vulkan's viewport coordinate system is right handed and we are doing all our calculations assuming 
+			// +Z is forward, +Y is up and +X is right, so using a left-handed coordinate system.
 
-		/**
-		 * @brief See IPhysicsUpdatable.
-		 */
-		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
-			auto now = std::chrono::high_resolution_clock::now();
-			_physicsDeltaTime = (now - _lastPhysicsUpdateTime).count() * 0.000001;
-			_lastPhysicsUpdateTime = now;
-		}
-	};
+			// We use the inverse of the camera transformation matrix because this matrix will be applied to each vertex of each object in the scene in the vertex shader.
+			// There is no such thing as a camera, because in the end we use the position of the vertices to draw stuff on screen. We can only modify the position of the
+			// vertices as if they were viewed from the camera, because in the end the physical position of the vertex ends up in the vertex shader, which then calculates
+			// its position on 2D screen using the projection matrix.
+			// Suppose that our vertex V is at (0,10,0) (so above your head if you are looking down the z axis from the origin)
+			// Also suppose that our camera is at (0,0,-10). This means that the camera is behind us by 10 units and can likely see the object
+			// somewhat in the upper area of its screen. If we want to see vertex V as if we viewed it from the camera, we would have to move
+			// vertex V 10 units forward from its current position. If instead of moving the camera BACK 10 units we move vertex V FORWARD 10 units, 
+			// we get the exact same effect as if we actually had a camera and moved it backwards.
+			_view._matrix = glm::inverse(_localTransform._matrix);
 
-	/*struct ForceCtx {
-		glm::vec3 _force;
-		glm::vec3 _pointOfApplication;
-		float _deltaTimeSeconds;
-		bool _isTorque = false;
-		bool _ignoreMass = false;
-		bool _isApplicationPointWorldSpace = true;
-		bool _isForceWorldSpace = true;
+			float _deltaScrollY = ((float)input._scrollY - _lastScrollY);
+			_horizontalFov -= _deltaScrollY;
+			_lastScrollY = (float)input._scrollY;
 
-		ForceCtx(glm::vec3 force = glm::vec3(0.0f), glm::vec3 pointOfApplication = glm::vec3(0.0f), float deltaTimeSeconds = 0.0f, bool isTorque = false, bool ignoreMass = false, bool isApplicationPointWorldSpace = true, bool isForceWorldSpace = true) :
-			_force(force),
-			_pointOfApplication(pointOfApplication),
-			_deltaTimeSeconds(deltaTimeSeconds),
-			_isTorque(isTorque),
-			_ignoreMass(ignoreMass),
-			_isApplicationPointWorldSpace(isApplicationPointWorldSpace),
-			_isForceWorldSpace(isForceWorldSpace)
-		{
+			UpdateShaderResources();
+		}
+
+		/**
+		 * @brief Places the camera at position, looking at target with _up pointing up. Used by scripted camera paths instead of Update.
+		 */
+		void LookAt(const glm::vec3& position, const glm::vec3& target) {
+			auto forward = glm::normalize(target - position);
+			auto right = glm::normalize(glm::cross(_up, forward));
+			auto up = glm::cross(forward, right);
+			_localTransform._matrix = glm::mat4(glm::vec4(right, 0.0f), glm::vec4(up, 0.0f), glm::vec4(forward, 0.0f), glm::vec4(position, 1.0f));
+			_view._matrix = glm::inverse(_localTransform._matrix);
+			UpdateShaderResources();
 		}
-	};*/
+	};
 
-	glm::vec3 gGravity = glm::vec3(0.0f, -10.0f, 0.0f);
+	size_t Mesh::SelectLod(const glm::mat4& objectToWorld, Camera& camera) const {
+		if (_lods.size() <= 1) return 0;
+
+		// Errors are measured in object space, so they are scaled by the largest scale of the transform to not underestimate them.
+		auto scale = std::max(glm::length(glm::vec3(objectToWorld[0])), std::max(glm::length(glm::vec3(objectToWorld[1])), glm::length(glm::vec3(objectToWorld[2]))));
+		auto center = glm::vec3(objectToWorld * glm::vec4(_bounds.GetCenter(), 1.0f));
+		auto radius = glm::length(_bounds.GetExtents()) * scale;
+		auto distance = std::max(glm::length(center - camera._localTransform.Position()) - radius, camera._nearClippingDistance);
+
+		// Same projection as the vertex shader: a camera space length l at depth z covers l / (z * tan(fov / 2)) half screen heights.
+		auto& settings = GlobalSettings::Instance();
+		auto pixelsPerUnit = (float)settings._windowHeight * 0.5f / (distance * tanf(glm::radians(camera._horizontalFov * 0.5f)));
+
+		size_t lodIndex = 0;
+		for (size_t i = 1; i < _lods.size(); ++i) {
+			if (_lods[i]._error * scale * pixelsPerUnit > settings._lodErrorPixels) break;
+			lodIndex = i;
+		}
+		return lodIndex;
+	}
 
 	/**
-	 * @brief Base class for a body that performs physics simulation.
+	 * @brief Viewing volume of a camera, described by 6 world space planes whose normals point inside the volume.
 	 */
-	class RigidBody : public IPhysicsUpdatable {
+	class Frustum {
 	public:
 
 		/**
-		 * @brief Whether the body is initialized and valid for simulation.
+		 * @brief Result of testing a bounding volume against the frustum.
 		 */
-		bool _isInitialized = false;
+		enum class Containment {
+			Outside, Intersecting, Inside
+		};
 
 		/**
-		 * @brief True if collision detection and resolution is enabled for the body.
+		 * @brief Left, right, bottom, top, near and far planes. Each plane is stored as (normal.x, normal.y, normal.z, distance) where a
+		 * position p is on the inner side of the plane when dot(normal, p) + distance >= 0.
 		 */
-		bool _isCollidable = false;
+		glm::vec4 _planes[6];
 
 		/**
-		 * @brief The velocity vector of this physics body in units per second in world space.
+		 * @brief Builds the frustum from the same values the vertex shaders use to project vertices, so that what gets culled is exactly what
+		 * would have been clipped, the far plane included.
 		 */
-		glm::vec3 _velocity = glm::vec3(0.0f, 0.0f, 0.0f);
+		static Frustum Create(Camera& camera) {
+			auto& cameraData = camera._cameraData;
+			float tanHalfWidth = cameraData.tanHalfHorizontalFov * cameraData.aspectRatio;
+			float tanHalfHeight = cameraData.tanHalfHorizontalFov;
 
-		/**
-		 * @brief The angular velocity in radians per second. The direction of the vector represents the axis of rotation in world space, whereas the
-		 * length of the vector is the actual value in radians per second.
-		 */
-		glm::vec3 _angularVelocity = glm::vec3(0.0f, 0.0f, 0.0f);
+			// Planes in camera space (X right, Y up, Z forward).
+			glm::vec4 cameraSpacePlanes[6] = {
+				glm::vec4(1.0f, 0.0f, tanHalfWidth, 0.0f),
+				glm::vec4(-1.0f, 0.0f, tanHalfWidth, 0.0f),
+				glm::vec4(0.0f, 1.0f, tanHalfHeight, 0.0f),
+				glm::vec4(0.0f, -1.0f, tanHalfHeight, 0.0f),
+				glm::vec4(0.0f, 0.0f, 1.0f, -camera._nearClippingDistance),
+				glm::vec4(0.0f, 0.0f, -1.0f, camera._farClippingDistance)
+			};
 
-		glm::vec3 _lastAngularVelocity = glm::vec3(0.0f, 0.0f, 0.0f);
+			// A plane is transformed from camera space to world space by the transpose of the world to camera matrix.
+			Frustum outFrustum;
+			auto transposedView = glm::transpose(camera._view._matrix);
+			for (int i = 0; i < 6; ++i) {
+				auto plane = transposedView * cameraSpacePlanes[i];
+				outFrustum._planes[i] = plane / glm::length(glm::vec3(plane));
+			}
+			return outFrustum;
+		}
 
-		/**
-		 * @brief Mass in kg.
-		 */
-		float _mass;
+		Containment Classify(const BoundingSphere& sphere) const {
+			if (sphere._radius < 0.0f) return Containment::Outside;
 
-		/**
-		 * @brief Friction coefficient. Adjust depending on in-engine behaviour.
-		 */
-		float _friction;
+			auto outContainment = Containment::Inside;
+			for (int i = 0; i < 6; ++i) {
+				float distance = glm::dot(glm::vec3(_planes[i]), sphere._center) + _planes[i].w;
+				if (distance < -sphere._radius) return Containment::Outside;
+				if (distance < sphere._radius) outContainment = Containment::Intersecting;
+			}
+			return outContainment;
+		}
+	};
 
-		/**
-		 * @brief Bounciness coefficient. Adjust depending on in-engine behaviour.
-		 */
-		float _bounciness;
+	/**
+	 * @brief Decides which game objects of a scene are inside the view of a camera, so that only those are recorded into the draw command buffer.
+	 * The hierarchy is walked using the subtree spheres of the game objects, so whole branches are accepted or rejected with one test. The game objects
+	 * that can't be decided this way have their world space bounding boxes tested against the frustum 4 at a time using SSE.
+	 */
+	class FrustumCuller {
+	public:
 
 		/**
-		 * @brief If this is set to true, _overriddenCenterOfMass will be used as center of mass.
+		 * @brief Game objects with a mesh that passed the last Cull call.
 		 */
-		bool _isCenterOfMassOverridden;
+		std::vector<GameObject*> _visibleObjects;
 
 		/**
-		 * @brief Overridden center of mass in local space.
+		 * @brief Game objects that need the bounding box test, along with their box centers and extents laid out
+		 * one component per array so they can be loaded straight into SSE registers.
 		 */
-		glm::vec3 _overriddenCenterOfMassLocalSpace;
+		struct {
+			std::vector<GameObject*> _gameObjects;
+			std::vector<float> _centerX, _centerY, _centerZ;
+			std::vector<float> _extentX, _extentY, _extentZ;
+		} _candidates;
 
 		/**
-		 * @brief Lock rotation along the X axis.
+		 * @brief Updates the bounds of the hierarchy starting at pRoot and fills _visibleObjects with the game objects that the frustum can see.
 		 */
-		bool _lockRotationX;
+		void Cull(const Frustum& frustum, GameObject* pRoot) {
+			_visibleObjects.clear();
+			_candidates._gameObjects.clear();
+			_candidates._centerX.clear(); _candidates._centerY.clear(); _candidates._centerZ.clear();
+			_candidates._extentX.clear(); _candidates._extentY.clear(); _candidates._extentZ.clear();
 
-		/**
-		 * @brief Lock rotation along the Y axis.
-		 */
-		bool _lockRotationY;
+			for (auto& child : pRoot->_children) {
+				child->UpdateBounds();
+				CollectCandidates(frustum, child, false);
+			}
 
-		/**
-		 * @brief Lock rotation along the Z axis.
-		 */
-		bool _lockRotationZ;
+			TestCandidates(frustum);
+		}
 
-		/**
-		 * @brief Lock translation along the X axis.
-		 */
-		bool _lockTranslationX;
+	private:
 
-		/**
-		 * @brief Lock translation along the Y axis.
-		 */
-		bool _lockTranslationY;
+		void AddCandidate(GameObject* pGameObject) {
+			auto center = pGameObject->_worldBounds.GetCenter();
+			auto extents = pGameObject->_worldBounds.GetExtents();
+			_candidates._gameObjects.push_back(pGameObject);
+			_candidates._centerX.push_back(center.x);
+			_candidates._centerY.push_back(center.y);
+			_candidates._centerZ.push_back(center.z);
+			_candidates._extentX.push_back(extents.x);
+			_candidates._extentY.push_back(extents.y);
+			_candidates._extentZ.push_back(extents.z);
+		}
 
-		/**
-		 * @brief Lock translation along the Z axis.
-		 */
-		bool _lockTranslationZ;
+		void CollectCandidates(const Frustum& frustum, GameObject* pGameObject, bool isParentInside) {
+			auto containment = isParentInside ? Frustum::Containment::Inside : frustum.Classify(pGameObject->_subtreeSphere);
+			if (containment == Frustum::Containment::Outside) return;
 
-		bool _isAffectedByGravity;
+			if (pGameObject->_pMesh != nullptr && !pGameObject->_worldBounds.IsEmpty()) {
+				if (containment == Frustum::Containment::Inside) _visibleObjects.push_back(pGameObject);
+				else {
+					// Try the sphere first, it is cheap and often enough to decide.
+					auto objectContainment = frustum.Classify(pGameObject->_worldSphere);
+					if (objectContainment == Frustum::Containment::Inside) _visibleObjects.push_back(pGameObject);
+					else if (objectContainment == Frustum::Containment::Intersecting) AddCandidate(pGameObject);
+				}
+			}
 
-		/**
-		 * @brief The cutoff time after which a collision becomes continuous or stops being continuous.
-		 */
-		int _continuousCollisionThresholdMilliseconds = 100;
+			for (auto& child : pGameObject->_children)
+				CollectCandidates(frustum, child, containment == Frustum::Containment::Inside);
+		}
 
-		/**
-		 * @brief The maximum time allowed between an angular velocity oscillation and another. If an oscillation happens quicker than this time, it is considered twitching.
-		 */
-		int _twitchingDetectionThresholdMilliseconds = 150;
+		void TestCandidates(const Frustum& frustum) {
+			auto count = _candidates._gameObjects.size();
+			if (count == 0) return;
 
-		std::chrono::high_resolution_clock::time_point _lastTimeCollided;
+			// Pad to a multiple of 4 so the last batch can be loaded whole. Padded entries are never read back.
+			auto paddedCount = (count + 3) & ~(size_t)3;
+			_candidates._centerX.resize(paddedCount); _candidates._centerY.resize(paddedCount); _candidates._centerZ.resize(paddedCount);
+			_candidates._extentX.resize(paddedCount); _candidates._extentY.resize(paddedCount); _candidates._extentZ.resize(paddedCount);
 
-		/**
-		 * @brief Last time an angular velocity oscillation was detected.
-		 */
-		std::chrono::high_resolution_clock::time_point _lastTimeTwitched;
+			__m128 planeX[6], planeY[6], planeZ[6], planeW[6], absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+			for (int p = 0; p < 6; ++p) {
+				planeX[p] = _mm_set1_ps(frustum._planes[p].x);
+				planeY[p] = _mm_set1_ps(frustum._planes[p].y);
+				planeZ[p] = _mm_set1_ps(frustum._planes[p].z);
+				planeW[p] = _mm_set1_ps(frustum._planes[p].w);
+				absPlaneX[p] = _mm_set1_ps(std::abs(frustum._planes[p].x));
+				absPlaneY[p] = _mm_set1_ps(std::abs(frustum._planes[p].y));
+				absPlaneZ[p] = _mm_set1_ps(std::abs(frustum._planes[p].z));
+			}
 
-		/**
-		 * @brief Number of times twitching was detected, increased when an angular velocity oscillation is detected and happens within the twitching time threshold from the last oscillation.
-		 */
-		int _twitchCount;
+			auto zero = _mm_setzero_ps();
+			for (size_t i = 0; i < paddedCount; i += 4) {
+				auto centerX = _mm_loadu_ps(&_candidates._centerX[i]);
+				auto centerY = _mm_loadu_ps(&_candidates._centerY[i]);
+				auto centerZ = _mm_loadu_ps(&_candidates._centerZ[i]);
+				auto extentX = _mm_loadu_ps(&_candidates._extentX[i]);
+				auto extentY = _mm_loadu_ps(&_candidates._extentY[i]);
+				auto extentZ = _mm_loadu_ps(&_candidates._extentZ[i]);
+				auto visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+				for (int p = 0; p < 6; ++p) {
+					// Signed distance of the box center from the plane, and the radius of the box projected on the plane normal.
+					auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)), _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+					auto radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absPlaneX[p], extentX), _mm_mul_ps(absPlaneY[p], extentY)), _mm_mul_ps(absPlaneZ[p], extentZ));
+					visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+				}
 
-		/**
-		 * @brief Twitch count threshold. If the twitch count is above this number, the angular velocity and the velocity are both set to zero, as it is assumed that the
-		 * object is at a resting position, and keeps chaning angular velocity really quickly due to collision detection and response inaccuracies.
-		 */
-		int _twitchCountThreshold = 3;
+				int mask = _mm_movemask_ps(visible);
+				for (size_t j = 0; j < 4 && i + j < count; ++j) {
+					if (mask & (1 << j)) _visibleObjects.push_back(_candidates._gameObjects[i + j]);
+				}
+			}
+		}
+	};
 
-		float _maxAngularSpeed = 5.0f;
+	/**
+	 * @brief Groups game objects that share the same mesh so that each mesh is drawn once with vkCmdDrawIndexed, using one instance per game object.
+	 * The object to world transform of each instance is read by the vertex shader from a per-instance vertex buffer.
+	 */
+	class MeshInstancer {
+	public:
 
 		/**
-		 * @brief True if the body has been colliding for longer than the continuous collision threshold, and false if it has not been colliding for longer than said threshold.
+		 * @brief Push constants of the scene pipeline, set for each batch. Must match PushConstants in VertexShader.vert.
 		 */
-		bool _isColliding = false;
+		struct PushConstants {
+			uint32_t materialIndex;
+			uint32_t materialFlags; // Material::Flags.
+			uint32_t padding[2];
+			glm::vec4 positionOffset;
+			glm::vec4 positionScale;
+		};
 
 		/**
-		 * @brief Physics update implementation for this specific rigidbody.
+		 * @brief Range of instances in the instance buffer that all use the same level of detail of the same mesh.
 		 */
-		void(*_updateImplementation)(GameObject&);
+		struct Batch {
+			Mesh* _pMesh;
+			size_t _lodIndex;
+			uint32_t _firstInstance;
+			uint32_t _instanceCount;
+		};
+
+		std::vector<Batch> _batches;
 
 		/**
-		 * @brief GameObject tied to this RigidBody.
+		 * @brief Object to world transform of each instance, in the same order as they are stored in the instance buffer.
 		 */
-		GameObject* _pGameObject;
+		std::vector<glm::mat4> _instanceTransforms;
 
 		/**
-		 * @brief Map where the key is the index of a vertex in _pMesh, and the value is a list of vertex indices directly connected to the vertex represented by the key.
+		 * @brief Host visible buffer bound to vertex input binding 1. Grows as needed, it never shrinks.
 		 */
-		 //std::map<unsigned int, std::vector<unsigned int>> _neighbors;
-
-		 /**
-		  * @brief Constructor.
-		  */
-		RigidBody() = default;
-
-		/*inline std::ostream& operator<< (std::ostream& stream, const glm::vec3& vector)
-		{
-			return stream << "(" << vector.x << ", " << vector.y << ", " << vector.z << ")";
-		}*/
-
-		static glm::vec3 CalculateTransmittedForce(const glm::vec3& transmitterPosition, const glm::vec3& force, const glm::vec3& receiverPosition);
+		Buffer _instanceBuffer;
 
 		/**
-		 * @brief Returns the center of mass in local space.
-		 * @return
+		 * @brief Selects the level of detail of each of gameObjects as seen by camera, sorts them by material, mesh and level of detail, fills _batches
+		 * and copies the instance transforms to the instance buffer. Must only be called when the GPU is not reading the instance buffer anymore.
 		 */
-		glm::vec3 GetCenterOfMass(bool worldSpace = false);
-
-		glm::vec3 GetVelocityAtPosition(const glm::vec3& position);
-
-		void AddForceAtPosition(const glm::vec3& force, const glm::vec3& pointOfApplication, const float& deltaTimeSeconds, bool isApplicationPointWorldSpace = true, bool isForceWorldSpace = true, const bool& ignoreMass = false);
+		void Build(VkContext& ctx, const std::vector<GameObject*>& gameObjects, Camera& camera) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Uniform);
+			_sortedInstances.clear();
+			for (auto pGameObject : gameObjects) {
+				// Meshes still streaming in have nothing to draw yet.
+				if (!pGameObject->_pMesh->_isResident) continue;
+				_sortedInstances.push_back(Instance{ pGameObject, pGameObject->_pMesh->SelectLod(pGameObject->_gameObjectData.transform, camera) });
+			}
+			std::stable_sort(_sortedInstances.begin(), _sortedInstances.end(), [](const Instance& a, const Instance& b) {
+				auto pMeshA = a._pGameObject->_pMesh;
+				auto pMeshB = b._pGameObject->_pMesh;
+				if (pMeshA->_materialIndex != pMeshB->_materialIndex) return pMeshA->_materialIndex < pMeshB->_materialIndex;
+				if (pMeshA != pMeshB) return std::less<Mesh*>()(pMeshA, pMeshB);
+				return a._lodIndex < b._lodIndex;
+			});
 
-		void AddForce(const glm::vec3& force, const float& deltaTimeSeconds, const bool& ignoreMass = false);
+			_batches.clear();
+			_instanceTransforms.resize(_sortedInstances.size());
+			for (size_t i = 0; i < _sortedInstances.size(); ++i) {
+				auto& instance = _sortedInstances[i];
+				auto pMesh = instance._pGameObject->_pMesh;
+				_instanceTransforms[i] = instance._pGameObject->_gameObjectData.transform;
+				if (_batches.size() == 0 || _batches.back()._pMesh != pMesh || _batches.back()._lodIndex != instance._lodIndex) {
+					_batches.push_back(Batch{ pMesh, instance._lodIndex, (uint32_t)i, 0 });
+				}
+				_batches.back()._instanceCount++;
+			}
 
-		void AddTorque(const glm::vec3& torqueWorldSpaceAxis, const float& deltaTimeSeconds, const bool& ignoreMass = false);
+			if (_instanceTransforms.size() == 0) return;
 
-		CollisionContext DetectCollision(RigidBody& other);
+			auto requiredSizeBytes = GetVectorSizeInBytes(_instanceTransforms);
+			if (requiredSizeBytes > _instanceBuffer._sizeBytes) {
+				if (_instanceBuffer._buffer != VK_NULL_HANDLE) {
+					VkHelper::DestroyBuffer(ctx._logicalDevice, _instanceBuffer._buffer, _instanceBuffer._gpuMemory, true);
+				}
 
-		std::vector< GameObject*> GetGameObjects(GameObject* pRoot, std::vector<GameObject*> excludedObjects = {});
+				auto newSizeBytes = std::max(requiredSizeBytes, _instanceBuffer._sizeBytes * 2);
+				VkHelper::CreateBuffer(ctx._logicalDevice, ctx._physicalDevice, newSizeBytes,
+					VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					&_instanceBuffer._buffer, &_instanceBuffer._gpuMemory);
+				_instanceBuffer._sizeBytes = newSizeBytes;
+				vkMapMemory(ctx._logicalDevice, _instanceBuffer._gpuMemory, 0, newSizeBytes, 0, &_instanceBuffer._cpuMemory);
+			}
 
-		std::vector<CollisionContext> DetectCollisions(VkContext& ctx, VkContext& collisionCtx, std::vector<RigidBody*> bodiesToExclude = {});
+			memcpy(_instanceBuffer._cpuMemory, _instanceTransforms.data(), requiredSizeBytes);
+		}
 
 		/**
-		 * @brief Basic init that guarantees the body's simulation.
+		 * @brief Binds the instance buffer and issues one instanced draw per mesh. When useMaterialTable is true the material table must already be bound,
+		 * and only the material index is pushed for each draw; otherwise the material descriptor set is bound whenever the material changes.
 		 */
-		void Initialize(GameObject* pGameObject, const float& mass = 1.0f, const bool& overrideCenterOfMass = false, const glm::vec3& overriddenCenterOfMass = glm::vec3{});
+		void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer, bool useMaterialTable) {
+			if (_batches.size() == 0) return;
 
-		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx);
-
-		bool IsRotationLocked();
-
-		bool IsTranslationLocked();
-
-		void LockRotation();
-
-		void LockTranslation();
-
-		void UnlockRotation();
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(drawCommandBuffer, 1, 1, &_instanceBuffer._buffer, &offset);
 
-		void UnlockTranslation();
-	};
+			Mesh* pPreviousMesh = nullptr;
+			for (auto& batch : _batches) {
+				if (!useMaterialTable && (pPreviousMesh == nullptr || pPreviousMesh->_materialIndex != batch._pMesh->_materialIndex)) {
+					batch._pMesh->BindMaterial(pipelineLayout, drawCommandBuffer);
+				}
 
-	class Mesh : public IVulkanUpdatable, public IDrawable, public IPipelineable {
+				// Every mesh has its own position dequantization, so the push constants change with every batch.
+				PushConstants pushConstants{};
+				pushConstants.materialIndex = (uint32_t)batch._pMesh->_materialIndex;
+				pushConstants.materialFlags = batch._pMesh->_pGameObject->_pScene->_materials[batch._pMesh->_materialIndex].GetFlags();
+				pushConstants.positionOffset = batch._pMesh->_vertices._positionOffset;
+				pushConstants.positionScale = batch._pMesh->_vertices._positionScale;
+				vkCmdPushConstants(drawCommandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pushConstants);
+				batch._pMesh->DrawInstanced(drawCommandBuffer, batch._instanceCount, batch._firstInstance, batch._lodIndex);
+				pPreviousMesh = batch._pMesh;
+			}
+		}
 
-	public:
+	private:
 
-		Mesh() = default;
-		~Mesh();
-		int _materialIndex = 0;
-		GameObject* _pGameObject = nullptr;
+		struct Instance {
+			GameObject* _pGameObject;
+			size_t _lodIndex;
+		};
 
-		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts);
-		void UpdateShaderResources();
-		void Update(VkContext& vkContext);
-		void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer);
+		std::vector<Instance> _sortedInstances;
 	};
 
 	/**
-	 * @brief Represents a physical object in a celeritas-engine scene.
+	 * @brief Makes meshes and textures resident on the GPU in the background, so that a scene can be drawn before all of it has been uploaded.
+	 * Worker threads take requests in order of priority and write their data to host visible staging buffers; once per frame the main thread
+	 * records the copies of the staged requests into a single submission, within an upload budget, and swaps the uploaded resources in.
 	 */
-	class GameObject : public IVulkanUpdatable, public IPipelineable, public IDrawable {
+	class AssetStreamer {
 	public:
 
 		/**
-		 * @brief Name of the game object.
+		 * @brief A resource to make resident. _prepare runs on a worker thread and writes the _sizeBytes bytes to upload to the mapped staging buffer it is given.
+		 * _record and _finish run on the main thread: _record records the copies out of the staging buffer, and _finish swaps the resource in once they are done.
 		 */
-		std::string _name;
+		struct Request {
+			std::string _name;
 
-		/**
-		 * @brief Pointer to the scene so you can use _materialIndex and _gameObjectIndex from this class.
-		 */
-		Scene* _pScene = nullptr;
+			/**
+			 * @brief Requests with lower values are staged first. See GetPriority.
+			 */
+			float _priority = 0.0f;
+			size_t _sizeBytes = 0;
+			std::function<void(unsigned char* pStaging)> _prepare;
+			std::function<void(VkCommandBuffer& commandBuffer, VkBuffer stagingBuffer)> _record;
+			std::function<void()> _finish;
+		};
 
-		/**
-		 * @brief Parent game object pointer.
-		 */
-		GameObject* _pParent = nullptr;
+		struct Progress {
+			size_t _residentCount;
+			size_t _requestCount;
+			uint64_t _residentBytes;
+			uint64_t _requestBytes;
+		};
 
 		/**
-		 * @brief Child game object pointers.
+		 * @brief Priority of a resource drawn with objectToWorld, that bounds are the bounds of: how far the viewer is from its bounding sphere.
 		 */
-		std::vector<GameObject*> _children;
+		static float GetPriority(const BoundingBox& bounds, const glm::mat4& objectToWorld, const glm::vec3& viewerPosition) {
+			auto center = glm::vec3(objectToWorld * glm::vec4(bounds.GetCenter(), 1.0f));
+			auto maxScale = std::max({ glm::length(glm::vec3(objectToWorld[0])), glm::length(glm::vec3(objectToWorld[1])), glm::length(glm::vec3(objectToWorld[2])) });
+			return std::max(glm::length(center - viewerPosition) - glm::length(bounds.GetExtents()) * maxScale, 0.0f);
+		}
 
 		/**
-		 * @brief Mesh of this game object.
+		 * @brief Adds a request to the queue. Can be called before Start.
 		 */
-		Mesh* _pMesh = nullptr;
+		void Enqueue(Request request) {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_progress._requestCount++;
+				_progress._requestBytes += request._sizeBytes;
+
+				// Pending requests are sorted from the last to be staged to the first, so that workers take them from the back.
+				auto position = std::upper_bound(_pending.begin(), _pending.end(), request._priority, [](float priority, const Request& pending) { return priority > pending._priority; });
+				_pending.insert(position, std::move(request));
+			}
+			_condition.notify_one();
+		}
 
 		/**
-		 * @brief Body for physics simulation.
+		 * @brief Starts workerCount worker threads. Update uploads at most uploadBudgetBytes each frame, except for requests larger than that, which are uploaded on their own.
 		 */
-		RigidBody* _pBody;
+		void Start(VkContext& ctx, uint32_t workerCount, size_t uploadBudgetBytes) {
+			_logicalDevice = ctx._logicalDevice;
+			_physicalDevice = ctx._physicalDevice;
+			Resize(workerCount, uploadBudgetBytes);
+		}
 
 		/**
-		 * @brief Transform relative to the parent gameobject.
+		 * @brief Changes the number of worker threads and the upload budget of a started streamer. Must be called on the main thread. Workers that are
+		 * no longer needed finish the request they are staging before they leave, and this waits for them.
 		 */
-		Transform _localTransform;
-
-		struct {
-			glm::mat4x4 transform;
-		} _gameObjectData;
-
-		GameObject() = default;
-		GameObject(const std::string& name, Scene* pScene);
-		~GameObject();
-		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts);
-		Transform GetWorldSpaceTransform();
-		void UpdateShaderResources();
-		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx);
-		void Update(VkContext& vkContext);
-		void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer);
-	};
-
-	struct GpuCollisionDetector {
-		static int GetComputeQueueFamilyIndex(const VkPhysicalDevice& physicalDevice) {
-			//find a queue family for a selected GPU, select the first available for use
-			uint32_t queueFamilyCount;
-			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, NULL);
-
-			VkQueueFamilyProperties* queueFamilies = (VkQueueFamilyProperties*)malloc(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
+		void Resize(uint32_t workerCount, size_t uploadBudgetBytes) {
+			workerCount = std::max(workerCount, 1u);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_workerCount = workerCount;
+				_uploadBudgetBytes = std::max(uploadBudgetBytes, (size_t)1);
+			}
+			_condition.notify_all();
 
-			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies);
-			uint32_t i = 0;
-			for (; i < queueFamilyCount; i++) {
-				VkQueueFamilyProperties props = queueFamilies[i];
-				if (props.queueCount > 0 && (props.queueFlags & VK_QUEUE_COMPUTE_BIT)) break;
+			while (_workers.size() > workerCount) {
+				_workers.back().join();
+				_workers.pop_back();
 			}
-			free(queueFamilies);
-			if (i == queueFamilyCount) return -1;
-			return i;
+			while (_workers.size() < workerCount) _workers.emplace_back(&AssetStreamer::Work, this, (uint32_t)_workers.size());
 		}
 
-		static void CreateNewComputeDevice(VkDevice& device, VkPhysicalDevice& physicalDevice, VkDevice& outComputeDevice, VkQueue& outComputeQueue, uint32_t& outComputeQueueFamilyIndex) {
-			int computeFamilyIndex = GetComputeQueueFamilyIndex(physicalDevice);
-			if (computeFamilyIndex < 0) return;
-
-			float queuePriorities = 1.0;
-			VkDeviceQueueCreateInfo deviceQueueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO, 0, (VkDeviceQueueCreateFlags)0, (uint32_t)computeFamilyIndex,(uint32_t)1, (const float*)&queuePriorities };
+		/**
+		 * @brief Uploads staged requests in the order they were staged until the upload budget is spent, then swaps them in. Must be called on the main thread,
+		 * while the GPU is not using any of the resources the requests replace.
+		 */
+		void Update(VkContext& ctx) {
+			Profiler::ScopedZone zone("Streaming uploads");
+			std::vector<StagedRequest> uploads;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				size_t uploadSizeBytes = 0;
+				size_t uploadCount = 0;
+				while (uploadCount < _staged.size() && (uploadCount == 0 || uploadSizeBytes + _staged[uploadCount]._request._sizeBytes <= _uploadBudgetBytes)) {
+					uploadSizeBytes += _staged[uploadCount]._request._sizeBytes;
+					uploadCount++;
+				}
+				uploads.assign(std::make_move_iterator(_staged.begin()), std::make_move_iterator(_staged.begin() + uploadCount));
+				_staged.erase(_staged.begin(), _staged.begin() + uploadCount);
+			}
+			if (uploads.size() == 0) return;
 
-			VkPhysicalDeviceFeatures physicalDeviceFeatures = { 0 };
-			//physicalDeviceFeatures.shaderFloat64 = VK_TRUE;//this enables double precision support in shaders 
+			auto commandBuffer = VkHelper::CreateCommandBuffer(ctx._logicalDevice, ctx._commandPool);
+			VkHelper::StartRecording(commandBuffer);
+			for (auto& upload : uploads) upload._request._record(commandBuffer, upload._stagingBuffer._buffer);
 
-			VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-					0,
-					(VkDeviceCreateFlags)0,
-					(uint32_t)1,
-					(const VkDeviceQueueCreateInfo*)&deviceQueueCreateInfo,
-					(uint32_t)0,
-					(const char* const*)NULL,
-					(uint32_t)0,
-					(const char* const*)NULL,
-					(const VkPhysicalDeviceFeatures*)&physicalDeviceFeatures };
+			// Whatever was uploaded can be read by any later command.
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+			VkHelper::StopRecording(commandBuffer);
+			VkHelper::ExecuteCommands(commandBuffer, ctx._queue);
+			vkFreeCommandBuffers(ctx._logicalDevice, ctx._commandPool, 1, &commandBuffer);
 
-			CheckResult(vkCreateDevice(physicalDevice, &deviceCreateInfo, NULL, &outComputeDevice));
-			outComputeQueueFamilyIndex = computeFamilyIndex;
+			uint64_t uploadedBytes = 0;
+			for (auto& upload : uploads) {
+				upload._request._finish();
+				VkHelper::DestroyBuffer(ctx._logicalDevice, upload._stagingBuffer._buffer, upload._stagingBuffer._gpuMemory, true);
+				uploadedBytes += upload._request._sizeBytes;
+			}
 
-			vkGetDeviceQueue(outComputeDevice, computeFamilyIndex, 0, &outComputeQueue);
-			if (!outComputeQueue) { std::cout << "Failed to get compute queue" << std::endl; return; }
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stagedBytes -= uploadedBytes;
+				_progress._residentCount += uploads.size();
+				_progress._residentBytes += uploadedBytes;
+			}
+			_condition.notify_all();
 		}
 
-		static VkContext InitializeVulkan(VkDevice& device, VkPhysicalDevice physicalDevice) {
-			// Create logical device representation.
-			VkContext ctx;
-			ctx._physicalDevice = physicalDevice;
-			CreateNewComputeDevice(device, physicalDevice, ctx._logicalDevice, ctx._queue, ctx._queueFamilyIndex);
-			if (!ctx._logicalDevice) { std::cout << "Failed to create compute device" << std::endl; return {}; }
+		/**
+		 * @brief Whether some of the enqueued requests are not resident yet.
+		 */
+		bool IsLoading() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _progress._residentCount < _progress._requestCount;
+		}
 
-			// Create a fence for synchronization.
-			VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, 0 };
-			if (vkCreateFence(ctx._logicalDevice, &fenceCreateInfo, NULL, &ctx._queueFence)) { std::cout << "Fence creation failed." << std::endl; }
+		Progress GetProgress() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _progress;
+		}
 
-			// Create a structure from which command buffer memory is allocated from.
-			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, NULL, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, ctx._queueFamilyIndex };
-			if (vkCreateCommandPool(ctx._logicalDevice, &commandPoolCreateInfo, NULL, &ctx._commandPool)) { std::cout << "Command Pool Creation failed." << std::endl; }
-			return ctx;
+		/**
+		 * @brief Joins the worker threads. Requests that are not resident yet are dropped.
+		 */
+		void Stop(VkContext& ctx) {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_isStopping = true;
+			}
+			_condition.notify_all();
+			for (auto& worker : _workers) worker.join();
+			_workers.clear();
+
+			for (auto& staged : _staged) VkHelper::DestroyBuffer(ctx._logicalDevice, staged._stagingBuffer._buffer, staged._stagingBuffer._gpuMemory, true);
+			_staged.clear();
+			_pending.clear();
 		}
 
-		static std::vector<uint32_t> CalculateWorkGroupCount(VkPhysicalDeviceProperties& gpuProperties, uint32_t minimumThreadCount, const std::vector<uint32_t>& workGroupSize) {
-			// Prepare variables.
-			uint32_t maxWorkGroupInvocations = gpuProperties.limits.maxComputeWorkGroupInvocations;
-			uint32_t* maxWorkGroupSize = gpuProperties.limits.maxComputeWorkGroupSize;
-			uint32_t* maxWorkGroupCount = gpuProperties.limits.maxComputeWorkGroupCount;
-			std::vector<uint32_t> outWorkGroupCount = { 1, 1, 1 };
+	private:
 
-			// Use the work group size first, as that directly controls the amount of threads 1 to 1.
-			uint32_t totalWorkGroupSize = workGroupSize[0] * workGroupSize[1] * workGroupSize[2];
-			if (totalWorkGroupSize >= minimumThreadCount) return outWorkGroupCount;
+		struct StagedRequest {
+			Request _request;
+			Buffer _stagingBuffer;
+		};
 
-			// If one workgroup still doesn't do it, use multiple workgroups with the size of each one calculated earlier.
-			if (totalWorkGroupSize < minimumThreadCount) {
-				for (int i = 0; i < 3; ++i) {
-					for (; outWorkGroupCount[i] < maxWorkGroupCount[i]; ++outWorkGroupCount[i]) {
-						if (((outWorkGroupCount[0] * outWorkGroupCount[1] * outWorkGroupCount[2]) * totalWorkGroupSize) >= minimumThreadCount) { return outWorkGroupCount; }
-					}
-				}
-			}
+		/**
+		 * @brief Staged requests hold on to host visible memory until they are uploaded, so workers stop staging once this many frames worth of uploads are waiting.
+		 */
+		static constexpr size_t _maxStagedFrames = 4;
 
-			return { 0,0,0 };
-		}
+		VkDevice _logicalDevice = VK_NULL_HANDLE;
+		VkPhysicalDevice _physicalDevice = VK_NULL_HANDLE;
+		size_t _uploadBudgetBytes = 0;
 
-		static VkResult AllocateGPUOnlyBuffer(VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize bufferSizeBytes, VkContext& ctx, VkBuffer* outBuffer, VkDeviceMemory* outDeviceMemory) {
-			//allocate the buffer used by the GPU with specified properties
-			VkResult res = VK_SUCCESS;
-			uint32_t queueFamilyIndices;
-			VkBufferCreateInfo bufferCreateInfo;
-			bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferCreateInfo.pNext = 0;
-			bufferCreateInfo.flags = (VkBufferCreateFlags)0;
-			bufferCreateInfo.size = (VkDeviceSize)bufferSizeBytes;
-			bufferCreateInfo.usage = (VkBufferUsageFlags)bufferUsageFlags;
-			bufferCreateInfo.sharingMode = (VkSharingMode)VK_SHARING_MODE_EXCLUSIVE;
-			bufferCreateInfo.queueFamilyIndexCount = (uint32_t)1;
-			bufferCreateInfo.pQueueFamilyIndices = (const uint32_t*)&queueFamilyIndices;
+		/**
+		 * @brief Workers whose index is not below this leave.
+		 */
+		uint32_t _workerCount = 0;
 
-			res = vkCreateBuffer(ctx._logicalDevice, &bufferCreateInfo, NULL, outBuffer);
-			if (res != VK_SUCCESS) return res;
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		std::vector<std::thread> _workers;
+		bool _isStopping = false;
 
-			VkMemoryRequirements memoryRequirements = { 0 };
-			vkGetBufferMemoryRequirements(ctx._logicalDevice, *outBuffer, &memoryRequirements);
+		std::vector<Request> _pending;
+		std::vector<StagedRequest> _staged;
+		uint64_t _stagedBytes = 0;
+		Progress _progress{ 0, 0, 0, 0 };
 
-			//find memory with specified properties
-			uint32_t memoryTypeIndex = 0xFFFFFFFF;
-			VkPhysicalDeviceMemoryProperties gpuMemoryProps;
-			vkGetPhysicalDeviceMemoryProperties(ctx._physicalDevice, &gpuMemoryProps);
+		void Work(uint32_t workerIndex) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Staging);
+			Profiler::Instance().SetThreadName("Streaming worker " + std::to_string(workerIndex));
+			while (true) {
+				StagedRequest staged;
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					_condition.wait(lock, [this, workerIndex]() { return _isStopping || workerIndex >= _workerCount || (_pending.size() > 0 && _stagedBytes < _uploadBudgetBytes * _maxStagedFrames); });
+					if (_isStopping || workerIndex >= _workerCount) return;
+					staged._request = std::move(_pending.back());
+					_pending.pop_back();
+					_stagedBytes += staged._request._sizeBytes;
+				}
 
-			for (uint32_t i = 0; i < gpuMemoryProps.memoryTypeCount; ++i) {
-				if ((memoryRequirements.memoryTypeBits & (1 << i)) && ((gpuMemoryProps.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)) {
-					memoryTypeIndex = i;
-					break;
+				// Creating and mapping buffers does not touch the queue, so it is safe to do while the main thread is drawing.
+				auto& buffer = staged._stagingBuffer;
+				buffer._sizeBytes = std::max(staged._request._sizeBytes, (size_t)1);
+				VkHelper::CreateBuffer(_logicalDevice, _physicalDevice, buffer._sizeBytes,
+					VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					&buffer._buffer, &buffer._gpuMemory);
+				vkMapMemory(_logicalDevice, buffer._gpuMemory, 0, buffer._sizeBytes, 0, &buffer._cpuMemory);
+				{
+					Profiler::ScopedZone zone("Stage asset");
+					staged._request._prepare((unsigned char*)buffer._cpuMemory);
 				}
+
+				std::lock_guard<std::mutex> lock(_mutex);
+				_staged.push_back(std::move(staged));
 			}
-			if (0xFFFFFFFF == memoryTypeIndex) return VK_ERROR_INITIALIZATION_FAILED;
+		}
+	};
 
-			VkMemoryAllocateInfo memoryAllocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-										 0,
-										 (VkDeviceSize)memoryRequirements.size,
-										 (uint32_t)memoryTypeIndex };
+	/**
+	 * @brief Bindless alternative to the per mesh material descriptor sets: every texture of the scene is put in one array of combined image samplers,
+	 * and a storage buffer maps each material index to the indices of its textures in that array. The whole table is bound once per frame,
+	 * and draws only need to tell the shaders which material they use.
+	 */
+	class MaterialTable {
+	public:
 
-			res = vkAllocateMemory(ctx._logicalDevice, &memoryAllocateInfo, NULL, outDeviceMemory);
-			if (res != VK_SUCCESS) return res;
+		/**
+		 * @brief Indices of the textures of a material in the texture array. Must match MaterialData in BindlessFragmentShader.frag.
+		 */
+		struct MaterialData {
+			uint32_t albedoIndex;
+			uint32_t occlusionRoughnessMetalnessIndex;
+			uint32_t normalIndex;
+			uint32_t emissiveIndex;
+		};
 
-			res = vkBindBufferMemory(ctx._logicalDevice, *outBuffer, *outDeviceMemory, 0);
-			return res;
-		}
+		/**
+		 * @brief Whether the table is in use. False if disabled in the settings, or if the device cannot index as many textures as the scene has.
+		 */
+		bool _isEnabled = false;
 
-		static VkResult CreateComputePipeline(VkBuffer* shaderBuffersArray, VkDeviceSize* arrayOfSizesOfEachBuffer, const char* shaderFilePath, VkContext& ctx, VkPipeline& outPipeline, VkPipelineLayout& outLayout, VkDescriptorSet& outDescriptorSet, VkDescriptorPool& outDescriptorPool) {
-			VkResult res = VK_SUCCESS;
+		/**
+		 * @brief Every unique texture of the scene, in the order they appear in the texture array.
+		 */
+		std::vector<Image> _textures;
 
-			// We now have 5 buffers: vertexA, indexA, vertexB, indexB, result
-			uint32_t descriptorCount = 5;
+		/**
+		 * @brief One entry per material of the scene, indexed by Mesh::_materialIndex.
+		 */
+		std::vector<MaterialData> _materialData;
 
-			VkDescriptorPoolSize descriptorPoolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descriptorCount };
+		Buffer _materialBuffer;
 
-			const VkDescriptorType descriptorTypes[5] = {
-				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // vertex A
-				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // index A
-				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // vertex B
-				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // index B
-				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER  // output
-			};
+		/**
+		 * @brief Layout that replaces the per mesh material layout (set 3) in the scene pipelines when the table is in use.
+		 */
+		DescriptorSetLayout _setLayout;
 
-			VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, 1, 1, &descriptorPoolSize };
-			CheckResult(vkCreateDescriptorPool(ctx._logicalDevice, &descriptorPoolCreateInfo, nullptr, &outDescriptorPool));
+		VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
 
-			VkDescriptorSetLayoutBinding* descriptorSetLayoutBindings = (VkDescriptorSetLayoutBinding*)malloc(descriptorCount * sizeof(VkDescriptorSetLayoutBinding));
-			for (uint32_t i = 0; i < descriptorCount; ++i) {
-				descriptorSetLayoutBindings[i].binding = i;
-				descriptorSetLayoutBindings[i].descriptorType = descriptorTypes[i];
-				descriptorSetLayoutBindings[i].descriptorCount = 1;
-				descriptorSetLayoutBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-				descriptorSetLayoutBindings[i].pImmutableSamplers = nullptr;
+		/**
+		 * @brief Indexing the texture array only requires dynamic indexing, which is a core feature, instead of the non uniform indexing of descriptor
+		 * indexing, as long as the material index is the same for every invocation of a rendering command. The draws of a single multi-draw indirect command
+		 * are not guaranteed to be separate invocation groups, so every indirect command issued with the table bound must only draw one material.
+		 */
+		static bool IsSupported(VkPhysicalDevice& physicalDevice) {
+			VkPhysicalDeviceFeatures features{};
+			vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+			return features.shaderSampledImageArrayDynamicIndexing;
+		}
+
+		/**
+		 * @brief Gathers the textures of the meshes of the scene and creates the table. Must be called after the scene's descriptor sets have been created,
+		 * because that is when the textures are sent to the GPU.
+		 */
+		void Create(VkContext& ctx, Scene& scene) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Uniform);
+			_materialData.assign(scene._materials.size(), MaterialData{ 0, 0, 0, 0 });
+			for (auto& pMesh : scene._meshes) {
+				if (pMesh == nullptr || pMesh->_images.size() < Material::MapTypeCount) continue;
+				auto& materialData = _materialData[pMesh->_materialIndex];
+				materialData.albedoIndex = AddTexture(pMesh->_images[Material::Albedo]);
+				materialData.occlusionRoughnessMetalnessIndex = AddTexture(pMesh->_images[Material::OcclusionRoughnessMetalness]);
+				materialData.normalIndex = AddTexture(pMesh->_images[Material::Normal]);
+				materialData.emissiveIndex = AddTexture(pMesh->_images[Material::Emissive]);
+			}
+			if (_textures.size() == 0) return;
+
+			// The environment map also takes up a sampler in the fragment stage.
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(ctx._physicalDevice, &properties);
+			auto maxTextures = std::min({ properties.limits.maxPerStageDescriptorSamplers, properties.limits.maxPerStageDescriptorSampledImages, properties.limits.maxDescriptorSetSamplers }) - 1;
+			if (_textures.size() > maxTextures) {
+				Logger::Warning("the scene has {} textures but the device can only index {}, falling back to per mesh material descriptor sets", _textures.size(), maxTextures);
+				return;
 			}
+			auto textureCount = (uint32_t)_textures.size();
 
-			VkDescriptorSetLayout descriptorSetLayout;
-			VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
-				VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, descriptorCount, descriptorSetLayoutBindings
+			VkDescriptorSetLayoutBinding bindings[2] = {
+				VkDescriptorSetLayoutBinding { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureCount, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr },
+				VkDescriptorSetLayoutBinding { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
 			};
-			CheckResult(vkCreateDescriptorSetLayout(ctx._logicalDevice, &descriptorSetLayoutCreateInfo, nullptr, &descriptorSetLayout));
-			free(descriptorSetLayoutBindings);
-
-			VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, outDescriptorPool, 1, &descriptorSetLayout };
+			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+			layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutCreateInfo.bindingCount = 2;
+			layoutCreateInfo.pBindings = bindings;
+			_setLayout._name = "materialTableLayout";
+			_setLayout._id = 3;
+			CheckResult(vkCreateDescriptorSetLayout(ctx._logicalDevice, &layoutCreateInfo, nullptr, &_setLayout._layout));
 
-			CheckResult(vkAllocateDescriptorSets(ctx._logicalDevice, &descriptorSetAllocateInfo, &outDescriptorSet));
+			// The material data never changes, so it lives in device local memory.
+			auto materialBufferSize = GetVectorSizeInBytes(_materialData);
+			VkHelper::CreateBuffer(ctx._logicalDevice, ctx._physicalDevice, materialBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&_materialBuffer._buffer, &_materialBuffer._gpuMemory);
+			_materialBuffer._sizeBytes = materialBufferSize;
+			VkHelper::UploadData(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, _materialBuffer._buffer, _materialData.data(), materialBufferSize);
+
+			// The texture array can be larger than what a set of the shared descriptor allocator is sized for, so the table gets a pool of its own.
+			VkDescriptorPoolSize poolSizes[2] = {
+				VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureCount },
+				VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 }
+			};
+			VkDescriptorPoolCreateInfo createInfo = {};
+			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			createInfo.maxSets = (uint32_t)1;
+			createInfo.poolSizeCount = (uint32_t)2;
+			createInfo.pPoolSizes = poolSizes;
+			CheckResult(ResourceTracker::CreateDescriptorPool(ctx._logicalDevice, &createInfo, nullptr, &_descriptorPool));
+			_descriptorSet = VkHelper::AllocateDescriptorSet(ctx._logicalDevice, _descriptorPool, _setLayout._layout);
 
-			for (uint32_t i = 0; i < descriptorCount; ++i) {
-				VkDescriptorBufferInfo descriptorBufferInfo = { shaderBuffersArray[i], 0, arrayOfSizesOfEachBuffer[i] };
-				VkWriteDescriptorSet writeDescriptorSet = {
-					VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, outDescriptorSet, i, 0, 1,
-					descriptorTypes[i], nullptr, &descriptorBufferInfo, nullptr
-				};
-				vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeDescriptorSet, 0, nullptr);
+			std::vector<VkDescriptorImageInfo> imageInfos(_textures.size());
+			for (size_t i = 0; i < _textures.size(); ++i) {
+				imageInfos[i] = { _textures[i]._sampler, _textures[i]._view, _textures[i]._currentLayout };
 			}
+			VkDescriptorBufferInfo bufferInfo{ _materialBuffer._buffer, 0, _materialBuffer._sizeBytes };
 
-			VkPushConstantRange range = {};
-			range.offset = 0;
-			range.size = 144;
-			range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			VkWriteDescriptorSet writeInfos[2] = {};
+			writeInfos[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfos[0].dstSet = _descriptorSet;
+			writeInfos[0].dstBinding = 0;
+			writeInfos[0].descriptorCount = textureCount;
+			writeInfos[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writeInfos[0].pImageInfo = imageInfos.data();
+			writeInfos[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfos[1].dstSet = _descriptorSet;
+			writeInfos[1].dstBinding = 1;
+			writeInfos[1].descriptorCount = 1;
+			writeInfos[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writeInfos[1].pBufferInfo = &bufferInfo;
+			vkUpdateDescriptorSets(ctx._logicalDevice, 2, writeInfos, 0, nullptr);
 
-			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
-				VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO, nullptr, 0, 1, &descriptorSetLayout, 1, &range
-			};
-			CheckResult(vkCreatePipelineLayout(ctx._logicalDevice, &pipelineLayoutCreateInfo, nullptr, &outLayout));
+			_isEnabled = true;
+		}
 
-			VkShaderModule shaderModule = VkHelper::CreateShaderModule(ctx._logicalDevice, shaderFilePath);
+		/**
+		 * @brief Points the slot of the texture array holding oldImage to newImage, e.g. when a streamed texture replaces its placeholder. Must only be called
+		 * when the GPU is not using the table.
+		 */
+		void ReplaceTexture(VkContext& ctx, const Image& oldImage, const Image& newImage) {
+			auto existing = std::find_if(_textures.begin(), _textures.end(), [&oldImage](const Image& texture) { return texture._image == oldImage._image; });
+			if (existing == _textures.end()) return;
+			*existing = newImage;
+			if (!_isEnabled) return;
 
-			VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo = {
-				VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT,
-				shaderModule, "main", nullptr
-			};
+			VkDescriptorImageInfo imageInfo{ newImage._sampler, newImage._view, newImage._currentLayout };
+			VkWriteDescriptorSet writeInfo = {};
+			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeInfo.dstSet = _descriptorSet;
+			writeInfo.dstBinding = 0;
+			writeInfo.dstArrayElement = (uint32_t)(existing - _textures.begin());
+			writeInfo.descriptorCount = 1;
+			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writeInfo.pImageInfo = &imageInfo;
+			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+		}
 
-			VkComputePipelineCreateInfo computePipelineCreateInfo = {
-				VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
-				pipelineShaderStageCreateInfo, outLayout, VK_NULL_HANDLE, 0
-			};
+	private:
 
-			res = vkCreateComputePipelines(ctx._logicalDevice, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &outPipeline);
-			vkDestroyShaderModule(ctx._logicalDevice, shaderModule, nullptr);
-			vkDestroyDescriptorSetLayout(ctx._logicalDevice, descriptorSetLayout, nullptr);
-			return res;
+		VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+
+		uint32_t AddTexture(const Image& image) {
+			auto existing = std::find_if(_textures.begin(), _textures.end(), [&image](const Image& texture) { return texture._image == image._image; });
+			if (existing != _textures.end()) return (uint32_t)(existing - _textures.begin());
+			_textures.push_back(image);
+			return (uint32_t)(_textures.size() - 1);
 		}
+	};
 
-		static void Dispatch(VkContext& ctx, VkPipeline pipeline, VkPipelineLayout pipelineLayout,
-			VkDescriptorSet descriptorSet, std::vector<uint32_t>& workGroupCount,
-			const glm::mat4x4& objectToWorldA, const glm::mat4x4& objectToWorldB, uint32_t& objectAnormal) {
+	/**
+	 * @brief GPU-driven path for drawing the meshes of a scene. All vertices and indices are merged into one vertex buffer and one index buffer,
+	 * the data of each object and of each meshlet lives in storage buffers, and a compute shader culls the meshlets of the objects against the
+	 * camera frustum and by their normal cone, appending one VkDrawIndexedIndirectCommand per visible meshlet. The whole scene is then drawn with
+	 * one vkCmdDrawIndexedIndirect per material, so the CPU cost of drawing does not grow with the number of game objects, and the GPU only
+	 * processes the parts of large meshes that can be seen.
+	 */
+	class GpuDrivenScene : public IPipelineable, public IDrawable {
+	public:
 
-			// Define push constants structure matching the shader
-			struct PushConstants {
-				glm::mat4x4 localToWorldA;
-				glm::mat4x4 localToWorldB;
-				uint32_t objectAnormal;
-			} pushConstants;
-			pushConstants.localToWorldA = objectToWorldA;
-			pushConstants.localToWorldB = objectToWorldB;
-			pushConstants.objectAnormal = objectAnormal;
+		/**
+		 * @brief Per object data read by the culling compute shader and by the vertex shader. Must match ObjectData in ClusterCulling.comp and GpuDrivenVertexShader.vert.
+		 */
+		struct ObjectData {
+			glm::mat4 objectToWorld;
+			glm::vec4 boundsCenter;
+			glm::vec4 boundsExtents;
 
-			// Record compute shader pipeline commands
-			auto commandBuffer = VkHelper::CreateCommandBuffer(ctx._logicalDevice, ctx._commandPool);
-			VkHelper::StartRecording(commandBuffer);
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
-			vkCmdDispatch(commandBuffer, workGroupCount[0], workGroupCount[1], workGroupCount[2]);
-			VkHelper::StopRecording(commandBuffer);
+			/**
+			 * @brief Range of the meshlets of the level of detail drawn this frame, within the meshlet buffer.
+			 */
+			uint32_t firstMeshlet;
+			uint32_t meshletCount;
+			int32_t vertexOffset;
+			uint32_t materialIndex;
+			glm::vec4 positionOffset;
+			glm::vec4 positionScale;
 
-			// Submit the command buffer
-			VkSubmitInfo submitInfo = {};
-			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			submitInfo.commandBufferCount = 1;
-			submitInfo.pCommandBuffers = &commandBuffer;
-			clock_t t = clock();
-			CheckResult(vkQueueSubmit(ctx._queue, 1, &submitInfo, ctx._queueFence));
-			CheckResult(vkWaitForFences(ctx._logicalDevice, 1, &ctx._queueFence, VK_TRUE, 30000000000));
+			/**
+			 * @brief Index of the culling invocation that handles the first meshlet of the object. Invocations are handed out to objects in order.
+			 */
+			uint32_t firstThread;
+
+			/**
+			 * @brief Batch the draw commands of the object are appended to, and first command of that batch.
+			 */
+			uint32_t batchIndex;
+			uint32_t firstCommand;
+			uint32_t materialFlags; // Material::Flags.
+		};
+
+		/**
+		 * @brief Per meshlet data read by the culling compute shader. Must match MeshletData in ClusterCulling.comp.
+		 */
+		struct MeshletData {
+			glm::vec4 sphere; // Object space center, radius in w.
+			glm::vec4 cone;   // Object space axis, cutoff in w.
+			uint32_t firstIndex; // In the merged index buffer.
+			uint32_t indexCount;
+			uint32_t padding[2];
+		};
+
+		/**
+		 * @brief Range of draw commands that share the same material, and can therefore be drawn with a single indirect draw call. There is room for
+		 * every meshlet of every object of the batch; culling fills the range from the start and leaves the rest as empty commands.
+		 */
+		struct Batch {
+			VkDescriptorSet _materialSet;
+			uint32_t _firstCommand;
+			uint32_t _commandCount;
+		};
 
-			// Reset fence and free command buffer
-			CheckResult(vkResetFences(ctx._logicalDevice, 1, &ctx._queueFence));
-			vkFreeCommandBuffers(ctx._logicalDevice, ctx._commandPool, 1, &commandBuffer);
-		}
+		/**
+		 * @brief Whether the GPU-driven path is in use. False if disabled in the settings, or if the device does not support it.
+		 */
+		bool _isEnabled = false;
 
-		static CollisionContext Run(VkContext& collisionCtx, RigidBody& bodyA, RigidBody& bodyB, bool& outCollided) {
-			// Get device properties and memory properties, if needed.
-			VkPhysicalDeviceProperties gpuProperties;
-			VkPhysicalDeviceMemoryProperties gpuMemoryProperties;
-			vkGetPhysicalDeviceProperties(collisionCtx._physicalDevice, &gpuProperties);
-			vkGetPhysicalDeviceMemoryProperties(collisionCtx._physicalDevice, &gpuMemoryProperties);
+		/**
+		 * @brief Game objects drawn by this path, sorted by material. The index of a game object in here is also the index of its ObjectData.
+		 */
+		std::vector<GameObject*> _gameObjects;
 
-			RigidBody* a = &bodyA;
-			RigidBody* b = &bodyB;
-			uint32_t objectAnormal = 0;
+		std::vector<ObjectData> _objectData;
 
-			if (a->_pGameObject->_pMesh->_vertices._vertexData.size() < b->_pGameObject->_pMesh->_vertices._vertexData.size()) {
-				auto tmp = b;
-				b = a;
-				a = tmp;
-				objectAnormal = 1;
-			}
+		/**
+		 * @brief First meshlet of the mesh of each game object in the meshlet buffer, to which the offset of the selected level of detail is added.
+		 */
+		std::vector<uint32_t> _meshFirstMeshlets;
 
-			auto& aVertices = a->_pGameObject->_pMesh->_vertices._vertexData;
-			auto& bVertices = b->_pGameObject->_pMesh->_vertices._vertexData;
-			auto& aIndices = a->_pGameObject->_pMesh->_faceIndices._indexData;
-			auto& bIndices = b->_pGameObject->_pMesh->_faceIndices._indexData;
+		/**
+		 * @brief Number of culling invocations needed this frame, one per meshlet of the selected levels of detail.
+		 */
+		uint32_t _threadCount = 0;
 
-			size_t sizeA_bytes = aVertices.size() * sizeof(glm::vec4);
-			size_t sizeB_bytes = bVertices.size() * sizeof(glm::vec4);
-			size_t sizeIndexA_bytes = aIndices.size() * sizeof(uint32_t);
-			size_t sizeIndexB_bytes = bIndices.size() * sizeof(uint32_t);
+		/**
+		 * @brief Size of the draw command buffer, in commands.
+		 */
+		uint32_t _commandCount = 0;
 
-			auto faceCount = aIndices.size() / 3;
-			auto outputCount = faceCount * 2;
-			size_t sizeOutputBytes = sizeof(glm::vec4) * outputCount;
-			glm::vec4* dataInputBufferA = (glm::vec4*)malloc(sizeA_bytes);
-			glm::vec4* dataInputBufferB = (glm::vec4*)malloc(sizeB_bytes);
-			if (!dataInputBufferA || !dataInputBufferB) { std::cout << "Failed allocating buffers for input meshes" << std::endl; return {}; }
+		std::vector<Batch> _batches;
 
-			for (int i = 0; i < aVertices.size(); ++i) {
-				dataInputBufferA[i].x = aVertices[i]._position.x;
-				dataInputBufferA[i].y = aVertices[i]._position.y;
-				dataInputBufferA[i].z = aVertices[i]._position.z;
-				dataInputBufferA[i].w = 1.0f;
-			}
-			for (int i = 0; i < bVertices.size(); ++i) {
-				dataInputBufferB[i].x = bVertices[i]._position.x;
-				dataInputBufferB[i].y = bVertices[i]._position.y;
-				dataInputBufferB[i].z = bVertices[i]._position.z;
-				dataInputBufferB[i].w = 1.0f;
-			}
+		/**
+		 * @brief Storage buffer containing _objectData.
+		 */
+		Buffer _objectBuffer;
 
-			std::vector <uint32_t> workGroupCount = CalculateWorkGroupCount(gpuProperties, (uint32_t)faceCount, { 8, 8, 8 });
+		/**
+		 * @brief Storage buffer containing the MeshletData of all merged meshes.
+		 */
+		Buffer _meshletBuffer;
 
-			// Create all the buffers.
-			VkResult res = VK_SUCCESS;
-			Buffer vertexBufferA, indexBufferA, vertexBufferB, indexBufferB, outputBuffer;
+		/**
+		 * @brief Buffer written by the culling compute shader and consumed by vkCmdDrawIndexedIndirect.
+		 */
+		Buffer _drawCommandBuffer;
 
-			VkHelper::CreateBuffer(collisionCtx._logicalDevice,
-				collisionCtx._physicalDevice,
-				sizeA_bytes,
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				&vertexBufferA._buffer,
-				&vertexBufferA._gpuMemory);
+		/**
+		 * @brief One counter per batch, used by the culling compute shader to append draw commands to the range of the batch.
+		 */
+		Buffer _batchCounterBuffer;
 
-			VkHelper::CreateBuffer(collisionCtx._logicalDevice, collisionCtx._physicalDevice, sizeIndexA_bytes,
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				&indexBufferA._buffer, &indexBufferA._gpuMemory);
+		/**
+		 * @brief Layout of the descriptor set that replaces the per game object uniform buffer (set 1) in the GPU-driven scene pipeline.
+		 */
+		DescriptorSetLayout _objectSetLayout;
 
-			VkHelper::CreateBuffer(collisionCtx._logicalDevice,
-				collisionCtx._physicalDevice,
-				sizeB_bytes,
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				&vertexBufferB._buffer,
-				&vertexBufferB._gpuMemory);
+		Pipeline _cullingPipeline;
 
-			VkHelper::CreateBuffer(collisionCtx._logicalDevice, collisionCtx._physicalDevice, sizeIndexB_bytes,
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				&indexBufferB._buffer, &indexBufferB._gpuMemory);
+		/**
+		 * @brief Multi draw indirect is needed to draw more than one command per call, and first instance is how the vertex shader knows which object it is drawing.
+		 */
+		static bool IsSupported(VkPhysicalDevice& physicalDevice) {
+			VkPhysicalDeviceFeatures features{};
+			vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+			return features.multiDrawIndirect && features.drawIndirectFirstInstance;
+		}
 
-			VkHelper::CreateBuffer(collisionCtx._logicalDevice,
-				collisionCtx._physicalDevice,
-				sizeOutputBytes,
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				&outputBuffer._buffer,
-				&outputBuffer._gpuMemory);
+		/**
+		 * @brief Merges the meshes of the scene and creates all the resources of the GPU-driven path. Must be called after the scene's descriptor sets have been created,
+		 * because the material descriptor sets of the meshes are reused. The vertices and indices of each mesh are uploaded to the merged buffers by streamer, closest
+		 * to viewerPosition first, and its game objects are culled until then.
+		 */
+		void Create(VkContext& ctx, Scene& scene, std::vector<DescriptorSetLayout>& layouts, AssetStreamer& streamer, const glm::vec3& viewerPosition) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Mesh);
+			GatherGameObjects(scene._pRootGameObject);
+			if (_gameObjects.size() == 0) return;
 
-			VkBuffer buffers[5] = {
-				vertexBufferA._buffer,
-				indexBufferA._buffer,
-				vertexBufferB._buffer,
-				indexBufferB._buffer,
-				outputBuffer._buffer
-			};
-			VkDeviceSize bufferSizes[5] = {
-				sizeA_bytes,
-				sizeIndexA_bytes,
-				sizeB_bytes,
-				sizeIndexB_bytes,
-				sizeOutputBytes
+			// Sort by material so that draws sharing a material are contiguous in the draw command buffer.
+			std::stable_sort(_gameObjects.begin(), _gameObjects.end(), [](GameObject* a, GameObject* b) { return a->_pMesh->_materialIndex < b->_pMesh->_materialIndex; });
+
+			// Merge the vertices, indices and meshlets of all meshes, keeping track of where each mesh starts. Meshes shared by several game objects are only merged once.
+			// Each mesh is encoded with its own position dequantization, which the vertex shader reads from the object data.
+			struct MergedMesh {
+				int32_t _vertexOffset;
+				uint32_t _firstIndex;
+				uint32_t _firstMeshlet;
+				float _priority;
 			};
+			int32_t vertexCount = 0;
+			std::vector<unsigned int> indices;
+			std::vector<MeshletData> meshlets;
+			std::map<Mesh*, MergedMesh> mergedMeshes;
+			_objectData.resize(_gameObjects.size());
+			for (size_t i = 0; i < _gameObjects.size(); ++i) {
+				auto pMesh = _gameObjects[i]->_pMesh;
+				auto merged = mergedMeshes.find(pMesh);
+				if (merged == mergedMeshes.end()) {
+					auto firstIndex = (uint32_t)indices.size();
+					merged = mergedMeshes.emplace(pMesh, MergedMesh{ vertexCount, firstIndex, (uint32_t)meshlets.size(), FLT_MAX }).first;
+					vertexCount += (int32_t)pMesh->_vertices._vertexData.size();
+					indices.insert(indices.end(), pMesh->_faceIndices._indexData.begin(), pMesh->_faceIndices._indexData.end());
+					for (auto& meshlet : pMesh->_meshlets) {
+						meshlets.push_back(MeshletData{ glm::vec4(meshlet._center, meshlet._radius), glm::vec4(meshlet._coneAxis, meshlet._coneCutoff), firstIndex + meshlet._firstIndex, meshlet._indexCount });
+					}
+				}
+				merged->second._priority = std::min(merged->second._priority, AssetStreamer::GetPriority(pMesh->_bounds, _gameObjects[i]->GetWorldSpaceTransform()._matrix, viewerPosition));
+
+				auto& objectData = _objectData[i];
+				objectData.objectToWorld = _gameObjects[i]->_gameObjectData.transform;
+				objectData.boundsCenter = glm::vec4(pMesh->_bounds.GetCenter(), 0.0f);
+				objectData.boundsExtents = glm::vec4(pMesh->_bounds.GetExtents(), 0.0f);
+				objectData.vertexOffset = merged->second._vertexOffset;
+				objectData.materialIndex = (uint32_t)pMesh->_materialIndex;
+				objectData.materialFlags = scene._materials[pMesh->_materialIndex].GetFlags();
+				objectData.positionOffset = pMesh->_vertices._positionOffset;
+				objectData.positionScale = pMesh->_vertices._positionScale;
+				_meshFirstMeshlets.push_back(merged->second._firstMeshlet);
+
+				if (i == 0 || _objectData[i - 1].materialIndex != objectData.materialIndex) {
+					_batches.push_back(Batch{ pMesh->_shaderResources[3][0], _commandCount, 0 });
+				}
+				objectData.batchIndex = (uint32_t)_batches.size() - 1;
+				objectData.firstCommand = _batches.back()._firstCommand;
+
+				// Whichever level of detail gets drawn, all of its meshlets must fit in the range of the batch.
+				uint32_t maxMeshletCount = 0;
+				for (auto& lod : pMesh->_lods) maxMeshletCount = std::max(maxMeshletCount, lod._meshletCount);
+				_batches.back()._commandCount += maxMeshletCount;
+				_commandCount += maxMeshletCount;
+			}
 
-			// Create 
-			//const char* shaderPath = "C:\\code\\vulkan-compute\\shaders\\Shader.spv";
-			auto shaderPath = Paths::ShadersPath() /= L"compute\\CollisionDetection.spv";
-			VkPipeline pipeline; VkPipelineLayout layout; VkDescriptorSet descriptorSet; VkDescriptorPool descriptorPool;
-			if (CreateComputePipeline(buffers, bufferSizes, shaderPath.string().c_str(), collisionCtx, pipeline, layout, descriptorSet, descriptorPool) != VK_SUCCESS) {
-				std::cout << "Application creation failed." << std::endl;
+			// The merged buffers are filled one mesh at a time as the streamer gets to them.
+			auto vertexStride = GlobalSettings::Instance()._vertexLayout.GetStride();
+			SetFaceIndices(indices.data(), indices.size());
+			AllocateVertexBuffer(ctx, (size_t)vertexCount * vertexStride);
+			AllocateIndexBuffer(ctx, GetEncodedIndicesSize());
+			auto indexSize = _faceIndices._indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(unsigned int);
+			for (auto& entry : mergedMeshes) {
+				auto pMesh = entry.first;
+				auto& merged = entry.second;
+				pMesh->_isResident = false;
+				auto meshIndexCount = pMesh->_faceIndices._indexData.size();
+				VkBufferCopy vertexCopy{ 0, (VkDeviceSize)merged._vertexOffset * vertexStride, pMesh->_vertices._vertexData.size() * vertexStride };
+				VkBufferCopy indexCopy{ vertexCopy.size, (VkDeviceSize)merged._firstIndex * indexSize, meshIndexCount * indexSize };
+
+				AssetStreamer::Request request;
+				request._name = pMesh->_pGameObject->_name;
+				request._priority = merged._priority;
+				request._sizeBytes = (size_t)(vertexCopy.size + indexCopy.size);
+				request._prepare = [this, pMesh, firstIndex = merged._firstIndex, meshIndexCount, vertexCopy](unsigned char* pStaging) {
+					pMesh->EncodeVertices(pStaging);
+					EncodeIndices(pStaging + vertexCopy.size, firstIndex, meshIndexCount);
+				};
+				request._record = [this, vertexCopy, indexCopy](VkCommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+					vkCmdCopyBuffer(commandBuffer, stagingBuffer, _vertices._vertexBuffer._buffer, 1, &vertexCopy);
+					vkCmdCopyBuffer(commandBuffer, stagingBuffer, _faceIndices._indexBuffer._buffer, 1, &indexCopy);
+				};
+				request._finish = [pMesh]() { pMesh->_isResident = true; };
+				streamer.Enqueue(std::move(request));
 			}
 
-			auto aTransform = a->_pGameObject->GetWorldSpaceTransform()._matrix;
-			auto bTransform = b->_pGameObject->GetWorldSpaceTransform()._matrix;
+			// Object data is rewritten by the CPU every frame, so it lives in host visible memory.
+			auto objectBufferSize = GetVectorSizeInBytes(_objectData);
+			VkHelper::CreateBuffer(ctx._logicalDevice, ctx._physicalDevice, objectBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&_objectBuffer._buffer, &_objectBuffer._gpuMemory);
+			_objectBuffer._sizeBytes = objectBufferSize;
+			vkMapMemory(ctx._logicalDevice, _objectBuffer._gpuMemory, 0, objectBufferSize, 0, &_objectBuffer._cpuMemory);
+			memcpy(_objectBuffer._cpuMemory, _objectData.data(), objectBufferSize);
 
-			// Transfer data to GPU staging buffer and thereafter sync the staging buffer with GPU local memory.
-			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, vertexBufferA._buffer, dataInputBufferA, sizeA_bytes);
-			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, indexBufferA._buffer, aIndices.data(), sizeIndexA_bytes);
-			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, vertexBufferB._buffer, dataInputBufferB, sizeB_bytes);
-			VkHelper::UploadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queue, indexBufferB._buffer, bIndices.data(), sizeIndexB_bytes);
+			auto meshletBufferSize = meshlets.size() * sizeof(MeshletData);
+			VkHelper::CreateBuffer(ctx._logicalDevice, ctx._physicalDevice, meshletBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&_meshletBuffer._buffer, &_meshletBuffer._gpuMemory);
+			_meshletBuffer._sizeBytes = meshletBufferSize;
+			VkHelper::UploadData(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, _meshletBuffer._buffer, meshlets.data(), meshletBufferSize);
+
+			// Both buffers are cleared with vkCmdFillBuffer before every culling pass.
+			auto drawCommandBufferSize = _commandCount * sizeof(VkDrawIndexedIndirectCommand);
+			VkHelper::CreateBuffer(ctx._logicalDevice, ctx._physicalDevice, drawCommandBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&_drawCommandBuffer._buffer, &_drawCommandBuffer._gpuMemory);
+			_drawCommandBuffer._sizeBytes = drawCommandBufferSize;
 
-			Dispatch(collisionCtx, pipeline, layout, descriptorSet, workGroupCount, aTransform, bTransform, objectAnormal);
+			auto batchCounterBufferSize = _batches.size() * sizeof(uint32_t);
+			VkHelper::CreateBuffer(ctx._logicalDevice, ctx._physicalDevice, batchCounterBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&_batchCounterBuffer._buffer, &_batchCounterBuffer._gpuMemory);
+			_batchCounterBuffer._sizeBytes = batchCounterBufferSize;
 
-			auto shaderOutputBufferData = (glm::vec4*)malloc(sizeOutputBytes);
-			VkHelper::DownloadData(collisionCtx._logicalDevice, collisionCtx._physicalDevice, collisionCtx._commandPool, collisionCtx._queueFence, collisionCtx._queue,
-				sizeOutputBytes,
-				outputBuffer._buffer,
-				shaderOutputBufferData);
-			
-			// Convert GPU results into collision context info
-			CollisionContext outCollisionCtx;
-			for (int i = 0; i < faceCount; ++i) {
-				if (shaderOutputBufferData[i].x == 3.402823466e+38f &&
-					shaderOutputBufferData[i].y == 3.402823466e+38f &&
-					shaderOutputBufferData[i].z == 3.402823466e+38f &&
-					shaderOutputBufferData[i].w == 3.402823466e+38f &&
-					shaderOutputBufferData[i + faceCount].x == 3.402823466e+38f &&
-					shaderOutputBufferData[i + faceCount].y == 3.402823466e+38f &&
-					shaderOutputBufferData[i + faceCount].z == 3.402823466e+38f &&
-					shaderOutputBufferData[i + faceCount].w == 3.402823466e+38f)
-					continue;
-				outCollided = true;
-				outCollisionCtx._collidee = &bodyB;
-				outCollisionCtx._collisionPositions.push_back(shaderOutputBufferData[i]);
-				outCollisionCtx._collisionNormals.push_back(shaderOutputBufferData[i + faceCount]);
-				outCollisionCtx._collisionObjects.push_back(shaderOutputBufferData[i].w == 0.0f ? a : b);
-			}
+			_buffers.push_back(_objectBuffer);
+			_buffers.push_back(_meshletBuffer);
+			_buffers.push_back(_drawCommandBuffer);
+			_buffers.push_back(_batchCounterBuffer);
 
-			// Clean up
-			vkDestroyPipeline(collisionCtx._logicalDevice, pipeline, nullptr);
-			vkDestroyPipelineLayout(collisionCtx._logicalDevice, layout, nullptr);
-			vkDestroyDescriptorPool(collisionCtx._logicalDevice, descriptorPool, nullptr);
+			CreateDescriptorSets(ctx, layouts);
+			CreateCullingPipeline(ctx);
+			_isEnabled = true;
+		}
 
-			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, vertexBufferA._buffer, vertexBufferA._gpuMemory, false);
-			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, indexBufferA._buffer, indexBufferA._gpuMemory, false);
-			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, vertexBufferB._buffer, vertexBufferB._gpuMemory, false);
-			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, indexBufferB._buffer, indexBufferB._gpuMemory, false);
-			VkHelper::DestroyBuffer(collisionCtx._logicalDevice, outputBuffer._buffer, outputBuffer._gpuMemory, false);
+		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
+			// One set for the graphics pipeline (object data), one for the culling pipeline (object data, meshlets, draw commands and batch counters).
+			{
+				VkDescriptorSetLayoutBinding bindings[1] = { VkDescriptorSetLayoutBinding { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr } };
+				VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+				layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+				layoutCreateInfo.bindingCount = 1;
+				layoutCreateInfo.pBindings = bindings;
+				_objectSetLayout._name = "gpuDrivenObjectLayout";
+				_objectSetLayout._id = 1;
+				CheckResult(vkCreateDescriptorSetLayout(ctx._logicalDevice, &layoutCreateInfo, nullptr, &_objectSetLayout._layout));
+
+				auto descriptorSet = ctx._descriptorAllocator.Allocate(ctx._logicalDevice, _objectSetLayout._layout);
+				VkDescriptorBufferInfo bufferInfo{ _objectBuffer._buffer, 0, _objectBuffer._sizeBytes };
+				VkWriteDescriptorSet writeInfo = {};
+				writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeInfo.dstSet = descriptorSet;
+				writeInfo.descriptorCount = 1;
+				writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writeInfo.pBufferInfo = &bufferInfo;
+				writeInfo.dstBinding = 0;
+				vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+				_shaderResources._data.try_emplace(_objectSetLayout, std::vector<VkDescriptorSet>{ descriptorSet });
+			}
 
-			free(shaderOutputBufferData);
-			free(dataInputBufferA);
-			free(dataInputBufferB);
+			{
+				VkDescriptorSetLayoutBinding bindings[4] = {
+					VkDescriptorSetLayoutBinding { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+					VkDescriptorSetLayoutBinding { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+					VkDescriptorSetLayoutBinding { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+					VkDescriptorSetLayoutBinding { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }
+				};
+				DescriptorSetLayout cullingSetLayout{ "gpuDrivenCullingLayout", 0, VK_NULL_HANDLE };
+				VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+				layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+				layoutCreateInfo.bindingCount = 4;
+				layoutCreateInfo.pBindings = bindings;
+				CheckResult(vkCreateDescriptorSetLayout(ctx._logicalDevice, &layoutCreateInfo, nullptr, &cullingSetLayout._layout));
+
+				auto descriptorSet = ctx._descriptorAllocator.Allocate(ctx._logicalDevice, cullingSetLayout._layout);
+				VkDescriptorBufferInfo bufferInfos[4] = {
+					VkDescriptorBufferInfo{ _objectBuffer._buffer, 0, _objectBuffer._sizeBytes },
+					VkDescriptorBufferInfo{ _meshletBuffer._buffer, 0, _meshletBuffer._sizeBytes },
+					VkDescriptorBufferInfo{ _drawCommandBuffer._buffer, 0, _drawCommandBuffer._sizeBytes },
+					VkDescriptorBufferInfo{ _batchCounterBuffer._buffer, 0, _batchCounterBuffer._sizeBytes }
+				};
+				VkWriteDescriptorSet writeInfo = {};
+				writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeInfo.dstSet = descriptorSet;
+				writeInfo.descriptorCount = 4;
+				writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writeInfo.pBufferInfo = bufferInfos;
+				writeInfo.dstBinding = 0;
+				vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+				_cullingPipeline._shaderResources._data.try_emplace(cullingSetLayout, std::vector<VkDescriptorSet>{ descriptorSet });
+			}
 
-			return outCollisionCtx;
+			return _shaderResources;
 		}
-	};
-
-	/**
-	 * @brief Represents a celeritas-engine scene.
-	 */
-	class Scene : public IVulkanUpdatable, public IPipelineable {
 
-	public:
 		/**
-		 * @brief Collection of point lights.
+		 * @brief Points the meshlet range of every object at the level of detail of its mesh selected for camera, and hands out culling invocations.
+		 * Objects whose mesh is still streaming in get no meshlets.
 		 */
-		std::vector<PointLight> _pointLights;
+		void SelectLods(Camera& camera) {
+			_threadCount = 0;
+			for (size_t i = 0; i < _gameObjects.size(); ++i) {
+				auto pMesh = _gameObjects[i]->_pMesh;
+				auto lod = pMesh->_isResident ? pMesh->GetLod(pMesh->SelectLod(_gameObjects[i]->_gameObjectData.transform, camera)) : Mesh::Lod{ 0, 0, 0.0f, 0, 0 };
+				_objectData[i].firstMeshlet = _meshFirstMeshlets[i] + lod._firstMeshlet;
+				_objectData[i].meshletCount = lod._meshletCount;
+				_objectData[i].firstThread = _threadCount;
+				_threadCount += lod._meshletCount;
+			}
+		}
 
 		/**
-		 * @brief Game object hierarchy.
+		 * @brief Copies the current transforms of the game objects into the object buffer.
 		 */
-		GameObject* _pRootGameObject;
+		void UpdateShaderResources() {
+			for (size_t i = 0; i < _gameObjects.size(); ++i)
+				_objectData[i].objectToWorld = _gameObjects[i]->_gameObjectData.transform;
+			memcpy(_objectBuffer._cpuMemory, _objectData.data(), GetVectorSizeInBytes(_objectData));
+		}
 
 		/**
-		 * @brief Collection of materials.
+		 * @brief Records the culling dispatch into commandBuffer. Must be recorded outside of a render pass, before Draw.
 		 */
-		std::vector<Material> _materials;
+		void RecordCulling(VkCommandBuffer& commandBuffer, const Frustum& frustum, Camera& camera) {
+			SelectLods(camera);
+			UpdateShaderResources();
+
+			struct {
+				glm::vec4 frustumPlanes[6];
+				glm::vec4 cameraPosition;
+				uint32_t objectCount;
+				uint32_t threadCount;
+			} pushConstants;
+			for (int i = 0; i < 6; ++i) pushConstants.frustumPlanes[i] = frustum._planes[i];
+			pushConstants.cameraPosition = glm::vec4(camera._localTransform.Position(), 1.0f);
+			pushConstants.objectCount = (uint32_t)_gameObjects.size();
+			pushConstants.threadCount = _threadCount;
+
+			// Commands left empty by culling must draw nothing, and every batch starts appending at its first command. The previous frame's indirect
+			// draws must be done reading the commands before they are cleared.
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+			vkCmdFillBuffer(commandBuffer, _drawCommandBuffer._buffer, 0, VK_WHOLE_SIZE, 0);
+			vkCmdFillBuffer(commandBuffer, _batchCounterBuffer._buffer, 0, VK_WHOLE_SIZE, 0);
+
+			VkBufferMemoryBarrier clearBarriers[2]{};
+			for (auto& barrier : clearBarriers) {
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+			}
+			clearBarriers[0].buffer = _drawCommandBuffer._buffer;
+			clearBarriers[1].buffer = _batchCounterBuffer._buffer;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 2, clearBarriers, 0, nullptr);
+
+			if (_threadCount > 0) {
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cullingPipeline._handle);
+				vkCmdPushConstants(commandBuffer, _cullingPipeline._layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cullingPipeline._layout, 0, 1, &_cullingPipeline._shaderResources[0][0], 0, nullptr);
+				vkCmdDispatch(commandBuffer, (_threadCount + 63) / 64, 1, 1);
+			}
+
+			// The draw commands must be fully written before the indirect draws read them.
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = _drawCommandBuffer._buffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
 
 		/**
-		 * @brief Environment map used for image-based lighting.
+		 * @brief Binds the merged buffers and the object data, then issues one indirect draw per material. When useMaterialTable is true the material table
+		 * must already be bound and no material set is bound per batch, but batches are still drawn separately: see MaterialTable::IsSupported.
 		 */
-		CubicalEnvironmentMap _environmentMap;
+		void Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer, bool useMaterialTable) {
+			vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &_shaderResources[1][0], 0, nullptr);
+
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(drawCommandBuffer, 0, 1, &_vertices._vertexBuffer._buffer, &offset);
+			vkCmdBindIndexBuffer(drawCommandBuffer, _faceIndices._indexBuffer._buffer, 0, _faceIndices._indexType);
+
+			for (auto& batch : _batches) {
+				if (!useMaterialTable) vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3, 1, &batch._materialSet, 0, nullptr);
+				vkCmdDrawIndexedIndirect(drawCommandBuffer, _drawCommandBuffer._buffer, batch._firstCommand * sizeof(VkDrawIndexedIndirectCommand), batch._commandCount, sizeof(VkDrawIndexedIndirectCommand));
+			}
+		}
 
 		/**
-		 * @brief Default constructor.
+		 * @brief Creates the layout of the GPU-driven scene pipeline, which is the scene pipeline layout with the per game object uniform buffer swapped for the object storage buffer.
 		 */
-		Scene() = default;
+		VkPipelineLayout CreateGraphicsPipelineLayout(VkContext& ctx, std::vector<DescriptorSetLayout>& sceneLayouts) {
+			std::vector<VkDescriptorSetLayout> layouts;
+			for (auto& layout : sceneLayouts) layouts.push_back(layout._id == _objectSetLayout._id ? _objectSetLayout._layout : layout._layout);
 
-		Scene(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice) {
-			_materials.push_back(Material(logicalDevice, physicalDevice));
-			_pRootGameObject = new GameObject("Root", this);
-		}
+			// Same push constant range as the scene pipeline layout, so that descriptor sets bound with one layout stay valid with the other.
+			VkPushConstantRange range = {};
+			range.offset = 0;
+			range.size = sizeof(MeshInstancer::PushConstants);
+			range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-		Material DefaultMaterial() {
-			if (_materials.size() <= 0) {
-				std::cout << "a scene object should always have at least a default material" << std::endl;
-				std::exit(1);
-			}
-			return _materials[0];
+			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+			pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			pipelineLayoutCreateInfo.setLayoutCount = (uint32_t)layouts.size();
+			pipelineLayoutCreateInfo.pSetLayouts = layouts.data();
+			pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+			pipelineLayoutCreateInfo.pPushConstantRanges = &range;
+			VkPipelineLayout outLayout;
+			CheckResult(vkCreatePipelineLayout(ctx._logicalDevice, &pipelineLayoutCreateInfo, nullptr, &outLayout));
+			return outLayout;
 		}
 
-		void PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
-			for (auto& gameObject : _pRootGameObject->_children)
-				gameObject->PhysicsUpdate(ctx, collisionCtx, eCtx);
+	private:
+
+		void GatherGameObjects(GameObject* pGameObject) {
+			if (pGameObject->_pMesh != nullptr && pGameObject->_pMesh->_meshlets.size() > 0) _gameObjects.push_back(pGameObject);
+			for (auto& child : pGameObject->_children) GatherGameObjects(child);
 		}
 
-		void Update(VkContext& vkContext) {
-			for (auto& light : _pointLights)
-				light.Update(vkContext);
+		void CreateCullingPipeline(VkContext& ctx) {
+			VkPushConstantRange range = {};
+			range.offset = 0;
+			range.size = sizeof(glm::vec4) * 7 + sizeof(uint32_t) * 2;
+			range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+				VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO, nullptr, 0, 1, &_cullingPipeline._shaderResources._data.begin()->first._layout, 1, &range
+			};
+			CheckResult(vkCreatePipelineLayout(ctx._logicalDevice, &pipelineLayoutCreateInfo, nullptr, &_cullingPipeline._layout));
+
+			auto shaderPath = Paths::ShadersPath() /= L"compute\\ClusterCulling.spv";
+			VkShaderModule shaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, shaderPath);
+
+			VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo = {
+				VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT,
+				shaderModule, "main", nullptr
+			};
+
+			VkComputePipelineCreateInfo computePipelineCreateInfo = {
+				VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+				pipelineShaderStageCreateInfo, _cullingPipeline._layout, VK_NULL_HANDLE, 0
+			};
 
-			for (auto& gameObject : _pRootGameObject->_children)
-				gameObject->Update(vkContext);
+			CheckResult(vkCreateComputePipelines(ctx._logicalDevice, ctx._pipelineCache._handle, 1, &computePipelineCreateInfo, nullptr, &_cullingPipeline._handle));
 		}
+	};
 
-		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
-			for (auto& gameObject : _pRootGameObject->_children) {
-				auto gameObjectResources = gameObject->CreateDescriptorSets(ctx, layouts);
-				_shaderResources.MergeResources(gameObjectResources);
-			}
+	/**
+	 * @brief All the high-level information needed by the engine to perform user-related tasks such as managing cameras and scenes.
+	 */
+	struct EngineContext {
+		Scene _scene;
+		Camera _mainCamera;
+		FrustumCuller _frustumCuller;
+		MeshInstancer _meshInstancer;
+		MaterialTable _materialTable;
+		GpuDrivenScene _gpuDrivenScene;
+		AssetStreamer _assetStreamer;
+		FramePacer _framePacer;
+		Time& _time = Time::Instance();
+		KeyboardMouse& _input = KeyboardMouse::Instance();
+		GlobalSettings& _globalSettings = Engine::GlobalSettings::Instance();
 
-			for (auto& light : _pointLights) {
-				auto lightResources = light.CreateDescriptorSets(ctx, layouts);
-				_shaderResources.MergeResources(lightResources);
-				light.UpdateShaderResources();
-			}
+		/**
+		 * @brief File in the models folder InitializeEngine loads, or empty for the default scene.
+		 */
+		std::string _sceneName;
 
-			auto environmentMapResources = _environmentMap.CreateDescriptorSets(ctx, layouts);
-			_shaderResources.MergeResources(environmentMapResources);
-			return _shaderResources;
-		}
+		/**
+		 * @brief Set before InitializeEngine to render to images of this size instead of to a window, as benchmarks do. Zero to open a window.
+		 */
+		VkExtent2D _offscreenSize{};
 
-		void UpdateShaderResources() {
-			// TODO
-		}
+		/**
+		 * @brief Physics settings of the current physics step, only used by the physics thread. Taken from _globalSettings at the start of each step.
+		 */
+		GlobalSettings::Physics _physicsSettings{};
 	};
 
-	// GameObject
-	GameObject::GameObject(const std::string& name, Scene* pScene) {
-		_name = name;
-		_pScene = pScene;
-	}
+	void RigidBody::PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
+		float deltaTimeSeconds = (float)eCtx._time._physicsDeltaTime * 0.001f;
+		auto speed = glm::length(_velocity);
+		auto angularSpeed = glm::length(_angularVelocity);
+		if (IsRotationLocked() && IsTranslationLocked()) return;
+		if (_isColliding && speed < 0.05f) return;
+		if (_isAffectedByGravity) AddForce(gGravity, deltaTimeSeconds, true);
 
-	GameObject::~GameObject()
-	{
-		if (_pBody)
-			delete _pBody;
-	}
+		// Approximate air resistance/rotational friction.
+		auto frictionMultiplier = -eCtx._physicsSettings._airFrictionCoefficient / powf(_mass, 2.0f);
+		AddForce(_velocity * frictionMultiplier, deltaTimeSeconds);
+		AddTorque(_angularVelocity * frictionMultiplier, deltaTimeSeconds);
+		auto wscom = GetCenterOfMass(true);
 
-	ShaderResources GameObject::CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
-		auto descriptorSetID = 1;
-		auto globalTransform = GetWorldSpaceTransform();
+		// Clamp angular velocity
+		if (angularSpeed > _maxAngularSpeed) _angularVelocity *= _maxAngularSpeed / angularSpeed;
 
-		// Create a temporary buffer.
-		Buffer buffer{};
-		auto bufferSizeBytes = sizeof(_localTransform._matrix);
-		buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		buffer._createInfo.size = bufferSizeBytes;
-		buffer._createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-		vkCreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+		// Resolve collisions.
+		do {
+			if (!_isCollidable) break;
 
-		// Allocate memory for the buffer.
-		VkMemoryRequirements requirements{};
-		vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
-		buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			auto collisions = DetectCollisions(ctx, collisionCtx);
 
-		// Map memory to the correct GPU and CPU ranges for the buffer.
-		vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
-		vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
-		memcpy(buffer._cpuMemory, &globalTransform._matrix, bufferSizeBytes);
-
-		_buffers.push_back(buffer);
-
-		VkDescriptorPool descriptorPool{};
-		VkDescriptorPoolSize poolSizes[1] = { VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 } };
-		VkDescriptorPoolCreateInfo createInfo = {};
-		createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		createInfo.maxSets = (uint32_t)1;
-		createInfo.poolSizeCount = (uint32_t)1;
-		createInfo.pPoolSizes = poolSizes;
-		vkCreateDescriptorPool(ctx._logicalDevice, &createInfo, nullptr, &descriptorPool);
-
-		// Create the descriptor set.
-		VkDescriptorSetAllocateInfo allocInfo = {};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = descriptorPool;
-		allocInfo.descriptorSetCount = (uint32_t)1;
-		allocInfo.pSetLayouts = &layouts[descriptorSetID]._layout;
-		VkDescriptorSet descriptorSet;
-		vkAllocateDescriptorSets(ctx._logicalDevice, &allocInfo, &descriptorSet);
-
-		// Update the descriptor set's data.
-		VkDescriptorBufferInfo bufferInfo{ buffer._buffer, 0, buffer._createInfo.size };
-		VkWriteDescriptorSet writeInfo = {};
-		writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		writeInfo.dstSet = descriptorSet;
-		writeInfo.descriptorCount = 1;
-		writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		writeInfo.pBufferInfo = &bufferInfo;
-		writeInfo.dstBinding = 0;
-		vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
-
-		auto descriptorSets = std::vector<VkDescriptorSet>{ descriptorSet };
-		_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
+			// Detect continuous collision
+			bool isOverCollisionThreshold = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - _lastTimeCollided).count() > _continuousCollisionThresholdMilliseconds;
 
-		if (_pMesh) {
-			auto meshResources = _pMesh->CreateDescriptorSets(ctx, layouts);
-			_shaderResources.MergeResources(meshResources);
-		}
+			if (collisions.size() > 0) {
+				if (isOverCollisionThreshold) _isColliding = true;
+				_lastTimeCollided = std::chrono::high_resolution_clock::now();
+			}
+			else if (isOverCollisionThreshold) { _isColliding = false; break; }
 
-		for (auto& child : _children) {
-			auto childResources = child->CreateDescriptorSets(ctx, layouts);
-		}
+			for (int i = 0; i < collisions.size(); ++i) {
+				auto physicsDeltaTime = (float)eCtx._time._physicsDeltaTime;
+				collisions[i].CalculateAverages();
+				glm::vec3 averageCollisionPosition = glm::vec3(collisions[i]._averagePosition);
+				glm::vec3 averageCollisionNormal = glm::vec3(collisions[i]._averageNormal);
 
-		return _shaderResources;
-	}
+				auto velocityAtPosition = GetVelocityAtPosition(averageCollisionPosition);
+				auto velocityLength = glm::length(velocityAtPosition);
+				auto velocityDirection = velocityAtPosition; glm::normalize(velocityDirection);
 
-	Transform GameObject::GetWorldSpaceTransform() {
-		Transform outTransform;
-		GameObject* current = this;
-		do {
-			outTransform._matrix *= current->_localTransform._matrix;
-			current = current->_pParent;
-		} while (current->_pParent != nullptr);
-		outTransform.SetPosition(glm::vec3(_pParent->_localTransform._matrix * glm::vec4(_localTransform.Position(), 1.0f)));
-		return outTransform;
-	}
+				// If the object is moving slower than the collidee, don't do anything.
+				if (velocityLength < glm::length(collisions[i]._collidee->GetVelocityAtPosition(averageCollisionPosition))) continue;
 
-	void GameObject::UpdateShaderResources() {
-		auto worldTransform = GetWorldSpaceTransform()._matrix;
-		_gameObjectData.transform = worldTransform;
-		memcpy(_buffers[0]._cpuMemory, &_gameObjectData, sizeof(_gameObjectData));
-	}
+				CollisionContext collisionCtx = collisions[i];
+				// Correct the body's position by moving the object backwards along the collision normal until there are no more collisions, to reduce object penetration
+				// and make the collision detection seem more accurate.
+				_pGameObject->_localTransform.Translate(averageCollisionNormal * 0.01f);
 
-	void GameObject::PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
-		if (!_pBody) return;
-		if (!_pBody->_isCollidable || (_pBody->IsTranslationLocked() && _pBody->IsRotationLocked())) return;
-		_pBody->PhysicsUpdate(ctx, collisionCtx, eCtx);
-	}
+				auto f = averageCollisionNormal * 0.05f;
+				auto velBefore = glm::dot(velocityAtPosition, averageCollisionNormal);
+				AddForceAtPosition(f, averageCollisionPosition, 1.0f, true, true, true);
+				auto velAfter = glm::dot(GetVelocityAtPosition(averageCollisionPosition), averageCollisionNormal);
+				auto deltaVel = velBefore - velAfter;
+				auto newf = f * (velAfter / deltaVel);
+				AddForceAtPosition(newf, averageCollisionPosition, 1.0f, true, true, true);
 
-	void GameObject::Update(VkContext& vkContext) {
-		if (_pMesh != nullptr) {
-			_pMesh->Update(vkContext);
-		}
+				velocityAtPosition = GetVelocityAtPosition(averageCollisionPosition);
 
-		UpdateShaderResources();
+				auto frictionForceDirection = glm::cross(glm::cross(velocityAtPosition, averageCollisionNormal), averageCollisionNormal);
+				if (!Helpers::IsVectorZero(frictionForceDirection)) frictionForceDirection = glm::normalize(frictionForceDirection);
 
-		for (auto& child : _children) {
-			child->Update(vkContext);
-		}
-	}
+				auto frictionComponent = !Helpers::IsVectorZero(frictionForceDirection)
+					? frictionForceDirection * (glm::dot(velocityAtPosition, frictionForceDirection) * _mass * _friction) * deltaTimeSeconds
+					: glm::vec3(0.0f, 0.0f, 0.0f);
+				AddForceAtPosition(-frictionComponent * 4.0f, averageCollisionPosition, 1.0f);
 
-	void GameObject::Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) {
-		if (_pMesh != nullptr) {
-			vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &_shaderResources[1][0], 0, nullptr);
-			_pMesh->Draw(pipelineLayout, drawCommandBuffer);
-		}
+				collisions[i]._collidee->AddForceAtPosition(-f, averageCollisionPosition, 1.0f);
 
-		for (int i = 0; i < _children.size(); ++i) {
-			_children[i]->Draw(pipelineLayout, drawCommandBuffer);
-		}
-	}
 
-	Mesh::~Mesh()
-	{
-		// TODO
+				// Detect twitching (fast angular velocity oscillations when an object is almost at its resting position)
+				if (glm::dot(_lastAngularVelocity, _angularVelocity) < 0.0f && _isColliding) {
+					auto isOverTwitchingThreshold = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - _lastTimeTwitched).count() > _twitchingDetectionThresholdMilliseconds;
+					_lastTimeTwitched = std::chrono::high_resolution_clock::now();
+					if (isOverTwitchingThreshold) { _twitchCount = 0; continue; }
+					++_twitchCount;
+					if (_twitchCount < 3) continue;
+					_velocity *= 0.0f;
+					_angularVelocity *= 0.0f;
+					return;
+				}
+			}
+		} while (false);
+
+		_lastAngularVelocity = _angularVelocity;
+
+		_pGameObject->_localTransform.RotateAroundPosition(wscom, glm::normalize(_angularVelocity), glm::length(_angularVelocity) * deltaTimeSeconds);
+		_pGameObject->_localTransform.Translate(_velocity * deltaTimeSeconds);
 	}
 
-	// Mesh
-	ShaderResources Mesh::CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
-		auto descriptorSetID = 3;
+	bool RigidBody::IsRotationLocked() { return _lockRotationX && _lockRotationY && _lockRotationZ; }
 
-		// Get the textures to send to the shaders.
-		auto pScene = _pGameObject->_pScene;
-		auto defaultMaterial = pScene->DefaultMaterial();
-		Image albedoMap = defaultMaterial._albedo;
-		Image roughnessMap = defaultMaterial._roughness;
-		Image metalnessMap = defaultMaterial._metalness;
+	bool RigidBody::IsTranslationLocked() { return _lockTranslationX && _lockTranslationY && _lockTranslationZ; }
 
-		if (_materialIndex >= 0) {
-			if (VK_NULL_HANDLE != pScene->_materials[_materialIndex]._albedo._image) {
-				albedoMap = pScene->_materials[_materialIndex]._albedo;
-			}
-			if (VK_NULL_HANDLE != pScene->_materials[_materialIndex]._roughness._image) {
-				roughnessMap = pScene->_materials[_materialIndex]._roughness;
-			}
-			if (VK_NULL_HANDLE != pScene->_materials[_materialIndex]._metalness._image) {
-				metalnessMap = pScene->_materials[_materialIndex]._metalness;
-			}
-		}
+	void RigidBody::LockRotation() { _lockRotationX = true; _lockRotationY = true; _lockRotationZ = true; }
 
-		// Send the textures to the GPU.
-		CopyImageToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, albedoMap._image, albedoMap._createInfo.extent.width, albedoMap._createInfo.extent.height, albedoMap._createInfo.extent.depth, albedoMap._pData, albedoMap._sizeBytes);
-		CopyImageToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, albedoMap._image, roughnessMap._createInfo.extent.width, roughnessMap._createInfo.extent.height, roughnessMap._createInfo.extent.depth, roughnessMap._pData, roughnessMap._sizeBytes);
-		CopyImageToDeviceMemory(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue, albedoMap._image, metalnessMap._createInfo.extent.width, metalnessMap._createInfo.extent.height, metalnessMap._createInfo.extent.depth, metalnessMap._pData, metalnessMap._sizeBytes);
+	void RigidBody::LockTranslation() { _lockTranslationX = true; _lockTranslationY = true; _lockTranslationZ = true; }
 
-		auto commandBuffer = VkHelper::CreateCommandBuffer(ctx._logicalDevice, ctx._commandPool);
-		VkHelper::StartRecording(commandBuffer);
+	void RigidBody::UnlockRotation() { _lockRotationX = false; _lockRotationY = false; _lockRotationZ = false; }
 
-		// Transition the images to shader read layout.
-		{
-			VkImageMemoryBarrier barrier{};
-			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			barrier.oldLayout = albedoMap._currentLayout;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.image = albedoMap._image;
-			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
-			albedoMap._currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	void RigidBody::UnlockTranslation() { _lockTranslationX = false; _lockTranslationY = false; _lockTranslationZ = false; }
 
-			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			barrier.oldLayout = roughnessMap._currentLayout;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.image = roughnessMap._image;
-			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
-			roughnessMap._currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	/**
+	 * @brief Reorders the triangles and vertices of a mesh so the GPU does less work drawing it, without changing what is drawn. Runs when cooking, and
+	 * is deterministic so that cooking the same input always gives the same output.
+	 */
+	class MeshOptimizer {
+	public:
 
-			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			barrier.oldLayout = metalnessMap._currentLayout;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.image = metalnessMap._image;
-			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
-			metalnessMap._currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-		}
+		/**
+		 * @brief Size of the simulated post-transform vertex cache.
+		 */
+		static constexpr int _cacheSize = 32;
 
-		VkHelper::StopRecording(commandBuffer);
-		VkHelper::ExecuteCommands(commandBuffer, ctx._queue);
-
-		_images.push_back(albedoMap);
-		_images.push_back(roughnessMap);
-		_images.push_back(metalnessMap);
-
-		VkDescriptorPool descriptorPool{};
-		VkDescriptorPoolSize poolSizes[1] = { VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3 } };
-		VkDescriptorPoolCreateInfo createInfo = {};
-		createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		createInfo.maxSets = (uint32_t)1;
-		createInfo.poolSizeCount = (uint32_t)1;
-		createInfo.pPoolSizes = poolSizes;
-		vkCreateDescriptorPool(ctx._logicalDevice, &createInfo, nullptr, &descriptorPool);
-
-		VkDescriptorSetAllocateInfo allocInfo = {};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = descriptorPool;
-		allocInfo.descriptorSetCount = (uint32_t)1;
-		allocInfo.pSetLayouts = &layouts[descriptorSetID]._layout;
-		VkDescriptorSet descriptorSet;
-		vkAllocateDescriptorSets(ctx._logicalDevice, &allocInfo, &descriptorSet);
-
-		VkDescriptorImageInfo imageInfo[3];
-		imageInfo[0] = { albedoMap._sampler, albedoMap._view, albedoMap._currentLayout };
-		imageInfo[1] = { roughnessMap._sampler, roughnessMap._view, roughnessMap._currentLayout };
-		imageInfo[2] = { metalnessMap._sampler, metalnessMap._view, metalnessMap._currentLayout };
-		VkWriteDescriptorSet writeInfo = {};
-		writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		writeInfo.dstSet = descriptorSet;
-		writeInfo.descriptorCount = 3;
-		writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		writeInfo.pImageInfo = imageInfo;
-		writeInfo.dstBinding = 0;
-		vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
-
-		auto descriptorSets = std::vector<VkDescriptorSet>{ descriptorSet };
-		_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
-		return _shaderResources;
-	}
+		/**
+		 * @brief Most vertices and faces of a meshlet. The usual mesh shader limits, which keep meshlets small enough to be culled usefully.
+		 */
+		static constexpr size_t _maxMeshletVertexCount = 64;
+		static constexpr size_t _maxMeshletFaceCount = 124;
 
-	void Mesh::UpdateShaderResources() {
-		// TODO
-	}
+		/**
+		 * @brief Runs all optimizations in order: triangles for the vertex cache, then clusters of triangles for overdraw, then vertices for fetch locality.
+		 */
+		static void Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& faceIndices) {
+			OptimizeVertexCache(faceIndices, vertices.size());
+			OptimizeOverdraw(vertices, faceIndices);
+			OptimizeVertexFetch(vertices, faceIndices);
+		}
 
-	void Mesh::Update(VkContext& vkContext) {
-		auto& vkBuffer = _vertices._vertexBuffer._buffer;
-		auto& vertexData = _vertices._vertexData;
+		/**
+		 * @brief Reorders triangles so that consecutive triangles reuse recently transformed vertices, following Tom Forsyth's "Linear-speed vertex cache optimisation".
+		 * Every step emits the triangle whose vertices score highest, where a vertex scores higher the more recently it was used and the fewer triangles it has left.
+		 */
+		static void OptimizeVertexCache(std::vector<unsigned int>& faceIndices, size_t vertexCount) {
+			auto triangleCount = faceIndices.size() / 3;
+			if (triangleCount == 0) return;
 
-		// Update the Vulkan-only visible memory that is mapped to the GPU so that the updated data is also visible in the vertex shader.
-		memcpy(_vertices._vertexBuffer._cpuMemory, _vertices._vertexData.data(), GetVectorSizeInBytes(_vertices._vertexData));
-	}
+			// Triangles using each vertex, stored as one array with an offset per vertex.
+			std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+			for (auto index : faceIndices) ++remainingTriangles[index];
+			std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+			for (size_t i = 0; i < vertexCount; ++i) adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangles[i];
+			std::vector<uint32_t> adjacency(faceIndices.size());
+			{
+				std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t t = 0; t < triangleCount; ++t)
+					for (int k = 0; k < 3; ++k) adjacency[fill[faceIndices[t * 3 + k]]++] = (uint32_t)t;
+			}
 
-	void Mesh::Draw(VkPipelineLayout& pipelineLayout, VkCommandBuffer& drawCommandBuffer) {
-		VkDescriptorSet sets[] = { _shaderResources[3][0] };
-		vkCmdBindDescriptorSets(drawCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3, 1, sets, 0, nullptr);
+			std::vector<int> cachePositions(vertexCount, -1);
+			std::vector<float> vertexScores(vertexCount);
+			for (size_t i = 0; i < vertexCount; ++i) vertexScores[i] = VertexScore(-1, remainingTriangles[i]);
+
+			std::vector<float> triangleScores(triangleCount);
+			std::vector<bool> isEmitted(triangleCount, false);
+			for (size_t t = 0; t < triangleCount; ++t)
+				triangleScores[t] = vertexScores[faceIndices[t * 3]] + vertexScores[faceIndices[t * 3 + 1]] + vertexScores[faceIndices[t * 3 + 2]];
+
+			std::vector<unsigned int> outIndices;
+			outIndices.reserve(faceIndices.size());
+			std::vector<unsigned int> cache;
+			std::vector<unsigned int> newCache;
+			size_t nextUnemitted = 0;
+			int64_t bestTriangle = -1;
+
+			for (size_t emitted = 0; emitted < triangleCount; ++emitted) {
+				// When no triangle touches the cache, carry on with the first triangle not emitted yet.
+				if (bestTriangle < 0) {
+					while (isEmitted[nextUnemitted]) ++nextUnemitted;
+					bestTriangle = (int64_t)nextUnemitted;
+				}
 
-		VkDeviceSize offset = 0;
-		vkCmdBindVertexBuffers(drawCommandBuffer, 0, 1, &_vertices._vertexBuffer._buffer, &offset);
-		vkCmdBindIndexBuffer(drawCommandBuffer, _faceIndices._indexBuffer._buffer, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdDrawIndexed(drawCommandBuffer, (uint32_t)_faceIndices._indexData.size(), 1, 0, 0, 0);
-	}
+				auto t = (size_t)bestTriangle;
+				isEmitted[t] = true;
+				newCache.clear();
+				for (int k = 0; k < 3; ++k) {
+					auto v = faceIndices[t * 3 + k];
+					outIndices.push_back(v);
+					newCache.push_back(v);
+
+					// Remove the triangle from the triangles left for the vertex.
+					auto begin = adjacency.begin() + adjacencyOffsets[v];
+					auto end = begin + remainingTriangles[v];
+					auto found = std::find(begin, end, (uint32_t)t);
+					std::iter_swap(found, end - 1);
+					--remainingTriangles[v];
+				}
+				for (auto v : cache)
+					if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+
+				// Rescore the vertices in the cache, and the vertices that just fell out of it.
+				for (size_t i = 0; i < newCache.size(); ++i) {
+					auto v = newCache[i];
+					cachePositions[v] = i < (size_t)_cacheSize ? (int)i : -1;
+					vertexScores[v] = VertexScore(cachePositions[v], remainingTriangles[v]);
+				}
+				if (newCache.size() > (size_t)_cacheSize) newCache.resize(_cacheSize);
+				std::swap(cache, newCache);
+
+				// The next triangle is the best one among those using a vertex in the cache.
+				bestTriangle = -1;
+				float bestScore = -1.0f;
+				for (auto v : cache) {
+					for (uint32_t j = 0; j < remainingTriangles[v]; ++j) {
+						auto candidate = adjacency[adjacencyOffsets[v] + j];
+						triangleScores[candidate] = vertexScores[faceIndices[candidate * 3]] + vertexScores[faceIndices[candidate * 3 + 1]] + vertexScores[faceIndices[candidate * 3 + 2]];
+						if (triangleScores[candidate] > bestScore || (triangleScores[candidate] == bestScore && candidate < bestTriangle)) {
+							bestScore = triangleScores[candidate];
+							bestTriangle = candidate;
+						}
+					}
+				}
+			}
 
-	// Rigidbody
-	glm::vec3 RigidBody::CalculateTransmittedForce(const glm::vec3& transmitterPosition, const glm::vec3& force, const glm::vec3& receiverPosition) {
-		if (Helpers::IsVectorZero(receiverPosition - transmitterPosition, 0.001f)) return force;
-		auto effectiveForce = glm::normalize(receiverPosition - transmitterPosition);
-		auto scaleFactor = glm::dot(effectiveForce, force);
-		return effectiveForce * scaleFactor;
-	}
+			faceIndices = std::move(outIndices);
+		}
 
-	glm::vec3 RigidBody::GetCenterOfMass(bool worldSpace) {
-		auto worldSpaceTransform = _pGameObject->GetWorldSpaceTransform()._matrix;
-		if (_isCenterOfMassOverridden) return worldSpace ? glm::vec3(worldSpaceTransform * glm::vec4(_overriddenCenterOfMassLocalSpace, 1.0f)) : _overriddenCenterOfMassLocalSpace;
+		/**
+		 * @brief Reorders clusters of triangles so that the ones most likely to hide others are drawn first, following the view-independent
+		 * sorting of Sander, Nehab and Barczak's "Fast triangle reordering for vertex locality and reduced overdraw". Clusters are the runs of triangles
+		 * the vertex cache order already produced, split where a triangle misses the cache on all three vertices, so cache efficiency is kept.
+		 */
+		static void OptimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<unsigned int>& faceIndices) {
+			auto triangleCount = faceIndices.size() / 3;
+			if (triangleCount < 2) return;
 
-		auto& vertices = _pGameObject->_pMesh->_vertices._vertexData;
-		int vertexCount = (int)vertices.size();
-		float totalX = 0.0f;
-		float totalY = 0.0f;
-		float totalZ = 0.0f;
+			// Split into clusters by simulating a FIFO cache.
+			std::vector<size_t> clusterStarts;
+			std::vector<int64_t> cacheTimestamps(vertices.size(), INT64_MIN / 2);
+			int64_t time = 0;
+			for (size_t t = 0; t < triangleCount; ++t) {
+				int misses = 0;
+				for (int k = 0; k < 3; ++k) {
+					auto v = faceIndices[t * 3 + k];
+					if (time - cacheTimestamps[v] >= _cacheSize) {
+						cacheTimestamps[v] = time++;
+						++misses;
+					}
+				}
+				if (t == 0 || misses == 3) clusterStarts.push_back(t);
+			}
+			clusterStarts.push_back(triangleCount);
+
+			// Area weighted centroid of the mesh, and of each cluster along with its average normal.
+			struct Cluster {
+				size_t _firstTriangle;
+				size_t _triangleCount;
+				float _sortKey;
+			};
+			std::vector<Cluster> clusters;
+			std::vector<glm::vec3> clusterCentroids;
+			std::vector<glm::vec3> clusterNormals;
+			glm::vec3 meshCentroid(0.0f);
+			float meshArea = 0.0f;
+			for (size_t c = 0; c + 1 < clusterStarts.size(); ++c) {
+				glm::vec3 centroid(0.0f);
+				glm::vec3 normal(0.0f);
+				float area = 0.0f;
+				for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+					auto& a = vertices[faceIndices[t * 3]];
+					auto& b = vertices[faceIndices[t * 3 + 1]];
+					auto& d = vertices[faceIndices[t * 3 + 2]];
+					auto triangleArea = glm::length(glm::cross(b._position - a._position, d._position - a._position)) * 0.5f;
+					centroid += (a._position + b._position + d._position) * (triangleArea / 3.0f);
+					normal += (a._normal + b._normal + d._normal) * triangleArea;
+					area += triangleArea;
+				}
+				meshCentroid += centroid;
+				meshArea += area;
+				clusters.push_back(Cluster{ clusterStarts[c], clusterStarts[c + 1] - clusterStarts[c], 0.0f });
+				clusterCentroids.push_back(area > 0.0f ? centroid / area : vertices[faceIndices[clusterStarts[c] * 3]]._position);
+				clusterNormals.push_back(glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f));
+			}
+			if (clusters.size() < 2) return;
+			if (meshArea > 0.0f) meshCentroid /= meshArea;
 
-		for (int i = 0; i < vertexCount; ++i) {
-			totalX += vertices[i]._position.x;
-			totalY += vertices[i]._position.y;
-			totalZ += vertices[i]._position.z;
-		}
+			// Clusters far out from the center and facing outwards occlude the most, so they go first.
+			for (size_t c = 0; c < clusters.size(); ++c) clusters[c]._sortKey = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]);
+			std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a._sortKey > b._sortKey; });
 
-		auto averagePos = glm::vec3(totalX / vertexCount, totalY / vertexCount, totalZ / vertexCount);
-		return worldSpace ? glm::vec3(worldSpaceTransform * glm::vec4(averagePos, 1.0f)) : averagePos;
-	}
+			std::vector<unsigned int> outIndices;
+			outIndices.reserve(faceIndices.size());
+			for (auto& cluster : clusters)
+				outIndices.insert(outIndices.end(), faceIndices.begin() + cluster._firstTriangle * 3, faceIndices.begin() + (cluster._firstTriangle + cluster._triangleCount) * 3);
+			faceIndices = std::move(outIndices);
+		}
 
-	glm::vec3 RigidBody::GetVelocityAtPosition(const glm::vec3& positionWorldSpace) {
-		glm::vec3 linearVelocityContributionFromAngularVelocityAtPosition;
-		if (!Helpers::IsVectorZero(_angularVelocity)) {
-			auto rotationAxis = glm::normalize(_angularVelocity);
-			auto worldSpaceCom = GetCenterOfMass(true);
-			auto posToCom = worldSpaceCom - positionWorldSpace;
-			glm::vec3 directionOfAngularVelocityContributionAtPosition = -glm::normalize(glm::cross(rotationAxis, posToCom));
-			linearVelocityContributionFromAngularVelocityAtPosition = directionOfAngularVelocityContributionAtPosition * (glm::length(posToCom) * glm::length(_angularVelocity));
+		/**
+		 * @brief Reorders vertices in the order the face indices first use them, so that vertex fetches walk memory forwards, and remaps the indices to match.
+		 * Vertices no face uses are dropped.
+		 */
+		static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& faceIndices) {
+			std::vector<unsigned int> remap(vertices.size(), UINT32_MAX);
+			std::vector<Vertex> outVertices;
+			outVertices.reserve(vertices.size());
+			for (auto& index : faceIndices) {
+				if (remap[index] == UINT32_MAX) {
+					remap[index] = (unsigned int)outVertices.size();
+					outVertices.push_back(vertices[index]);
+				}
+				index = remap[index];
+			}
+			vertices = std::move(outVertices);
 		}
-		return linearVelocityContributionFromAngularVelocityAtPosition + _velocity;
-	}
 
-	void RigidBody::AddForceAtPosition(const glm::vec3& force, const glm::vec3& pointOfApplication, const float& deltaTimeSeconds, bool isApplicationPointWorldSpace, bool isForceWorldSpace, const bool& ignoreMass) {
-		auto worldSpaceTransform = _pGameObject->GetWorldSpaceTransform()._matrix;
-		auto worldSpaceForce = isForceWorldSpace ? force : glm::vec3(worldSpaceTransform * glm::vec4(force, 1.0f));
+		/**
+		 * @brief Simplifies a mesh by collapsing edges in order of increasing quadric error, following Garland and Heckbert's "Surface simplification using
+		 * quadric error metrics", until at most targetIndexCount face indices are left or no edge can be collapsed with an error below maxError.
+		 * Only the face indices are simplified, so the result references a subset of the same vertices. Vertices on borders and on UV or normal seams are
+		 * never moved, collapses between vertices whose normals differ too much are skipped, and so are collapses that would flip a face.
+		 * outError is the largest error of the collapses made, as a distance in the space of the vertex positions.
+		 */
+		static std::vector<unsigned int> Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& faceIndices, size_t targetIndexCount, float maxError, float& outError) {
+			outError = 0.0f;
+			auto vertexCount = vertices.size();
+			std::vector<unsigned int> indices = faceIndices;
+			if (indices.size() <= targetIndexCount) return indices;
 
-		// First calculate the translation component of the force to apply.
-		auto worldSpaceCom = GetCenterOfMass(true);
-		auto worldSpacePointOfApplication = isApplicationPointWorldSpace ? pointOfApplication : glm::vec3(worldSpaceTransform * glm::vec4(pointOfApplication, 1.0f));
+			// Vertices that share a position are one point of the surface, split because their normals or UVs differ. Each point is represented by its first vertex.
+			std::vector<unsigned int> points(vertexCount);
+			std::vector<unsigned int> wedgeCounts(vertexCount, 0);
+			{
+				std::map<std::tuple<float, float, float>, unsigned int> firstVertexByPosition;
+				for (unsigned int v = 0; v < vertexCount; ++v) {
+					auto& position = vertices[v]._position;
+					points[v] = firstVertexByPosition.emplace(std::make_tuple(position.x, position.y, position.z), v).first->second;
+					++wedgeCounts[points[v]];
+				}
+			}
 
-		glm::vec3 translationForce = CalculateTransmittedForce(worldSpacePointOfApplication, worldSpaceForce, worldSpaceCom);
-		//if (ignoreMass) glm::vec3 translationAcceleration = translationForce / _mass;
-		glm::vec3 translationDelta = translationForce * deltaTimeSeconds;
-		translationDelta.x = _lockTranslationX ? 0.0f : translationDelta.x;
-		translationDelta.y = _lockTranslationY ? 0.0f : translationDelta.y;
-		translationDelta.z = _lockTranslationZ ? 0.0f : translationDelta.z;
-		_velocity += translationDelta;
+			// Points on seams, on borders (edges used by one face) and on non manifold edges are locked.
+			std::vector<bool> isLocked(vertexCount, false);
+			{
+				std::map<std::pair<unsigned int, unsigned int>, int> edgeFaceCounts;
+				for (size_t i = 0; i < indices.size(); i += 3) {
+					for (int k = 0; k < 3; ++k) {
+						auto a = points[indices[i + k]];
+						auto b = points[indices[i + (k + 1) % 3]];
+						++edgeFaceCounts[std::make_pair(std::min(a, b), std::max(a, b))];
+					}
+				}
+				for (auto& edge : edgeFaceCounts) {
+					if (edge.second != 2) isLocked[edge.first.first] = isLocked[edge.first.second] = true;
+				}
+				for (unsigned int v = 0; v < vertexCount; ++v) {
+					if (wedgeCounts[points[v]] > 1) isLocked[points[v]] = true;
+				}
+			}
 
-		// Now calculate the rotation component.
-		auto positionToCom = worldSpaceCom - worldSpacePointOfApplication;
-		if (Helpers::IsVectorZero(positionToCom, 0.001f)) return;
+			// Every point starts with the area weighted sum of the planes of its faces.
+			std::vector<Quadric> quadrics(vertexCount);
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				auto& p0 = vertices[indices[i]]._position;
+				auto& p1 = vertices[indices[i + 1]]._position;
+				auto& p2 = vertices[indices[i + 2]]._position;
+				auto normal = glm::cross(p1 - p0, p2 - p0);
+				auto doubleArea = glm::length(normal);
+				if (doubleArea <= 0.0f) continue;
+				normal /= doubleArea;
+				auto plane = Quadric::FromPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5f);
+				for (int k = 0; k < 3; ++k) quadrics[points[indices[i + k]]].Add(plane);
+			}
 
-		auto rotationAxis = -glm::normalize(glm::cross(positionToCom, worldSpaceForce));
-		if (glm::isnan(rotationAxis.x) || glm::isnan(rotationAxis.y) || glm::isnan(rotationAxis.x)) return;
+			struct Collapse {
+				unsigned int _from;
+				unsigned int _to;
+				double _error;
+			};
+			auto maxSquaredError = (double)maxError * maxError;
+			std::vector<unsigned int> adjacencyOffsets;
+			std::vector<unsigned int> adjacency;
+			std::vector<Collapse> collapses;
+			std::vector<unsigned int> collapseTargets(vertexCount);
+			std::vector<bool> isTouched(vertexCount);
+
+			while (indices.size() > targetIndexCount) {
+				// Faces using each vertex.
+				adjacencyOffsets.assign(vertexCount + 1, 0);
+				for (auto index : indices) ++adjacencyOffsets[index + 1];
+				for (size_t v = 0; v < vertexCount; ++v) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+				adjacency.resize(indices.size());
+				{
+					std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+					for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+				}
 
-		auto comPerpendicularDirection = glm::normalize(glm::cross(positionToCom, rotationAxis));
-		auto rotationalForce = comPerpendicularDirection * glm::dot(comPerpendicularDirection, worldSpaceForce);
-		auto rotationalInertia = powf(glm::length(positionToCom), 2.0f) * _mass;
-		// TODO: better approximation for rotational inertia.
+				// The cheapest collapse of every vertex that can move along one of its edges. Moving a vertex onto another makes the faces between them disappear.
+				collapses.clear();
+				std::vector<Collapse> bestCollapses(vertexCount, Collapse{ 0, 0, -1.0 });
+				for (size_t i = 0; i < indices.size(); i += 3) {
+					for (int k = 0; k < 6; ++k) {
+						auto from = indices[i + k % 3];
+						auto to = indices[i + (k % 3 + (k < 3 ? 1 : 2)) % 3];
+						if (isLocked[points[from]]) continue;
+						if (glm::dot(vertices[from]._normal, vertices[to]._normal) < _minCollapseNormalCosine) continue;
+
+						auto combined = quadrics[points[from]];
+						combined.Add(quadrics[points[to]]);
+						auto error = combined.Evaluate(vertices[to]._position);
+						auto& best = bestCollapses[from];
+						if (best._error < 0.0 || error < best._error || (error == best._error && to < best._to)) best = Collapse{ from, to, error };
+					}
+				}
+				for (auto& collapse : bestCollapses)
+					if (collapse._error >= 0.0 && collapse._error <= maxSquaredError) collapses.push_back(collapse);
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+					return a._error != b._error ? a._error < b._error : a._from < b._from;
+				});
 
-		auto angularAcceleration = glm::cross(rotationalForce, positionToCom) / rotationalInertia;
-		AddTorque(angularAcceleration, deltaTimeSeconds, true);
-	}
+				// Collapse as many vertices as possible in this pass, leaving alone the neighborhoods already changed so that the flip test stays correct.
+				for (size_t v = 0; v < vertexCount; ++v) collapseTargets[v] = (unsigned int)v;
+				std::fill(isTouched.begin(), isTouched.end(), false);
+				auto faceCount = indices.size() / 3;
+				auto targetFaceCount = targetIndexCount / 3;
+				bool hasCollapsed = false;
+				for (auto& collapse : collapses) {
+					if (faceCount <= targetFaceCount) break;
+					if (isTouched[points[collapse._from]] || isTouched[points[collapse._to]]) continue;
+
+					auto& toPosition = vertices[collapse._to]._position;
+					size_t removedFaceCount = 0;
+					bool flips = false;
+					for (auto j = adjacencyOffsets[collapse._from]; j < adjacencyOffsets[collapse._from + 1] && !flips; ++j) {
+						auto face = adjacency[j] * 3;
+						unsigned int corners[3] = { indices[face], indices[face + 1], indices[face + 2] };
+						if (points[corners[0]] == points[collapse._to] || points[corners[1]] == points[collapse._to] || points[corners[2]] == points[collapse._to]) {
+							++removedFaceCount;
+							continue;
+						}
+						glm::vec3 before[3], after[3];
+						for (int k = 0; k < 3; ++k) {
+							before[k] = vertices[corners[k]]._position;
+							after[k] = corners[k] == collapse._from ? toPosition : before[k];
+						}
+						auto normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+						auto normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+						flips = glm::dot(normalBefore, normalAfter) <= 0.0f;
+					}
+					if (flips) continue;
 
-	void RigidBody::AddForce(const glm::vec3& force, const float& deltaTimeSeconds, const bool& ignoreMass) {
-		auto translationDelta = ignoreMass ? (force * deltaTimeSeconds) : ((force / _mass) * deltaTimeSeconds);
-		translationDelta.x = _lockTranslationX ? 0.0f : translationDelta.x;
-		translationDelta.y = _lockTranslationY ? 0.0f : translationDelta.y;
-		translationDelta.z = _lockTranslationZ ? 0.0f : translationDelta.z;
-		_velocity += translationDelta;
-	}
+					collapseTargets[collapse._from] = collapse._to;
+					quadrics[points[collapse._to]].Add(quadrics[points[collapse._from]]);
+					for (auto j = adjacencyOffsets[collapse._from]; j < adjacencyOffsets[collapse._from + 1]; ++j) {
+						auto face = adjacency[j] * 3;
+						for (int k = 0; k < 3; ++k) isTouched[points[indices[face + k]]] = true;
+					}
+					outError = std::max(outError, (float)sqrt(collapse._error));
+					faceCount -= removedFaceCount;
+					hasCollapsed = true;
+				}
+				if (!hasCollapsed) break;
+
+				// Move the collapsed vertices and drop the faces that became degenerate.
+				size_t writeIndex = 0;
+				for (size_t i = 0; i < indices.size(); i += 3) {
+					auto a = collapseTargets[indices[i]];
+					auto b = collapseTargets[indices[i + 1]];
+					auto c = collapseTargets[indices[i + 2]];
+					if (points[a] == points[b] || points[b] == points[c] || points[a] == points[c]) continue;
+					indices[writeIndex++] = a;
+					indices[writeIndex++] = b;
+					indices[writeIndex++] = c;
+				}
+				indices.resize(writeIndex);
+			}
 
-	void RigidBody::AddTorque(const glm::vec3& torqueWorldSpaceAxis, const float& deltaTimeSeconds, const bool& ignoreMass) {
-		auto rotationDelta = ignoreMass ? (torqueWorldSpaceAxis * deltaTimeSeconds) : ((torqueWorldSpaceAxis / _mass) * deltaTimeSeconds);
-		rotationDelta.x = _lockRotationX ? 0.0f : rotationDelta.x;
-		rotationDelta.y = _lockRotationY ? 0.0f : rotationDelta.y;
-		rotationDelta.z = _lockRotationZ ? 0.0f : rotationDelta.z;
-		_angularVelocity += rotationDelta;
-	}
+			return indices;
+		}
 
-	CollisionContext RigidBody::DetectCollision(RigidBody& other) {
-		CollisionContext outCtx;
-		outCtx._collidee = &other;
-		auto worldSpaceOther = other._pGameObject->GetWorldSpaceTransform();
-		auto worldSpaceCurrent = _pGameObject->GetWorldSpaceTransform();
-		auto& otherMesh = other._pGameObject->_pMesh;
-		auto& mesh = _pGameObject->_pMesh;
+		/**
+		 * @brief Splits indexCount face indices into meshlets of consecutive faces, starting a new meshlet whenever the next face would take the current one
+		 * over _maxMeshletVertexCount vertices or _maxMeshletFaceCount faces. Faces are not reordered: after OptimizeVertexCache consecutive faces are
+		 * already neighbours. The index ranges of the meshlets are relative to pFaceIndices.
+		 */
+		static std::vector<Mesh::Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, const unsigned int* pFaceIndices, size_t indexCount) {
+			std::vector<Mesh::Meshlet> meshlets;
 
-		for (int i = 0; i < otherMesh->_faceIndices._indexData.size(); i += 3) {
-			for (int j = 0; j < otherMesh->_faceIndices._indexData.size(); j += 3) {
+			// Index of the meshlet each vertex was last added to, so that checking whether a vertex is in the current meshlet needs no search.
+			std::vector<size_t> lastMeshlets(vertices.size(), SIZE_MAX);
+			size_t firstIndex = 0;
+			size_t vertexCount = 0;
+			for (size_t i = 0; i < indexCount; i += 3) {
+				size_t newVertexCount = 0;
+				for (int k = 0; k < 3; ++k) {
+					if (lastMeshlets[pFaceIndices[i + k]] != meshlets.size()) ++newVertexCount;
+				}
+				if (vertexCount + newVertexCount > _maxMeshletVertexCount || (i - firstIndex) / 3 >= _maxMeshletFaceCount) {
+					meshlets.push_back(ComputeMeshletBounds(vertices, pFaceIndices, firstIndex, i - firstIndex));
+					firstIndex = i;
+					vertexCount = 0;
+				}
+				for (int k = 0; k < 3; ++k) {
+					auto& lastMeshlet = lastMeshlets[pFaceIndices[i + k]];
+					if (lastMeshlet == meshlets.size()) continue;
+					lastMeshlet = meshlets.size();
+					++vertexCount;
+				}
+			}
+			if (indexCount > firstIndex) meshlets.push_back(ComputeMeshletBounds(vertices, pFaceIndices, firstIndex, indexCount - firstIndex));
+			return meshlets;
+		}
 
-				auto v1Other = glm::vec3(worldSpaceOther._matrix * glm::vec4(otherMesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[i]]._position, 1.0f));
-				auto v2Other = glm::vec3(worldSpaceOther._matrix * glm::vec4(otherMesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[i + 1]]._position, 1.0f));
-				auto v3Other = glm::vec3(worldSpaceOther._matrix * glm::vec4(otherMesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[i + 2]]._position, 1.0f));
+	private:
 
-				auto v1 = glm::vec3(worldSpaceCurrent._matrix * glm::vec4(mesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[j]]._position, 1.0f));
-				auto v2 = glm::vec3(worldSpaceCurrent._matrix * glm::vec4(mesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[j + 1]]._position, 1.0f));
-				auto v3 = glm::vec3(worldSpaceCurrent._matrix * glm::vec4(mesh->_vertices._vertexData[otherMesh->_faceIndices._indexData[j + 2]]._position, 1.0f));
+		/**
+		 * @brief Collapses between vertices whose normals are further apart than this cosine are not made, to keep the shading of creases.
+		 */
+		static constexpr float _minCollapseNormalCosine = 0.5f;
 
-				glm::vec3 intersectionPoint1, intersectionPoint2, intersectionPoint3;
-				auto edge1 = v2Other - v1Other;
-				auto edge2 = v3Other - v1Other;
-				auto edge3 = v2Other - v3Other;
-				glm::vec3 normal = -glm::normalize(glm::cross(edge1, edge2));
+		/**
+		 * @brief Sum of squared distances to a set of planes, as the symmetric matrix of the plane equations (upper triangle), divided by the
+		 * total weight of the planes when evaluated so that the error is a mean squared distance.
+		 */
+		struct Quadric {
+			double _a00 = 0.0, _a01 = 0.0, _a02 = 0.0, _a11 = 0.0, _a12 = 0.0, _a22 = 0.0;
+			double _b0 = 0.0, _b1 = 0.0, _b2 = 0.0;
+			double _c = 0.0;
+			double _weight = 0.0;
 
-				// Check collision by testing this body's edges as segments against the other body's face.
-				if (IsSegmentIntersectingTriangle(v1, v2 - v1, v1Other, v2Other, v3Other, intersectionPoint1)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint1, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
-				if (IsSegmentIntersectingTriangle(v1, v3 - v1, v1Other, v2Other, v3Other, intersectionPoint2)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint2, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
-				if (IsSegmentIntersectingTriangle(v3, v2 - v3, v1Other, v2Other, v3Other, intersectionPoint3)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint3, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
-				//if (!IsVectorZero(intersectionPoint1) || !IsVectorZero(intersectionPoint2) || !IsVectorZero(intersectionPoint3)) return outCtx;
+			static Quadric FromPlane(const glm::vec3& normal, float distance, float weight) {
+				Quadric q;
+				double x = normal.x, y = normal.y, z = normal.z, d = distance, w = weight;
+				q._a00 = w * x * x; q._a01 = w * x * y; q._a02 = w * x * z;
+				q._a11 = w * y * y; q._a12 = w * y * z; q._a22 = w * z * z;
+				q._b0 = w * x * d; q._b1 = w * y * d; q._b2 = w * z * d;
+				q._c = w * d * d;
+				q._weight = w;
+				return q;
+			}
 
-				// Check collision by testing the other body's edges as segments against the current body's face.
-				if (IsSegmentIntersectingTriangle(v1Other, edge1, v1, v2, v3, intersectionPoint1)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint1, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
-				if (IsSegmentIntersectingTriangle(v1Other, edge2, v1, v2, v3, intersectionPoint2)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint2, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
-				if (IsSegmentIntersectingTriangle(v3Other, edge3, v1, v2, v3, intersectionPoint3)) { outCtx._collisionPositions.push_back(glm::vec4(intersectionPoint3, 1.0f)); outCtx._collisionNormals.push_back(glm::vec4(normal, 1.0f)); }
+			void Add(const Quadric& other) {
+				_a00 += other._a00; _a01 += other._a01; _a02 += other._a02;
+				_a11 += other._a11; _a12 += other._a12; _a22 += other._a22;
+				_b0 += other._b0; _b1 += other._b1; _b2 += other._b2;
+				_c += other._c;
+				_weight += other._weight;
 			}
-		}
 
-		return outCtx;
-	}
+			double Evaluate(const glm::vec3& position) const {
+				double x = position.x, y = position.y, z = position.z;
+				auto error = _a00 * x * x + _a11 * y * y + _a22 * z * z + 2.0 * (_a01 * x * y + _a02 * x * z + _a12 * y * z) + 2.0 * (_b0 * x + _b1 * y + _b2 * z) + _c;
+				return _weight > 0.0 ? fabs(error) / _weight : 0.0;
+			}
+		};
 
-	std::vector<GameObject*> RigidBody::GetGameObjects(GameObject* pRoot, std::vector<GameObject*> excludedObjects) {
-		std::vector<GameObject*> outGameObjects;
-		if (!pRoot->_pMesh) goto searchChildren;
-		if (pRoot->_pMesh->_vertices._vertexData.size() < 1) goto searchChildren;
-		for (int i = 0; i < excludedObjects.size(); ++i) if (excludedObjects[i] == pRoot) goto searchChildren;
-		outGameObjects.push_back(pRoot);
+		static Mesh::Meshlet ComputeMeshletBounds(const std::vector<Vertex>& vertices, const unsigned int* pFaceIndices, size_t firstIndex, size_t indexCount) {
+			Mesh::Meshlet meshlet{};
+			meshlet._firstIndex = (uint32_t)firstIndex;
+			meshlet._indexCount = (uint32_t)indexCount;
 
-	searchChildren:
-		for (int i = 0; i < pRoot->_children.size(); ++i) {
-			auto objects = GetGameObjects(pRoot->_children[i], excludedObjects);
-			outGameObjects.insert(outGameObjects.end(), objects.begin(), objects.end());
-		}
-		return outGameObjects;
-	}
+			BoundingBox bounds;
+			for (size_t i = firstIndex; i < firstIndex + indexCount; ++i) {
+				bounds._min = glm::min(bounds._min, vertices[pFaceIndices[i]]._position);
+				bounds._max = glm::max(bounds._max, vertices[pFaceIndices[i]]._position);
+			}
+			meshlet._center = bounds.GetCenter();
+			for (size_t i = firstIndex; i < firstIndex + indexCount; ++i) {
+				meshlet._radius = std::max(meshlet._radius, glm::length(vertices[pFaceIndices[i]]._position - meshlet._center));
+			}
 
-	std::vector<CollisionContext> RigidBody::DetectCollisions(VkContext& ctx, VkContext& collisionCtx, std::vector<RigidBody*> bodiesToExclude) {
-		std::vector<GameObject*> gameObjectsToExclude;
-		gameObjectsToExclude.push_back(_pGameObject);
-		for (int i = 1; i < gameObjectsToExclude.size(); ++i) gameObjectsToExclude[i] = bodiesToExclude[i - 1]->_pGameObject;
-		auto otherGameObjects = GetGameObjects(_pGameObject->_pScene->_pRootGameObject, gameObjectsToExclude);
+			// The face normals are oriented like the vertex normals rather than by winding, so the cones are only as right as the normals are. Faces whose
+			// vertex normals are zero fall back to their winding, reversed: importing mirrors the positions, which turns counterclockwise front faces clockwise.
+			std::vector<glm::vec3> faceNormals;
+			glm::vec3 axis(0.0f);
+			for (size_t i = firstIndex; i < firstIndex + indexCount; i += 3) {
+				auto& v0 = vertices[pFaceIndices[i]];
+				auto& v1 = vertices[pFaceIndices[i + 1]];
+				auto& v2 = vertices[pFaceIndices[i + 2]];
+				auto normal = glm::cross(v1._position - v0._position, v2._position - v0._position);
+				auto length = glm::length(normal);
+				if (length <= 0.0f) continue;
+				normal /= length;
+				auto vertexNormal = v0._normal + v1._normal + v2._normal;
+				if (glm::dot(vertexNormal, vertexNormal) <= 0.0f || glm::dot(normal, vertexNormal) < 0.0f) normal = -normal;
+				faceNormals.push_back(normal);
+				axis += normal;
+			}
 
-		std::vector<CollisionContext> outCollisions;
-		for (int i = 0; i < otherGameObjects.size(); ++i) {
-			if (otherGameObjects[i]->_pMesh->_vertices._vertexData.size() < 1) continue;
-			if (!otherGameObjects[i]->_pBody) continue;
-			//auto collision = DetectCollision(otherGameObjects[i]->_body);
-			//bool hasCollided = collision._collisionPositions.size() > 0;
-			bool hasCollided = false;
+			meshlet._coneCutoff = 1.0f;
+			auto axisLength = glm::length(axis);
+			if (axisLength <= 0.0f) return meshlet;
+			meshlet._coneAxis = axis / axisLength;
 
-			auto start = std::chrono::high_resolution_clock::now();
-			auto collision = GpuCollisionDetector::Run(collisionCtx, *this, *otherGameObjects[i]->_pBody, hasCollided);
-			auto end = std::chrono::high_resolution_clock::now();
-			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-			if (elapsed.count() > 10)
-				std::cout << "Elapsed time: " << elapsed.count() << " milliseconds" << std::endl;
+			auto minDot = 1.0f;
+			for (auto& normal : faceNormals) minDot = std::min(minDot, glm::dot(meshlet._coneAxis, normal));
 
-			if (!hasCollided) continue;
-			outCollisions.push_back(collision);
-			//if (collision._collisionPositions.size() > 0) outCollisions.push_back(collision);
+			// A cone this wide almost never faces away from the camera as a whole, so it is not worth testing.
+			if (minDot > 0.1f) meshlet._coneCutoff = sqrtf(1.0f - minDot * minDot);
+			return meshlet;
 		}
-		return outCollisions;
-	}
 
-	void RigidBody::Initialize(GameObject* pGameObject, const float& mass, const bool& overrideCenterOfMass, const glm::vec3& overriddenCenterOfMass) {
-		if (!pGameObject) return;
-		if (!pGameObject->_pMesh) return;
-		if (pGameObject->_pMesh->_vertices._vertexData.size() < 1) return;
-		if (mass <= 0.001f) return;
+		static float VertexScore(int cachePosition, uint32_t remainingTriangles) {
+			if (remainingTriangles == 0) return -1.0f;
 
-		_pGameObject = pGameObject;
-		_mass = mass;
-		_isCenterOfMassOverridden = overrideCenterOfMass;
-		_overriddenCenterOfMassLocalSpace = overriddenCenterOfMass;
-		_isInitialized = true;
-	}
+			float score = 0.0f;
+			if (cachePosition >= 0) {
+				// The last triangle's vertices get a fixed score, so that the same triangle is not just flipped around.
+				if (cachePosition < 3) score = 0.75f;
+				else score = powf(1.0f - (float)(cachePosition - 3) / (float)(_cacheSize - 3), 1.5f);
+			}
+
+			// Vertices with few triangles left get a boost, so that they are finished off rather than left behind as lone triangles.
+			return score + 2.0f * powf((float)remainingTriangles, -0.5f);
+		}
+	};
 
 	/**
-	 * @brief Represents a general-purpose camera.
+	 * @brief Layout of the engine's own scene file format (.cscene), that SceneLoader cooks glTF files into.
+	 * A cooked file is a header followed by tables of fixed size records, a string table and 16 byte aligned data blobs, all referenced
+	 * by byte offsets from the start of the file. Nothing needs parsing: a mapped file is read in place, and vertex, index and texture data
+	 * are uploaded to the GPU straight from the mapping.
 	 */
-	class Camera : public GameObject {
+	class SceneFile {
 	public:
 
 		/**
-		 * @brief Horizontal FOV in degrees.
+		 * @brief "CSCN" read as a little endian uint32_t.
 		 */
-		float _horizontalFov;
+		static constexpr uint32_t _magic = 0x4E435343;
 
 		/**
-		 * @brief Lower bound that maps to normalizedDeviceCoordinates.z = 0 in the vertex shader, in meters.
-		 * Anything closer than this will not be rendered by the graphics pipeline.
+		 * @brief Bumped every time the layout of the file or the way glTF data is cooked changes, so that old cooked files are cooked again.
 		 */
-		float _nearClippingDistance;
+		static constexpr uint32_t _version = 8;
 
 		/**
-		 * @brief Upper bound that maps to normalizedDeviceCoordinates.z = 1 in the vertex shader, in meters.
-		 * Anything farther than this will not be rendered by the graphics pipeline.
+		 * @brief String offset meaning "no string".
 		 */
-		float _farClippingDistance;
+		static constexpr uint32_t _noString = UINT32_MAX;
 
 		/**
-		 * @brief This is a transform passed to the vertex shader that translates vertices from world space into camera space.
+		 * @brief Most levels of detail a primitive can have, including the full detail one.
 		 */
-		Transform _view;
+		static constexpr uint32_t _maxLodCount = 5;
+
+		struct Header {
+			uint32_t _magic;
+			uint32_t _version;
+			uint32_t _nodeCount;
+			uint32_t _meshCount;
+			uint32_t _primitiveCount;
+			uint32_t _materialCount;
+			uint32_t _textureCount;
+			uint32_t _meshletCount;
+			uint64_t _nodesOffset;
+			uint64_t _meshesOffset;
+			uint64_t _primitivesOffset;
+			uint64_t _meshletsOffset;
+			uint64_t _materialsOffset;
+			uint64_t _texturesOffset;
+			uint64_t _stringsOffset;
+			uint64_t _stringsSizeBytes;
+		};
 
 		/**
-		 * @brief Up direction of the camera.
+		 * @brief Rigid body settings of a node, read from the custom properties of the glTF node when cooking.
 		 */
-		glm::vec3 _up;
+		enum NodeFlags : uint32_t {
+			AffectedByGravity = 1 << 0,
+			Collidable = 1 << 1,
+			LockRotationX = 1 << 2,
+			LockRotationY = 1 << 3,
+			LockRotationZ = 1 << 4,
+			LockTranslationX = 1 << 5,
+			LockTranslationY = 1 << 6,
+			LockTranslationZ = 1 << 7
+		};
 
-		// Temp
-		float _lastYaw = 0.0f;
-		float _lastPitch = 0.0f;
-		float _lastRoll = 0.0f;
+		/**
+		 * @brief A game object. Nodes are stored depth first, so a node always comes after its parent.
+		 */
+		struct NodeRecord {
+			glm::mat4 _localTransform;
+			glm::vec3 _scale;
 
-		float _yaw = 0.0f;
-		float _pitch = 0.0f;
-		float _roll = 0.0f;
+			/**
+			 * @brief Index of the parent node, or -1 if the node is a child of the root of the scene.
+			 */
+			int32_t _parentIndex;
 
-		float _lastScrollY = 0.0f;
+			/**
+			 * @brief Index of the mesh record, or -1 if the node has no mesh.
+			 */
+			int32_t _meshIndex;
+			uint32_t _nameOffset;
 
-		/**
-		 * @brief Camera related data directed to the vertex shader. Knowing this, the vertex shader is able to calculate the correct
-		 * Vulkan view volume coordinates.
-		 */
-		struct {
-			float tanHalfHorizontalFov;
-			float aspectRatio;
-			float nearClipDistance;
-			float farClipDistance;
-			glm::mat4 worldToCamera;
-			glm::vec3 transform;
-		} _cameraData;
+			/**
+			 * @brief Name of the node whose mesh the node collides with, or _noString if the node has no rigid body.
+			 */
+			uint32_t _collisionMeshNameOffset;
+			float _friction;
+			float _mass;
+			uint32_t _flags;
 
-		Camera() {
-			_horizontalFov = 55.0f;
-			_nearClippingDistance = 0.1f;
-			_farClippingDistance = 200.0f;
-			_up = glm::vec3(0.0f, 1.0f, 0.0f);
-		}
+			/**
+			 * @brief Level of detail of the node's mesh used for collision detection. Coarser levels are cheaper collision proxies.
+			 */
+			uint32_t _collisionLod;
+		};
 
-		Camera(float horizontalFov, float nearClippingDistance, float farClippingDistance) {
-			_horizontalFov = horizontalFov;
-			_nearClippingDistance = nearClippingDistance;
-			_farClippingDistance = farClippingDistance;
-			_up = glm::vec3(0.0f, 1.0f, 0.0f);
-		}
+		/**
+		 * @brief A glTF mesh. The vertices and face indices of all its primitives are stored in one blob each, and each primitive is a draw range within them.
+		 */
+		struct MeshRecord {
+			uint32_t _firstPrimitive;
+			uint32_t _primitiveCount;
+			uint32_t _vertexCount;
+			uint32_t _indexCount;
 
-		ShaderResources CreateDescriptorSets(VkContext& ctx, std::vector<DescriptorSetLayout>& layouts) {
-			auto descriptorSetID = 0;
+			/**
+			 * @brief Offset of _vertexCount Vertex structs, ready to be copied to a vertex buffer.
+			 */
+			uint64_t _verticesOffset;
 
-			// Create a temporary buffer.
-			Buffer buffer{};
-			auto bufferSizeBytes = sizeof(_cameraData);
-			buffer._createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			buffer._createInfo.size = bufferSizeBytes;
-			buffer._createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-			vkCreateBuffer(ctx._logicalDevice, &buffer._createInfo, nullptr, &buffer._buffer);
+			/**
+			 * @brief Offset of _indexCount 32 bit face indices.
+			 */
+			uint64_t _indicesOffset;
+		};
 
-			// Allocate memory for the buffer.
-			VkMemoryRequirements requirements{};
-			vkGetBufferMemoryRequirements(ctx._logicalDevice, buffer._buffer, &requirements);
-			buffer._gpuMemory = PhysicalDevice::AllocateMemory(ctx._physicalDevice, ctx._logicalDevice, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		/**
+		 * @brief A level of detail of a primitive: a range of its face indices that draws a simplified version of it.
+		 */
+		struct LodRecord {
+			/**
+			 * @brief Range of the face indices of the level within the face indices of the primitive.
+			 */
+			uint32_t _firstIndex;
+			uint32_t _indexCount;
 
-			// Map memory to the correct GPU and CPU ranges for the buffer.
-			vkBindBufferMemory(ctx._logicalDevice, buffer._buffer, buffer._gpuMemory, 0);
-			vkMapMemory(ctx._logicalDevice, buffer._gpuMemory, 0, bufferSizeBytes, 0, &buffer._cpuMemory);
-			memcpy(buffer._cpuMemory, &_cameraData, bufferSizeBytes);
+			/**
+			 * @brief How far, at most, the simplified surface is from the full detail surface, in object space. 0 for the full detail level.
+			 */
+			float _error;
 
-			_buffers.push_back(buffer);
+			/**
+			 * @brief Range of the meshlets of the level within the meshlets of the primitive.
+			 */
+			uint32_t _firstMeshlet;
+			uint32_t _meshletCount;
+		};
 
-			VkDescriptorPool descriptorPool{};
-			VkDescriptorPoolSize poolSizes[1] = { VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 } };
-			VkDescriptorPoolCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-			createInfo.maxSets = (uint32_t)1;
-			createInfo.poolSizeCount = (uint32_t)1;
-			createInfo.pPoolSizes = poolSizes;
-			vkCreateDescriptorPool(ctx._logicalDevice, &createInfo, nullptr, &descriptorPool);
+		/**
+		 * @brief A meshlet of a level of detail of a primitive. See Mesh::Meshlet.
+		 */
+		struct MeshletRecord {
+			glm::vec3 _center;
+			float _radius;
+			glm::vec3 _coneAxis;
+			float _coneCutoff;
 
-			VkDescriptorSet descriptorSet = VkHelper::AllocateDescriptorSet(ctx._logicalDevice, descriptorPool, layouts[descriptorSetID]._layout);
+			/**
+			 * @brief Range of the face indices of the meshlet within the face indices of the primitive.
+			 */
+			uint32_t _firstIndex;
+			uint32_t _indexCount;
+		};
 
-			// Update the descriptor set's data with the environment map's image.
-			VkDescriptorBufferInfo bufferInfo{ buffer._buffer, 0, buffer._createInfo.size };
-			VkWriteDescriptorSet writeInfo = {};
-			writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			writeInfo.dstSet = descriptorSet;
-			writeInfo.descriptorCount = 1;
-			writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			writeInfo.pBufferInfo = &bufferInfo;
-			writeInfo.dstBinding = 0;
-			vkUpdateDescriptorSets(ctx._logicalDevice, 1, &writeInfo, 0, nullptr);
+		struct PrimitiveRecord {
+			/**
+			 * @brief Index of the material record, or -1 if the primitive uses the default material.
+			 */
+			int32_t _materialIndex;
 
-			auto descriptorSets = std::vector<VkDescriptorSet>{ descriptorSet };
-			_shaderResources._data.try_emplace(layouts[descriptorSetID], descriptorSets);
-			return _shaderResources;
-		}
+			/**
+			 * @brief Range of the face indices of all the levels of detail of the primitive within the indices of its mesh.
+			 */
+			uint32_t _firstIndex;
+			uint32_t _indexCount;
 
-		void UpdateShaderResources() {
-			auto& globalSettings = GlobalSettings::Instance();
+			/**
+			 * @brief Levels of detail, from full detail to coarsest. All of them use the same vertices.
+			 */
+			uint32_t _lodCount;
+			LodRecord _lods[_maxLodCount];
 
-			_cameraData.worldToCamera = _view._matrix;
-			_cameraData.tanHalfHorizontalFov = tan(glm::radians(_horizontalFov / 2.0f));
-			_cameraData.aspectRatio = Helpers::Convert<uint32_t, float>(globalSettings._windowWidth) / Helpers::Convert<uint32_t, float>(globalSettings._windowHeight);
-			_cameraData.nearClipDistance = _nearClippingDistance;
-			_cameraData.farClipDistance = _farClippingDistance;
-			_cameraData.transform = _localTransform.Position();
+			/**
+			 * @brief Range of the meshlets of all the levels of detail of the primitive within the meshlet table.
+			 */
+			uint32_t _firstMeshlet;
+			uint32_t _meshletCount;
 
-			memcpy(_buffers[0]._cpuMemory, &_cameraData, sizeof(_cameraData));
-		}
+			/**
+			 * @brief Range of the vertices of the primitive within the vertices of its mesh. Face indices are relative to _vertexOffset.
+			 */
+			uint32_t _vertexOffset;
+			uint32_t _vertexCount;
 
-		void Update(VkContext& vkContext, KeyboardMouse& input) {
-			auto& time = Time::Instance();
-			auto mouseSens = GlobalSettings::Instance()._mouseSensitivity;
-			_yaw += (float)input._deltaMouseX * mouseSens;
+			/**
+			 * @brief Bounds of the vertices, used for culling and collision detection.
+			 */
+			glm::vec3 _boundsMin;
+			glm::vec3 _boundsMax;
+		};
 
-			if ((_pitch + (input._deltaMouseY * mouseSens)) > -90 && (_pitch + (input._deltaMouseY * mouseSens)) < 90) {
-				_pitch += (float)input._deltaMouseY * mouseSens;
-			}
+		struct MaterialRecord {
+			uint32_t _nameOffset;
 
-			if (input.IsKeyHeldDown(GLFW_KEY_Q)) {
-				_roll += 0.1f * (float)Time::Instance()._deltaTime;
-			}
+			/**
+			 * @brief Index of the texture record of each map, in Material::MapType order, or -1 for maps taken from the default material.
+			 */
+			int32_t _textureIndices[Material::MapTypeCount];
+		};
 
-			if (input.IsKeyHeldDown(GLFW_KEY_E)) {
-				_roll -= 0.1f * (float)Time::Instance()._deltaTime;
-			}
+		struct TextureRecord {
+			uint32_t _width;
+			uint32_t _height;
+			VkFormat _format;
+			uint32_t _padding;
 
-			if (input.IsKeyHeldDown(GLFW_KEY_W)) {
-				_localTransform.Translate(_localTransform.Forward() * 0.05f * (float)time._deltaTime);
-			}
+			/**
+			 * @brief Hash of the size and texels of the texture. Textures with the same content are only stored once.
+			 */
+			uint64_t _contentHash;
 
-			if (input.IsKeyHeldDown(GLFW_KEY_A)) {
-				_localTransform.Translate(-_localTransform.Right() * 0.05f * (float)time._deltaTime);
-			}
+			/**
+			 * @brief Offset of the decoded texels, ready to be copied to an image of _format.
+			 */
+			uint64_t _dataOffset;
+			uint64_t _dataSizeBytes;
+		};
 
-			if (input.IsKeyHeldDown(GLFW_KEY_S)) {
-				_localTransform.Translate(-_localTransform.Forward() * 0.05f * (float)time._deltaTime);
+		std::vector<NodeRecord> _nodes;
+		std::vector<MeshRecord> _meshes;
+		std::vector<PrimitiveRecord> _primitives;
+		std::vector<MeshletRecord> _meshlets;
+		std::vector<MaterialRecord> _materials;
+		std::vector<TextureRecord> _textures;
+
+		/**
+		 * @brief Returns the offset of the string in the string table, adding it if needed.
+		 */
+		uint32_t AddString(const std::string& string) {
+			auto offset = (uint32_t)_strings.size();
+			_strings.insert(_strings.end(), string.begin(), string.end());
+			_strings.push_back('\0');
+			return offset;
+		}
+
+		/**
+		 * @brief Appends data to the data section and returns its offset relative to the start of the data section. Save turns these into file offsets.
+		 */
+		uint64_t AddBlob(const void* pData, size_t sizeBytes) {
+			auto offset = (uint64_t)AlignUp(_blobs.size());
+			_blobs.resize(offset + sizeBytes);
+			if (sizeBytes > 0) memcpy(_blobs.data() + offset, pData, sizeBytes);
+			return offset;
+		}
+
+		bool Save(const std::filesystem::path& absolutePath) {
+			Header header{};
+			header._magic = _magic;
+			header._version = _version;
+			header._nodeCount = (uint32_t)_nodes.size();
+			header._meshCount = (uint32_t)_meshes.size();
+			header._primitiveCount = (uint32_t)_primitives.size();
+			header._materialCount = (uint32_t)_materials.size();
+			header._textureCount = (uint32_t)_textures.size();
+			header._meshletCount = (uint32_t)_meshlets.size();
+			header._nodesOffset = AlignUp(sizeof(Header));
+			header._meshesOffset = AlignUp(header._nodesOffset + GetVectorSizeInBytes(_nodes));
+			header._primitivesOffset = AlignUp(header._meshesOffset + GetVectorSizeInBytes(_meshes));
+			header._meshletsOffset = AlignUp(header._primitivesOffset + GetVectorSizeInBytes(_primitives));
+			header._materialsOffset = AlignUp(header._meshletsOffset + GetVectorSizeInBytes(_meshlets));
+			header._texturesOffset = AlignUp(header._materialsOffset + GetVectorSizeInBytes(_materials));
+			header._stringsOffset = AlignUp(header._texturesOffset + GetVectorSizeInBytes(_textures));
+			header._stringsSizeBytes = _strings.size();
+			auto blobsOffset = AlignUp(header._stringsOffset + header._stringsSizeBytes);
+
+			auto meshes = _meshes;
+			for (auto& mesh : meshes) {
+				mesh._verticesOffset += blobsOffset;
+				mesh._indicesOffset += blobsOffset;
 			}
+			auto textures = _textures;
+			for (auto& texture : textures) texture._dataOffset += blobsOffset;
+
+			std::vector<unsigned char> fileBytes(blobsOffset + _blobs.size(), 0);
+			memcpy(fileBytes.data(), &header, sizeof(Header));
+			if (_nodes.size() > 0) memcpy(fileBytes.data() + header._nodesOffset, _nodes.data(), GetVectorSizeInBytes(_nodes));
+			if (meshes.size() > 0) memcpy(fileBytes.data() + header._meshesOffset, meshes.data(), GetVectorSizeInBytes(meshes));
+			if (_primitives.size() > 0) memcpy(fileBytes.data() + header._primitivesOffset, _primitives.data(), GetVectorSizeInBytes(_primitives));
+			if (_meshlets.size() > 0) memcpy(fileBytes.data() + header._meshletsOffset, _meshlets.data(), GetVectorSizeInBytes(_meshlets));
+			if (_materials.size() > 0) memcpy(fileBytes.data() + header._materialsOffset, _materials.data(), GetVectorSizeInBytes(_materials));
+			if (textures.size() > 0) memcpy(fileBytes.data() + header._texturesOffset, textures.data(), GetVectorSizeInBytes(textures));
+			if (_strings.size() > 0) memcpy(fileBytes.data() + header._stringsOffset, _strings.data(), _strings.size());
+			if (_blobs.size() > 0) memcpy(fileBytes.data() + blobsOffset, _blobs.data(), _blobs.size());
+
+			std::ofstream file(absolutePath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) return false;
+			file.write((const char*)fileBytes.data(), fileBytes.size());
+			return file.good();
+		}
+
+		static const Header& GetHeader(const MappedFile& file) {
+			return *(const Header*)file._pData;
+		}
+
+		template<typename T>
+		static const T* Get(const MappedFile& file, uint64_t offset) {
+			return (const T*)(file._pData + offset);
+		}
+
+		static std::string GetString(const MappedFile& file, uint32_t offset) {
+			if (offset == _noString) return "";
+			return std::string(Get<char>(file, GetHeader(file)._stringsOffset + offset));
+		}
+
+		/**
+		 * @brief Checks that the file is a cooked scene of the current version, and that every table and blob it references lies within the file.
+		 */
+		static bool IsValid(const MappedFile& file) {
+			if (file._sizeBytes < sizeof(Header)) return false;
+			auto& header = GetHeader(file);
+			if (header._magic != _magic || header._version != _version) return false;
+
+			auto fits = [&file](uint64_t offset, uint64_t sizeBytes) { return offset <= file._sizeBytes && sizeBytes <= file._sizeBytes - offset; };
+			if (!fits(header._nodesOffset, (uint64_t)header._nodeCount * sizeof(NodeRecord)) ||
+				!fits(header._meshesOffset, (uint64_t)header._meshCount * sizeof(MeshRecord)) ||
+				!fits(header._primitivesOffset, (uint64_t)header._primitiveCount * sizeof(PrimitiveRecord)) ||
+				!fits(header._meshletsOffset, (uint64_t)header._meshletCount * sizeof(MeshletRecord)) ||
+				!fits(header._materialsOffset, (uint64_t)header._materialCount * sizeof(MaterialRecord)) ||
+				!fits(header._texturesOffset, (uint64_t)header._textureCount * sizeof(TextureRecord)) ||
+				!fits(header._stringsOffset, header._stringsSizeBytes) ||
+				(header._stringsSizeBytes > 0 && file._pData[header._stringsOffset + header._stringsSizeBytes - 1] != '\0')) return false;
+
+			auto meshes = Get<MeshRecord>(file, header._meshesOffset);
+			auto primitives = Get<PrimitiveRecord>(file, header._primitivesOffset);
+			auto meshlets = Get<MeshletRecord>(file, header._meshletsOffset);
+			for (uint32_t i = 0; i < header._meshCount; ++i) {
+				auto& mesh = meshes[i];
+				if (!fits(mesh._verticesOffset, (uint64_t)mesh._vertexCount * sizeof(Vertex)) ||
+					!fits(mesh._indicesOffset, (uint64_t)mesh._indexCount * sizeof(unsigned int)) ||
+					(uint64_t)mesh._firstPrimitive + mesh._primitiveCount > header._primitiveCount) return false;
+
+				for (uint32_t j = mesh._firstPrimitive; j < mesh._firstPrimitive + mesh._primitiveCount; ++j) {
+					auto& primitive = primitives[j];
+					if ((uint64_t)primitive._firstIndex + primitive._indexCount > mesh._indexCount ||
+						(uint64_t)primitive._vertexOffset + primitive._vertexCount > mesh._vertexCount ||
+						primitive._materialIndex >= (int32_t)header._materialCount) return false;
+
+					if (primitive._lodCount < 1 || primitive._lodCount > _maxLodCount) return false;
+					for (uint32_t k = 0; k < primitive._lodCount; ++k) {
+						if ((uint64_t)primitive._lods[k]._firstIndex + primitive._lods[k]._indexCount > primitive._indexCount ||
+							(uint64_t)primitive._lods[k]._firstMeshlet + primitive._lods[k]._meshletCount > primitive._meshletCount) return false;
+					}
 
-			if (input.IsKeyHeldDown(GLFW_KEY_D)) {
-				_localTransform.Translate(_localTransform.Right() * 0.05f * (float)time._deltaTime);
+					if ((uint64_t)primitive._firstMeshlet + primitive._meshletCount > header._meshletCount) return false;
+					for (uint32_t k = primitive._firstMeshlet; k < primitive._firstMeshlet + primitive._meshletCount; ++k) {
+						if ((uint64_t)meshlets[k]._firstIndex + meshlets[k]._indexCount > primitive._indexCount) return false;
+					}
+				}
 			}
 
-			if (input.IsKeyHeldDown(GLFW_KEY_SPACE)) {
-				_localTransform.Translate(_localTransform.Up() * 0.05f * (float)time._deltaTime);
+			auto textures = Get<TextureRecord>(file, header._texturesOffset);
+			for (uint32_t i = 0; i < header._textureCount; ++i) {
+				if (!fits(textures[i]._dataOffset, textures[i]._dataSizeBytes)) return false;
 			}
 
-			if (input.IsKeyHeldDown(GLFW_KEY_LEFT_CONTROL)) {
-				_localTransform.Translate(-_localTransform.Up() * 0.05f * (float)time._deltaTime);
+			auto materials = Get<MaterialRecord>(file, header._materialsOffset);
+			for (uint32_t i = 0; i < header._materialCount; ++i) {
+				for (auto textureIndex : materials[i]._textureIndices) {
+					if (textureIndex < -1 || textureIndex >= (int32_t)header._textureCount) return false;
+				}
 			}
 
-			float _deltaYaw = (_yaw - _lastYaw);
-			float _deltaPitch = (_pitch - _lastPitch);
-			float _deltaRoll = (_roll - _lastRoll);
-
-			_lastYaw = _yaw;
-			_lastPitch = _pitch;
-			_lastRoll = _roll;
-
-			// First apply roll rotation.
-			_localTransform.Rotate(_localTransform.Forward(), _deltaRoll);
-
-			// Transform the up vector according to delta roll but not delta pitch, so the
-			// up vector is not affected by looking up and down, but it is by rolling the camera
-			// left and right.
-			auto axis = _localTransform.Forward(); // This gets the pitch-independent forward vector.
-			auto angleRadians = glm::radians(_deltaRoll);
-			auto cosine = cos(angleRadians / 2.0f);
-			auto sine = sin(angleRadians / 2.0f);
-			_up = glm::quat(cosine, axis.x * sine, axis.y * sine, axis.z * sine) * _up;
-
-			// Then apply yaw rotation.
-			_localTransform.Rotate(_up, _deltaYaw);
-
-			// Then pitch.
-			_localTransform.Rotate(_localTransform.Right(), _deltaPitch);
-
-			// Vulkan's coordinate system is: X points to the right, Y points down, Z points into the screen.
-			// Vulkan's viewport coordinate system is right handed and we are doing all our calculations assuming 
-			// +Z is forward, +Y is up and +X is right, so using a left-handed coordinate system.
+			// Parents must come before their children.
+			auto nodes = Get<NodeRecord>(file, header._nodesOffset);
+			for (uint32_t i = 0; i < header._nodeCount; ++i) {
+				if (nodes[i]._parentIndex >= (int32_t)i || nodes[i]._meshIndex >= (int32_t)header._meshCount) return false;
+			}
+			return true;
+		}
 
-			// We use the inverse of the camera transformation matrix because this matrix will be applied to each vertex of each object in the scene in the vertex shader.
-			// There is no such thing as a camera, because in the end we use the position of the vertices to draw stuff on screen. We can only modify the position of the
-			// vertices as if they were viewed from the camera, because in the end the physical position of the vertex ends up in the vertex shader, which then calculates
-			// its position on 2D screen using the projection matrix.
-			// Suppose that our vertex V is at (0,10,0) (so above your head if you are looking down the z axis from the origin)
-			// Also suppose that our camera is at (0,0,-10). This means that the camera is behind us by 10 units and can likely see the object
-			// somewhat in the upper area of its screen. If we want to see vertex V as if we viewed it from the camera, we would have to move
-			// vertex V 10 units forward from its current position. If instead of moving the camera BACK 10 units we move vertex V FORWARD 10 units, 
-			// we get the exact same effect as if we actually had a camera and moved it backwards.
-			_view._matrix = glm::inverse(_localTransform._matrix);
+	private:
 
-			float _deltaScrollY = ((float)input._scrollY - _lastScrollY);
-			_horizontalFov -= _deltaScrollY;
-			_lastScrollY = (float)input._scrollY;
+		std::vector<char> _strings;
+		std::vector<unsigned char> _blobs;
 
-			UpdateShaderResources();
+		static size_t AlignUp(size_t offset) {
+			return (offset + 15) & ~(size_t)15;
 		}
 	};
 
 	/**
-	 * @brief All the high-level information needed by the engine to perform user-related tasks such as managing cameras and scenes.
+	 * @brief Loads scenes. glTF files are first cooked into SceneFile's format in the asset cache, and scenes are always created from the cooked file,
+	 * so that glTF parsing, image decoding and vertex conversion only happen when the source file changes.
 	 */
-	struct EngineContext {
-		Scene _scene;
-		Camera _mainCamera;
-		Time& _time = Time::Instance();
-		KeyboardMouse& _input = KeyboardMouse::Instance();
-		GlobalSettings& _globalSettings = Engine::GlobalSettings::Instance();
-	};
-
-	void RigidBody::PhysicsUpdate(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
-		float deltaTimeSeconds = (float)eCtx._time._physicsDeltaTime * 0.001f;
-		auto speed = glm::length(_velocity);
-		auto angularSpeed = glm::length(_angularVelocity);
-		if (IsRotationLocked() && IsTranslationLocked()) return;
-		if (_isColliding && speed < 0.05f) return;
-		if (_isAffectedByGravity) AddForce(gGravity, deltaTimeSeconds, true);
+	class SceneLoader {
+	public:
 
-		// Approximate air resistance/rotational friction.
-		auto airFrictionCoefficient = 0.09f;
-		auto frictionMultiplier = -airFrictionCoefficient / powf(_mass, 2.0f);
-		AddForce(_velocity * frictionMultiplier, deltaTimeSeconds);
-		AddTorque(_angularVelocity * frictionMultiplier, deltaTimeSeconds);
-		auto wscom = GetCenterOfMass(true);
+		/**
+		 * @brief Primitives with fewer faces than this are not simplified any further.
+		 */
+		static constexpr size_t _minLodFaceCount = 32;
 
-		// Clamp angular velocity
-		if (angularSpeed > _maxAngularSpeed) _angularVelocity *= _maxAngularSpeed / angularSpeed;
+		/**
+		 * @brief Creates a GPU image for a texture of a cooked scene file. The texel data is not copied: the image points into the mapped file and is uploaded from there.
+		 */
+		static Image CreateTextureImage(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, const SceneFile::TextureRecord& texture, const unsigned char* pData) {
+			ResourceTracker::Scope resourceScope(ResourceTracker::Category::Texture);
+			Image image;
 
-		// Resolve collisions.
-		do {
-			if (!_isCollidable) break;
+			auto& imageCreateInfo = image._createInfo;
+			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageCreateInfo.extent = { texture._width, texture._height, 1 };
+			imageCreateInfo.format = texture._format;
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageCreateInfo.arrayLayers = 1;
+			imageCreateInfo.mipLevels = 1;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			CheckResult(ResourceTracker::CreateImage(logicalDevice, &imageCreateInfo, nullptr, &image._image));
 
-			auto collisions = DetectCollisions(ctx, collisionCtx);
+			// Allocate memory on the GPU for the image.
+			VkMemoryRequirements reqs;
+			vkGetImageMemoryRequirements(logicalDevice, image._image, &reqs);
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = reqs.size;
+			allocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			CheckResult(ResourceTracker::AllocateMemory(logicalDevice, &allocInfo, nullptr, &image._gpuMemory));
+			CheckResult(vkBindImageMemory(logicalDevice, image._image, image._gpuMemory, 0));
 
-			// Detect continuous collision
-			bool isOverCollisionThreshold = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - _lastTimeCollided).count() > _continuousCollisionThresholdMilliseconds;
+			auto& imageViewCreateInfo = image._viewCreateInfo;
+			imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			imageViewCreateInfo.components = { {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY} };
+			imageViewCreateInfo.format = texture._format;
+			imageViewCreateInfo.image = image._image;
+			imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+			imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+			imageViewCreateInfo.subresourceRange.layerCount = 1;
+			imageViewCreateInfo.subresourceRange.levelCount = 1;
+			CheckResult(vkCreateImageView(logicalDevice, &imageViewCreateInfo, nullptr, &image._view));
 
-			if (collisions.size() > 0) {
-				if (isOverCollisionThreshold) _isColliding = true;
-				_lastTimeCollided = std::chrono::high_resolution_clock::now();
-			}
-			else if (isOverCollisionThreshold) { _isColliding = false; break; }
+			auto& samplerCreateInfo = image._samplerCreateInfo;
+			samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+			samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+			samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+			samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+			vkCreateSampler(logicalDevice, &samplerCreateInfo, nullptr, &image._sampler);
 
-			for (int i = 0; i < collisions.size(); ++i) {
-				auto physicsDeltaTime = (float)eCtx._time._physicsDeltaTime;
-				collisions[i].CalculateAverages();
-				glm::vec3 averageCollisionPosition = glm::vec3(collisions[i]._averagePosition);
-				glm::vec3 averageCollisionNormal = glm::vec3(collisions[i]._averageNormal);
+			image._pData = (void*)pData;
+			image._sizeBytes = (size_t)texture._dataSizeBytes;
+			return image;
+		}
 
-				auto velocityAtPosition = GetVelocityAtPosition(averageCollisionPosition);
-				auto velocityLength = glm::length(velocityAtPosition);
-				auto velocityDirection = velocityAtPosition; glm::normalize(velocityDirection);
+		static unsigned char EncodeUnorm8(double value) {
+			return (unsigned char)std::lround(std::clamp(value, 0.0, 1.0) * 255.0);
+		}
 
-				// If the object is moving slower than the collidee, don't do anything.
-				if (velocityLength < glm::length(collisions[i]._collidee->GetVelocityAtPosition(averageCollisionPosition))) continue;
+		static unsigned char EncodeSrgb8(double value) {
+			value = std::clamp(value, 0.0, 1.0);
+			return EncodeUnorm8(value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055);
+		}
 
-				CollisionContext collisionCtx = collisions[i];
-				// Correct the body's position by moving the object backwards along the collision normal until there are no more collisions, to reduce object penetration
-				// and make the collision detection seem more accurate.
-				_pGameObject->_localTransform.Translate(averageCollisionNormal * 0.01f);
+		static double DecodeSrgb8(unsigned char value) {
+			auto encoded = value / 255.0;
+			return encoded <= 0.04045 ? encoded / 12.92 : std::pow((encoded + 0.055) / 1.055, 2.4);
+		}
 
-				auto f = averageCollisionNormal * 0.05f;
-				auto velBefore = glm::dot(velocityAtPosition, averageCollisionNormal);
-				AddForceAtPosition(f, averageCollisionPosition, 1.0f, true, true, true);
-				auto velAfter = glm::dot(GetVelocityAtPosition(averageCollisionPosition), averageCollisionNormal);
-				auto deltaVel = velBefore - velAfter;
-				auto newf = f * (velAfter / deltaVel);
-				AddForceAtPosition(newf, averageCollisionPosition, 1.0f, true, true, true);
+		/**
+		 * @brief Returns the image a glTF texture refers to, or nullptr if textureIndex is -1 or the image is not made of 8 bit components.
+		 */
+		static const tinygltf::Image* GetTextureImage(tinygltf::Model& gltfScene, int textureIndex) {
+			if (textureIndex < 0 || textureIndex >= gltfScene.textures.size()) return nullptr;
+			auto imageIndex = gltfScene.textures[textureIndex].source;
+			if (imageIndex < 0 || imageIndex >= gltfScene.images.size()) return nullptr;
+			auto& image = gltfScene.images[imageIndex];
+			if (image.bits != 8 || image.component < 1 || image.component > 4 || image.image.size() != (size_t)image.width * image.height * image.component) return nullptr;
+			return &image;
+		}
 
-				velocityAtPosition = GetVelocityAtPosition(averageCollisionPosition);
+		/**
+		 * @brief Returns the texels of an image as RGBA8. Grayscale images are spread to the color channels and missing alpha channels are opaque.
+		 */
+		static std::vector<unsigned char> GetRgba8(const tinygltf::Image& image) {
+			auto texelCount = (size_t)image.width * image.height;
+			if (image.component == 4) return image.image;
 
-				auto frictionForceDirection = glm::cross(glm::cross(velocityAtPosition, averageCollisionNormal), averageCollisionNormal);
-				if (!Helpers::IsVectorZero(frictionForceDirection)) frictionForceDirection = glm::normalize(frictionForceDirection);
+			std::vector<unsigned char> texels(texelCount * 4);
+			for (size_t i = 0; i < texelCount; ++i) {
+				auto pSource = &image.image[i * image.component];
+				auto pTexel = &texels[i * 4];
+				pTexel[0] = pSource[0];
+				pTexel[1] = image.component >= 3 ? pSource[1] : pSource[0];
+				pTexel[2] = image.component >= 3 ? pSource[2] : pSource[0];
+				pTexel[3] = image.component == 2 ? pSource[1] : 255;
+			}
+			return texels;
+		}
 
-				auto frictionComponent = !Helpers::IsVectorZero(frictionForceDirection)
-					? frictionForceDirection * (glm::dot(velocityAtPosition, frictionForceDirection) * _mass * _friction) * deltaTimeSeconds
-					: glm::vec3(0.0f, 0.0f, 0.0f);
-				AddForceAtPosition(-frictionComponent * 4.0f, averageCollisionPosition, 1.0f);
+		/**
+		 * @brief Multiplies sRGB encoded RGBA8 texels by a linear factor, as glTF applies base color and emissive factors.
+		 */
+		static void ScaleColors(std::vector<unsigned char>& texels, const double factor[4]) {
+			if (factor[0] == 1.0 && factor[1] == 1.0 && factor[2] == 1.0 && factor[3] == 1.0) return;
+			for (size_t i = 0; i < texels.size(); i += 4) {
+				for (int c = 0; c < 3; ++c) texels[i + c] = EncodeSrgb8(DecodeSrgb8(texels[i + c]) * factor[c]);
+				texels[i + 3] = EncodeUnorm8(texels[i + 3] / 255.0 * factor[3]);
+			}
+		}
 
-				collisions[i]._collidee->AddForceAtPosition(-f, averageCollisionPosition, 1.0f);
+		/**
+		 * @brief Packs occlusion in R, roughness in G and metalness in B, with the factors of the material baked in. glTF already stores roughness and metalness in the
+		 * G and B channels of the metallic-roughness map, so only occlusion, which may come from another image of another size, is resampled to it.
+		 */
+		static std::vector<unsigned char> PackOcclusionRoughnessMetalness(const tinygltf::Image* pOcclusion, double occlusionStrength, const tinygltf::Image* pMetallicRoughness,
+			double roughnessFactor, double metallicFactor, uint32_t& outWidth, uint32_t& outHeight) {
+			auto pSizeSource = pMetallicRoughness != nullptr ? pMetallicRoughness : pOcclusion;
+			outWidth = pSizeSource != nullptr ? (uint32_t)pSizeSource->width : 1;
+			outHeight = pSizeSource != nullptr ? (uint32_t)pSizeSource->height : 1;
 
+			auto occlusionTexels = pOcclusion != nullptr ? GetRgba8(*pOcclusion) : std::vector<unsigned char>();
+			auto metallicRoughnessTexels = pMetallicRoughness != nullptr ? GetRgba8(*pMetallicRoughness) : std::vector<unsigned char>();
+			auto sample = [outWidth, outHeight](const tinygltf::Image& image, const std::vector<unsigned char>& texels, uint32_t x, uint32_t y, int channel) {
+				auto sourceX = (size_t)x * image.width / outWidth;
+				auto sourceY = (size_t)y * image.height / outHeight;
+				return texels[(sourceY * image.width + sourceX) * 4 + channel] / 255.0;
+			};
 
-				// Detect twitching (fast angular velocity oscillations when an object is almost at its resting position)
-				if (glm::dot(_lastAngularVelocity, _angularVelocity) < 0.0f && _isColliding) {
-					auto isOverTwitchingThreshold = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - _lastTimeTwitched).count() > _twitchingDetectionThresholdMilliseconds;
-					_lastTimeTwitched = std::chrono::high_resolution_clock::now();
-					if (isOverTwitchingThreshold) { _twitchCount = 0; continue; }
-					++_twitchCount;
-					if (_twitchCount < 3) continue;
-					_velocity *= 0.0f;
-					_angularVelocity *= 0.0f;
-					return;
+			std::vector<unsigned char> texels((size_t)outWidth * outHeight * 4);
+			for (uint32_t y = 0; y < outHeight; ++y) {
+				for (uint32_t x = 0; x < outWidth; ++x) {
+					auto pTexel = &texels[((size_t)y * outWidth + x) * 4];
+					auto occlusion = pOcclusion != nullptr ? 1.0 + occlusionStrength * (sample(*pOcclusion, occlusionTexels, x, y, 0) - 1.0) : 1.0;
+					auto roughness = roughnessFactor * (pMetallicRoughness != nullptr ? sample(*pMetallicRoughness, metallicRoughnessTexels, x, y, 1) : 1.0);
+					auto metalness = metallicFactor * (pMetallicRoughness != nullptr ? sample(*pMetallicRoughness, metallicRoughnessTexels, x, y, 2) : 1.0);
+					pTexel[0] = EncodeUnorm8(occlusion);
+					pTexel[1] = EncodeUnorm8(roughness);
+					pTexel[2] = EncodeUnorm8(metalness);
+					pTexel[3] = 255;
 				}
 			}
-		} while (false);
-
-		_lastAngularVelocity = _angularVelocity;
+			return texels;
+		}
 
-		_pGameObject->_localTransform.RotateAroundPosition(wscom, glm::normalize(_angularVelocity), glm::length(_angularVelocity) * deltaTimeSeconds);
-		_pGameObject->_localTransform.Translate(_velocity * deltaTimeSeconds);
-	}
+		/**
+		 * @brief Adds a texture to the scene file and returns its index. Textures with the same size, format and texels are only stored once.
+		 */
+		static int32_t AddTexture(SceneFile& sceneFile, std::map<uint64_t, int32_t>& textureIndicesByHash, uint32_t width, uint32_t height, VkFormat format, const std::vector<unsigned char>& texels) {
+			SceneFile::TextureRecord texture{};
+			texture._width = width;
+			texture._height = height;
+			texture._format = format;
+			texture._contentHash = Helpers::Hash64(texels.data(), texels.size(), Helpers::Hash64(&format, sizeof(format), ((uint64_t)width << 32) | height));
 
-	bool RigidBody::IsRotationLocked() { return _lockRotationX && _lockRotationY && _lockRotationZ; }
+			auto sameContent = textureIndicesByHash.find(texture._contentHash);
+			if (sameContent != textureIndicesByHash.end()) return sameContent->second;
 
-	bool RigidBody::IsTranslationLocked() { return _lockTranslationX && _lockTranslationY && _lockTranslationZ; }
+			texture._dataOffset = sceneFile.AddBlob(texels.data(), texels.size());
+			texture._dataSizeBytes = texels.size();
+			textureIndicesByHash.emplace(texture._contentHash, (int32_t)sceneFile._textures.size());
+			sceneFile._textures.push_back(texture);
+			return (int32_t)sceneFile._textures.size() - 1;
+		}
 
-	void RigidBody::LockRotation() { _lockRotationX = true; _lockRotationY = true; _lockRotationZ = true; }
+		/**
+		 * @brief Cooks every material of the glTF scene, in order, along with the textures they use. Albedo and occlusion-roughness-metalness maps are always cooked,
+		 * from the factors of the material when it has no texture for them, while normal and emissive maps are only cooked when the material has them.
+		 */
+		static void CookMaterials(tinygltf::Model& gltfScene, SceneFile& sceneFile) {
+			// Maps using the same glTF image share its texture, and so do maps using different glTF images with the same content.
+			std::map<std::pair<const tinygltf::Image*, VkFormat>, int32_t> textureIndicesByImage;
+			std::map<uint64_t, int32_t> textureIndicesByHash;
+			auto addImage = [&](const tinygltf::Image& image, VkFormat format, const double factor[4]) {
+				auto key = std::make_pair(&image, format);
+				auto found = textureIndicesByImage.find(key);
+				if (found != textureIndicesByImage.end()) return found->second;
 
-	void RigidBody::LockTranslation() { _lockTranslationX = true; _lockTranslationY = true; _lockTranslationZ = true; }
+				auto texels = GetRgba8(image);
+				if (factor != nullptr) ScaleColors(texels, factor);
+				auto textureIndex = AddTexture(sceneFile, textureIndicesByHash, (uint32_t)image.width, (uint32_t)image.height, format, texels);
 
-	void RigidBody::UnlockRotation() { _lockRotationX = false; _lockRotationY = false; _lockRotationZ = false; }
+				// Scaled texels depend on the material, so only unscaled images can be shared by image.
+				if (factor == nullptr || (factor[0] == 1.0 && factor[1] == 1.0 && factor[2] == 1.0 && factor[3] == 1.0)) textureIndicesByImage.emplace(key, textureIndex);
+				return textureIndex;
+			};
+			auto addColor = [&](const double color[4], VkFormat format) {
+				std::vector<unsigned char> texels = { EncodeSrgb8(color[0]), EncodeSrgb8(color[1]), EncodeSrgb8(color[2]), EncodeUnorm8(color[3]) };
+				return AddTexture(sceneFile, textureIndicesByHash, 1, 1, format, texels);
+			};
 
-	void RigidBody::UnlockTranslation() { _lockTranslationX = false; _lockTranslationY = false; _lockTranslationZ = false; }
+			for (auto& gltfMaterial : gltfScene.materials) {
+				auto& pbr = gltfMaterial.pbrMetallicRoughness;
+				SceneFile::MaterialRecord material{};
+				material._nameOffset = sceneFile.AddString(gltfMaterial.name);
+				for (auto& textureIndex : material._textureIndices) textureIndex = -1;
+
+				// Meshes only keep TEXCOORD_0, maps that use another uv set are sampled with it anyway.
+				int texCoords[] = { pbr.baseColorTexture.texCoord, pbr.metallicRoughnessTexture.texCoord, gltfMaterial.occlusionTexture.texCoord,
+					gltfMaterial.normalTexture.texCoord, gltfMaterial.emissiveTexture.texCoord };
+				for (auto texCoord : texCoords) {
+					if (texCoord == 0) continue;
+					Logger::Warning("material {} samples a map with uv set {}, only uv set 0 is supported", gltfMaterial.name, texCoord);
+					break;
+				}
 
-	/**
-	 * @brief Represents a three-dimensional bounding box.
-	 */
-	class BoundingBox {
-	public:
+				double baseColorFactor[4] = { 1.0, 1.0, 1.0, 1.0 };
+				for (size_t c = 0; c < 4 && c < pbr.baseColorFactor.size(); ++c) baseColorFactor[c] = pbr.baseColorFactor[c];
+				auto pBaseColor = GetTextureImage(gltfScene, pbr.baseColorTexture.index);
+				material._textureIndices[Material::Albedo] = pBaseColor != nullptr ?
+					addImage(*pBaseColor, Material::GetFormat(Material::Albedo), baseColorFactor) :
+					addColor(baseColorFactor, Material::GetFormat(Material::Albedo));
+
+				uint32_t width, height;
+				auto texels = PackOcclusionRoughnessMetalness(GetTextureImage(gltfScene, gltfMaterial.occlusionTexture.index), gltfMaterial.occlusionTexture.strength,
+					GetTextureImage(gltfScene, pbr.metallicRoughnessTexture.index), pbr.roughnessFactor, pbr.metallicFactor, width, height);
+				material._textureIndices[Material::OcclusionRoughnessMetalness] = AddTexture(sceneFile, textureIndicesByHash, width, height,
+					Material::GetFormat(Material::OcclusionRoughnessMetalness), texels);
+
+				auto pNormal = GetTextureImage(gltfScene, gltfMaterial.normalTexture.index);
+				if (pNormal != nullptr) material._textureIndices[Material::Normal] = addImage(*pNormal, Material::GetFormat(Material::Normal), nullptr);
+
+				double emissiveFactor[4] = { 0.0, 0.0, 0.0, 1.0 };
+				for (size_t c = 0; c < 3 && c < gltfMaterial.emissiveFactor.size(); ++c) emissiveFactor[c] = gltfMaterial.emissiveFactor[c];
+				auto pEmissive = GetTextureImage(gltfScene, gltfMaterial.emissiveTexture.index);
+				if (pEmissive != nullptr) material._textureIndices[Material::Emissive] = addImage(*pEmissive, Material::GetFormat(Material::Emissive), emissiveFactor);
+				else if (emissiveFactor[0] > 0.0 || emissiveFactor[1] > 0.0 || emissiveFactor[2] > 0.0) material._textureIndices[Material::Emissive] = addColor(emissiveFactor, Material::GetFormat(Material::Emissive));
+
+				sceneFile._materials.push_back(material);
+			}
+		}
 
 		/**
-		 * @brief Low bound, or more accurately, the position whose components are all the lowest number calculated from a collection of positions.
+		 * @brief Converts count elements of componentCount components of type T, laid out stride bytes apart, to floats.
+		 * Normalized integers are mapped to [0, 1] or [-1, 1] as the glTF specification requires, and other integers (as allowed by KHR_mesh_quantization) are converted as they are.
 		 */
-		glm::vec3 _min;
+		template<typename T>
+		static void ConvertComponents(const unsigned char* pSource, size_t count, size_t stride, int componentCount, bool isNormalized, float* pOut) {
+			const float scale = isNormalized ? 1.0f / (float)std::numeric_limits<T>::max() : 1.0f;
+			const float lowest = isNormalized ? -1.0f : -FLT_MAX;
+			for (size_t i = 0; i < count; ++i, pSource += stride, pOut += componentCount) {
+				T components[4];
+				memcpy(components, pSource, sizeof(T) * componentCount);
+				for (int c = 0; c < componentCount; ++c) pOut[c] = std::max((float)components[c] * scale, lowest);
+			}
+		}
 
 		/**
-		 * @brief High bound, or more accurately, the position whose components are all the highest number calculated from a collection of positions.
+		 * @brief Returns the sizeBytes bytes at byteOffset in the buffer view at viewIndex, or nullptr if the view or its buffer does not exist, or if
+		 * the range does not fit in the view or the view does not fit in its buffer.
 		 */
-		glm::vec3 _max;
-
-		glm::vec3 GetCenter() {
-			return glm::vec3((_min.x + _max.x) * 0.5f, (_min.y + _max.y) * 0.5f, (_min.z + _max.z) * 0.5f);
+		static const unsigned char* GetBufferViewData(tinygltf::Model& gltfScene, int viewIndex, size_t byteOffset, size_t sizeBytes) {
+			if (viewIndex < 0 || viewIndex >= gltfScene.bufferViews.size()) return nullptr;
+			auto& bufferView = gltfScene.bufferViews[viewIndex];
+			if (bufferView.buffer < 0 || bufferView.buffer >= gltfScene.buffers.size()) return nullptr;
+			auto& buffer = gltfScene.buffers[bufferView.buffer];
+			if (bufferView.byteOffset + bufferView.byteLength > buffer.data.size() || byteOffset + sizeBytes > bufferView.byteLength) return nullptr;
+			return buffer.data.data() + bufferView.byteOffset + byteOffset;
 		}
 
-		static BoundingBox Create(const Mesh& mesh) {
-			auto& vertices = mesh._vertices._vertexData;
-			BoundingBox boundingBox;
+		/**
+		 * @brief Reads a glTF accessor of componentCount components per element as floats, honouring the byte offsets of the accessor and of its buffer view,
+		 * the byte stride, the component type, normalization and sparse substitution. Tightly packed float data is copied in one go.
+		 */
+		static bool ReadAccessor(tinygltf::Model& gltfScene, int accessorIndex, int componentCount, std::vector<float>& outValues) {
+			if (accessorIndex < 0 || accessorIndex >= gltfScene.accessors.size()) return false;
+			auto& accessor = gltfScene.accessors[accessorIndex];
+			if (tinygltf::GetNumComponentsInType(accessor.type) != componentCount) return false;
 
-			if (vertices.size() <= 0) {
-				return boundingBox;
+			// An accessor without a buffer view is all zeros, unless sparse values replace some of them.
+			outValues.assign(accessor.count * componentCount, 0.0f);
+			auto componentSizeBytes = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+			if (componentSizeBytes <= 0) return false;
+			auto elementSizeBytes = (size_t)componentSizeBytes * componentCount;
+			if (accessor.bufferView >= 0) {
+				if (accessor.bufferView >= gltfScene.bufferViews.size()) return false;
+				auto stride = accessor.ByteStride(gltfScene.bufferViews[accessor.bufferView]);
+				if (stride <= 0) return false;
+				auto pSource = GetBufferViewData(gltfScene, accessor.bufferView, accessor.byteOffset, accessor.count > 0 ? (accessor.count - 1) * stride + elementSizeBytes : 0);
+				if (pSource == nullptr) return false;
+				if (!ConvertAccessorData(pSource, accessor.count, stride, accessor.componentType, componentCount, accessor.normalized, outValues.data())) return false;
 			}
 
-			float minimumX = vertices[0]._position.x;
-			float minimumY = vertices[0]._position.y;
-			float minimumZ = vertices[0]._position.z;
+			if (accessor.sparse.isSparse) {
+				auto count = (size_t)accessor.sparse.count;
+				auto indexSizeBytes = tinygltf::GetComponentSizeInBytes(accessor.sparse.indices.componentType);
+				if (accessor.sparse.count < 0 || indexSizeBytes <= 0) return false;
 
-			float maximumX = minimumX;
-			float maximumY = minimumY;
-			float maximumZ = minimumZ;
+				std::vector<unsigned int> indices;
+				auto pIndices = GetBufferViewData(gltfScene, accessor.sparse.indices.bufferView, accessor.sparse.indices.byteOffset, count * indexSizeBytes);
+				if (pIndices == nullptr) return false;
+				if (!ConvertIndices(pIndices, count, indexSizeBytes, accessor.sparse.indices.componentType, indices)) return false;
 
-			for (int i = 0; i < vertices.size(); ++i) {
-				minimumX = std::min(minimumX, vertices[i]._position.x);
-				minimumY = std::min(minimumY, vertices[i]._position.y);
-				minimumZ = std::min(minimumZ, vertices[i]._position.z);
+				std::vector<float> values(count * componentCount);
+				auto pValues = GetBufferViewData(gltfScene, accessor.sparse.values.bufferView, accessor.sparse.values.byteOffset, count * elementSizeBytes);
+				if (pValues == nullptr) return false;
+				if (!ConvertAccessorData(pValues, count, elementSizeBytes, accessor.componentType, componentCount, accessor.normalized, values.data())) return false;
 
-				maximumX = std::max(maximumX, vertices[i]._position.x);
-				maximumY = std::max(maximumY, vertices[i]._position.y);
-				maximumZ = std::max(maximumZ, vertices[i]._position.z);
+				for (size_t i = 0; i < count; ++i) {
+					if (indices[i] >= accessor.count) return false;
+					memcpy(outValues.data() + indices[i] * componentCount, values.data() + i * componentCount, sizeof(float) * componentCount);
+				}
 			}
+			return true;
+		}
 
-			boundingBox._min = glm::vec3(minimumX, minimumY, minimumZ);
-			boundingBox._max = glm::vec3(maximumX, maximumY, maximumZ);
-
-			return boundingBox;
+		static bool ConvertAccessorData(const unsigned char* pSource, size_t count, size_t stride, int componentType, int componentCount, bool isNormalized, float* pOut) {
+			switch (componentType) {
+			case TINYGLTF_COMPONENT_TYPE_FLOAT:
+				if (stride == sizeof(float) * componentCount) memcpy(pOut, pSource, count * stride);
+				else ConvertComponents<float>(pSource, count, stride, componentCount, false, pOut);
+				return true;
+			case TINYGLTF_COMPONENT_TYPE_BYTE: ConvertComponents<int8_t>(pSource, count, stride, componentCount, isNormalized, pOut); return true;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: ConvertComponents<uint8_t>(pSource, count, stride, componentCount, isNormalized, pOut); return true;
+			case TINYGLTF_COMPONENT_TYPE_SHORT: ConvertComponents<int16_t>(pSource, count, stride, componentCount, isNormalized, pOut); return true;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: ConvertComponents<uint16_t>(pSource, count, stride, componentCount, isNormalized, pOut); return true;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: ConvertComponents<uint32_t>(pSource, count, stride, componentCount, isNormalized, pOut); return true;
+			default: return false;
+			}
 		}
-	};
 
-	class SceneLoader {
-	public:
-		static std::vector<Material> LoadMaterials(VkDevice& logicalDevice, VkPhysicalDevice& physicalDevice, tinygltf::Model& gltfScene) {
-			std::vector<Material> outMaterials;
+		/**
+		 * @brief Widens count 8, 16 or 32 bit unsigned indices, laid out stride bytes apart, to 32 bits.
+		 */
+		static bool ConvertIndices(const unsigned char* pSource, size_t count, size_t stride, int componentType, std::vector<unsigned int>& outIndices) {
+			outIndices.resize(count);
+			switch (componentType) {
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+				for (size_t i = 0; i < count; ++i) outIndices[i] = pSource[i * stride];
+				return true;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+				for (size_t i = 0; i < count; ++i) { uint16_t index; memcpy(&index, pSource + i * stride, sizeof(index)); outIndices[i] = index; }
+				return true;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+				if (stride == sizeof(unsigned int)) memcpy(outIndices.data(), pSource, count * stride);
+				else for (size_t i = 0; i < count; ++i) memcpy(&outIndices[i], pSource + i * stride, sizeof(unsigned int));
+				return true;
+			default: return false;
+			}
+		}
 
-			for (int i = 0; i < gltfScene.materials.size(); ++i) {
-				Material m;
-				auto& baseColorTextureIndex = gltfScene.materials[i].pbrMetallicRoughness.baseColorTexture.index;
-				m._name = gltfScene.materials[i].name;
-
-				if (baseColorTextureIndex >= 0) {
-					auto& baseColorImageIndex = gltfScene.textures[baseColorTextureIndex].source;
-					auto& baseColorImageData = gltfScene.images[baseColorImageIndex].image;
-					unsigned char* copiedImageData = new unsigned char[baseColorImageData.size()];
-					memcpy(copiedImageData, baseColorImageData.data(), baseColorImageData.size());
-					auto size = VkExtent2D{ (uint32_t)gltfScene.images[baseColorImageIndex].width, (uint32_t)gltfScene.images[baseColorImageIndex].height };
-
-					auto& imageCreateInfo = m._albedo._createInfo;
-					imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-					imageCreateInfo.extent = { (uint32_t)size.width, (uint32_t)size.height, 1 };
-					imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-					imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-					imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-					imageCreateInfo.arrayLayers = 1;
-					imageCreateInfo.mipLevels = 1;
-					imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-					imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-					imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-					CheckResult(vkCreateImage(logicalDevice, &imageCreateInfo, nullptr, &m._albedo._image));
-
-					// Allocate memory on the GPU for the image.
-					VkMemoryRequirements reqs;
-					vkGetImageMemoryRequirements(logicalDevice, m._albedo._image, &reqs);
-					VkMemoryAllocateInfo allocInfo{};
-					allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-					allocInfo.allocationSize = reqs.size;
-					allocInfo.memoryTypeIndex = PhysicalDevice::GetMemoryTypeIndex(physicalDevice, reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-					VkDeviceMemory mem;
-					CheckResult(vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &mem));
-					CheckResult(vkBindImageMemory(logicalDevice, m._albedo._image, mem, 0));
-
-					auto& imageViewCreateInfo = m._albedo._viewCreateInfo;
-					imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-					imageViewCreateInfo.components = { {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY}, {VK_COMPONENT_SWIZZLE_IDENTITY} };
-					imageViewCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-					imageViewCreateInfo.image = m._albedo._image;
-					imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-					imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-					imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-					imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-					imageViewCreateInfo.subresourceRange.layerCount = 1;
-					imageViewCreateInfo.subresourceRange.levelCount = 1;
-					CheckResult(vkCreateImageView(logicalDevice, &imageViewCreateInfo, nullptr, &m._albedo._view));
-
-					auto& samplerCreateInfo = m._albedo._samplerCreateInfo;
-					samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-					samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-					samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-					samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-					samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
-					samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
-					samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
-					vkCreateSampler(logicalDevice, &samplerCreateInfo, nullptr, &m._albedo._sampler);
-
-					m._albedo._pData = copiedImageData;
-					m._albedo._sizeBytes = baseColorImageData.size();
-
-					outMaterials.push_back(m);
-				}
+		/**
+		 * @brief Reads the face indices of a primitive as a triangle list. Primitives without indices get one index per vertex, and strips and fans are unrolled.
+		 */
+		static bool ReadFaceIndices(tinygltf::Model& gltfScene, tinygltf::Primitive& gltfPrimitive, size_t vertexCount, std::vector<unsigned int>& outFaceIndices) {
+			std::vector<unsigned int> indices;
+			if (gltfPrimitive.indices >= 0) {
+				if (gltfPrimitive.indices >= gltfScene.accessors.size()) return false;
+				auto& accessor = gltfScene.accessors[gltfPrimitive.indices];
+				auto indexSizeBytes = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+				if (accessor.bufferView < 0 || accessor.bufferView >= gltfScene.bufferViews.size() || indexSizeBytes <= 0) return false;
+				auto stride = accessor.ByteStride(gltfScene.bufferViews[accessor.bufferView]);
+				if (stride <= 0) return false;
+				auto pSource = GetBufferViewData(gltfScene, accessor.bufferView, accessor.byteOffset, accessor.count > 0 ? (accessor.count - 1) * stride + indexSizeBytes : 0);
+				if (pSource == nullptr) return false;
+				if (!ConvertIndices(pSource, accessor.count, stride, accessor.componentType, indices)) return false;
+			}
+			else {
+				indices.resize(vertexCount);
+				for (unsigned int i = 0; i < vertexCount; ++i) indices[i] = i;
 			}
 
-			return outMaterials;
-		}
-
-		static Mesh* ProcessMesh(tinygltf::Mesh& gltfMesh, tinygltf::Model& gltfScene, Scene& scene, Transform localTransform, VkContext& ctx) {
-			if (gltfMesh.primitives.size() < 1) return nullptr;
-
-			auto& gltfPrimitive = gltfMesh.primitives[0];
-			auto faceIndicesAccessorIndex = gltfPrimitive.indices;
-			auto vertexPositionsAccessorIndex = gltfPrimitive.attributes["POSITION"];
-			auto vertexNormalsAccessorIndex = gltfPrimitive.attributes["NORMAL"];
-			auto uvCoords0AccessorIndex = gltfPrimitive.attributes["TEXCOORD_0"];
-			//auto uvCoords1AccessorIndex = gltfPrimitive.attributes["TEXCOORD_1"];
-			//auto uvCoords2AccessorIndex = gltfPrimitive.attributes["TEXCOORD_2"];
-
-			auto faceIndicesAccessor = gltfScene.accessors[faceIndicesAccessorIndex];
-			auto positionsAccessor = gltfScene.accessors[vertexPositionsAccessorIndex];
-			auto normalsAccessor = gltfScene.accessors[vertexNormalsAccessorIndex];
-			auto uvCoords0Accessor = gltfScene.accessors[uvCoords0AccessorIndex];
-			//auto uvCoords1Accessor = gltfScene.accessors[uvCoords1AccessorIndex];
-			//auto uvCoords2Accessor = gltfScene.accessors[uvCoords2AccessorIndex];
-
-			// Load face indices.
-			auto faceIndicesCount = faceIndicesAccessor.count;
-			auto faceIndicesBufferIndex = gltfScene.bufferViews[faceIndicesAccessor.bufferView].buffer;
-			auto faceIndicesBufferOffset = gltfScene.bufferViews[faceIndicesAccessor.bufferView].byteOffset;
-			auto faceIndicesBufferStride = faceIndicesAccessor.ByteStride(gltfScene.bufferViews[faceIndicesAccessor.bufferView]);
-			auto faceIndicesBufferSizeBytes = faceIndicesCount * faceIndicesBufferStride;
-			std::vector<unsigned int> faceIndices(faceIndicesCount);
-			if (faceIndicesAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-				for (int i = 0; i < faceIndicesCount; ++i) {
-					unsigned short index = 0;
-					memcpy(&index, gltfScene.buffers[faceIndicesBufferIndex].data.data() + faceIndicesBufferOffset + i * faceIndicesBufferStride, faceIndicesBufferStride);
-					faceIndices[i] = index;
+			for (auto& index : indices) if (index >= vertexCount) return false;
+
+			switch (gltfPrimitive.mode) {
+			case TINYGLTF_MODE_TRIANGLES:
+				outFaceIndices = std::move(indices);
+				outFaceIndices.resize(outFaceIndices.size() - outFaceIndices.size() % 3);
+				return true;
+			case TINYGLTF_MODE_TRIANGLE_STRIP:
+				outFaceIndices.clear();
+				for (size_t i = 2; i < indices.size(); ++i) {
+					// Every other triangle of a strip has its first two vertices swapped to keep the winding consistent.
+					bool isOdd = (i % 2) == 1;
+					outFaceIndices.insert(outFaceIndices.end(), { indices[isOdd ? i - 1 : i - 2], indices[isOdd ? i - 2 : i - 1], indices[i] });
 				}
+				return true;
+			case TINYGLTF_MODE_TRIANGLE_FAN:
+				outFaceIndices.clear();
+				for (size_t i = 2; i < indices.size(); ++i) outFaceIndices.insert(outFaceIndices.end(), { indices[0], indices[i - 1], indices[i] });
+				return true;
+			default:
+				return false;
 			}
-			else if (faceIndicesAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-				memcpy(faceIndices.data(), gltfScene.buffers[faceIndicesBufferIndex].data.data() + faceIndicesBufferOffset, faceIndicesBufferSizeBytes);
-			}
-
-			// Load vertex Positions.
-			auto vertexPositionsCount = positionsAccessor.count;
-			auto vertexPositionsBufferIndex = gltfScene.bufferViews[positionsAccessor.bufferView].buffer;
-			auto vertexPositionsBufferOffset = gltfScene.bufferViews[positionsAccessor.bufferView].byteOffset;
-			auto vertexPositionsBufferStride = positionsAccessor.ByteStride(gltfScene.bufferViews[positionsAccessor.bufferView]);
-			auto vertexPositionsBufferSizeBytes = vertexPositionsCount * vertexPositionsBufferStride;
-			std::vector<glm::vec3> vertexPositions(vertexPositionsCount);
-			memcpy(vertexPositions.data(), gltfScene.buffers[vertexPositionsBufferIndex].data.data() + vertexPositionsBufferOffset, vertexPositionsBufferSizeBytes);
-
-			// Load vertex normals.
-			auto vertexNormalsCount = normalsAccessor.count;
-			auto vertexNormalsBufferIndex = gltfScene.bufferViews[normalsAccessor.bufferView].buffer;
-			auto vertexNormalsBufferOffset = gltfScene.bufferViews[normalsAccessor.bufferView].byteOffset;
-			auto vertexNormalsBufferStride = normalsAccessor.ByteStride(gltfScene.bufferViews[normalsAccessor.bufferView]);
-			auto vertexNormalsBufferSizeBytes = vertexNormalsCount * vertexNormalsBufferStride;
-			std::vector<glm::vec3> vertexNormals(vertexNormalsCount);
-			memcpy(vertexNormals.data(), gltfScene.buffers[vertexNormalsBufferIndex].data.data() + vertexNormalsBufferOffset, vertexNormalsBufferSizeBytes);
-
-			// Load UV coordinates for UV slot 0.
-			auto uvCoords0Count = uvCoords0Accessor.count;
-			auto uvCoords0BufferIndex = gltfScene.bufferViews[uvCoords0Accessor.bufferView].buffer;
-			auto uvCoords0BufferOffset = gltfScene.bufferViews[uvCoords0Accessor.bufferView].byteOffset;
-			auto uvCoords0BufferStride = uvCoords0Accessor.ByteStride(gltfScene.bufferViews[uvCoords0Accessor.bufferView]);
-			auto uvCoords0BufferSize = uvCoords0Count * uvCoords0BufferStride;
-			std::vector<glm::vec2> uvCoords0(uvCoords0Count);
-			memcpy(uvCoords0.data(), gltfScene.buffers[uvCoords0BufferIndex].data.data() + uvCoords0BufferOffset, uvCoords0BufferSize);
+		}
 
-			auto mesh = new Mesh();
+		/**
+		 * @brief Reads the vertices and face indices of a primitive, converting the vertices into the engine's coordinate system.
+		 * Primitives without normals get flat normals, as the glTF specification asks, and missing UV coordinates are left at zero.
+		 */
+		static bool ReadPrimitive(tinygltf::Model& gltfScene, tinygltf::Primitive& gltfPrimitive, std::vector<Vertex>& outVertices, std::vector<unsigned int>& outFaceIndices) {
+			auto findAttribute = [&gltfPrimitive](const std::string& name) { auto found = gltfPrimitive.attributes.find(name); return found != gltfPrimitive.attributes.end() ? found->second : -1; };
+			auto positionsAccessorIndex = findAttribute("POSITION");
+			auto normalsAccessorIndex = findAttribute("NORMAL");
+			auto uvCoords0AccessorIndex = findAttribute("TEXCOORD_0");
+
+			std::vector<float> positions;
+			if (!ReadAccessor(gltfScene, positionsAccessorIndex, 3, positions)) return false;
+			auto vertexCount = positions.size() / 3;
+
+			std::vector<float> normals;
+			auto hasNormals = normalsAccessorIndex >= 0 && ReadAccessor(gltfScene, normalsAccessorIndex, 3, normals) && normals.size() == positions.size();
 
-			bool found = false;
-			if (gltfPrimitive.material >= 0) {
-				for (int i = 0; i < scene._materials.size() && !found; ++i) {
-					if (scene._materials[i]._name == gltfScene.materials[gltfPrimitive.material].name) {
-						mesh->_materialIndex = i;
-						found = true;
+			std::vector<float> uvCoords0;
+			if (uvCoords0AccessorIndex < 0 || !ReadAccessor(gltfScene, uvCoords0AccessorIndex, 2, uvCoords0) || uvCoords0.size() != vertexCount * 2) uvCoords0.assign(vertexCount * 2, 0.0f);
+
+			if (!ReadFaceIndices(gltfScene, gltfPrimitive, vertexCount, outFaceIndices)) return false;
+
+			// Flat normals differ between the faces sharing a vertex, so vertices are split per face and only shared by corners with the same position,
+			// normal and uv coordinates. The normals are computed in glTF space, where counterclockwise faces are front faces, and converted below like read normals.
+			if (!hasNormals) {
+				std::vector<float> flatPositions, flatUvCoords0;
+				std::map<std::array<float, 8>, unsigned int> flatIndices;
+				normals.clear();
+				for (size_t f = 0; f < outFaceIndices.size(); f += 3) {
+					glm::vec3 corners[3];
+					for (size_t k = 0; k < 3; ++k) {
+						auto i = outFaceIndices[f + k];
+						corners[k] = glm::vec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+					}
+					auto normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+					auto length = glm::length(normal);
+					if (length > 0.0f) normal /= length;
+
+					for (size_t k = 0; k < 3; ++k) {
+						auto i = outFaceIndices[f + k];
+						std::array<float, 8> key = { corners[k].x, corners[k].y, corners[k].z, normal.x, normal.y, normal.z, uvCoords0[i * 2], uvCoords0[i * 2 + 1] };
+						auto found = flatIndices.try_emplace(key, (unsigned int)flatIndices.size());
+						if (found.second) {
+							flatPositions.insert(flatPositions.end(), key.begin(), key.begin() + 3);
+							normals.insert(normals.end(), key.begin() + 3, key.begin() + 6);
+							flatUvCoords0.insert(flatUvCoords0.end(), key.begin() + 6, key.end());
+						}
+						outFaceIndices[f + k] = found.first->second;
 					}
 				}
-				if (!found) {
-					mesh->_materialIndex = 0;
-				}
+				positions = std::move(flatPositions);
+				uvCoords0 = std::move(flatUvCoords0);
+				vertexCount = flatIndices.size();
 			}
 
-			// Gather vertices and face indices.
-			std::vector<Vertex> vertices;
-			vertices.resize(vertexPositions.size());
-			for (int i = 0; i < vertexPositions.size(); ++i) {
-				Vertex v;
+			outVertices.resize(vertexCount);
+			for (size_t i = 0; i < vertexCount; ++i) {
+				auto& v = outVertices[i];
 
 				// Transform all 3D space vectors into the engine's coordinate system (X Right, Y Up, Z forward).
-				/*auto position = GltfToEngine()._matrix * glm::vec4(vertexPositions[i], 1.0f);
-				auto normal = GltfToEngine()._matrix * glm::vec4(vertexNormals[i], 1.0f);;*/
+				v._position = glm::vec3(-positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+				v._normal = glm::vec3(-normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+				v._uvCoord = glm::vec2(uvCoords0[i * 2], uvCoords0[i * 2 + 1]);
+			}
+			return true;
+		}
 
-				vertexPositions[i].x = -vertexPositions[i].x;
-				vertexNormals[i].x = -vertexNormals[i].x;
+		/**
+		 * @brief Appends the face indices of every level of detail of a primitive to meshFaceIndices, starting with the full detail faces, and their meshlets
+		 * to meshlets, then fills the level of detail and meshlet ranges of the primitive. Each level aims at half the faces of the previous one; the chain
+		 * stops early when simplification cannot remove enough faces without moving the surface further than a tenth of the size of the primitive.
+		 */
+		static void CookLods(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& faceIndices, const BoundingBox& bounds, SceneFile::PrimitiveRecord& primitive,
+			std::vector<unsigned int>& meshFaceIndices, std::vector<SceneFile::MeshletRecord>& meshlets) {
+			auto firstIndex = meshFaceIndices.size();
+			primitive._firstMeshlet = (uint32_t)meshlets.size();
+			auto addMeshlets = [&](SceneFile::LodRecord& lod, const std::vector<unsigned int>& lodIndices) {
+				auto lodMeshlets = MeshOptimizer::BuildMeshlets(vertices, lodIndices.data(), lodIndices.size());
+				lod._firstMeshlet = (uint32_t)meshlets.size() - primitive._firstMeshlet;
+				lod._meshletCount = (uint32_t)lodMeshlets.size();
+				for (auto& m : lodMeshlets) meshlets.push_back(SceneFile::MeshletRecord{ m._center, m._radius, m._coneAxis, m._coneCutoff, lod._firstIndex + m._firstIndex, m._indexCount });
+			};
 
-				// Set the vertex attributes.
-				/*v._position = glm::vec3(position);
-				v._normal = glm::vec3(normal);*/
-				v._position = glm::vec3(localTransform._matrix * glm::vec4(vertexPositions[i], 1.0f));
-				v._normal = vertexNormals[i];
-				v._uvCoord = uvCoords0[i];
-				vertices[i] = v;
+			primitive._lodCount = 1;
+			primitive._lods[0] = SceneFile::LodRecord{ 0, (uint32_t)faceIndices.size(), 0.0f, 0, 0 };
+			meshFaceIndices.insert(meshFaceIndices.end(), faceIndices.begin(), faceIndices.end());
+			addMeshlets(primitive._lods[0], faceIndices);
+
+			auto maxError = glm::length(bounds._max - bounds._min) * 0.1f;
+			auto previousIndexCount = faceIndices.size();
+			while (primitive._lodCount < SceneFile::_maxLodCount && previousIndexCount / 3 >= _minLodFaceCount * 2) {
+				float error = 0.0f;
+				auto targetIndexCount = previousIndexCount / 6 * 3;
+				auto lodIndices = MeshOptimizer::Simplify(vertices, faceIndices, targetIndexCount, maxError, error);
+
+				// A level that is not much cheaper than the previous one is not worth its memory.
+				if (lodIndices.size() > previousIndexCount * 3 / 4) break;
+				MeshOptimizer::OptimizeVertexCache(lodIndices, vertices.size());
+
+				auto& lod = primitive._lods[primitive._lodCount++];
+				lod._firstIndex = (uint32_t)(meshFaceIndices.size() - firstIndex);
+				lod._indexCount = (uint32_t)lodIndices.size();
+				lod._error = error;
+				meshFaceIndices.insert(meshFaceIndices.end(), lodIndices.begin(), lodIndices.end());
+				addMeshlets(lod, lodIndices);
+				previousIndexCount = lodIndices.size();
 			}
+			primitive._meshletCount = (uint32_t)meshlets.size() - primitive._firstMeshlet;
+		}
+
+		/**
+		 * @brief Cooks every mesh of the glTF file, so that mesh records are indexed like the glTF meshes. Each primitive becomes a draw range in the shared
+		 * vertex and index blobs of its mesh; primitives that cannot be drawn as triangles, or whose data is malformed, are skipped with a warning.
+		 */
+		static void CookMeshes(tinygltf::Model& gltfScene, SceneFile& sceneFile) {
+			for (int i = 0; i < gltfScene.meshes.size(); ++i) {
+				auto& gltfMesh = gltfScene.meshes[i];
+				SceneFile::MeshRecord mesh{};
+				mesh._firstPrimitive = (uint32_t)sceneFile._primitives.size();
 
-			// Copy vertices to the GPU.
-			mesh->CreateVertexBuffer(ctx, vertices);
+				std::vector<Vertex> meshVertices;
+				std::vector<unsigned int> meshFaceIndices;
+				for (int j = 0; j < gltfMesh.primitives.size(); ++j) {
+					auto& gltfPrimitive = gltfMesh.primitives[j];
+					std::vector<Vertex> vertices;
+					std::vector<unsigned int> faceIndices;
+					if (!ReadPrimitive(gltfScene, gltfPrimitive, vertices, faceIndices) || faceIndices.size() == 0) {
+						Logger::Warning("skipping primitive {} of mesh {}: unsupported mode or malformed accessors", j, gltfMesh.name);
+						continue;
+					}
+					MeshOptimizer::Optimize(vertices, faceIndices);
 
-			// Copy face indices to the GPU.
-			mesh->CreateIndexBuffer(ctx, faceIndices);
+					SceneFile::PrimitiveRecord primitive{};
+					primitive._materialIndex = -1;
 
-			return mesh;
+					// Every glTF material is cooked in order, so material records share their indices. Primitives without a material use the default material.
+					if (gltfPrimitive.material >= 0 && gltfPrimitive.material < (int)sceneFile._materials.size()) primitive._materialIndex = gltfPrimitive.material;
+
+					BoundingBox bounds;
+					for (auto& vertex : vertices) {
+						bounds._min = glm::min(bounds._min, vertex._position);
+						bounds._max = glm::max(bounds._max, vertex._position);
+					}
+					primitive._boundsMin = bounds._min;
+					primitive._boundsMax = bounds._max;
+
+					primitive._firstIndex = (uint32_t)meshFaceIndices.size();
+					primitive._vertexOffset = (uint32_t)meshVertices.size();
+					primitive._vertexCount = (uint32_t)vertices.size();
+					meshVertices.insert(meshVertices.end(), vertices.begin(), vertices.end());
+					CookLods(vertices, faceIndices, bounds, primitive, meshFaceIndices, sceneFile._meshlets);
+					primitive._indexCount = (uint32_t)meshFaceIndices.size() - primitive._firstIndex;
+					sceneFile._primitives.push_back(primitive);
+				}
+
+				mesh._primitiveCount = (uint32_t)sceneFile._primitives.size() - mesh._firstPrimitive;
+				mesh._vertexCount = (uint32_t)meshVertices.size();
+				mesh._indexCount = (uint32_t)meshFaceIndices.size();
+				mesh._verticesOffset = sceneFile.AddBlob(meshVertices.data(), meshVertices.size() * sizeof(Vertex));
+				mesh._indicesOffset = sceneFile.AddBlob(meshFaceIndices.data(), meshFaceIndices.size() * sizeof(unsigned int));
+				sceneFile._meshes.push_back(mesh);
+			}
 		}
 
 		static Transform GetGltfNodeTransform(tinygltf::Node& gltfNode) {
@@ -5586,18 +10848,8 @@ namespace Engine {
 			std::string name;
 			Node* parent;
 			std::vector<Node*> children;
-			GameObject* pGameObject;
 		};
 
-		static GameObject* FindGameObject(Node* rootNode, std::string name) {
-			if (rootNode->pGameObject->_name == name) return rootNode->pGameObject;
-			for (int i = 0; i < rootNode->children.size(); ++i) {
-				auto childSearchResult = FindGameObject(rootNode->children[i], name);
-				if (childSearchResult) return childSearchResult;
-			}
-			return nullptr;
-		}
-
 		static bool GetBoolProperty(tinygltf::Node& node, const std::string& propertyName) {
 			auto p = node.extras.Get(propertyName);
 			if (p.IsBool()) return p.Get<bool>();
@@ -5610,73 +10862,50 @@ namespace Engine {
 			return 0.0;
 		}
 
-		static void ProcessGameConfig(Node* rootNode, Node* currentNode, tinygltf::Model& gltfScene) {
-			do {
-				if (currentNode->gltfSceneIndex < 0) break;
-				auto& gltfNode = gltfScene.nodes[currentNode->gltfSceneIndex];
-				if (gltfNode.extras.Keys().size() < 1) break;
-
-				auto collisionMeshProp = gltfNode.extras.Get("CollisionMeshName");
-				std::string collisionMeshName = "";
-				if (collisionMeshProp.IsString()) collisionMeshName = collisionMeshProp.Get<std::string>();
-				if (collisionMeshName == "") break;
-
-				auto gameObject = FindGameObject(rootNode, collisionMeshName);
-				if (!gameObject) break;
-				if (!gameObject->_pMesh) break;
-
-				/*if (gameObject->_name != currentNode->name) {
-					delete(gameObject->_pMesh);
-					gameObject->_pMesh = nullptr;
-				}*/
-				currentNode->pGameObject->_pBody = new RigidBody();
-				currentNode->pGameObject->_pBody->Initialize(currentNode->pGameObject);
+		/**
+		 * @brief Cooks the rigid body settings stored in the custom properties of the glTF node.
+		 */
+		static void CookGameConfig(tinygltf::Node& gltfNode, SceneFile& sceneFile, SceneFile::NodeRecord& outNode) {
+			outNode._collisionMeshNameOffset = SceneFile::_noString;
+			if (gltfNode.extras.Keys().size() < 1) return;
 
-				// Additional init
-				currentNode->pGameObject->_pBody->_friction = (float)GetNumberProperty(gltfNode, "Friction");
-				currentNode->pGameObject->_pBody->_mass = (float)GetNumberProperty(gltfNode, "Mass");
-				currentNode->pGameObject->_pBody->_isAffectedByGravity = GetBoolProperty(gltfNode, "EnableGravity");
-				currentNode->pGameObject->_pBody->_isCollidable = GetBoolProperty(gltfNode, "IsCollidable");
-				currentNode->pGameObject->_pBody->_lockRotationX = GetBoolProperty(gltfNode, "LockRotationX");
-				currentNode->pGameObject->_pBody->_lockRotationY = GetBoolProperty(gltfNode, "LockRotationY");
-				currentNode->pGameObject->_pBody->_lockRotationZ = GetBoolProperty(gltfNode, "LockRotationZ");
-				currentNode->pGameObject->_pBody->_lockTranslationX = GetBoolProperty(gltfNode, "LockTranslationX");
-				currentNode->pGameObject->_pBody->_lockTranslationY = GetBoolProperty(gltfNode, "LockTranslationY");
-				currentNode->pGameObject->_pBody->_lockTranslationZ = GetBoolProperty(gltfNode, "LockTranslationZ");
-			} while (false);
+			auto collisionMeshProp = gltfNode.extras.Get("CollisionMeshName");
+			std::string collisionMeshName = "";
+			if (collisionMeshProp.IsString()) collisionMeshName = collisionMeshProp.Get<std::string>();
+			if (collisionMeshName == "") return;
 
-			for (int i = 0; i < currentNode->children.size(); ++i) {
-				ProcessGameConfig(rootNode, currentNode->children[i], gltfScene);
-			}
+			outNode._collisionMeshNameOffset = sceneFile.AddString(collisionMeshName);
+			outNode._friction = (float)GetNumberProperty(gltfNode, "Friction");
+			outNode._mass = (float)GetNumberProperty(gltfNode, "Mass");
+			if (GetBoolProperty(gltfNode, "EnableGravity")) outNode._flags |= SceneFile::AffectedByGravity;
+			if (GetBoolProperty(gltfNode, "IsCollidable")) outNode._flags |= SceneFile::Collidable;
+			if (GetBoolProperty(gltfNode, "LockRotationX")) outNode._flags |= SceneFile::LockRotationX;
+			if (GetBoolProperty(gltfNode, "LockRotationY")) outNode._flags |= SceneFile::LockRotationY;
+			if (GetBoolProperty(gltfNode, "LockRotationZ")) outNode._flags |= SceneFile::LockRotationZ;
+			if (GetBoolProperty(gltfNode, "LockTranslationX")) outNode._flags |= SceneFile::LockTranslationX;
+			if (GetBoolProperty(gltfNode, "LockTranslationY")) outNode._flags |= SceneFile::LockTranslationY;
+			if (GetBoolProperty(gltfNode, "LockTranslationZ")) outNode._flags |= SceneFile::LockTranslationZ;
+			outNode._collisionLod = (uint32_t)std::max(0.0, GetNumberProperty(gltfNode, "CollisionLod"));
 		}
 
-		static GameObject* ProcessNode(Node* node, tinygltf::Model& gltfScene, Scene& scene, VkContext& ctx) {
+		static void CookNodeHierarchy(Node* node, int32_t parentIndex, tinygltf::Model& gltfScene, SceneFile& sceneFile) {
 			auto& gltfNode = gltfScene.nodes[node->gltfSceneIndex];
-			auto gameObject = new GameObject(gltfNode.name, &scene);
-			auto gltfNodeTransform = GetGltfNodeTransform(gltfNode);
-			gameObject->_localTransform = glm::mat4(1.0f);
-
-			if (gltfNode.mesh < 0) return gameObject;
-
-			auto gltfMesh = gltfScene.meshes[gltfNode.mesh];
-			gameObject->_pMesh = ProcessMesh(gltfMesh, gltfScene, scene, gltfNodeTransform, ctx);
-			gameObject->_pMesh->_pGameObject = gameObject;
+			auto transform = GetGltfNodeTransform(gltfNode);
+			auto& sc = gltfNode.scale;
 
-			return gameObject;
-		}
+			SceneFile::NodeRecord record{};
+			record._localTransform = transform._matrix;
+			record._scale = sc.size() == 3 ? glm::vec3{ sc[0], sc[1], sc[2] } : glm::vec3{ 1.0f, 1.0f, 1.0f };
+			record._parentIndex = parentIndex;
+			record._meshIndex = gltfNode.mesh;
+			record._nameOffset = sceneFile.AddString(gltfNode.name);
+			CookGameConfig(gltfNode, sceneFile, record);
 
-		static GameObject* ProcessNodeHierarchy(Node* root, tinygltf::Model& gltfScene, Scene& scene, VkContext& ctx) {
-			GameObject* outGameObject;
-			if (root->gltfSceneIndex >= 0) outGameObject = ProcessNode(root, gltfScene, scene, ctx);
-			else outGameObject = new GameObject("Root", &scene);
-			root->pGameObject = outGameObject;
+			auto nodeIndex = (int32_t)sceneFile._nodes.size();
+			sceneFile._nodes.push_back(record);
 
-			for (int i = 0; i < root->children.size(); ++i) {
-				auto child = ProcessNodeHierarchy(root->children[i], gltfScene, scene, ctx);
-				child->_pParent = outGameObject;
-				outGameObject->_children.push_back(child);
-			}
-			return outGameObject;
+			for (int i = 0; i < node->children.size(); ++i)
+				CookNodeHierarchy(node->children[i], nodeIndex, gltfScene, sceneFile);
 		}
 
 		static Node* FindExisting(Node* parent, int indexToFind) {
@@ -5728,33 +10957,185 @@ namespace Engine {
 			root = nullptr;
 		}
 
-		static Scene LoadFile(std::filesystem::path filePath, VkContext& ctx) {
-			auto s = new Scene(ctx._logicalDevice, ctx._physicalDevice);
-			auto& scene = *s;
-			scene._pointLights.push_back(PointLight("DefaultLight"));
-
+		/**
+		 * @brief Parses a binary glTF file and writes it to cookedFilePath in SceneFile's format.
+		 */
+		static void CookFile(const std::filesystem::path& filePath, const std::filesystem::path& cookedFilePath) {
 			tinygltf::Model gltfScene;
 			tinygltf::TinyGLTF loader;
 			std::string err;
 			std::string warn;
 
 			bool ret = loader.LoadBinaryFromFile(&gltfScene, &err, &warn, filePath.string());
-			std::cout << warn << std::endl;
-			std::cout << err << std::endl;
+			if (!warn.empty()) Logger::Warning("{}", warn);
+			if (!err.empty()) Logger::Error("{}", err);
 
-			auto materials = LoadMaterials(ctx._logicalDevice, ctx._physicalDevice, gltfScene);
-			scene._materials.insert(scene._materials.end(), materials.begin(), materials.end());
+			SceneFile sceneFile;
+			CookMaterials(gltfScene, sceneFile);
+			CookMeshes(gltfScene, sceneFile);
 
-			// Creates a hierarchy of nodes from the flat list of nodes that tinygltf's loader filled.
-			// This is done because the transforms of each node are relative to the parent, and having a tree-like structure makes it much easier to apply transforms hierarchically.
+			// Creates a hierarchy of nodes from the flat list of nodes that tinygltf's loader filled, and stores it depth first so that parents always come before their children.
 			Node* rootNode = CreateNodeHierarchy(gltfScene);
-			scene._pRootGameObject = ProcessNodeHierarchy(rootNode, gltfScene, scene, ctx);
-			ProcessGameConfig(rootNode, rootNode, gltfScene);
+			for (int i = 0; i < rootNode->children.size(); ++i)
+				CookNodeHierarchy(rootNode->children[i], -1, gltfScene, sceneFile);
 			DestroyNodeHierarchy(rootNode);
 			rootNode = nullptr;
 
+			if (!sceneFile.Save(cookedFilePath)) Logger::Warning("failed writing cooked scene {}", cookedFilePath);
+		}
+
+		/**
+		 * @brief Creates the Mesh drawing one primitive of a cooked mesh. Only the CPU side is filled in: the mesh is not resident until it has been streamed
+		 * to the GPU, see StreamScene.
+		 */
+		static Mesh* CreateMesh(VkContext& ctx, const MappedFile& file, const SceneFile::MeshRecord& meshRecord, const SceneFile::PrimitiveRecord& primitiveRecord) {
+			auto meshlets = SceneFile::Get<SceneFile::MeshletRecord>(file, SceneFile::GetHeader(file)._meshletsOffset) + primitiveRecord._firstMeshlet;
+			auto mesh = new Mesh();
+
+			// Material 0 of the scene is the default material, followed by the cooked materials.
+			mesh->_materialIndex = primitiveRecord._materialIndex >= 0 ? primitiveRecord._materialIndex + 1 : 0;
+			mesh->_isResident = false;
+			mesh->SetVertices(SceneFile::Get<Vertex>(file, meshRecord._verticesOffset) + primitiveRecord._vertexOffset, primitiveRecord._vertexCount);
+			mesh->SetFaceIndices(SceneFile::Get<unsigned int>(file, meshRecord._indicesOffset) + primitiveRecord._firstIndex, primitiveRecord._indexCount);
+			for (uint32_t i = 0; i < primitiveRecord._lodCount; ++i) {
+				auto& lod = primitiveRecord._lods[i];
+				mesh->_lods.push_back(Mesh::Lod{ lod._firstIndex, lod._indexCount, lod._error, lod._firstMeshlet, lod._meshletCount });
+			}
+			for (uint32_t i = 0; i < primitiveRecord._meshletCount; ++i) {
+				auto& meshlet = meshlets[i];
+				mesh->_meshlets.push_back(Mesh::Meshlet{ meshlet._center, meshlet._radius, meshlet._coneAxis, meshlet._coneCutoff, meshlet._firstIndex, meshlet._indexCount });
+			}
+			mesh->_bounds._min = primitiveRecord._boundsMin;
+			mesh->_bounds._max = primitiveRecord._boundsMax;
+
+			return mesh;
+		}
+
+		/**
+		 * @brief Creates a scene from a mapped cooked scene file, which must have been checked with SceneFile::IsValid. Only the node hierarchy is loaded:
+		 * meshes are not resident and materials use placeholder textures until StreamScene uploads them.
+		 */
+		static Scene LoadCookedFile(std::shared_ptr<MappedFile> pCookedFile, VkContext& ctx) {
+			auto s = new Scene(ctx._logicalDevice, ctx._physicalDevice);
+			auto& scene = *s;
+			scene._pointLights.push_back(PointLight("DefaultLight"));
+			scene._pCookedFile = pCookedFile;
+
+			auto& file = *pCookedFile;
+			auto& header = SceneFile::GetHeader(file);
+			auto materials = SceneFile::Get<SceneFile::MaterialRecord>(file, header._materialsOffset);
+			auto meshes = SceneFile::Get<SceneFile::MeshRecord>(file, header._meshesOffset);
+			auto primitives = SceneFile::Get<SceneFile::PrimitiveRecord>(file, header._primitivesOffset);
+			auto nodes = SceneFile::Get<SceneFile::NodeRecord>(file, header._nodesOffset);
+
+			// Every texture gets a placeholder of its own, shared by the materials using the texture, so that it keeps a slot of its own in the material table
+			// once the texture replaces the placeholder. Placeholders are neutral for the map they stand in for.
+			static const unsigned char placeholderColors[Material::MapTypeCount][4] = { { 128, 128, 128, 255 }, { 255, 128, 0, 255 }, { 128, 128, 255, 255 }, { 0, 0, 0, 255 } };
+			auto textures = SceneFile::Get<SceneFile::TextureRecord>(file, header._texturesOffset);
+			for (uint32_t i = 0; i < header._materialCount; ++i) {
+				Material m;
+				m._name = SceneFile::GetString(file, materials[i]._nameOffset);
+				for (uint32_t type = 0; type < Material::MapTypeCount; ++type) {
+					if (materials[i]._textureIndices[type] < 0) continue;
+					auto& texture = textures[materials[i]._textureIndices[type]];
+					auto& color = placeholderColors[type];
+					m._textureIndices[type] = (int32_t)scene._textures.FindOrAdd(ctx, texture._contentHash, [&ctx, &color, type]() {
+						return Image::SolidColor(ctx._logicalDevice, ctx._physicalDevice, color[0], color[1], color[2], color[3], Material::GetFormat((Material::MapType)type));
+					});
+					m._maps[type] = scene._textures._entries[m._textureIndices[type]]._image;
+				}
+				scene._materials.push_back(m);
+			}
+
+			// Game objects that reference the same mesh record share the same Meshes, and are drawn as instances of them.
+			scene._meshes.resize(header._primitiveCount, nullptr);
+			std::vector<GameObject*> gameObjects(header._nodeCount);
+			for (uint32_t i = 0; i < header._nodeCount; ++i) {
+				auto& node = nodes[i];
+				auto gameObject = new GameObject(SceneFile::GetString(file, node._nameOffset), &scene);
+				gameObject->_localTransform._matrix = node._localTransform;
+				gameObject->_localTransform._scale = node._scale;
+
+				auto pParent = node._parentIndex >= 0 ? gameObjects[node._parentIndex] : scene._pRootGameObject;
+				gameObject->_pParent = pParent;
+				pParent->_children.push_back(gameObject);
+				gameObjects[i] = gameObject;
+				if (node._meshIndex < 0) continue;
+
+				// A game object has a single mesh, so the first primitive goes to the node's game object and every other primitive to a child of it.
+				auto& meshRecord = meshes[node._meshIndex];
+				for (uint32_t j = 0; j < meshRecord._primitiveCount; ++j) {
+					auto primitiveIndex = meshRecord._firstPrimitive + j;
+					auto pPrimitiveGameObject = gameObject;
+					if (j > 0) {
+						pPrimitiveGameObject = new GameObject(gameObject->_name + ".Primitive" + std::to_string(j), &scene);
+						pPrimitiveGameObject->_pParent = gameObject;
+						gameObject->_children.push_back(pPrimitiveGameObject);
+					}
+
+					auto& pMesh = scene._meshes[primitiveIndex];
+					if (pMesh == nullptr) {
+						pMesh = CreateMesh(ctx, file, meshRecord, primitives[primitiveIndex]);
+						pMesh->_pGameObject = pPrimitiveGameObject;
+					}
+					pPrimitiveGameObject->_pMesh = pMesh;
+				}
+			}
+
+			// Rigid bodies are created once all game objects exist, because the game object holding the collision mesh can come after the one with the body.
+			for (uint32_t i = 0; i < header._nodeCount; ++i) {
+				auto& node = nodes[i];
+				if (node._collisionMeshNameOffset == SceneFile::_noString) continue;
+
+				auto collisionMeshName = SceneFile::GetString(file, node._collisionMeshNameOffset);
+				auto found = std::find_if(gameObjects.begin(), gameObjects.end(), [&collisionMeshName](GameObject* g) { return g->_name == collisionMeshName; });
+				if (found == gameObjects.end() || !(*found)->_pMesh) continue;
+
+				auto gameObject = gameObjects[i];
+				gameObject->_pBody = new RigidBody();
+				gameObject->_pBody->Initialize(gameObject);
+
+				// Additional init
+				gameObject->_pBody->_friction = node._friction;
+				gameObject->_pBody->_mass = node._mass;
+				gameObject->_pBody->_collisionLod = node._collisionLod;
+				gameObject->_pBody->_isAffectedByGravity = (node._flags & SceneFile::AffectedByGravity) != 0;
+				gameObject->_pBody->_isCollidable = (node._flags & SceneFile::Collidable) != 0;
+				gameObject->_pBody->_lockRotationX = (node._flags & SceneFile::LockRotationX) != 0;
+				gameObject->_pBody->_lockRotationY = (node._flags & SceneFile::LockRotationY) != 0;
+				gameObject->_pBody->_lockRotationZ = (node._flags & SceneFile::LockRotationZ) != 0;
+				gameObject->_pBody->_lockTranslationX = (node._flags & SceneFile::LockTranslationX) != 0;
+				gameObject->_pBody->_lockTranslationY = (node._flags & SceneFile::LockTranslationY) != 0;
+				gameObject->_pBody->_lockTranslationZ = (node._flags & SceneFile::LockTranslationZ) != 0;
+			}
+
 			return scene;
 		}
+
+		/**
+		 * @brief Loads a binary glTF file. The file is cooked into the asset cache the first time it is loaded and every time its content or the cooker changes;
+		 * otherwise the cached file is mapped and used as is.
+		 */
+		static Scene LoadFile(std::filesystem::path filePath, VkContext& ctx) {
+			auto& assetCache = AssetCache::Instance();
+			auto cachedFilePath = assetCache.GetCookedPath(filePath, SceneFile::_version, ".cscene");
+			auto pCookedFile = std::make_shared<MappedFile>();
+
+			// Without a cache entry, the file is cooked to a temporary file every time, so that the importer still gets to report what is wrong with it.
+			if (!cachedFilePath) Logger::Warning("cannot read {}, not using the asset cache", filePath);
+			auto cookedFilePath = cachedFilePath ? *cachedFilePath : std::filesystem::temp_directory_path() / filePath.stem().concat(".cscene");
+
+			if (!cachedFilePath || !pCookedFile->Open(cookedFilePath) || !SceneFile::IsValid(*pCookedFile)) {
+				pCookedFile->Close();
+				CookFile(filePath, cookedFilePath);
+				if (cachedFilePath) assetCache.Evict(cookedFilePath);
+				if (!pCookedFile->Open(cookedFilePath) || !SceneFile::IsValid(*pCookedFile)) Exit(1, ("failed loading cooked scene " + cookedFilePath.string()).c_str());
+			}
+
+			// Streaming reads all of the file soon after the node hierarchy is loaded, so the OS can start loading it in the background now.
+			pCookedFile->WillNeed();
+			return LoadCookedFile(pCookedFile, ctx);
+		}
 	};
 
 	static VkBool32 DebugCallback(VkDebugReportFlagsEXT flags,
@@ -5766,17 +11147,24 @@ namespace Engine {
 		const char* pMsg,
 		void* pUserData) {
 		if (flags & VK_DEBUG_REPORT_ERROR_BIT_EXT) {
-			Logger::Log("ERROR: [" + std::string(pLayerPrefix) + "] Code " + std::to_string(msgCode) + " : " + pMsg);
+			Logger::Error("[{}] code {}: {}", pLayerPrefix, msgCode, pMsg);
 		}
 		else if (flags & VK_DEBUG_REPORT_WARNING_BIT_EXT) {
-			Logger::Log("WARNING: [" + std::string(pLayerPrefix) + "] Code " + std::to_string(msgCode) + " : " + pMsg);
+			Logger::Warning("[{}] code {}: {}", pLayerPrefix, msgCode, pMsg);
 		}
 
 		return VK_FALSE;
 	}
 
-	void Cleanup(bool fullClean) {
+	void Cleanup(VkContext& ctx, bool fullClean) {
 		nk_glfw3_shutdown();
+
+		// Save what the driver compiled this run, so the next run creates its pipelines from it.
+		ctx._pipelineCache.Save(ctx._logicalDevice, Paths::PipelineCachePath());
+		ctx._pipelineCache.Destroy(ctx._logicalDevice);
+
+		// The scene is not torn down yet, so this lists what it still holds as well as any leak.
+		ResourceTracker::Instance().LogLiveResources();
 		//vkDeviceWaitIdle(_logicalDevice);
 		//vkFreeCommandBuffers(_logicalDevice, _commandPool, (uint32_t)_drawCommandBuffers.size(), _drawCommandBuffers.data());
 		//vkDestroyPipeline(_logicalDevice, _graphicsPipeline._handle, nullptr);
@@ -5871,7 +11259,8 @@ namespace Engine {
 		createDebugReportCallback(ctx._instance, &createInfo, nullptr, &ctx._callback);
 	}
 
-	Scene LoadScene(VkContext& ctx) {
+	Scene LoadScene(VkContext& ctx, const std::string& sceneName) {
+		if (!sceneName.empty()) return SceneLoader::LoadFile(Paths::ModelsPath() /= sceneName, ctx);
 		//auto scenePath = Paths::ModelsPath() /= "MaterialSphere.glb";
 		auto scenePath = Paths::ModelsPath() /= "ShootingRange.glb";
 		//auto scenePath = Paths::ModelsPath() /= "cubes.glb";
@@ -5914,14 +11303,134 @@ namespace Engine {
 		eCtx._scene._environmentMap.CreateImage(ctx._logicalDevice, ctx._physicalDevice, ctx._commandPool, ctx._queue);
 	}
 
-	VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR> presentModes) {
+	/**
+	 * @brief Enqueues the meshes and textures of the scene to eCtx._assetStreamer, those closest to the camera first. Meshes of the GPU-driven path are
+	 * enqueued by GpuDrivenScene::Create instead. Must be called after the scene's descriptor sets and the material table have been created, because
+	 * streamed textures are swapped into them.
+	 */
+	void StreamScene(VkContext& ctx, EngineContext& eCtx) {
+		auto& scene = eCtx._scene;
+		auto pCookedFile = scene._pCookedFile;
+		if (pCookedFile == nullptr) return;
+
+		// A mesh is as urgent as its closest game object, a material as its most urgent mesh, and a texture as its most urgent material.
+		auto viewerPosition = eCtx._mainCamera._localTransform.Position();
+		std::map<Mesh*, float> meshPriorities;
+		std::function<void(GameObject*)> gatherPriorities = [&](GameObject* pGameObject) {
+			if (auto pMesh = pGameObject->_pMesh) {
+				auto priority = AssetStreamer::GetPriority(pMesh->_bounds, pGameObject->GetWorldSpaceTransform()._matrix, viewerPosition);
+				auto found = meshPriorities.find(pMesh);
+				meshPriorities[pMesh] = found == meshPriorities.end() ? priority : std::min(found->second, priority);
+			}
+			for (auto& child : pGameObject->_children) gatherPriorities(child);
+		};
+		gatherPriorities(scene._pRootGameObject);
+		std::vector<float> materialPriorities(scene._materials.size(), FLT_MAX);
+		for (auto& [pMesh, priority] : meshPriorities) materialPriorities[pMesh->_materialIndex] = std::min(materialPriorities[pMesh->_materialIndex], priority);
+
+		for (auto& entry : meshPriorities) {
+			auto pMesh = entry.first;
+			if (pMesh->_isResident || eCtx._gpuDrivenScene._isEnabled) continue;
+			auto vertexSizeBytes = pMesh->GetEncodedVerticesSize();
+			auto indexSizeBytes = pMesh->GetEncodedIndicesSize();
+
+			AssetStreamer::Request request;
+			request._name = pMesh->_pGameObject->_name;
+			request._priority = entry.second;
+			request._sizeBytes = vertexSizeBytes + indexSizeBytes;
+			request._prepare = [pMesh, vertexSizeBytes](unsigned char* pStaging) {
+				pMesh->EncodeVertices(pStaging);
+				pMesh->EncodeIndices(pStaging + vertexSizeBytes);
+			};
+			request._record = [&ctx, pMesh, vertexSizeBytes, indexSizeBytes](VkCommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+				pMesh->AllocateVertexBuffer(ctx, vertexSizeBytes);
+				pMesh->AllocateIndexBuffer(ctx, indexSizeBytes);
+				VkBufferCopy vertexCopy{ 0, 0, vertexSizeBytes };
+				VkBufferCopy indexCopy{ vertexSizeBytes, 0, indexSizeBytes };
+				vkCmdCopyBuffer(commandBuffer, stagingBuffer, pMesh->_vertices._vertexBuffer._buffer, 1, &vertexCopy);
+				vkCmdCopyBuffer(commandBuffer, stagingBuffer, pMesh->_faceIndices._indexBuffer._buffer, 1, &indexCopy);
+			};
+			request._finish = [pMesh]() { pMesh->_isResident = true; };
+			eCtx._assetStreamer.Enqueue(std::move(request));
+		}
+
+		// Material 0 is the default material, followed by the cooked materials. Each unique texture is streamed once, as soon as the most urgent
+		// material using it needs it.
+		auto& file = *pCookedFile;
+		auto& header = SceneFile::GetHeader(file);
+		auto textures = SceneFile::Get<SceneFile::TextureRecord>(file, header._texturesOffset);
+		auto materials = SceneFile::Get<SceneFile::MaterialRecord>(file, header._materialsOffset);
+		std::map<int32_t, const SceneFile::TextureRecord*> textureRecords;
+		std::map<int32_t, float> texturePriorities;
+		for (uint32_t i = 0; i < header._materialCount; ++i) {
+			for (uint32_t type = 0; type < Material::MapTypeCount; ++type) {
+				auto textureIndex = scene._materials[i + 1]._textureIndices[type];
+				if (textureIndex < 0) continue;
+				textureRecords[textureIndex] = &textures[materials[i]._textureIndices[type]];
+				auto found = texturePriorities.find(textureIndex);
+				texturePriorities[textureIndex] = found == texturePriorities.end() ? materialPriorities[i + 1] : std::min(found->second, materialPriorities[i + 1]);
+			}
+		}
+
+		for (auto& entry : textureRecords) {
+			auto textureIndex = entry.first;
+			auto& texture = *entry.second;
+			auto pImage = std::make_shared<Image>();
+
+			AssetStreamer::Request request;
+			request._name = "texture " + std::to_string(textureIndex);
+			request._priority = texturePriorities[textureIndex];
+			request._sizeBytes = (size_t)texture._dataSizeBytes;
+			request._prepare = [pCookedFile, &texture](unsigned char* pStaging) {
+				memcpy(pStaging, pCookedFile->_pData + texture._dataOffset, (size_t)texture._dataSizeBytes);
+			};
+			request._record = [&ctx, pCookedFile, &texture, pImage](VkCommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+				*pImage = SceneLoader::CreateTextureImage(ctx._logicalDevice, ctx._physicalDevice, texture, pCookedFile->_pData + texture._dataOffset);
+				VkHelper::RecordImageUpload(commandBuffer, stagingBuffer, pImage->_image, texture._width, texture._height);
+				pImage->_currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			};
+			request._finish = [&ctx, &eCtx, textureIndex, pImage]() {
+				// Swap the texture into the registry, the materials using it, their descriptor sets and the material table, then drop the placeholder.
+				auto& scene = eCtx._scene;
+				auto placeholder = scene._textures.Replace(textureIndex, *pImage);
+
+				for (auto& material : scene._materials) {
+					for (uint32_t type = 0; type < Material::MapTypeCount; ++type) {
+						if (material._textureIndices[type] != textureIndex) continue;
+						material._maps[type] = *pImage;
+						material.UpdateDescriptorSet(ctx, (Material::MapType)type, *pImage);
+					}
+				}
+				for (auto pMesh : scene._meshes) {
+					if (pMesh == nullptr || pMesh->_images.size() < Material::MapTypeCount) continue;
+					for (uint32_t type = 0; type < Material::MapTypeCount; ++type) {
+						if (scene._materials[pMesh->_materialIndex]._textureIndices[type] == textureIndex) pMesh->_images[type] = *pImage;
+					}
+				}
+				eCtx._materialTable.ReplaceTexture(ctx, placeholder, *pImage);
+
+				VkHelper::DestroyImage(ctx._logicalDevice, placeholder._image, placeholder._view, placeholder._sampler);
+				ResourceTracker::FreeMemory(ctx._logicalDevice, placeholder._gpuMemory, nullptr);
+				free(placeholder._pData);
+			};
+			eCtx._assetStreamer.Enqueue(std::move(request));
+		}
+	}
+
+	VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR> presentModes, VkPresentModeKHR requestedPresentMode) {
+		// The swapchain is recreated every time the window is resized, so a fallback is only reported when a different mode is requested.
+		static VkPresentModeKHR lastRequestedPresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
+		bool isNewRequest = requestedPresentMode != lastRequestedPresentMode;
+		lastRequestedPresentMode = requestedPresentMode;
+
 		for (const auto& presentMode : presentModes) {
-			if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+			if (presentMode == requestedPresentMode) {
 				return presentMode;
 			}
 		}
 
-		// If mailbox is unavailable, fall back to FIFO (guaranteed to be available)
+		// If the requested mode is unavailable, fall back to FIFO (guaranteed to be available)
+		if (isNewRequest) Logger::Warning("present mode {} is not supported by the surface, using Fifo", GlobalSettings::GetName(requestedPresentMode));
 		return VK_PRESENT_MODE_FIFO_KHR;
 	}
 
@@ -5954,8 +11463,8 @@ namespace Engine {
 		{
 			auto vertPath = Paths::ShadersPath() / std::filesystem::path("graphics\\EnvMapVertShader.spv");
 			auto fragPath = Paths::ShadersPath() / std::filesystem::path("graphics\\EnvMapFragShader.spv");
-			VkShaderModule vertexShaderModule = VkHelper::CreateShaderModule(ctx._logicalDevice, vertPath.string().c_str());
-			VkShaderModule fragmentShaderModule = VkHelper::CreateShaderModule(ctx._logicalDevice, fragPath.string().c_str());
+			VkShaderModule vertexShaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, vertPath);
+			VkShaderModule fragmentShaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, fragPath);
 
 			// Set up shader stage info.
 			VkPipelineShaderStageCreateInfo vertexShaderCreateInfo = {};
@@ -6105,15 +11614,14 @@ namespace Engine {
 			pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 			pipelineCreateInfo.basePipelineIndex = -1;
 
-			CheckResult(vkCreateGraphicsPipelines(ctx._logicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &rCtx._envMapPipeline._handle));
-			vkDestroyShaderModule(ctx._logicalDevice, vertexShaderModule, nullptr);
-			vkDestroyShaderModule(ctx._logicalDevice, fragmentShaderModule, nullptr);
+			CheckResult(vkCreateGraphicsPipelines(ctx._logicalDevice, ctx._pipelineCache._handle, 1, &pipelineCreateInfo, nullptr, &rCtx._envMapPipeline._handle));
 		}
 
 		// 3D scene pipeline.
 		{
-			VkShaderModule vertexShaderModule = VkHelper::CreateShaderModule(ctx._logicalDevice, Paths::VertexShaderPath().string().c_str());
-			VkShaderModule fragmentShaderModule = VkHelper::CreateShaderModule(ctx._logicalDevice, Paths::FragmentShaderPath().string().c_str());
+			auto fragmentShaderPath = rCtx._bindlessTextureCount > 0 ? Paths::BindlessFragmentShaderPath() : Paths::FragmentShaderPath();
+			VkShaderModule vertexShaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, Paths::VertexShaderPath());
+			VkShaderModule fragmentShaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, fragmentShaderPath);
 
 			// Set up shader stage info.
 			VkPipelineShaderStageCreateInfo vertexShaderCreateInfo = {};
@@ -6127,41 +11635,44 @@ namespace Engine {
 			fragmentShaderCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 			fragmentShaderCreateInfo.module = fragmentShaderModule;
 			fragmentShaderCreateInfo.pName = "main";
+
+			// The size of the texture array of the bindless fragment shader is a specialization constant.
+			VkSpecializationMapEntry textureCountEntry{ 0, 0, sizeof(uint32_t) };
+			VkSpecializationInfo fragmentSpecializationInfo{ 1, &textureCountEntry, sizeof(uint32_t), &rCtx._bindlessTextureCount };
+			if (rCtx._bindlessTextureCount > 0) fragmentShaderCreateInfo.pSpecializationInfo = &fragmentSpecializationInfo;
+
+			// Whether normals are octahedral encoded is a specialization constant of the vertex shaders.
+			auto& vertexLayout = GlobalSettings::Instance()._vertexLayout;
+			VkBool32 octahedralNormals = vertexLayout._normalFormat == VertexLayout::NormalFormat::Octahedral16 ? VK_TRUE : VK_FALSE;
+			VkSpecializationMapEntry octahedralNormalsEntry{ 0, 0, sizeof(VkBool32) };
+			VkSpecializationInfo vertexSpecializationInfo{ 1, &octahedralNormalsEntry, sizeof(VkBool32), &octahedralNormals };
+			vertexShaderCreateInfo.pSpecializationInfo = &vertexSpecializationInfo;
 			VkPipelineShaderStageCreateInfo shaderStages[] = { vertexShaderCreateInfo, fragmentShaderCreateInfo };
 
-			// Vertex attribute binding - gives the vertex shader more info about a particular vertex buffer, denoted by the binding number. See binding for more info.
-			VkVertexInputBindingDescription vertexBindingDescription;
-			vertexBindingDescription.binding = 0;
-			vertexBindingDescription.stride = sizeof(Vertex);
-			vertexBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+			// Vertex attribute bindings - give the vertex shader more info about a particular vertex buffer, denoted by the binding number. See binding for more info.
+			// Binding 0 is the vertex buffer of the mesh, binding 1 is the instance buffer containing the object to world transform of each instance.
+			VkVertexInputBindingDescription vertexBindingDescriptions[2];
+			vertexBindingDescriptions[0] = vertexLayout.GetBindingDescription(0);
+			vertexBindingDescriptions[1].binding = 1;
+			vertexBindingDescriptions[1].stride = sizeof(glm::mat4);
+			vertexBindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
 			// Describe how the shader should read vertex attributes when getting a vertex from the vertex buffer.
-			// Object-space positions.
-			VkVertexInputAttributeDescription vertexAttributeDescriptions[3];
-			vertexAttributeDescriptions[0].location = 0;
-			vertexAttributeDescriptions[0].binding = 0;
-			vertexAttributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-			vertexAttributeDescriptions[0].offset = (uint32_t)Vertex::OffsetOf(Vertex::AttributeType::Position);
-
-			// Normals.
-			vertexAttributeDescriptions[1].location = 1;
-			vertexAttributeDescriptions[1].binding = 0;
-			vertexAttributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			vertexAttributeDescriptions[1].offset = (uint32_t)Vertex::OffsetOf(Vertex::AttributeType::Normal);
-
-			// UV coordinates.
-			vertexAttributeDescriptions[2].location = 2;
-			vertexAttributeDescriptions[2].binding = 0;
-			vertexAttributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-			vertexAttributeDescriptions[2].offset = (uint32_t)Vertex::OffsetOf(Vertex::AttributeType::UV);
+			// Object-space positions, normals and UV coordinates are at locations 0, 1 and 2, in the formats of the vertex layout.
+			auto vertexAttributeDescriptions = vertexLayout.GetAttributeDescriptions(0);
+
+			// Object to world transform of the instance, one attribute per column.
+			for (uint32_t column = 0; column < 4; ++column) {
+				vertexAttributeDescriptions.push_back(VkVertexInputAttributeDescription{ 3 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT, column * (uint32_t)sizeof(glm::vec4) });
+			}
 
 			// Describe vertex input.
 			VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = {};
 			vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-			vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
-			vertexInputCreateInfo.pVertexBindingDescriptions = &vertexBindingDescription;
-			vertexInputCreateInfo.vertexAttributeDescriptionCount = (uint32_t)3;
-			vertexInputCreateInfo.pVertexAttributeDescriptions = vertexAttributeDescriptions;
+			vertexInputCreateInfo.vertexBindingDescriptionCount = 2;
+			vertexInputCreateInfo.pVertexBindingDescriptions = vertexBindingDescriptions;
+			vertexInputCreateInfo.vertexAttributeDescriptionCount = (uint32_t)vertexAttributeDescriptions.size();
+			vertexInputCreateInfo.pVertexAttributeDescriptions = vertexAttributeDescriptions.data();
 
 			// Describe input assembly - this allows Vulkan to know how many indices make up a face for the vkCmdDrawIndexed function.
 			// The input assembly is the very first stage of the graphics pipeline, where vertices and indices are loaded from VRAM and assembled,
@@ -6275,17 +11786,28 @@ namespace Engine {
 			pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 			pipelineCreateInfo.basePipelineIndex = -1;
 
-			CheckResult(vkCreateGraphicsPipelines(ctx._logicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &rCtx._scenePipeline._handle));
-			vkDestroyShaderModule(ctx._logicalDevice, vertexShaderModule, nullptr);
-			vkDestroyShaderModule(ctx._logicalDevice, fragmentShaderModule, nullptr);
+			CheckResult(vkCreateGraphicsPipelines(ctx._logicalDevice, ctx._pipelineCache._handle, 1, &pipelineCreateInfo, nullptr, &rCtx._scenePipeline._handle));
+
+			// The GPU-driven variant only differs in the vertex shader and in the layout of set 1.
+			if (rCtx._gpuDrivenScenePipeline._layout != VK_NULL_HANDLE) {
+				auto gpuDrivenVertPath = Paths::ShadersPath() / std::filesystem::path("graphics\\GpuDrivenVertexShader.spv");
+				VkShaderModule gpuDrivenVertexShaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, gpuDrivenVertPath);
+				shaderStages[0].module = gpuDrivenVertexShaderModule;
+
+				// Object data comes from a storage buffer, so there is no instance buffer.
+				vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
+				vertexInputCreateInfo.vertexAttributeDescriptionCount = (uint32_t)3;
+				pipelineCreateInfo.layout = rCtx._gpuDrivenScenePipeline._layout;
+				CheckResult(vkCreateGraphicsPipelines(ctx._logicalDevice, ctx._pipelineCache._handle, 1, &pipelineCreateInfo, nullptr, &rCtx._gpuDrivenScenePipeline._handle));
+			}
 		}
 
 		// UI pipeline.
 		{
 			auto vertPath = Paths::ShadersPath() / std::filesystem::path("graphics\\NuklearUIVertexShader.spv");
 			auto fragPath = Paths::ShadersPath() / std::filesystem::path("graphics\\NuklearUIFragmentShader.spv");
-			VkShaderModule vertShaderModule = VkHelper::CreateShaderModule(ctx._logicalDevice, vertPath.string().c_str());
-			VkShaderModule fragShaderModule = VkHelper::CreateShaderModule(ctx._logicalDevice, fragPath.string().c_str());
+			VkShaderModule vertShaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, vertPath);
+			VkShaderModule fragShaderModule = ctx._pipelineCache.GetShaderModule(ctx._logicalDevice, fragPath);
 
 			VkPipelineShaderStageCreateInfo vert_shader_stage_info{};
 			vert_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -6381,10 +11903,7 @@ namespace Engine {
 			pipelineInfo.subpass = 1;
 			pipelineInfo.basePipelineHandle = NULL;
 
-			CheckResult(vkCreateGraphicsPipelines(ctx._logicalDevice, NULL, 1, &pipelineInfo, NULL, &rCtx._uiPipeline._handle));
-
-			if (fragShaderModule) vkDestroyShaderModule(ctx._logicalDevice, fragShaderModule, NULL);
-			if (vertShaderModule) vkDestroyShaderModule(ctx._logicalDevice, vertShaderModule, NULL);
+			CheckResult(vkCreateGraphicsPipelines(ctx._logicalDevice, ctx._pipelineCache._handle, 1, &pipelineInfo, NULL, &rCtx._uiPipeline._handle));
 		}
 	}
 
@@ -6423,13 +11942,14 @@ namespace Engine {
 		}
 
 		{
-			VkDescriptorSetLayoutBinding bindings[3];
-			bindings[0] = { VkDescriptorSetLayoutBinding {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, &scene._materials[0]._albedo._sampler} };
-			bindings[1] = { VkDescriptorSetLayoutBinding {1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, &scene._materials[0]._roughness._sampler} };
-			bindings[2] = { VkDescriptorSetLayoutBinding {2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, &scene._materials[0]._metalness._sampler} };
+			// One binding per Material::MapType.
+			VkDescriptorSetLayoutBinding bindings[Material::MapTypeCount];
+			for (uint32_t i = 0; i < Material::MapTypeCount; ++i) {
+				bindings[i] = { VkDescriptorSetLayoutBinding { i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, &scene._materials[0]._maps[i]._sampler } };
+			}
 			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
 			layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-			layoutCreateInfo.bindingCount = 3;
+			layoutCreateInfo.bindingCount = Material::MapTypeCount;
 			layoutCreateInfo.pBindings = bindings;
 			vkCreateDescriptorSetLayout(ctx._logicalDevice, &layoutCreateInfo, nullptr, &meshLayout);
 		}
@@ -6461,10 +11981,18 @@ namespace Engine {
 				return l._layout;
 			});
 
+		// The material index and the position dequantization of the mesh being drawn.
+		VkPushConstantRange range = {};
+		range.offset = 0;
+		range.size = sizeof(MeshInstancer::PushConstants);
+		range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
 		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
 		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutCreateInfo.setLayoutCount = (uint32_t)layouts.size();
 		pipelineLayoutCreateInfo.pSetLayouts = layouts.data();
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &range;
 		VkPipelineLayout outLayout;
 		CheckResult(vkCreatePipelineLayout(ctx._logicalDevice, &pipelineLayoutCreateInfo, nullptr, &outLayout));
 		return outLayout;
@@ -6491,8 +12019,10 @@ namespace Engine {
 		eCtx._scene.UpdateShaderResources();
 	}
 
-	void CreateRenderingResources(VkContext& ctx, EngineContext& eCtx, VkRenderContext* outRenderCtx) {
-		// Create the swapchain.
+	/**
+	 * @brief Creates the swapchain of the window surface and returns its images.
+	 */
+	std::vector<VkImage> CreateSwapchain(VkContext& ctx, VkRenderContext* outRenderCtx) {
 		// Get physical device capabilities for the window surface.
 		VkSurfaceCapabilitiesKHR surfaceCapabilities = PhysicalDevice::GetSurfaceCapabilities(ctx._physicalDevice, ctx._windowSurface);
 		std::vector<VkSurfaceFormatKHR> surfaceFormats = PhysicalDevice::GetSupportedFormatsForSurface(ctx._physicalDevice, ctx._windowSurface);
@@ -6512,8 +12042,9 @@ namespace Engine {
 		if (surfaceCapabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) surfaceTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 		else surfaceTransform = surfaceCapabilities.currentTransform;
 
-		// Choose presentation mode (preferring MAILBOX ~= triple buffering).
-		VkPresentModeKHR presentMode = ChoosePresentMode(presentModes);
+		// Choose presentation mode.
+		outRenderCtx->_swapchain._requestedPresentMode = GlobalSettings::Instance()._presentMode;
+		VkPresentModeKHR presentMode = ChoosePresentMode(presentModes, outRenderCtx->_swapchain._requestedPresentMode);
 
 		// Finally, create the swap chain.
 		VkSwapchainCreateInfoKHR createInfo = {};
@@ -6543,24 +12074,62 @@ namespace Engine {
 		outRenderCtx->_swapchain._oldSwapchainHandle = outRenderCtx->_swapchain._handle;
 		outRenderCtx->_swapchain._surfaceFormat = surfaceFormat;
 
-
-		auto& imageFormat = outRenderCtx->_swapchain._surfaceFormat.format;
 		// Store the images used by the swap chain.
 		// Note: these are the images that swap chain image indices refer to.
 		// Note: actual number of images may differ from requested number, since it's a lower bound.
 		uint32_t actualImageCount = 0;
 		CheckResult(vkGetSwapchainImagesKHR(ctx._logicalDevice, outRenderCtx->_swapchain._handle, &actualImageCount, nullptr));
+		std::vector<VkImage> swapchainImages;
+		swapchainImages.resize(actualImageCount);
+		CheckResult(vkGetSwapchainImagesKHR(ctx._logicalDevice, outRenderCtx->_swapchain._handle, &actualImageCount, swapchainImages.data()));
+		outRenderCtx->_swapchain._images.resize(actualImageCount);
+		return swapchainImages;
+	}
+
+	/**
+	 * @brief Creates the image frames are rendered to when there is no window to present them to, sized like the window would be. Unlike swapchain
+	 * images, it is owned by the engine, so its memory is kept in _swapchain._images.
+	 */
+	std::vector<VkImage> CreateOffscreenImages(VkContext& ctx, VkRenderContext* outRenderCtx) {
+		ResourceTracker::Scope resourceScope(ResourceTracker::Category::RenderTarget);
+		auto& settings = GlobalSettings::Instance();
+		outRenderCtx->_swapchain._framebufferSize = { settings._windowWidth, settings._windowHeight };
+		outRenderCtx->_swapchain._surfaceFormat = { VK_FORMAT_R8G8B8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+		outRenderCtx->_swapchain._images.resize(1);
+
+		auto& image = outRenderCtx->_swapchain._images[0];
+		VkImageCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		createInfo.imageType = VK_IMAGE_TYPE_2D;
+		createInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+		createInfo.extent = { settings._windowWidth, settings._windowHeight, 1 };
+		createInfo.mipLevels = 1;
+		createInfo.arrayLayers = 1;
+		createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		createInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		CheckResult(ResourceTracker::CreateImage(ctx._logicalDevice, &createInfo, nullptr, &image._image));
+		image._gpuMemory = VkHelper::AllocateGpuMemoryForImage(ctx._logicalDevice, ctx._physicalDevice, image._image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		CheckResult(vkBindImageMemory(ctx._logicalDevice, image._image, image._gpuMemory, 0));
+		return { image._image };
+	}
+
+	void CreateRenderingResources(VkContext& ctx, EngineContext& eCtx, VkRenderContext* outRenderCtx) {
+		ResourceTracker::Scope resourceScope(ResourceTracker::Category::RenderTarget);
+		// Without a window surface, such as when benchmarking, frames are rendered to an image of their own and left ready to be copied from.
+		auto isOffscreen = ctx._windowSurface == VK_NULL_HANDLE;
+		auto finalImageLayout = isOffscreen ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		auto swapchainImages = isOffscreen ? CreateOffscreenImages(ctx, outRenderCtx) : CreateSwapchain(ctx, outRenderCtx);
+		auto actualImageCount = (uint32_t)swapchainImages.size();
 
 		outRenderCtx->_renderPass._colorImages.resize(actualImageCount);
-		outRenderCtx->_swapchain._images.resize(actualImageCount);
 		outRenderCtx->_overlayImages.resize(actualImageCount);
 		outRenderCtx->_swapchain._frameBuffers.resize(actualImageCount);
 		outRenderCtx->_drawCommandBuffers.resize(actualImageCount);
-
-		std::vector<VkImage> swapchainImages;
-		swapchainImages.resize(actualImageCount);
-		CheckResult(vkGetSwapchainImagesKHR(ctx._logicalDevice, outRenderCtx->_swapchain._handle, &actualImageCount, swapchainImages.data()));
 		outRenderCtx->_swapchain._imageCount = actualImageCount;
+		Profiler::Instance().CreateGpuQueries(ctx._logicalDevice, ctx._physicalDevice, ctx._queueFamilyIndex, actualImageCount);
 
 		// Create the scene and UI color attachments.
 		for (uint32_t i = 0; i < actualImageCount; ++i) {
@@ -6597,7 +12166,7 @@ namespace Engine {
 				imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 				imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 				imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
-				vkCreateImage(ctx._logicalDevice, &imageCreateInfo, nullptr, &rpColorImg._image);
+				ResourceTracker::CreateImage(ctx._logicalDevice, &imageCreateInfo, nullptr, &rpColorImg._image);
 
 				// Allocate memory on the GPU for the image.
 				rpColorImg._gpuMemory = VkHelper::AllocateGpuMemoryForImage(ctx._logicalDevice, ctx._physicalDevice, rpColorImg._image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
@@ -6651,7 +12220,7 @@ namespace Engine {
 				image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 				image_info.samples = VK_SAMPLE_COUNT_1_BIT;
 				image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-				CheckResult(vkCreateImage(ctx._logicalDevice, &image_info, NULL, &outRenderCtx->_overlayImages[i]._image));
+				CheckResult(ResourceTracker::CreateImage(ctx._logicalDevice, &image_info, NULL, &outRenderCtx->_overlayImages[i]._image));
 
 				outRenderCtx->_overlayImages[i]._gpuMemory = VkHelper::AllocateGpuMemoryForImage(ctx._logicalDevice, ctx._physicalDevice, outRenderCtx->_overlayImages[i]._image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 				CheckResult(vkBindImageMemory(ctx._logicalDevice, outRenderCtx->_overlayImages[i]._image, outRenderCtx->_overlayImages[i]._gpuMemory, 0));
@@ -6704,7 +12273,7 @@ namespace Engine {
 			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 			imageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-			vkCreateImage(ctx._logicalDevice, &imageCreateInfo, nullptr, &outRenderCtx->_renderPass._depthImage._image);
+			ResourceTracker::CreateImage(ctx._logicalDevice, &imageCreateInfo, nullptr, &outRenderCtx->_renderPass._depthImage._image);
 
 			// Allocate memory on the GPU for the image.
 			outRenderCtx->_renderPass._depthImage._gpuMemory = VkHelper::AllocateGpuMemoryForImage(ctx._logicalDevice, ctx._physicalDevice, outRenderCtx->_renderPass._depthImage._image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
@@ -6799,8 +12368,8 @@ namespace Engine {
 			swapchainImageAttachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 			swapchainImageAttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			swapchainImageAttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-			swapchainImageAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-			swapchainImageAttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			swapchainImageAttachmentDescription.initialLayout = finalImageLayout;
+			swapchainImageAttachmentDescription.finalLayout = finalImageLayout;
 
 			// Describes how the render pass is going to use the main color attachment. An attachment is a fancy word for "image used for a render pass".
 			VkAttachmentDescription colorAttachmentDescription = {};
@@ -6884,7 +12453,7 @@ namespace Engine {
 			std::vector<VkDescriptorSet> sets; sets.resize(actualImageCount);
 			for (uint32_t i = 0; i < actualImageCount; ++i) {
 				VkDescriptorPool dp;
-				CheckResult(vkCreateDescriptorPool(ctx._logicalDevice, &pool_info, NULL, &dp));
+				CheckResult(ResourceTracker::CreateDescriptorPool(ctx._logicalDevice, &pool_info, NULL, &dp));
 				sets[i] = VkHelper::AllocateDescriptorSet(ctx._logicalDevice, dp, uiDescriptorSetLayout._layout);
 
 				std::array<VkDescriptorImageInfo, 2> descriptors{};
@@ -6937,11 +12506,11 @@ namespace Engine {
 
 		CreateGraphicsPipelines(ctx, *outRenderCtx);
 
-		// Here we record the commands that will be executed in the render loop. The engine uses deferred command execution, meaning that it will execute the command buffers 
-		// that are recorded now in the future.
+		// The environment map pipeline reads the camera data too.
+		eCtx._scene._environmentMap._shaderResources.MergeResources(eCtx._mainCamera._shaderResources);
+
 		for (size_t i = 0; i < actualImageCount; i++) {
 			auto& currentFrameBuffer = outRenderCtx->_swapchain._frameBuffers[i];
-			auto& cmdBufferOfCurrentFrame = outRenderCtx->_drawCommandBuffers[i];
 
 			// We will render to the same depth image for each frame. 
 			// We can just keep clearing and reusing the same depth image for every frame.
@@ -6956,57 +12525,9 @@ namespace Engine {
 			createInfo.layers = 1;
 			CheckResult(vkCreateFramebuffer(ctx._logicalDevice, &createInfo, nullptr, &currentFrameBuffer));
 
-			VkCommandBufferBeginInfo beginInfo = {};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-			vkBeginCommandBuffer(outRenderCtx->_drawCommandBuffers[i], &beginInfo);
-
-			VkHelper::TransitionImageLayout(ctx._logicalDevice, ctx._commandPool, ctx._queue, outRenderCtx->_swapchain._images[i]._image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+			VkHelper::TransitionImageLayout(ctx._logicalDevice, ctx._commandPool, ctx._queue, outRenderCtx->_swapchain._images[i]._image, VK_IMAGE_LAYOUT_UNDEFINED, finalImageLayout);
 			VkHelper::TransitionImageLayout(ctx._logicalDevice, ctx._commandPool, ctx._queue, outRenderCtx->_renderPass._colorImages[i]._image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 			//VkHelper::TransitionImageLayout(ctx._logicalDevice, ctx._commandPool, ctx._queue, _uiCtx._overlayImages[i]._image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-			VkClearValue swapchainImageClear{ { 0.0f, 0.0f, 0.0f, 1.0f } }; // R, G, B, A.
-			VkClearValue sceneImageClear = { { 0.1f, 0.1f, 0.1f, 1.0f } };
-			VkClearValue depthImageClear{ { 0.0f, 0.0f, 0.0f, 0.0f } }; depthImageClear.depthStencil.depth = 1.0f;
-			VkClearValue clearValues[] = { swapchainImageClear, sceneImageClear, depthImageClear };
-
-			VkRenderPassBeginInfo renderPassBeginInfo{};
-			renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassBeginInfo.renderPass = outRenderCtx->_renderPass._handle;
-			renderPassBeginInfo.framebuffer = currentFrameBuffer;
-			renderPassBeginInfo.renderArea.offset.x = 0;
-			renderPassBeginInfo.renderArea.offset.y = 0;
-			renderPassBeginInfo.renderArea.extent = outRenderCtx->_swapchain._framebufferSize;
-			renderPassBeginInfo.clearValueCount = 3;
-			renderPassBeginInfo.pClearValues = clearValues;
-
-			// Draw the environment map as a skybox.
-			vkCmdBeginRenderPass(cmdBufferOfCurrentFrame, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-			vkCmdBindPipeline(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, outRenderCtx->_envMapPipeline._handle);
-			eCtx._scene._environmentMap._shaderResources.MergeResources(eCtx._mainCamera._shaderResources);
-			eCtx._scene._environmentMap.Draw(outRenderCtx->_envMapPipeline._layout, cmdBufferOfCurrentFrame);
-
-			// Draw the 3D objects.
-			auto& shaderResources = outRenderCtx->_scenePipeline._shaderResources;
-			VkDescriptorSet sets[4] = { shaderResources[0][0], shaderResources[1][0], shaderResources[2][0], shaderResources[4][0] };
-			vkCmdBindPipeline(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, outRenderCtx->_scenePipeline._handle);
-			vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, outRenderCtx->_scenePipeline._layout, 0, 1, &shaderResources[0][0], 0, nullptr);
-			vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, outRenderCtx->_scenePipeline._layout, 2, 1, &shaderResources[2][0], 0, nullptr);
-			vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, outRenderCtx->_scenePipeline._layout, 4, 1, &shaderResources[4][0], 0, nullptr);
-
-			for (auto& gameObject : eCtx._scene._pRootGameObject->_children)
-				gameObject->Draw(outRenderCtx->_scenePipeline._layout, cmdBufferOfCurrentFrame);
-
-			// Draw UI.
-			auto& uiShaderResources = outRenderCtx->_uiPipeline._shaderResources;
-			vkCmdNextSubpass(cmdBufferOfCurrentFrame, VK_SUBPASS_CONTENTS_INLINE);
-			vkCmdBindPipeline(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, outRenderCtx->_uiPipeline._handle);
-			vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, outRenderCtx->_uiPipeline._layout, 0, 1, &uiShaderResources[0][i], 0, nullptr);
-			vkCmdPushConstants(cmdBufferOfCurrentFrame, outRenderCtx->_uiPipeline._layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &eCtx._globalSettings._gammaCorrection);
-			vkCmdDraw(cmdBufferOfCurrentFrame, 3, 1, 0, 0);
-			vkCmdEndRenderPass(cmdBufferOfCurrentFrame);
-			CheckResult(vkEndCommandBuffer(cmdBufferOfCurrentFrame));
-
 		}
 
 		// Create sempahores to synchronize drawing operations.
@@ -7018,6 +12539,95 @@ namespace Engine {
 		}
 	}
 
+	/**
+	 * @brief Records the draw commands for the swapchain image at imageIndex. Commands are recorded every frame, because the set of game objects to draw
+	 * depends on what the camera sees.
+	 */
+	void RecordDrawCommands(VkContext& ctx, VkRenderContext& rCtx, EngineContext& eCtx, uint32_t imageIndex) {
+		Profiler::ScopedZone zone("Record draw commands");
+		auto& profiler = Profiler::Instance();
+		auto& currentFrameBuffer = rCtx._swapchain._frameBuffers[imageIndex];
+		auto& cmdBufferOfCurrentFrame = rCtx._drawCommandBuffers[imageIndex];
+
+		auto frustum = Frustum::Create(eCtx._mainCamera);
+		auto& gpuDrivenScene = eCtx._gpuDrivenScene;
+		if (!gpuDrivenScene._isEnabled) {
+			Profiler::ScopedZone cullingZone("Frustum culling");
+			eCtx._frustumCuller.Cull(frustum, eCtx._scene._pRootGameObject);
+			eCtx._meshInstancer.Build(ctx, eCtx._frustumCuller._visibleObjects, eCtx._mainCamera);
+		}
+
+		// The command buffer pool was created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, so beginning the command buffer implicitly resets it.
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(cmdBufferOfCurrentFrame, &beginInfo);
+		profiler.BeginGpuFrame(ctx._logicalDevice, cmdBufferOfCurrentFrame, imageIndex);
+		auto frameZone = profiler.BeginGpuZone(cmdBufferOfCurrentFrame, imageIndex, "Frame");
+
+		// Culling on the GPU writes the draw commands, so it has to happen before the render pass begins.
+		if (gpuDrivenScene._isEnabled) {
+			auto cullingZone = profiler.BeginGpuZone(cmdBufferOfCurrentFrame, imageIndex, "Culling");
+			gpuDrivenScene.RecordCulling(cmdBufferOfCurrentFrame, frustum, eCtx._mainCamera);
+			profiler.EndGpuZone(cmdBufferOfCurrentFrame, imageIndex, cullingZone);
+		}
+
+		VkClearValue swapchainImageClear{ { 0.0f, 0.0f, 0.0f, 1.0f } }; // R, G, B, A.
+		VkClearValue sceneImageClear = { { 0.1f, 0.1f, 0.1f, 1.0f } };
+		VkClearValue depthImageClear{ { 0.0f, 0.0f, 0.0f, 0.0f } }; depthImageClear.depthStencil.depth = 1.0f;
+		VkClearValue clearValues[] = { swapchainImageClear, sceneImageClear, depthImageClear };
+
+		VkRenderPassBeginInfo renderPassBeginInfo{};
+		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.renderPass = rCtx._renderPass._handle;
+		renderPassBeginInfo.framebuffer = currentFrameBuffer;
+		renderPassBeginInfo.renderArea.offset.x = 0;
+		renderPassBeginInfo.renderArea.offset.y = 0;
+		renderPassBeginInfo.renderArea.extent = rCtx._swapchain._framebufferSize;
+		renderPassBeginInfo.clearValueCount = 3;
+		renderPassBeginInfo.pClearValues = clearValues;
+
+		// Draw the environment map as a skybox.
+		vkCmdBeginRenderPass(cmdBufferOfCurrentFrame, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		auto passZone = profiler.BeginGpuZone(cmdBufferOfCurrentFrame, imageIndex, "Skybox");
+		vkCmdBindPipeline(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, rCtx._envMapPipeline._handle);
+		eCtx._scene._environmentMap.Draw(rCtx._envMapPipeline._layout, cmdBufferOfCurrentFrame);
+		profiler.EndGpuZone(cmdBufferOfCurrentFrame, imageIndex, passZone);
+
+		// Draw the 3D objects the camera can see.
+		passZone = profiler.BeginGpuZone(cmdBufferOfCurrentFrame, imageIndex, "Scene");
+		auto& shaderResources = rCtx._scenePipeline._shaderResources;
+		auto& scenePipeline = gpuDrivenScene._isEnabled ? rCtx._gpuDrivenScenePipeline : rCtx._scenePipeline;
+		vkCmdBindPipeline(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline._handle);
+		vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline._layout, 0, 1, &shaderResources[0][0], 0, nullptr);
+		vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline._layout, 2, 1, &shaderResources[2][0], 0, nullptr);
+		vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline._layout, 4, 1, &shaderResources[4][0], 0, nullptr);
+
+		auto& materialTable = eCtx._materialTable;
+		if (materialTable._isEnabled) vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline._layout, 3, 1, &materialTable._descriptorSet, 0, nullptr);
+
+		if (gpuDrivenScene._isEnabled) {
+			gpuDrivenScene.Draw(scenePipeline._layout, cmdBufferOfCurrentFrame, materialTable._isEnabled);
+		}
+		else {
+			eCtx._meshInstancer.Draw(scenePipeline._layout, cmdBufferOfCurrentFrame, materialTable._isEnabled);
+		}
+		profiler.EndGpuZone(cmdBufferOfCurrentFrame, imageIndex, passZone);
+
+		// Draw UI.
+		auto& uiShaderResources = rCtx._uiPipeline._shaderResources;
+		vkCmdNextSubpass(cmdBufferOfCurrentFrame, VK_SUBPASS_CONTENTS_INLINE);
+		passZone = profiler.BeginGpuZone(cmdBufferOfCurrentFrame, imageIndex, "UI");
+		vkCmdBindPipeline(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, rCtx._uiPipeline._handle);
+		vkCmdBindDescriptorSets(cmdBufferOfCurrentFrame, VK_PIPELINE_BIND_POINT_GRAPHICS, rCtx._uiPipeline._layout, 0, 1, &uiShaderResources[0][imageIndex], 0, nullptr);
+		vkCmdPushConstants(cmdBufferOfCurrentFrame, rCtx._uiPipeline._layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &eCtx._globalSettings._gammaCorrection);
+		vkCmdDraw(cmdBufferOfCurrentFrame, 3, 1, 0, 0);
+		profiler.EndGpuZone(cmdBufferOfCurrentFrame, imageIndex, passZone);
+		vkCmdEndRenderPass(cmdBufferOfCurrentFrame);
+		profiler.EndGpuZone(cmdBufferOfCurrentFrame, imageIndex, frameZone);
+		CheckResult(vkEndCommandBuffer(cmdBufferOfCurrentFrame));
+	}
+
 	void DestroyRenderingResources(VkContext& ctx, VkRenderContext& rCtx) {
 		vkQueueWaitIdle(ctx._queue);
 		for (int i = 0; i < rCtx._swapchain._frameBuffers.size(); ++i) {
@@ -7027,14 +12637,22 @@ namespace Engine {
 		}
 		VkHelper::DestroyImage(ctx._logicalDevice, rCtx._renderPass._depthImage._image, rCtx._renderPass._depthImage._view, rCtx._renderPass._depthImage._sampler);
 		vkDestroyRenderPass(ctx._logicalDevice, rCtx._renderPass._handle, nullptr);
+		if (ctx._windowSurface == VK_NULL_HANDLE) {
+			for (auto& image : rCtx._swapchain._images) {
+				VkHelper::DestroyImage(ctx._logicalDevice, image._image, image._view);
+				ResourceTracker::FreeMemory(ctx._logicalDevice, image._gpuMemory, nullptr);
+			}
+		}
 		vkDestroySwapchainKHR(ctx._logicalDevice, rCtx._swapchain._handle, nullptr);
 		rCtx._swapchain._handle = nullptr;
 		rCtx._swapchain._oldSwapchainHandle = nullptr;
 		vkDestroyPipeline(ctx._logicalDevice, rCtx._envMapPipeline._handle, nullptr);
 		vkDestroyPipeline(ctx._logicalDevice, rCtx._uiPipeline._handle, nullptr);
 		vkDestroyPipeline(ctx._logicalDevice, rCtx._scenePipeline._handle, nullptr);
+		if (rCtx._gpuDrivenScenePipeline._handle != VK_NULL_HANDLE) vkDestroyPipeline(ctx._logicalDevice, rCtx._gpuDrivenScenePipeline._handle, nullptr);
 		vkDestroySemaphore(ctx._logicalDevice, rCtx._imageAvailableSemaphore, nullptr);
 		vkDestroySemaphore(ctx._logicalDevice, rCtx._renderingFinishedSemaphore, nullptr);
+		Profiler::Instance().DestroyGpuQueries(ctx._logicalDevice);
 	}
 
 	VkContext InitializeVulkan(GlobalSettings& settings, GLFWwindow* pWindow) {
@@ -7048,10 +12666,10 @@ namespace Engine {
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.apiVersion = VK_API_VERSION_1_0;
 
-		// Get instance extensions required by GLFW to draw to the window.
-		unsigned int glfwExtensionCount;
-		const char** glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		// Get instance extensions required by GLFW to draw to the window. Without a window, frames are rendered offscreen and no extensions are needed.
+		unsigned int glfwExtensionCount = 0;
+		const char** glfwExtensions = nullptr;
+		if (pWindow != nullptr) glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
 		std::vector<const char*> extensions;
 		for (size_t i = 0; i < glfwExtensionCount; i++) extensions.push_back(glfwExtensions[i]);
@@ -7065,6 +12683,15 @@ namespace Engine {
 		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
 
+		// Needed to query memory budgets, which are only used when available.
+		bool isProperties2Enabled = false;
+		for (auto& extension : availableExtensions) {
+			if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+				extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+				isProperties2Enabled = true;
+			}
+		}
+
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 		createInfo.pApplicationInfo = &appInfo;
@@ -7081,7 +12708,7 @@ namespace Engine {
 		vkCreateInstance(&createInfo, nullptr, &ctx._instance);
 
 		Engine::CreateDebugCallback(ctx, settings);
-		glfwCreateWindowSurface(ctx._instance, pWindow, NULL, &ctx._windowSurface);
+		if (pWindow != nullptr) glfwCreateWindowSurface(ctx._instance, pWindow, NULL, &ctx._windowSurface);
 
 		uint32_t deviceCount = 0;
 		vkEnumeratePhysicalDevices(ctx._instance, &deviceCount, nullptr);
@@ -7092,6 +12719,9 @@ namespace Engine {
 		if (deviceCount <= 0) Exit(1, "device count was zero");
 		ctx._physicalDevice = outDevice[0];
 
+		bool isMemoryBudgetEnabled = isProperties2Enabled && ResourceTracker::IsMemoryBudgetSupported(ctx._physicalDevice);
+		ResourceTracker::Instance().Initialize(ctx._instance, ctx._physicalDevice, isMemoryBudgetEnabled);
+
 		auto flags = (VkQueueFlagBits)(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
 		std::vector<VkQueueFamilyProperties> queueFamilyProperties = PhysicalDevice::GetAllQueueFamilyProperties(ctx._physicalDevice);
 		uint32_t queueFamilyCount = 0;
@@ -7106,7 +12736,7 @@ namespace Engine {
 
 		ctx._queueFamilyIndex = VkHelper::FindQueueFamilyIndex(ctx._physicalDevice, flags);
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(ctx._physicalDevice, ctx._queueFamilyIndex, ctx._windowSurface, &presentSupport);
+		if (ctx._windowSurface != VK_NULL_HANDLE) vkGetPhysicalDeviceSurfaceSupportKHR(ctx._physicalDevice, ctx._queueFamilyIndex, ctx._windowSurface, &presentSupport);
 
 		VkDeviceQueueCreateInfo graphicsQueueInfo{};
 		float queuePriority = 1.0f;
@@ -7126,9 +12756,20 @@ namespace Engine {
 		enabledFeatures.shaderClipDistance = VK_TRUE;
 		enabledFeatures.shaderCullDistance = VK_TRUE;
 
-		const char* deviceExtensions = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
-		deviceCreateInfo.enabledExtensionCount = 1;
-		deviceCreateInfo.ppEnabledExtensionNames = &deviceExtensions;
+		// Needed by the GPU-driven path; if not supported the engine falls back to drawing one object at a time.
+		if (settings._gpuDrivenRendering && GpuDrivenScene::IsSupported(ctx._physicalDevice)) {
+			enabledFeatures.multiDrawIndirect = VK_TRUE;
+			enabledFeatures.drawIndirectFirstInstance = VK_TRUE;
+		}
+		if (settings._bindlessMaterials && MaterialTable::IsSupported(ctx._physicalDevice)) {
+			enabledFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+		}
+
+		std::vector<const char*> deviceExtensions;
+		if (ctx._windowSurface != VK_NULL_HANDLE) deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		if (isMemoryBudgetEnabled) deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		deviceCreateInfo.enabledExtensionCount = (uint32_t)deviceExtensions.size();
+		deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
 		deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
 
 		if (settings._enableValidationLayers) {
@@ -7141,6 +12782,7 @@ namespace Engine {
 		VkFenceCreateInfo fci = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, 0 };
 		vkCreateFence(ctx._logicalDevice, &fci, NULL, &ctx._queueFence);
 		ctx._commandPool = VkHelper::CreateCommandPool(ctx._logicalDevice, ctx._queueFamilyIndex);
+		ctx._pipelineCache.Create(ctx._logicalDevice, ctx._physicalDevice, Paths::PipelineCachePath());
 		return ctx;
 	}
 
@@ -7174,20 +12816,68 @@ namespace Engine {
 
 	void InitializeEngine(VkContext* outCtx, VkRenderContext* outRenderCtx, EngineContext* outEngineCtx) {
 		outEngineCtx->_globalSettings.Load(Engine::Paths::Settings());
-		glfwInit();
-		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-		outRenderCtx->_pWindow = glfwCreateWindow(outEngineCtx->_globalSettings._windowWidth, outEngineCtx->_globalSettings._windowHeight, "Frontline Legacy", nullptr, nullptr);
-		glfwSetWindowSizeCallback(outRenderCtx->_pWindow, Engine::OnWindowResized);
-		outEngineCtx->_input.Initialize(outRenderCtx->_pWindow);
+		auto isOffscreen = outEngineCtx->_offscreenSize.width > 0 && outEngineCtx->_offscreenSize.height > 0;
+		if (isOffscreen) {
+			outEngineCtx->_globalSettings._windowWidth = outEngineCtx->_offscreenSize.width;
+			outEngineCtx->_globalSettings._windowHeight = outEngineCtx->_offscreenSize.height;
+		}
+		Logger::Instance().SetLevel(outEngineCtx->_globalSettings._logLevel);
+
+		// Benchmarks read their timings from the profiler, so it is always enabled for them.
+		Profiler::Instance().SetEnabled(isOffscreen || outEngineCtx->_globalSettings._profilingEnabled);
+		Profiler::Instance().SetThreadName("Main");
+		if (!outEngineCtx->_globalSettings._logFile.empty()) {
+			auto logPath = Paths::CurrentWorkingDirectory() / outEngineCtx->_globalSettings._logFile;
+			if (!Logger::Instance().OpenFile(logPath, outEngineCtx->_globalSettings._logBinary)) Logger::Warning("failed creating log file {}", logPath);
+		}
+		outEngineCtx->_mainCamera._farClippingDistance = outEngineCtx->_globalSettings._farClippingDistance;
+		AssetCache::Instance().Initialize(Paths::AssetCachePath(), (uint64_t)outEngineCtx->_globalSettings._assetCacheSizeMegabytes * 1024 * 1024);
+		outRenderCtx->_pWindow = nullptr;
+		if (!isOffscreen) {
+			glfwInit();
+			glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+			outRenderCtx->_pWindow = glfwCreateWindow(outEngineCtx->_globalSettings._windowWidth, outEngineCtx->_globalSettings._windowHeight, "Frontline Legacy", nullptr, nullptr);
+			glfwSetWindowSizeCallback(outRenderCtx->_pWindow, Engine::OnWindowResized);
+			outEngineCtx->_input.Initialize(outRenderCtx->_pWindow);
+		}
 
 		*outCtx = InitializeVulkan(outEngineCtx->_globalSettings, outRenderCtx->_pWindow);
-		outEngineCtx->_scene = LoadScene(*outCtx);
-		LoadEnvironmentMap(*outCtx, *outEngineCtx);
+		{
+			Profiler::ScopedZone zone("Load scene");
+			outEngineCtx->_scene = LoadScene(*outCtx, outEngineCtx->_sceneName);
+			outEngineCtx->_scene.AdoptGameObjects();
+		}
+		{
+			Profiler::ScopedZone zone("Bake environment map");
+			LoadEnvironmentMap(*outCtx, *outEngineCtx);
+		}
 		auto descriptorSetLayouts = CreateSceneDescriptorSetLayouts(*outCtx, outEngineCtx->_scene);
-		outRenderCtx->_scenePipeline._layout = CreateScenePipelineLayout(*outCtx, descriptorSetLayouts);
 		CreateSceneShaderResources(*outCtx, *outRenderCtx, *outEngineCtx, descriptorSetLayouts);
+
+		// With the material table, the per mesh material sets are replaced by the table in the scene pipeline layouts.
+		if (outEngineCtx->_globalSettings._bindlessMaterials && MaterialTable::IsSupported(outCtx->_physicalDevice)) {
+			outEngineCtx->_materialTable.Create(*outCtx, outEngineCtx->_scene);
+			if (outEngineCtx->_materialTable._isEnabled) {
+				descriptorSetLayouts[3] = outEngineCtx->_materialTable._setLayout;
+				outRenderCtx->_bindlessTextureCount = (uint32_t)outEngineCtx->_materialTable._textures.size();
+			}
+		}
+		outRenderCtx->_scenePipeline._layout = CreateScenePipelineLayout(*outCtx, descriptorSetLayouts);
+		if (outEngineCtx->_globalSettings._gpuDrivenRendering && GpuDrivenScene::IsSupported(outCtx->_physicalDevice)) {
+			outEngineCtx->_gpuDrivenScene.Create(*outCtx, outEngineCtx->_scene, descriptorSetLayouts, outEngineCtx->_assetStreamer, outEngineCtx->_mainCamera._localTransform.Position());
+			if (outEngineCtx->_gpuDrivenScene._isEnabled) outRenderCtx->_gpuDrivenScenePipeline._layout = outEngineCtx->_gpuDrivenScene.CreateGraphicsPipelineLayout(*outCtx, descriptorSetLayouts);
+		}
+
+		// Only the node hierarchy has been loaded so far: meshes and textures are uploaded in the background while the scene is already being drawn.
+		StreamScene(*outCtx, *outEngineCtx);
+		outEngineCtx->_assetStreamer.Start(*outCtx, outEngineCtx->_globalSettings._streamingWorkerCount, (size_t)outEngineCtx->_globalSettings._streamingUploadMegabytesPerFrame * 1024 * 1024);
+
 		CreateRenderingResources(*outCtx, *outEngineCtx, outRenderCtx);
-		InitializeNuklearUI(*outCtx, *outRenderCtx);
+		if (isOffscreen) {
+			// Nothing draws the UI offscreen, but the UI subpass still samples the overlay images.
+			for (auto& image : outRenderCtx->_overlayImages) VkHelper::TransitionImageLayout(outCtx->_logicalDevice, outCtx->_commandPool, outCtx->_queue, image._image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
+		else InitializeNuklearUI(*outCtx, *outRenderCtx);
 	}
 
 	void WindowSizeChanged(VkContext& ctx, VkRenderContext& rCtx, EngineContext& eCtx) {
@@ -7196,27 +12886,58 @@ namespace Engine {
 		InitializeNuklearUI(ctx, rCtx);
 	}
 
-	void Draw(VkContext& ctx, VkRenderContext& rCtx, EngineContext& eCtx) {
-		if (windowMinimized) return;
-		vkResetFences(ctx._logicalDevice, 1, &ctx._queueFence);
+	/**
+	 * @brief Recreates the swapchain if it is out of date or the window was resized. Returns false if it was recreated.
+	 */
+	bool CheckSwapchainImageState(VkContext& ctx, VkRenderContext& rCtx, EngineContext& eCtx, VkResult swapImageState) {
+		if (swapImageState == VK_SUBOPTIMAL_KHR || swapImageState == VK_ERROR_OUT_OF_DATE_KHR || windowResized) { windowResized = false; WindowSizeChanged(ctx, rCtx, eCtx); return false; }
+		else if (swapImageState != VK_SUCCESS) { Logger::Error("image state is VkResult = {}", swapImageState); exit(1); }
+		return true;
+	}
 
-		// Acquire image.
-		uint32_t imageIndex;
-		VkResult swapImageState = vkAcquireNextImageKHR(ctx._logicalDevice, rCtx._swapchain._handle, UINT64_MAX, rCtx._imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+	/**
+	 * @brief Acquires the swapchain image the next frame is drawn to. Returns false if there is none to draw to, because the window is minimized or
+	 * the swapchain had to be recreated.
+	 */
+	bool AcquireImage(VkContext& ctx, VkRenderContext& rCtx, EngineContext& eCtx, uint32_t& outImageIndex) {
+		if (windowMinimized) return false;
+		Profiler::ScopedZone zone("Acquire image");
 
-		// Declare a lambda that takes three arguments
-		auto checkSwapchainImageState = [&]() -> bool {
-			if (swapImageState == VK_SUBOPTIMAL_KHR || swapImageState == VK_ERROR_OUT_OF_DATE_KHR || windowResized) { windowResized = false; WindowSizeChanged(ctx, rCtx, eCtx); return false; }
-			else if (swapImageState != VK_SUCCESS) { std::cerr << "Error: image state is VkResult = " << swapImageState << std::endl; exit(1); }
-			return true;
-			};
+		// The present mode is set when the swapchain is created.
+		if (rCtx._swapchain._requestedPresentMode != eCtx._globalSettings._presentMode) WindowSizeChanged(ctx, rCtx, eCtx);
+
+		VkResult swapImageState = vkAcquireNextImageKHR(ctx._logicalDevice, rCtx._swapchain._handle, UINT64_MAX, rCtx._imageAvailableSemaphore, VK_NULL_HANDLE, &outImageIndex);
+		return CheckSwapchainImageState(ctx, rCtx, eCtx, swapImageState);
+	}
 
-		if (!checkSwapchainImageState()) return;
+	/**
+	 * @brief Draws the frame to the swapchain image acquired by AcquireImage and presents it.
+	 */
+	void Draw(VkContext& ctx, VkRenderContext& rCtx, EngineContext& eCtx, uint32_t imageIndex) {
+		Profiler::ScopedZone zone("Draw");
+		vkResetFences(ctx._logicalDevice, 1, &ctx._queueFence);
 
 		// Refresh UI
 		{
-			if (!eCtx._input._cursorEnabled) goto skipUi;
+			Profiler::ScopedZone uiZone("UI");
+			auto isLoading = eCtx._assetStreamer.IsLoading();
+			if (!eCtx._input._cursorEnabled && !isLoading && !Profiler::Instance()._isOverlayVisible) goto skipUi;
 			nk_glfw3_new_frame();
+			Profiler::Instance().DrawOverlay(rCtx._uiCtx, (float)rCtx._swapchain._framebufferSize.width);
+
+			// Streaming progress is shown whether the cursor is enabled or not.
+			if (isLoading) {
+				auto progress = eCtx._assetStreamer.GetProgress();
+				if (nk_begin(rCtx._uiCtx, "Loading", nk_rect(10, 10, 260, 80), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR | NK_WINDOW_NO_INPUT)) {
+					nk_layout_row_dynamic(rCtx._uiCtx, 20, 1);
+					auto label = std::to_string(progress._residentCount) + " of " + std::to_string(progress._requestCount) + " assets, " + std::to_string(progress._residentBytes / (1024 * 1024)) + " of " + std::to_string(progress._requestBytes / (1024 * 1024)) + " MB";
+					nk_label(rCtx._uiCtx, label.c_str(), NK_TEXT_LEFT);
+					nk_size current = (nk_size)(progress._residentBytes / 1024);
+					nk_progress(rCtx._uiCtx, &current, (nk_size)std::max(progress._requestBytes / 1024, (uint64_t)1), NK_FIXED);
+				}
+				nk_end(rCtx._uiCtx);
+			}
+			if (!eCtx._input._cursorEnabled) goto skipUi;
 
 			/* GUI */
 			/*if (nk_begin(rCtx._uiCtx, "Demo", nk_rect(50, 50, 230, 250),
@@ -7287,6 +13008,8 @@ namespace Engine {
 		VkHelper::DestroyBuffer(_logicalDevice, stagingMemory, stagingBuffer);
 		VkHelper::TransitionImageLayout(_logicalDevice, _commandPool, _queue, _uiCtx._overlayImages[imageIndex]._image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);*/
 
+		RecordDrawCommands(ctx, rCtx, eCtx, imageIndex);
+
 		// Wait for image to be available and draw.
 		// This is the stage where the queue should wait on the semaphore.
 		VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -7301,7 +13024,11 @@ namespace Engine {
 		submitInfo.pCommandBuffers = &rCtx._drawCommandBuffers[imageIndex];
 
 		vkQueueSubmit(ctx._queue, 1, &submitInfo, ctx._queueFence);
-		vkWaitForFences(ctx._logicalDevice, 1, &ctx._queueFence, VK_TRUE, UINT64_MAX);
+		Profiler::Instance().OnGpuSubmit(imageIndex);
+		{
+			Profiler::ScopedZone waitZone("Wait for GPU");
+			vkWaitForFences(ctx._logicalDevice, 1, &ctx._queueFence, VK_TRUE, UINT64_MAX);
+		}
 
 		// Present drawn image.
 		// Note: semaphore here is not strictly necessary, because commands are processed in submission order within a single queue.
@@ -7313,20 +13040,66 @@ namespace Engine {
 		presentInfo.pSwapchains = &rCtx._swapchain._handle;
 		presentInfo.pImageIndices = &imageIndex;
 
-		swapImageState = vkQueuePresentKHR(ctx._queue, &presentInfo);
-		checkSwapchainImageState();
+		Profiler::ScopedZone presentZone("Present");
+		CheckSwapchainImageState(ctx, rCtx, eCtx, vkQueuePresentKHR(ctx._queue, &presentInfo));
+	}
+
+	/**
+	 * @brief Same as Draw, for when frames are rendered offscreen: there is no image to acquire, no UI and nothing to present.
+	 */
+	void DrawOffscreen(VkContext& ctx, VkRenderContext& rCtx, EngineContext& eCtx) {
+		Profiler::ScopedZone zone("Draw");
+		vkResetFences(ctx._logicalDevice, 1, &ctx._queueFence);
+		RecordDrawCommands(ctx, rCtx, eCtx, 0);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &rCtx._drawCommandBuffers[0];
+		CheckResult(vkQueueSubmit(ctx._queue, 1, &submitInfo, ctx._queueFence));
+		Profiler::Instance().OnGpuSubmit(0);
+
+		Profiler::ScopedZone waitZone("Wait for GPU");
+		vkWaitForFences(ctx._logicalDevice, 1, &ctx._queueFence, VK_TRUE, UINT64_MAX);
+	}
+
+	/**
+	 * @brief Passes live settings that changed on to the parts of the engine that keep their own copy of them.
+	 */
+	void ApplySettings(EngineContext& eCtx) {
+		auto& settings = eCtx._globalSettings;
+		Logger::Instance().SetLevel(settings._logLevel);
+		Profiler::Instance().SetEnabled(settings._profilingEnabled);
+		eCtx._mainCamera._farClippingDistance = settings._farClippingDistance;
+		eCtx._assetStreamer.Resize(settings._streamingWorkerCount, (size_t)settings._streamingUploadMegabytesPerFrame * 1024 * 1024);
 	}
 
 	void Update(VkContext& ctx, EngineContext& eCtx) {
+		Profiler::ScopedZone zone("Update");
+		if (eCtx._globalSettings.Update()) ApplySettings(eCtx);
+		if (eCtx._input.WasKeyPressed(GLFW_KEY_F3)) Profiler::Instance()._isOverlayVisible = !Profiler::Instance()._isOverlayVisible;
+		if (eCtx._input.WasKeyPressed(GLFW_KEY_F4)) Profiler::Instance().SaveTrace(Paths::TracePath());
+		eCtx._assetStreamer.Update(ctx);
 		eCtx._time.Update();
 		eCtx._input.Update();
 		eCtx._mainCamera.Update(ctx, eCtx._input);
 		eCtx._scene.Update(ctx);
 	}
 
+	/**
+	 * @brief Advances the simulation by one step.
+	 */
+	void PhysicsStep(VkContext& ctx, VkContext& collisionCtx, EngineContext& eCtx) {
+		Profiler::ScopedZone zone("Physics step");
+		eCtx._time.PhysicsUpdate(ctx, collisionCtx, eCtx);
+		eCtx._scene.PhysicsUpdate(ctx, collisionCtx, eCtx);
+	}
+
 	void PhysicsUpdate(GLFWwindow* pWindow, VkContext* ctx, EngineContext* eCtx) {
 		auto& time = Time::Instance();
+		Profiler::Instance().SetThreadName("Physics");
 		VkContext collisionCtx = GpuCollisionDetector::InitializeVulkan(ctx->_logicalDevice, ctx->_physicalDevice);
+		eCtx->_physicsSettings = eCtx->_globalSettings.GetPhysics();
 		time.PhysicsUpdate(*ctx, collisionCtx, *eCtx);
 
 		GameObject* mp5k = nullptr;
@@ -7336,10 +13109,13 @@ namespace Engine {
 			if (eCtx->_scene._pRootGameObject->_children[i]->_name == "MP5KCollision") mp5k = eCtx->_scene._pRootGameObject->_children[i];
 		}
 
+		auto timePhysicsUpdateStart = std::chrono::high_resolution_clock::now();
 		while (!glfwWindowShouldClose(pWindow)) {
-			auto timePhysicsUpdateStart = std::chrono::high_resolution_clock::now();
-			time.PhysicsUpdate(*ctx, collisionCtx, *eCtx);
-			eCtx->_scene.PhysicsUpdate(*ctx, collisionCtx, *eCtx);
+			eCtx->_physicsSettings = eCtx->_globalSettings.GetPhysics();
+			auto maxStepsPerSecond = eCtx->_physicsSettings._maxStepsPerSecond;
+			if (maxStepsPerSecond > 0) std::this_thread::sleep_until(timePhysicsUpdateStart + std::chrono::nanoseconds(1000000000 / maxStepsPerSecond));
+			timePhysicsUpdateStart = std::chrono::high_resolution_clock::now();
+			PhysicsStep(*ctx, collisionCtx, *eCtx);
 
 			float deltaTimeSeconds = (float)Time::Instance()._physicsDeltaTime * 0.001f;
 
@@ -7379,22 +13155,718 @@ namespace Engine {
 		std::thread physicsThread(&PhysicsUpdate, rCtx._pWindow, &ctx, &eCtx);
 
 		while (!glfwWindowShouldClose(rCtx._pWindow)) {
-			Update(ctx, eCtx);
-			Draw(ctx, rCtx, eCtx);
-			glfwPollEvents();
+			eCtx._framePacer.Wait(eCtx._globalSettings._maxFramesPerSecond);
+			{
+				Profiler::ScopedZone zone("Frame");
+
+				// The image is acquired first because acquiring may block until one is free, and input is only sampled after that, so what is drawn
+				// reflects input as recent as possible.
+				uint32_t imageIndex = 0;
+				auto isImageAcquired = AcquireImage(ctx, rCtx, eCtx, imageIndex);
+				glfwPollEvents();
+				Update(ctx, eCtx);
+				if (isImageAcquired) Draw(ctx, rCtx, eCtx, imageIndex);
+			}
+			Profiler::Instance().EndFrame();
 		}
 
 		physicsThread.join();
+		eCtx._assetStreamer.Stop(ctx);
 	}
+
+	/**
+	 * @brief Renders a scene offscreen along a scripted camera path, runs a fixed number of physics steps, and saves how long each stage took as JSON,
+	 * so that runs can be compared to catch performance regressions. Started with --benchmark followed by the name of a file in the models folder,
+	 * optionally followed by --frames, --warmup-frames, --physics-ticks, --width, --height and --output. Benchmarks need no window, so they also run
+	 * on machines without a display or a GPU, using a software Vulkan driver.
+	 */
+	class Benchmark {
+	public:
+
+		struct Options {
+			std::string _sceneName;
+			uint32_t _frameCount = 600;
+
+			/**
+			 * @brief Frames rendered before measuring starts, so that caches and the driver settle.
+			 */
+			uint32_t _warmupFrameCount = 30;
+			uint32_t _physicsTickCount = 600;
+			VkExtent2D _size = { 1280, 720 };
+
+			/**
+			 * @brief File the results are saved to. Defaults to a file named after the scene in the benchmarks folder.
+			 */
+			std::filesystem::path _outputPath;
+		};
+
+		/**
+		 * @brief Returns the options of the benchmark the command line asks for, if any.
+		 */
+		static std::optional<Options> ParseArguments(int argc, char** argv) {
+			Options options;
+			auto isBenchmark = false;
+			for (int i = 1; i < argc; i += 2) {
+				std::string argument = argv[i];
+				if (i + 1 >= argc) Exit(1, ("missing value of command line argument " + argument).c_str());
+				std::string value = argv[i + 1];
+				if (argument == "--benchmark") { options._sceneName = value; isBenchmark = true; }
+				else if (argument == "--frames") options._frameCount = std::max(ParseCount(argument, value), 1u);
+				else if (argument == "--warmup-frames") options._warmupFrameCount = ParseCount(argument, value);
+				else if (argument == "--physics-ticks") options._physicsTickCount = ParseCount(argument, value);
+				else if (argument == "--width") options._size.width = std::max(ParseCount(argument, value), 1u);
+				else if (argument == "--height") options._size.height = std::max(ParseCount(argument, value), 1u);
+				else if (argument == "--output") options._outputPath = std::filesystem::absolute(value);
+				else Exit(1, ("unknown command line argument " + argument).c_str());
+			}
+			if (!isBenchmark) return std::nullopt;
+			if (options._outputPath.empty()) options._outputPath = Paths::BenchmarksPath() /= std::filesystem::path(options._sceneName).stem().concat(".json");
+			return options;
+		}
+
+		/**
+		 * @brief Parses the value of a command line argument that counts something, exiting if it is not a non-negative integer.
+		 */
+		static uint32_t ParseCount(const std::string& argument, const std::string& value) {
+			uint32_t count = 0;
+			auto result = std::from_chars(value.data(), value.data() + value.size(), count);
+			if (result.ec != std::errc() || result.ptr != value.data() + value.size()) Exit(1, ("invalid value of command line argument " + argument + ": " + value).c_str());
+			return count;
+		}
+
+		/**
+		 * @brief Runs the benchmark and returns the exit code of the process.
+		 */
+		static int Run(const Options& options) {
+			VkContext ctx{};
+			VkRenderContext rCtx{};
+			EngineContext eCtx{};
+			eCtx._sceneName = options._sceneName;
+			eCtx._offscreenSize = options._size;
+			eCtx._time._isFixedStep = true;
+			InitializeEngine(&ctx, &rCtx, &eCtx);
+
+			// Zones are collected as often as a frame would, so that the rings of the profiler do not overflow.
+			Benchmark benchmark;
+			auto& profiler = Profiler::Instance();
+			profiler.EndFrame();
+			benchmark.Collect(0, UINT64_MAX);
+
+			// Everything is made resident before rendering, so that frames measure drawing the whole scene rather than streaming.
+			{
+				Profiler::ScopedZone zone("Stream scene");
+				while (eCtx._assetStreamer.IsLoading()) {
+					eCtx._assetStreamer.Update(ctx);
+					profiler.EndFrame();
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+			profiler.EndFrame();
+			benchmark.Collect(0, UINT64_MAX);
+
+			// The camera circles the scene once over the measured frames, looking at its center.
+			eCtx._scene.Update(ctx);
+			BoundingBox sceneBounds;
+			for (auto& child : eCtx._scene._pRootGameObject->_children) {
+				child->UpdateBounds();
+				sceneBounds = BoundingBox::Merge(sceneBounds, child->_subtreeBounds);
+			}
+			auto center = sceneBounds.IsEmpty() ? glm::vec3(0.0f) : sceneBounds.GetCenter();
+			auto extents = sceneBounds.IsEmpty() ? glm::vec3(1.0f) : sceneBounds.GetExtents();
+			auto radius = std::max(extents.x, extents.z) * 1.5f + 1.0f;
+
+			// GPU zones are read back the next time the command buffer is recorded, so one more frame is rendered after the measured ones.
+			uint64_t measureStart = UINT64_MAX;
+			uint64_t measureEnd = UINT64_MAX;
+			auto frameCount = options._warmupFrameCount + options._frameCount + 1;
+			for (uint32_t frame = 0; frame < frameCount; ++frame) {
+				if (frame == options._warmupFrameCount) measureStart = profiler.GetTime();
+				if (frame == options._warmupFrameCount + options._frameCount) measureEnd = profiler.GetTime();
+				{
+					Profiler::ScopedZone zone("Frame");
+					auto angle = glm::two_pi<float>() * (float)((int64_t)frame - options._warmupFrameCount) / (float)options._frameCount;
+					eCtx._mainCamera.LookAt(center + glm::vec3(cosf(angle) * radius, extents.y, sinf(angle) * radius), center);
+					eCtx._time.Update();
+					eCtx._scene.Update(ctx);
+					DrawOffscreen(ctx, rCtx, eCtx);
+				}
+				profiler.EndFrame();
+				benchmark.Collect(measureStart, measureEnd);
+			}
+
+			auto collisionCtx = GpuCollisionDetector::InitializeVulkan(ctx._logicalDevice, ctx._physicalDevice);
+			eCtx._physicsSettings = eCtx._globalSettings.GetPhysics();
+			measureStart = profiler.GetTime();
+			for (uint32_t tick = 0; tick < options._physicsTickCount; ++tick) {
+				PhysicsStep(ctx, collisionCtx, eCtx);
+				profiler.EndFrame();
+				benchmark.Collect(measureStart, UINT64_MAX);
+			}
+
+			eCtx._assetStreamer.Stop(ctx);
+			auto isSaved = benchmark.Save(options, ctx);
+			Logger::Instance().Flush();
+			return isSaved ? 0 : 1;
+		}
+
+	private:
+
+		/**
+		 * @brief A measured stage of the benchmark, along with the profiler zone it is measured by.
+		 */
+		struct Stage {
+			const char* _name;
+			const char* _zoneName;
+			bool _isGpu;
+		};
+
+		static constexpr Stage _stages[] = {
+			{ "load", "Load scene", false },
+			{ "envMapBake", "Bake environment map", false },
+			{ "streaming", "Stream scene", false },
+			{ "frameCpu", "Frame", false },
+			{ "recordCpu", "Record draw commands", false },
+			{ "frameGpu", "Frame", true },
+			{ "physicsTick", "Physics step", false },
+		};
+
+		/**
+		 * @brief Durations in milliseconds of each of _stages.
+		 */
+		std::vector<double> _samples[std::size(_stages)];
+
+		/**
+		 * @brief Adds the zones of the last frame that started within [startNanoseconds, endNanoseconds) to the samples.
+		 */
+		void Collect(uint64_t startNanoseconds, uint64_t endNanoseconds) {
+			auto& profiler = Profiler::Instance();
+			for (auto& zone : profiler.GetFrameZones()) {
+				if (zone._startNanoseconds < startNanoseconds || zone._startNanoseconds >= endNanoseconds) continue;
+				for (size_t i = 0; i < std::size(_stages); ++i) {
+					if (_stages[i]._isGpu != profiler.IsGpuZone(zone) || strcmp(_stages[i]._zoneName, zone._name) != 0) continue;
+					_samples[i].push_back((zone._endNanoseconds - zone._startNanoseconds) * 1e-6);
+				}
+			}
+		}
+
+		bool Save(const Options& options, VkContext& ctx) {
+			std::error_code error;
+			std::filesystem::create_directories(options._outputPath.parent_path(), error);
+			auto pFile = fopen(options._outputPath.string().c_str(), "wb");
+			if (pFile == nullptr) {
+				Logger::Error("failed saving benchmark results to {}", options._outputPath);
+				return false;
+			}
+
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(ctx._physicalDevice, &properties);
+			{
+				sjson::writer json(sjson::writer::file_sink(pFile));
+				json.start_object();
+				json.key("scene").string(options._sceneName).key("device").string(properties.deviceName);
+				json.key("width").number(options._size.width).key("height").number(options._size.height);
+				json.key("warmupFrames").number(options._warmupFrameCount).key("frames").number(options._frameCount).key("physicsTicks").number(options._physicsTickCount);
+
+				// Percentiles use the nearest rank, so they are always one of the samples.
+				json.key("unit").string("ms").key("stages").start_object();
+				for (size_t i = 0; i < std::size(_stages); ++i) {
+					auto samples = _samples[i];
+					std::sort(samples.begin(), samples.end());
+					auto percentile = [&samples](double p) { return samples[(size_t)std::max(std::ceil(p * 0.01 * samples.size()) - 1.0, 0.0)]; };
+					json.key(_stages[i]._name).start_object().key("count").number((uint64_t)samples.size());
+					if (samples.size() > 0) {
+						auto sum = 0.0;
+						for (auto sample : samples) sum += sample;
+						json.key("mean").number(sum / samples.size()).key("min").number(samples.front());
+						json.key("p50").number(percentile(50.0)).key("p90").number(percentile(90.0)).key("p95").number(percentile(95.0)).key("p99").number(percentile(99.0));
+						json.key("max").number(samples.back());
+					}
+					json.end_object();
+				}
+				json.end_object();
+
+				// Memory held at the end of the run, so growth shows up when comparing results.
+				json.key("memory");
+				ResourceTracker::Instance().Write(json);
+				json.end_object();
+			}
+			fclose(pFile);
+			Logger::Info("saved benchmark results to {}", options._outputPath);
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Times CPU kernels of the engine in isolation, on synthetic inputs of several sizes, and compares the results with a baseline saved by an
+	 * earlier run, so that optimizations can show what they gained and regressions are caught before they show up in whole frames. Started with
+	 * --micro-benchmarks followed by "all" or by part of the names of the cases to run, optionally followed by --repetitions, --min-batch-ms, --tolerance,
+	 * --baseline and --output. Needs neither a window nor a GPU. Saving a run with --output benchmarks\MicroBenchmarksBaseline.json makes it the
+	 * baseline of later runs, and the process exits with 1 when a case got slower than the tolerance allows.
+	 */
+	class MicroBenchmarks {
+	public:
+
+		struct Options {
+			/**
+			 * @brief Cases whose name contains this are run. "all" runs every case.
+			 */
+			std::string _filter;
+
+			/**
+			 * @brief Timed batches per case after warming up. The statistics of a case are taken over its batches.
+			 */
+			uint32_t _repetitions = 15;
+
+			/**
+			 * @brief Each batch runs the kernel as many times as it takes to last at least this long, so that fast kernels are timed well above the
+			 * resolution of the clock.
+			 */
+			uint32_t _minBatchMilliseconds = 10;
+
+			/**
+			 * @brief How much slower than in the baseline, in percent, the median of a case can get before it counts as a regression.
+			 */
+			uint32_t _tolerancePercent = 10;
+			std::filesystem::path _baselinePath;
+			std::filesystem::path _outputPath;
+		};
+
+		/**
+		 * @brief Returns the options of the micro benchmarks the command line asks for, if any.
+		 */
+		static std::optional<Options> ParseArguments(int argc, char** argv) {
+			if (std::none_of(argv + 1, argv + argc, [](const char* pArgument) { return strcmp(pArgument, "--micro-benchmarks") == 0; })) return std::nullopt;
+
+			Options options;
+			for (int i = 1; i < argc; i += 2) {
+				std::string argument = argv[i];
+				if (i + 1 >= argc) Exit(1, ("missing value of command line argument " + argument).c_str());
+				std::string value = argv[i + 1];
+				if (argument == "--micro-benchmarks") options._filter = value;
+				else if (argument == "--repetitions") options._repetitions = std::max(Benchmark::ParseCount(argument, value), 1u);
+				else if (argument == "--min-batch-ms") options._minBatchMilliseconds = Benchmark::ParseCount(argument, value);
+				else if (argument == "--tolerance") options._tolerancePercent = Benchmark::ParseCount(argument, value);
+				else if (argument == "--baseline") options._baselinePath = std::filesystem::absolute(value);
+				else if (argument == "--output") options._outputPath = std::filesystem::absolute(value);
+				else Exit(1, ("unknown command line argument " + argument).c_str());
+			}
+			if (options._baselinePath.empty()) options._baselinePath = Paths::BenchmarksPath() /= "MicroBenchmarksBaseline.json";
+			if (options._outputPath.empty()) options._outputPath = Paths::BenchmarksPath() /= "MicroBenchmarks.json";
+			return options;
+		}
+
+		/**
+		 * @brief Runs the cases the options select and returns the exit code of the process.
+		 */
+		static int Run(const Options& options) {
+			std::vector<Result> results;
+			for (auto& benchmarkCase : GetCases()) {
+				if (options._filter != "all" && benchmarkCase._name.find(options._filter) == std::string::npos) continue;
+				auto& result = results.emplace_back(Measure(benchmarkCase, options));
+				Logger::Info("{}: median {} ns, mean {} ns, standard deviation {} ns, {} runs per batch", result._name, result._median, result._mean, result._standardDeviation, result._iterationsPerBatch);
+			}
+
+			if (results.empty()) {
+				Logger::Error("no micro benchmark matches {}", options._filter);
+				Logger::Instance().Flush();
+				return 1;
+			}
+
+			auto regressionCount = Compare(options, results);
+			auto isSaved = Save(options, results);
+			Logger::Instance().Flush();
+			return isSaved && regressionCount == 0 ? 0 : 1;
+		}
+
+	private:
+
+		/**
+		 * @brief A kernel along with the input it is timed on.
+		 */
+		struct Case {
+			std::string _name;
+
+			/**
+			 * @brief Builds the input of the case and returns the kernel to time, which runs on that same input every time it is called.
+			 */
+			std::function<std::function<void()>()> _setUp;
+		};
+
+		/**
+		 * @brief Statistics of a case over its batches, in nanoseconds per run of the kernel.
+		 */
+		struct Result {
+			std::string _name;
+			uint64_t _iterationsPerBatch = 0;
+			double _mean = 0.0;
+			double _median = 0.0;
+			double _standardDeviation = 0.0;
+			double _min = 0.0;
+			std::optional<double> _baselineMedian;
+		};
+
+		/**
+		 * @brief Two bodies sharing a mesh, overlapping and children of the same root, the way DetectCollision finds them in a scene.
+		 */
+		struct CollisionScene {
+			Mesh _mesh;
+			GameObject _root;
+			GameObject _a;
+			GameObject _b;
+
+			CollisionScene(int cellsPerSide) {
+				MakeGrid(cellsPerSide, _mesh._vertices._vertexData, _mesh._faceIndices._indexData);
+				_root._pBody = nullptr;
+				for (auto pGameObject : { &_a, &_b }) {
+					pGameObject->_pParent = &_root;
+					pGameObject->_pMesh = &_mesh;
+					pGameObject->_pBody = new RigidBody();
+					pGameObject->_pBody->_pGameObject = pGameObject;
+				}
+				_b._localTransform.SetPosition(glm::vec3(0.1f, 0.05f, 0.1f));
+				_b._localTransform.Rotate(glm::vec3(1.0f, 0.0f, 0.0f), 30.0f);
+			}
+		};
+
+		/**
+		 * @brief Written by the kernels with something derived from their results, so that the compiler cannot leave out the work.
+		 */
+		static inline volatile size_t _sink = 0;
+
+		static std::vector<Case> GetCases() {
+			std::vector<Case> cases;
+
+			cases.push_back({ "IsRayIntersectingTriangle/triangles=4096", []() {
+				auto pCorners = std::make_shared<std::vector<glm::vec3>>(RandomVectors(4096 * 3));
+				return [pCorners]() {
+					auto& corners = *pCorners;
+					size_t hitCount = 0;
+					glm::vec3 intersectionPoint;
+					for (size_t i = 0; i < corners.size(); i += 3) hitCount += IsRayIntersectingTriangle(glm::vec3(0.0f, 0.0f, -2.0f), glm::vec3(0.0f, 0.0f, 1.0f), corners[i], corners[i + 1], corners[i + 2], intersectionPoint);
+					_sink = hitCount;
+				};
+			} });
+
+			// DetectCollision tests every pair of faces, so its cost grows with the square of the triangle count.
+			for (auto cellsPerSide : { 4, 8, 16 }) {
+				cases.push_back({ "RigidBody::DetectCollision/triangles=" + std::to_string(cellsPerSide * cellsPerSide * 2), [cellsPerSide]() {
+					auto pScene = std::make_shared<CollisionScene>(cellsPerSide);
+					return [pScene]() { _sink = pScene->_a._pBody->DetectCollision(*pScene->_b._pBody)._collisionPositions.size(); };
+				} });
+			}
+
+			// The faces are projected from an HDRi twice as wide as it is tall, with four face widths around the horizon, like the ones the engine loads.
+			for (auto faceSizePixels : { 64, 256, 512 }) {
+				cases.push_back({ "CubicalEnvironmentMap::GenerateFaceImage/faceSize=" + std::to_string(faceSizePixels), [faceSizePixels]() {
+					auto pEnvironmentMap = std::make_shared<CubicalEnvironmentMap>();
+					pEnvironmentMap->_faceSizePixels = faceSizePixels;
+					pEnvironmentMap->_hdriSizePixels = { (uint32_t)faceSizePixels * 4, (uint32_t)faceSizePixels * 2 };
+					pEnvironmentMap->_hdriImageData.push_back(RandomImage(faceSizePixels * 4, faceSizePixels * 2));
+
+					// Each face takes its own path through the projection, so consecutive runs go through all six.
+					return [pEnvironmentMap, faceIndex = 0]() mutable {
+						auto face = (CubeMapFace)(AsInteger(CubeMapFace::FRONT) + faceIndex++ % 6);
+						_sink = pEnvironmentMap->GenerateFaceImage(face, 0, pEnvironmentMap->_hdriSizePixels.width, pEnvironmentMap->_hdriSizePixels.height).size();
+					};
+				} });
+			}
+
+			for (auto radiusPixels : { 1, 4, 16 }) {
+				cases.push_back({ "CubicalEnvironmentMap::BoxBlurImage/size=256,radius=" + std::to_string(radiusPixels), [radiusPixels]() {
+					auto pEnvironmentMap = std::make_shared<CubicalEnvironmentMap>();
+					auto pImage = std::make_shared<std::vector<unsigned char>>(RandomImage(256, 256));
+					return [pEnvironmentMap, pImage, radiusPixels]() { _sink = pEnvironmentMap->BoxBlurImage(*pImage, 256, 256, radiusPixels).size(); };
+				} });
+			}
+
+			// Resizing and padding are timed the way the environment map builds its mip chain: halving an HDRi, then padding it by 5% of its width.
+			for (auto widthPixels : { 512, 2048 }) {
+				cases.push_back({ "CubicalEnvironmentMap::ResizeImage/width=" + std::to_string(widthPixels), [widthPixels]() {
+					auto pEnvironmentMap = std::make_shared<CubicalEnvironmentMap>();
+					auto pImage = std::make_shared<std::vector<unsigned char>>(RandomImage(widthPixels, widthPixels / 2));
+					return [pEnvironmentMap, pImage, widthPixels]() { _sink = pEnvironmentMap->ResizeImage(*pImage, widthPixels, widthPixels / 2, widthPixels / 2, widthPixels / 4).size(); };
+				} });
+				cases.push_back({ "CubicalEnvironmentMap::PadImage/width=" + std::to_string(widthPixels), [widthPixels]() {
+					auto pEnvironmentMap = std::make_shared<CubicalEnvironmentMap>();
+					auto pImage = std::make_shared<std::vector<unsigned char>>(RandomImage(widthPixels, widthPixels / 2));
+					return [pEnvironmentMap, pImage, widthPixels]() { _sink = pEnvironmentMap->PadImage(*pImage, widthPixels, widthPixels / 2, widthPixels / 20).size(); };
+				} });
+			}
+
+			for (auto depth : { 2, 8, 32 }) {
+				cases.push_back({ "GameObject::GetWorldSpaceTransform/depth=" + std::to_string(depth), [depth]() {
+					auto pChain = std::make_shared<std::vector<GameObject>>(depth + 1);
+					auto& chain = *pChain;
+					for (int i = 0; i <= depth; ++i) {
+						chain[i]._pBody = nullptr;
+						if (i == 0) continue;
+						chain[i]._pParent = &chain[i - 1];
+						chain[i]._localTransform.SetPosition(glm::vec3(0.0f, 1.0f, 0.5f));
+						chain[i]._localTransform.Rotate(glm::vec3(0.0f, 1.0f, 0.0f), 10.0f);
+					}
+					return [pChain]() { _sink = (size_t)pChain->back().GetWorldSpaceTransform()._matrix[3][1]; };
+				} });
+			}
+
+			cases.push_back({ "Transform::Rotate/quaternion", []() {
+				return [transform = Transform(), rotation = glm::angleAxis(0.01f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)))]() mutable { transform.Rotate(rotation); _sink = (size_t)transform._matrix[0][0]; };
+			} });
+			cases.push_back({ "Transform::Rotate/axisAngle", []() {
+				return [transform = Transform()]() mutable { transform.Rotate(glm::vec3(0.0f, 1.0f, 0.0f), 0.5f); _sink = (size_t)transform._matrix[0][0]; };
+			} });
+
+			for (auto memberCount : { 16, 256, 4096 }) {
+				cases.push_back({ "sjson::jobject::parse/members=" + std::to_string(memberCount), [memberCount]() {
+					auto pText = std::make_shared<std::string>(MakeJson(memberCount));
+					return [pText]() { _sink = sjson::jobject::parse(*pText).size(); };
+				} });
+				cases.push_back({ "sjson::document::parse/members=" + std::to_string(memberCount), [memberCount]() {
+					auto pText = std::make_shared<std::string>(MakeJson(memberCount));
+					return [pText]() { _sink = sjson::document::parse(*pText).root().size(); };
+				} });
+			}
+
+			for (auto cellsPerSide : { 32, 128, 512 }) {
+				cases.push_back({ "SceneLoader::ReadPrimitive/triangles=" + std::to_string(cellsPerSide * cellsPerSide * 2), [cellsPerSide]() {
+					auto pModel = MakeGltfModel(cellsPerSide);
+					return [pModel]() {
+						std::vector<Vertex> vertices;
+						std::vector<unsigned int> faceIndices;
+						SceneLoader::ReadPrimitive(*pModel, pModel->meshes[0].primitives[0], vertices, faceIndices);
+						_sink = faceIndices.size();
+					};
+				} });
+			}
+
+			return cases;
+		}
+
+		static Result Measure(const Case& benchmarkCase, const Options& options) {
+			auto kernel = benchmarkCase._setUp();
+			auto timeBatch = [&kernel](uint64_t iterationCount) {
+				auto start = std::chrono::steady_clock::now();
+				for (uint64_t i = 0; i < iterationCount; ++i) kernel();
+				return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			};
+
+			// Warming up doubles the batch until it lasts long enough, which also settles the caches, the branch predictors and the clock speed of the CPU.
+			auto minBatchNanoseconds = options._minBatchMilliseconds * 1e6;
+			uint64_t iterationCount = 1;
+			while (timeBatch(iterationCount) < minBatchNanoseconds) iterationCount *= 2;
+
+			std::vector<double> samples(options._repetitions);
+			for (auto& sample : samples) sample = timeBatch(iterationCount) / iterationCount;
+			std::sort(samples.begin(), samples.end());
+
+			Result result;
+			result._name = benchmarkCase._name;
+			result._iterationsPerBatch = iterationCount;
+			for (auto sample : samples) result._mean += sample;
+			result._mean /= samples.size();
+			for (auto sample : samples) result._standardDeviation += (sample - result._mean) * (sample - result._mean);
+			result._standardDeviation = samples.size() > 1 ? std::sqrt(result._standardDeviation / (samples.size() - 1)) : 0.0;
+			auto middle = samples.size() / 2;
+			result._median = samples.size() % 2 == 1 ? samples[middle] : (samples[middle - 1] + samples[middle]) * 0.5;
+			result._min = samples.front();
+			return result;
+		}
+
+		/**
+		 * @brief Fills in the baseline of each result from the baseline file, if there is one, and returns how many cases got slower than the tolerance allows.
+		 * The medians are compared, as they are the least thrown off by the odd batch the operating system interrupts.
+		 */
+		static uint32_t Compare(const Options& options, std::vector<Result>& results) {
+			if (!std::filesystem::exists(options._baselinePath)) {
+				Logger::Info("no micro benchmark baseline at {}, skipping the comparison", options._baselinePath);
+				return 0;
+			}
+
+			std::string text;
+			if (!FileIO::ReadAll(options._baselinePath, text)) {
+				Logger::Error("failed reading the micro benchmark baseline from {}", options._baselinePath);
+				return 0;
+			}
+
+			uint32_t regressionCount = 0;
+			try {
+				auto json = sjson::document::parse(text);
+				auto root = json.root();
+				if (!root.has_key("cases")) throw sjson::parsing_error("missing cases");
+				auto baselineCases = root["cases"];
+				for (auto& result : results) {
+					if (!baselineCases.has_key(result._name)) continue;
+					auto median = baselineCases[result._name]["median"];
+					if (median.type() != sjson::jtype::jnumber || median.as_double() <= 0.0) continue;
+
+					result._baselineMedian = median.as_double();
+					auto changePercent = (result._median / *result._baselineMedian - 1.0) * 100.0;
+					if (changePercent > options._tolerancePercent) {
+						Logger::Warning("{} regressed by {}%, from {} ns to {} ns", result._name, changePercent, *result._baselineMedian, result._median);
+						++regressionCount;
+					}
+					else if (changePercent < -(double)options._tolerancePercent) Logger::Info("{} improved by {}%, from {} ns to {} ns", result._name, -changePercent, *result._baselineMedian, result._median);
+				}
+			}
+			catch (const std::exception& error) {
+				Logger::Error("failed parsing the micro benchmark baseline from {}: {}", options._baselinePath, error.what());
+				return 0;
+			}
+
+			Logger::Info("{} of {} micro benchmarks regressed beyond {}%", regressionCount, results.size(), options._tolerancePercent);
+			return regressionCount;
+		}
+
+		static bool Save(const Options& options, const std::vector<Result>& results) {
+			std::error_code error;
+			std::filesystem::create_directories(options._outputPath.parent_path(), error);
+			auto pFile = fopen(options._outputPath.string().c_str(), "wb");
+			if (pFile == nullptr) {
+				Logger::Error("failed saving micro benchmark results to {}", options._outputPath);
+				return false;
+			}
+
+			{
+				sjson::writer json(sjson::writer::file_sink(pFile));
+				json.start_object();
+				json.key("repetitions").number(options._repetitions).key("minBatchMs").number(options._minBatchMilliseconds);
+				json.key("unit").string("ns").key("cases").start_object();
+				for (auto& result : results) {
+					json.key(result._name).start_object().key("iterationsPerBatch").number(result._iterationsPerBatch);
+					json.key("mean").number(result._mean).key("median").number(result._median).key("stddev").number(result._standardDeviation).key("min").number(result._min);
+					if (result._baselineMedian) json.key("baselineMedian").number(*result._baselineMedian).key("changePercent").number((result._median / *result._baselineMedian - 1.0) * 100.0);
+					json.end_object();
+				}
+				json.end_object().end_object();
+			}
+			fclose(pFile);
+			Logger::Info("saved micro benchmark results to {}", options._outputPath);
+			return true;
+		}
+
+		/**
+		 * @brief Inputs come from a fixed seed, so that every run times the same work.
+		 */
+		static std::mt19937& GetRandomEngine() {
+			static std::mt19937 engine(1234);
+			return engine;
+		}
+
+		static std::vector<glm::vec3> RandomVectors(size_t count) {
+			std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+			std::vector<glm::vec3> vectors(count);
+			for (auto& vector : vectors) vector = glm::vec3(distribution(GetRandomEngine()), distribution(GetRandomEngine()), distribution(GetRandomEngine()));
+			return vectors;
+		}
+
+		static std::vector<unsigned char> RandomImage(int widthPixels, int heightPixels) {
+			std::uniform_int_distribution<int> distribution(0, 255);
+			std::vector<unsigned char> image(widthPixels * heightPixels * 4);
+			for (auto& component : image) component = (unsigned char)distribution(GetRandomEngine());
+			return image;
+		}
+
+		/**
+		 * @brief Makes a unit square of cellsPerSide by cellsPerSide cells, two triangles each, on the XZ plane, with a wavy height so that rotated copies of it
+		 * cross each other in many places.
+		 */
+		static void MakeGrid(int cellsPerSide, std::vector<Vertex>& outVertices, std::vector<unsigned int>& outFaceIndices) {
+			auto verticesPerSide = cellsPerSide + 1;
+			outVertices.resize(verticesPerSide * verticesPerSide);
+			for (int z = 0; z < verticesPerSide; ++z) {
+				for (int x = 0; x < verticesPerSide; ++x) {
+					auto& vertex = outVertices[z * verticesPerSide + x];
+					auto u = (float)x / cellsPerSide;
+					auto v = (float)z / cellsPerSide;
+					vertex._position = glm::vec3(u - 0.5f, 0.1f * sinf(u * 12.0f) * cosf(v * 12.0f), v - 0.5f);
+					vertex._normal = glm::vec3(0.0f, 1.0f, 0.0f);
+					vertex._uvCoord = glm::vec2(u, v);
+				}
+			}
+
+			outFaceIndices.clear();
+			for (int z = 0; z < cellsPerSide; ++z) {
+				for (int x = 0; x < cellsPerSide; ++x) {
+					unsigned int corner = z * verticesPerSide + x;
+					outFaceIndices.insert(outFaceIndices.end(), { corner, corner + verticesPerSide, corner + 1, corner + 1, corner + verticesPerSide, corner + verticesPerSide + 1 });
+				}
+			}
+		}
+
+		/**
+		 * @brief Makes a glTF model with a single primitive holding a grid, with positions, normals, UV coordinates and indices each in a tightly packed
+		 * buffer view, the way exporters usually lay them out.
+		 */
+		static std::shared_ptr<tinygltf::Model> MakeGltfModel(int cellsPerSide) {
+			std::vector<Vertex> vertices;
+			std::vector<unsigned int> faceIndices;
+			MakeGrid(cellsPerSide, vertices, faceIndices);
+
+			std::vector<float> positions, normals, uvCoords;
+			for (auto& vertex : vertices) {
+				positions.insert(positions.end(), { vertex._position.x, vertex._position.y, vertex._position.z });
+				normals.insert(normals.end(), { vertex._normal.x, vertex._normal.y, vertex._normal.z });
+				uvCoords.insert(uvCoords.end(), { vertex._uvCoord.x, vertex._uvCoord.y });
+			}
+
+			auto pModel = std::make_shared<tinygltf::Model>();
+			auto& buffer = pModel->buffers.emplace_back();
+			auto addAccessor = [&pModel, &buffer](const void* pData, size_t count, int type, int componentType) {
+				tinygltf::BufferView bufferView;
+				bufferView.buffer = 0;
+				bufferView.byteOffset = buffer.data.size();
+				bufferView.byteLength = count * tinygltf::GetNumComponentsInType(type) * tinygltf::GetComponentSizeInBytes(componentType);
+				buffer.data.insert(buffer.data.end(), (const unsigned char*)pData, (const unsigned char*)pData + bufferView.byteLength);
+
+				tinygltf::Accessor accessor;
+				accessor.bufferView = (int)pModel->bufferViews.size();
+				accessor.count = count;
+				accessor.type = type;
+				accessor.componentType = componentType;
+				pModel->bufferViews.push_back(bufferView);
+				pModel->accessors.push_back(accessor);
+				return (int)pModel->accessors.size() - 1;
+			};
+
+			tinygltf::Primitive primitive;
+			primitive.mode = TINYGLTF_MODE_TRIANGLES;
+			primitive.attributes["POSITION"] = addAccessor(positions.data(), vertices.size(), TINYGLTF_TYPE_VEC3, TINYGLTF_COMPONENT_TYPE_FLOAT);
+			primitive.attributes["NORMAL"] = addAccessor(normals.data(), vertices.size(), TINYGLTF_TYPE_VEC3, TINYGLTF_COMPONENT_TYPE_FLOAT);
+			primitive.attributes["TEXCOORD_0"] = addAccessor(uvCoords.data(), vertices.size(), TINYGLTF_TYPE_VEC2, TINYGLTF_COMPONENT_TYPE_FLOAT);
+			primitive.indices = addAccessor(faceIndices.data(), faceIndices.size(), TINYGLTF_TYPE_SCALAR, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT);
+			pModel->meshes.emplace_back().primitives.push_back(primitive);
+			return pModel;
+		}
+
+		/**
+		 * @brief Makes a JSON object of memberCount members, cycling through numbers, strings, arrays and nested objects like settings and glTF files hold.
+		 */
+		static std::string MakeJson(int memberCount) {
+			std::string text = "{";
+			for (int i = 0; i < memberCount; ++i) {
+				if (i > 0) text += ",";
+				text += "\"member" + std::to_string(i) + "\":";
+				switch (i % 4) {
+				case 0: text += std::to_string(i * 0.25); break;
+				case 1: text += "\"value " + std::to_string(i) + " with \\\"escapes\\\"\""; break;
+				case 2: text += "[" + std::to_string(i) + ",-1.5e3,true,null]"; break;
+				default: text += "{\"x\":" + std::to_string(i) + ",\"y\":\"nested\",\"z\":[1,2,3]}"; break;
+				}
+			}
+			return text + "}";
+		}
+	};
 }
 
-int main() {
+int main(int argc, char** argv) {
+	if (auto microBenchmarkOptions = Engine::MicroBenchmarks::ParseArguments(argc, argv)) return Engine::MicroBenchmarks::Run(*microBenchmarkOptions);
+	if (auto benchmarkOptions = Engine::Benchmark::ParseArguments(argc, argv)) return Engine::Benchmark::Run(*benchmarkOptions);
+
 	Engine::VkContext ctx{};
 	Engine::VkRenderContext rCtx{};
 	Engine::EngineContext eCtx{};
 	Engine::InitializeEngine(&ctx, &rCtx, &eCtx);
 	Engine::MainLoop(ctx, rCtx, eCtx);
-	Engine::Cleanup(true);
+	Engine::Cleanup(ctx, true);
 
 	return 0;
 }
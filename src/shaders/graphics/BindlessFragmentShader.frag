@@ -0,0 +1,107 @@
+#version 450
+
+// Input variables. All these values will be interpolated for each pixel this instance
+// of the shader runs on, with the base and target interpolation values coming from the
+// attributes of the 2 closest vertices.
+layout (location = 0) in vec2 inUVCoord;
+layout (location = 1) in vec3 inWorldSpaceNormal;
+layout (location = 2) in vec3 inDirectionToLight;
+layout (location = 3) in vec3 inDirectionToCamera;
+layout (location = 4) flat in uint inMaterialIndex;
+layout (location = 5) in vec3 inWorldSpacePosition;
+layout (location = 6) flat in uint inMaterialFlags;
+
+// Must match Material::Flags.
+const uint MATERIAL_HAS_NORMAL_MAP = 1u;
+
+// Output variables.
+layout(location = 0) out vec4 outColor;
+
+// Variables coming from descriptor sets. See ShaderResources.cpp for more info on descriptor sets.
+layout(set = 2, binding = 0) uniform LightData {
+	vec3 position;
+	vec4 colorIntensity; // X, Y, Z for color, W for intensity.
+} lightData;
+
+// Number of textures in the texture table, set by the engine when creating the pipeline.
+layout(constant_id = 0) const uint textureCount = 1;
+
+// Every texture used by the scene. Materials refer to textures by their index in this array.
+layout(set = 3, binding = 0) uniform sampler2D textures[textureCount];
+
+// Must match MaterialTable::MaterialData.
+struct MaterialData {
+	uint albedoIndex;
+	uint occlusionRoughnessMetalnessIndex;
+	uint normalIndex;
+	uint emissiveIndex;
+};
+
+// One entry per material of the scene, indexed by the material index of the mesh being drawn.
+layout(std430, set = 3, binding = 1) readonly buffer MaterialBuffer {
+	MaterialData materials[];
+};
+
+// Environment map.
+layout(set = 4, binding = 0) uniform samplerCube environmentMap;
+
+// Perturbs the interpolated normal with a tangent space normal map sample. Vertices have no tangents, so the tangent frame is rebuilt for each pixel from the
+// screen space derivatives of the position and of the uv coordinates.
+vec3 PerturbNormal(vec3 normal, vec3 position, vec2 uv, vec3 normalMapColor)
+{
+	vec3 dPositionDx = dFdx(position);
+	vec3 dPositionDy = dFdy(position);
+	vec2 dUvDx = dFdx(uv);
+	vec2 dUvDy = dFdy(uv);
+
+	vec3 dPositionDyPerpendicular = cross(dPositionDy, normal);
+	vec3 dPositionDxPerpendicular = cross(normal, dPositionDx);
+	vec3 tangent = dPositionDyPerpendicular * dUvDx.x + dPositionDxPerpendicular * dUvDy.x;
+	vec3 bitangent = dPositionDyPerpendicular * dUvDx.y + dPositionDxPerpendicular * dUvDy.y;
+
+	// Surfaces without a uv mapping have no tangent frame.
+	float frameSize = max(dot(tangent, tangent), dot(bitangent, bitangent));
+	if (frameSize <= 0.0f) return normal;
+
+	vec3 tangentSpaceNormal = normalMapColor * 2.0f - 1.0f;
+	float inverseFrameSize = inversesqrt(frameSize);
+	return normalize(mat3(tangent * inverseFrameSize, bitangent * inverseFrameSize, normal) * tangentSpaceNormal);
+}
+
+void main() 
+{
+	// Only do the calculations if the pixel is actually visible.
+	if (dot(inDirectionToCamera, inWorldSpaceNormal) > -0.1f) {
+
+        // Sample the textures that will be used in our Cook-Torrance material model. The engine only issues rendering commands that draw a single
+		// material while this shader is bound, so the material index is uniform and indexing the texture array only needs dynamic indexing.
+		MaterialData material = materials[inMaterialIndex];
+		vec4 albedoMapColor = texture(textures[material.albedoIndex], inUVCoord);
+		vec4 occlusionRoughnessMetalnessMapColor = texture(textures[material.occlusionRoughnessMetalnessIndex], inUVCoord);
+		vec4 emissiveMapColor = texture(textures[material.emissiveIndex], inUVCoord);
+
+		// Occlusion, roughness and metalness are packed in the R, G and B channels of one map, so a single fetch gets all three.
+		float occlusion = occlusionRoughnessMetalnessMapColor.r;
+		float roughness = occlusionRoughnessMetalnessMapColor.g;
+		float metalness = occlusionRoughnessMetalnessMapColor.b;
+
+		// Materials without a normal map keep the interpolated normal.
+		vec3 normal = normalize(inWorldSpaceNormal);
+		if ((inMaterialFlags & MATERIAL_HAS_NORMAL_MAP) != 0u) {
+			vec3 normalMapColor = texture(textures[material.normalIndex], inUVCoord).rgb;
+			normal = PerturbNormal(normal, inWorldSpacePosition, inUVCoord, normalMapColor);
+		}
+
+        // Calculate the vector resulting from an imaginary ray shooting out of the camera and bouncing off
+		// the pixel on the surface we want to render.
+		vec4 reflected = reflect(vec4(-inDirectionToCamera.xyz, 0.0f), vec4(normal, 0.0f));
+
+		// Rougher surfaces reflect a blurrier environment, and metals tint what they reflect with their base color.
+        vec4 environmentMapColor = textureLod(environmentMap, reflected.xyz, roughness * 6.0f);
+		environmentMapColor.rgb = mix(environmentMapColor.rgb, environmentMapColor.rgb * albedoMapColor.rgb, metalness);
+        outColor = normalize(environmentMapColor + albedoMapColor) * vec4(vec3(occlusion), 1.0f) + vec4(emissiveMapColor.rgb, 0.0f);
+	}
+	else {
+		outColor = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+	}
+}
\ No newline at end of file
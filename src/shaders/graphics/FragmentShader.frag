@@ -7,6 +7,11 @@ layout (location = 0) in vec2 inUVCoord;
 layout (location = 1) in vec3 inWorldSpaceNormal;
 layout (location = 2) in vec3 inDirectionToLight;
 layout (location = 3) in vec3 inDirectionToCamera;
+layout (location = 5) in vec3 inWorldSpacePosition;
+layout (location = 6) flat in uint inMaterialFlags;
+
+// Must match Material::Flags.
+const uint MATERIAL_HAS_NORMAL_MAP = 1u;
 
 // Output variables.
 layout(location = 0) out vec4 outColor;
@@ -17,14 +22,38 @@ layout(set = 2, binding = 0) uniform LightData {
 	vec4 colorIntensity; // X, Y, Z for color, W for intensity.
 } lightData;
 
-// Base color texture.
+// Material maps, one binding per Material::MapType.
 layout(set = 3, binding = 0) uniform sampler2D albedoMap;
-layout(set = 3, binding = 1) uniform sampler2D roughnessMap;
-layout(set = 3, binding = 2) uniform sampler2D metalnessMap;
+layout(set = 3, binding = 1) uniform sampler2D occlusionRoughnessMetalnessMap;
+layout(set = 3, binding = 2) uniform sampler2D normalMap;
+layout(set = 3, binding = 3) uniform sampler2D emissiveMap;
 
 // Environment map.
 layout(set = 4, binding = 0) uniform samplerCube environmentMap;
 
+// Perturbs the interpolated normal with a tangent space normal map sample. Vertices have no tangents, so the tangent frame is rebuilt for each pixel from the
+// screen space derivatives of the position and of the uv coordinates.
+vec3 PerturbNormal(vec3 normal, vec3 position, vec2 uv, vec3 normalMapColor)
+{
+	vec3 dPositionDx = dFdx(position);
+	vec3 dPositionDy = dFdy(position);
+	vec2 dUvDx = dFdx(uv);
+	vec2 dUvDy = dFdy(uv);
+
+	vec3 dPositionDyPerpendicular = cross(dPositionDy, normal);
+	vec3 dPositionDxPerpendicular = cross(normal, dPositionDx);
+	vec3 tangent = dPositionDyPerpendicular * dUvDx.x + dPositionDxPerpendicular * dUvDy.x;
+	vec3 bitangent = dPositionDyPerpendicular * dUvDx.y + dPositionDxPerpendicular * dUvDy.y;
+
+	// Surfaces without a uv mapping have no tangent frame.
+	float frameSize = max(dot(tangent, tangent), dot(bitangent, bitangent));
+	if (frameSize <= 0.0f) return normal;
+
+	vec3 tangentSpaceNormal = normalMapColor * 2.0f - 1.0f;
+	float inverseFrameSize = inversesqrt(frameSize);
+	return normalize(mat3(tangent * inverseFrameSize, bitangent * inverseFrameSize, normal) * tangentSpaceNormal);
+}
+
 void main() 
 {
 	// Only do the calculations if the pixel is actually visible.
@@ -32,19 +61,29 @@ void main()
 
         // Sample the textures that will be used in our Cook-Torrance material model.
 		vec4 albedoMapColor = texture(albedoMap, inUVCoord);
-		vec4 roughnessMapColor = texture(roughnessMap, inUVCoord);
-		vec4 metalnessMapColor = texture(metalnessMap, inUVCoord);
+		vec4 occlusionRoughnessMetalnessMapColor = texture(occlusionRoughnessMetalnessMap, inUVCoord);
+		vec4 emissiveMapColor = texture(emissiveMap, inUVCoord);
+
+		// Occlusion, roughness and metalness are packed in the R, G and B channels of one map, so a single fetch gets all three.
+		float occlusion = occlusionRoughnessMetalnessMapColor.r;
+		float roughness = occlusionRoughnessMetalnessMapColor.g;
+		float metalness = occlusionRoughnessMetalnessMapColor.b;
+
+		// Materials without a normal map keep the interpolated normal.
+		vec3 normal = normalize(inWorldSpaceNormal);
+		if ((inMaterialFlags & MATERIAL_HAS_NORMAL_MAP) != 0u) {
+			vec3 normalMapColor = texture(normalMap, inUVCoord).rgb;
+			normal = PerturbNormal(normal, inWorldSpacePosition, inUVCoord, normalMapColor);
+		}
 
         // Calculate the vector resulting from an imaginary ray shooting out of the camera and bouncing off
 		// the pixel on the surface we want to render.
-		vec4 reflected = reflect(vec4(-inDirectionToCamera.xyz, 0.0f), vec4(inWorldSpaceNormal.xyz, 0.0f));
-
-		// Now we need to get the roughness value as a grayscale value. We calculate the average of all three color channels in case the image is not already grayscale.
-        float roughness = (roughnessMapColor.x + roughnessMapColor.y + roughnessMapColor.z) / 3.0f;
-        float metalness = (metalnessMapColor.x + metalnessMapColor.y + metalnessMapColor.z) / 3.0f;
+		vec4 reflected = reflect(vec4(-inDirectionToCamera.xyz, 0.0f), vec4(normal, 0.0f));
 
-        vec4 environmentMapColor = textureLod(environmentMap, reflected.xyz, 3.0f);
-        outColor = normalize(environmentMapColor + albedoMapColor);
+		// Rougher surfaces reflect a blurrier environment, and metals tint what they reflect with their base color.
+        vec4 environmentMapColor = textureLod(environmentMap, reflected.xyz, roughness * 6.0f);
+		environmentMapColor.rgb = mix(environmentMapColor.rgb, environmentMapColor.rgb * albedoMapColor.rgb, metalness);
+        outColor = normalize(environmentMapColor + albedoMapColor) * vec4(vec3(occlusion), 1.0f) + vec4(emissiveMapColor.rgb, 0.0f);
 	}
 	else {
 		outColor = vec4(0.0f, 0.0f, 0.0f, 0.0f);
@@ -0,0 +1,68 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// https://registry.khronos.org/SPIR-V/specs/unified1/SPIRV.html
+
+// Input attributes coming from a vertex buffer.
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUv;
+
+#include "SceneVertex.glsl"
+
+// Output variables to send to the next shader stages.
+layout (location = 0) out vec2 outUVCoord;
+layout (location = 1) out vec3 outWorldSpaceNormal;
+layout (location = 2) out vec3 outDirectionToLight;
+layout (location = 3) out vec3 outDirectionToCamera;
+layout (location = 4) flat out uint outMaterialIndex;
+layout (location = 5) out vec3 outWorldSpacePosition;
+layout (location = 6) flat out uint outMaterialFlags;
+
+// Must match GpuDrivenScene::ObjectData.
+struct ObjectData {
+	mat4 objectToWorld;
+	vec4 boundsCenter;
+	vec4 boundsExtents;
+	uint firstMeshlet;
+	uint meshletCount;
+	int vertexOffset;
+	uint materialIndex;
+	vec4 positionOffset;
+	vec4 positionScale;
+	uint firstThread;
+	uint batchIndex;
+	uint firstCommand;
+	uint materialFlags;
+};
+
+// Data of all the objects of the scene. The draw commands written by the culling compute shader set firstInstance to the index of the object they draw.
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+	ObjectData objects[];
+};
+
+layout(set = 2, binding = 0) uniform LightData {
+	vec3 position;
+	vec4 colorIntensity; // X, Y, Z for color, W for intensity.
+} lightData;
+
+void main() 
+{
+	ObjectData objectData = objects[gl_InstanceIndex];
+	vec3 objectSpacePosition = objectData.positionOffset.xyz + inPosition.xyz * objectData.positionScale.xyz;
+	vec4 vertexWorldSpacePosition = objectData.objectToWorld * vec4(objectSpacePosition, 1.0f);
+	vec4 worldSpaceNormal = objectData.objectToWorld * vec4(DecodeNormal(inNormal), 0.0f);
+	vec4 cameraSpacePosition = cameraData.worldToCamera * vertexWorldSpacePosition;
+
+	gl_Position = Project(cameraSpacePosition);
+	
+	// Forward the uv coordinate of the vertex to the fragment stage.
+	outUVCoord = inUv;
+	outWorldSpaceNormal = vec3(worldSpaceNormal.xyz);
+//	outWorldSpaceNormal = vec4(inNormal.xyz, 1.0f);
+	outDirectionToLight = lightData.position - vertexWorldSpacePosition.xyz;
+	outDirectionToCamera = normalize(cameraData.worldSpacePosition - vertexWorldSpacePosition.xyz);
+	outWorldSpacePosition = vertexWorldSpacePosition.xyz;
+	outMaterialIndex = objectData.materialIndex;
+	outMaterialFlags = objectData.materialFlags;
+}
\ No newline at end of file
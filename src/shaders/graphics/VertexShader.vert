@@ -1,4 +1,5 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
 // https://registry.khronos.org/SPIR-V/specs/unified1/SPIRV.html
 
@@ -7,26 +8,29 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inUv;
 
+#include "SceneVertex.glsl"
+
 // Output variables to send to the next shader stages.
 layout (location = 0) out vec2 outUVCoord;
 layout (location = 1) out vec3 outWorldSpaceNormal;
 layout (location = 2) out vec3 outDirectionToLight;
 layout (location = 3) out vec3 outDirectionToCamera;
-
-// Data used to project the world space coordinates of the vertex into Vulkan's viewable volume.
-layout(set = 0, binding = 0) uniform CameraData {
-	float tanHalfHorizontalFov;
-	float aspectRatio;
-	float nearClipDistance;
-	float farClipDistance;
-	mat4 worldToCamera;
-	vec3 worldSpacePosition;
-} cameraData;
-
-// Variables coming from descriptor with binding number 0 at descriptor set 1.
-layout(set = 1, binding = 0) uniform ObjectData {
-	mat4 objectToWorld;
-} objectData;
+layout (location = 4) flat out uint outMaterialIndex;
+layout (location = 5) out vec3 outWorldSpacePosition;
+layout (location = 6) flat out uint outMaterialFlags;
+
+// Per instance attribute coming from the instance buffer. Each instance of the mesh being drawn has its own object to world transform.
+// A mat4 takes up 4 locations, one per column, so this occupies locations 3 to 6.
+layout(location = 3) in mat4 inObjectToWorld;
+
+// Index and flags of the material of the mesh being drawn, used by the fragment shaders to look up its textures, and how to bring its
+// vertex positions back to object space. Must match MeshInstancer::PushConstants.
+layout(push_constant) uniform PushConstants {
+	uint materialIndex;
+	uint materialFlags;
+	vec4 positionOffset;
+	vec4 positionScale;
+} pushConstants;
 
 layout(set = 2, binding = 0) uniform LightData {
 	vec3 position;
@@ -35,30 +39,12 @@ layout(set = 2, binding = 0) uniform LightData {
 
 void main() 
 {
-	vec4 vertexWorldSpacePosition = objectData.objectToWorld * vec4(inPosition.xyz, 1.0f);
-	vec4 worldSpaceNormal = objectData.objectToWorld * vec4(inNormal.xyz, 0.0f);
+	vec3 objectSpacePosition = pushConstants.positionOffset.xyz + inPosition.xyz * pushConstants.positionScale.xyz;
+	vec4 vertexWorldSpacePosition = inObjectToWorld * vec4(objectSpacePosition, 1.0f);
+	vec4 worldSpaceNormal = inObjectToWorld * vec4(DecodeNormal(inNormal), 0.0f);
 	vec4 cameraSpacePosition = cameraData.worldToCamera * vertexWorldSpacePosition;
 
-	// The idea behind the projection transformation is using the camera as if you were standing behind a glass window: whatever you see out the window gets projected onto
-	// the glass.
-	// Lets say that YOU are the camera. Now do the following:
-	// 1) Go to a window and stand about 1 meter behind it, making sure that your head is roughly at the center of the window.
-	// 2) Close one eye so you have only one focal point.
-	// 3) Now focus on something outside the window (has to be a specific point, like the tip of the roof of a house or the leaf of a tree) 
-	// 4) Next, move your head towards the point you are focusing on in a straight line, untill you eventually hit the window with your head
-	// That point on the glass, right in front of your pupil, is what we're looking to calculate.
-	// This is exactly how the projection transformation was thought about but in reverse; the point in space outside the window moves towards your pupil until it
-	// eventually hits the window. When it hits the window, you just take the distance from the center of the window to the hit point: these will be your 2D screen
-	// coordinates.
-	// This calculation is based on the fact that Vulkan's coordinate system is X right, Y down, Z forward (follows the right hand rule).
-	// In our engine we have X right, Y up, Z forward (we follow the left hand rule).
-	float xCoord = cameraSpacePosition.x / (cameraData.tanHalfHorizontalFov * cameraData.aspectRatio);
-	float yCoord = -cameraSpacePosition.y / cameraData.tanHalfHorizontalFov;
-	float zCoord = (cameraSpacePosition.z - cameraData.nearClipDistance) / (cameraData.farClipDistance - cameraData.nearClipDistance);
-
-	// Remember that the next stages are going to divide each component of gl_position by its w component, meaning that
-	// gl_position = vec4(gl_position.x / gl_position.w, gl_position.y / gl_position.w, gl_position.z / gl_position.w, gl_position.w / gl_position.w)
-	gl_Position = vec4(xCoord, yCoord, zCoord, cameraSpacePosition.z);
+	gl_Position = Project(cameraSpacePosition);
 	
 	// Forward the uv coordinate of the vertex to the fragment stage.
 	outUVCoord = inUv;
@@ -66,4 +52,7 @@ void main()
 //	outWorldSpaceNormal = vec4(inNormal.xyz, 1.0f);
 	outDirectionToLight = lightData.position - vertexWorldSpacePosition.xyz;
 	outDirectionToCamera = normalize(cameraData.worldSpacePosition - vertexWorldSpacePosition.xyz);
+	outWorldSpacePosition = vertexWorldSpacePosition.xyz;
+	outMaterialIndex = pushConstants.materialIndex;
+	outMaterialFlags = pushConstants.materialFlags;
 }
\ No newline at end of file